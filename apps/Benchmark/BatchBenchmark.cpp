@@ -0,0 +1,76 @@
+#include <new>
+#include <string>
+
+#include <MatrixLibrary/Math/Matrix.h>
+#include <MatrixLibrary/Memory/AlignedAlloc.h>
+
+#include "Benchmark.h"
+
+using namespace ML;
+
+namespace
+{
+  // Array of count static matrices (std::vector does not respect the alignment of SIMD types before C++17)
+  template<typename MT>
+  class TMatrixArray
+  {
+  public:
+    explicit TMatrixArray(std::size_t count) : m_array(count, alignof(MT))
+    {
+      for (std::size_t i = 0; i < count; i++)
+        new (m_array.data() + i) MT();
+    }
+
+    MT* data() noexcept { return m_array.data(); }
+    MT& operator[](std::size_t i) noexcept { return m_array.data()[i]; }
+
+  private:
+    TMLAlignedArray<MT> m_array;
+  };
+
+  // Products of count pairs of n x n matrices: one product per call, batched on arrays of static
+  // matrices and batched on the interleaved layout
+  template<typename ET, std::size_t n>
+  void BenchmarkBatchGemm(const std::string& type, std::size_t count)
+  {
+    using MatrixType = TMLStaticMatrix<ET, n, n>;
+    TMatrixArray<MatrixType> a(count), b(count), c(count);
+    TMLMatrixBatch<ET, n, n> ab(count), bb(count), cb(count);
+    for (std::size_t i = 0; i < count; i++)
+    {
+      FillRandom(a[i], static_cast<unsigned int>(2 * i));
+      FillRandom(b[i], static_cast<unsigned int>(2 * i + 1));
+      ab.Set(i, a[i]);
+      bb.Set(i, b[i]);
+    }
+
+    const double products = static_cast<double>(count) / 1e6;
+    PrintResult("per call " + type, n, products / MeasureRuntime([&]() {
+      for (std::size_t i = 0; i < count; i++)
+        c[i] = a[i] * b[i];
+    }), "M products/s");
+    PrintResult("batched array " + type, n, products / MeasureRuntime([&]() {
+      MLBatchMul(c.data(), a.data(), b.data(), count);
+    }), "M products/s");
+    PrintResult("batched interleaved " + type, n, products / MeasureRuntime([&]() {
+      MLBatchMul(cb, ab, bb);
+    }), "M products/s");
+  }
+
+  template<typename ET>
+  void BenchmarkBatchGemmSizes(const std::string& type)
+  {
+    constexpr std::size_t count = 4096;
+    BenchmarkBatchGemm<ET, 3>(type, count);
+    BenchmarkBatchGemm<ET, 4>(type, count);
+    BenchmarkBatchGemm<ET, 8>(type, count);
+    BenchmarkBatchGemm<ET, 16>(type, count);
+  }
+}
+
+void RunBatchGemmBenchmarks()
+{
+  PrintHeader("Batched GEMM of 4096 static matrix pairs");
+  BenchmarkBatchGemmSizes<float>("float");
+  BenchmarkBatchGemmSizes<double>("double");
+}
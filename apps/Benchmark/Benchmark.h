@@ -0,0 +1,80 @@
+// Copyright 2021, Philipp Neufeld
+
+#ifndef ML_APPS_Benchmark_H_
+#define ML_APPS_Benchmark_H_
+
+#include <chrono>
+#include <string>
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <complex>
+#include <algorithm>
+#include <cstddef>
+
+// Benchmark suites (selected by name on the command line)
+void RunGemmBenchmarks();
+void RunBatchGemmBenchmarks();
+void RunStrassenBenchmarks();
+void RunElementwiseBenchmarks();
+void RunTransposeBenchmarks();
+void RunViewBenchmarks();
+void RunReduceBenchmarks();
+void RunMathBenchmarks();
+void RunMemoryBenchmarks();
+
+// Tools (only run if they are selected)
+void RunGemmTuning();
+
+// Runs func repeatedly until the time budget (in seconds) is used up and
+// returns the fastest runtime in seconds (func runs at least three times)
+template<typename Func>
+double MeasureRuntime(Func func, double budget = 0.5)
+{
+  using Clock = std::chrono::high_resolution_clock;
+
+  double tmin = 1e300;
+  auto tstart = Clock::now();
+  for (std::size_t runs = 0; runs < 3 || std::chrono::duration<double>(Clock::now() - tstart).count() < budget; runs++)
+  {
+    auto ts = Clock::now();
+    func();
+    tmin = std::min(tmin, std::chrono::duration<double>(Clock::now() - ts).count());
+  }
+  return tmin;
+}
+
+// Random numbers in [-1, 1]
+template<typename T>
+struct TRandomValue
+{
+  template<typename Gen> static T Get(Gen& gen) { return static_cast<T>(std::uniform_real_distribution<double>(-1.0, 1.0)(gen)); }
+};
+template<typename T>
+struct TRandomValue<std::complex<T>>
+{
+  template<typename Gen> static std::complex<T> Get(Gen& gen) { return { TRandomValue<T>::Get(gen), TRandomValue<T>::Get(gen) }; }
+};
+
+template<typename MT>
+void FillRandom(MT& mat, unsigned int seed = 42)
+{
+  std::mt19937 gen(seed);
+  for (std::size_t i = 0; i < mat.Rows(); i++)
+    for (std::size_t j = 0; j < mat.Cols(); j++)
+      mat(i, j) = TRandomValue<typename MT::ElementType>::Get(gen);
+}
+
+// Output
+inline void PrintHeader(const std::string& title)
+{
+  std::cout << std::endl << "== " << title << " ==" << std::endl;
+}
+
+inline void PrintResult(const std::string& name, std::size_t n, double value, const std::string& unit)
+{
+  std::cout << std::left << std::setw(40) << name << std::right << std::setw(8) << n
+    << std::setw(12) << std::fixed << std::setprecision(2) << value << " " << unit << std::endl;
+}
+
+#endif
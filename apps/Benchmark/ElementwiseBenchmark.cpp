@@ -0,0 +1,176 @@
+#include <string>
+#include <complex>
+
+#include <MatrixLibrary/Math/Matrix.h>
+
+#include "Benchmark.h"
+
+using namespace ML;
+
+namespace
+{
+  // Scalar reference (element by element through operator())
+  template<typename C, typename A, typename B>
+  void NaiveAdd(C& c, const A& a, const B& b)
+  {
+    for (std::size_t i = 0; i < c.Rows(); i++)
+      for (std::size_t j = 0; j < c.Cols(); j++)
+        c(i, j) = a(i, j) + b(i, j);
+  }
+
+  // C = A + B with the operand layouts given by the template arguments. The rate is
+  // the memory traffic of the addition (two matrices read, one written) per second.
+  template<typename ET, bool rowMajorA, bool rowMajorB>
+  void BenchmarkAdd(const std::string& name, std::size_t n, bool withReference)
+  {
+    TMLDynamicMatrix<ET, rowMajorA> a(n, n);
+    TMLDynamicMatrix<ET, rowMajorB> b(n, n);
+    TMLDynamicMatrix<ET> c(n, n);
+    FillRandom(a, 1);
+    FillRandom(b, 2);
+
+    const double bytes = 3.0 * sizeof(ET) * n * n;
+    if (withReference)
+      PrintResult("naive " + name, n, bytes / MeasureRuntime([&]() { NaiveAdd(c, a, b); }) / 1e9, "GB/s");
+    PrintResult("ML " + name, n, bytes / MeasureRuntime([&]() { c = a + b; }) / 1e9, "GB/s");
+  }
+
+  // Other elementwise operations on row-major n x n matrices of doubles. naive computes one element
+  // from the elements of A and B, ml evaluates the expression, matrices is the number of matrices
+  // that are read or written.
+  template<typename Naive, typename ML>
+  void BenchmarkElementwise(const std::string& name, std::size_t n, std::size_t matrices, Naive naive, ML ml)
+  {
+    TMLDynamicMatrix<double> a(n, n);
+    TMLDynamicMatrix<double> b(n, n);
+    TMLDynamicMatrix<double> c(n, n);
+    FillRandom(a, 1);
+    FillRandom(b, 2);
+
+    auto reference = [&]() {
+      for (std::size_t i = 0; i < n; i++)
+        for (std::size_t j = 0; j < n; j++)
+          c(i, j) = naive(a(i, j), b(i, j));
+    };
+
+    const double bytes = static_cast<double>(matrices) * sizeof(double) * n * n;
+    PrintResult("naive " + name, n, bytes / MeasureRuntime(reference) / 1e9, "GB/s");
+    PrintResult("ML " + name, n, bytes / MeasureRuntime([&]() { ml(c, a, b); }) / 1e9, "GB/s");
+  }
+
+  // D = A + B + C - E as one fused expression and step by step with a temporary. The rate is the
+  // minimum memory traffic (four matrices read, one written), the step by step version moves 9 matrices.
+  void BenchmarkChain(std::size_t n)
+  {
+    TMLDynamicMatrix<double> a(n, n), b(n, n), c(n, n), e(n, n);
+    TMLDynamicMatrix<double> d(n, n), t(n, n);
+    FillRandom(a, 1);
+    FillRandom(b, 2);
+    FillRandom(c, 3);
+    FillRandom(e, 4);
+
+    auto reference = [&]() {
+      for (std::size_t i = 0; i < n; i++)
+        for (std::size_t j = 0; j < n; j++)
+          d(i, j) = a(i, j) + b(i, j) + c(i, j) - e(i, j);
+    };
+    auto steps = [&]() {
+      t = a + b;
+      t = t + c;
+      d = t - e;
+    };
+
+    const double bytes = 5.0 * sizeof(double) * n * n;
+    PrintResult("naive D = A + B + C - E", n, bytes / MeasureRuntime(reference) / 1e9, "GB/s");
+    PrintResult("ML step by step", n, bytes / MeasureRuntime(steps) / 1e9, "GB/s");
+    PrintResult("ML D = A + B + C - E", n, bytes / MeasureRuntime([&]() { d = a + b + c - e; }) / 1e9, "GB/s");
+  }
+
+  // C = (A - mean) / std with a mean and a standard deviation per column, naive, with the vectors expanded
+  // to full matrices (what has to be done without broadcasts) and with the fused broadcast expression. The
+  // rate is the minimum memory traffic (A read, C written).
+  void BenchmarkNormalize(std::size_t n)
+  {
+    TMLDynamicMatrix<double> a(n, n), c(n, n), meanMat(n, n), stdMat(n, n);
+    TMLDynamicMatrix<double> mean(1, n), std(1, n);
+    FillRandom(a, 1);
+    FillRandom(mean, 2);
+    FillRandom(std, 3);
+    for (std::size_t i = 0; i < n; i++)
+    {
+      for (std::size_t j = 0; j < n; j++)
+      {
+        meanMat(i, j) = mean(0, j);
+        stdMat(i, j) = std(0, j);
+      }
+    }
+
+    auto reference = [&]() {
+      for (std::size_t i = 0; i < n; i++)
+        for (std::size_t j = 0; j < n; j++)
+          c(i, j) = (a(i, j) - mean(0, j)) / std(0, j);
+    };
+    auto broadcast = [&]() {
+      c = MLBroadcastDiv<EMLBroadcast::Columnwise>(MLBroadcastSub<EMLBroadcast::Columnwise>(a, mean), std);
+    };
+
+    const double bytes = 2.0 * sizeof(double) * n * n;
+    PrintResult("naive C = (A - mean) / std", n, bytes / MeasureRuntime(reference) / 1e9, "GB/s");
+    PrintResult("ML expanded vectors", n, bytes / MeasureRuntime([&]() { c = (a - meanMat) / stdMat; }) / 1e9, "GB/s");
+    PrintResult("ML broadcast", n, bytes / MeasureRuntime(broadcast) / 1e9, "GB/s");
+  }
+
+  // C = A + bias with a row vector (along the rows of A) and C = A % s with a column vector (one element
+  // per row of A), the rate is the traffic of A and C
+  void BenchmarkBroadcast(std::size_t n)
+  {
+    TMLDynamicMatrix<double> a(n, n), c(n, n);
+    TMLDynamicMatrix<double> bias(1, n), s(n, 1);
+    FillRandom(a, 1);
+    FillRandom(bias, 2);
+    FillRandom(s, 3);
+
+    const double bytes = 2.0 * sizeof(double) * n * n;
+    PrintResult("ML C = A + bias (row vector)", n, bytes / 
+      MeasureRuntime([&]() { c = MLBroadcastAdd<EMLBroadcast::Columnwise>(a, bias); }) / 1e9, "GB/s");
+    PrintResult("ML C = A % s (column vector)", n, bytes / 
+      MeasureRuntime([&]() { c = MLBroadcastMul<EMLBroadcast::Rowwise>(a, s); }) / 1e9, "GB/s");
+  }
+}
+
+void RunElementwiseBenchmarks()
+{
+  PrintHeader("Addition C = A + B (C row-major)");
+  for (std::size_t n : { 64, 256, 1024, 4096 })
+  {
+    BenchmarkAdd<float, true, true>("float", n, true);
+    BenchmarkAdd<double, true, true>("double", n, true);
+    BenchmarkAdd<std::complex<double>, true, true>("complex<double>", n, false);
+    BenchmarkAdd<float, true, false>("float, column-major B", n, true);
+    BenchmarkAdd<double, false, false>("double, column-major A, B", n, true);
+  }
+
+  PrintHeader("Elementwise operations (double, row-major)");
+  for (std::size_t n : { 256, 1024, 4096 })
+  {
+    BenchmarkElementwise("C = A - B", n, 3, 
+      [](double x, double y) { return x - y; }, [](auto& c, const auto& a, const auto& b) { c = a - b; });
+    BenchmarkElementwise("C = A % B", n, 3, 
+      [](double x, double y) { return x * y; }, [](auto& c, const auto& a, const auto& b) { c = a % b; });
+    BenchmarkElementwise("C = A / B", n, 3, 
+      [](double x, double y) { return x / y; }, [](auto& c, const auto& a, const auto& b) { c = a / b; });
+    BenchmarkElementwise("C = 2 * A", n, 2, 
+      [](double x, double) { return 2.0 * x; }, [](auto& c, const auto& a, const auto&) { c = 2.0 * a; });
+  }
+
+  PrintHeader("Nested expression (double, row-major, rate of the minimum traffic)");
+  for (std::size_t n : { 256, 1024, 4096 })
+    BenchmarkChain(n);
+
+  PrintHeader("Row and column broadcasts (double, row-major, rate of the minimum traffic)");
+  for (std::size_t n : { 256, 1024, 4096 })
+  {
+    BenchmarkBroadcast(n);
+    BenchmarkNormalize(n);
+  }
+}
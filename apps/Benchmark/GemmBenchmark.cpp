@@ -0,0 +1,248 @@
+#include <utility>
+#include <complex>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include <MatrixLibrary/Math/Matrix.h>
+
+#include "Benchmark.h"
+
+using namespace ML;
+
+namespace
+{
+  // Floating point operations per multiply-add
+  template<typename T> constexpr double FlopsPerMadd_v = 2.0;
+  template<typename T> constexpr double FlopsPerMadd_v<std::complex<T>> = 8.0;
+
+  // Scalar reference (i-k-j loop order, no explicit vectorization)
+  template<typename C, typename A, typename B>
+  void NaiveGemm(C& c, const A& a, const B& b)
+  {
+    c.SetZero();
+    for (std::size_t i = 0; i < c.Rows(); i++)
+      for (std::size_t k = 0; k < a.Cols(); k++)
+        for (std::size_t j = 0; j < c.Cols(); j++)
+          c(i, j) += a(i, k) * b(k, j);
+  }
+
+  template<typename ET>
+  void BenchmarkGemm(const std::string& type, std::size_t n, bool withReference)
+  {
+    TMLDynamicMatrix<ET> a(n, n), b(n, n), c(n, n);
+    FillRandom(a, 1);
+    FillRandom(b, 2);
+
+    const double flops = FlopsPerMadd_v<ET> * n * n * n;
+    if (withReference)
+      PrintResult("naive " + type, n, flops / MeasureRuntime([&]() { NaiveGemm(c, a, b); }) / 1e9, "GFlops");
+    PrintResult("ML " + type, n, flops / MeasureRuntime([&]() { c = a * b; }) / 1e9, "GFlops");
+  }
+
+  // C = relu(A * B + C + bias) with the epilogue fused into the kernel and as separate passes over C
+  template<typename ET>
+  void BenchmarkGemmEpilogue(const std::string& type, std::size_t n)
+  {
+    TMLDynamicMatrix<ET> a(n, n), b(n, n), c(n, n), t(n, n);
+    FillRandom(a, 1);
+    FillRandom(b, 2);
+    FillRandom(c, 3);
+    std::vector<ET> bias(n, ET(0.5));
+
+    const double flops = FlopsPerMadd_v<ET> * n * n * n;
+    PrintResult("separate " + type, n, flops / MeasureRuntime([&]() {
+      t = a * b;
+      c = t + c;
+      for (std::size_t i = 0; i < n; i++)
+        for (std::size_t j = 0; j < n; j++)
+          c(i, j) = std::max(c(i, j) + bias[j], ET(0));
+    }) / 1e9, "GFlops");
+    PrintResult("fused " + type, n, flops / MeasureRuntime([&]() {
+      c = (a * b).Scale(ET(1), ET(1)).ColBias(bias.data()).Activation(EMLActivation::ReLU);
+    }) / 1e9, "GFlops");
+  }
+
+  // D = A * B + C with a low inner dimension (the sweeps over C and D dominate) and the residual r = y - A * x.
+  // The product is materialized into a temporary (as the sum of the expressions used to be evaluated) or 
+  // accumulated into the result by one GEMM.
+  template<typename ET>
+  void BenchmarkGemmUpdate(const std::string& type, std::size_t n)
+  {
+    using MatrixType = TMLDynamicMatrix<ET>;
+    MatrixType a(n, 64), b(64, n), c(n, n), d(n, n);
+    MatrixType m(n, n), x(n, 1), y(n, 1), r(n, 1);
+    FillRandom(a, 1);
+    FillRandom(b, 2);
+    FillRandom(c, 3);
+    FillRandom(m, 4);
+    FillRandom(x, 5);
+    FillRandom(y, 6);
+
+    PrintResult("temporary A * B + C " + type, n, 1e3 * MeasureRuntime([&]() { d = MatrixType(a * b) + c; }), "ms");
+    PrintResult("fused A * B + C " + type, n, 1e3 * MeasureRuntime([&]() { d = a * b + c; }), "ms");
+    PrintResult("fused in-place C = A * B + C " + type, n, 1e3 * MeasureRuntime([&]() { c = a * b + c; }), "ms");
+    PrintResult("temporary y - A * x " + type, n, 1e3 * MeasureRuntime([&]() { r = y - MatrixType(m * x); }), "ms");
+    PrintResult("fused y - A * x " + type, n, 1e3 * MeasureRuntime([&]() { r = y - m * x; }), "ms");
+  }
+
+  // Matrix-vector products y = A * x of row- and column-major A and the rank-1 update A += x * y^T. The 
+  // rate is the size of A per second (A is read once by GEMV and read and written once by GER).
+  template<typename ET>
+  void BenchmarkGemv(const std::string& type, std::size_t n)
+  {
+    TMLDynamicMatrix<ET, true> a(n, n);
+    TMLDynamicMatrix<ET, false> at(n, n);
+    TMLDynamicMatrix<ET> x(n, 1), y(n, 1);
+    FillRandom(a, 1);
+    FillRandom(at, 1);
+    FillRandom(x, 2);
+
+    const double bytes = static_cast<double>(sizeof(ET) * n * n);
+    PrintResult("gemv row-major " + type, n, bytes / MeasureRuntime([&]() { y = a * x; }) / 1e9, "GB/s");
+    PrintResult("gemv column-major " + type, n, bytes / MeasureRuntime([&]() { y = at * x; }) / 1e9, "GB/s");
+    PrintResult("ger row-major " + type, n, 2 * bytes / MeasureRuntime([&]() { MLGer(a, x, y, ET(1e-3)); }) / 1e9, "GB/s");
+  }
+
+  // Product chains of tall and wide factors evaluated from left to right (step by step with temporaries)
+  // and as one expression, which picks the order with the fewest multiply-adds
+  template<typename ET>
+  void BenchmarkChain(const std::string& type, std::size_t n)
+  {
+    TMLDynamicMatrix<ET> a(n, 64), b(64, n), c(n, 64), x(n, 1);
+    TMLDynamicMatrix<ET> ab(n, n), abc(n, 64), y(n, 1), d(n, n);
+    FillRandom(a, 1);
+    FillRandom(b, 2);
+    FillRandom(c, 3);
+    FillRandom(x, 4);
+
+    PrintResult("left to right A * B * x " + type, n, 1e3 * MeasureRuntime([&]() { ab = a * b; y = ab * x; }), "ms");
+    PrintResult("chain A * B * x " + type, n, 1e3 * MeasureRuntime([&]() { y = a * b * x; }), "ms");
+    PrintResult("left to right A * B * C * B " + type, n, 1e3 * MeasureRuntime([&]() {
+      ab = a * b;
+      abc = ab * c;
+      d = abc * b;
+    }), "ms");
+    PrintResult("chain A * B * C * B " + type, n, 1e3 * MeasureRuntime([&]() { d = a * b * c * b; }), "ms");
+  }
+
+  // Classical product and Strassen-Winograd recursion with the given cutoff. The rate of the recursion is
+  // given as the classical flop count per second; the error is max|C - C_classical| / (max|A| * max|B|).
+  template<typename ET>
+  void BenchmarkStrassen(const std::string& type, std::size_t n, std::size_t cutoff)
+  {
+    TMLDynamicMatrix<ET> a(n, n), b(n, n), c(n, n), ref(n, n);
+    FillRandom(a, 1);
+    FillRandom(b, 2);
+    TMLStrassenWorkspace<ET> workspace;
+
+    const double flops = FlopsPerMadd_v<ET> * n * n * n;
+    const double classical = flops / MeasureRuntime([&]() { ref = a * b; }, 0.0) / 1e9;
+    const double strassen = flops / MeasureRuntime([&]() { c = (a * b).Strassen(cutoff, &workspace); }, 0.0) / 1e9;
+
+    double error = 0.0, maxA = 0.0, maxB = 0.0;
+    for (std::size_t i = 0; i < n; i++)
+    {
+      for (std::size_t j = 0; j < n; j++)
+      {
+        error = std::max(error, static_cast<double>(std::abs(c(i, j) - ref(i, j))));
+        maxA = std::max(maxA, static_cast<double>(std::abs(a(i, j))));
+        maxB = std::max(maxB, static_cast<double>(std::abs(b(i, j))));
+      }
+    }
+
+    const std::string name = type + " cutoff " + std::to_string(cutoff);
+    PrintResult("classical " + name, n, classical, "GFlops");
+    PrintResult("strassen " + name, n, strassen, "GFlops");
+    std::cout << "  levels " << workspace.Levels() << std::scientific << std::setprecision(2) 
+      << ", error " << error / (maxA * maxB) << " (bound " << workspace.ErrorBound() << ")" << std::endl;
+  }
+
+  std::string FormatTuning(const SMLGemmTuning& t)
+  {
+    return "tile " + std::to_string(t.mr) + "x" + std::to_string(t.regsB) + ", kc " + std::to_string(t.kc) +
+      ", mc " + std::to_string(t.mc) + ", nc " + std::to_string(t.nc) + ", small tile " + 
+      std::to_string(t.smallMR) + "x" + std::to_string(t.smallRegsB);
+  }
+
+  // Tunes the kernels of ET and compares the default parameters with the tuned ones
+  template<typename ET>
+  void TuneGemm(const std::string& type)
+  {
+    auto gflops = [](std::size_t n) {
+      TMLDynamicMatrix<ET> a(n, n), b(n, n), c(n, n);
+      FillRandom(a, 1);
+      FillRandom(b, 2);
+      return FlopsPerMadd_v<ET> * n * n * n / MeasureRuntime([&]() { c = a * b; }, 0.2) / 1e9;
+    };
+
+    const SMLGemmTuning before = MLGetGemmTuning<ET>();
+    const double smallBefore = gflops(32), largeBefore = gflops(512);
+    const SMLGemmTuning after = MLTuneGemm<ET>();
+    const double smallAfter = gflops(32), largeAfter = gflops(512);
+
+    std::cout << type << ": " << FormatTuning(before) << std::endl;
+    std::cout << std::string(type.size(), ' ') << "  " << FormatTuning(after) << std::endl;
+    PrintResult("before " + type, 32, smallBefore, "GFlops");
+    PrintResult("tuned " + type, 32, smallAfter, "GFlops");
+    PrintResult("before " + type, 512, largeBefore, "GFlops");
+    PrintResult("tuned " + type, 512, largeAfter, "GFlops");
+  }
+}
+
+void RunGemmBenchmarks()
+{
+  PrintHeader("GEMM C = A * B (square, row-major)");
+  for (std::size_t n : { 64, 128, 256, 512, 1024 })
+  {
+    BenchmarkGemm<float>("float", n, n <= 256);
+    BenchmarkGemm<double>("double", n, n <= 256);
+    BenchmarkGemm<std::complex<float>>("complex<float>", n, false);
+    BenchmarkGemm<std::complex<double>>("complex<double>", n, false);
+  }
+
+  PrintHeader("GEMM with epilogue C = relu(A * B + C + bias)");
+  for (std::size_t n : { 64, 128, 256, 512 })
+  {
+    BenchmarkGemmEpilogue<float>("float", n);
+    BenchmarkGemmEpilogue<double>("double", n);
+  }
+
+  PrintHeader("GEMV y = A * x and GER A += x * y^T");
+  for (std::size_t n : { 256, 1024, 4096 })
+  {
+    BenchmarkGemv<float>("float", n);
+    BenchmarkGemv<double>("double", n);
+  }
+
+  PrintHeader("GEMM update D = A * B + C (A: n x 64, B: 64 x n) and residual r = y - A * x");
+  for (std::size_t n : { 1024, 4096 })
+    BenchmarkGemmUpdate<double>("double", n);
+
+  PrintHeader("Product chains (A: n x 64, B: 64 x n, C: n x 64, x: n x 1)");
+  for (std::size_t n : { 1024, 4096 })
+    BenchmarkChain<double>("double", n);
+}
+
+void RunStrassenBenchmarks()
+{
+  PrintHeader("Strassen-Winograd vs classical GEMM (square, row-major)");
+  for (std::size_t n : { 1024, 2048, 4096 })
+  {
+    for (std::size_t cutoff : { 256, 512, 1024 })
+    {
+      if (cutoff < n)
+        BenchmarkStrassen<double>("double", n, cutoff);
+    }
+  }
+  BenchmarkStrassen<float>("float", 4096, 1024);
+}
+
+void RunGemmTuning()
+{
+  PrintHeader("GEMM autotuning (tuning file: " + Internal::MLGetGemmTuningFile() + ")");
+  TuneGemm<float>("float");
+  TuneGemm<double>("double");
+  TuneGemm<std::complex<float>>("complex<float>");
+  TuneGemm<std::complex<double>>("complex<double>");
+}
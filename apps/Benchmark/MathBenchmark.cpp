@@ -0,0 +1,70 @@
+#include <string>
+#include <cmath>
+
+#include <MatrixLibrary/Math/Matrix.h>
+
+#include "Benchmark.h"
+
+using namespace ML;
+
+namespace
+{
+  // One elementwise function of an n x n row-major matrix. std applies the standard library function
+  // through operator(), ML assigns the expression (evaluated with the vectorized approximation). The rate
+  // is in elements per second.
+  template<typename ET, typename Scalar, typename Expr>
+  void BenchmarkFunction(const std::string& name, std::size_t n, double lo, double hi, Scalar scalar, Expr expr)
+  {
+    TMLDynamicMatrix<ET> a(n, n), c(n, n);
+    std::mt19937 gen(1);
+    std::uniform_real_distribution<double> dist(lo, hi);
+    for (std::size_t i = 0; i < n; i++)
+      for (std::size_t j = 0; j < n; j++)
+        a(i, j) = static_cast<ET>(dist(gen));
+
+    auto scalarLoop = [&]() {
+      for (std::size_t i = 0; i < n; i++)
+        for (std::size_t j = 0; j < n; j++)
+          c(i, j) = scalar(a(i, j));
+    };
+
+    const double elements = static_cast<double>(n) * n;
+    PrintResult("std " + name, n, elements / MeasureRuntime(scalarLoop) / 1e9, "Gelem/s");
+    PrintResult("ML " + name, n, elements / MeasureRuntime([&]() { expr(c, a); }) / 1e9, "Gelem/s");
+  }
+
+  template<typename ET>
+  void BenchmarkFunctions(const std::string& type, std::size_t n)
+  {
+    BenchmarkFunction<ET>("exp " + type, n, -10.0, 10.0,
+      [](ET x) { return std::exp(x); }, [](TMLDynamicMatrix<ET>& c, const TMLDynamicMatrix<ET>& a) { c = MLExp(a); });
+    BenchmarkFunction<ET>("log " + type, n, 1e-3, 1e3,
+      [](ET x) { return std::log(x); }, [](TMLDynamicMatrix<ET>& c, const TMLDynamicMatrix<ET>& a) { c = MLLog(a); });
+    BenchmarkFunction<ET>("pow " + type, n, 1e-3, 1e3,
+      [](ET x) { return std::pow(x, ET(1.5)); }, [](TMLDynamicMatrix<ET>& c, const TMLDynamicMatrix<ET>& a) { c = MLPow(a, 1.5); });
+    BenchmarkFunction<ET>("sqrt " + type, n, 0.0, 1e3,
+      [](ET x) { return std::sqrt(x); }, [](TMLDynamicMatrix<ET>& c, const TMLDynamicMatrix<ET>& a) { c = MLSqrt(a); });
+    BenchmarkFunction<ET>("rsqrt " + type, n, 1e-3, 1e3,
+      [](ET x) { return ET(1) / std::sqrt(x); }, [](TMLDynamicMatrix<ET>& c, const TMLDynamicMatrix<ET>& a) { c = MLRsqrt(a); });
+    BenchmarkFunction<ET>("sin " + type, n, -100.0, 100.0,
+      [](ET x) { return std::sin(x); }, [](TMLDynamicMatrix<ET>& c, const TMLDynamicMatrix<ET>& a) { c = MLSin(a); });
+    BenchmarkFunction<ET>("cos " + type, n, -100.0, 100.0,
+      [](ET x) { return std::cos(x); }, [](TMLDynamicMatrix<ET>& c, const TMLDynamicMatrix<ET>& a) { c = MLCos(a); });
+    BenchmarkFunction<ET>("tanh " + type, n, -5.0, 5.0,
+      [](ET x) { return std::tanh(x); }, [](TMLDynamicMatrix<ET>& c, const TMLDynamicMatrix<ET>& a) { c = MLTanh(a); });
+    BenchmarkFunction<ET>("sigmoid " + type, n, -10.0, 10.0,
+      [](ET x) { return ET(1) / (ET(1) + std::exp(-x)); }, [](TMLDynamicMatrix<ET>& c, const TMLDynamicMatrix<ET>& a) { c = MLSigmoid(a); });
+    BenchmarkFunction<ET>("erf " + type, n, -3.0, 3.0,
+      [](ET x) { return std::erf(x); }, [](TMLDynamicMatrix<ET>& c, const TMLDynamicMatrix<ET>& a) { c = MLErf(a); });
+  }
+}
+
+void RunMathBenchmarks()
+{
+  PrintHeader("Elementwise math functions (row-major)");
+  for (std::size_t n : { 256, 1024 })
+  {
+    BenchmarkFunctions<float>("float", n);
+    BenchmarkFunctions<double>("double", n);
+  }
+}
@@ -0,0 +1,212 @@
+#include <string>
+#include <memory>
+#include <vector>
+#include <thread>
+
+#include <MatrixLibrary/Math/Matrix.h>
+#include <MatrixLibrary/Memory/MemoryPool.h>
+#include <MatrixLibrary/Memory/Arena.h>
+#include <MatrixLibrary/Memory/ScratchArena.h>
+#include <MatrixLibrary/Utility/DoNotOptimizeAway.h>
+
+#include "Benchmark.h"
+
+using namespace ML;
+
+namespace
+{
+  template<typename Alloc>
+  using TMatrix = TMLDynamicMatrix<double, true, 0xFFFFFFFF, true, Alloc>;
+
+  // Default allocator that counts its allocations
+  std::size_t allocationCount = 0;
+
+  template<typename T>
+  class TCountingAllocator : public TMLAlignedAllocator<T>
+  {
+  public:
+    TCountingAllocator() noexcept = default;
+    template<typename U>
+    TCountingAllocator(const TCountingAllocator<U>&) noexcept {}
+
+    T* allocate(std::size_t n) { return allocate(n, alignof(T)); }
+    T* allocate(std::size_t n, std::size_t alignment) { allocationCount++; return TMLAlignedAllocator<T>::allocate(n, alignment); }
+  };
+
+  // T = A + B into a new matrix per evaluation (e.g. a temporary inside a loop). reset runs after
+  // every evaluation (arenas give their memory back there). The rate is in evaluations per second.
+  template<typename Alloc, typename Reset>
+  void BenchmarkTemporary(const std::string& name, std::size_t n, const Alloc& alloc, Reset reset)
+  {
+    TMLDynamicMatrix<double> a(n, n), b(n, n);
+    FillRandom(a, 1);
+    FillRandom(b, 2);
+
+    constexpr std::size_t evaluations = 100;
+    auto run = [&]() {
+      for (std::size_t k = 0; k < evaluations; k++)
+      {
+        TMatrix<Alloc> t(n, n, MLNoneType{}, alloc);
+        t = a + b;
+        MLDoNotOptimizeAway(t(0, 0));
+        reset();
+      }
+    };
+    PrintResult(name, n, evaluations / MeasureRuntime(run) / 1e3, "k/s");
+  }
+
+  // Layers y = tanh(x * W + b) of a small network with a new matrix per step and layer (the shapes
+  // change from layer to layer). The rate is in forward passes per second.
+  template<typename Alloc, typename Reset>
+  void BenchmarkLayers(const std::string& name, std::size_t n, const Alloc& alloc, Reset reset)
+  {
+    const std::size_t widths[] = { n, 2 * n, n, n / 2 + 1 };
+    std::vector<TMLDynamicMatrix<double>> weights, biases;
+    for (std::size_t l = 0; l + 1 < 4; l++)
+    {
+      weights.emplace_back(widths[l], widths[l + 1]);
+      biases.emplace_back(1, widths[l + 1]);
+      FillRandom(weights.back(), static_cast<unsigned int>(l + 1));
+      FillRandom(biases.back(), static_cast<unsigned int>(l + 10));
+    }
+    TMatrix<Alloc> x(16, n, alloc);
+    FillRandom(x, 3);
+
+    auto run = [&]() {
+      TMatrix<Alloc> h(x);
+      for (std::size_t l = 0; l + 1 < 4; l++)
+      {
+        TMatrix<Alloc> z(h.Rows(), weights[l].Cols(), MLNoneType{}, alloc);
+        z = h * weights[l];
+        TMatrix<Alloc> y(z.Rows(), z.Cols(), MLNoneType{}, alloc);
+        y = MLTanh(MLBroadcastAdd<EMLBroadcast::Columnwise>(z, biases[l]));
+        h = std::move(y);
+      }
+      MLDoNotOptimizeAway(h(0, 0));
+    };
+    auto runAndReset = [&]() { run(); reset(); };
+    PrintResult(name, n, 1.0 / MeasureRuntime(runAndReset) / 1e3, "k/s");
+  }
+
+  // C = A + B into the same matrix with shapes that change in every evaluation (between n - 7 and n rows
+  // and columns). With shrink the memory is given back after every evaluation, so every shape change
+  // reallocates (as without capacity). Prints the evaluations per second and the allocations per evaluation.
+  void BenchmarkShapeChanges(const std::string& name, std::size_t n, bool shrink)
+  {
+    TMLDynamicMatrix<double> a(n, n), b(n, n);
+    FillRandom(a, 1);
+    FillRandom(b, 2);
+
+    constexpr std::size_t evaluations = 100;
+    TMatrix<TCountingAllocator<double>> c;
+    std::size_t allocations = 0, runs = 0;
+    auto run = [&]() {
+      const std::size_t count = allocationCount;
+      for (std::size_t k = 0; k < evaluations; k++)
+      {
+        const std::size_t rows = n - (k * 3) % 8, cols = n - (k * 5) % 8;
+        c = MLSubmatrix(a, 0, 0, rows, cols) + MLSubmatrix(b, 0, 0, rows, cols);
+        MLDoNotOptimizeAway(c(0, 0));
+        if (shrink)
+          c.ShrinkToFit();
+      }
+      allocations += allocationCount - count;
+      runs++;
+    };
+    PrintResult(name, n, evaluations / MeasureRuntime(run) / 1e3, "k/s");
+    PrintResult(name, n, static_cast<double>(allocations) / (runs * evaluations), "allocations/evaluation");
+  }
+
+  // Expressions with internal temporaries (a materialized operand and the packing buffers of the product, a
+  // copy of the aliased result) on several threads at the same time, each with its own matrices. With a
+  // scratch capacity of 0 all temporaries are allocated on the heap. The rate is the sum of all threads.
+  void BenchmarkScratch(const std::string& name, std::size_t n, std::size_t threads, std::size_t capacity)
+  {
+    const std::size_t previous = CMLScratchArena::GetDefaultCapacity();
+    CMLScratchArena::SetDefaultCapacity(capacity);
+
+    std::vector<double> rates(threads);
+    auto work = [&](std::size_t t) {
+      TMLDynamicMatrix<double> a(n, n), b(n, n), w(n, n), y(n, n);
+      FillRandom(a, static_cast<unsigned int>(t + 1));
+      FillRandom(b, static_cast<unsigned int>(t + 2));
+      FillRandom(w, static_cast<unsigned int>(t + 3));
+      TMLDynamicMatrix<double> x(a);
+
+      constexpr std::size_t evaluations = 10;
+      auto run = [&]() {
+        for (std::size_t k = 0; k < evaluations; k++)
+        {
+          y = ((a + b) * w).Threads(1);
+          x = MLTanh((x * w).Threads(1));
+          MLDoNotOptimizeAway(y(0, 0));
+          MLDoNotOptimizeAway(x(0, 0));
+        }
+      };
+      rates[t] = evaluations / MeasureRuntime(run);
+    };
+
+    std::vector<std::thread> workers;
+    for (std::size_t t = 1; t < threads; t++)
+      workers.emplace_back(work, t);
+    work(0);
+    for (auto& worker : workers)
+      worker.join();
+
+    double rate = 0.0;
+    for (double r : rates)
+      rate += r;
+    PrintResult(name, n, rate / 1e3, "k/s");
+    CMLScratchArena::SetDefaultCapacity(previous);
+  }
+
+  // Runs a workload with the default allocator, std::allocator (over-allocated for the alignment),
+  // a memory pool and an arena
+  template<typename Workload>
+  void BenchmarkAllocators(const std::string& name, std::size_t n, Workload workload)
+  {
+    auto none = []() {};
+    workload(name + " default", n, TMLAlignedAllocator<double>(), none);
+    workload(name + " std::allocator", n, std::allocator<double>(), none);
+
+    CMLMemoryPool pool;
+    workload(name + " pool", n, TMLPoolAllocator<double>(pool), none);
+
+    CMLArena arena(64 * 1024 * 1024);
+    workload(name + " arena", n, TMLArenaAllocator<double>(arena), [&]() { arena.Reset(); });
+  }
+}
+
+void RunMemoryBenchmarks()
+{
+  PrintHeader("Temporary T = A + B per evaluation (double, evaluations per second)");
+  for (std::size_t n : { 4, 16, 64, 256, 1024 })
+  {
+    BenchmarkAllocators("T = A + B", n, [](const std::string& name, std::size_t n, const auto& alloc, auto reset)
+      { BenchmarkTemporary(name, n, alloc, reset); });
+  }
+
+  PrintHeader("Network layers tanh(X * W + b) with 16 rows (double, passes per second)");
+  for (std::size_t n : { 16, 64, 256 })
+  {
+    BenchmarkAllocators("layers", n, [](const std::string& name, std::size_t n, const auto& alloc, auto reset)
+      { BenchmarkLayers(name, n, alloc, reset); });
+  }
+
+  PrintHeader("C = A + B with changing shapes (double, evaluations per second)");
+  for (std::size_t n : { 16, 64, 256, 1024 })
+  {
+    BenchmarkShapeChanges("C = A + B reuse capacity", n, false);
+    BenchmarkShapeChanges("C = A + B shrink to fit", n, true);
+  }
+
+  const std::size_t threads = std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+  PrintHeader("Y = (A + B) * W, X = tanh(X * W) on " + std::to_string(threads) + " threads (double, evaluations per second)");
+  for (std::size_t n : { 8, 32, 128 })
+  {
+    BenchmarkScratch("scratch arena 1 thread", n, 1, ML_MEMORY_SCRATCH_SIZE);
+    BenchmarkScratch("heap 1 thread", n, 1, 0);
+    BenchmarkScratch("scratch arena all threads", n, threads, ML_MEMORY_SCRATCH_SIZE);
+    BenchmarkScratch("heap all threads", n, threads, 0);
+  }
+}
@@ -0,0 +1,105 @@
+#include <string>
+#include <cmath>
+
+#include <MatrixLibrary/Math/Matrix.h>
+
+#include "Benchmark.h"
+
+using namespace ML;
+
+namespace
+{
+  // Keeps the results of the timed reductions alive
+  volatile double g_sink = 0.0;
+
+  // Total reductions of an n x n row-major matrix. naive folds the elements through operator(), the
+  // rate is the size of the matrix (or of both matrices for the dot product) per second.
+  template<typename ET>
+  void BenchmarkTotal(const std::string& type, std::size_t n)
+  {
+    TMLDynamicMatrix<ET> a(n, n), b(n, n);
+    FillRandom(a, 1);
+    FillRandom(b, 2);
+
+    auto naiveSum = [&]() {
+      ET s = ET(0);
+      for (std::size_t i = 0; i < n; i++)
+        for (std::size_t j = 0; j < n; j++)
+          s += a(i, j);
+      g_sink = static_cast<double>(s);
+    };
+    auto naiveMax = [&]() {
+      ET s = a(0, 0);
+      for (std::size_t i = 0; i < n; i++)
+        for (std::size_t j = 0; j < n; j++)
+          s = std::max(s, a(i, j));
+      g_sink = static_cast<double>(s);
+    };
+    auto naiveDot = [&]() {
+      ET s = ET(0);
+      for (std::size_t i = 0; i < n; i++)
+        for (std::size_t j = 0; j < n; j++)
+          s += a(i, j) * b(i, j);
+      g_sink = static_cast<double>(s);
+    };
+
+    const double bytes = static_cast<double>(sizeof(ET)) * n * n;
+    PrintResult("naive sum " + type, n, bytes / MeasureRuntime(naiveSum) / 1e9, "GB/s");
+    PrintResult("ML MLSum " + type, n, bytes / MeasureRuntime([&]() { g_sink = static_cast<double>(MLSum(a)); }) / 1e9, "GB/s");
+    PrintResult("ML MLCompensatedSum " + type, n, bytes / MeasureRuntime([&]() { g_sink = static_cast<double>(MLCompensatedSum(a)); }) / 1e9, "GB/s");
+    PrintResult("naive max " + type, n, bytes / MeasureRuntime(naiveMax) / 1e9, "GB/s");
+    PrintResult("ML MLMax " + type, n, bytes / MeasureRuntime([&]() { g_sink = static_cast<double>(MLMax(a)); }) / 1e9, "GB/s");
+    PrintResult("ML MLArgMax " + type, n, bytes / MeasureRuntime([&]() { g_sink = static_cast<double>(MLArgMax(a).row); }) / 1e9, "GB/s");
+    PrintResult("naive dot " + type, n, 2.0 * bytes / MeasureRuntime(naiveDot) / 1e9, "GB/s");
+    PrintResult("ML MLDot " + type, n, 2.0 * bytes / MeasureRuntime([&]() { g_sink = static_cast<double>(MLDot(a, b)); }) / 1e9, "GB/s");
+  }
+
+  // Row and column sums of an n x n row-major matrix (the row sums reduce contiguous lines, the column
+  // sums reduce across the lines)
+  void BenchmarkDirectional(std::size_t n)
+  {
+    TMLDynamicMatrix<double> a(n, n);
+    TMLDynamicMatrix<double, false> rows(n, 1);
+    TMLDynamicMatrix<double> cols(1, n);
+    FillRandom(a, 1);
+
+    auto naiveRows = [&]() {
+      for (std::size_t i = 0; i < n; i++)
+      {
+        double s = 0.0;
+        for (std::size_t j = 0; j < n; j++)
+          s += a(i, j);
+        rows(i, 0) = s;
+      }
+    };
+    auto naiveCols = [&]() {
+      for (std::size_t j = 0; j < n; j++)
+      {
+        double s = 0.0;
+        for (std::size_t i = 0; i < n; i++)
+          s += a(i, j);
+        cols(0, j) = s;
+      }
+    };
+
+    const double bytes = sizeof(double) * static_cast<double>(n) * n;
+    PrintResult("naive row sums", n, bytes / MeasureRuntime(naiveRows) / 1e9, "GB/s");
+    PrintResult("ML row sums", n, bytes / MeasureRuntime([&]() { rows = MLSum<EMLReduction::Rowwise>(a); }) / 1e9, "GB/s");
+    PrintResult("naive column sums", n, bytes / MeasureRuntime(naiveCols) / 1e9, "GB/s");
+    PrintResult("ML column sums", n, bytes / MeasureRuntime([&]() { cols = MLSum<EMLReduction::Columnwise>(a); }) / 1e9, "GB/s");
+  }
+}
+
+void RunReduceBenchmarks()
+{
+  PrintHeader("Total reductions (row-major)");
+  for (std::size_t n : { 64, 256, 1024, 4096 })
+  {
+    BenchmarkTotal<float>("float", n);
+    BenchmarkTotal<double>("double", n);
+  }
+
+  PrintHeader("Row and column sums (double, row-major)");
+  for (std::size_t n : { 64, 256, 1024, 4096 })
+    BenchmarkDirectional(n);
+}
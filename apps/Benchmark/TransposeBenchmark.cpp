@@ -0,0 +1,55 @@
+#include <string>
+#include <complex>
+
+#include <MatrixLibrary/Math/Matrix.h>
+
+#include "Benchmark.h"
+
+using namespace ML;
+
+namespace
+{
+  // Scalar reference (element by element through operator())
+  template<typename B, typename A>
+  void NaiveTranspose(B& b, const A& a)
+  {
+    for (std::size_t i = 0; i < a.Rows(); i++)
+      for (std::size_t j = 0; j < a.Cols(); j++)
+        b(j, i) = a(i, j);
+  }
+
+  // B = A^T of row-major matrices (rows x cols) through the scalar loop, the copy of the transposed view
+  // A.Transpose() (a column-major matrix assigned to a row-major one) and the transpose expression. The
+  // rate is the memory traffic (A read, B written) per second.
+  template<typename ET>
+  void BenchmarkTranspose(const std::string& type, std::size_t rows, std::size_t cols, bool inPlace)
+  {
+    TMLDynamicMatrix<ET> a(rows, cols), b(cols, rows);
+    FillRandom(a, 1);
+
+    const double bytes = 2.0 * sizeof(ET) * rows * cols;
+    PrintResult("naive " + type, rows, bytes / MeasureRuntime([&]() { NaiveTranspose(b, a); }) / 1e9, "GB/s");
+    PrintResult("view copy " + type, rows, bytes / MeasureRuntime([&]() { b = a.Transpose(); }) / 1e9, "GB/s");
+    PrintResult("ML " + type, rows, bytes / MeasureRuntime([&]() { b = MLTranspose(a); }) / 1e9, "GB/s");
+    if (inPlace)
+      PrintResult("ML in-place " + type, rows, bytes / MeasureRuntime([&]() { MLTransposeInPlace(a); }) / 1e9, "GB/s");
+  }
+}
+
+void RunTransposeBenchmarks()
+{
+  PrintHeader("Transpose B = A^T (square, row-major)");
+  for (std::size_t n : { 64, 256, 1024, 4096 })
+  {
+    BenchmarkTranspose<float>("float", n, n, true);
+    BenchmarkTranspose<double>("double", n, n, true);
+    BenchmarkTranspose<std::complex<double>>("complex<double>", n, n, true);
+  }
+
+  PrintHeader("Transpose B = A^T (A: n x 100, row-major)");
+  for (std::size_t n : { 4096, 65536 })
+  {
+    BenchmarkTranspose<float>("float", n, 100, false);
+    BenchmarkTranspose<double>("double", n, 100, false);
+  }
+}
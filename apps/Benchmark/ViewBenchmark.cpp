@@ -0,0 +1,105 @@
+#include <string>
+
+#include <MatrixLibrary/Math/Matrix.h>
+
+#include "Benchmark.h"
+
+using namespace ML;
+
+namespace
+{
+  // Copies the rows x cols block of src at (row, col) into dst and back
+  template<typename D, typename S>
+  void CopyOut(D& dst, const S& src, std::size_t row, std::size_t col)
+  {
+    for (std::size_t i = 0; i < dst.Rows(); i++)
+      for (std::size_t j = 0; j < dst.Cols(); j++)
+        dst(i, j) = src(row + i, col + j);
+  }
+  template<typename D, typename S>
+  void CopyBack(D& dst, const S& src, std::size_t row, std::size_t col)
+  {
+    for (std::size_t i = 0; i < src.Rows(); i++)
+      for (std::size_t j = 0; j < src.Cols(); j++)
+        dst(row + i, col + j) = src(i, j);
+  }
+
+  // C[blk] = C[blk] + 2 * A[blk] for all blocks of b x b elements of n x n matrices, with the blocks copied
+  // into matrices and back or addressed by views. The rate is the memory traffic of the update per second.
+  void BenchmarkBlockUpdate(std::size_t n, std::size_t b)
+  {
+    TMLDynamicMatrix<double> a(n, n), c(n, n);
+    TMLDynamicMatrix<double> ab(b, b), cb(b, b);
+    FillRandom(a, 1);
+    FillRandom(c, 2);
+
+    auto copied = [&]() {
+      for (std::size_t i = 0; i < n; i += b)
+      {
+        for (std::size_t j = 0; j < n; j += b)
+        {
+          CopyOut(ab, a, i, j);
+          CopyOut(cb, c, i, j);
+          cb = cb + 2.0 * ab;
+          CopyBack(c, cb, i, j);
+        }
+      }
+    };
+    auto viewed = [&]() {
+      for (std::size_t i = 0; i < n; i += b)
+      {
+        for (std::size_t j = 0; j < n; j += b)
+        {
+          auto cv = MLSubmatrix(c, i, j, b, b);
+          cv = cv + 2.0 * MLSubmatrix(a, i, j, b, b);
+        }
+      }
+    };
+
+    const double bytes = 3.0 * sizeof(double) * n * n;
+    PrintResult("copied blocks (b = " + std::to_string(b) + ")", n, bytes / MeasureRuntime(copied) / 1e9, "GB/s");
+    PrintResult("views (b = " + std::to_string(b) + ")", n, bytes / MeasureRuntime(viewed) / 1e9, "GB/s");
+  }
+
+  // C = A * B computed panel by panel: C[i, j] = A[rows i] * B[cols j] for blocks of b x b elements of C
+  void BenchmarkPanelGemm(std::size_t n, std::size_t b)
+  {
+    TMLDynamicMatrix<double> a(n, n), bm(n, n), c(n, n);
+    TMLDynamicMatrix<double> ap(b, n), bp(n, b), cb(b, b);
+    FillRandom(a, 1);
+    FillRandom(bm, 2);
+
+    auto copied = [&]() {
+      for (std::size_t i = 0; i < n; i += b)
+      {
+        CopyOut(ap, a, i, 0);
+        for (std::size_t j = 0; j < n; j += b)
+        {
+          CopyOut(bp, bm, 0, j);
+          cb = ap * bp;
+          CopyBack(c, cb, i, j);
+        }
+      }
+    };
+    auto viewed = [&]() {
+      for (std::size_t i = 0; i < n; i += b)
+        for (std::size_t j = 0; j < n; j += b)
+          MLSubmatrix(c, i, j, b, b) = MLSubmatrix(a, i, 0, b, n) * MLSubmatrix(bm, 0, j, n, b);
+    };
+
+    const double flops = 2.0 * n * n * n;
+    PrintResult("copied panels (b = " + std::to_string(b) + ")", n, flops / MeasureRuntime(copied) / 1e9, "GFLOP/s");
+    PrintResult("views (b = " + std::to_string(b) + ")", n, flops / MeasureRuntime(viewed) / 1e9, "GFLOP/s");
+  }
+}
+
+void RunViewBenchmarks()
+{
+  PrintHeader("Block update C[blk] += 2 * A[blk] (double, row-major)");
+  for (std::size_t b : { 64, 256 })
+    BenchmarkBlockUpdate(2048, b);
+
+  PrintHeader("Panel GEMM C[i, j] = A[i, :] * B[:, j] (double, row-major)");
+  for (std::size_t b : { 128, 256 })
+    BenchmarkPanelGemm(1024, b);
+}
@@ -0,0 +1,49 @@
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <utility>
+#include <iostream>
+
+#if defined(ML_RUNTIME_DISPATCH)
+#include <MatrixLibrary/Math/Kernels/Dispatch.h>
+#endif
+
+#include "Benchmark.h"
+
+// Usage: Benchmark [suite...]  (runs all suites if none is given)
+//        Benchmark tune        (tunes the GEMM kernels and writes the tuning file)
+int main(int argc, char** argv)
+{
+  const std::vector<std::pair<std::string, void(*)()>> suites = {
+    { "gemm", &RunGemmBenchmarks },
+    { "batch", &RunBatchGemmBenchmarks },
+    { "strassen", &RunStrassenBenchmarks },
+    { "elementwise", &RunElementwiseBenchmarks },
+    { "transpose", &RunTransposeBenchmarks },
+    { "views", &RunViewBenchmarks },
+    { "reductions", &RunReduceBenchmarks },
+    { "math", &RunMathBenchmarks },
+    { "memory", &RunMemoryBenchmarks },
+  };
+  const std::vector<std::pair<std::string, void(*)()>> tools = {
+    { "tune", &RunGemmTuning },
+  };
+
+#if defined(ML_RUNTIME_DISPATCH)
+  std::cout << "Runtime dispatch: " << ML::MLGetSIMDLevelName(ML::MLGetSIMDLevel()) << " kernels" << std::endl;
+#endif
+
+  std::vector<std::string> selected(argv + 1, argv + argc);
+  for (const auto& suite : suites)
+  {
+    if (selected.empty() || std::find(selected.begin(), selected.end(), suite.first) != selected.end())
+      suite.second();
+  }
+  for (const auto& tool : tools)
+  {
+    if (std::find(selected.begin(), selected.end(), tool.first) != selected.end())
+      tool.second();
+  }
+
+  return 0;
+}
@@ -0,0 +1,182 @@
+#include <string>
+#include <complex>
+#include <memory>
+#include <cstdint>
+
+#include <MatrixLibrary/Math/Matrix.h>
+#include <MatrixLibrary/Memory/MemoryPool.h>
+#include <MatrixLibrary/Memory/Arena.h>
+
+#include "UnitTest.h"
+
+using namespace ML;
+
+namespace
+{
+  // std::allocator that counts the blocks in use (it does not know about alignment, so the matrices
+  // over-allocate and align the block themselves)
+  struct SAllocationCounts
+  {
+    std::size_t allocations = 0;
+    std::size_t deallocations = 0;
+  };
+
+  inline SAllocationCounts& GetAllocationCounts()
+  {
+    static SAllocationCounts counts;
+    return counts;
+  }
+
+  template<typename T>
+  struct TCountingAllocator : std::allocator<T>
+  {
+    using value_type = T;
+    template<typename U> struct rebind { using other = TCountingAllocator<U>; };
+
+    TCountingAllocator() = default;
+    template<typename U>
+    TCountingAllocator(const TCountingAllocator<U>&) noexcept {}
+
+    T* allocate(std::size_t n) { GetAllocationCounts().allocations++; return std::allocator<T>::allocate(n); }
+    void deallocate(T* ptr, std::size_t n) noexcept { GetAllocationCounts().deallocations++; std::allocator<T>::deallocate(ptr, n); }
+  };
+
+  template<typename T, typename U>
+  bool operator==(const TCountingAllocator<T>&, const TCountingAllocator<U>&) noexcept { return true; }
+  template<typename T, typename U>
+  bool operator!=(const TCountingAllocator<T>&, const TCountingAllocator<U>&) noexcept { return false; }
+
+  // Is the storage aligned for the SIMD type of the matrix?
+  template<typename MT>
+  bool IsAligned(const MT& mat)
+  {
+    return reinterpret_cast<std::uintptr_t>(mat.Data()) % alignof(typename MT::SIMDType) == 0;
+  }
+
+  std::string AllocatorName(const std::string& what, const std::string& alloc, const std::string& type, std::size_t m, std::size_t n)
+  {
+    return what + " (" + alloc + ") " + type + " " + std::to_string(m) + "x" + std::to_string(n);
+  }
+
+  // Products, sums, transposes, copies and moves of matrices with the allocator Alloc give the results of
+  // matrices with the default allocator (the kernels are the same, so the results are identical)
+  template<typename ET, bool rowMajor, typename Alloc>
+  void TestWithAllocator(const std::string& type, const std::string& name, const Alloc& alloc)
+  {
+    using MT = TMLDynamicMatrix<ET, rowMajor, 0xFFFFFFFF, true, Alloc>;
+    const std::size_t shapes[][3] = { { 1, 1, 1 }, { 5, 3, 7 }, { 67, 45, 33 }, { 130, 97, 75 } };
+    for (const auto& s : shapes)
+    {
+      const std::size_t m = s[0], n = s[1], k = s[2];
+      MT a(m, k, alloc), b(k, n, alloc), c(m, n, alloc), d(m, n, alloc);
+      TMLDynamicMatrix<ET, rowMajor> a0(m, k), b0(k, n), d0(m, n), ref(m, n);
+      FillRandom(a, 1);
+      FillRandom(b, 2);
+      FillRandom(d, 3);
+      a0 = a;
+      b0 = b;
+      d0 = d;
+      Check(IsAligned(a) && IsAligned(b) && IsAligned(c), AllocatorName("alignment", name, type, m, n));
+
+      ref = a0 * b0;
+      c = a * b;
+      CheckClose(c, ref, 0.0, AllocatorName("C = A * B", name, type, m, n));
+      ref = a0 * b0 + d0;
+      c = a * b + d;
+      CheckClose(c, ref, 0.0, AllocatorName("C = A * B + D", name, type, m, n));
+      ref = d0 - ET(2) * d0;
+      c = d - ET(2) * d;
+      CheckClose(c, ref, 0.0, AllocatorName("C = D - 2 * D", name, type, m, n));
+
+      MT t(n, m, alloc);
+      t = MLTranspose(d);
+      Check(MaxDifference(MLTranspose(t), d0) == 0.0, AllocatorName("T = MLTranspose(D)", name, type, m, n));
+
+      // Copies use the allocator of the source, moves take the memory along
+      MT e(d);
+      Check(e.GetAllocator() == d.GetAllocator() && e.Data() != d.Data() && MaxDifference(e, d0) == 0.0,
+        AllocatorName("copy", name, type, m, n));
+      const ET* data = e.Data();
+      MT f(std::move(e));
+      Check(f.Data() == data && f.GetAllocator() == d.GetAllocator() && MaxDifference(f, d0) == 0.0,
+        AllocatorName("move", name, type, m, n));
+      MT g(alloc);
+      g = std::move(f);
+      Check(g.Data() == data && MaxDifference(g, d0) == 0.0, AllocatorName("move assignment", name, type, m, n));
+    }
+  }
+
+  template<typename ET>
+  void TestAllocators(const std::string& type)
+  {
+    {
+      CMLMemoryPool pool;
+      TestWithAllocator<ET, true>(type, "pool", TMLPoolAllocator<ET>(pool));
+      TestWithAllocator<ET, false>(type, "pool", TMLPoolAllocator<ET>(pool));
+    }
+    {
+      CMLArena arena(1 << 16);
+      TestWithAllocator<ET, true>(type, "arena", TMLArenaAllocator<ET>(arena));
+      TestWithAllocator<ET, false>(type, "arena", TMLArenaAllocator<ET>(arena));
+    }
+    TestWithAllocator<ET, true>(type, "std::allocator", std::allocator<ET>());
+
+    GetAllocationCounts() = SAllocationCounts();
+    TestWithAllocator<ET, true>(type, "counting std::allocator", TCountingAllocator<ET>());
+    const SAllocationCounts counts = GetAllocationCounts();
+    Check(counts.allocations > 0 && counts.allocations == counts.deallocations,
+      "allocations == deallocations (counting std::allocator) " + type);
+  }
+
+  // The pool hands out freed blocks again, the arena carves blocks out of its buffer until it is full
+  void TestResources()
+  {
+    CMLMemoryPool pool;
+    const double* first = nullptr;
+    {
+      TMLDynamicMatrix<double, true, 0xFFFFFFFF, true, TMLPoolAllocator<double>> a(17, 19, TMLPoolAllocator<double>(pool));
+      first = a.Data();
+    }
+    Check(pool.GetCachedBytes() >= 17 * 19 * sizeof(double), "pool caches freed blocks");
+    {
+      TMLDynamicMatrix<double, true, 0xFFFFFFFF, true, TMLPoolAllocator<double>> b(17, 19, TMLPoolAllocator<double>(pool));
+      Check(b.Data() == first && pool.GetCachedBytes() == 0, "pool reuses freed blocks");
+    }
+    pool.Release();
+    Check(pool.GetCachedBytes() == 0, "pool releases cached blocks");
+
+    CMLArena arena(64 * 1024);
+    using AT = TMLDynamicMatrix<float, true, 0xFFFFFFFF, true, TMLArenaAllocator<float>>;
+    {
+      AT a(16, 16, TMLArenaAllocator<float>(arena));
+      AT b(16, 16, TMLArenaAllocator<float>(arena));
+      Check(arena.Owns(a.Data()) && arena.Owns(b.Data()) && arena.GetUsed() >= 2 * 16 * 16 * sizeof(float),
+        "arena serves blocks from its buffer");
+      // Too large for the rest of the buffer: served from the heap
+      AT c(200, 200, TMLArenaAllocator<float>(arena));
+      Check(!arena.Owns(c.Data()) && IsAligned(c), "arena falls back to the heap");
+      c = a + b;
+      Check(c.Rows() == 16 && MaxDifference(c, a + b) == 0.0, "arena C = A + B");
+    }
+    // Blocks are given back in stack order
+    Check(arena.GetUsed() == 0, "arena rewinds in stack order");
+    arena.Reset();
+
+    // Static matrices of 16kB and more allocate from the allocator
+    TMLStaticMatrix<double, 64, 64, true, 64, TMLPoolAllocator<double>> s{ TMLPoolAllocator<double>(pool) };
+    TMLStaticMatrix<double, 64, 64> s0;
+    FillRandom(s, 1);
+    FillRandom(s0, 1);
+    TMLStaticMatrix<double, 64, 64> p = s * s;
+    TMLStaticMatrix<double, 64, 64> p0 = s0 * s0;
+    Check(IsAligned(s) && MaxDifference(p, p0) == 0.0, "static matrix with a pool allocator");
+  }
+}
+
+void RunAllocatorTests()
+{
+  TestAllocators<float>("float");
+  TestAllocators<double>("double");
+  TestAllocators<std::complex<double>>("complex<double>");
+  TestResources();
+}
@@ -0,0 +1,111 @@
+#include <new>
+#include <string>
+#include <complex>
+
+#include <MatrixLibrary/Math/Matrix.h>
+#include <MatrixLibrary/Memory/AlignedAlloc.h>
+
+#include "UnitTest.h"
+
+using namespace ML;
+
+namespace
+{
+  // Array of count static matrices (std::vector does not respect the alignment of SIMD types before C++17)
+  template<typename MT>
+  class TMatrixArray
+  {
+  public:
+    explicit TMatrixArray(std::size_t count) : m_array(count, alignof(MT))
+    {
+      for (std::size_t i = 0; i < count; i++)
+        new (m_array.data() + i) MT();
+    }
+
+    MT* data() noexcept { return m_array.data(); }
+    MT& operator[](std::size_t i) noexcept { return m_array.data()[i]; }
+
+  private:
+    TMLAlignedArray<MT> m_array;
+  };
+
+  // Numbers of products that fill no packet, some packets and a partial last packet
+  const std::size_t g_counts[] = { 1, 3, 17, 70 };
+
+  template<std::size_t n, std::size_t k, std::size_t m>
+  std::string BatchName(const std::string& type, std::size_t count)
+  {
+    return type + " " + std::to_string(count) + " x (" + std::to_string(n) + "x" + std::to_string(k) + " * " +
+      std::to_string(k) + "x" + std::to_string(m) + ")";
+  }
+
+  // Batched products of the interleaved layout and of arrays of static matrices (with the given layouts of
+  // C, A and B) against one scalar reference per product
+  template<typename ET, std::size_t n, std::size_t k, std::size_t m, bool rowMajorC, bool rowMajorA, bool rowMajorB>
+  void TestBatchMul(const std::string& type)
+  {
+    using MatrixC = TMLStaticMatrix<ET, n, m, rowMajorC>;
+    using MatrixA = TMLStaticMatrix<ET, n, k, rowMajorA>;
+    using MatrixB = TMLStaticMatrix<ET, k, m, rowMajorB>;
+    const std::string layout = std::string(rowMajorA ? "R" : "C") + (rowMajorB ? "R" : "C") + (rowMajorC ? "R" : "C");
+
+    for (std::size_t count : g_counts)
+    {
+      const std::string name = BatchName<n, k, m>(type, count);
+      TMatrixArray<MatrixA> a(count);
+      TMatrixArray<MatrixB> b(count);
+      TMatrixArray<MatrixC> c(count), ref(count);
+      TMLMatrixBatch<ET, n, k> ab(count);
+      TMLMatrixBatch<ET, k, m> bb(count);
+      TMLMatrixBatch<ET, n, m> cb(count);
+      for (std::size_t l = 0; l < count; l++)
+      {
+        FillRandom(a[l], static_cast<unsigned int>(2 * l));
+        FillRandom(b[l], static_cast<unsigned int>(2 * l + 1));
+        NaiveGemm(ref[l], a[l], b[l]);
+        ab.Set(l, a[l]);
+        bb.Set(l, b[l]);
+      }
+
+      MLBatchMul(c.data(), a.data(), b.data(), count);
+      double diffArray = 0.0, diffBatch = 0.0;
+      for (std::size_t l = 0; l < count; l++)
+        diffArray = std::max(diffArray, MaxDifference(c[l], ref[l]));
+      Check(diffArray <= GemmTolerance<ET>(k), "MLBatchMul(array) " + layout + " " + name);
+
+      MLBatchMul(cb, ab, bb);
+      bool roundTrip = true;
+      for (std::size_t l = 0; l < count; l++)
+      {
+        diffBatch = std::max(diffBatch, MaxDifference(cb.Get(l), ref[l]));
+        roundTrip = roundTrip && MaxDifference(ab.Get(l), a[l]) == 0.0;
+      }
+      Check(diffBatch <= GemmTolerance<ET>(k), "MLBatchMul(batch) " + name);
+      Check(roundTrip, "TMLMatrixBatch Set/Get " + name);
+    }
+  }
+
+  // Matrices with short rows (interleaved kernel) and with rows that fill SIMD registers (kernel per product)
+  template<typename ET>
+  void TestBatchMulShapes(const std::string& type)
+  {
+    TestBatchMul<ET, 1, 1, 1, true, true, true>(type);
+    TestBatchMul<ET, 2, 2, 2, true, true, true>(type);
+    TestBatchMul<ET, 3, 3, 3, true, true, true>(type);
+    TestBatchMul<ET, 3, 3, 3, false, true, false>(type);
+    TestBatchMul<ET, 4, 4, 4, true, false, true>(type);
+    TestBatchMul<ET, 3, 5, 2, true, true, true>(type);
+    TestBatchMul<ET, 5, 2, 7, false, false, false>(type);
+    TestBatchMul<ET, 8, 8, 8, true, true, true>(type);
+    TestBatchMul<ET, 16, 16, 16, true, true, true>(type);
+    TestBatchMul<ET, 6, 9, 16, true, false, true>(type);
+  }
+}
+
+void RunBatchTests()
+{
+  TestBatchMulShapes<float>("float");
+  TestBatchMulShapes<double>("double");
+  TestBatchMulShapes<std::complex<float>>("complex<float>");
+  TestBatchMulShapes<std::complex<double>>("complex<double>");
+}
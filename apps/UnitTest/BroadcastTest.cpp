@@ -0,0 +1,180 @@
+#include <string>
+#include <complex>
+#include <cstdint>
+
+#include <MatrixLibrary/Math/Matrix.h>
+
+#include "UnitTest.h"
+
+using namespace ML;
+
+namespace
+{
+  // Vectors, shapes with masked tails in both layouts and shapes above the blocks of the transposing kernel
+  const std::size_t g_broadcastShapes[][2] = { { 1, 1 }, { 1, 37 }, { 37, 1 }, { 3, 5 }, { 17, 33 }, { 65, 129 }, { 300, 257 } };
+
+  std::string BroadcastName(const std::string& what, const std::string& layout, const std::string& type, std::size_t m, std::size_t n)
+  {
+    return what + " " + layout + " " + type + " " + std::to_string(m) + "x" + std::to_string(n);
+  }
+
+  // Scalar reference c(i, j) = op(a(i, j), v(i)) (rowwise) or op(a(i, j), v(j))
+  template<typename C, typename A, typename V, typename Op>
+  void NaiveBroadcast(C& c, const A& a, const V& v, bool rowwise, Op op)
+  {
+    for (std::size_t i = 0; i < c.Rows(); i++)
+      for (std::size_t j = 0; j < c.Cols(); j++)
+        c(i, j) = op(a(i, j), rowwise ? v(i, 0) : v(0, j));
+  }
+
+  // Complex products and quotients are not computed like std::complex does
+  template<typename ET>
+  double BroadcastTolerance() { return 0.0; }
+  template<>
+  double BroadcastTolerance<std::complex<double>>() { return 8.0 * Epsilon<double>(); }
+
+  // C = op(A, v) in both directions for the layouts of A and C, with a contiguous vector (the layout of a
+  // reduction result) and with a strided vector (a padded m x 1 row-major or 1 x n column-major matrix)
+  template<typename ET, bool rowMajorA, bool rowMajorC, bool division>
+  void TestBroadcast(const std::string& type)
+  {
+    const std::string layout = std::string(rowMajorA ? "R" : "C") + (rowMajorC ? "R" : "C");
+    const double tolerance = BroadcastTolerance<ET>();
+    for (const auto& shape : g_broadcastShapes)
+    {
+      const std::size_t m = shape[0], n = shape[1];
+      TMLDynamicMatrix<ET, rowMajorA> a(m, n);
+      TMLDynamicMatrix<ET, rowMajorC> c(m, n);
+      TMLDynamicMatrix<ET> ref(m, n);
+      // Contiguous and strided vectors with the same elements (divisors away from zero)
+      TMLDynamicMatrix<ET, false> col(m, 1);
+      TMLDynamicMatrix<ET, true> row(1, n), colStrided(m, 1);
+      TMLDynamicMatrix<ET, false> rowStrided(1, n);
+      FillRandom(a, 1);
+      FillRandom(col, 2);
+      FillRandom(row, 3);
+      for (std::size_t i = 0; i < m; i++)
+        col(i, 0) += ET(3);
+      for (std::size_t j = 0; j < n; j++)
+        row(0, j) += ET(3);
+      colStrided = col;
+      rowStrided = row;
+
+      const auto add = [](ET x, ET y) { return x + y; };
+      const auto sub = [](ET x, ET y) { return x - y; };
+      const auto mul = [](ET x, ET y) { ET r(0); MulAdd(r, x, y); return r; };
+      const auto div = [](ET x, ET y) { return x / y; };
+
+      NaiveBroadcast(ref, a, col, true, add);
+      c = MLBroadcastAdd<EMLBroadcast::Rowwise>(a, col);
+      CheckClose(c, ref, 0.0, BroadcastName("MLBroadcastAdd<Rowwise>", layout, type, m, n));
+      c = MLBroadcastAdd<EMLBroadcast::Rowwise>(a, colStrided);
+      CheckClose(c, ref, 0.0, BroadcastName("MLBroadcastAdd<Rowwise> (strided)", layout, type, m, n));
+      NaiveBroadcast(ref, a, row, false, add);
+      c = MLBroadcastAdd<EMLBroadcast::Columnwise>(a, row);
+      CheckClose(c, ref, 0.0, BroadcastName("MLBroadcastAdd<Columnwise>", layout, type, m, n));
+      c = MLBroadcastAdd<EMLBroadcast::Columnwise>(a, rowStrided);
+      CheckClose(c, ref, 0.0, BroadcastName("MLBroadcastAdd<Columnwise> (strided)", layout, type, m, n));
+
+      NaiveBroadcast(ref, a, col, true, sub);
+      c = MLBroadcastSub<EMLBroadcast::Rowwise>(a, col);
+      CheckClose(c, ref, 0.0, BroadcastName("MLBroadcastSub<Rowwise>", layout, type, m, n));
+      NaiveBroadcast(ref, a, row, false, sub);
+      c = MLBroadcastSub<EMLBroadcast::Columnwise>(a, rowStrided);
+      CheckClose(c, ref, 0.0, BroadcastName("MLBroadcastSub<Columnwise> (strided)", layout, type, m, n));
+
+      NaiveBroadcast(ref, a, col, true, mul);
+      c = MLBroadcastMul<EMLBroadcast::Rowwise>(a, colStrided);
+      CheckClose(c, ref, tolerance, BroadcastName("MLBroadcastMul<Rowwise> (strided)", layout, type, m, n));
+      NaiveBroadcast(ref, a, row, false, mul);
+      c = MLBroadcastMul<EMLBroadcast::Columnwise>(a, row);
+      CheckClose(c, ref, tolerance, BroadcastName("MLBroadcastMul<Columnwise>", layout, type, m, n));
+
+      if (division)
+      {
+        NaiveBroadcast(ref, a, col, true, div);
+        c = MLBroadcastDiv<EMLBroadcast::Rowwise>(a, col);
+        CheckClose(c, ref, tolerance, BroadcastName("MLBroadcastDiv<Rowwise>", layout, type, m, n));
+        NaiveBroadcast(ref, a, row, false, div);
+        c = MLBroadcastDiv<EMLBroadcast::Columnwise>(a, row);
+        CheckClose(c, ref, tolerance, BroadcastName("MLBroadcastDiv<Columnwise>", layout, type, m, n));
+      }
+    }
+  }
+
+  // Broadcasts of expressions (fused into one pass), vectors that are expressions (evaluated first) and
+  // results that are the matrix (in place) or hold the vector (through a temporary)
+  template<typename ET, bool rowMajor>
+  void TestBroadcastExpressions(const std::string& type)
+  {
+    const std::string layout = rowMajor ? "R" : "C";
+    for (const auto& shape : g_broadcastShapes)
+    {
+      const std::size_t m = shape[0], n = shape[1];
+      TMLDynamicMatrix<ET, rowMajor> a(m, n), b(m, n), c(m, n);
+      TMLDynamicMatrix<ET> ref(m, n), tmp(m, n);
+      TMLDynamicMatrix<ET> mean(1, n), scale(1, n);
+      FillRandom(a, 1);
+      FillRandom(b, 2);
+      FillRandom(mean, 3);
+      FillRandom(scale, 4);
+      for (std::size_t j = 0; j < n; j++)
+        scale(0, j) += ET(3);
+
+      // (A + B - mean) / scale
+      for (std::size_t i = 0; i < m; i++)
+        for (std::size_t j = 0; j < n; j++)
+          ref(i, j) = (a(i, j) + b(i, j) - mean(0, j)) / scale(0, j);
+      c = MLBroadcastDiv<EMLBroadcast::Columnwise>(MLBroadcastSub<EMLBroadcast::Columnwise>(a + b, mean), scale);
+      CheckClose(c, ref, 0.0, BroadcastName("(A + B - mean) / scale", layout, type, m, n));
+
+      // The vector is a reduction (row sums)
+      TMLDynamicMatrix<ET> sums(m, 1);
+      for (std::size_t i = 0; i < m; i++)
+      {
+        sums(i, 0) = ET(0);
+        for (std::size_t j = 0; j < n; j++)
+          sums(i, 0) += a(i, j);
+      }
+      NaiveBroadcast(ref, a, sums, true, [](ET x, ET y) { return x - y; });
+      c = MLBroadcastSub<EMLBroadcast::Rowwise>(a, MLSum<EMLReduction::Rowwise>(a));
+      CheckClose(c, ref, 2.0 * static_cast<double>(n) * Epsilon<ET>(), BroadcastName("A - MLSum<Rowwise>(A)", layout, type, m, n));
+
+      // In place
+      NaiveBroadcast(ref, a, mean, false, [](ET x, ET y) { return x * y; });
+      c = a;
+      c = MLBroadcastMul<EMLBroadcast::Columnwise>(c, mean);
+      CheckClose(c, ref, 0.0, BroadcastName("A = MLBroadcastMul<Columnwise>(A, v)", layout, type, m, n));
+
+      // The vector is the first column of the result
+      c = a;
+      for (std::size_t i = 0; i < m; i++)
+        tmp(i, 0) = a(i, 0);
+      NaiveBroadcast(ref, a, tmp, true, [](ET x, ET y) { return x + y; });
+      c = MLBroadcastAdd<EMLBroadcast::Rowwise>(c, MLColumn(c, 0));
+      CheckClose(c, ref, 0.0, BroadcastName("A = MLBroadcastAdd<Rowwise>(A, Column(A, 0))", layout, type, m, n));
+    }
+  }
+
+  template<typename ET, bool division>
+  void TestBroadcastLayouts(const std::string& type)
+  {
+    TestBroadcast<ET, true, true, division>(type);
+    TestBroadcast<ET, false, false, division>(type);
+    TestBroadcast<ET, true, false, division>(type);
+    TestBroadcast<ET, false, true, division>(type);
+  }
+}
+
+void RunBroadcastTests()
+{
+  TestBroadcastLayouts<float, true>("float");
+  TestBroadcastLayouts<double, true>("double");
+  TestBroadcastLayouts<std::complex<double>, true>("complex<double>");
+  TestBroadcastLayouts<std::int32_t, false>("int32");
+
+  TestBroadcastExpressions<float, true>("float");
+  TestBroadcastExpressions<float, false>("float");
+  TestBroadcastExpressions<double, true>("double");
+  TestBroadcastExpressions<double, false>("double");
+}
@@ -0,0 +1,120 @@
+#include <string>
+#include <complex>
+
+#include <MatrixLibrary/Math/Matrix.h>
+
+#include "UnitTest.h"
+
+using namespace ML;
+
+namespace
+{
+  // Shapes that shrink and grow in both dimensions (the spacing changes with the shape)
+  const std::size_t g_capacityShapes[][2] = { { 40, 33 }, { 7, 5 }, { 33, 40 }, { 1, 1 }, { 17, 3 }, { 41, 41 }, { 3, 70 }, { 60, 45 } };
+
+  std::string CapacityName(const std::string& what, const std::string& layout, const std::string& type, std::size_t m, std::size_t n)
+  {
+    return what + " " + layout + " " + type + " " + std::to_string(m) + "x" + std::to_string(n);
+  }
+
+  // Elements of a matrix of the given shape (with padding)
+  template<typename MT>
+  std::size_t StorageSize(const MT& mat)
+  {
+    return mat.PaddedRows() * mat.PaddedCols();
+  }
+
+  // One result matrix for expressions of changing shapes against the scalar reference: the memory is kept
+  // while the shapes fit into the capacity and the capacity grows by at least half otherwise
+  template<typename ET, bool rowMajor, bool padded>
+  void TestResize(const std::string& type)
+  {
+    const std::string layout = std::string(rowMajor ? "R" : "C") + (padded ? "" : " unpadded");
+    using MT = TMLDynamicMatrix<ET, rowMajor, 0xFFFFFFFF, padded>;
+    MT c;
+    for (const auto& shape : g_capacityShapes)
+    {
+      const std::size_t m = shape[0], n = shape[1];
+      MT a(m, n), b(m, n);
+      TMLDynamicMatrix<ET> ref(m, n);
+      FillRandom(a, 1);
+      FillRandom(b, 2);
+      for (std::size_t i = 0; i < m; i++)
+        for (std::size_t j = 0; j < n; j++)
+          ref(i, j) = a(i, j) + b(i, j);
+
+      const std::size_t capacity = c.Capacity();
+      const ET* data = c.Data();
+      c = a + b;
+      CheckClose(c, ref, 0.0, CapacityName("C = A + B", layout, type, m, n));
+      if (StorageSize(c) <= capacity)
+        Check(c.Data() == data && c.Capacity() == capacity, CapacityName("memory kept", layout, type, m, n));
+      else
+        Check(c.Capacity() >= StorageSize(c) && c.Capacity() >= capacity + capacity / 2, CapacityName("capacity grows", layout, type, m, n));
+
+      // Products into a matrix that holds another shape (and padding) before
+      MT p;
+      p = c;
+      p = a * MLTranspose(b);
+      TMLDynamicMatrix<ET> pref(m, m);
+      NaiveGemm(pref, a, MLTranspose(b));
+      CheckClose(p, pref, GemmTolerance<ET>(n), CapacityName("P = A * B^T", layout, type, m, n));
+
+      // Resize zeros the elements, the expression assignment afterwards does not see old values
+      c.Resize(m, n);
+      Check(MaxDifference(c, TMLDynamicMatrix<ET>(m, n)) == 0.0, CapacityName("Resize zeros", layout, type, m, n));
+    }
+  }
+
+  // Reserve and ShrinkToFit keep the elements, copies reuse the memory of the destination
+  template<typename ET, bool rowMajor>
+  void TestReserve(const std::string& type)
+  {
+    const std::string layout = rowMajor ? "R" : "C";
+    TMLDynamicMatrix<ET, rowMajor> a(17, 9), ref(17, 9);
+    FillRandom(a, 1);
+    ref = a;
+
+    a.Reserve(50, 60);
+    Check(a.Capacity() >= 50 * 60 && a.Rows() == 17 && MaxDifference(a, ref) == 0.0, CapacityName("Reserve", layout, type, 17, 9));
+    const ET* data = a.Data();
+    a.Resize(50, 60, MLNoneType{});
+    Check(a.Data() == data, CapacityName("Resize within the reserved capacity", layout, type, 50, 60));
+    a.Resize(17, 9, MLNoneType{});
+    a = ref;
+    a.ShrinkToFit();
+    Check(a.Capacity() == StorageSize(a) && MaxDifference(a, ref) == 0.0, CapacityName("ShrinkToFit", layout, type, 17, 9));
+    a.ShrinkToFit();
+    Check(a.Capacity() == StorageSize(a), CapacityName("ShrinkToFit twice", layout, type, 17, 9));
+
+    // Copy assignment of a smaller matrix keeps the memory, copy construction allocates what it needs
+    TMLDynamicMatrix<ET, rowMajor> big(40, 40);
+    data = big.Data();
+    big = ref;
+    Check(big.Data() == data && MaxDifference(big, ref) == 0.0, CapacityName("copy into larger matrix", layout, type, 17, 9));
+    const TMLDynamicMatrix<ET, rowMajor> copy(big);
+    Check(copy.Capacity() == StorageSize(copy) && MaxDifference(copy, ref) == 0.0, CapacityName("copy construction", layout, type, 17, 9));
+
+    // Empty matrices
+    TMLDynamicMatrix<ET, rowMajor> e;
+    e.ShrinkToFit();
+    Check(e.Capacity() == 0 && e.Rows() == 0, CapacityName("ShrinkToFit empty", layout, type, 0, 0));
+    e.Reserve(3, 3);
+    e.Resize(0, 0);
+    Check(e.Capacity() >= 9 && e.Rows() == 0 && e.Cols() == 0, CapacityName("Resize to empty", layout, type, 0, 0));
+    e.ShrinkToFit();
+    Check(e.Capacity() == 0, CapacityName("ShrinkToFit to empty", layout, type, 0, 0));
+  }
+}
+
+void RunCapacityTests()
+{
+  TestResize<float, true, true>("float");
+  TestResize<float, false, true>("float");
+  TestResize<double, true, false>("double");
+  TestResize<double, false, true>("double");
+  TestResize<std::complex<double>, true, true>("complex<double>");
+
+  TestReserve<float, true>("float");
+  TestReserve<double, false>("double");
+}
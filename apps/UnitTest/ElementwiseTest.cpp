@@ -0,0 +1,218 @@
+#include <string>
+#include <complex>
+#include <cstdint>
+
+#include <MatrixLibrary/Math/Matrix.h>
+
+#include "UnitTest.h"
+
+using namespace ML;
+
+namespace
+{
+  // Shapes below and above the blocks of the transposing kernel with dimensions that are not multiples
+  // of the SIMD width
+  const std::size_t g_elementwiseShapes[][2] = { { 1, 1 }, { 3, 5 }, { 17, 31 }, { 64, 64 }, { 65, 129 }, { 300, 257 } };
+
+  std::string ElementwiseName(const std::string& what, const std::string& layout, const std::string& type,
+    std::size_t m, std::size_t n)
+  {
+    return what + " " + layout + " " + type + " " + std::to_string(m) + "x" + std::to_string(n);
+  }
+
+  template<bool rowMajorA, bool rowMajorB, bool rowMajorC>
+  std::string LayoutName()
+  {
+    return std::string(rowMajorA ? "R" : "C") + (rowMajorB ? "R" : "C") + (rowMajorC ? "R" : "C");
+  }
+
+  // Scalar reference c(i, j) = op(a(i, j), b(i, j))
+  template<typename C, typename A, typename B, typename Op>
+  void NaiveElementwise(C& c, const A& a, const B& b, Op op)
+  {
+    for (std::size_t i = 0; i < c.Rows(); i++)
+      for (std::size_t j = 0; j < c.Cols(); j++)
+        c(i, j) = op(a(i, j), b(i, j));
+  }
+
+  // C = A + B for the given layouts (same layouts: SIMD kernel, mixed layouts: blocked transposing kernel).
+  // The kernels round like the scalar reference, i.e. the results are exact.
+  template<typename ET, bool rowMajorA, bool rowMajorB, bool rowMajorC>
+  void TestAdd(const std::string& type)
+  {
+    const std::string layout = LayoutName<rowMajorA, rowMajorB, rowMajorC>();
+    for (const auto& shape : g_elementwiseShapes)
+    {
+      const std::size_t m = shape[0], n = shape[1];
+      TMLDynamicMatrix<ET, rowMajorA> a(m, n);
+      TMLDynamicMatrix<ET, rowMajorB> b(m, n);
+      TMLDynamicMatrix<ET, rowMajorC> c(m, n);
+      TMLDynamicMatrix<ET> ref(m, n);
+      FillRandom(a, 1);
+      FillRandom(b, 2);
+      NaiveElementwise(ref, a, b, [](ET x, ET y) { return x + y; });
+
+      c = a + b;
+      CheckClose(c, ref, 0.0, ElementwiseName("C = A + B", layout, type, m, n));
+
+      TMLDynamicMatrix<ET, rowMajorC> d = a + b;
+      CheckClose(d, ref, 0.0, ElementwiseName("D(A + B)", layout, type, m, n));
+
+      // The result is one of the operands
+      TMLDynamicMatrix<ET, rowMajorA> e = a;
+      e = e + b;
+      CheckClose(e, ref, 0.0, ElementwiseName("A = A + B", layout, type, m, n));
+    }
+  }
+
+  // Elementwise products and quotients of complex numbers are not computed like std::complex does
+  template<typename ET>
+  double ElementwiseTolerance() { return 0.0; }
+  template<>
+  double ElementwiseTolerance<std::complex<float>>() { return 8.0 * Epsilon<float>(); }
+  template<>
+  double ElementwiseTolerance<std::complex<double>>() { return 8.0 * Epsilon<double>(); }
+
+  // C = A - B, C = s * A, C = A * s, C = A % B (Hadamard product) and C = A / B (division: with divisors
+  // away from zero, not for integers)
+  template<typename ET, bool rowMajorA, bool rowMajorB, bool rowMajorC, bool division>
+  void TestElementwise(const std::string& type)
+  {
+    const std::string layout = LayoutName<rowMajorA, rowMajorB, rowMajorC>();
+    const double tolerance = ElementwiseTolerance<ET>();
+    const ET s = ET(3);
+    for (const auto& shape : g_elementwiseShapes)
+    {
+      const std::size_t m = shape[0], n = shape[1];
+      TMLDynamicMatrix<ET, rowMajorA> a(m, n);
+      TMLDynamicMatrix<ET, rowMajorB> b(m, n);
+      TMLDynamicMatrix<ET, rowMajorC> c(m, n);
+      TMLDynamicMatrix<ET> ref(m, n);
+      FillRandom(a, 1);
+      FillRandom(b, 2);
+
+      NaiveElementwise(ref, a, b, [](ET x, ET y) { return x - y; });
+      c = a - b;
+      CheckClose(c, ref, 0.0, ElementwiseName("C = A - B", layout, type, m, n));
+
+      NaiveElementwise(ref, a, b, [s](ET x, ET) { return s * x; });
+      c = s * a;
+      CheckClose(c, ref, tolerance, ElementwiseName("C = s * A", layout, type, m, n));
+      c = a * s;
+      CheckClose(c, ref, tolerance, ElementwiseName("C = A * s", layout, type, m, n));
+
+      NaiveElementwise(ref, a, b, [](ET x, ET y) { ET r(0); MulAdd(r, x, y); return r; });
+      c = a % b;
+      CheckClose(c, ref, tolerance, ElementwiseName("C = A % B", layout, type, m, n));
+
+      if (division)
+      {
+        for (std::size_t i = 0; i < m; i++)
+          for (std::size_t j = 0; j < n; j++)
+            b(i, j) += ET(2);
+        NaiveElementwise(ref, a, b, [](ET x, ET y) { return x / y; });
+        c = a / b;
+        CheckClose(c, ref, tolerance, ElementwiseName("C = A / B", layout, type, m, n));
+      }
+    }
+  }
+
+  template<typename ET, bool division>
+  void TestElementwiseLayouts(const std::string& type)
+  {
+    TestElementwise<ET, true, true, true, division>(type);
+    TestElementwise<ET, false, false, false, division>(type);
+    TestElementwise<ET, true, false, true, division>(type);
+    TestElementwise<ET, false, true, true, division>(type);
+    TestElementwise<ET, true, true, false, division>(type);
+  }
+
+  // Nested expressions that are evaluated in one pass (operands of mixed layouts are read through the
+  // transposing path) and a result that is also an operand of the tree
+  template<typename ET, bool rowMajorB>
+  void TestNested(const std::string& type)
+  {
+    const std::string layout = rowMajorB ? "R" : "C";
+    const double tolerance = 4.0 * ElementwiseTolerance<ET>() + 8.0 * Epsilon<ET>();
+    for (const auto& shape : g_elementwiseShapes)
+    {
+      const std::size_t m = shape[0], n = shape[1];
+      TMLDynamicMatrix<ET> a(m, n), c(m, n), e(m, n), d(m, n), ref(m, n);
+      TMLDynamicMatrix<ET, rowMajorB> b(m, n);
+      FillRandom(a, 1);
+      FillRandom(b, 2);
+      FillRandom(c, 3);
+      FillRandom(e, 4);
+      auto reference = [&](auto op) {
+        for (std::size_t i = 0; i < m; i++)
+          for (std::size_t j = 0; j < n; j++)
+            ref(i, j) = op(a(i, j), b(i, j), c(i, j), e(i, j));
+      };
+
+      reference([](ET x, ET y, ET z, ET w) { return x + y + z - w; });
+      d = a + b + c - e;
+      CheckClose(d, ref, tolerance, ElementwiseName("D = A + B + C - E", layout, type, m, n));
+
+      reference([](ET x, ET y, ET z, ET w) { ET r(0); MulAdd(r, x - y, z + w); return r; });
+      d = (a - b) % (c + e);
+      CheckClose(d, ref, tolerance, ElementwiseName("D = (A - B) % (C + E)", layout, type, m, n));
+
+      reference([](ET x, ET y, ET z, ET w) { return ET(2) * (x + y) - (z - w) * ET(3); });
+      d = ET(2) * (a + b) - (c - e) * ET(3);
+      CheckClose(d, ref, tolerance, ElementwiseName("D = 2 * (A + B) - (C - E) * 3", layout, type, m, n));
+
+      // Divisors away from zero
+      TMLDynamicMatrix<ET> f(m, n);
+      for (std::size_t i = 0; i < m; i++)
+        for (std::size_t j = 0; j < n; j++)
+          f(i, j) = e(i, j) + ET(3);
+      reference([](ET x, ET y, ET z, ET w) { return x + (y - z) / (w + ET(3)); });
+      d = a + (b - c) / f;
+      CheckClose(d, ref, tolerance, ElementwiseName("D = A + (B - C) / F", layout, type, m, n));
+
+      reference([](ET x, ET y, ET z, ET) { return y - x + z + x; });
+      d = a;
+      d = b - d + c + d;
+      CheckClose(d, ref, tolerance, ElementwiseName("A = B - A + C + A", layout, type, m, n));
+    }
+  }
+
+  template<typename ET>
+  void TestAddLayouts(const std::string& type)
+  {
+    TestAdd<ET, true, true, true>(type);
+    TestAdd<ET, false, false, false>(type);
+    TestAdd<ET, true, true, false>(type);
+    TestAdd<ET, true, false, true>(type);
+    TestAdd<ET, false, true, true>(type);
+    TestAdd<ET, false, false, true>(type);
+
+    // Static matrices
+    TMLStaticMatrix<ET, 5, 7> a, b, c, ref;
+    FillRandom(a, 1);
+    FillRandom(b, 2);
+    NaiveElementwise(ref, a, b, [](ET x, ET y) { return x + y; });
+    c = a + b;
+    CheckClose(c, ref, 0.0, ElementwiseName("C = A + B", "static", type, 5, 7));
+  }
+}
+
+void RunElementwiseTests()
+{
+  TestAddLayouts<float>("float");
+  TestAddLayouts<double>("double");
+  TestAddLayouts<std::complex<float>>("complex<float>");
+  TestAddLayouts<std::complex<double>>("complex<double>");
+  TestAddLayouts<std::int32_t>("int32");
+
+  TestElementwiseLayouts<float, true>("float");
+  TestElementwiseLayouts<double, true>("double");
+  TestElementwiseLayouts<std::complex<float>, true>("complex<float>");
+  TestElementwiseLayouts<std::complex<double>, true>("complex<double>");
+  TestElementwiseLayouts<std::int32_t, false>("int32");
+
+  TestNested<float, true>("float");
+  TestNested<float, false>("float");
+  TestNested<double, true>("double");
+  TestNested<std::complex<double>, false>("complex<double>");
+}
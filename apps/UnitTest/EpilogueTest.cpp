@@ -0,0 +1,156 @@
+#include <string>
+#include <complex>
+#include <vector>
+#include <cmath>
+
+#include <MatrixLibrary/Math/Matrix.h>
+
+#include "UnitTest.h"
+
+using namespace ML;
+
+namespace
+{
+  // Below and above the threshold of the blocked kernel, dimensions that are not multiples of the tiles
+  const std::size_t g_epilogueShapes[][3] = { { 1, 1, 1 }, { 7, 13, 5 }, { 33, 31, 29 }, { 97, 130, 71 } };
+
+  std::string EpilogueShapeName(const std::string& type, const std::size_t* s)
+  {
+    return type + " " + std::to_string(s[0]) + "x" + std::to_string(s[2]) + " * " + std::to_string(s[2]) + "x" +
+      std::to_string(s[1]);
+  }
+
+  // Activation of the reference (complex numbers have no activations)
+  template<typename T>
+  T Activate(T x, const TMLGemmEpilogue<T>& ep)
+  {
+    switch (ep.activation)
+    {
+    case EMLActivation::ReLU: return std::max(x, T(0));
+    case EMLActivation::Clamp: return std::min(std::max(x, ep.lo), ep.hi);
+    case EMLActivation::Tanh: return std::tanh(x);
+    default: return x;
+    }
+  }
+  template<typename T>
+  std::complex<T> Activate(std::complex<T> x, const TMLGemmEpilogue<std::complex<T>>&) { return x; }
+
+  // Reference of C = activation(alpha * A * B + beta * C + rowBias + colBias) from the product A * B
+  template<typename MT, typename ET>
+  void EpilogueReference(MT& ref, const TMLDynamicMatrix<ET>& ab, const TMLDynamicMatrix<ET>& c0,
+    const TMLGemmEpilogue<ET>& ep)
+  {
+    for (std::size_t i = 0; i < ref.Rows(); i++)
+    {
+      for (std::size_t j = 0; j < ref.Cols(); j++)
+      {
+        ET x = ep.alpha * ab(i, j) + ep.beta * c0(i, j);
+        if (ep.rowBias)
+          x += ep.rowBias[i];
+        if (ep.colBias)
+          x += ep.colBias[j];
+        ref(i, j) = Activate(x, ep);
+      }
+    }
+  }
+
+  template<typename... Args>
+  void TestActivations(std::false_type, Args&&...) {}
+
+  template<typename A, typename B, typename C, typename ET, typename Check>
+  void TestActivations(std::true_type, const A& a, const B& b, C& c, const TMLDynamicMatrix<ET>& c0,
+    const ET* colBias, Check& check)
+  {
+    TMLGemmEpilogue<ET> ep;
+    ep.activation = EMLActivation::ReLU;
+    c = (a * b).Activation(EMLActivation::ReLU);
+    check(ep, "C = (A * B).Activation(ReLU)");
+
+    ep.activation = EMLActivation::Clamp;
+    ep.lo = ET(-0.25);
+    ep.hi = ET(0.5);
+    c = (a * b).Activation(EMLActivation::Clamp, ep.lo, ep.hi);
+    check(ep, "C = (A * B).Activation(Clamp, -0.25, 0.5)");
+
+    ep = TMLGemmEpilogue<ET>();
+    ep.activation = EMLActivation::Tanh;
+    c = (a * b).Activation(EMLActivation::Tanh);
+    check(ep, "C = (A * B).Activation(Tanh)");
+
+    // Dense layer: C = max(A * B + C + bias, 0) with the structure of the epilogue
+    ep.activation = EMLActivation::ReLU;
+    ep.beta = ET(1);
+    ep.colBias = colBias;
+    c = c0;
+    c = (a * b).Epilogue(ep);
+    check(ep, "C = (A * B).Epilogue(beta 1, column bias, ReLU)");
+  }
+
+  // Every modifier of the product (and the combinations used by the inference layers) for a row- or
+  // column-major C against the scalar reference
+  template<typename ET, bool rowMajorC, bool activations>
+  void TestEpilogues(const std::string& type)
+  {
+    const std::string layout = rowMajorC ? " RRR " : " RRC ";
+    for (const std::size_t* s : g_epilogueShapes)
+    {
+      const std::size_t m = s[0], n = s[1], k = s[2];
+      TMLDynamicMatrix<ET> a(m, k), b(k, n), ab(m, n), c0(m, n), ref(m, n), bias(1, m + n);
+      TMLDynamicMatrix<ET, rowMajorC> c(m, n);
+      FillRandom(a, 1);
+      FillRandom(b, 2);
+      FillRandom(c0, 3);
+      FillRandom(bias, 4);
+      NaiveGemm(ab, a, b);
+      const ET* rowBias = &bias(0, 0);
+      const ET* colBias = &bias(0, m);
+
+      // The bias, the scaling and beta * C add a few roundings to the product, tanh has an error of a few ulp
+      const double tolerance = 2.0 * GemmTolerance<ET>(k) + 16.0 * Epsilon<ET>();
+      auto check = [&](const TMLGemmEpilogue<ET>& ep, const std::string& what) {
+        EpilogueReference(ref, ab, c0, ep);
+        CheckClose(c, ref, tolerance, what + layout + EpilogueShapeName(type, s));
+      };
+
+      TMLGemmEpilogue<ET> ep;
+      ep.alpha = ET(-1.5);
+      c = c0;
+      c = (a * b).Scale(ep.alpha);
+      check(ep, "C = (A * B).Scale(alpha)");
+
+      ep.beta = ET(0.5);
+      c = c0;
+      c = (a * b).Scale(ep.alpha, ep.beta);
+      check(ep, "C = (A * B).Scale(alpha, beta)");
+
+      ep = TMLGemmEpilogue<ET>();
+      ep.rowBias = rowBias;
+      c = (a * b).RowBias(rowBias);
+      check(ep, "C = (A * B).RowBias(bias)");
+
+      ep = TMLGemmEpilogue<ET>();
+      ep.colBias = colBias;
+      c = (a * b).ColBias(colBias);
+      check(ep, "C = (A * B).ColBias(bias)");
+
+      ep.alpha = ET(2);
+      ep.beta = ET(1);
+      ep.rowBias = rowBias;
+      c = c0;
+      c = (a * b).Scale(ep.alpha, ep.beta).RowBias(rowBias).ColBias(colBias).Threads(2);
+      check(ep, "C = (A * B).Scale(2, 1).RowBias(bias).ColBias(bias)");
+
+      TestActivations(std::integral_constant<bool, activations>(), a, b, c, c0, colBias, check);
+    }
+  }
+}
+
+void RunEpilogueTests()
+{
+  TestEpilogues<float, true, true>("float");
+  TestEpilogues<float, false, true>("float");
+  TestEpilogues<double, true, true>("double");
+  TestEpilogues<double, false, true>("double");
+  TestEpilogues<std::complex<float>, true, false>("complex<float>");
+  TestEpilogues<std::complex<double>, false, false>("complex<double>");
+}
@@ -0,0 +1,242 @@
+#include <string>
+#include <complex>
+#include <thread>
+#include <vector>
+
+#include <MatrixLibrary/Math/Matrix.h>
+
+#include "UnitTest.h"
+
+using namespace ML;
+
+namespace
+{
+  struct SGemmShape
+  {
+    std::size_t m, n, k;
+  };
+
+  // Shapes below and above the threshold of the blocked kernel (64^3 multiply-adds) with dimensions that are
+  // not multiples of the register tiles, the SIMD width or the cache blocks
+  const SGemmShape g_shapes[] = {
+    { 1, 1, 1 }, { 2, 3, 5 }, { 7, 7, 7 }, { 13, 1, 17 }, { 1, 19, 23 }, { 16, 16, 16 }, { 31, 33, 35 },
+    { 64, 64, 64 }, { 65, 67, 69 }, { 97, 41, 130 }, { 130, 257, 97 }, { 300, 5, 301 }, { 131, 137, 300 },
+  };
+
+  std::string ShapeName(const std::string& type, const SGemmShape& s)
+  {
+    return type + " " + std::to_string(s.m) + "x" + std::to_string(s.k) + " * " + std::to_string(s.k) + "x" +
+      std::to_string(s.n);
+  }
+
+  // C = A * B of row-major dynamic matrices against the scalar reference
+  template<typename ET>
+  void TestGemm(const std::string& type)
+  {
+    for (const SGemmShape& s : g_shapes)
+    {
+      TMLDynamicMatrix<ET> a(s.m, s.k), b(s.k, s.n), c(s.m, s.n), ref(s.m, s.n);
+      FillRandom(a, 1);
+      FillRandom(b, 2);
+      FillRandom(c, 3);
+      NaiveGemm(ref, a, b);
+
+      c = a * b;
+      CheckClose(c, ref, GemmTolerance<ET>(s.k), "C = A * B " + ShapeName(type, s));
+
+      TMLDynamicMatrix<ET> d = a * b;
+      CheckClose(d, ref, GemmTolerance<ET>(s.k), "D(A * B) " + ShapeName(type, s));
+    }
+  }
+
+  // C = A * B for all combinations of row- and column-major operands (ref is the row-major product)
+  template<typename ET, bool rowMajorA, bool rowMajorB, bool rowMajorC>
+  void TestGemmLayout(const std::string& type, const SGemmShape& s, const TMLDynamicMatrix<ET>& ref)
+  {
+    const std::string layout = std::string(rowMajorA ? "R" : "C") + (rowMajorB ? "R" : "C") + (rowMajorC ? "R" : "C");
+    TMLDynamicMatrix<ET, rowMajorA> a(s.m, s.k);
+    TMLDynamicMatrix<ET, rowMajorB> b(s.k, s.n);
+    TMLDynamicMatrix<ET, rowMajorC> c(s.m, s.n);
+    FillRandom(a, 1);
+    FillRandom(b, 2);
+
+    c = a * b;
+    CheckClose(c, ref, GemmTolerance<ET>(s.k), "C = A * B " + layout + " " + ShapeName(type, s));
+  }
+
+  template<typename ET>
+  void TestGemmLayouts(const std::string& type)
+  {
+    for (const SGemmShape& s : g_shapes)
+    {
+      TMLDynamicMatrix<ET> a(s.m, s.k), b(s.k, s.n), ref(s.m, s.n);
+      FillRandom(a, 1);
+      FillRandom(b, 2);
+      NaiveGemm(ref, a, b);
+
+      TestGemmLayout<ET, true, true, false>(type, s, ref);
+      TestGemmLayout<ET, true, false, true>(type, s, ref);
+      TestGemmLayout<ET, true, false, false>(type, s, ref);
+      TestGemmLayout<ET, false, true, true>(type, s, ref);
+      TestGemmLayout<ET, false, true, false>(type, s, ref);
+      TestGemmLayout<ET, false, false, true>(type, s, ref);
+      TestGemmLayout<ET, false, false, false>(type, s, ref);
+    }
+  }
+
+  // Parallel products with a limited number of threads and products that are computed by several user threads
+  // at the same time while the pool is resized
+  template<typename ET>
+  void TestGemmThreads(const std::string& type)
+  {
+    auto& pool = CMLThreadPool::GetGlobal();
+    const std::size_t previous = pool.GetThreadCount();
+    pool.SetThreadCount(4);
+
+    const SGemmShape s = { 200, 210, 260 };
+    TMLDynamicMatrix<ET> a(s.m, s.k), b(s.k, s.n), c(s.m, s.n), ref(s.m, s.n);
+    FillRandom(a, 1);
+    FillRandom(b, 2);
+    NaiveGemm(ref, a, b);
+
+    for (std::size_t threads : { 0, 1, 2, 3, 4, 8 })
+    {
+      c = (a * b).Threads(threads);
+      CheckClose(c, ref, GemmTolerance<ET>(s.k), "C = (A * B).Threads(" + std::to_string(threads) + ") " + 
+        ShapeName(type, s));
+    }
+
+    std::vector<double> diffs(3, 0.0);
+    std::vector<std::thread> workers;
+    for (std::size_t t = 0; t < diffs.size(); t++)
+    {
+      workers.emplace_back([&, t]() {
+        TMLDynamicMatrix<ET> ct(s.m, s.n);
+        for (std::size_t r = 0; r < 3; r++)
+        {
+          ct = a * b;
+          diffs[t] = std::max(diffs[t], MaxDifference(ct, ref));
+        }
+      });
+    }
+    for (std::size_t threads : { 2, 3, 1, 4 })
+      pool.SetThreadCount(threads);
+    for (auto& worker : workers)
+      worker.join();
+
+    for (std::size_t t = 0; t < diffs.size(); t++)
+      Check(diffs[t] <= GemmTolerance<ET>(s.k), "concurrent C = A * B on user thread " + std::to_string(t) + " " + 
+        ShapeName(type, s));
+
+    pool.SetThreadCount(previous);
+  }
+
+  // Largest absolute value of the elements of a matrix
+  template<typename MT>
+  double MaxAbs(const MT& mat)
+  {
+    double m = 0.0;
+    for (std::size_t i = 0; i < mat.Rows(); i++)
+      for (std::size_t j = 0; j < mat.Cols(); j++)
+        m = std::max(m, static_cast<double>(std::abs(mat(i, j))));
+    return m;
+  }
+
+  // Products of three to five factors (evaluated in the cheapest order) against the left to right scalar
+  // reference. The error bound of the reordered product is relative to the size of the result.
+  template<typename ET, bool rowMajorB>
+  void TestGemmChain(const std::string& type)
+  {
+    // Dimensions of the factors: dims[i] x dims[i + 1]
+    const std::vector<std::vector<std::size_t>> chains = {
+      { 1, 1, 1, 1 }, { 200, 8, 200, 1 }, { 3, 70, 5, 90 }, { 130, 64, 130, 64, 130 }, { 1, 97, 33, 97, 1 },
+      { 40, 7, 90, 3, 60, 9 },
+    };
+    const std::string layout = rowMajorB ? " (row-major) " : " (column-major second factor) ";
+
+    for (const auto& dims : chains)
+    {
+      const std::size_t n = dims.size() - 1;
+      std::string name = type + layout;
+      std::size_t ksum = 0;
+      for (std::size_t i = 0; i < n; i++)
+      {
+        name += (i == 0 ? "" : " * ") + std::to_string(dims[i]) + "x" + std::to_string(dims[i + 1]);
+        ksum += dims[i + 1];
+      }
+
+      std::vector<TMLDynamicMatrix<ET>> f;
+      for (std::size_t i = 0; i < n; i++)
+      {
+        f.emplace_back(dims[i], dims[i + 1]);
+        FillRandom(f[i], static_cast<unsigned int>(i + 1));
+      }
+      // Second factor in the layout of the test (same elements as f[1])
+      TMLDynamicMatrix<ET, rowMajorB> b1(dims[1], dims[2]);
+      FillRandom(b1, 2);
+
+      TMLDynamicMatrix<ET> ref = f[0];
+      for (std::size_t i = 1; i < n; i++)
+      {
+        TMLDynamicMatrix<ET> next(dims[0], dims[i + 1]);
+        NaiveGemm(next, ref, f[i]);
+        ref = next;
+      }
+      const double tolerance = GemmTolerance<ET>(ksum) * std::max(1.0, MaxAbs(ref)) * static_cast<double>(n);
+
+      TMLDynamicMatrix<ET> c(dims[0], dims[n]);
+      if (n == 3)
+        c = f[0] * b1 * f[2];
+      else if (n == 4)
+        c = f[0] * b1 * f[2] * f[3];
+      else
+        c = f[0] * b1 * f[2] * f[3] * f[4];
+      CheckClose(c, ref, tolerance, "C = chain " + name);
+
+      // The epilogue applies to the last product
+      if (n == 3)
+        c = (f[0] * f[1] * f[2]).Scale(ET(2)).Threads(2);
+      else if (n == 4)
+        c = (f[0] * f[1] * f[2] * f[3]).Scale(ET(2)).Threads(2);
+      else
+        c = (f[0] * f[1] * f[2] * f[3] * f[4]).Scale(ET(2)).Threads(2);
+      TMLDynamicMatrix<ET> ref2 = ref;
+      for (std::size_t i = 0; i < ref2.Rows(); i++)
+        for (std::size_t j = 0; j < ref2.Cols(); j++)
+          ref2(i, j) = ET(2) * ref(i, j);
+      CheckClose(c, ref2, 2.0 * tolerance, "C = (chain).Scale(2) " + name);
+    }
+
+    // The result is one of the factors (evaluated from left to right)
+    TMLDynamicMatrix<ET> a(31, 31), b(31, 31), c(31, 31), ab(31, 31), ref(31, 31);
+    FillRandom(a, 1);
+    FillRandom(b, 2);
+    FillRandom(c, 3);
+    NaiveGemm(ab, a, b);
+    NaiveGemm(ref, ab, c);
+    a = a * b * c;
+    CheckClose(a, ref, GemmTolerance<ET>(62) * std::max(1.0, MaxAbs(ref)), "A = A * B * C " + type + " 31x31");
+  }
+}
+
+void RunGemmTests()
+{
+  TestGemm<float>("float");
+  TestGemm<double>("double");
+
+  TestGemmLayouts<float>("float");
+  TestGemmLayouts<double>("double");
+
+  TestGemm<std::complex<float>>("complex<float>");
+  TestGemm<std::complex<double>>("complex<double>");
+  TestGemmLayouts<std::complex<float>>("complex<float>");
+  TestGemmLayouts<std::complex<double>>("complex<double>");
+
+  TestGemmChain<float, true>("float");
+  TestGemmChain<double, true>("double");
+  TestGemmChain<double, false>("double");
+  TestGemmChain<std::complex<double>, true>("complex<double>");
+
+  TestGemmThreads<float>("float");
+  TestGemmThreads<double>("double");
+}
@@ -0,0 +1,104 @@
+#include <string>
+#include <complex>
+
+#include <MatrixLibrary/Math/Matrix.h>
+
+#include "UnitTest.h"
+
+using namespace ML;
+
+namespace
+{
+  // Small products, blocked products and matrix-vector products (n == 1)
+  const std::size_t g_updateShapes[][3] = { { 1, 1, 1 }, { 7, 9, 5 }, { 65, 67, 69 }, { 130, 97, 75 }, { 301, 1, 257 } };
+
+  std::string UpdateName(const std::string& what, const std::string& layout, const std::string& type, const std::size_t* s)
+  {
+    return what + " " + layout + " " + type + " " + std::to_string(s[0]) + "x" + std::to_string(s[2]) + " * " +
+      std::to_string(s[2]) + "x" + std::to_string(s[1]);
+  }
+
+  // Sums of a product and a matrix that are fused into one GEMM against the scalar reference, with C in the
+  // layout of the result (read by the epilogue) and in the other layout (copied first)
+  template<typename ET, bool rowMajorC, bool rowMajorD>
+  void TestGemmUpdate(const std::string& type)
+  {
+    const std::string layout = std::string("RR") + (rowMajorC ? "R" : "C") + (rowMajorD ? "R" : "C");
+    for (const std::size_t* s : g_updateShapes)
+    {
+      const std::size_t m = s[0], n = s[1], k = s[2];
+      TMLDynamicMatrix<ET> a(m, k), b(k, n), ab(m, n), ref(m, n);
+      TMLDynamicMatrix<ET, rowMajorC> c(m, n);
+      TMLDynamicMatrix<ET, rowMajorD> d(m, n);
+      FillRandom(a, 1);
+      FillRandom(b, 2);
+      FillRandom(c, 3);
+      NaiveGemm(ab, a, b);
+      const double tolerance = 4.0 * GemmTolerance<ET>(k);
+
+      auto reference = [&](ET x, ET y) {
+        for (std::size_t i = 0; i < m; i++)
+          for (std::size_t j = 0; j < n; j++)
+            ref(i, j) = x * ab(i, j) + y * c(i, j);
+      };
+
+      reference(ET(1), ET(1));
+      d = a * b + c;
+      CheckClose(d, ref, tolerance, UpdateName("D = A * B + C", layout, type, s));
+      d = c + a * b;
+      CheckClose(d, ref, tolerance, UpdateName("D = C + A * B", layout, type, s));
+
+      reference(ET(-1), ET(1));
+      d = c - a * b;
+      CheckClose(d, ref, tolerance, UpdateName("D = C - A * B", layout, type, s));
+
+      reference(ET(1), ET(-1));
+      d = a * b - c;
+      CheckClose(d, ref, tolerance, UpdateName("D = A * B - C", layout, type, s));
+
+      reference(ET(2), ET(3));
+      d = ET(2) * (a * b) + ET(3) * c;
+      CheckClose(d, ref, tolerance, UpdateName("D = 2 * (A * B) + 3 * C", layout, type, s));
+      d = (a * b).Scale(ET(2)) + c * ET(3);
+      CheckClose(d, ref, tolerance, UpdateName("D = (A * B).Scale(2) + C * 3", layout, type, s));
+
+      // The product is accumulated into C itself
+      reference(ET(-1), ET(1));
+      TMLDynamicMatrix<ET, rowMajorC> r = c;
+      r = r - a * b;
+      CheckClose(r, ref, tolerance, UpdateName("C = C - A * B", layout, type, s));
+
+      // Epilogues that cannot be combined with the sum (a scaled bias) are evaluated in two passes
+      TMLDynamicMatrix<ET> bias(1, m);
+      FillRandom(bias, 4);
+      for (std::size_t i = 0; i < m; i++)
+        for (std::size_t j = 0; j < n; j++)
+          ref(i, j) = ET(2) * (ab(i, j) + bias(0, i)) + c(i, j);
+      d = ET(2) * (a * b).RowBias(&bias(0, 0)) + c;
+      CheckClose(d, ref, 2.0 * tolerance, UpdateName("D = 2 * (A * B).RowBias(bias) + C", layout, type, s));
+    }
+
+    // The result is a factor of the product
+    TMLDynamicMatrix<ET> a(33, 33), b(33, 33), c(33, 33), ab(33, 33);
+    FillRandom(a, 1);
+    FillRandom(b, 2);
+    FillRandom(c, 3);
+    NaiveGemm(ab, a, b);
+    for (std::size_t i = 0; i < 33; i++)
+      for (std::size_t j = 0; j < 33; j++)
+        ab(i, j) += c(i, j);
+    a = a * b + c;
+    CheckClose(a, ab, 4.0 * GemmTolerance<ET>(33), "A = A * B + C " + type + " 33x33");
+  }
+}
+
+void RunGemmUpdateTests()
+{
+  TestGemmUpdate<float, true, true>("float");
+  TestGemmUpdate<float, false, true>("float");
+  TestGemmUpdate<double, true, true>("double");
+  TestGemmUpdate<double, true, false>("double");
+  TestGemmUpdate<double, false, false>("double");
+  TestGemmUpdate<std::complex<float>, true, true>("complex<float>");
+  TestGemmUpdate<std::complex<double>, false, true>("complex<double>");
+}
@@ -0,0 +1,140 @@
+#include <string>
+#include <complex>
+#include <limits>
+
+#include <MatrixLibrary/Math/Matrix.h>
+
+#include "UnitTest.h"
+
+using namespace ML;
+
+namespace
+{
+  // Shapes of A with dimensions that are not multiples of the SIMD width (the last one is parallelized)
+  const std::size_t g_gemvShapes[][2] = { { 1, 1 }, { 5, 3 }, { 17, 33 }, { 130, 70 }, { 300, 257 }, { 1100, 301 } };
+
+  // (alpha, beta) of the tests, beta == 0 must not read the output
+  const double g_scales[][2] = { { 1.0, 0.0 }, { 2.0, -0.5 }, { -1.0, 1.0 } };
+
+  template<typename ET>
+  ET NotANumber()
+  {
+    return ET(std::numeric_limits<decltype(std::abs(ET()))>::quiet_NaN());
+  }
+
+  std::string GemvName(const std::string& what, const std::string& type, std::size_t m, std::size_t n, double alpha, double beta)
+  {
+    return what + " " + type + " " + std::to_string(m) + "x" + std::to_string(n) + " (alpha " + std::to_string(alpha) +
+      ", beta " + std::to_string(beta) + ")";
+  }
+
+  // y = alpha * A * x + beta * y with contiguous vectors (a column and a row) and with strided vectors (a row
+  // and a column of matrices of the other layout)
+  template<typename ET, bool rowMajorA>
+  void TestGemv(const std::string& type)
+  {
+    const std::string layout = rowMajorA ? "row-major A " : "column-major A ";
+    for (const auto& shape : g_gemvShapes)
+    {
+      const std::size_t m = shape[0], n = shape[1];
+      TMLDynamicMatrix<ET, rowMajorA> a(m, n);
+      TMLDynamicMatrix<ET> x(n, 1), y0(m, 1), ax(m, 1), ref(m, 1);
+      TMLDynamicMatrix<ET> xs(3, n), ys(m, 2);
+      FillRandom(a, 1);
+      FillRandom(x, 2);
+      FillRandom(y0, 3);
+      NaiveGemm(ax, a, x);
+      for (std::size_t j = 0; j < n; j++)
+        xs(1, j) = x(j, 0);
+
+      for (const auto& scale : g_scales)
+      {
+        const ET alpha = ET(scale[0]), beta = ET(scale[1]);
+        for (std::size_t i = 0; i < m; i++)
+          ref(i, 0) = alpha * ax(i, 0) + (scale[1] == 0.0 ? ET(0) : beta * y0(i, 0));
+        const double tolerance = 2.0 * GemmTolerance<ET>(n);
+
+        TMLDynamicMatrix<ET> y(m, 1);
+        y = y0;
+        if (scale[1] == 0.0)
+          y.Set1(NotANumber<ET>());
+        MLGemv(y, a, x, alpha, beta);
+        CheckClose(y, ref, tolerance, GemvName("MLGemv " + layout, type, m, n, scale[0], scale[1]));
+
+        // x is a row of a matrix, y is a row vector and a column of a row-major matrix (stride 2)
+        TMLDynamicMatrix<ET> yt(1, m);
+        for (std::size_t i = 0; i < m; i++)
+        {
+          yt(0, i) = scale[1] == 0.0 ? NotANumber<ET>() : y0(i, 0);
+          ys(i, 1) = yt(0, i);
+        }
+        MLGemv(yt, a, MLRow(xs, 1), alpha, beta);
+        CheckClose(MLTranspose(yt), ref, tolerance, GemvName("MLGemv (row vectors) " + layout, type, m, n, scale[0], scale[1]));
+        auto ycol = MLColumn(ys, 1);
+        MLGemv(ycol, a, MLRow(xs, 1), alpha, beta);
+        CheckClose(MLColumn(ys, 1), ref, tolerance, GemvName("MLGemv (strided y) " + layout, type, m, n, scale[0], scale[1]));
+
+        // Products with one column of B and with one row of A are matrix-vector products as well
+        y = y0;
+        y = (a * x).Scale(alpha, beta);
+        CheckClose(y, ref, tolerance, GemvName("y = (A * x).Scale " + layout, type, m, n, scale[0], scale[1]));
+        yt = (MLTranspose(x) * MLTranspose(a)).Scale(alpha);
+        for (std::size_t i = 0; i < m; i++)
+          ref(i, 0) = alpha * ax(i, 0);
+        CheckClose(MLTranspose(yt), ref, tolerance, GemvName("y^T = (x^T * A^T).Scale " + layout, type, m, n, scale[0], 0.0));
+      }
+    }
+  }
+
+  // A = alpha * x * y^T + beta * A and products with an inner dimension of 1
+  template<typename ET, bool rowMajorA>
+  void TestGer(const std::string& type)
+  {
+    const std::string layout = rowMajorA ? "row-major A " : "column-major A ";
+    for (const auto& shape : g_gemvShapes)
+    {
+      const std::size_t m = shape[0], n = shape[1];
+      TMLDynamicMatrix<ET> x(m, 1), y(1, n), a0(m, n), ref(m, n);
+      TMLDynamicMatrix<ET, rowMajorA> a(m, n);
+      FillRandom(x, 1);
+      FillRandom(y, 2);
+      FillRandom(a0, 3);
+
+      for (const auto& scale : g_scales)
+      {
+        const ET alpha = ET(scale[0]), beta = ET(scale[1]);
+        for (std::size_t i = 0; i < m; i++)
+          for (std::size_t j = 0; j < n; j++)
+            ref(i, j) = alpha * x(i, 0) * y(0, j) + (scale[1] == 0.0 ? ET(0) : beta * a0(i, j));
+        const double tolerance = 16.0 * Epsilon<ET>();
+
+        a = a0;
+        if (scale[1] == 0.0)
+          a.Set1(NotANumber<ET>());
+        MLGer(a, x, y, alpha, beta);
+        CheckClose(a, ref, tolerance, GemvName("MLGer " + layout, type, m, n, scale[0], scale[1]));
+
+        a = a0;
+        a = (x * y).Scale(alpha, beta);
+        CheckClose(a, ref, tolerance, GemvName("A = (x * y).Scale " + layout, type, m, n, scale[0], scale[1]));
+      }
+    }
+  }
+}
+
+void RunGemvTests()
+{
+  TestGemv<float, true>("float");
+  TestGemv<float, false>("float");
+  TestGemv<double, true>("double");
+  TestGemv<double, false>("double");
+  TestGemv<std::complex<float>, true>("complex<float>");
+  TestGemv<std::complex<double>, false>("complex<double>");
+
+  TestGer<float, true>("float");
+  TestGer<float, false>("float");
+  TestGer<double, true>("double");
+  TestGer<double, false>("double");
+  TestGer<std::complex<float>, false>("complex<float>");
+  TestGer<std::complex<double>, true>("complex<double>");
+}
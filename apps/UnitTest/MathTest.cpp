@@ -0,0 +1,147 @@
+#include <string>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+#include <MatrixLibrary/Math/Matrix.h>
+
+#include "UnitTest.h"
+
+using namespace ML;
+
+namespace
+{
+  // Error of a result in units in the last place of the reference rounded to ET (NaNs and infinities must match)
+  template<typename ET>
+  double UlpError(ET result, long double ref)
+  {
+    if (std::isnan(ref) || std::isnan(result))
+      return std::isnan(ref) && std::isnan(result) ? 0.0 : std::numeric_limits<double>::infinity();
+    if (std::isinf(ref) || std::isinf(result))
+      return ref == static_cast<long double>(result) ? 0.0 : std::numeric_limits<double>::infinity();
+    const ET rounded = std::abs(static_cast<ET>(ref));
+    const long double ulp = static_cast<long double>(std::nextafter(rounded, std::numeric_limits<ET>::infinity())) - rounded;
+    return static_cast<double>(std::abs(static_cast<long double>(result) - ref) / ulp);
+  }
+
+  // Largest error of f(x) against the reference of every element
+  template<typename A, typename B, typename F>
+  double MaxUlpError(const A& result, const B& x, F reference)
+  {
+    double err = 0.0;
+    for (std::size_t i = 0; i < x.Rows(); i++)
+      for (std::size_t j = 0; j < x.Cols(); j++)
+        err = std::max(err, UlpError(result(i, j), reference(static_cast<long double>(x(i, j)))));
+    return err;
+  }
+
+  // Random elements in [lo, hi]
+  template<typename MT>
+  void FillRange(MT& mat, double lo, double hi, unsigned int seed)
+  {
+    FillRandom(mat, seed);
+    for (std::size_t i = 0; i < mat.Rows(); i++)
+      for (std::size_t j = 0; j < mat.Cols(); j++)
+        mat(i, j) = static_cast<typename MT::ElementType>(lo + (hi - lo) * (static_cast<double>(mat(i, j)) + 1.0) / 2.0);
+  }
+
+  std::string MathName(const std::string& what, const std::string& type, double lo, double hi)
+  {
+    return what + " " + type + " [" + std::to_string(lo) + ", " + std::to_string(hi) + "]";
+  }
+
+  // Maximum errors of the kernels (see SIMD/Exp.h, Sqrt.h, Trig.h, Tanh.h and Erf.h)
+  struct SMathBounds
+  {
+    double exp, log, pow, rsqrt, trig, tanh, sigmoid, erf;
+  };
+
+  // Every function against the long double reference on ranges that cover the branches of its kernel (the
+  // SIMD body and the masked tail of each line, lanes that are clamped and registers that fall back to the
+  // standard library). f(y, x) evaluates y = F(x).
+  template<typename ET, bool rowMajor>
+  void TestMath(const std::string& type, const SMathBounds& bounds, double expRange, double trigRange)
+  {
+    const std::string name = type + (rowMajor ? " (row-major)" : " (column-major)");
+    TMLDynamicMatrix<ET, rowMajor> x(37, 29), y(37, 29);
+
+    auto check = [&](const std::string& what, double lo, double hi, double bound, auto f, auto reference) {
+      FillRange(x, lo, hi, 1);
+      f(y, x);
+      const double err = MaxUlpError(y, x, reference);
+      Check(err <= bound, MathName(what, name, lo, hi) + " (max error " + std::to_string(err) + " ulp, bound " +
+        std::to_string(bound) + " ulp)");
+    };
+
+    check("MLExp", -expRange, expRange, bounds.exp, [](auto& r, const auto& a) { r = MLExp(a); }, [](long double v) { return std::exp(v); });
+    check("MLExp", -1.0, 1.0, bounds.exp, [](auto& r, const auto& a) { r = MLExp(a); }, [](long double v) { return std::exp(v); });
+    check("MLLog", 1e-3, 1e3, bounds.log, [](auto& r, const auto& a) { r = MLLog(a); }, [](long double v) { return std::log(v); });
+    check("MLLog", 0.5, 2.0, bounds.log, [](auto& r, const auto& a) { r = MLLog(a); }, [](long double v) { return std::log(v); });
+    for (double e : { 0.5, -1.5, 2.0, 3.25 })
+    {
+      check("MLPow(A, " + std::to_string(e) + ")", 0.1, 10.0, bounds.pow, [e](auto& r, const auto& a) { r = MLPow(a, ET(e)); },
+        [e](long double v) { return std::pow(v, static_cast<long double>(static_cast<ET>(e))); });
+    }
+    check("MLSqrt", 0.0, 1e4, 0.5, [](auto& r, const auto& a) { r = MLSqrt(a); }, [](long double v) { return std::sqrt(v); });
+    check("MLRsqrt", 1e-4, 1e4, bounds.rsqrt, [](auto& r, const auto& a) { r = MLRsqrt(a); }, [](long double v) { return 1.0L / std::sqrt(v); });
+    for (double range : { 4.0, trigRange, 1e7 })
+    {
+      check("MLSin", -range, range, bounds.trig, [](auto& r, const auto& a) { r = MLSin(a); }, [](long double v) { return std::sin(v); });
+      check("MLCos", -range, range, bounds.trig, [](auto& r, const auto& a) { r = MLCos(a); }, [](long double v) { return std::cos(v); });
+    }
+    for (double range : { 0.5, 10.0 })
+      check("MLTanh", -range, range, bounds.tanh, [](auto& r, const auto& a) { r = MLTanh(a); }, [](long double v) { return std::tanh(v); });
+    check("MLSigmoid", -30.0, 30.0, bounds.sigmoid, [](auto& r, const auto& a) { r = MLSigmoid(a); },
+      [](long double v) { return 1.0L / (1.0L + std::exp(-v)); });
+    for (double range : { 1.0, 6.0 })
+      check("MLErf", -range, range, bounds.erf, [](auto& r, const auto& a) { r = MLErf(a); }, [](long double v) { return std::erf(v); });
+
+    // Fused with another elementwise expression
+    TMLDynamicMatrix<ET, rowMajor> b(37, 29), d(37, 29);
+    FillRange(x, -5.0, 5.0, 1);
+    FillRange(b, -5.0, 5.0, 2);
+    d = x - b;
+    y = MLExp(x - b);
+    const double err = MaxUlpError(y, d, [](long double v) { return std::exp(v); });
+    Check(err <= bounds.exp, "MLExp(A - B) " + name + " (max error " + std::to_string(err) + " ulp)");
+  }
+
+  // Special arguments: zeros, infinities and NaNs
+  template<typename ET>
+  void TestMathSpecial(const std::string& type)
+  {
+    const ET inf = std::numeric_limits<ET>::infinity(), nan = std::numeric_limits<ET>::quiet_NaN();
+    const ET args[] = { ET(0), ET(-0.0), inf, -inf, nan, ET(-1), ET(1), ET(2) };
+    TMLDynamicMatrix<ET> x(1, 8), y(1, 8);
+    for (std::size_t j = 0; j < 8; j++)
+      x(0, j) = args[j];
+
+    auto check = [&](const std::string& what, auto f, auto reference) {
+      f(y, x);
+      bool ok = true;
+      for (std::size_t j = 0; j < 8; j++)
+        ok = ok && UlpError(y(0, j), reference(static_cast<long double>(x(0, j)))) <= 8.0;
+      Check(ok, what + " special arguments " + type);
+    };
+
+    check("MLExp", [](auto& r, const auto& a) { r = MLExp(a); }, [](long double v) { return std::exp(v); });
+    check("MLLog", [](auto& r, const auto& a) { r = MLLog(a); }, [](long double v) { return std::log(v); });
+    check("MLSqrt", [](auto& r, const auto& a) { r = MLSqrt(a); }, [](long double v) { return std::sqrt(v); });
+    check("MLTanh", [](auto& r, const auto& a) { r = MLTanh(a); }, [](long double v) { return std::tanh(v); });
+    check("MLErf", [](auto& r, const auto& a) { r = MLErf(a); }, [](long double v) { return std::erf(v); });
+    check("MLSigmoid", [](auto& r, const auto& a) { r = MLSigmoid(a); }, [](long double v) { return 1.0L / (1.0L + std::exp(-v)); });
+  }
+}
+
+void RunMathTests()
+{
+  const SMathBounds floatBounds = { 1.0, 1.0, 20.0, 4.0, 2.0, 5.0, 3.0, 6.0 };
+  const SMathBounds doubleBounds = { 2.0, 1.0, 20.0, 1.5, 2.0, 2.0, 3.0, 1.0 };
+  TestMath<float, true>("float", floatBounds, 87.0, 8192.0);
+  TestMath<float, false>("float", floatBounds, 87.0, 8192.0);
+  TestMath<double, true>("double", doubleBounds, 708.0, 16777216.0);
+  TestMath<double, false>("double", doubleBounds, 708.0, 16777216.0);
+
+  TestMathSpecial<float>("float");
+  TestMathSpecial<double>("double");
+}
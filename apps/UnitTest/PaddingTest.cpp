@@ -0,0 +1,134 @@
+#include <string>
+#include <complex>
+#include <cstring>
+#include <memory>
+
+#include <MatrixLibrary/Math/Matrix.h>
+
+#include "UnitTest.h"
+
+using namespace ML;
+
+namespace
+{
+  // Number of bytes behind the elements of an unpadded matrix that must not be written by the kernels
+  constexpr std::size_t g_guardSize = 64;
+  constexpr unsigned char g_guardByte = 0xA5;
+
+  // Allocator that allocates g_guardSize additional bytes behind every block, i.e. the bytes behind the last
+  // element of a matrix can be checked without reading outside of the allocation
+  template<typename T>
+  struct TGuardAllocator
+  {
+    using value_type = T;
+
+    TGuardAllocator() = default;
+    template<typename U> TGuardAllocator(const TGuardAllocator<U>&) noexcept {}
+
+    T* allocate(std::size_t n) { return std::allocator<T>().allocate(n + (g_guardSize + sizeof(T) - 1) / sizeof(T)); }
+    void deallocate(T* ptr, std::size_t n) noexcept { std::allocator<T>().deallocate(ptr, n + (g_guardSize + sizeof(T) - 1) / sizeof(T)); }
+
+    template<typename U> bool operator==(const TGuardAllocator<U>&) const noexcept { return true; }
+    template<typename U> bool operator!=(const TGuardAllocator<U>&) const noexcept { return false; }
+  };
+
+  template<typename ET, bool rowMajor>
+  using TUnpaddedMatrix = TMLDynamicMatrix<ET, rowMajor, 0xFFFFFFFF, false, TGuardAllocator<ET>>;
+
+  template<typename MT>
+  unsigned char* GuardBegin(MT& mat)
+  {
+    return reinterpret_cast<unsigned char*>(mat.Data() + mat.Rows() * mat.Cols());
+  }
+
+  template<typename MT>
+  void SetGuard(MT& mat)
+  {
+    std::memset(GuardBegin(mat), g_guardByte, g_guardSize);
+  }
+
+  template<typename MT>
+  bool IsGuardIntact(MT& mat)
+  {
+    const unsigned char* guard = GuardBegin(mat);
+    for (std::size_t i = 0; i < g_guardSize; i++)
+      if (guard[i] != g_guardByte)
+        return false;
+    return true;
+  }
+
+  // Shapes whose minor dimensions are not multiples of the SIMD width (skinny shapes are the reason for
+  // unpadded storage) and shapes on both sides of the threshold of the blocked GEMM kernel
+  const std::size_t g_sizes[][3] = {
+    { 1, 1, 1 }, { 3, 5, 7 }, { 9, 1000, 9 }, { 1000, 9, 3 }, { 17, 31, 15 }, { 65, 67, 69 }, { 129, 3, 131 },
+  };
+
+  std::string SizeName(const std::string& type, const std::size_t* s)
+  {
+    return type + " " + std::to_string(s[0]) + "x" + std::to_string(s[2]) + " * " + std::to_string(s[2]) + "x" +
+      std::to_string(s[1]);
+  }
+
+  // Products, sums, SetZero and Set1 of unpadded matrices against the scalar references, including the check
+  // that the bytes behind the last element of the result are not written
+  template<typename ET, bool rowMajorA, bool rowMajorB, bool rowMajorC>
+  void TestUnpadded(const std::string& type)
+  {
+    const std::string layout = std::string(rowMajorA ? "R" : "C") + (rowMajorB ? "R" : "C") + (rowMajorC ? "R" : "C");
+    for (const std::size_t* s : g_sizes)
+    {
+      const std::string name = layout + " " + SizeName(type, s);
+      const std::size_t m = s[0], n = s[1], k = s[2];
+
+      TUnpaddedMatrix<ET, rowMajorA> a(m, k), a2(m, k);
+      TUnpaddedMatrix<ET, rowMajorB> b(k, n);
+      TUnpaddedMatrix<ET, rowMajorC> c(m, n);
+      TMLDynamicMatrix<ET> ref(m, n), refSum(m, k);
+      Check(a.Spacing() == (rowMajorA ? k : m), "unpadded spacing " + name);
+      FillRandom(a, 1);
+      FillRandom(a2, 3);
+      FillRandom(b, 2);
+      NaiveGemm(ref, a, b);
+      for (std::size_t i = 0; i < m; i++)
+        for (std::size_t j = 0; j < k; j++)
+          refSum(i, j) = a(i, j) + a2(i, j);
+
+      SetGuard(c);
+      c = a * b;
+      CheckClose(c, ref, GemmTolerance<ET>(k), "unpadded C = A * B " + name);
+      Check(IsGuardIntact(c), "unpadded C = A * B leaves the memory behind C untouched " + name);
+
+      TUnpaddedMatrix<ET, rowMajorC> sum(m, k);
+      SetGuard(sum);
+      sum = a + a2;
+      CheckClose(sum, refSum, 0.0, "unpadded A + A2 " + name);
+      Check(IsGuardIntact(sum), "unpadded A + A2 leaves the memory behind the result untouched " + name);
+
+      TMLDynamicMatrix<ET> value(m, n);
+      value.Set1(ET(2));
+      c.Set1(ET(2));
+      CheckClose(c, value, 0.0, "unpadded Set1 " + name);
+      value.SetZero();
+      c.SetZero();
+      CheckClose(c, value, 0.0, "unpadded SetZero " + name);
+      Check(IsGuardIntact(c), "unpadded Set1/SetZero leave the memory behind C untouched " + name);
+    }
+  }
+
+  template<typename ET>
+  void TestUnpaddedLayouts(const std::string& type)
+  {
+    TestUnpadded<ET, true, true, true>(type);
+    TestUnpadded<ET, true, false, true>(type);
+    TestUnpadded<ET, false, true, false>(type);
+    TestUnpadded<ET, false, false, false>(type);
+  }
+}
+
+void RunPaddingTests()
+{
+  TestUnpaddedLayouts<float>("float");
+  TestUnpaddedLayouts<double>("double");
+  TestUnpaddedLayouts<std::complex<float>>("complex<float>");
+  TestUnpaddedLayouts<std::complex<double>>("complex<double>");
+}
@@ -0,0 +1,295 @@
+#include <string>
+#include <complex>
+#include <cstdint>
+#include <cmath>
+
+#include <MatrixLibrary/Math/Matrix.h>
+
+#include "UnitTest.h"
+
+using namespace ML;
+
+namespace
+{
+  // Vectors, shapes below and above the unrolled accumulators and shapes with masked tails
+  const std::size_t g_reduceShapes[][2] = {
+    { 1, 1 }, { 1, 37 }, { 37, 1 }, { 3, 5 }, { 17, 33 }, { 64, 64 }, { 130, 67 }, { 301, 257 }
+  };
+
+  std::string ReduceName(const std::string& what, const std::string& layout, const std::string& type, std::size_t m, std::size_t n)
+  {
+    return what + " " + layout + " " + type + " " + std::to_string(m) + "x" + std::to_string(n);
+  }
+
+  // Scalar reference of a reduction of the rows (rowwise) or the columns of a matrix: f(acc, x) for every
+  // element of a line, starting from init
+  template<typename ET, typename MT, typename F>
+  TMLDynamicMatrix<ET> NaiveReduce(const MT& mat, bool rowwise, ET init, F f)
+  {
+    TMLDynamicMatrix<ET> res(rowwise ? mat.Rows() : 1, rowwise ? 1 : mat.Cols());
+    for (std::size_t l = 0; l < (rowwise ? mat.Rows() : mat.Cols()); l++)
+    {
+      ET acc = init;
+      for (std::size_t k = 0; k < (rowwise ? mat.Cols() : mat.Rows()); k++)
+        acc = f(acc, rowwise ? mat(l, k) : mat(k, l));
+      res(rowwise ? l : 0, rowwise ? 0 : l) = acc;
+    }
+    return res;
+  }
+
+  // Position of the first extreme of every line (f(a, b) tells if a replaces b)
+  template<typename MT, typename F>
+  TMLDynamicMatrix<std::size_t> NaiveArgReduce(const MT& mat, bool rowwise, F f)
+  {
+    TMLDynamicMatrix<std::size_t> res(rowwise ? mat.Rows() : 1, rowwise ? 1 : mat.Cols());
+    for (std::size_t l = 0; l < (rowwise ? mat.Rows() : mat.Cols()); l++)
+    {
+      std::size_t pos = 0;
+      for (std::size_t k = 1; k < (rowwise ? mat.Cols() : mat.Rows()); k++)
+        if (rowwise ? f(mat(l, k), mat(l, pos)) : f(mat(k, l), mat(pos, l)))
+          pos = k;
+      res(rowwise ? l : 0, rowwise ? 0 : l) = pos;
+    }
+    return res;
+  }
+
+  // Sum of the absolute values (the error of a sum is bounded relative to it)
+  template<typename MT>
+  double AbsSum(const MT& mat)
+  {
+    double sum = 0.0;
+    for (std::size_t i = 0; i < mat.Rows(); i++)
+      for (std::size_t j = 0; j < mat.Cols(); j++)
+        sum += static_cast<double>(std::abs(mat(i, j)));
+    return sum;
+  }
+
+  // Elementwise comparison of integer results
+  template<typename A, typename B>
+  bool Equal(const A& a, const B& b)
+  {
+    if (a.Rows() != b.Rows() || a.Cols() != b.Cols())
+      return false;
+    for (std::size_t i = 0; i < a.Rows(); i++)
+      for (std::size_t j = 0; j < a.Cols(); j++)
+        if (a(i, j) != b(i, j))
+          return false;
+    return true;
+  }
+
+  double Difference(double a, double b) { return std::isnan(a - b) ? std::numeric_limits<double>::infinity() : std::abs(a - b); }
+
+  // Total and row- / column-wise reductions against the scalar reference in double precision. Sums may be
+  // reassociated by the kernels (error bounded by the number of elements), the compensated sum must stay
+  // within a few ulps of the sum of the absolute values, min, max and the positions are exact.
+  template<typename ET, bool rowMajor>
+  void TestReduceReal(const std::string& type)
+  {
+    const std::string layout = rowMajor ? "R" : "C";
+    for (const auto& shape : g_reduceShapes)
+    {
+      const std::size_t m = shape[0], n = shape[1];
+      TMLDynamicMatrix<ET, rowMajor> a(m, n), b(m, n), p(m, n);
+      FillRandom(a, 1);
+      FillRandom(b, 2);
+      // Factors close to one (the product of elements in [-1, 1] underflows)
+      for (std::size_t i = 0; i < m; i++)
+        for (std::size_t j = 0; j < n; j++)
+          p(i, j) = ET(1) + a(i, j) / ET(64);
+
+      const double eps = Epsilon<ET>();
+      const double absSum = AbsSum(a);
+      const double sumTolerance = 2.0 * static_cast<double>(m + n) * eps * absSum;
+      double sum = 0.0, dot = 0.0, squares = 0.0, prod = 1.0, maxAbs = 0.0;
+      ET minimum = a(0, 0), maximum = a(0, 0);
+      SMLMatrixIndex argMin{ 0, 0 }, argMax{ 0, 0 };
+      for (std::size_t i = 0; i < m; i++)
+      {
+        for (std::size_t j = 0; j < n; j++)
+        {
+          const double x = static_cast<double>(a(i, j));
+          sum += x;
+          dot += x * static_cast<double>(b(i, j));
+          squares += x * x;
+          prod *= static_cast<double>(p(i, j));
+          maxAbs = std::max(maxAbs, std::abs(x));
+          if (a(i, j) < minimum) { minimum = a(i, j); argMin = { i, j }; }
+          if (a(i, j) > maximum) { maximum = a(i, j); argMax = { i, j }; }
+        }
+      }
+
+      Check(Difference(static_cast<double>(MLSum(a)), sum) <= sumTolerance, ReduceName("MLSum", layout, type, m, n));
+      Check(Difference(static_cast<double>(MLCompensatedSum(a)), sum) <= 4.0 * eps * absSum + 4.0 * eps * std::abs(sum),
+        ReduceName("MLCompensatedSum", layout, type, m, n));
+      Check(Difference(static_cast<double>(MLProd(p)), prod) <= 4.0 * static_cast<double>(m * n) * eps * std::abs(prod),
+        ReduceName("MLProd", layout, type, m, n));
+      Check(Difference(static_cast<double>(MLSquaredNorm(a)), squares) <= 2.0 * static_cast<double>(m + n) * eps * squares,
+        ReduceName("MLSquaredNorm", layout, type, m, n));
+      Check(Difference(static_cast<double>(MLNorm(a)), std::sqrt(squares)) <= static_cast<double>(m + n) * eps * std::sqrt(squares) + eps,
+        ReduceName("MLNorm", layout, type, m, n));
+      Check(static_cast<double>(MLMaxAbs(a)) == maxAbs, ReduceName("MLMaxAbs", layout, type, m, n));
+      Check(MLMin(a) == minimum, ReduceName("MLMin", layout, type, m, n));
+      Check(MLMax(a) == maximum, ReduceName("MLMax", layout, type, m, n));
+      const SMLMatrixIndex foundMin = MLArgMin(a), foundMax = MLArgMax(a);
+      Check(foundMin.row == argMin.row && foundMin.col == argMin.col, ReduceName("MLArgMin", layout, type, m, n));
+      Check(foundMax.row == argMax.row && foundMax.col == argMax.col, ReduceName("MLArgMax", layout, type, m, n));
+
+      // Expressions are reduced without a temporary (same layouts) or through one (mixed layouts)
+      const double dotTolerance = 2.0 * static_cast<double>(m + n) * eps * static_cast<double>(m * n);
+      Check(Difference(static_cast<double>(MLDot(a, b)), dot) <= dotTolerance, ReduceName("MLDot(A, B)", layout, type, m, n));
+      const TMLDynamicMatrix<ET, !rowMajor> bt = b;
+      Check(Difference(static_cast<double>(MLDot(a, bt)), dot) <= dotTolerance, ReduceName("MLDot(A, B) mixed", layout, type, m, n));
+      Check(Difference(static_cast<double>(MLSum(a - a)), 0.0) == 0.0, ReduceName("MLSum(A - A)", layout, type, m, n));
+
+      // Row- and column-wise reductions (along the lines of the storage and across them)
+      for (bool rowwise : { true, false })
+      {
+        const std::string dir = rowwise ? "<Rowwise>" : "<Columnwise>";
+        const std::size_t length = rowwise ? n : m;
+        // Absolute tolerances: the errors of the result and of the reference grow with the sum of the magnitudes
+        // (at most length for elements in [-1, 1] and e^(length / 64) for the products of 1 + a / 64). The
+        // compensated sum is compared with a reference in extended precision, its error does not grow with length.
+        const double lineSum = static_cast<double>(length) * static_cast<double>(length) * eps;
+        const double lineProd = static_cast<double>(length) * eps * std::exp(static_cast<double>(length) / 64.0);
+        TMLDynamicMatrix<ET> r(rowwise ? m : 1, rowwise ? 1 : n);
+        TMLDynamicMatrix<std::size_t> pos(rowwise ? m : 1, rowwise ? 1 : n);
+        const auto add = [](ET x, ET y) { return x + y; };
+
+        if (rowwise) r = MLSum<EMLReduction::Rowwise>(a); else r = MLSum<EMLReduction::Columnwise>(a);
+        CheckClose(r, NaiveReduce(a, rowwise, ET(0), add), 2.0 * lineSum,
+          ReduceName("MLSum" + dir, layout, type, m, n));
+        if (rowwise) r = MLCompensatedSum<EMLReduction::Rowwise>(a); else r = MLCompensatedSum<EMLReduction::Columnwise>(a);
+        CheckClose(r, NaiveReduce(a, rowwise, 0.0L, [](long double x, ET y) { return x + static_cast<long double>(y); }),
+          4.0 * static_cast<double>(length) * eps, ReduceName("MLCompensatedSum" + dir, layout, type, m, n));
+        if (rowwise) r = MLProd<EMLReduction::Rowwise>(p); else r = MLProd<EMLReduction::Columnwise>(p);
+        CheckClose(r, NaiveReduce(p, rowwise, ET(1), [](ET x, ET y) { return x * y; }), 8.0 * lineProd,
+          ReduceName("MLProd" + dir, layout, type, m, n));
+        if (rowwise) r = MLSquaredNorm<EMLReduction::Rowwise>(a); else r = MLSquaredNorm<EMLReduction::Columnwise>(a);
+        CheckClose(r, NaiveReduce(a, rowwise, ET(0), [](ET x, ET y) { return x + y * y; }), 2.0 * lineSum,
+          ReduceName("MLSquaredNorm" + dir, layout, type, m, n));
+        if (rowwise) r = MLMaxAbs<EMLReduction::Rowwise>(a); else r = MLMaxAbs<EMLReduction::Columnwise>(a);
+        CheckClose(r, NaiveReduce(a, rowwise, ET(0), [](ET x, ET y) { return std::max(x, ET(std::abs(y))); }), 0.0,
+          ReduceName("MLMaxAbs" + dir, layout, type, m, n));
+        if (rowwise) r = MLMin<EMLReduction::Rowwise>(a); else r = MLMin<EMLReduction::Columnwise>(a);
+        CheckClose(r, NaiveReduce(a, rowwise, ET(2), [](ET x, ET y) { return std::min(x, y); }), 0.0,
+          ReduceName("MLMin" + dir, layout, type, m, n));
+        if (rowwise) r = MLMax<EMLReduction::Rowwise>(a); else r = MLMax<EMLReduction::Columnwise>(a);
+        CheckClose(r, NaiveReduce(a, rowwise, ET(-2), [](ET x, ET y) { return std::max(x, y); }), 0.0,
+          ReduceName("MLMax" + dir, layout, type, m, n));
+        if (rowwise) pos = MLArgMin<EMLReduction::Rowwise>(a); else pos = MLArgMin<EMLReduction::Columnwise>(a);
+        Check(Equal(pos, NaiveArgReduce(a, rowwise, [](ET x, ET y) { return x < y; })), ReduceName("MLArgMin" + dir, layout, type, m, n));
+        if (rowwise) pos = MLArgMax<EMLReduction::Rowwise>(a); else pos = MLArgMax<EMLReduction::Columnwise>(a);
+        Check(Equal(pos, NaiveArgReduce(a, rowwise, [](ET x, ET y) { return x > y; })), ReduceName("MLArgMax" + dir, layout, type, m, n));
+      }
+    }
+  }
+
+  // Integers: sums and extremes are exact, the first of equal extremes is reported
+  template<bool rowMajor>
+  void TestReduceInt()
+  {
+    const std::string layout = rowMajor ? "R" : "C";
+    for (const auto& shape : g_reduceShapes)
+    {
+      const std::size_t m = shape[0], n = shape[1];
+      TMLDynamicMatrix<std::int32_t, rowMajor> a(m, n);
+      FillRandom(a, 1);
+      std::int32_t sum = 0, minimum = a(0, 0), maximum = a(0, 0);
+      for (std::size_t i = 0; i < m; i++)
+      {
+        for (std::size_t j = 0; j < n; j++)
+        {
+          sum += a(i, j);
+          minimum = std::min(minimum, a(i, j));
+          maximum = std::max(maximum, a(i, j));
+        }
+      }
+      Check(MLSum(a) == sum, ReduceName("MLSum", layout, "int32", m, n));
+      Check(MLMin(a) == minimum, ReduceName("MLMin", layout, "int32", m, n));
+      Check(MLMax(a) == maximum, ReduceName("MLMax", layout, "int32", m, n));
+      // The order in which the elements are searched depends on the layout, only the values are compared
+      const SMLMatrixIndex argMin = MLArgMin(a), argMax = MLArgMax(a);
+      Check(a(argMin.row, argMin.col) == minimum, ReduceName("MLArgMin", layout, "int32", m, n));
+      Check(a(argMax.row, argMax.col) == maximum, ReduceName("MLArgMax", layout, "int32", m, n));
+
+      TMLDynamicMatrix<std::int32_t> r(m, 1), c(1, n);
+      TMLDynamicMatrix<std::size_t> pr(m, 1), pc(1, n);
+      r = MLSum<EMLReduction::Rowwise>(a);
+      c = MLSum<EMLReduction::Columnwise>(a);
+      const auto add = [](std::int32_t x, std::int32_t y) { return x + y; };
+      Check(Equal(r, NaiveReduce(a, true, std::int32_t(0), add)), ReduceName("MLSum<Rowwise>", layout, "int32", m, n));
+      Check(Equal(c, NaiveReduce(a, false, std::int32_t(0), add)), ReduceName("MLSum<Columnwise>", layout, "int32", m, n));
+      pr = MLArgMax<EMLReduction::Rowwise>(a);
+      pc = MLArgMin<EMLReduction::Columnwise>(a);
+      Check(Equal(pr, NaiveArgReduce(a, true, [](std::int32_t x, std::int32_t y) { return x > y; })),
+        ReduceName("MLArgMax<Rowwise>", layout, "int32", m, n));
+      Check(Equal(pc, NaiveArgReduce(a, false, [](std::int32_t x, std::int32_t y) { return x < y; })),
+        ReduceName("MLArgMin<Columnwise>", layout, "int32", m, n));
+    }
+  }
+
+  // Sums, products and norms of complex matrices and of views (strided lines). The norms are real.
+  template<typename ET>
+  void TestReduceComplex(const std::string& type)
+  {
+    using RT = typename ET::value_type;
+    TMLDynamicMatrix<ET> iu(2, 2);
+    iu.Set1(ET(0, 1));
+    const RT norm = MLNorm(iu);
+    Check(norm == RT(2), ReduceName("MLNorm(i)", "R", type, 2, 2));
+
+
+    TMLDynamicMatrix<ET> a(67, 45);
+    FillRandom(a, 1);
+    const auto view = MLSubmatrix(a, 3, 5, 61, 37);
+    ET sum(0);
+    for (std::size_t i = 0; i < view.Rows(); i++)
+      for (std::size_t j = 0; j < view.Cols(); j++)
+        sum += view(i, j);
+    const double tolerance = 2.0 * (61 + 37) * Epsilon<ET>() * AbsSum(view);
+    Check(Difference(std::abs(MLSum(view) - sum), 0.0) <= tolerance, ReduceName("MLSum(View)", "R", type, 61, 37));
+    TMLDynamicMatrix<ET> r(61, 1);
+    r = MLSum<EMLReduction::Rowwise>(view);
+    CheckClose(r, NaiveReduce(view, true, ET(0), [](ET x, ET y) { return x + y; }), 2.0 * 37 * Epsilon<ET>(),
+      ReduceName("MLSum<Rowwise>(View)", "R", type, 61, 37));
+
+    double squares = 0.0;
+    for (std::size_t i = 0; i < view.Rows(); i++)
+      for (std::size_t j = 0; j < view.Cols(); j++)
+        squares += static_cast<double>(std::norm(view(i, j)));
+    Check(Difference(static_cast<double>(MLSquaredNorm(view)), squares) <= 2.0 * (61 + 37) * Epsilon<ET>() * squares,
+      ReduceName("MLSquaredNorm(View)", "R", type, 61, 37));
+    TMLDynamicMatrix<RT> rn(61, 1), cn(1, 37);
+    rn = MLSquaredNorm<EMLReduction::Rowwise>(view);
+    cn = MLSquaredNorm<EMLReduction::Columnwise>(view);
+    const auto addSquare = [](RT x, ET y) { return x + std::norm(y); };
+    CheckClose(rn, NaiveReduce(view, true, RT(0), addSquare), 4.0 * 37 * Epsilon<ET>(),
+      ReduceName("MLSquaredNorm<Rowwise>(View)", "R", type, 61, 37));
+    CheckClose(cn, NaiveReduce(view, false, RT(0), addSquare), 4.0 * 61 * Epsilon<ET>(),
+      ReduceName("MLSquaredNorm<Columnwise>(View)", "R", type, 61, 37));
+
+    // Factors close to one (see TestReduceReal)
+    TMLDynamicMatrix<ET> p(17, 33);
+    for (std::size_t i = 0; i < p.Rows(); i++)
+      for (std::size_t j = 0; j < p.Cols(); j++)
+        p(i, j) = ET(1) + a(i, j) / RT(64);
+    std::complex<double> prod(1.0);
+    for (std::size_t i = 0; i < p.Rows(); i++)
+      for (std::size_t j = 0; j < p.Cols(); j++)
+        prod *= std::complex<double>(p(i, j));
+    Check(std::abs(std::complex<double>(MLProd(p)) - prod) <= 8.0 * 17 * 33 * Epsilon<ET>() * std::abs(prod),
+      ReduceName("MLProd", "R", type, 17, 33));
+  }
+}
+
+void RunReduceTests()
+{
+  TestReduceReal<float, true>("float");
+  TestReduceReal<float, false>("float");
+  TestReduceReal<double, true>("double");
+  TestReduceReal<double, false>("double");
+  TestReduceInt<true>();
+  TestReduceInt<false>();
+  TestReduceComplex<std::complex<float>>("complex<float>");
+  TestReduceComplex<std::complex<double>>("complex<double>");
+}
@@ -0,0 +1,138 @@
+#include <string>
+#include <complex>
+#include <cstdint>
+#include <vector>
+
+#include <MatrixLibrary/Math/Matrix.h>
+
+#include "UnitTest.h"
+
+using namespace ML;
+
+namespace
+{
+  // Small integral values that are exact in every element type (and whose sums and products are exact as well)
+  template<typename T>
+  struct TLaneValue
+  {
+    static T Get(std::size_t i) { return static_cast<T>(i % 11 + 1); }
+  };
+  template<typename T>
+  struct TLaneValue<std::complex<T>>
+  {
+    static std::complex<T> Get(std::size_t i) { return { TLaneValue<T>::Get(i), TLaneValue<T>::Get(i + 5) }; }
+  };
+
+  // Set1, SetZero, unaligned and masked loads/stores of a SIMD type against the scalar lanes
+  template<typename S>
+  void TestSIMDLoadStore(const std::string& type)
+  {
+    using ET = typename S::ElementType;
+    constexpr std::size_t size = S::Size_v;
+    const std::string name = type + " (" + std::to_string(size) + " lanes)";
+
+    std::vector<ET> src(size + 1), dst(size + 1);
+    for (std::size_t i = 0; i < src.size(); i++)
+      src[i] = TLaneValue<ET>::Get(i);
+
+    bool set1 = true, zero = true;
+    const S v1 = S::Set1(src[3]), v0 = S::SetZero();
+    for (std::size_t i = 0; i < size; i++)
+    {
+      set1 = set1 && v1[i] == src[3];
+      zero = zero && v0[i] == ET(0);
+    }
+    Check(set1, "Set1 " + name);
+    Check(zero, "SetZero " + name);
+
+    // Loads and stores from an odd offset (unaligned for every SIMD width)
+    const S v = S::LoadUnaligned(src.data() + 1);
+    S::StoreUnaligned(v, dst.data());
+    bool load = true, store = true;
+    for (std::size_t i = 0; i < size; i++)
+    {
+      load = load && v[i] == src[i + 1];
+      store = store && dst[i] == src[i + 1];
+    }
+    Check(load && store, "LoadUnaligned/StoreUnaligned " + name);
+
+    for (std::size_t n = 0; n <= size; n++)
+    {
+      const S m = S::LoadMasked(src.data() + 1, n);
+      bool maskedLoad = true;
+      for (std::size_t i = 0; i < size; i++)
+        maskedLoad = maskedLoad && m[i] == (i < n ? src[i + 1] : ET(0));
+      Check(maskedLoad, "LoadMasked(" + std::to_string(n) + ") " + name);
+
+      // Elements behind the first n are left untouched
+      std::fill(dst.begin(), dst.end(), ET(0));
+      S::StoreMasked(S::Set1(src[2]), dst.data(), n);
+      bool maskedStore = true;
+      for (std::size_t i = 0; i < dst.size(); i++)
+        maskedStore = maskedStore && dst[i] == (i < n ? src[2] : ET(0));
+      Check(maskedStore, "StoreMasked(" + std::to_string(n) + ") " + name);
+    }
+  }
+
+  // Lane-wise arithmetic of the floating point SIMD types (the values are small integers, i.e. the results are exact)
+  template<typename S>
+  void TestSIMDArithmetic(const std::string& type)
+  {
+    using ET = typename S::ElementType;
+    constexpr std::size_t size = S::Size_v;
+
+    std::vector<ET> a(size), b(size);
+    for (std::size_t i = 0; i < size; i++)
+    {
+      a[i] = TLaneValue<ET>::Get(i);
+      b[i] = TLaneValue<ET>::Get(i + 4);
+    }
+    const S va = S::LoadUnaligned(a.data()), vb = S::LoadUnaligned(b.data());
+    const S sum = va + vb, diff = va - vb, prod = va * vb;
+
+    bool add = true, sub = true, mul = true;
+    for (std::size_t i = 0; i < size; i++)
+    {
+      add = add && sum[i] == a[i] + b[i];
+      sub = sub && diff[i] == a[i] - b[i];
+      mul = mul && prod[i] == a[i] * b[i];
+    }
+    Check(add, "a + b " + type);
+    Check(sub, "a - b " + type);
+    Check(mul, "a * b " + type);
+  }
+
+  // Widest SIMD type of an element type
+  template<typename ET>
+  using TWidestSIMD = TMLSIMDTypeSelector_t<ET, 0xFFFFFFFF>;
+}
+
+void RunSIMDTests()
+{
+  TestSIMDLoadStore<TWidestSIMD<float>>("float");
+  TestSIMDLoadStore<TWidestSIMD<double>>("double");
+  TestSIMDLoadStore<TWidestSIMD<std::complex<float>>>("complex<float>");
+  TestSIMDLoadStore<TWidestSIMD<std::complex<double>>>("complex<double>");
+
+  TestSIMDArithmetic<TWidestSIMD<float>>("float");
+  TestSIMDArithmetic<TWidestSIMD<double>>("double");
+  TestSIMDArithmetic<TWidestSIMD<std::complex<float>>>("complex<float>");
+  TestSIMDArithmetic<TWidestSIMD<std::complex<double>>>("complex<double>");
+
+#if defined(ML_MATH_AVX512F)
+  TestSIMDLoadStore<MLSIMD32fAVX512>("AVX-512 float");
+  TestSIMDLoadStore<MLSIMD64fAVX512>("AVX-512 double");
+  TestSIMDLoadStore<MLSIMD32iAVX512>("AVX-512 int32");
+  TestSIMDLoadStore<MLSIMD64uAVX512>("AVX-512 uint64");
+  TestSIMDLoadStore<MLSIMD8iAVX512>("AVX-512 int8");
+  TestSIMDLoadStore<MLSIMD16uAVX512>("AVX-512 uint16");
+
+  // Set1 of complex integers packs the real and the imaginary part into one integer of twice the width
+  TestSIMDLoadStore<MLSIMD8ciAVX512>("AVX-512 complex<int8>");
+  TestSIMDLoadStore<MLSIMD8cuAVX512>("AVX-512 complex<uint8>");
+  TestSIMDLoadStore<MLSIMD16ciAVX512>("AVX-512 complex<int16>");
+  TestSIMDLoadStore<MLSIMD16cuAVX512>("AVX-512 complex<uint16>");
+  TestSIMDLoadStore<MLSIMD32ciAVX512>("AVX-512 complex<int32>");
+  TestSIMDLoadStore<MLSIMD64ciAVX512>("AVX-512 complex<int64>");
+#endif
+}
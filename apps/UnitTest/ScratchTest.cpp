@@ -0,0 +1,194 @@
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstdint>
+
+#include <MatrixLibrary/Math/Matrix.h>
+#include <MatrixLibrary/Memory/ScratchArena.h>
+
+#include "UnitTest.h"
+
+using namespace ML;
+
+namespace
+{
+  // Results of expressions whose temporaries come from the scratch arena (GEMM packing buffers, copies of
+  // aliased results, materialized operands, reduction and GEMV buffers)
+  struct SScratchResults
+  {
+    TMLDynamicMatrix<double> product, update, aliased, nested, transposed, reduced, gemv;
+  };
+
+  // Evaluates the expressions with temporaries on n x n matrices; the arena of the calling thread must be
+  // empty after every expression
+  bool EvaluateWithScratch(SScratchResults& res, std::size_t n)
+  {
+    const CMLScratchArena& arena = CMLScratchArena::GetThreadLocal();
+    TMLDynamicMatrix<double> a(n, n), b(n, n), c(n, n), x(n, 1);
+    TMLDynamicMatrix<double, false> bc(n, n);
+    FillRandom(a, 1);
+    FillRandom(b, 2);
+    FillRandom(c, 3);
+    FillRandom(x, 4);
+    bc = b;
+    bool empty = true;
+
+    res.product = a * bc;
+    empty = empty && arena.GetUsed() == 0;
+    res.update = a * b + c;
+    empty = empty && arena.GetUsed() == 0;
+    // The result is a factor (copied first)
+    res.aliased = a;
+    res.aliased = res.aliased * b;
+    empty = empty && arena.GetUsed() == 0;
+    // Operands that are products are materialized
+    res.nested = (a * b) * (a + c);
+    empty = empty && arena.GetUsed() == 0;
+    res.transposed = a;
+    res.transposed = MLTranspose(res.transposed) + c;
+    empty = empty && arena.GetUsed() == 0;
+    res.reduced = MLSum<EMLReduction::Columnwise>(a + bc);
+    empty = empty && arena.GetUsed() == 0;
+    res.gemv = a * x;
+    empty = empty && arena.GetUsed() == 0;
+    return empty;
+  }
+
+  // Scalar reference of the expressions of EvaluateWithScratch
+  SScratchResults Reference(std::size_t n)
+  {
+    SScratchResults res;
+    TMLDynamicMatrix<double> a(n, n), b(n, n), c(n, n), x(n, 1), s(n, n);
+    FillRandom(a, 1);
+    FillRandom(b, 2);
+    FillRandom(c, 3);
+    FillRandom(x, 4);
+    res.product = TMLDynamicMatrix<double>(n, n);
+    NaiveGemm(res.product, a, b);
+    res.aliased = res.product;
+    res.update = res.product;
+    for (std::size_t i = 0; i < n; i++)
+      for (std::size_t j = 0; j < n; j++)
+      {
+        res.update(i, j) += c(i, j);
+        s(i, j) = a(i, j) + c(i, j);
+      }
+    res.nested = TMLDynamicMatrix<double>(n, n);
+    NaiveGemm(res.nested, res.product, s);
+    res.transposed = TMLDynamicMatrix<double>(n, n);
+    res.reduced = TMLDynamicMatrix<double>(1, n);
+    for (std::size_t i = 0; i < n; i++)
+      for (std::size_t j = 0; j < n; j++)
+      {
+        res.transposed(i, j) = a(j, i) + c(i, j);
+        res.reduced(0, j) += a(i, j) + b(i, j);
+      }
+    res.gemv = TMLDynamicMatrix<double>(n, 1);
+    NaiveGemm(res.gemv, a, x);
+    return res;
+  }
+
+  bool CheckResults(const SScratchResults& res, const SScratchResults& ref, std::size_t n, const std::string& name)
+  {
+    const double tolerance = 4.0 * GemmTolerance<double>(n) * static_cast<double>(n);
+    const std::string size = " " + std::to_string(n) + "x" + std::to_string(n) + " (" + name + ")";
+    bool ok = CheckClose(res.product, ref.product, GemmTolerance<double>(n), "A * B" + size);
+    ok = CheckClose(res.update, ref.update, GemmTolerance<double>(n), "A * B + C" + size) && ok;
+    ok = CheckClose(res.aliased, ref.aliased, GemmTolerance<double>(n), "A = A * B" + size) && ok;
+    ok = CheckClose(res.nested, ref.nested, tolerance, "(A * B) * (A + C)" + size) && ok;
+    ok = CheckClose(res.transposed, ref.transposed, 0.0, "A = MLTranspose(A) + C" + size) && ok;
+    ok = CheckClose(res.reduced, ref.reduced, 2.0 * static_cast<double>(n) * Epsilon<double>(), "MLSum<Columnwise>(A + B)" + size) && ok;
+    ok = CheckClose(res.gemv, ref.gemv, GemmTolerance<double>(n), "A * x" + size) && ok;
+    return ok;
+  }
+
+  // The same expressions with the default capacity, with a capacity that is too small for the packing
+  // buffers (some temporaries fall back to the heap) and without an arena; the results are identical
+  void TestScratchCapacities()
+  {
+    const std::size_t defaultCapacity = CMLScratchArena::GetDefaultCapacity();
+    for (std::size_t n : { 3, 33, 130, 300 })
+    {
+      const SScratchResults ref = Reference(n);
+      SScratchResults first, res;
+      Check(EvaluateWithScratch(first, n), "arena empty after every expression " + std::to_string(n));
+      CheckResults(first, ref, n, "default capacity");
+
+      for (std::size_t capacity : { std::size_t(4096), std::size_t(0) })
+      {
+        const std::string name = "capacity " + std::to_string(capacity);
+        CMLScratchArena::SetDefaultCapacity(capacity);
+        Check(EvaluateWithScratch(res, n), "arena empty after every expression " + std::to_string(n) + " (" + name + ")");
+        Check(CMLScratchArena::GetThreadLocal().GetCapacity() == capacity, "arena follows the default capacity (" + name + ")");
+        CheckResults(res, ref, n, name);
+        Check(MaxDifference(res.nested, first.nested) == 0.0 && MaxDifference(res.product, first.product) == 0.0,
+          "results independent of the arena " + std::to_string(n) + " (" + name + ")");
+      }
+      CMLScratchArena::SetDefaultCapacity(defaultCapacity);
+    }
+  }
+
+  // Every thread evaluates in its own arena (also the workers of a multithreaded product)
+  void TestScratchThreads()
+  {
+    const std::size_t n = 130;
+    const SScratchResults ref = Reference(n);
+    std::vector<SScratchResults> results(4);
+    std::vector<char> empty(4, 0);
+    std::vector<std::thread> threads;
+    for (std::size_t t = 0; t < 4; t++)
+      threads.emplace_back([&, t]() { empty[t] = EvaluateWithScratch(results[t], n) ? 1 : 0; });
+    for (auto& thread : threads)
+      thread.join();
+    for (std::size_t t = 0; t < 4; t++)
+    {
+      Check(empty[t] != 0, "arena empty after every expression (thread " + std::to_string(t) + ")");
+      CheckResults(results[t], ref, n, "thread " + std::to_string(t));
+    }
+
+    TMLDynamicMatrix<double> a(n, n), b(n, n), c(n, n), p(n, n);
+    FillRandom(a, 1);
+    FillRandom(b, 2);
+    c = (a * b).Threads(4);
+    NaiveGemm(p, a, b);
+    CheckClose(c, p, GemmTolerance<double>(n), "(A * B).Threads(4) with scratch buffers");
+    Check(CMLScratchArena::GetThreadLocal().GetUsed() == 0, "arena empty after (A * B).Threads(4)");
+  }
+
+  // Blocks given back in stack order rewind the arena, blocks given back out of order are reclaimed when
+  // the arena is empty
+  void TestScratchArena()
+  {
+    CMLScratchArena arena;
+    void* a = arena.Allocate(100, 64);
+    void* b = arena.Allocate(200, 32);
+    Check(arena.Owns(a) && arena.Owns(b) && reinterpret_cast<std::uintptr_t>(a) % 64 == 0 &&
+      reinterpret_cast<std::uintptr_t>(b) % 32 == 0, "scratch blocks are aligned and in the buffer");
+    const std::size_t used = arena.GetUsed();
+    arena.Deallocate(b, 200, 32);
+    Check(arena.GetUsed() < used, "scratch arena rewinds in stack order");
+    b = arena.Allocate(200, 32);
+    arena.Deallocate(a, 100, 64);
+    Check(arena.GetUsed() == used, "scratch block given back out of order stays allocated");
+    arena.Deallocate(b, 200, 32);
+    Check(arena.GetUsed() == 0, "scratch arena reclaimed when empty");
+
+    void* big = arena.Allocate(arena.GetCapacity() + 1, 64);
+    Check(!arena.Owns(big) && reinterpret_cast<std::uintptr_t>(big) % 64 == 0 && arena.GetUsed() == 0,
+      "scratch arena falls back to the heap");
+    arena.Deallocate(big, arena.GetCapacity() + 1, 64);
+
+    {
+      TMLScratchArray<float> x(1000, 64), y(10, 64);
+      Check(CMLScratchArena::GetThreadLocal().GetUsed() >= 1010 * sizeof(float), "scratch arrays in the thread arena");
+    }
+    Check(CMLScratchArena::GetThreadLocal().GetUsed() == 0, "scratch arrays given back");
+  }
+}
+
+void RunScratchTests()
+{
+  TestScratchArena();
+  TestScratchCapacities();
+  TestScratchThreads();
+}
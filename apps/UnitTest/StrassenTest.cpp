@@ -0,0 +1,68 @@
+#include <string>
+#include <complex>
+
+#include <MatrixLibrary/Math/Matrix.h>
+
+#include "UnitTest.h"
+
+using namespace ML;
+
+namespace
+{
+  std::string StrassenName(const std::string& type, std::size_t m, std::size_t n, std::size_t k, std::size_t cutoff)
+  {
+    return type + " " + std::to_string(m) + "x" + std::to_string(k) + " * " + std::to_string(k) + "x" +
+      std::to_string(n) + " (cutoff " + std::to_string(cutoff) + ")";
+  }
+
+  // Products with the Strassen-Winograd recursion against the scalar reference. Small cutoffs give several
+  // levels on small shapes and odd dimensions on every level (peeled rows, columns and slices of K).
+  // The error must stay within the bound that is reported by the workspace (the elements are in [-1, 1]).
+  // Matrices that are not vectorized (e.g. complex<double> with SSE2 only) use the classical default kernel.
+  template<typename ET, bool rowMajorA, bool rowMajorB>
+  void TestStrassen(const std::string& type)
+  {
+    const std::string layout = std::string(rowMajorA ? "R" : "C") + (rowMajorB ? "R" : "C") + "R ";
+    const std::size_t shapes[][4] = {
+      { 64, 64, 64, 16 }, { 67, 45, 91, 8 }, { 100, 130, 70, 32 }, { 33, 33, 33, 2 }, { 128, 96, 160, 64 },
+    };
+
+    TMLStrassenWorkspace<ET> workspace;
+    for (const auto& shape : shapes)
+    {
+      const std::size_t m = shape[0], n = shape[1], k = shape[2], cutoff = shape[3];
+      const std::string name = layout + StrassenName(type, m, n, k, cutoff);
+      TMLDynamicMatrix<ET, rowMajorA> a(m, k);
+      TMLDynamicMatrix<ET, rowMajorB> b(k, n);
+      TMLDynamicMatrix<ET> c(m, n), ref(m, n);
+      FillRandom(a, 1);
+      FillRandom(b, 2);
+      NaiveGemm(ref, a, b);
+
+      c = (a * b).Strassen(cutoff, &workspace);
+      if (TMLMatrixIsVectorized_v<TMLDynamicMatrix<ET>>)
+        Check(workspace.Levels() > 0, "Strassen levels > 0 " + name);
+      CheckClose(c, ref, workspace.ErrorBound() + GemmTolerance<ET>(k), "C = (A * B).Strassen " + name);
+
+      // The workspace is reused and only grows for larger products
+      const std::size_t capacity = workspace.Capacity();
+      c = (a * b).Strassen(cutoff, &workspace).Threads(3);
+      Check(workspace.Capacity() == capacity, "Strassen workspace is reused " + name);
+      CheckClose(c, ref, workspace.ErrorBound() + GemmTolerance<ET>(k), "C = (A * B).Strassen.Threads(3) " + name);
+
+      // Temporaries from the scratch arena
+      c = (a * b).Strassen(cutoff);
+      CheckClose(c, ref, workspace.ErrorBound() + GemmTolerance<ET>(k), "C = (A * B).Strassen without workspace " + name);
+    }
+  }
+}
+
+void RunStrassenTests()
+{
+  TestStrassen<float, true, true>("float");
+  TestStrassen<float, false, true>("float");
+  TestStrassen<double, true, true>("double");
+  TestStrassen<double, true, false>("double");
+  TestStrassen<std::complex<float>, true, true>("complex<float>");
+  TestStrassen<std::complex<double>, true, true>("complex<double>");
+}
@@ -0,0 +1,103 @@
+#include <string>
+#include <complex>
+#include <cstdint>
+
+#include <MatrixLibrary/Math/Matrix.h>
+
+#include "UnitTest.h"
+
+using namespace ML;
+
+namespace
+{
+  // Shapes of the SIMD blocks (4x4, 8x8, 16x16), odd shapes with remainders in both dimensions and
+  // large non-square shapes (recursive path)
+  const std::size_t g_transposeShapes[][2] = {
+    { 1, 1 }, { 1, 9 }, { 4, 4 }, { 8, 8 }, { 16, 16 }, { 3, 5 }, { 17, 31 }, { 64, 64 }, { 65, 63 }, { 300, 170 },
+    { 1000, 3 }, { 3, 1000 },
+  };
+
+  std::string TransposeName(const std::string& what, const std::string& type, std::size_t m, std::size_t n)
+  {
+    return what + " " + type + " " + std::to_string(m) + "x" + std::to_string(n);
+  }
+
+  // Checks b == a^T elementwise
+  template<typename A, typename B>
+  bool IsTranspose(const A& a, const B& b)
+  {
+    if (a.Rows() != b.Cols() || a.Cols() != b.Rows())
+      return false;
+    for (std::size_t i = 0; i < a.Rows(); i++)
+      for (std::size_t j = 0; j < a.Cols(); j++)
+        if (!(a(i, j) == b(j, i)))
+          return false;
+    return true;
+  }
+
+  // B = A^T for all layouts of A and B, padded and unpadded
+  template<typename ET, bool rowMajorA, bool rowMajorB, bool padded>
+  void TestTranspose(const std::string& type)
+  {
+    const std::string layout = std::string(rowMajorA ? "R" : "C") + (rowMajorB ? "R" : "C") + (padded ? "" : " unpadded");
+    for (const auto& shape : g_transposeShapes)
+    {
+      const std::size_t m = shape[0], n = shape[1];
+      TMLDynamicMatrix<ET, rowMajorA, 0xFFFFFFFF, padded> a(m, n);
+      TMLDynamicMatrix<ET, rowMajorB, 0xFFFFFFFF, padded> b(n, m);
+      FillRandom(a, 1);
+
+      b = MLTranspose(a);
+      Check(IsTranspose(a, b), TransposeName("B = MLTranspose(A) " + layout, type, m, n));
+
+      const TMLDynamicMatrix<ET, rowMajorB, 0xFFFFFFFF, padded> c = MLTranspose(a);
+      Check(IsTranspose(a, c), TransposeName("C(MLTranspose(A)) " + layout, type, m, n));
+
+      // The storage reinterpreted with the other layout
+      Check(IsTranspose(a, a.Transpose()), TransposeName("A.Transpose() " + layout, type, m, n));
+    }
+  }
+
+  // Square matrices transposed in place
+  template<typename ET, bool rowMajor>
+  void TestTransposeInPlace(const std::string& type)
+  {
+    const std::string layout = rowMajor ? "R " : "C ";
+    for (std::size_t n : { 1, 2, 3, 4, 7, 8, 9, 16, 17, 63, 64, 65, 130 })
+    {
+      TMLDynamicMatrix<ET, rowMajor> a(n, n), ref(n, n);
+      FillRandom(a, 1);
+      ref = a;
+
+      MLTransposeInPlace(a);
+      Check(IsTranspose(ref, a), TransposeName("MLTransposeInPlace(A) " + layout, type, n, n));
+
+      a = MLTranspose(a);
+      Check(MaxDifference(a, ref) == 0.0, TransposeName("A = MLTranspose(A) " + layout, type, n, n));
+    }
+  }
+
+  template<typename ET>
+  void TestTransposeLayouts(const std::string& type)
+  {
+    TestTranspose<ET, true, true, true>(type);
+    TestTranspose<ET, true, false, true>(type);
+    TestTranspose<ET, false, true, true>(type);
+    TestTranspose<ET, false, false, true>(type);
+    TestTranspose<ET, true, true, false>(type);
+    TestTranspose<ET, false, true, false>(type);
+
+    TestTransposeInPlace<ET, true>(type);
+    TestTransposeInPlace<ET, false>(type);
+  }
+}
+
+void RunTransposeTests()
+{
+  TestTransposeLayouts<float>("float");
+  TestTransposeLayouts<double>("double");
+  TestTransposeLayouts<std::complex<float>>("complex<float>");
+  TestTransposeLayouts<std::complex<double>>("complex<double>");
+  TestTransposeLayouts<std::int8_t>("int8");
+  TestTransposeLayouts<std::int16_t>("int16");
+}
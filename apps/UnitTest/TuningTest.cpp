@@ -0,0 +1,81 @@
+#include <string>
+#include <complex>
+
+#include <MatrixLibrary/Math/Matrix.h>
+
+#include "UnitTest.h"
+
+using namespace ML;
+
+namespace
+{
+  // Register tiles of the autotuner (SSE/AVX and AVX-512 candidates, the others fall back to the default tile)
+  const std::size_t g_tiles[][2] = {
+    { 3, 4 }, { 4, 3 }, { 6, 2 }, { 4, 2 }, { 6, 4 }, { 8, 3 }, { 4, 6 }, { 12, 2 },
+  };
+
+  std::string TuningName(const std::string& type, const SMLGemmTuning& t)
+  {
+    return type + " tile " + std::to_string(t.mr) + "x" + std::to_string(t.regsB) + " (kc " + std::to_string(t.kc) +
+      ", mc " + std::to_string(t.mc) + ", nc " + std::to_string(t.nc) + ", small tile " + std::to_string(t.smallMR) +
+      "x" + std::to_string(t.smallRegsB) + ")";
+  }
+
+  // Products with every candidate tile and with block sizes that do not divide the shape (several blocks
+  // along every dimension) against the scalar reference
+  template<typename ET>
+  void TestGemmTuning(const std::string& type)
+  {
+    const SMLGemmTuning previous = MLGetGemmTuning<ET>();
+
+    // Below and above the threshold of the blocked kernel
+    const std::size_t shapes[][3] = { { 5, 7, 3 }, { 37, 29, 41 }, { 131, 97, 75 } };
+    for (const auto& shape : shapes)
+    {
+      const std::size_t m = shape[0], n = shape[1], k = shape[2];
+      TMLDynamicMatrix<ET> a(m, k), b(k, n), c(m, n), ref(m, n);
+      FillRandom(a, 1);
+      FillRandom(b, 2);
+      NaiveGemm(ref, a, b);
+
+      for (const auto& tile : g_tiles)
+      {
+        for (std::size_t blocks : { 0, 1 })
+        {
+          // Block sizes of 0 select the defaults of the tile
+          const SMLGemmTuning tuning = { tile[0], tile[1], blocks ? 19u : 0u, blocks ? 25u : 0u, blocks ? 33u : 0u,
+            tile[0], tile[1] };
+          MLSetGemmTuning<ET>(tuning);
+          const SMLGemmTuning applied = MLGetGemmTuning<ET>();
+          Check(applied.kc > 0 && applied.mc > 0 && applied.nc > 0 && applied.mc % applied.mr == 0,
+            "applied block sizes " + TuningName(type, applied));
+
+          c = a * b;
+          CheckClose(c, ref, GemmTolerance<ET>(k), "C = A * B " + std::to_string(m) + "x" + std::to_string(k) +
+            " * " + std::to_string(k) + "x" + std::to_string(n) + " with " + TuningName(type, applied));
+        }
+      }
+    }
+
+    // Tiles that are not compiled fall back to the default tile
+    MLSetGemmTuning<ET>({ 5, 5, 0, 0, 0, 5, 5 });
+    const SMLGemmTuning fallback = MLGetGemmTuning<ET>();
+    MLSetGemmTuning<ET>({ 0, 0, 0, 0, 0, 0, 0 });
+    const SMLGemmTuning defaults = MLGetGemmTuning<ET>();
+    Check(fallback.mr == defaults.mr && fallback.regsB == defaults.regsB && fallback.smallMR == defaults.smallMR &&
+      fallback.smallRegsB == defaults.smallRegsB, "unknown tile falls back to the default " + TuningName(type, fallback));
+
+    MLSetGemmTuning<ET>(previous);
+    const SMLGemmTuning restored = MLGetGemmTuning<ET>();
+    Check(restored.mr == previous.mr && restored.regsB == previous.regsB && restored.kc == previous.kc &&
+      restored.mc == previous.mc && restored.nc == previous.nc, "restored " + TuningName(type, restored));
+  }
+}
+
+void RunTuningTests()
+{
+  TestGemmTuning<float>("float");
+  TestGemmTuning<double>("double");
+  TestGemmTuning<std::complex<float>>("complex<float>");
+  TestGemmTuning<std::complex<double>>("complex<double>");
+}
@@ -0,0 +1,155 @@
+// Copyright 2021, Philipp Neufeld
+
+#ifndef ML_APPS_UnitTest_H_
+#define ML_APPS_UnitTest_H_
+
+#include <string>
+#include <iostream>
+#include <random>
+#include <complex>
+#include <limits>
+#include <cmath>
+#include <algorithm>
+#include <cstddef>
+#include <type_traits>
+
+// Test suites (selected by name on the command line)
+void RunGemmTests();
+void RunSIMDTests();
+void RunPaddingTests();
+void RunTuningTests();
+void RunEpilogueTests();
+void RunBatchTests();
+void RunStrassenTests();
+void RunGemvTests();
+void RunElementwiseTests();
+void RunGemmUpdateTests();
+void RunTransposeTests();
+void RunViewTests();
+void RunReduceTests();
+void RunMathTests();
+void RunBroadcastTests();
+void RunAllocatorTests();
+void RunCapacityTests();
+void RunScratchTests();
+
+// Number of checks and failed checks of all suites
+struct STestCounts
+{
+  std::size_t checks = 0;
+  std::size_t failures = 0;
+};
+
+inline STestCounts& GetTestCounts()
+{
+  static STestCounts counts;
+  return counts;
+}
+
+// Records a check, failures are printed with the name of the check
+inline bool Check(bool condition, const std::string& name)
+{
+  GetTestCounts().checks++;
+  if (!condition)
+  {
+    GetTestCounts().failures++;
+    std::cout << "FAILED: " << name << std::endl;
+  }
+  return condition;
+}
+
+// Random numbers in [-1, 1] (integers in [-100, 100])
+template<typename T, typename=void>
+struct TRandomValue
+{
+  template<typename Gen> static T Get(Gen& gen) { return static_cast<T>(std::uniform_real_distribution<double>(-1.0, 1.0)(gen)); }
+};
+template<typename T>
+struct TRandomValue<T, std::enable_if_t<std::is_integral<T>::value>>
+{
+  template<typename Gen> static T Get(Gen& gen) { return static_cast<T>(std::uniform_int_distribution<int>(-100, 100)(gen)); }
+};
+template<typename T>
+struct TRandomValue<std::complex<T>, void>
+{
+  template<typename Gen> static std::complex<T> Get(Gen& gen) { return { TRandomValue<T>::Get(gen), TRandomValue<T>::Get(gen) }; }
+};
+
+// The elements are generated in the order (0, 0), (0, 1), ..., i.e. matrices of different layouts that are
+// filled with the same seed hold the same elements
+template<typename MT>
+void FillRandom(MT& mat, unsigned int seed = 42)
+{
+  std::mt19937 gen(seed);
+  for (std::size_t i = 0; i < mat.Rows(); i++)
+    for (std::size_t j = 0; j < mat.Cols(); j++)
+      mat(i, j) = TRandomValue<typename MT::ElementType>::Get(gen);
+}
+
+// Machine epsilon of the real type of ET
+template<typename ET>
+double Epsilon()
+{
+  using RealType = decltype(std::abs(ET()));
+  return static_cast<double>(std::numeric_limits<RealType>::epsilon());
+}
+
+// Largest absolute difference of the elements of two matrices of the same shape (infinite if the shapes differ)
+template<typename A, typename B>
+double MaxDifference(const A& a, const B& b)
+{
+  if (a.Rows() != b.Rows() || a.Cols() != b.Cols())
+    return std::numeric_limits<double>::infinity();
+
+  double diff = 0.0;
+  for (std::size_t i = 0; i < a.Rows(); i++)
+  {
+    for (std::size_t j = 0; j < a.Cols(); j++)
+    {
+      const double d = static_cast<double>(std::abs(a(i, j) - b(i, j)));
+      diff = std::isnan(d) ? std::numeric_limits<double>::infinity() : std::max(diff, d);
+    }
+  }
+  return diff;
+}
+
+// Checks that the result is within the tolerance of the reference (absolute difference of every element)
+template<typename A, typename B>
+bool CheckClose(const A& result, const B& reference, double tolerance, const std::string& name)
+{
+  const double diff = MaxDifference(result, reference);
+  return Check(diff <= tolerance, name + " (max difference " + std::to_string(diff) + ", tolerance " +
+    std::to_string(tolerance) + ")");
+}
+
+// c += a * b (the complex product is spelled out, std::complex checks for infinities in unoptimized builds)
+template<typename T>
+void MulAdd(T& c, const T& a, const T& b) { c += a * b; }
+template<typename T>
+void MulAdd(std::complex<T>& c, const std::complex<T>& a, const std::complex<T>& b)
+{
+  c = std::complex<T>(c.real() + a.real() * b.real() - a.imag() * b.imag(), c.imag() + a.real() * b.imag() + a.imag() * b.real());
+}
+
+// Scalar reference of C = A * B (i-k-j loop order through operator())
+template<typename C, typename A, typename B>
+void NaiveGemm(C& c, const A& a, const B& b)
+{
+  using ET = typename C::ElementType;
+  for (std::size_t i = 0; i < c.Rows(); i++)
+    for (std::size_t j = 0; j < c.Cols(); j++)
+      c(i, j) = ET(0);
+  for (std::size_t i = 0; i < c.Rows(); i++)
+    for (std::size_t k = 0; k < a.Cols(); k++)
+      for (std::size_t j = 0; j < c.Cols(); j++)
+        MulAdd(c(i, j), a(i, k), b(k, j));
+}
+
+// Tolerance of a product with an inner dimension of k and elements in [-1, 1]
+template<typename ET>
+double GemmTolerance(std::size_t k)
+{
+  return 4.0 * static_cast<double>(k + 1) * Epsilon<ET>();
+}
+
+#endif
@@ -0,0 +1,172 @@
+#include <string>
+#include <complex>
+#include <algorithm>
+
+#include <MatrixLibrary/Math/Matrix.h>
+
+#include "UnitTest.h"
+
+using namespace ML;
+
+namespace
+{
+  // Elements of a matrix or a view as a row-major dynamic matrix (a snapshot of the operands of the reference)
+  template<typename MT>
+  TMLDynamicMatrix<typename MT::ElementType> Copy(const MT& mat)
+  {
+    TMLDynamicMatrix<typename MT::ElementType> res(mat.Rows(), mat.Cols());
+    for (std::size_t i = 0; i < mat.Rows(); i++)
+      for (std::size_t j = 0; j < mat.Cols(); j++)
+        res(i, j) = mat(i, j);
+    return res;
+  }
+
+  // Writes src into the block of dst at (row, col)
+  template<typename D, typename S>
+  void Paste(D& dst, std::size_t row, std::size_t col, const S& src)
+  {
+    for (std::size_t i = 0; i < src.Rows(); i++)
+      for (std::size_t j = 0; j < src.Cols(); j++)
+        dst(row + i, col + j) = src(i, j);
+  }
+
+  // Views at odd offsets (unaligned, spacing larger than the view) as operands and as results of
+  // elementwise expressions and products. The elements around a result view must not change.
+  template<typename ET, bool rowMajor>
+  void TestViewOperands(const std::string& type)
+  {
+    const std::string layout = rowMajor ? " (row-major) " : " (column-major) ";
+    const std::size_t sizes[][3] = { { 3, 5, 2 }, { 17, 19, 23 }, { 70, 65, 90 } };
+    for (const auto& size : sizes)
+    {
+      const std::size_t m = size[0], n = size[1], k = size[2];
+      const std::string name = type + layout + std::to_string(m) + "x" + std::to_string(n) + "x" + std::to_string(k);
+      TMLDynamicMatrix<ET, rowMajor> a(m + 5, k + 7), b(k + 3, n + 9), c(m + 4, n + 2);
+      FillRandom(a, 1);
+      FillRandom(b, 2);
+      FillRandom(c, 3);
+      const auto va = MLSubmatrix(a, 3, 5, m, k);
+      const auto vb = MLSubmatrix(b, 1, 7, k, n);
+      auto vc = MLSubmatrix(c, 1, 1, m, n);
+
+      // Product into a view
+      TMLDynamicMatrix<ET> ab(m, n), ref = Copy(c);
+      NaiveGemm(ab, Copy(va), Copy(vb));
+      Paste(ref, 1, 1, ab);
+      vc = va * vb;
+      CheckClose(c, ref, GemmTolerance<ET>(k), "View = View * View " + name);
+
+      // Elementwise expressions of views of different matrices
+      const auto va2 = MLSubmatrix(a, 2, 1, m, n < k + 6 ? n : k + 6);
+      const auto vc2 = MLSubmatrix(c, 0, 2, m, va2.Cols());
+      TMLDynamicMatrix<ET> sum = Copy(va2);
+      const auto copyC2 = Copy(vc2);
+      for (std::size_t i = 0; i < sum.Rows(); i++)
+        for (std::size_t j = 0; j < sum.Cols(); j++)
+          sum(i, j) = sum(i, j) + copyC2(i, j) - ET(2) * copyC2(i, j);
+      TMLDynamicMatrix<ET> d(m, va2.Cols());
+      d = va2 + vc2 - ET(2) * vc2;
+      CheckClose(d, sum, 4.0 * Epsilon<ET>(), "D = View + View - 2 * View " + name);
+
+      // Rows and columns
+      ref = Copy(c);
+      for (std::size_t j = 0; j < c.Cols(); j++)
+        ref(m, j) = c(m, j) + c(0, j);
+      MLRow(c, m) = MLRow(c, m) + MLRow(c, 0);
+      CheckClose(c, ref, 0.0, "Row(C, m) = Row(C, m) + Row(C, 0) " + name);
+      for (std::size_t i = 0; i < c.Rows(); i++)
+        ref(i, n + 1) = ET(3) * c(i, 0);
+      MLColumn(c, n + 1) = ET(3) * MLColumn(c, 0);
+      CheckClose(c, ref, 0.0, "Column(C, n + 1) = 3 * Column(C, 0) " + name);
+
+      // Diagonal (a strided column vector)
+      TMLDynamicMatrix<ET> x(std::min(c.Rows(), c.Cols()), 1);
+      FillRandom(x, 4);
+      ref = Copy(c);
+      for (std::size_t i = 0; i < x.Rows(); i++)
+        ref(i, i) = x(i, 0) - c(i, i);
+      MLDiagonal(c) = x - MLDiagonal(c);
+      CheckClose(c, ref, 0.0, "Diagonal(C) = x - Diagonal(C) " + name);
+    }
+  }
+
+  // Results that overlap with their operands: the same block, shifted blocks and transposed blocks
+  template<typename ET, bool rowMajor>
+  void TestViewAliasing(const std::string& type)
+  {
+    const std::string layout = rowMajor ? " (row-major) " : " (column-major) ";
+    for (std::size_t n : { 4, 17, 70 })
+    {
+      const std::string name = type + layout + std::to_string(n) + "x" + std::to_string(n);
+      TMLDynamicMatrix<ET, rowMajor> a(n + 2, n + 2), b(n, n);
+      FillRandom(b, 2);
+      const double tolerance = 2.0 * GemmTolerance<ET>(n);
+
+      // Same block: A = A * B
+      FillRandom(a, 1);
+      TMLDynamicMatrix<ET> ref = Copy(a), p(n, n);
+      NaiveGemm(p, Copy(MLSubmatrix(a, 1, 1, n, n)), b);
+      Paste(ref, 1, 1, p);
+      MLSubmatrix(a, 1, 1, n, n) = MLSubmatrix(a, 1, 1, n, n) * b;
+      CheckClose(a, ref, tolerance, "View = View * B " + name);
+
+      // Shifted block as a factor
+      FillRandom(a, 1);
+      ref = Copy(a);
+      NaiveGemm(p, Copy(MLSubmatrix(a, 0, 0, n, n)), b);
+      Paste(ref, 2, 1, p);
+      MLSubmatrix(a, 2, 1, n, n) = MLSubmatrix(a, 0, 0, n, n) * b;
+      CheckClose(a, ref, tolerance, "View = shifted View * B " + name);
+
+      // Shifted block as the matrix of a GEMM update
+      FillRandom(a, 1);
+      ref = Copy(a);
+      NaiveGemm(p, b, b);
+      const auto shifted = Copy(MLSubmatrix(a, 1, 0, n, n));
+      for (std::size_t i = 0; i < n; i++)
+        for (std::size_t j = 0; j < n; j++)
+          p(i, j) += shifted(i, j);
+      Paste(ref, 0, 1, p);
+      MLSubmatrix(a, 0, 1, n, n) = b * b + MLSubmatrix(a, 1, 0, n, n);
+      CheckClose(a, ref, tolerance, "View = B * B + shifted View " + name);
+
+      // Shifted blocks of an elementwise expression
+      FillRandom(a, 1);
+      ref = Copy(a);
+      const auto s1 = Copy(MLSubmatrix(a, 1, 2, n, n));
+      const auto s2 = Copy(MLSubmatrix(a, 2, 0, n, n));
+      for (std::size_t i = 0; i < n; i++)
+        for (std::size_t j = 0; j < n; j++)
+          ref(i, j) = s1(i, j) - s2(i, j);
+      MLSubmatrix(a, 0, 0, n, n) = MLSubmatrix(a, 1, 2, n, n) - MLSubmatrix(a, 2, 0, n, n);
+      CheckClose(a, ref, 0.0, "View = shifted View - shifted View " + name);
+
+      // Transpose of the same block (in place) and of a shifted block
+      FillRandom(a, 1);
+      ref = Copy(a);
+      const auto block = Copy(MLSubmatrix(a, 1, 1, n, n));
+      Paste(ref, 1, 1, Copy(MLTranspose(block)));
+      MLSubmatrix(a, 1, 1, n, n) = MLTranspose(MLSubmatrix(a, 1, 1, n, n));
+      CheckClose(a, ref, 0.0, "View = MLTranspose(View) " + name);
+
+      FillRandom(a, 1);
+      ref = Copy(a);
+      Paste(ref, 0, 1, Copy(MLTranspose(Copy(MLSubmatrix(a, 1, 0, n, n)))));
+      MLSubmatrix(a, 0, 1, n, n) = MLTranspose(MLSubmatrix(a, 1, 0, n, n));
+      CheckClose(a, ref, 0.0, "View = MLTranspose(shifted View) " + name);
+    }
+  }
+}
+
+void RunViewTests()
+{
+  TestViewOperands<float, true>("float");
+  TestViewOperands<float, false>("float");
+  TestViewOperands<double, true>("double");
+  TestViewOperands<std::complex<double>, false>("complex<double>");
+
+  TestViewAliasing<float, true>("float");
+  TestViewAliasing<double, true>("double");
+  TestViewAliasing<double, false>("double");
+  TestViewAliasing<std::complex<float>, true>("complex<float>");
+}
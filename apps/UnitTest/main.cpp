@@ -0,0 +1,56 @@
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <utility>
+#include <iostream>
+
+#if defined(ML_RUNTIME_DISPATCH)
+#include <MatrixLibrary/Math/Kernels/Dispatch.h>
+#endif
+
+#include "UnitTest.h"
+
+// Usage: UnitTest [suite...]  (runs all suites if none is given)
+// Returns a non-zero exit code if a check fails
+int main(int argc, char** argv)
+{
+  const std::vector<std::pair<std::string, void(*)()>> suites = {
+    { "simd", &RunSIMDTests },
+    { "gemm", &RunGemmTests },
+    { "padding", &RunPaddingTests },
+    { "tuning", &RunTuningTests },
+    { "epilogue", &RunEpilogueTests },
+    { "batch", &RunBatchTests },
+    { "strassen", &RunStrassenTests },
+    { "gemv", &RunGemvTests },
+    { "elementwise", &RunElementwiseTests },
+    { "gemmupdate", &RunGemmUpdateTests },
+    { "transpose", &RunTransposeTests },
+    { "view", &RunViewTests },
+    { "reduce", &RunReduceTests },
+    { "math", &RunMathTests },
+    { "broadcast", &RunBroadcastTests },
+    { "allocator", &RunAllocatorTests },
+    { "capacity", &RunCapacityTests },
+    { "scratch", &RunScratchTests },
+  };
+
+#if defined(ML_RUNTIME_DISPATCH)
+  std::cout << "Runtime dispatch: " << ML::MLGetSIMDLevelName(ML::MLGetSIMDLevel()) << " kernels" << std::endl;
+#endif
+
+  std::vector<std::string> selected(argv + 1, argv + argc);
+  for (const auto& suite : suites)
+  {
+    if (selected.empty() || std::find(selected.begin(), selected.end(), suite.first) != selected.end())
+    {
+      const std::size_t failures = GetTestCounts().failures;
+      suite.second();
+      std::cout << suite.first << ": " << (GetTestCounts().failures == failures ? "passed" : "FAILED") << std::endl;
+    }
+  }
+
+  const STestCounts& counts = GetTestCounts();
+  std::cout << counts.checks - counts.failures << " of " << counts.checks << " checks passed" << std::endl;
+  return counts.failures == 0 ? 0 : 1;
+}
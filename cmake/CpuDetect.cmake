@@ -1,5 +1,7 @@
 
 include(CheckFlags)
+
+option(ML_USE_AVX512 "Use AVX-512 instructions if they are supported by the cpu" ON)
  
 # Detecting CPU
 set(CMAKE_TRY_COMPILE_TARGET_TYPE, EXECUTABLE)
@@ -73,9 +75,33 @@ if(CPU_DETECT_COMPILED)
         set(ML_AVX2_TEST_SNIPPET
             "${ML_AVX_TEST_SNIPPET};{auto x=_mm256_set1_epi32(1);x=_mm256_abs_epi32(x);}"
         )
+        set(ML_AVX512_TEST_SNIPPET
+            "${ML_AVX2_TEST_SNIPPET};{auto x=_mm512_set1_epi16(1);x=_mm512_abs_epi16(x);auto y=_mm512_set1_pd(0.5);y=_mm512_and_pd(y,y);}"
+        )
         
         set(ML_AVX_SSE_COMPILER_FLAG_FOUND FALSE)
 
+        # AVX-512 (foundation, double/quadword and byte/word instructions)
+        if (ML_USE_AVX512 AND 
+            CPU_DETECTION_OUTPUT MATCHES ".*Features:.* avx512f .*" AND
+            CPU_DETECTION_OUTPUT MATCHES ".*Features:.* avx512dq .*" AND
+            CPU_DETECTION_OUTPUT MATCHES ".*Features:.* avx512bw .*")
+            if (NOT ML_AVX_SSE_COMPILER_FLAG_FOUND)
+                set(ML_AVX512_TEST_SOURCE 
+                    "#include<immintrin.h>
+                    int main(){${ML_AVX512_TEST_SNIPPET};return 0;}"
+                )
+                ml_select_flag(COMPILER_FLAG_AVX512 
+                "${ML_AVX512_TEST_SOURCE}" "${SIMD_COMPILER_FLAGS}" 
+                    "/arch:AVX512" "-mavx512f -mavx512dq -mavx512bw"
+                )
+                set(SIMD_COMPILER_FLAGS "${SIMD_COMPILER_FLAGS} ${COMPILER_FLAG_AVX512}")
+                set(ML_AVX_SSE_COMPILER_FLAG_FOUND TRUE)
+            endif()
+            set(SIMD_MACRO_DEFINITIONS "${SIMD_MACRO_DEFINITIONS} ML_AVX512F=1 ML_AVX512DQ=1 ML_AVX512BW=1")
+            message("CPU support for AVX-512 (F, DQ, BW) has been verified")
+        endif()
+
         # AVX 2 
         if (CPU_DETECTION_OUTPUT MATCHES ".*Features:.* avx2 .*")
             if (NOT ML_AVX_SSE_COMPILER_FLAG_FOUND)
@@ -221,6 +247,17 @@ if(CPU_DETECT_COMPILED)
         endif()
 
         unset(ML_AVX_SSE_COMPILER_FLAG_FOUND)
+
+        ############# Caches ##############
+        foreach(ML_CACHE_LEVEL IN ITEMS l1d l2 l3)
+            if (CPU_DETECTION_OUTPUT MATCHES ".*Caches:.* ${ML_CACHE_LEVEL}=([0-9]+) .*")
+                if (NOT CMAKE_MATCH_1 EQUAL 0)
+                    string(TOUPPER "${ML_CACHE_LEVEL}" ML_CACHE_LEVEL_UPPER)
+                    set(SIMD_MACRO_DEFINITIONS "${SIMD_MACRO_DEFINITIONS} ML_CACHE_${ML_CACHE_LEVEL_UPPER}=${CMAKE_MATCH_1}")
+                    message("Detected ${ML_CACHE_LEVEL} cache size: ${CMAKE_MATCH_1} bytes")
+                endif()
+            endif()
+        endforeach()
         
         message("Vectorization compiler flags: ${SIMD_COMPILER_FLAGS}")
 
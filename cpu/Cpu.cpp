@@ -27,6 +27,10 @@ namespace ML
     m_f_7_ecx = 0;
     m_f_81_ecx = 0;
     m_f_81_edx = 0;
+    m_xcr0 = 0;
+    m_cacheL1d = 0;
+    m_cacheL2 = 0;
+    m_cacheL3 = 0;
 
     SMLX86Registers regs = { 0, 0, 0, 0 };
 
@@ -49,6 +53,10 @@ namespace ML
 
       m_f_1_ecx = regs.ecx;
       m_f_1_edx = regs.edx;
+
+      // register state that is saved by the os (requires osxsave)
+      if (CMLCpu::IsBitSet(m_f_1_ecx, 27))
+        m_xcr0 = CMLCpu::Xgetbv(0);
     }
 
     if (max_supported_id >= 7)
@@ -64,7 +72,7 @@ namespace ML
     regs.eax = 0x80000000;
     regs.ecx = 0;
     CMLCpu::Cpuid(&regs);
-    int max_supported_ExtId = regs.eax;
+    unsigned int max_supported_ExtId = static_cast<unsigned int>(regs.eax);
 
     if (max_supported_ExtId >= 0x80000001)
     {
@@ -90,12 +98,64 @@ namespace ML
         *reinterpret_cast<int*>(m_szBrand + 12 + i * 16) = regs.edx;
       }
     }
+
+    // Intel reports the cache hierarchy in leaf 4, AMD uses the 
+    // extended leaf 0x8000001D with the identical register layout
+    if (std::strcmp(m_szVendor, "GenuineIntel") == 0 && max_supported_id >= 4)
+      DetectCaches(4);
+    else if (std::strcmp(m_szVendor, "AuthenticAMD") == 0 && max_supported_ExtId >= 0x8000001D)
+      DetectCaches(0x8000001D);
+  }
+
+  void CMLCpu::DetectCaches(int leaf)
+  {
+    SMLX86Registers regs = { 0, 0, 0, 0 };
+
+    for (int i = 0; ; i++)
+    {
+      regs.eax = leaf;
+      regs.ecx = i;
+      CMLCpu::Cpuid(&regs);
+
+      const int type = regs.eax & 0x1F; // 0: no more caches, 1: data, 2: instruction, 3: unified
+      if (type == 0)
+        break;
+      if (type == 2)
+        continue;
+
+      const int level = (regs.eax >> 5) & 0x07;
+      const std::size_t ways = ((regs.ebx >> 22) & 0x3FF) + 1;
+      const std::size_t partitions = ((regs.ebx >> 12) & 0x3FF) + 1;
+      const std::size_t lineSize = (regs.ebx & 0xFFF) + 1;
+      const std::size_t sets = static_cast<std::size_t>(regs.ecx) + 1;
+      const std::size_t size = ways * partitions * lineSize * sets;
+
+      if (level == 1)
+        m_cacheL1d = size;
+      else if (level == 2)
+        m_cacheL2 = size;
+      else if (level == 3)
+        m_cacheL3 = size;
+    }
   }
 
   CMLCpu::~CMLCpu()
   {
   }
 
+  unsigned long long CMLCpu::Xgetbv(unsigned int index)
+  {
+#if defined(ML_COMPILER_MSVC)
+    return _xgetbv(index);
+#elif defined(ML_COMPILER_GNUC) || defined(ML_COMPILER_CLANG)
+    unsigned int eax, edx;
+    __asm__ __volatile__("xgetbv" : "=a"(eax), "=d"(edx) : "c"(index));
+    return (static_cast<unsigned long long>(edx) << 32) | eax;
+#else
+#error Please add compiler support for CMLCpu::Xgetbv on your compiler.
+#endif
+  }
+
   void CMLCpu::Cpuid(SMLX86Registers* pRegisters)
   {
     if (pRegisters)
@@ -149,6 +209,18 @@ int main()
 		output += " avx ";
 	if (cpu.HasAVX2())
 		output += " avx2 ";
+	if (cpu.HasAVX512F())
+		output += " avx512f ";
+	if (cpu.HasAVX512DQ())
+		output += " avx512dq ";
+	if (cpu.HasAVX512BW())
+		output += " avx512bw ";
+	output += "\n";
+
+	output += "Caches: ";
+	output += " l1d=" + std::to_string(cpu.GetL1DataCacheSize()) + " ";
+	output += " l2=" + std::to_string(cpu.GetL2CacheSize()) + " ";
+	output += " l3=" + std::to_string(cpu.GetL3CacheSize()) + " ";
 	output += "\n";
 
 	std::cout << output << std::endl;
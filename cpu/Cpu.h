@@ -4,6 +4,7 @@
 #define ML_Cpu_H_
 
 #include <string>
+#include <cstddef>
 
 namespace ML
 {
@@ -42,9 +43,22 @@ namespace ML
       bool HasAVX() const { return CMLCpu::IsBitSet(m_f_1_ecx, 28) && CMLCpu::IsBitSet(m_f_1_ecx, 27); }
       bool HasAVX2() const { return CMLCpu::IsBitSet(m_f_7_ebx, 5) && CMLCpu::IsBitSet(m_f_1_ecx, 27); }
 
+      // the os must additionally save the opmask and zmm registers (XCR0 bits 5-7) for AVX-512
+      bool HasAVX512F() const { return CMLCpu::IsBitSet(m_f_7_ebx, 16) && HasAVX512OSSupport(); }
+      bool HasAVX512DQ() const { return CMLCpu::IsBitSet(m_f_7_ebx, 17) && HasAVX512OSSupport(); }
+      bool HasAVX512BW() const { return CMLCpu::IsBitSet(m_f_7_ebx, 30) && HasAVX512OSSupport(); }
+
+      // Cache sizes in bytes (0 if the cache level could not be detected)
+      std::size_t GetL1DataCacheSize() const { return m_cacheL1d; }
+      std::size_t GetL2CacheSize() const { return m_cacheL2; }
+      std::size_t GetL3CacheSize() const { return m_cacheL3; }
+
     private:
       static void Cpuid(SMLX86Registers* pRegisters);
       static bool IsBitSet(int flag, int bitNum) { return !!(flag & (1 << bitNum)); }
+      static unsigned long long Xgetbv(unsigned int index);
+      bool HasAVX512OSSupport() const { return (m_xcr0 & 0xE6) == 0xE6; }
+      void DetectCaches(int leaf);
 
     private:
       char m_szVendor[0x10];	// 12 + zero terminator + padding
@@ -56,6 +70,11 @@ namespace ML
       int m_f_7_ecx;
       int m_f_81_ecx;
       int m_f_81_edx;
+      unsigned long long m_xcr0;
+
+      std::size_t m_cacheL1d;
+      std::size_t m_cacheL2;
+      std::size_t m_cacheL3;
     };
 
 }
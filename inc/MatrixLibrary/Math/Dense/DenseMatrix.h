@@ -4,6 +4,10 @@
 #define ML_MATH_Dense_DenseMatrix_H_
 
 // Includes
+#include <cstdint>
+#include <cstddef>
+#include <type_traits>
+
 #include "../Matrix.h"
 
 namespace ML
@@ -24,9 +28,86 @@ namespace ML
   template<typename MT>
   constexpr bool TMLMatrixIsDense_v = TMLMatrixIsDense<MT>::value;
 
+  //
+  // Alias detection
+  //
+  namespace Internal
+  {
+    // Do two blocks of memory share elements? A block consists of 'lines' lines (rows or columns) of 'length'
+    // elements that start 'spacing' elements apart. Blocks with the same spacing (e.g. two blocks of one matrix)
+    // are compared line by line, i.e. the left and the right half of a matrix are disjoint. Otherwise the
+    // blocks overlap if their address ranges do.
+    template<typename ET1, typename ET2>
+    bool MLIsOverlapping(const ET1* a, std::size_t aLines, std::size_t aLength, std::size_t aSpacing,
+      const ET2* b, std::size_t bLines, std::size_t bLength, std::size_t bSpacing) noexcept
+    {
+      if (aLines == 0 || aLength == 0 || bLines == 0 || bLength == 0)
+        return false;
+
+      const std::uintptr_t a0 = reinterpret_cast<std::uintptr_t>(a);
+      const std::uintptr_t a1 = reinterpret_cast<std::uintptr_t>(a + (aLines - 1) * aSpacing + aLength);
+      const std::uintptr_t b0 = reinterpret_cast<std::uintptr_t>(b);
+      const std::uintptr_t b1 = reinterpret_cast<std::uintptr_t>(b + (bLines - 1) * bSpacing + bLength);
+      if (a1 <= b0 || b1 <= a0)
+        return false;
+      
+      const std::uintptr_t distance = b0 >= a0 ? b0 - a0 : a0 - b0;
+      if (sizeof(ET1) != sizeof(ET2) || aSpacing != bSpacing || aLength > aSpacing || bLength > bSpacing || 
+        distance % sizeof(ET1) != 0)
+        return true;
+
+      // First element of b on the grid of lines of a (b must not wrap around into the next line of the grid)
+      const std::ptrdiff_t spacing = static_cast<std::ptrdiff_t>(aSpacing);
+      const std::ptrdiff_t offset = (b0 >= a0 ? 1 : -1) * static_cast<std::ptrdiff_t>(distance / sizeof(ET1));
+      std::ptrdiff_t line = offset / spacing;
+      std::ptrdiff_t pos = offset % spacing;
+      if (pos < 0)
+      {
+        pos += spacing;
+        line--;
+      }
+      if (pos + static_cast<std::ptrdiff_t>(bLength) > spacing)
+        return true;
+
+      return line < static_cast<std::ptrdiff_t>(aLines) && line + static_cast<std::ptrdiff_t>(bLines) > 0 &&
+        pos < static_cast<std::ptrdiff_t>(aLength);
+    }
+
+    // Do the dense matrices a and b (e.g. a matrix and a view of it) share elements?
+    template<typename A, typename B>
+    bool MLIsOverlapping(const TMLDenseMatrix<A>& a, const TMLDenseMatrix<B>& b) noexcept
+    {
+      constexpr bool aRowMajor = TMLMatrixIsRowMajor_v<A>;
+      constexpr bool bRowMajor = TMLMatrixIsRowMajor_v<B>;
+      return MLIsOverlapping(
+        (~a).Data(), aRowMajor ? (~a).Rows() : (~a).Cols(), aRowMajor ? (~a).Cols() : (~a).Rows(), (~a).Spacing(),
+        (~b).Data(), bRowMajor ? (~b).Rows() : (~b).Cols(), bRowMajor ? (~b).Cols() : (~b).Rows(), (~b).Spacing());
+    }
+
+    // Are a and b the same elements at the same positions (e.g. a matrix and itself)? Elementwise operations
+    // can be computed in place then.
+    template<typename A, typename B>
+    bool MLIsSameBlock(const TMLDenseMatrix<A>& a, const TMLDenseMatrix<B>& b) noexcept
+    {
+      return std::is_same<TMLMatrixElementType_t<A>, TMLMatrixElementType_t<B>>::value &&
+        TMLMatrixIsRowMajor_v<A> == TMLMatrixIsRowMajor_v<B> &&
+        static_cast<const void*>((~a).Data()) == static_cast<const void*>((~b).Data()) &&
+        (~a).Spacing() == (~b).Spacing() && (~a).Rows() == (~b).Rows() && (~a).Cols() == (~b).Cols();
+    }
+
+    // Do a and b share elements at different positions (e.g. a matrix and its shifted view)?
+    template<typename A, typename B>
+    bool MLIsPartialOverlap(const TMLDenseMatrix<A>& a, const TMLDenseMatrix<B>& b) noexcept
+    {
+      return MLIsOverlapping(a, b) && !MLIsSameBlock(a, b);
+    }
+  }
+
 }
 
 #include "StaticMatrix.h"
 #include "DynamicMatrix.h"
+#include "DenseMatrixView.h"
+#include "MatrixBatch.h"
 
 #endif
\ No newline at end of file
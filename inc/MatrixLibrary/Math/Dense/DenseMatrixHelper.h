@@ -17,6 +17,7 @@ namespace ML
   public:
     void SetZero() { (~(*this)).Assign(TMLDMSetZeroExpression<MT>((~(*this)).Rows(), (~(*this)).Cols())); }
     template<typename ET> void Set1(ET value) { (~(*this)).Assign(TMLDMSet1Expression<MT>(value, (~(*this)).Rows(), (~(*this)).Cols())); }
+    // The storage reinterpreted with the other layout (no copy, see MLTranspose for a transposed copy)
     const auto& Transpose() { return *reinterpret_cast<typename MT::TransposeType*>(&(~(*this))); }
   };
 
@@ -0,0 +1,233 @@
+// Copyright 2021, Philipp Neufeld
+
+#ifndef ML_MATH_Dense_DenseMatrixView_H_
+#define ML_MATH_Dense_DenseMatrixView_H_
+
+// Includes
+#include <cassert>
+#include <cstdint>
+#include <algorithm>
+#include <type_traits>
+#include <utility>
+
+#include "DenseMatrix.h"
+#include "DenseMatrixHelper.h"
+#include "DynamicMatrix.h"
+#include "../SIMD/SIMD.h"
+
+#include "../../QTL/Type.h"
+#include "../../QTL/EnableIf.h"
+#include "../../QTL/Boolean.h"
+
+namespace ML
+{
+
+  // Block of the elements of another dense matrix without a copy (see MLSubmatrix, MLRow, MLColumn and
+  // MLDiagonal). The view addresses the elements through its own data pointer and spacing and is used like
+  // a dynamic matrix of that layout, as operand of expressions and as their result. Assigning to a view
+  // writes the viewed elements (a view is never resized), copying a view gives a second view of the same
+  // elements. ET is const for views of constant matrices, SIMD is the SIMD type of the viewed matrix.
+  template<typename ET, bool RowMajor, typename SIMD>
+  class TMLDenseMatrixView : public TMLDenseMatrixHelper<TMLDenseMatrixView<ET, RowMajor, SIMD>>
+  {
+  public:
+    // befriend TMLMatrixExpression in order to let it access the SIMD iterator methods
+    template<typename T> friend class TMLMatrixExpression;
+
+    // Type aliases
+    using MyT = TMLDenseMatrixView<ET, RowMajor, SIMD>;
+    using TransposeType = TMLDenseMatrixView<ET, !RowMajor, SIMD>;
+    using ElementType = std::remove_const_t<ET>;
+    using SIMDType = SIMD;
+
+    constexpr static std::size_t SIMDSize = TMLSIMDSize_v<SIMDType>;
+
+    // View of the rows x cols elements at data (spacing is the distance between two consecutive rows/columns)
+    TMLDenseMatrixView(ET* data, std::size_t rows, std::size_t cols, std::size_t spacing) noexcept;
+
+    TMLDenseMatrixView(const TMLDenseMatrixView& rhs) noexcept = default;
+
+    // Expression assignment
+    template<typename Expr>
+    TMLDenseMatrixView& operator=(const TMLMatrixExpression<Expr>& expr) { return this->Assign(expr); }
+    template<typename Expr>
+    TMLDenseMatrixView& Assign(const TMLMatrixExpression<Expr>& expr);
+
+    // Matrix assignment (copies the elements)
+    TMLDenseMatrixView& operator=(const TMLDenseMatrixView& rhs) { return this->Assign(rhs); }
+    template<typename MT>
+    TMLDenseMatrixView& operator=(const TMLDenseMatrix<MT>& rhs) { return this->Assign(~rhs); }
+    template<typename MT>
+    TMLDenseMatrixView& Assign(const TMLDenseMatrix<MT>& rhs) { return this->Assign(TMLDMAssignExpression<MT>(~rhs)); }
+
+    // Data access
+    QM_ALWAYS_INLINE ET& operator()(std::size_t i, std::size_t j) noexcept;
+    QM_ALWAYS_INLINE const ElementType& operator()(std::size_t i, std::size_t j) const noexcept;
+
+    // Utility
+    QM_ALWAYS_INLINE std::size_t Rows() const noexcept { return RowMajor ? m_majorCnt : m_minorCnt; }
+    QM_ALWAYS_INLINE std::size_t Cols() const noexcept { return RowMajor ? m_minorCnt : m_majorCnt; }
+
+    // Raw memory access (Spacing is the distance between two consecutive rows/columns)
+    QM_ALWAYS_INLINE ET* Data() noexcept { return m_data; }
+    QM_ALWAYS_INLINE const ElementType* Data() const noexcept { return m_data; }
+    QM_ALWAYS_INLINE std::size_t Spacing() const noexcept { return m_spacing; }
+
+    // Alias detection (other shares elements with the view, e.g. the viewed matrix or an overlapping view)
+    template<typename MT> QM_ALWAYS_INLINE TMLEnableIf_t<!TMLMatrixIsDense_v<MT>, bool>
+      IsAlias(const MT& other) { return false; }
+    template<typename MT> QM_ALWAYS_INLINE TMLEnableIf_t<TMLMatrixIsDense_v<MT>, bool>
+      IsAlias(const MT& other) { return Internal::MLIsOverlapping(*this, ~other); }
+
+    // Load / Store (aligned if the first element and the spacing are aligned to the SIMD type, e.g. a block of
+    // a padded matrix that starts at a multiple of the SIMD size)
+    SIMDType Load(std::size_t i, std::size_t j) const
+      { return m_aligned ? SIMDType::LoadAligned(&((*this)(i, j))) : SIMDType::LoadUnaligned(&((*this)(i, j))); }
+    void Store(SIMDType reg, std::size_t i, std::size_t j)
+      { m_aligned ? SIMDType::StoreAligned(reg, &((*this)(i, j))) : SIMDType::StoreUnaligned(reg, &((*this)(i, j))); }
+    SIMDType LoadMasked(std::size_t i, std::size_t j, std::size_t n) const { return SIMDType::LoadMasked(&((*this)(i, j)), n); }
+    void StoreMasked(SIMDType reg, std::size_t i, std::size_t j, std::size_t n) { SIMDType::StoreMasked(reg, &((*this)(i, j)), n); }
+
+  private:
+    ET* m_data;
+    std::size_t m_majorCnt;
+    std::size_t m_minorCnt;
+    std::size_t m_spacing;
+    bool m_aligned;
+  };
+
+  template<typename ET, bool RowMajor, typename SIMD>
+  TMLDenseMatrixView<ET, RowMajor, SIMD>::TMLDenseMatrixView(ET* data, std::size_t rows, std::size_t cols, std::size_t spacing) noexcept
+    : m_data(data),
+      m_majorCnt(RowMajor ? rows : cols),
+      m_minorCnt(RowMajor ? cols : rows),
+      m_spacing(spacing),
+      m_aligned(reinterpret_cast<std::uintptr_t>(data) % alignof(SIMDType) == 0 &&
+        (spacing * sizeof(ElementType)) % alignof(SIMDType) == 0)
+  {
+    assert(m_majorCnt <= 1 || m_minorCnt <= spacing);
+  }
+
+  template<typename ET, bool RowMajor, typename SIMD>
+  template<typename Expr> TMLDenseMatrixView<ET, RowMajor, SIMD>&
+    TMLDenseMatrixView<ET, RowMajor, SIMD>::Assign(const TMLMatrixExpression<Expr>& expr)
+  {
+    static_assert(!std::is_const<ET>::value, "The view of a constant matrix cannot be assigned");
+    assert((~expr).Rows() == this->Rows());
+    assert((~expr).Cols() == this->Cols());
+    (~expr).AssignTo(*this);
+    return *this;
+  }
+
+  template<typename ET, bool RowMajor, typename SIMD>
+  QM_ALWAYS_INLINE ET& TMLDenseMatrixView<ET, RowMajor, SIMD>::operator()(std::size_t i, std::size_t j) noexcept
+  {
+    assert(i < this->Rows());
+    assert(j < this->Cols());
+
+    auto major = RowMajor ? i : j;
+    auto minor = RowMajor ? j : i;
+
+    return m_data[major*m_spacing + minor];
+  }
+
+  template<typename ET, bool RowMajor, typename SIMD>
+  QM_ALWAYS_INLINE const typename TMLDenseMatrixView<ET, RowMajor, SIMD>::ElementType&
+    TMLDenseMatrixView<ET, RowMajor, SIMD>::operator()(std::size_t i, std::size_t j) const noexcept
+  {
+    assert(i < this->Rows());
+    assert(j < this->Cols());
+
+    auto major = RowMajor ? i : j;
+    auto minor = RowMajor ? j : i;
+
+    return m_data[major*m_spacing + minor];
+  }
+
+  //
+  // Views
+  //
+  namespace Internal
+  {
+    template<bool RowMajor, typename SIMD, typename ET>
+    TMLDenseMatrixView<ET, RowMajor, SIMD> MLMakeDenseMatrixView(ET* data, std::size_t spacing,
+      std::size_t row, std::size_t col, std::size_t rows, std::size_t cols) noexcept
+    {
+      const std::size_t offset = RowMajor ? row * spacing + col : col * spacing + row;
+      return { rows != 0 && cols != 0 ? data + offset : data, rows, cols, spacing };
+    }
+  }
+
+  // Block of rows x cols elements of mat starting at the element (row, col). The view of a constant
+  // matrix is read-only, a view of a view addresses the elements of the originally viewed matrix.
+  template<typename MT>
+  auto MLSubmatrix(TMLDenseMatrix<MT>& mat, std::size_t row, std::size_t col, std::size_t rows, std::size_t cols) noexcept
+  {
+    assert(row + rows <= (~mat).Rows() && col + cols <= (~mat).Cols());
+    return Internal::MLMakeDenseMatrixView<TMLMatrixIsRowMajor_v<MT>, TMLMatrixSIMDType_t<MT>>(
+      (~mat).Data(), (~mat).Spacing(), row, col, rows, cols);
+  }
+  template<typename MT>
+  auto MLSubmatrix(const TMLDenseMatrix<MT>& mat, std::size_t row, std::size_t col, std::size_t rows, std::size_t cols) noexcept
+  {
+    assert(row + rows <= (~mat).Rows() && col + cols <= (~mat).Cols());
+    return Internal::MLMakeDenseMatrixView<TMLMatrixIsRowMajor_v<MT>, TMLMatrixSIMDType_t<MT>>(
+      (~mat).Data(), (~mat).Spacing(), row, col, rows, cols);
+  }
+  template<typename ET, bool RowMajor, typename SIMD>
+  TMLDenseMatrixView<ET, RowMajor, SIMD> MLSubmatrix(TMLDenseMatrixView<ET, RowMajor, SIMD> view,
+    std::size_t row, std::size_t col, std::size_t rows, std::size_t cols) noexcept
+  {
+    assert(row + rows <= view.Rows() && col + cols <= view.Cols());
+    return Internal::MLMakeDenseMatrixView<RowMajor, SIMD>(view.Data(), view.Spacing(), row, col, rows, cols);
+  }
+
+  // Row i (1 x n) and column j (m x 1) of mat
+  template<typename MT, typename=TMLEnableIf_t<TMLMatrixIsDense_v<std::decay_t<MT>>>>
+  auto MLRow(MT&& mat, std::size_t i) noexcept
+  {
+    const std::size_t cols = (~mat).Cols();
+    return MLSubmatrix(std::forward<MT>(mat), i, 0, 1, cols);
+  }
+  template<typename MT, typename=TMLEnableIf_t<TMLMatrixIsDense_v<std::decay_t<MT>>>>
+  auto MLColumn(MT&& mat, std::size_t j) noexcept
+  {
+    const std::size_t rows = (~mat).Rows();
+    return MLSubmatrix(std::forward<MT>(mat), 0, j, rows, 1);
+  }
+
+  // Diagonal of mat as a column vector. Its elements are one spacing plus one apart, i.e. it is a row-major
+  // view with one element per row (whatever the layout of mat is).
+  template<typename MT, typename=TMLEnableIf_t<TMLMatrixIsDense_v<std::decay_t<MT>>>>
+  auto MLDiagonal(MT&& mat) noexcept
+  {
+    const std::size_t n = std::min((~mat).Rows(), (~mat).Cols());
+    auto block = MLSubmatrix(std::forward<MT>(mat), 0, 0, n, n);
+    using ViewType = TMLDenseMatrixView<std::remove_pointer_t<decltype(block.Data())>, true, TMLMatrixSIMDType_t<decltype(block)>>;
+    return ViewType(block.Data(), n, 1, block.Spacing() + 1);
+  }
+
+  //
+  // Traits
+  //
+
+  template<typename ET, bool RowMajor, typename SIMD>
+  struct TMLMatrixRows1<TMLDenseMatrixView<ET, RowMajor, SIMD>, void>
+    : TMLConstant<std::size_t, MLMatrixDynamicSize_v> {};
+
+  template<typename ET, bool RowMajor, typename SIMD>
+  struct TMLMatrixCols1<TMLDenseMatrixView<ET, RowMajor, SIMD>, void>
+    : TMLConstant<std::size_t, MLMatrixDynamicSize_v> {};
+
+  template<typename ET, bool RowMajor, typename SIMD>
+  struct TMLMatrixIsRowMajor1<TMLDenseMatrixView<ET, RowMajor, SIMD>, void>
+    : TMLBooleanConstant<RowMajor> {};
+
+  // Temporaries of the elements of a view are dynamic matrices with the SIMD type of the view
+  template<typename ET, bool RowMajor, typename SIMD>
+  struct TMLMatrixCopyResult1<TMLDenseMatrixView<ET, RowMajor, SIMD>, void>
+    : TMLType<TMLDynamicMatrix<std::remove_const_t<ET>, RowMajor, TMLSIMDSize_v<SIMD>>> {};
+
+}
+
+#endif
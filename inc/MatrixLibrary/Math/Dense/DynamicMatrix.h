@@ -6,12 +6,16 @@
 // Includes
 #include <cassert>
 #include <algorithm>
+#include <memory>
+#include <utility>
 
 #include "DenseMatrix.h"
 #include "DenseMatrixHelper.h"
 #include "../SIMD/SIMD.h"
 
 #include "../../Memory/AlignedAlloc.h"
+#include "../../Memory/Allocator.h"
+#include "../../Memory/ScratchArena.h"
 
 #include "../../QTL/Type.h"
 #include "../../QTL/EnableIf.h"
@@ -25,28 +29,51 @@ namespace ML
   //
   namespace Internal
   {
-    template<typename Type, std::size_t Al = alignof(Type)>
-    class TMLDynamicMatrixStorage
+    // Resize keeps the memory if the new size fits into the capacity and grows the capacity by at least half
+    // otherwise, so repeated resizes between similar sizes stop allocating. The memory is only given back by
+    // ShrinkToFit. The allocator is a base class in order to take no space if it has no state.
+    template<typename Type, std::size_t Al = alignof(Type), typename Alloc = TMLAlignedAllocator<Type>>
+    class TMLDynamicMatrixStorage : private std::allocator_traits<Alloc>::template rebind_alloc<Type>
     {
     private:
-      using MyT = TMLDynamicMatrixStorage<Type, Al>;
+      using MyT = TMLDynamicMatrixStorage<Type, Al, Alloc>;
+
+    public:
+      using AllocatorType = typename std::allocator_traits<Alloc>::template rebind_alloc<Type>;
       
     public:
-      TMLDynamicMatrixStorage() : m_size(0), m_data(nullptr) {}
-      TMLDynamicMatrixStorage(std::size_t size) 
-        : m_size(size), m_data(MLAlignedAlloc<Type>(size, Al)) {}
+      TMLDynamicMatrixStorage() : m_size(0), m_capacity(0), m_data(nullptr) {}
+      explicit TMLDynamicMatrixStorage(const AllocatorType& alloc) 
+        : AllocatorType(alloc), m_size(0), m_capacity(0), m_data(nullptr) {}
+      TMLDynamicMatrixStorage(std::size_t size, const AllocatorType& alloc = AllocatorType()) 
+        : AllocatorType(alloc), m_size(size), m_capacity(size), m_data(MLAllocateAligned(Allocator(), size, Al)) {}
       TMLDynamicMatrixStorage(const MyT& rhs)
-        : MyT(rhs.m_size) { if(m_data) std::copy(rhs.m_data, rhs.m_data+m_size, m_data); }
+        : MyT(rhs.m_size, std::allocator_traits<AllocatorType>::select_on_container_copy_construction(rhs.GetAllocator())) 
+        { if(m_data) std::copy(rhs.m_data, rhs.m_data+m_size, m_data); }
       TMLDynamicMatrixStorage(MyT&& rhs) noexcept
-        : m_size(rhs.m_size), m_data(rhs.m_data) { rhs.m_size = 0; rhs.m_data = nullptr; } 
-      ~TMLDynamicMatrixStorage() { MLAlignedFree(m_data); m_data = nullptr; m_size = 0; }
-
-      MyT& operator=(const MyT& rhs) { Resize(rhs.m_size, MLNoneType{}); Copy(rhs.m_data); } 
-      MyT& operator=(MyT&& rhs) noexcept { std::swap(m_size, rhs.m_size); std::swap(m_data, rhs.m_data); }
+        : AllocatorType(std::move(rhs.Allocator())), m_size(rhs.m_size), m_capacity(rhs.m_capacity), m_data(rhs.m_data) 
+        { rhs.m_size = 0; rhs.m_capacity = 0; rhs.m_data = nullptr; } 
+      ~TMLDynamicMatrixStorage() { MLDeallocateAligned(Allocator(), m_data, m_capacity, Al); m_data = nullptr; m_size = 0; m_capacity = 0; }
+
+      // Copies keep their allocator, moves take the allocator along with the memory
+      MyT& operator=(const MyT& rhs) { Resize(rhs.m_size); std::copy(rhs.m_data, rhs.m_data + m_size, m_data); return *this; } 
+      MyT& operator=(MyT&& rhs) noexcept 
+      { 
+        std::swap(Allocator(), rhs.Allocator());
+        std::swap(m_size, rhs.m_size); 
+        std::swap(m_capacity, rhs.m_capacity); 
+        std::swap(m_data, rhs.m_data); 
+        return *this; 
+      }
 
-      // Size
+      // Size (Resize does not keep the elements, Reserve and ShrinkToFit do)
       void Resize(std::size_t size);
+      void Reserve(std::size_t capacity);
+      void ShrinkToFit();
       QM_ALWAYS_INLINE std::size_t GetSize() const noexcept { return m_size; }
+      QM_ALWAYS_INLINE std::size_t GetCapacity() const noexcept { return m_capacity; }
+
+      const AllocatorType& GetAllocator() const noexcept { return *this; }
       
       // data access (std cpp compliant)
       QM_ALWAYS_INLINE Type* begin() noexcept { return m_data; }
@@ -60,36 +87,72 @@ namespace ML
       QM_ALWAYS_INLINE Type& operator[](std::size_t i) noexcept { return m_data[i]; }
       QM_ALWAYS_INLINE const Type& operator[](std::size_t i) const noexcept { return m_data[i]; }
 
+    private:
+      AllocatorType& Allocator() noexcept { return *this; }
+
+      // Replaces the memory by a block of the given capacity and copies the first cnt elements into it
+      void Reallocate(std::size_t capacity, std::size_t cnt);
+
     private:
       std::size_t m_size;
+      std::size_t m_capacity;
       Type* m_data;
     };
 
-    template<typename Type, std::size_t Al>
-    void TMLDynamicMatrixStorage<Type, Al>::Resize(std::size_t size)
+    template<typename Type, std::size_t Al, typename Alloc>
+    void TMLDynamicMatrixStorage<Type, Al, Alloc>::Resize(std::size_t size)
     {
-      if (size != m_size)
-      {
-        MLAlignedFree(m_data);
-        m_data = MLAlignedAlloc<Type>(size, Al);
-        m_size = size;
-      }
+      if (size > m_capacity)
+        Reallocate(std::max(size, m_capacity + m_capacity / 2), 0);
+      m_size = size;
+    }
+
+    template<typename Type, std::size_t Al, typename Alloc>
+    void TMLDynamicMatrixStorage<Type, Al, Alloc>::Reserve(std::size_t capacity)
+    {
+      if (capacity > m_capacity)
+        Reallocate(capacity, m_size);
+    }
+
+    template<typename Type, std::size_t Al, typename Alloc>
+    void TMLDynamicMatrixStorage<Type, Al, Alloc>::ShrinkToFit()
+    {
+      if (m_capacity > m_size)
+        Reallocate(m_size, m_size);
+    }
+
+    template<typename Type, std::size_t Al, typename Alloc>
+    void TMLDynamicMatrixStorage<Type, Al, Alloc>::Reallocate(std::size_t capacity, std::size_t cnt)
+    {
+      Type* data = MLAllocateAligned(Allocator(), capacity, Al);
+      if (cnt > 0)
+        std::copy(m_data, m_data + cnt, data);
+      MLDeallocateAligned(Allocator(), m_data, m_capacity, Al);
+      m_data = data;
+      m_capacity = capacity;
     }
 
   }
 
-  template <typename ET, bool RowMajor = true, std::size_t maxSIMD = 0xFFFFFFFF>
-  class TMLDynamicMatrix : public TMLDenseMatrixHelper<TMLDynamicMatrix<ET, RowMajor, maxSIMD>>
+  // Rows (row-major) or columns (column-major) are padded to a multiple of the SIMD width unless 
+  // Padded is false. Unpadded matrices are tightly packed (e.g. for exchanging buffers with other
+  // libraries) and their rows/columns are not aligned. The kernels never access the padding.
+  // The memory comes from Alloc (see Memory/Allocator.h), results of expressions use the default allocator.
+  template <typename ET, bool RowMajor = true, std::size_t maxSIMD = 0xFFFFFFFF, bool Padded = true, 
+    typename Alloc = TMLAlignedAllocator<std::decay_t<ET>>>
+  class TMLDynamicMatrix : public TMLDenseMatrixHelper<TMLDynamicMatrix<ET, RowMajor, maxSIMD, Padded, Alloc>>
   {
   public:
     // befriend TMLMatrixExpression in order to let it access the SIMD iterator methods
     template<typename T> friend class TMLMatrixExpression;
 
     // Type aliases
-    using MyT = TMLDynamicMatrix<ET, RowMajor, maxSIMD>;
-    using TransposeType = TMLDynamicMatrix<ET, !RowMajor, maxSIMD>;
+    using MyT = TMLDynamicMatrix<ET, RowMajor, maxSIMD, Padded, Alloc>;
+    using TransposeType = TMLDynamicMatrix<ET, !RowMajor, maxSIMD, Padded, Alloc>;
     using ElementType = std::decay_t<ET>;
     using SIMDType = TMLSIMDTypeSelector_t<ElementType, maxSIMD>; 
+    using StorageType = Internal::TMLDynamicMatrixStorage<ElementType, alignof(SIMDType), Alloc>;
+    using AllocatorType = typename StorageType::AllocatorType;
     
     constexpr static std::size_t SIMDSize = TMLSIMDSize_v<SIMDType>;
   
@@ -98,7 +161,12 @@ namespace ML
     TMLDynamicMatrix(std::size_t rows, std::size_t cols)
       : TMLDynamicMatrix(rows, cols, MLNoneType{}) { this->SetZero(); }
     explicit TMLDynamicMatrix(MLNoneType) : TMLDynamicMatrix(0, 0, MLNoneType{}) {}
-    explicit TMLDynamicMatrix(std::size_t rows, std::size_t cols, MLNoneType);
+    explicit TMLDynamicMatrix(std::size_t rows, std::size_t cols, MLNoneType, const AllocatorType& alloc = AllocatorType());
+
+    // Constructors with an allocator (e.g. one with a memory pool)
+    explicit TMLDynamicMatrix(const AllocatorType& alloc) : TMLDynamicMatrix(0, 0, MLNoneType{}, alloc) {}
+    TMLDynamicMatrix(std::size_t rows, std::size_t cols, const AllocatorType& alloc)
+      : TMLDynamicMatrix(rows, cols, MLNoneType{}, alloc) { this->SetZero(); }
 
     // Expression assignment
     template<typename Expr>
@@ -111,7 +179,9 @@ namespace ML
 
     // copy constructor/assignment operator
     TMLDynamicMatrix(const TMLDynamicMatrix& rhs) noexcept 
-      : TMLDynamicMatrix(TMLDMAssignExpression<TMLDynamicMatrix>(rhs)) {}
+      : TMLDynamicMatrix(rhs.Rows(), rhs.Cols(), MLNoneType{}, 
+          std::allocator_traits<AllocatorType>::select_on_container_copy_construction(rhs.GetAllocator())) 
+      { TMLDMAssignExpression<TMLDynamicMatrix>(rhs).AssignTo(*this); }
     TMLDynamicMatrix& operator=(const TMLDynamicMatrix& rhs) noexcept { return this->Assign(rhs); }
 
     // move constructor/assignment operator
@@ -139,51 +209,75 @@ namespace ML
     QM_ALWAYS_INLINE constexpr std::size_t PaddedRows() const noexcept { return RowMajor ? Rows() : m_paddedMinorCnt; }
     QM_ALWAYS_INLINE constexpr std::size_t PaddedCols() const noexcept { return RowMajor ? m_paddedMinorCnt : Cols(); }
 
-    // Alias detection
+    // Capacity in elements (including the padding). Resizes and assignments reuse the memory if the new
+    // shape fits. Reserve makes room for a rows x cols matrix, ShrinkToFit frees the unused memory (both
+    // keep the elements).
+    void Reserve(std::size_t rows, std::size_t cols)
+      { m_storage.Reserve((RowMajor ? rows : cols) * CalcSpacing(RowMajor ? cols : rows)); }
+    void ShrinkToFit() { m_storage.ShrinkToFit(); }
+    QM_ALWAYS_INLINE std::size_t Capacity() const noexcept { return m_storage.GetCapacity(); }
+
+    // Raw memory access (Spacing is the distance between two consecutive rows/columns)
+    QM_ALWAYS_INLINE ElementType* Data() noexcept { return m_storage.data(); }
+    QM_ALWAYS_INLINE const ElementType* Data() const noexcept { return m_storage.data(); }
+    QM_ALWAYS_INLINE std::size_t Spacing() const noexcept { return m_paddedMinorCnt; }
+
+    const AllocatorType& GetAllocator() const noexcept { return m_storage.GetAllocator(); }
+
+    // Alias detection (other shares elements with this matrix, e.g. a view of it)
     template<typename MT> QM_ALWAYS_INLINE TMLEnableIf_t<!TMLMatrixIsDense_v<MT>, bool> 
       IsAlias(const MT& other) { return false; }
     template<typename MT> QM_ALWAYS_INLINE TMLEnableIf_t<TMLMatrixIsDense_v<MT>, bool> 
-      IsAlias(const MT& other) { return static_cast<const void*>(this) == static_cast<const void*>(&(~other)); }
+      IsAlias(const MT& other) { return Internal::MLIsOverlapping(*this, ~other); }
 
-    // Load / Store
-    SIMDType Load(std::size_t i, std::size_t j) const { return SIMDType::LoadAligned(&((*this)(i, j))); }
-    void Store(SIMDType reg, std::size_t i, std::size_t j) { SIMDType::StoreAligned(reg, &((*this)(i, j))); }
+    // Load / Store (the masked variants access the first n elements, e.g. at the end of a row)
+    SIMDType Load(std::size_t i, std::size_t j) const 
+      { return Padded ? SIMDType::LoadAligned(&((*this)(i, j))) : SIMDType::LoadUnaligned(&((*this)(i, j))); }
+    void Store(SIMDType reg, std::size_t i, std::size_t j) 
+      { Padded ? SIMDType::StoreAligned(reg, &((*this)(i, j))) : SIMDType::StoreUnaligned(reg, &((*this)(i, j))); }
+    SIMDType LoadMasked(std::size_t i, std::size_t j, std::size_t n) const { return SIMDType::LoadMasked(&((*this)(i, j)), n); }
+    void StoreMasked(SIMDType reg, std::size_t i, std::size_t j, std::size_t n) { SIMDType::StoreMasked(reg, &((*this)(i, j)), n); }
+
+  private:
+    constexpr static std::size_t CalcSpacing(std::size_t minorCnt) noexcept 
+      { return Padded ? minorCnt + (SIMDSize - minorCnt % SIMDSize) % SIMDSize : minorCnt; }
 
   private:
     std::size_t m_majorCnt;
     std::size_t m_minorCnt;
     std::size_t m_paddedMinorCnt;
-    Internal::TMLDynamicMatrixStorage<ElementType, alignof(SIMDType)> m_storage;
+    StorageType m_storage;
   };
 
-  template <typename ET, bool RowMajor, std::size_t maxSIMD>
-  QM_ALWAYS_INLINE TMLDynamicMatrix<ET, RowMajor, maxSIMD>::TMLDynamicMatrix(std::size_t rows, std::size_t cols, MLNoneType)
+  template <typename ET, bool RowMajor, std::size_t maxSIMD, bool Padded, typename Alloc>
+  QM_ALWAYS_INLINE TMLDynamicMatrix<ET, RowMajor, maxSIMD, Padded, Alloc>::TMLDynamicMatrix(std::size_t rows, std::size_t cols, MLNoneType, 
+    const AllocatorType& alloc)
     : m_majorCnt(RowMajor ? rows : cols),
       m_minorCnt(RowMajor ? cols : rows),
-      m_paddedMinorCnt(m_minorCnt + (SIMDSize - m_minorCnt % SIMDSize) % SIMDSize),
-      m_storage(m_majorCnt * m_paddedMinorCnt) {}
+      m_paddedMinorCnt(CalcSpacing(m_minorCnt)),
+      m_storage(m_majorCnt * m_paddedMinorCnt, alloc) {}
 
-  template <typename ET, bool RowMajor, std::size_t maxSIMD>
-  void TMLDynamicMatrix<ET, RowMajor, maxSIMD>::Resize(std::size_t rows, std::size_t cols, MLNoneType)
+  template <typename ET, bool RowMajor, std::size_t maxSIMD, bool Padded, typename Alloc>
+  void TMLDynamicMatrix<ET, RowMajor, maxSIMD, Padded, Alloc>::Resize(std::size_t rows, std::size_t cols, MLNoneType)
   {
     m_majorCnt = RowMajor ? rows : cols;
     m_minorCnt = RowMajor ? cols : rows;
-    m_paddedMinorCnt = m_minorCnt + (SIMDSize - m_minorCnt % SIMDSize) % SIMDSize;
+    m_paddedMinorCnt = CalcSpacing(m_minorCnt);
     m_storage.Resize(m_majorCnt * m_paddedMinorCnt);
   }
 
-  template <typename ET, bool RowMajor, std::size_t maxSIMD>
-  template<typename Expr> TMLDynamicMatrix<ET, RowMajor, maxSIMD>&
-    TMLDynamicMatrix<ET, RowMajor, maxSIMD>::Assign(const TMLMatrixExpression<Expr>& expr)
+  template <typename ET, bool RowMajor, std::size_t maxSIMD, bool Padded, typename Alloc>
+  template<typename Expr> TMLDynamicMatrix<ET, RowMajor, maxSIMD, Padded, Alloc>&
+    TMLDynamicMatrix<ET, RowMajor, maxSIMD, Padded, Alloc>::Assign(const TMLMatrixExpression<Expr>& expr)
   {
     this->Resize((~expr).Rows(), (~expr).Cols(), MLNoneType{});
     (~expr).AssignTo(*this);
     return *this;
   }
 
-  template <typename ET, bool RowMajor, std::size_t maxSIMD>
-  QM_ALWAYS_INLINE typename TMLDynamicMatrix<ET, RowMajor, maxSIMD>::ElementType& 
-    TMLDynamicMatrix<ET, RowMajor, maxSIMD>::operator()(std::size_t i, std::size_t j) noexcept
+  template <typename ET, bool RowMajor, std::size_t maxSIMD, bool Padded, typename Alloc>
+  QM_ALWAYS_INLINE typename TMLDynamicMatrix<ET, RowMajor, maxSIMD, Padded, Alloc>::ElementType& 
+    TMLDynamicMatrix<ET, RowMajor, maxSIMD, Padded, Alloc>::operator()(std::size_t i, std::size_t j) noexcept
   {
     assert(i < this->Rows());
     assert(j < this->Cols());
@@ -194,9 +288,9 @@ namespace ML
     return this->m_storage[major*m_paddedMinorCnt + minor];
   }
 
-  template <typename ET, bool RowMajor, std::size_t maxSIMD>
-  QM_ALWAYS_INLINE const typename TMLDynamicMatrix<ET, RowMajor, maxSIMD>::ElementType& 
-    TMLDynamicMatrix<ET, RowMajor, maxSIMD>::operator()(std::size_t i, std::size_t j) const noexcept
+  template <typename ET, bool RowMajor, std::size_t maxSIMD, bool Padded, typename Alloc>
+  QM_ALWAYS_INLINE const typename TMLDynamicMatrix<ET, RowMajor, maxSIMD, Padded, Alloc>::ElementType& 
+    TMLDynamicMatrix<ET, RowMajor, maxSIMD, Padded, Alloc>::operator()(std::size_t i, std::size_t j) const noexcept
   {
     assert(i < this->Rows());
     assert(j < this->Cols());
@@ -211,18 +305,26 @@ namespace ML
   // Traits
   //
 
-  template <typename ET, bool RowMajor, std::size_t maxSIMD>
-  struct TMLMatrixRows1<TMLDynamicMatrix<ET, RowMajor, maxSIMD>, void>
+  template <typename ET, bool RowMajor, std::size_t maxSIMD, bool Padded, typename Alloc>
+  struct TMLMatrixRows1<TMLDynamicMatrix<ET, RowMajor, maxSIMD, Padded, Alloc>, void>
     : TMLConstant<std::size_t, MLMatrixDynamicSize_v> {};
 
-  template <typename ET, bool RowMajor, std::size_t maxSIMD>
-  struct TMLMatrixCols1<TMLDynamicMatrix<ET, RowMajor, maxSIMD>, void>
+  template <typename ET, bool RowMajor, std::size_t maxSIMD, bool Padded, typename Alloc>
+  struct TMLMatrixCols1<TMLDynamicMatrix<ET, RowMajor, maxSIMD, Padded, Alloc>, void>
     : TMLConstant<std::size_t, MLMatrixDynamicSize_v> {};
 
-  template <typename ET, bool RowMajor, std::size_t maxSIMD>
-  struct TMLMatrixIsRowMajor1<TMLDynamicMatrix<ET, RowMajor, maxSIMD>, void>
+  template <typename ET, bool RowMajor, std::size_t maxSIMD, bool Padded, typename Alloc>
+  struct TMLMatrixIsRowMajor1<TMLDynamicMatrix<ET, RowMajor, maxSIMD, Padded, Alloc>, void>
     : TMLBooleanConstant<RowMajor> {};
 
+  template <typename ET, bool RowMajor, std::size_t maxSIMD, bool Padded, typename Alloc>
+  struct TMLMatrixCopyResult1<TMLDynamicMatrix<ET, RowMajor, maxSIMD, Padded, Alloc>, void>
+    : TMLType<TMLDynamicMatrix<ET, RowMajor, maxSIMD, Padded, Alloc>> {};
+
+  template <typename ET, bool RowMajor, std::size_t maxSIMD, bool Padded, typename Alloc>
+  struct TMLMatrixScratchResult1<TMLDynamicMatrix<ET, RowMajor, maxSIMD, Padded, Alloc>, void>
+    : TMLType<TMLDynamicMatrix<ET, RowMajor, maxSIMD, Padded, TMLScratchAllocator<std::decay_t<ET>>>> {};
+
 
   // Arithmetic traits
   template<typename MT1, typename MT2>
@@ -258,6 +360,18 @@ namespace ML
         TMLMatrixIsRowMajor_v<MT1>
       >> {};
 
+  template<typename MT>
+  struct TMLMatrixTransResult1<MT, TMLEnableIf_t<TMLMatrixIsDynamic_v<MT>>>
+    : TMLType<TMLDynamicMatrix<
+        TMLMatrixElementType_t<MT>,
+        TMLMatrixIsRowMajor_v<MT>
+      >> {};
+
+  // Vectors are stored contiguously (column vectors in column-major, row vectors in row-major layout)
+  template<typename MT, bool rowwise, typename ET>
+  struct TMLMatrixReduceResult1<MT, rowwise, ET, TMLEnableIf_t<TMLMatrixIsDynamic_v<MT>>>
+    : TMLType<TMLDynamicMatrix<ET, !rowwise>> {};
+
 }
 
 #endif
@@ -0,0 +1,221 @@
+// Copyright 2021, Philipp Neufeld
+
+#ifndef ML_MATH_Dense_MatrixBatch_H_
+#define ML_MATH_Dense_MatrixBatch_H_
+
+// Includes
+#include <cassert>
+#include <algorithm>
+
+#include "DenseMatrix.h"
+#include "StaticMatrix.h"
+#include "DynamicMatrix.h"
+#include "../SIMD/SIMD.h"
+#include "../Kernels/BatchGemmKernel.h"
+
+#include "../../Memory/ScratchArena.h"
+
+namespace ML
+{
+
+  // Batch of N x M matrices in an interleaved (array of structures of arrays) layout for batched products of
+  // small matrices (see MLBatchMul). The matrices are grouped into packets of SIMDSize_v matrices. The elements
+  // (i, j) of the matrices of a packet are stored next to each other and form one SIMD register, lane l of
+  // which belongs to the matrix l of the packet.
+  template<typename ET, std::size_t N, std::size_t M, std::size_t maxSIMD = 0xFFFFFFFF>
+  class TMLMatrixBatch
+  {
+  public:
+    using MyT = TMLMatrixBatch<ET, N, M, maxSIMD>;
+    using ElementType = ET;
+    using SIMDType = TMLSIMDTypeSelector_t<ElementType, maxSIMD>;
+    using MatrixType = TMLStaticMatrix<ElementType, N, M>;
+
+    constexpr static std::size_t SIMDSize_v = TMLSIMDSize_v<SIMDType>;
+    // Elements per packet
+    constexpr static std::size_t PacketSize_v = N * M * SIMDSize_v;
+
+    // The matrices are initialized with zeros
+    explicit TMLMatrixBatch(std::size_t count = 0)
+      : m_count(count), m_storage(((count + SIMDSize_v - 1) / SIMDSize_v) * PacketSize_v)
+    {
+      std::fill(m_storage.begin(), m_storage.end(), ElementType(0));
+    }
+
+    // Number of matrices
+    std::size_t Size() const noexcept { return m_count; }
+    std::size_t Packets() const noexcept { return (m_count + SIMDSize_v - 1) / SIMDSize_v; }
+    constexpr std::size_t Rows() const noexcept { return N; }
+    constexpr std::size_t Cols() const noexcept { return M; }
+
+    // Element (i, j) of the matrix with the given index
+    ElementType& operator()(std::size_t index, std::size_t i, std::size_t j) noexcept { return m_storage[CalcIndex(index, i, j)]; }
+    const ElementType& operator()(std::size_t index, std::size_t i, std::size_t j) const noexcept { return m_storage[CalcIndex(index, i, j)]; }
+
+    // Copies a matrix into / out of the batch
+    template<typename MT>
+    void Set(std::size_t index, const TMLDenseMatrix<MT>& mat);
+    MatrixType Get(std::size_t index) const;
+
+    // Raw memory access (Packets() * PacketSize_v elements, aligned for SIMDType)
+    ElementType* Data() noexcept { return m_storage.data(); }
+    const ElementType* Data() const noexcept { return m_storage.data(); }
+
+  private:
+    std::size_t CalcIndex(std::size_t index, std::size_t i, std::size_t j) const noexcept
+    {
+      assert(index < m_count);
+      assert(i < N);
+      assert(j < M);
+      return (index / SIMDSize_v) * PacketSize_v + (i*M + j) * SIMDSize_v + index % SIMDSize_v;
+    }
+
+    std::size_t m_count;
+    Internal::TMLDynamicMatrixStorage<ElementType, alignof(SIMDType)> m_storage;
+  };
+
+  template<typename ET, std::size_t N, std::size_t M, std::size_t maxSIMD>
+  template<typename MT>
+  void TMLMatrixBatch<ET, N, M, maxSIMD>::Set(std::size_t index, const TMLDenseMatrix<MT>& mat)
+  {
+    assert((~mat).Rows() == N);
+    assert((~mat).Cols() == M);
+    for (std::size_t i = 0; i < N; i++)
+      for (std::size_t j = 0; j < M; j++)
+        (*this)(index, i, j) = (~mat)(i, j);
+  }
+
+  template<typename ET, std::size_t N, std::size_t M, std::size_t maxSIMD>
+  typename TMLMatrixBatch<ET, N, M, maxSIMD>::MatrixType TMLMatrixBatch<ET, N, M, maxSIMD>::Get(std::size_t index) const
+  {
+    MatrixType res(MLNoneType{});
+    for (std::size_t i = 0; i < N; i++)
+      for (std::size_t j = 0; j < M; j++)
+        res(i, j) = (*this)(index, i, j);
+    return res;
+  }
+
+  namespace Internal
+  {
+    // Copies lanes static matrices into / out of one packet of the interleaved layout
+    template<std::size_t simdSize, typename MT>
+    void MLBatchPack(const MT* mats, std::size_t lanes, typename MT::ElementType* packet)
+    {
+      for (std::size_t i = 0; i < TMLMatrixRows_v<MT>; i++)
+        for (std::size_t j = 0; j < TMLMatrixCols_v<MT>; j++)
+          for (std::size_t l = 0; l < lanes; l++)
+            packet[(i*TMLMatrixCols_v<MT> + j) * simdSize + l] = mats[l](i, j);
+    }
+
+    template<std::size_t simdSize, typename MT>
+    void MLBatchUnpack(const typename MT::ElementType* packet, std::size_t lanes, MT* mats)
+    {
+      for (std::size_t i = 0; i < TMLMatrixRows_v<MT>; i++)
+        for (std::size_t j = 0; j < TMLMatrixCols_v<MT>; j++)
+          for (std::size_t l = 0; l < lanes; l++)
+            mats[l](i, j) = packet[(i*TMLMatrixCols_v<MT> + j) * simdSize + l];
+    }
+  }
+
+  namespace Internal
+  {
+    // Product of one pair of static matrices with the SIMD type of the matrices: the rows of C are linear 
+    // combinations of the rows of B (B and C are row-major, the last columns are loaded and stored masked)
+    template<typename C, typename A, typename B>
+    QM_ALWAYS_INLINE void MLBatchMulRows(C& c, const A& a, const B& b)
+    {
+      using SIMDType = TMLMatrixSIMDType_t<C>;
+      constexpr std::size_t simdSize = TMLSIMDSize_v<SIMDType>;
+      constexpr std::size_t K = TMLMatrixCols_v<A>;
+      constexpr std::size_t M = TMLMatrixCols_v<C>;
+      constexpr std::size_t full = (M / simdSize) * simdSize;
+
+      for (std::size_t i = 0; i < TMLMatrixRows_v<C>; i++)
+      {
+        for (std::size_t j = 0; j < full; j += simdSize)
+        {
+          SIMDType acc = SIMDType::Set1(a(i, 0)) * b.Load(0, j);
+          for (std::size_t k = 1; k < K; k++)
+            acc = MLSIMDFmadd(SIMDType::Set1(a(i, k)), b.Load(k, j), acc);
+          c.Store(acc, i, j);
+        }
+        if (full < M)
+        {
+          SIMDType acc = SIMDType::Set1(a(i, 0)) * b.LoadMasked(0, full, M - full);
+          for (std::size_t k = 1; k < K; k++)
+            acc = MLSIMDFmadd(SIMDType::Set1(a(i, k)), b.LoadMasked(k, full, M - full), acc);
+          c.StoreMasked(acc, i, full, M - full);
+        }
+      }
+    }
+
+    // Matrices whose rows fill SIMD registers are multiplied one by one, the others (e.g. 3 x 3 matrices 
+    // of floats) are packed into the interleaved layout
+    template<typename C, typename A, typename B>
+    constexpr bool MLBatchMulByRows_v = 
+      TMLMatrixIsRowMajor_v<C> &&
+      TMLMatrixIsRowMajor_v<B> &&
+      TMLMatrixIsSameSIMDType_v<C, B> &&
+      TMLMatrixIsVectorized_v<C>;
+
+    template<typename C, typename A, typename B>
+    void MLBatchMulArray(C* c, const A* a, const B* b, std::size_t count, std::true_type)
+    {
+      for (std::size_t l = 0; l < count; l++)
+        MLBatchMulRows(c[l], a[l], b[l]);
+    }
+
+    template<typename C, typename A, typename B>
+    void MLBatchMulArray(C* c, const A* a, const B* b, std::size_t count, std::false_type)
+    {
+      using ElementType = typename C::ElementType;
+      using SIMDType = TMLSIMDTypeSelector_t<ElementType, 0xFFFFFFFF>;
+      using Kernel = TMLBatchGemmKernel<ElementType, SIMDType, TMLMatrixRows_v<A>, TMLMatrixCols_v<A>, TMLMatrixCols_v<B>>;
+      constexpr std::size_t simdSize = TMLSIMDSize_v<SIMDType>;
+
+      // Unused lanes of the last packet stay zero
+      TMLScratchArray<ElementType> packetA(TMLMatrixRows_v<A> * TMLMatrixCols_v<A> * simdSize, alignof(SIMDType));
+      TMLScratchArray<ElementType> packetB(TMLMatrixRows_v<B> * TMLMatrixCols_v<B> * simdSize, alignof(SIMDType));
+      TMLScratchArray<ElementType> packetC(TMLMatrixRows_v<C> * TMLMatrixCols_v<C> * simdSize, alignof(SIMDType));
+      std::fill(packetA.data(), packetA.data() + packetA.size(), ElementType(0));
+      std::fill(packetB.data(), packetB.data() + packetB.size(), ElementType(0));
+
+      for (std::size_t l = 0; l < count; l += simdSize)
+      {
+        const std::size_t lanes = std::min(simdSize, count - l);
+        MLBatchPack<simdSize>(a + l, lanes, packetA.data());
+        MLBatchPack<simdSize>(b + l, lanes, packetB.data());
+        Kernel::Packet(packetC.data(), packetA.data(), packetB.data());
+        MLBatchUnpack<simdSize>(packetC.data(), lanes, c + l);
+      }
+    }
+  }
+
+  // Batched products c[l] = a[l] * b[l] of all matrices of the batches (one SIMD lane per product)
+  template<typename ET, std::size_t N, std::size_t K, std::size_t M, std::size_t maxSIMD>
+  void MLBatchMul(TMLMatrixBatch<ET, N, M, maxSIMD>& c, const TMLMatrixBatch<ET, N, K, maxSIMD>& a,
+    const TMLMatrixBatch<ET, K, M, maxSIMD>& b)
+  {
+    assert(a.Size() == b.Size());
+    assert(c.Size() == a.Size());
+    using SIMDType = typename TMLMatrixBatch<ET, N, M, maxSIMD>::SIMDType;
+    Internal::TMLBatchGemmKernel<ET, SIMDType, N, K, M>::Compute(c.Data(), a.Data(), b.Data(), c.Packets());
+  }
+
+  // Batched products c[l] = a[l] * b[l] for l < count of arrays of static matrices. Matrices with short rows
+  // are copied into the interleaved layout of TMLMatrixBatch packet by packet, the others are multiplied 
+  // one by one with a kernel for their size. c must not overlap with a or b.
+  template<typename ET, std::size_t N, std::size_t K, std::size_t M, bool RMC, bool RMA, bool RMB,
+    std::size_t SC, std::size_t SA, std::size_t SB>
+  void MLBatchMul(TMLStaticMatrix<ET, N, M, RMC, SC>* c, const TMLStaticMatrix<ET, N, K, RMA, SA>* a,
+    const TMLStaticMatrix<ET, K, M, RMB, SB>* b, std::size_t count)
+  {
+    using C = TMLStaticMatrix<ET, N, M, RMC, SC>;
+    using A = TMLStaticMatrix<ET, N, K, RMA, SA>;
+    using B = TMLStaticMatrix<ET, K, M, RMB, SB>;
+    Internal::MLBatchMulArray(c, a, b, count, std::integral_constant<bool, Internal::MLBatchMulByRows_v<C, A, B>>());
+  }
+
+}
+
+#endif
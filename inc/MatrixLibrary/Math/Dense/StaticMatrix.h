@@ -6,6 +6,8 @@
 // Includes
 #include <cassert>
 #include <algorithm>
+#include <memory>
+#include <utility>
 
 #include "DenseMatrix.h"
 #include "DenseMatrixHelper.h"
@@ -17,6 +19,8 @@
 #include "../../QTL/Comparison.h"
 
 #include "../../Memory/AlignedAlloc.h"
+#include "../../Memory/Allocator.h"
+#include "../../Memory/ScratchArena.h"
 
 namespace ML
 {
@@ -26,14 +30,18 @@ namespace ML
   //
   namespace Internal
   {
-    template<typename Type, std::size_t N, std::size_t Al = alignof(Type), typename=void>
+    template<typename Type, std::size_t N, std::size_t Al = alignof(Type), typename Alloc = TMLAlignedAllocator<Type>, typename=void>
     class TMLStaticMatrixStorage
     {
     private:
-      using MyT = TMLStaticMatrixStorage<Type, N, Al>;
+      using MyT = TMLStaticMatrixStorage<Type, N, Al, Alloc>;
+
+    public:
+      using AllocatorType = typename std::allocator_traits<Alloc>::template rebind_alloc<Type>;
 
     public:
       TMLStaticMatrixStorage() {}; // no init for m_data!
+      explicit TMLStaticMatrixStorage(const AllocatorType&) {}
       TMLStaticMatrixStorage(const TMLStaticMatrixStorage&) = default;
       TMLStaticMatrixStorage(TMLStaticMatrixStorage&&) noexcept = default;
 
@@ -42,6 +50,8 @@ namespace ML
 
       // Size
       QM_ALWAYS_INLINE constexpr std::size_t GetSize() const noexcept { return N; }
+
+      AllocatorType GetAllocator() const noexcept { return AllocatorType(); }
       
       // data access (std cpp compliant)
       QM_ALWAYS_INLINE constexpr Type* begin() noexcept { return m_data; }
@@ -59,27 +69,43 @@ namespace ML
       alignas(Al) Type m_data[N];
     };
 
-    // Starting from sizes greated than 16kB the matrix is allocated dynamically
-    template<typename Type, std::size_t N, std::size_t Al>
-    class TMLStaticMatrixStorage<Type, N, Al, 
+    // Starting from sizes greated than 16kB the matrix is allocated dynamically (from Alloc, which is a
+    // base class in order to take no space if it has no state)
+    template<typename Type, std::size_t N, std::size_t Al, typename Alloc>
+    class TMLStaticMatrixStorage<Type, N, Al, Alloc,
       TMLEnableIf_t<TMLGreaterEqual_v<std::size_t, sizeof(Type) * N, 16 * 1024>>>
+      : private std::allocator_traits<Alloc>::template rebind_alloc<Type>
     {
     private:
-      using MyT = TMLStaticMatrixStorage<Type, N, Al>;
+      using MyT = TMLStaticMatrixStorage<Type, N, Al, Alloc>;
 
     public:
-      TMLStaticMatrixStorage() : m_data(MLAlignedAlloc<Type>(N, Al)) {}; // no init for m_data!
-      ~TMLStaticMatrixStorage() { MLAlignedFree(m_data); m_data = nullptr; }
+      using AllocatorType = typename std::allocator_traits<Alloc>::template rebind_alloc<Type>;
 
-      TMLStaticMatrixStorage(const MyT& rhs) 
-        : m_data(MLAlignedAlloc<Type>(N, Al)) { std::copy(rhs.m_data, rhs.m_data + N, m_data); }
-      TMLStaticMatrixStorage(MyT&& rhs) noexcept : m_data(rhs.m_data) { rhs.m_data = nullptr; }
+    public:
+      TMLStaticMatrixStorage() : m_data(MLAllocateAligned(Allocator(), N, Al)) {}; // no init for m_data!
+      explicit TMLStaticMatrixStorage(const AllocatorType& alloc) 
+        : AllocatorType(alloc), m_data(MLAllocateAligned(Allocator(), N, Al)) {}
+      ~TMLStaticMatrixStorage() { MLDeallocateAligned(Allocator(), m_data, N, Al); m_data = nullptr; }
 
-      MyT& operator=(const MyT& rhs) { std::copy(rhs.m_data, rhs.m_data + N, m_data); }
-      MyT& operator=(MyT&& rhs) noexcept { std::swap(m_data, rhs.m_data); return *this; }
+      TMLStaticMatrixStorage(const MyT& rhs) 
+        : MyT(std::allocator_traits<AllocatorType>::select_on_container_copy_construction(rhs.GetAllocator())) 
+        { std::copy(rhs.m_data, rhs.m_data + N, m_data); }
+      TMLStaticMatrixStorage(MyT&& rhs) noexcept 
+        : AllocatorType(std::move(rhs.Allocator())), m_data(rhs.m_data) { rhs.m_data = nullptr; }
+
+      MyT& operator=(const MyT& rhs) { std::copy(rhs.m_data, rhs.m_data + N, m_data); return *this; }
+      MyT& operator=(MyT&& rhs) noexcept 
+      { 
+        std::swap(Allocator(), rhs.Allocator());
+        std::swap(m_data, rhs.m_data); 
+        return *this; 
+      }
 
       // Size
       QM_ALWAYS_INLINE constexpr std::size_t GetSize() const noexcept { return N; }
+
+      const AllocatorType& GetAllocator() const noexcept { return *this; }
       
       // data access (std cpp compliant)
       QM_ALWAYS_INLINE constexpr Type* begin() noexcept { return m_data; }
@@ -93,6 +119,9 @@ namespace ML
       QM_ALWAYS_INLINE constexpr Type& operator[](std::size_t i) noexcept { return m_data[i]; }
       QM_ALWAYS_INLINE constexpr const Type& operator[](std::size_t i) const noexcept { return m_data[i]; }
 
+    private:
+      AllocatorType& Allocator() noexcept { return *this; }
+
     private:
       Type* m_data;
     };
@@ -120,24 +149,32 @@ namespace ML
     };
   }
 
-  template <typename ET, std::size_t N, std::size_t M, bool RowMajor = true, std::size_t maxSIMD = RowMajor ? M : N>
-  class TMLStaticMatrix : public TMLDenseMatrixHelper<TMLStaticMatrix<ET, N, M, RowMajor, maxSIMD>>
+  // Matrices of 16kB and more are allocated with Alloc (see Memory/Allocator.h)
+  template <typename ET, std::size_t N, std::size_t M, bool RowMajor = true, std::size_t maxSIMD = RowMajor ? M : N,
+    typename Alloc = TMLAlignedAllocator<std::decay_t<ET>>>
+  class TMLStaticMatrix : public TMLDenseMatrixHelper<TMLStaticMatrix<ET, N, M, RowMajor, maxSIMD, Alloc>>
   {
     static_assert(N != MLMatrixDynamicSize_v && M != MLMatrixDynamicSize_v, "Invalid row or column size");
   public:
     // befriend TMLMatrixExpression in order to let it access the SIMD iterator methods
     template<typename T> friend class TMLMatrixExpression;
 
-    using MyT = TMLStaticMatrix<ET, N, M, RowMajor, maxSIMD>;
-    using TransposeType = TMLStaticMatrix<ET, M, N, !RowMajor, maxSIMD>;
+    using MyT = TMLStaticMatrix<ET, N, M, RowMajor, maxSIMD, Alloc>;
+    using TransposeType = TMLStaticMatrix<ET, M, N, !RowMajor, maxSIMD, Alloc>;
     using ElementType = std::decay_t<ET>;
     using SIMDType = TMLSIMDTypeSelector_t<ElementType, maxSIMD>; 
     
     using MemoryLayout = Internal::TMLStaticMatrixMemoryLayout<SIMDType, RowMajor ? N : M, RowMajor ? M : N>;
+    using StorageType = Internal::TMLStaticMatrixStorage<ElementType, MemoryLayout::PaddedSize_v, MemoryLayout::Alignment_v, Alloc>;
+    using AllocatorType = typename StorageType::AllocatorType;
     
     // Constructors
     TMLStaticMatrix() noexcept { this->SetZero(); }
     explicit TMLStaticMatrix(MLNoneType) noexcept { } // non-initialization constructor
+
+    // Constructors with an allocator
+    explicit TMLStaticMatrix(const AllocatorType& alloc) noexcept : m_storage(alloc) { this->SetZero(); }
+    explicit TMLStaticMatrix(MLNoneType, const AllocatorType& alloc) noexcept : m_storage(alloc) { }
     
     // Expression assignment
     template<typename Expr>
@@ -150,7 +187,8 @@ namespace ML
 
     // copy constructor/assignment operator
     TMLStaticMatrix(const TMLStaticMatrix& rhs) noexcept 
-      : TMLStaticMatrix(TMLDMAssignExpression<TMLStaticMatrix>(rhs)) {}
+      : TMLStaticMatrix(MLNoneType{}, std::allocator_traits<AllocatorType>::select_on_container_copy_construction(rhs.GetAllocator())) 
+      { this->Assign(TMLDMAssignExpression<TMLStaticMatrix>(rhs)); }
     TMLStaticMatrix& operator=(const TMLStaticMatrix& rhs) noexcept { return this->Assign(rhs); }
 
     // move constructor/assignment operator
@@ -175,24 +213,33 @@ namespace ML
     QM_ALWAYS_INLINE constexpr std::size_t Cols() const noexcept { return M; }
     QM_ALWAYS_INLINE constexpr std::size_t PaddedRows() const noexcept { return RowMajor ? Rows() : MemoryLayout::PaddedMinorCnt_v; }
     QM_ALWAYS_INLINE constexpr std::size_t PaddedCols() const noexcept { return RowMajor ? MemoryLayout::PaddedMinorCnt_v : Cols(); }
+
+    // Raw memory access (Spacing is the distance between two consecutive rows/columns)
+    QM_ALWAYS_INLINE ElementType* Data() noexcept { return m_storage.data(); }
+    QM_ALWAYS_INLINE const ElementType* Data() const noexcept { return m_storage.data(); }
+    QM_ALWAYS_INLINE constexpr std::size_t Spacing() const noexcept { return MemoryLayout::PaddedMinorCnt_v; }
+
+    AllocatorType GetAllocator() const noexcept { return m_storage.GetAllocator(); }
     
-    // Alias detection
+    // Alias detection (other shares elements with this matrix, e.g. a view of it)
     template<typename MT> QM_ALWAYS_INLINE TMLEnableIf_t<!TMLMatrixIsDense_v<MT>, bool> 
       IsAlias(const MT& other) { return false; }
     template<typename MT> QM_ALWAYS_INLINE TMLEnableIf_t<TMLMatrixIsDense_v<MT>, bool> 
-      IsAlias(const MT& other) { return static_cast<const void*>(this) == static_cast<const void*>(&(~other)); }
+      IsAlias(const MT& other) { return Internal::MLIsOverlapping(*this, ~other); }
     
-    // Load / Store
+    // Load / Store (the masked variants access the first n elements, e.g. at the end of a row)
     SIMDType Load(std::size_t i, std::size_t j) const { return SIMDType::LoadAligned(&((*this)(i, j))); }
     void Store(SIMDType reg, std::size_t i, std::size_t j) { SIMDType::StoreAligned(reg, &((*this)(i, j))); }
+    SIMDType LoadMasked(std::size_t i, std::size_t j, std::size_t n) const { return SIMDType::LoadMasked(&((*this)(i, j)), n); }
+    void StoreMasked(SIMDType reg, std::size_t i, std::size_t j, std::size_t n) { SIMDType::StoreMasked(reg, &((*this)(i, j)), n); }
 
   private:
-    Internal::TMLStaticMatrixStorage<ElementType, MemoryLayout::PaddedSize_v, MemoryLayout::Alignment_v> m_storage;
+    StorageType m_storage;
   };
   
-  template <typename ET, std::size_t N, std::size_t M, bool RowMajor, std::size_t maxSIMD>
-  template<typename Expr> TMLStaticMatrix<ET, N, M, RowMajor, maxSIMD>&
-    TMLStaticMatrix<ET, N, M, RowMajor, maxSIMD>::Assign(const TMLMatrixExpression<Expr>& expr) noexcept
+  template <typename ET, std::size_t N, std::size_t M, bool RowMajor, std::size_t maxSIMD, typename Alloc>
+  template<typename Expr> TMLStaticMatrix<ET, N, M, RowMajor, maxSIMD, Alloc>&
+    TMLStaticMatrix<ET, N, M, RowMajor, maxSIMD, Alloc>::Assign(const TMLMatrixExpression<Expr>& expr) noexcept
   {
     assert((~expr).Rows() == this->Rows());
     assert((~expr).Cols() == this->Cols());
@@ -200,9 +247,9 @@ namespace ML
     return *this;
   }
 
-  template <typename ET, std::size_t N, std::size_t M, bool RowMajor, std::size_t maxSIMD>
-  QM_ALWAYS_INLINE typename TMLStaticMatrix<ET, N, M, RowMajor, maxSIMD>::ElementType& 
-    TMLStaticMatrix<ET, N, M, RowMajor, maxSIMD>::operator()(std::size_t i, std::size_t j) noexcept
+  template <typename ET, std::size_t N, std::size_t M, bool RowMajor, std::size_t maxSIMD, typename Alloc>
+  QM_ALWAYS_INLINE typename TMLStaticMatrix<ET, N, M, RowMajor, maxSIMD, Alloc>::ElementType& 
+    TMLStaticMatrix<ET, N, M, RowMajor, maxSIMD, Alloc>::operator()(std::size_t i, std::size_t j) noexcept
   {
     assert(i < this->Rows());
     assert(j < this->Cols());
@@ -213,9 +260,9 @@ namespace ML
     return this->m_storage[MemoryLayout::CalcIndex(major, minor)];
   }
 
-  template <typename ET, std::size_t N, std::size_t M, bool RowMajor, std::size_t maxSIMD>
-  QM_ALWAYS_INLINE const typename TMLStaticMatrix<ET, N, M, RowMajor, maxSIMD>::ElementType& 
-    TMLStaticMatrix<ET, N, M, RowMajor, maxSIMD>::operator()(std::size_t i, std::size_t j) const noexcept
+  template <typename ET, std::size_t N, std::size_t M, bool RowMajor, std::size_t maxSIMD, typename Alloc>
+  QM_ALWAYS_INLINE const typename TMLStaticMatrix<ET, N, M, RowMajor, maxSIMD, Alloc>::ElementType& 
+    TMLStaticMatrix<ET, N, M, RowMajor, maxSIMD, Alloc>::operator()(std::size_t i, std::size_t j) const noexcept
   {
     assert(i < this->Rows());
     assert(j < this->Cols());
@@ -230,18 +277,27 @@ namespace ML
   // Traits
   //
 
-  template<typename ET, std::size_t N, std::size_t M, bool RowMajor, std::size_t maxSIMD>
-  struct TMLMatrixRows1<TMLStaticMatrix<ET, N, M, RowMajor, maxSIMD>, void>
+  template<typename ET, std::size_t N, std::size_t M, bool RowMajor, std::size_t maxSIMD, typename Alloc>
+  struct TMLMatrixRows1<TMLStaticMatrix<ET, N, M, RowMajor, maxSIMD, Alloc>, void>
     : TMLConstant<std::size_t, N> {};
 
-  template<typename ET, std::size_t N, std::size_t M, bool RowMajor, std::size_t maxSIMD>
-  struct TMLMatrixCols1<TMLStaticMatrix<ET, N, M, RowMajor, maxSIMD>, void>
+  template<typename ET, std::size_t N, std::size_t M, bool RowMajor, std::size_t maxSIMD, typename Alloc>
+  struct TMLMatrixCols1<TMLStaticMatrix<ET, N, M, RowMajor, maxSIMD, Alloc>, void>
     : TMLConstant<std::size_t, M> {};
 
-  template<typename ET, std::size_t N, std::size_t M, bool RowMajor, std::size_t maxSIMD>
-  struct TMLMatrixIsRowMajor1<TMLStaticMatrix<ET, N, M, RowMajor, maxSIMD>, void>
+  template<typename ET, std::size_t N, std::size_t M, bool RowMajor, std::size_t maxSIMD, typename Alloc>
+  struct TMLMatrixIsRowMajor1<TMLStaticMatrix<ET, N, M, RowMajor, maxSIMD, Alloc>, void>
     : TMLBooleanConstant<RowMajor> {};
 
+  template<typename ET, std::size_t N, std::size_t M, bool RowMajor, std::size_t maxSIMD, typename Alloc>
+  struct TMLMatrixCopyResult1<TMLStaticMatrix<ET, N, M, RowMajor, maxSIMD, Alloc>, void>
+    : TMLType<TMLStaticMatrix<ET, N, M, RowMajor, maxSIMD, Alloc>> {};
+
+  // (only matrices of 16kB and more allocate, the others stay on the stack)
+  template<typename ET, std::size_t N, std::size_t M, bool RowMajor, std::size_t maxSIMD, typename Alloc>
+  struct TMLMatrixScratchResult1<TMLStaticMatrix<ET, N, M, RowMajor, maxSIMD, Alloc>, void>
+    : TMLType<TMLStaticMatrix<ET, N, M, RowMajor, maxSIMD, TMLScratchAllocator<std::decay_t<ET>>>> {};
+
 
   // Arithmetic traits
   template<typename MT1, typename MT2>
@@ -292,6 +348,24 @@ namespace ML
         TMLMatrixIsRowMajor_v<MT1>
       >> {};
 
+  template<typename MT>
+  struct TMLMatrixTransResult1<MT, TMLEnableIf_t<TMLMatrixIsStatic_v<MT>>>
+    : TMLType<TMLStaticMatrix<
+        TMLMatrixElementType_t<MT>, 
+        TMLMatrixCols_v<MT>, 
+        TMLMatrixRows_v<MT>,
+        TMLMatrixIsRowMajor_v<MT>
+      >> {};
+
+  template<typename MT, bool rowwise, typename ET>
+  struct TMLMatrixReduceResult1<MT, rowwise, ET, TMLEnableIf_t<TMLMatrixIsStatic_v<MT>>>
+    : TMLType<TMLStaticMatrix<
+        ET, 
+        rowwise ? TMLMatrixRows_v<MT> : 1, 
+        rowwise ? 1 : TMLMatrixCols_v<MT>,
+        !rowwise
+      >> {};
+
 }
 
 #endif
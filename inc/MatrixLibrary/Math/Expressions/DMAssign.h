@@ -9,6 +9,10 @@
 
 #include "../../QTL/EnableIf.h"
 
+#if defined(ML_MATH_RUNTIME_DISPATCH)
+#include "../Kernels/Dispatch.h"
+#endif
+
 namespace ML
 {
   
@@ -18,7 +22,7 @@ namespace ML
   public:
     using MyT = TMLDMAssignExpression<M1>;
     using LOpType = TMLDecayMatrixType_t<M1>;
-    using ResultType = TMLDecayMatrixType_t<M1>;
+    using ResultType = TMLMatrixCopyResult_t<M1>;
     
     using ElementType = TMLMatrixElementType_t<M1>;
     using SIMDType = TMLMatrixSIMDType_t<M1>;
@@ -43,16 +47,37 @@ namespace ML
       TMLMatrixIsSameSIMDType_v<MT, LOpType> && 
       TMLMatrixIsRowMajor_v<MT> == TMLMatrixIsRowMajor_v<LOpType>;
 
+#if defined(ML_MATH_RUNTIME_DISPATCH)
+    // Dynamic matrices are copied by the kernel of the instruction set that is selected at runtime
+    template<typename MT>
+    constexpr static bool IsDispatched_v = 
+      IsVectorizable_v<MT> &&
+      TMLMatrixIsDynamic_v<MT> &&
+      TMLMatrixIsDynamic_v<LOpType> &&
+      TMLHasKernelTable_v<ElementType>;
+#else
+    template<typename MT>
+    constexpr static bool IsDispatched_v = false;
+#endif
+
     // Selects the right kernel
     template<typename MT> TMLEnableIf_t<!IsVectorizable_v<MT>, void> 
       ExecuteKernel(TMLDenseMatrix<MT>& res, const LOpType& lhs) const { DefaultKernel(res, lhs); }
-    template<typename MT> TMLEnableIf_t<IsVectorizable_v<MT>, void>
+    template<typename MT> TMLEnableIf_t<IsVectorizable_v<MT> && !IsDispatched_v<MT>, void>
       ExecuteKernel(TMLDenseMatrix<MT>& res, const LOpType& lhs) const { VectorizedKernel(res, lhs); }
+#if defined(ML_MATH_RUNTIME_DISPATCH)
+    template<typename MT> TMLEnableIf_t<IsDispatched_v<MT>, void>
+      ExecuteKernel(TMLDenseMatrix<MT>& res, const LOpType& lhs) const { DispatchedKernel(res, lhs); }
+#endif
 
     template<typename MT>
     void DefaultKernel(TMLDenseMatrix<MT>& res, const LOpType& lhs) const;
     template<typename MT, typename=TMLEnableIf_t<IsVectorizable_v<MT>>>
     void VectorizedKernel(TMLDenseMatrix<MT>& res, const LOpType& lhs) const;
+#if defined(ML_MATH_RUNTIME_DISPATCH)
+    template<typename MT, typename=TMLEnableIf_t<IsDispatched_v<MT>>>
+    void DispatchedKernel(TMLDenseMatrix<MT>& res, const LOpType& lhs) const;
+#endif
     
     const LOpType& m_lhs;
   };
@@ -73,11 +98,15 @@ namespace ML
     assert((~res).Rows() == (~m_lhs).Rows());
     assert((~res).Cols() == (~m_lhs).Cols());
     
-    // self assignment detection
-    const void* resAddr = static_cast<const void*>(&(~res));
-    const void* lhsAddr = static_cast<const void*>(&(~m_lhs));
-    if (resAddr == lhsAddr)
+    // self assignment detection (a view that overlaps the result elsewhere is copied via a temporary)
+    if (Internal::MLIsSameBlock(res, m_lhs))
+      return;
+    if (Internal::MLIsOverlapping(res, m_lhs))
+    {
+      const TMLMatrixScratchResult_t<LOpType> tmp(m_lhs);
+      (~res).Assign(tmp);
       return;
+    }
     
     ExecuteKernel(res, m_lhs);
   }
@@ -101,15 +130,58 @@ namespace ML
   void TMLDMAssignExpression<M1>::VectorizedKernel(
     TMLDenseMatrix<MT>& res, const LOpType& lhs) const
   {
-    for (size_t i = 0; i < (~res).Rows(); i++)
+    // SIMD registers span consecutive elements of a row (row-major) or a column (column-major).
+    // The last register of a row/column is stored masked (the padding is not accessed).
+    if (TMLMatrixIsRowMajor_v<MT>)
+    {
+      for (size_t i = 0; i < (~res).Rows(); i++)
+      {
+        size_t j = 0;
+        for (; (j + TMLSIMDSize_v<SIMDType>) <= (~res).Cols(); j += TMLSIMDSize_v<SIMDType>)
+        {
+          (~res).Store((~lhs).Load(i, j), i, j);
+        }
+        if (j < (~res).Cols())
+          (~res).StoreMasked((~lhs).LoadMasked(i, j, (~res).Cols() - j), i, j, (~res).Cols() - j);
+      }
+    }
+    else
     {
-      for (size_t j = 0; j < (~res).Cols(); j += TMLSIMDSize_v<SIMDType>)
+      for (size_t j = 0; j < (~res).Cols(); j++)
       {
-        (~res).Store((~lhs).Load(i, j), i, j);
+        size_t i = 0;
+        for (; (i + TMLSIMDSize_v<SIMDType>) <= (~res).Rows(); i += TMLSIMDSize_v<SIMDType>)
+        {
+          (~res).Store((~lhs).Load(i, j), i, j);
+        }
+        if (i < (~res).Rows())
+          (~res).StoreMasked((~lhs).LoadMasked(i, j, (~res).Rows() - i), i, j, (~res).Rows() - i);
       }
     }
   }
-  
+
+#if defined(ML_MATH_RUNTIME_DISPATCH)
+  template<typename M1>
+  template<typename MT, typename>
+  void TMLDMAssignExpression<M1>::DispatchedKernel(
+    TMLDenseMatrix<MT>& res, const LOpType& lhs) const
+  {
+    const auto& kernels = MLGetKernelTable<ElementType>();
+
+    // Tightly packed matrices are copied at once, otherwise the padding is skipped
+    const std::size_t outer = TMLMatrixIsRowMajor_v<MT> ? (~res).Rows() : (~res).Cols();
+    const std::size_t inner = TMLMatrixIsRowMajor_v<MT> ? (~res).Cols() : (~res).Rows();
+    if ((~res).Spacing() == inner && (~lhs).Spacing() == inner)
+    {
+      kernels.copy((~res).Data(), (~lhs).Data(), outer * inner);
+    }
+    else
+    {
+      for (size_t i = 0; i < outer; i++)
+        kernels.copy((~res).Data() + i * (~res).Spacing(), (~lhs).Data() + i * (~lhs).Spacing(), inner);
+    }
+  }
+#endif
 
 }
 
@@ -0,0 +1,308 @@
+// Copyright 2021, Philipp Neufeld
+
+#ifndef ML_MATH_Expressions_DMBroadcast_H_
+#define ML_MATH_Expressions_DMBroadcast_H_
+
+// Includes
+#include <type_traits>
+#include <cassert>
+
+#include "MatrixExpression.h"
+#include "DMDMElementwise.h"
+#include "../Matrix.h"
+
+#include "../../QTL/EnableIf.h"
+#include "../../QTL/Boolean.h"
+
+namespace ML
+{
+
+  // Direction of a broadcast: Rowwise applies element i of a column vector (an element per row, e.g. the
+  // result of a rowwise reduction) to every element of row i, Columnwise element j of a row vector to every
+  // element of column j
+  enum class EMLBroadcast
+  {
+    Rowwise,
+    Columnwise
+  };
+
+  namespace Internal
+  {
+    // Vector operand of MLElementwiseKernel that is repeated over the lines (along the lines of the result)
+    // or over the elements of each line (across the lines). Along the lines the vector is loaded like a
+    // line of a matrix and stays in the L1 cache, if its elements are not contiguous the part of the current
+    // block is copied into a buffer. Across the lines every register holds one element.
+    template<typename VT, bool rowMajor, bool rowwise>
+    class TMLBroadcastOperand
+    {
+    public:
+      using ElementType = TMLMatrixElementType_t<VT>;
+      using SIMDType = TMLMatrixSIMDType_t<VT>;
+
+      constexpr static std::size_t BlockSize_v = MLElementwiseBlockSize_v;
+      constexpr static bool AlongLines_v = rowwise != rowMajor;
+      constexpr static bool Transpose_v = AlongLines_v && TMLMatrixIsRowMajor_v<VT> == rowwise;
+
+      explicit TMLBroadcastOperand(const VT& vec) : m_vec(vec) {}
+
+      // Prepares the elements [n0, n1) of the vector
+      QM_ALWAYS_INLINE void Block(std::size_t o0, std::size_t o1, std::size_t n0, std::size_t n1)
+      {
+        if (!Transpose_v)
+          return;
+        m_n0 = n0;
+        for (std::size_t n = n0; n < n1; n++)
+          m_tile[n - n0] = Element(n);
+      }
+
+      QM_ALWAYS_INLINE SIMDType Load(std::size_t o, std::size_t n) const
+      {
+        if (!AlongLines_v)
+          return SIMDType::Set1(Element(o));
+        if (Transpose_v)
+          return SIMDType::LoadUnaligned(m_tile + (n - m_n0));
+        return rowwise ? m_vec.Load(n, 0) : m_vec.Load(0, n);
+      }
+
+      QM_ALWAYS_INLINE SIMDType LoadMasked(std::size_t o, std::size_t n, std::size_t cnt) const
+      {
+        if (!AlongLines_v)
+          return SIMDType::Set1(Element(o));
+        if (Transpose_v)
+          return SIMDType::LoadMasked(m_tile + (n - m_n0), cnt);
+        return rowwise ? m_vec.LoadMasked(n, 0, cnt) : m_vec.LoadMasked(0, n, cnt);
+      }
+
+    private:
+      QM_ALWAYS_INLINE ElementType Element(std::size_t k) const { return rowwise ? m_vec(k, 0) : m_vec(0, k); }
+
+      const VT& m_vec;
+      std::size_t m_n0 = 0;
+      ElementType m_tile[Transpose_v ? BlockSize_v : 1];
+    };
+
+    // Does a broadcast vector overlap res? Unlike the matrix operand, every element of the vector is read
+    // for a whole row or column of res, so any overlap is an alias. Expressions are evaluated into temporaries.
+    template<typename MT, typename VT>
+    TMLEnableIf_t<TMLIsMatrix_v<VT>, bool> MLIsBroadcastAlias(const MT& res, const VT& vec) noexcept
+    {
+      return MLIsOverlapping(res, vec);
+    }
+    template<typename MT, typename ExT>
+    TMLEnableIf_t<TMLIsMatrixExpression_v<ExT>, bool> MLIsBroadcastAlias(const MT& res, const ExT& expr) noexcept
+    {
+      return false;
+    }
+  }
+
+  // Elementwise operation of a dense matrix and a row or column vector that is repeated over the columns
+  // or rows of the matrix (MLBroadcastAdd, MLBroadcastSub, MLBroadcastMul and MLBroadcastDiv)
+  template<typename M1, typename V1, typename OP, bool rowwise>
+  class TMLDMBroadcastExpression : public TMLMatrixExpression<TMLDMBroadcastExpression<M1, V1, OP, rowwise>>
+  {
+    template<EMLBroadcast D, typename M, typename V, typename> friend auto MLBroadcastAdd(const M& mat, const V& vec);
+    template<EMLBroadcast D, typename M, typename V, typename> friend auto MLBroadcastSub(const M& mat, const V& vec);
+    template<EMLBroadcast D, typename M, typename V, typename> friend auto MLBroadcastMul(const M& mat, const V& vec);
+    template<EMLBroadcast D, typename M, typename V, typename> friend auto MLBroadcastDiv(const M& mat, const V& vec);
+
+  public:
+    using MyT = TMLDMBroadcastExpression<M1, V1, OP, rowwise>;
+    using LOpType = TMLDecayCRTP_t<M1>;
+    using ROpType = TMLDecayCRTP_t<V1>;
+    using LOpResType = TMLMatrixExpressionResultType_t<LOpType>;
+    using LOpTmpType = TMLMatrixExpressionTemporary_t<LOpType>;
+    using ROpResType = TMLMatrixExpressionResultType_t<ROpType>;
+    using ROpTmpType = TMLMatrixExpressionTemporary_t<ROpType>;
+    using ResultType = TMLMatrixCopyResult_t<LOpResType>;
+    using OperationType = OP;
+
+    using ElementType = TMLMatrixElementType_t<LOpResType>;
+    using SIMDType = TMLMatrixSIMDType_t<LOpResType>;
+
+    explicit TMLDMBroadcastExpression(const M1& mat, const V1& vec)
+    : m_mat(~mat), m_vec(~vec)
+    {
+      assert(rowwise ? ((~vec).Rows() == (~mat).Rows() && (~vec).Cols() == 1) :
+        ((~vec).Rows() == 1 && (~vec).Cols() == (~mat).Cols()));
+    }
+
+  private:
+    // Make copy/move private in order to prevent direct assignment of an expression
+    TMLDMBroadcastExpression(const MyT&) = default;
+    TMLDMBroadcastExpression(MyT&&) noexcept = default;
+    MyT& operator=(const MyT&) = default;
+    MyT& operator=(MyT&&) noexcept = default;
+  public:
+
+    constexpr std::size_t Rows() const noexcept { return (~m_mat).Rows(); }
+    constexpr std::size_t Cols() const noexcept { return (~m_mat).Cols(); }
+
+    ElementType operator()(std::size_t i, std::size_t j) const noexcept;
+
+    template<typename MT, typename=LOpResType>
+    void AssignTo(TMLDenseMatrix<MT>& res) const;
+
+    // Operand tree of the expression for Internal::MLElementwiseKernel
+    template<bool rowMajor>
+    auto Operand() const
+    {
+      return Internal::MLElementwiseNode(OperationType(), Internal::MLElementwiseOperand<rowMajor>(m_mat),
+        Internal::TMLBroadcastOperand<ROpType, rowMajor, rowwise>(m_vec));
+    }
+
+    // Does the matrix overlap res at other positions or the vector overlap res at all?
+    template<typename MT>
+    bool IsElementwiseAlias(const MT& res) const noexcept
+    {
+      return Internal::MLIsElementwiseAlias(res, m_mat) || Internal::MLIsBroadcastAlias(res, m_vec);
+    }
+
+  public:
+    // The vector is read in place, so it has to be a matrix (expressions are evaluated first)
+    template<typename SIMD>
+    constexpr static bool IsFusable_v =
+      Internal::TMLIsElementwiseFusable_v<LOpType, SIMD> &&
+      TMLIsMatrix_v<ROpType> &&
+      Internal::TMLIsElementwiseFusable_v<ROpType, SIMD> &&
+      OperationType::template IsVectorizable_v<ElementType>;
+
+    // A broadcast of an elementwise expression (e.g. (a - mean) / std) is computed in one pass
+    template<typename MT>
+    constexpr static bool IsFused_v =
+      TMLIsMatrixExpression_v<LOpType> &&
+      TMLMatrixIsVectorized_v<MT> &&
+      IsFusable_v<TMLMatrixSIMDType_t<MT>>;
+
+    template<typename C, typename A, typename V>
+    constexpr static bool IsVectorizable_v =
+      TMLMatrixIsDense_v<C> &&
+      TMLMatrixIsDense_v<A> &&
+      TMLMatrixIsDense_v<V> &&
+      TMLMatrixIsVectorized_v<C> &&
+      TMLMatrixIsVectorized_v<A> &&
+      TMLMatrixIsVectorized_v<V> &&
+      TMLMatrixIsSameSIMDType_v<C, A, V> &&
+      OperationType::template IsVectorizable_v<TMLMatrixElementType_t<C>>;
+
+    template<typename MT> TMLEnableIf_t<!IsFused_v<MT>, void> Evaluate(TMLDenseMatrix<MT>& res) const
+      { const LOpTmpType& mat(m_mat); const ROpTmpType& vec(m_vec); ExecuteKernel(res, mat, vec); }
+    template<typename MT> TMLEnableIf_t<IsFused_v<MT>, void> Evaluate(TMLDenseMatrix<MT>& res) const { FusedKernel(res); }
+
+    // Selects the right kernel
+    template<typename C, typename A, typename V> TMLEnableIf_t<!IsVectorizable_v<C, A, V>, void>
+      ExecuteKernel(TMLDenseMatrix<C>& c, const TMLDenseMatrix<A>& a, const TMLDenseMatrix<V>& v) const { DefaultKernel(c, a, v); }
+    template<typename C, typename A, typename V> TMLEnableIf_t<IsVectorizable_v<C, A, V>, void>
+      ExecuteKernel(TMLDenseMatrix<C>& c, const TMLDenseMatrix<A>& a, const TMLDenseMatrix<V>& v) const { VectorizedKernel(c, a, v); }
+
+    template<typename C, typename A, typename V>
+    static void DefaultKernel(TMLDenseMatrix<C>& c, const TMLDenseMatrix<A>& a, const TMLDenseMatrix<V>& v);
+    template<typename C, typename A, typename V, typename=TMLEnableIf_t<IsVectorizable_v<C, A, V>>>
+    static void VectorizedKernel(TMLDenseMatrix<C>& c, const TMLDenseMatrix<A>& a, const TMLDenseMatrix<V>& v);
+    template<typename MT, typename=TMLEnableIf_t<IsFused_v<MT>>>
+    void FusedKernel(TMLDenseMatrix<MT>& res) const;
+
+    const LOpType& m_mat;
+    const ROpType& m_vec;
+  };
+
+  // The operands are a dense matrix and a dense vector
+  template<typename MT, typename VT>
+  constexpr bool TMLIsBroadcastOperand_v =
+    TMLMatrixIsDense_v<TMLMatrixExpressionResultType_t<MT>> &&
+    TMLMatrixIsDense_v<TMLMatrixExpressionResultType_t<VT>>;
+
+  // Adds a bias vector to every row (Columnwise, 1 x n vector) or every column (Rowwise, m x 1 vector)
+  template<EMLBroadcast D, typename MT, typename VT, typename=TMLEnableIf_t<TMLIsBroadcastOperand_v<MT, VT>>>
+  auto MLBroadcastAdd(const MT& mat, const VT& vec)
+  {
+    return TMLDMBroadcastExpression<MT, VT, Internal::SMLElementwiseAdd, D == EMLBroadcast::Rowwise>(mat, vec);
+  }
+
+  // Subtracts a vector (e.g. the means of the rows or columns)
+  template<EMLBroadcast D, typename MT, typename VT, typename=TMLEnableIf_t<TMLIsBroadcastOperand_v<MT, VT>>>
+  auto MLBroadcastSub(const MT& mat, const VT& vec)
+  {
+    return TMLDMBroadcastExpression<MT, VT, Internal::SMLElementwiseSub, D == EMLBroadcast::Rowwise>(mat, vec);
+  }
+
+  // Scales the rows or columns elementwise by a vector
+  template<EMLBroadcast D, typename MT, typename VT, typename=TMLEnableIf_t<TMLIsBroadcastOperand_v<MT, VT>>>
+  auto MLBroadcastMul(const MT& mat, const VT& vec)
+  {
+    return TMLDMBroadcastExpression<MT, VT, Internal::SMLElementwiseMul, D == EMLBroadcast::Rowwise>(mat, vec);
+  }
+
+  // Divides the rows or columns elementwise by a vector (e.g. the standard deviations)
+  template<EMLBroadcast D, typename MT, typename VT, typename=TMLEnableIf_t<TMLIsBroadcastOperand_v<MT, VT>>>
+  auto MLBroadcastDiv(const MT& mat, const VT& vec)
+  {
+    return TMLDMBroadcastExpression<MT, VT, Internal::SMLElementwiseDiv, D == EMLBroadcast::Rowwise>(mat, vec);
+  }
+
+  template<typename M1, typename V1, typename OP, bool rowwise>
+  typename TMLDMBroadcastExpression<M1, V1, OP, rowwise>::ElementType
+    TMLDMBroadcastExpression<M1, V1, OP, rowwise>::operator()(std::size_t i, std::size_t j) const noexcept
+  {
+    assert(i < Rows());
+    assert(j < Cols());
+
+    const auto& vec = ~m_vec;
+    return OperationType()(static_cast<ElementType>((~m_mat)(i, j)), static_cast<ElementType>(rowwise ? vec(i, 0) : vec(0, j)));
+  }
+
+  template<typename M1, typename V1, typename OP, bool rowwise>
+  template<typename MT, typename>
+  void TMLDMBroadcastExpression<M1, V1, OP, rowwise>::AssignTo(TMLDenseMatrix<MT>& res) const
+  {
+    assert((~res).Rows() == (~m_mat).Rows());
+    assert((~res).Cols() == (~m_mat).Cols());
+
+    // in-place is fine for the matrix (e.g. a = MLBroadcastSub<...>(a, mean)), but not for the vector
+    if (IsElementwiseAlias(~res))
+    {
+      const TMLMatrixScratchResult_t<ResultType> tmp(*this);
+      (~res).Assign(tmp);
+    }
+    else
+    {
+      Evaluate(res);
+    }
+  }
+
+  template<typename M1, typename V1, typename OP, bool rowwise>
+  template<typename C, typename A, typename V>
+  void TMLDMBroadcastExpression<M1, V1, OP, rowwise>::DefaultKernel(
+    TMLDenseMatrix<C>& c, const TMLDenseMatrix<A>& a, const TMLDenseMatrix<V>& v)
+  {
+    const OperationType op;
+    for (size_t i = 0; i < (~c).Rows(); i++)
+    {
+      for (size_t j = 0; j < (~c).Cols(); j++)
+      {
+        (~c)(i, j) = op(static_cast<ElementType>((~a)(i, j)), static_cast<ElementType>(rowwise ? (~v)(i, 0) : (~v)(0, j)));
+      }
+    }
+  }
+
+  template<typename M1, typename V1, typename OP, bool rowwise>
+  template<typename C, typename A, typename V, typename>
+  void TMLDMBroadcastExpression<M1, V1, OP, rowwise>::VectorizedKernel(
+    TMLDenseMatrix<C>& c, const TMLDenseMatrix<A>& a, const TMLDenseMatrix<V>& v)
+  {
+    constexpr bool rowMajor = TMLMatrixIsRowMajor_v<C>;
+    auto operand = Internal::MLElementwiseNode(OperationType(), Internal::MLElementwiseOperand<rowMajor>(~a),
+      Internal::TMLBroadcastOperand<V, rowMajor, rowwise>(~v));
+    Internal::MLElementwiseKernel(~c, operand);
+  }
+
+  template<typename M1, typename V1, typename OP, bool rowwise>
+  template<typename MT, typename>
+  void TMLDMBroadcastExpression<M1, V1, OP, rowwise>::FusedKernel(TMLDenseMatrix<MT>& res) const
+  {
+    auto operand = Operand<TMLMatrixIsRowMajor_v<MT>>();
+    Internal::MLElementwiseKernel(~res, operand);
+  }
+
+}
+
+#endif
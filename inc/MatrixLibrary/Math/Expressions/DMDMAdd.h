@@ -8,10 +8,16 @@
 #include <cassert>
 
 #include "MatrixExpression.h"
+#include "DMDMElementwise.h"
+#include "GemmUpdate.h"
 #include "../Matrix.h"
 
 #include "../../QTL/EnableIf.h"
 
+#if defined(ML_MATH_RUNTIME_DISPATCH)
+#include "../Kernels/Dispatch.h"
+#endif
+
 namespace ML
 {
 
@@ -26,7 +32,9 @@ namespace ML
     using LOpType = TMLDecayCRTP_t<M1>;
     using ROpType = TMLDecayCRTP_t<M2>;
     using LOpResType = TMLMatrixExpressionResultType_t<LOpType>;
+    using LOpTmpType = TMLMatrixExpressionTemporary_t<LOpType>;
     using ROpResType = TMLMatrixExpressionResultType_t<ROpType>;
+    using ROpTmpType = TMLMatrixExpressionTemporary_t<ROpType>;
     using ResultType = TMLMatrixAddResult_t<LOpResType, ROpResType>;
 
     using ElementType = TMLMatrixCommonElementType_t<LOpResType, ROpResType>;
@@ -35,7 +43,7 @@ namespace ML
       TMLMatrixSIMDType_t<LOpResType>, ElementType>;
 
     explicit TMLDMDMAddExpression(const M1& lhs, const M2& rhs) 
-    : m_lhs(~lhs), m_rhs(~rhs) { assert((~lhs).Cols() == (~rhs).Rows()); }
+    : m_lhs(~lhs), m_rhs(~rhs) { assert((~lhs).Rows() == (~rhs).Rows() && (~lhs).Cols() == (~rhs).Cols()); }
 
   private:
     // Make copy/move private in order to prevent direct assignment of an expression
@@ -55,7 +63,44 @@ namespace ML
     template<typename MT, typename=LOpResType>
     void AssignTo(TMLDenseMatrix<MT>& res) const;
 
+    // Operand tree of the expression for Internal::MLElementwiseKernel
+    template<bool rowMajor>
+    auto Operand() const 
+    { 
+      return Internal::MLElementwiseNode(Internal::SMLElementwiseAdd(), 
+        Internal::MLElementwiseOperand<rowMajor>(m_lhs), Internal::MLElementwiseOperand<rowMajor>(m_rhs)); 
+    }
+
+    // Is an operand a matrix that overlaps res at other positions (see Internal::MLIsElementwiseAlias)?
+    template<typename MT>
+    bool IsElementwiseAlias(const MT& res) const noexcept
+    {
+      return Internal::MLIsElementwiseAlias(res, m_lhs) || Internal::MLIsElementwiseAlias(res, m_rhs);
+    }
+
   public:
+    template<typename SIMD>
+    constexpr static bool IsFusable_v =
+      Internal::TMLIsElementwiseFusable_v<LOpType, SIMD> &&
+      Internal::TMLIsElementwiseFusable_v<ROpType, SIMD>;
+
+    // Sums with nested elementwise expressions (e.g. a + b + c) are computed in one pass without temporaries
+    template<typename MT>
+    constexpr static bool IsFused_v =
+      (TMLIsMatrixExpression_v<LOpType> || TMLIsMatrixExpression_v<ROpType>) &&
+      TMLMatrixIsVectorized_v<MT> &&
+      IsFusable_v<TMLMatrixSIMDType_t<MT>>;
+
+    // Sums of a product and a matrix (e.g. d = a * b + c) accumulate the product into the result
+    template<typename MT>
+    constexpr static bool IsGemmUpdate_v = Internal::TMLIsGemmUpdate_v<MT, LOpType, ROpType>;
+
+    // Returns false if the sum is not computed by a GEMM
+    template<typename MT> TMLEnableIf_t<!IsGemmUpdate_v<MT>, bool> 
+      ExecuteGemmUpdate(TMLDenseMatrix<MT>& res) const { return false; }
+    template<typename MT> TMLEnableIf_t<IsGemmUpdate_v<MT>, bool> 
+      ExecuteGemmUpdate(TMLDenseMatrix<MT>& res) const { return Internal::MLGemmUpdate(res, m_lhs, m_rhs, ElementType(1)); }
+
     template<typename C, typename A, typename B>
     constexpr static bool IsVectorizable_v = 
       TMLMatrixIsDense_v<C> &&
@@ -66,13 +111,48 @@ namespace ML
       TMLMatrixIsVectorized_v<B> &&
       TMLMatrixIsSameSIMDType_v<C, A, B>;
 
+#if defined(ML_MATH_RUNTIME_DISPATCH)
+    // Dynamic matrices are added by the kernel of the instruction set that is selected at runtime
+    template<typename C, typename A, typename B>
+    constexpr static bool IsDispatched_v = 
+      TMLMatrixIsDynamic_v<C> &&
+      TMLMatrixIsDynamic_v<A> &&
+      TMLMatrixIsDynamic_v<B> &&
+      TMLMatrixIsSameElementType_v<C, A, B> &&
+      TMLHasKernelTable_v<TMLMatrixElementType_t<C>> &&
+      TMLMatrixIsRowMajor_v<C> == TMLMatrixIsRowMajor_v<A> &&
+      TMLMatrixIsRowMajor_v<C> == TMLMatrixIsRowMajor_v<B>;
+#else
+    template<typename C, typename A, typename B>
+    constexpr static bool IsDispatched_v = false;
+#endif
+
+    template<typename MT> TMLEnableIf_t<!IsFused_v<MT>, void> Evaluate(TMLDenseMatrix<MT>& res) const 
+      { const LOpTmpType& lhs(m_lhs); const ROpTmpType& rhs(m_rhs); ExecuteKernel(res, lhs, rhs); }
+    template<typename MT> TMLEnableIf_t<IsFused_v<MT>, void> Evaluate(TMLDenseMatrix<MT>& res) const { FusedKernel(res); }
+
     // Selects the right kernel
-    template<typename C, typename A, typename B> 
-    void ExecuteKernel(TMLDenseMatrix<C>& c, const TMLDenseMatrix<A>& a, const TMLDenseMatrix<B>& b) const { DefaultKernel(c, a, b); }
-    
+    template<typename C, typename A, typename B> TMLEnableIf_t<!IsVectorizable_v<C, A, B> && !IsDispatched_v<C, A, B>, void>
+      ExecuteKernel(TMLDenseMatrix<C>& c, const TMLDenseMatrix<A>& a, const TMLDenseMatrix<B>& b) const { DefaultKernel(c, a, b); }
+    template<typename C, typename A, typename B> TMLEnableIf_t<IsVectorizable_v<C, A, B> && !IsDispatched_v<C, A, B>, void>
+      ExecuteKernel(TMLDenseMatrix<C>& c, const TMLDenseMatrix<A>& a, const TMLDenseMatrix<B>& b) const { VectorizedKernel(c, a, b); }
+#if defined(ML_MATH_RUNTIME_DISPATCH)
+    template<typename C, typename A, typename B> TMLEnableIf_t<IsDispatched_v<C, A, B>, void>
+      ExecuteKernel(TMLDenseMatrix<C>& c, const TMLDenseMatrix<A>& a, const TMLDenseMatrix<B>& b) const { DispatchedKernel(c, a, b); }
+#endif
+
+
     // Addition kernels
     template<typename C, typename A, typename B> 
     static void DefaultKernel(TMLDenseMatrix<C>& c, const TMLDenseMatrix<A>& a, const TMLDenseMatrix<B>& b);
+    template<typename C, typename A, typename B, typename=TMLEnableIf_t<IsVectorizable_v<C, A, B>>>
+    static void VectorizedKernel(TMLDenseMatrix<C>& c, const TMLDenseMatrix<A>& a, const TMLDenseMatrix<B>& b);
+    template<typename MT, typename=TMLEnableIf_t<IsFused_v<MT>>>
+    void FusedKernel(TMLDenseMatrix<MT>& res) const;
+#if defined(ML_MATH_RUNTIME_DISPATCH)
+    template<typename C, typename A, typename B, typename=TMLEnableIf_t<IsDispatched_v<C, A, B>>>
+    static void DispatchedKernel(TMLDenseMatrix<C>& c, const TMLDenseMatrix<A>& a, const TMLDenseMatrix<B>& b);
+#endif
     
     const LOpType& m_lhs;
     const ROpType& m_rhs;
@@ -103,11 +183,20 @@ namespace ML
     assert((~res).Rows() == (~m_lhs).Rows());
     assert((~res).Cols() == (~m_rhs).Cols());
 
-    const LOpResType& lhs(m_lhs);
-    const ROpResType& rhs(m_rhs);
+    if (ExecuteGemmUpdate(res))
+      return;
 
-    // no need to check for alias since addition can be performed in-place
-    ExecuteKernel(res, lhs, rhs);
+    // no need to check for alias since addition can be performed in-place (unless an operand is
+    // shifted against the result, e.g. an overlapping view)
+    if (IsElementwiseAlias(~res))
+    {
+      const TMLMatrixScratchResult_t<ResultType> tmp(*this);
+      (~res).Assign(tmp);
+    }
+    else
+    {
+      Evaluate(res);
+    }
   }
 
   template<typename M1, typename M2>
@@ -124,6 +213,46 @@ namespace ML
     }
   }
 
+  template<typename M1, typename M2>
+  template<typename C, typename A, typename B, typename>
+  void TMLDMDMAddExpression<M1, M2>::VectorizedKernel(
+    TMLDenseMatrix<C>& c, const TMLDenseMatrix<A>& a, const TMLDenseMatrix<B>& b)
+  {
+    // Operands with the other layout than C are transposed block by block
+    Internal::MLElementwiseKernel(~c, Internal::SMLElementwiseAdd(), ~a, ~b);
+  }
+
+  template<typename M1, typename M2>
+  template<typename MT, typename>
+  void TMLDMDMAddExpression<M1, M2>::FusedKernel(TMLDenseMatrix<MT>& res) const
+  {
+    auto operand = Operand<TMLMatrixIsRowMajor_v<MT>>();
+    Internal::MLElementwiseKernel(~res, operand);
+  }
+
+#if defined(ML_MATH_RUNTIME_DISPATCH)
+  template<typename M1, typename M2>
+  template<typename C, typename A, typename B, typename>
+  void TMLDMDMAddExpression<M1, M2>::DispatchedKernel(
+    TMLDenseMatrix<C>& c, const TMLDenseMatrix<A>& a, const TMLDenseMatrix<B>& b)
+  {
+    const auto& kernels = MLGetKernelTable<TMLMatrixElementType_t<C>>();
+
+    // Tightly packed matrices are added at once, otherwise the padding is skipped
+    const std::size_t outer = TMLMatrixIsRowMajor_v<C> ? (~c).Rows() : (~c).Cols();
+    const std::size_t inner = TMLMatrixIsRowMajor_v<C> ? (~c).Cols() : (~c).Rows();
+    if ((~c).Spacing() == inner && (~a).Spacing() == inner && (~b).Spacing() == inner)
+    {
+      kernels.add((~c).Data(), (~a).Data(), (~b).Data(), outer * inner);
+    }
+    else
+    {
+      for (size_t i = 0; i < outer; i++)
+        kernels.add((~c).Data() + i * (~c).Spacing(), (~a).Data() + i * (~a).Spacing(), (~b).Data() + i * (~b).Spacing(), inner);
+    }
+  }
+#endif
+
 }
 
 #endif
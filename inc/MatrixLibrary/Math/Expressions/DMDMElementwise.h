@@ -0,0 +1,481 @@
+// Copyright 2021, Philipp Neufeld
+
+#ifndef ML_MATH_Expressions_DMDMElementwise_H_
+#define ML_MATH_Expressions_DMDMElementwise_H_
+
+// Includes
+#include <type_traits>
+#include <algorithm>
+#include <cassert>
+
+#include "MatrixExpression.h"
+#include "GemmUpdate.h"
+#include "../Matrix.h"
+
+#include "../../QTL/EnableIf.h"
+#include "../../QTL/Boolean.h"
+
+namespace ML
+{
+
+  namespace Internal
+  {
+    // Elementwise operations (applied to elements as well as to SIMD registers)
+    struct SMLElementwiseAdd
+    {
+      template<typename ET> constexpr static bool IsVectorizable_v = true;
+      template<typename T> QM_ALWAYS_INLINE T operator()(const T& a, const T& b) const { return a + b; }
+    };
+
+    struct SMLElementwiseSub
+    {
+      template<typename ET> constexpr static bool IsVectorizable_v = true;
+      template<typename T> QM_ALWAYS_INLINE T operator()(const T& a, const T& b) const { return a - b; }
+    };
+
+    struct SMLElementwiseMul
+    {
+      template<typename ET> constexpr static bool IsVectorizable_v = true;
+      template<typename T> QM_ALWAYS_INLINE T operator()(const T& a, const T& b) const { return a * b; }
+    };
+
+    // Integers are divided lane by lane anyway and the masked tail would divide by zero
+    struct SMLElementwiseDiv
+    {
+      template<typename ET> constexpr static bool IsVectorizable_v = !std::is_integral<ET>::value;
+      template<typename T> QM_ALWAYS_INLINE T operator()(const T& a, const T& b) const { return a / b; }
+    };
+
+    // Edge length of the blocks of MLElementwiseKernel if operands are transposed (a block fits into the L1 cache)
+    constexpr std::size_t MLElementwiseBlockSize_v = 32;
+
+    // Operand of MLElementwiseKernel. Operands whose layout differs from the layout of the result are
+    // transposed block by block into a buffer (reading them along their own lines), the others are loaded
+    // directly. o and n are the line and the element within the line in the layout of the result.
+    template<typename MT, bool rowMajor>
+    class TMLElementwiseOperand
+    {
+    public:
+      using ElementType = TMLMatrixElementType_t<MT>;
+      using SIMDType = TMLMatrixSIMDType_t<MT>;
+
+      constexpr static std::size_t BlockSize_v = MLElementwiseBlockSize_v;
+      constexpr static bool Transpose_v = TMLMatrixIsRowMajor_v<MT> != rowMajor;
+
+      explicit TMLElementwiseOperand(const MT& mat) : m_mat(mat) {}
+
+      // Prepares the block [o0, o1) x [n0, n1)
+      QM_ALWAYS_INLINE void Block(std::size_t o0, std::size_t o1, std::size_t n0, std::size_t n1)
+      {
+        if (!Transpose_v)
+          return;
+        m_o0 = o0;
+        m_n0 = n0;
+        for (std::size_t n = n0; n < n1; n++)
+        {
+          const ElementType* src = m_mat.Data() + n * m_mat.Spacing();
+          for (std::size_t o = o0; o < o1; o++)
+            m_tile[(o - o0) * BlockSize_v + (n - n0)] = src[o];
+        }
+      }
+
+      QM_ALWAYS_INLINE SIMDType Load(std::size_t o, std::size_t n) const
+      {
+        if (Transpose_v)
+          return SIMDType::LoadUnaligned(Tile(o, n));
+        return rowMajor ? m_mat.Load(o, n) : m_mat.Load(n, o);
+      }
+
+      QM_ALWAYS_INLINE SIMDType LoadMasked(std::size_t o, std::size_t n, std::size_t cnt) const
+      {
+        if (Transpose_v)
+          return SIMDType::LoadMasked(Tile(o, n), cnt);
+        return rowMajor ? m_mat.LoadMasked(o, n, cnt) : m_mat.LoadMasked(n, o, cnt);
+      }
+
+    private:
+      QM_ALWAYS_INLINE const ElementType* Tile(std::size_t o, std::size_t n) const
+      {
+        return m_tile + (o - m_o0) * BlockSize_v + (n - m_n0);
+      }
+
+      const MT& m_mat;
+      std::size_t m_o0 = 0;
+      std::size_t m_n0 = 0;
+      ElementType m_tile[Transpose_v ? BlockSize_v * BlockSize_v : 1];
+    };
+
+    // Inner nodes of elementwise expression trees (see MLElementwiseOperand)
+    template<typename Op, typename X>
+    class TMLElementwiseUnaryNode
+    {
+    public:
+      using SIMDType = typename X::SIMDType;
+      constexpr static bool Transpose_v = X::Transpose_v;
+
+      TMLElementwiseUnaryNode(const Op& op, const X& x) : m_op(op), m_x(x) {}
+
+      QM_ALWAYS_INLINE void Block(std::size_t o0, std::size_t o1, std::size_t n0, std::size_t n1) { m_x.Block(o0, o1, n0, n1); }
+      QM_ALWAYS_INLINE SIMDType Load(std::size_t o, std::size_t n) const { return m_op(m_x.Load(o, n)); }
+      QM_ALWAYS_INLINE SIMDType LoadMasked(std::size_t o, std::size_t n, std::size_t cnt) const { return m_op(m_x.LoadMasked(o, n, cnt)); }
+
+    private:
+      Op m_op;
+      X m_x;
+    };
+
+    template<typename Op, typename X, typename Y>
+    class TMLElementwiseBinaryNode
+    {
+    public:
+      using SIMDType = typename X::SIMDType;
+      constexpr static bool Transpose_v = X::Transpose_v || Y::Transpose_v;
+
+      TMLElementwiseBinaryNode(const Op& op, const X& x, const Y& y) : m_op(op), m_x(x), m_y(y) {}
+
+      QM_ALWAYS_INLINE void Block(std::size_t o0, std::size_t o1, std::size_t n0, std::size_t n1) 
+      { 
+        m_x.Block(o0, o1, n0, n1); 
+        m_y.Block(o0, o1, n0, n1); 
+      }
+      QM_ALWAYS_INLINE SIMDType Load(std::size_t o, std::size_t n) const { return m_op(m_x.Load(o, n), m_y.Load(o, n)); }
+      QM_ALWAYS_INLINE SIMDType LoadMasked(std::size_t o, std::size_t n, std::size_t cnt) const 
+        { return m_op(m_x.LoadMasked(o, n, cnt), m_y.LoadMasked(o, n, cnt)); }
+
+    private:
+      Op m_op;
+      X m_x;
+      Y m_y;
+    };
+
+    template<typename Op, typename X>
+    TMLElementwiseUnaryNode<Op, X> MLElementwiseNode(const Op& op, const X& x) { return { op, x }; }
+    template<typename Op, typename X, typename Y>
+    TMLElementwiseBinaryNode<Op, X, Y> MLElementwiseNode(const Op& op, const X& x, const Y& y) { return { op, x, y }; }
+
+    // Can a matrix or an expression be evaluated by MLElementwiseKernel with the given SIMD type? Dense
+    // matrices with that SIMD type can, expressions that define IsFusable_v decide for themselves.
+    template<typename T, typename SIMD, typename=void>
+    struct TMLIsElementwiseFusable : std::false_type {};
+    template<typename MT, typename SIMD>
+    struct TMLIsElementwiseFusable<MT, SIMD, TMLEnableIf_t<TMLIsMatrix_v<MT>>> 
+      : TMLBooleanConstant<
+          TMLMatrixIsDense_v<MT> && 
+          TMLMatrixIsVectorized_v<MT> && 
+          std::is_same<TMLMatrixSIMDType_t<MT>, SIMD>::value> {};
+    template<typename ExT, typename SIMD>
+    struct TMLIsElementwiseFusable<ExT, SIMD, TMLEnableIf_t<TMLIsMatrixExpression_v<ExT> && ExT::template IsFusable_v<SIMD>>> 
+      : std::true_type {};
+
+    template<typename T, typename SIMD>
+    constexpr bool TMLIsElementwiseFusable_v = TMLIsElementwiseFusable<T, SIMD>::value;
+
+    // Does an elementwise expression assigned to res read elements of res at other positions than the ones
+    // it writes (e.g. a shifted view of res)? Operands that coincide with res are fine, since every element is
+    // read before it is written. Expressions that are not fused are evaluated into temporaries.
+    template<typename MT, typename OP>
+    TMLEnableIf_t<TMLIsMatrix_v<OP>, bool> MLIsElementwiseAlias(const MT& res, const OP& op) noexcept
+    {
+      return MLIsPartialOverlap(res, op);
+    }
+    template<typename MT, typename ExT>
+    TMLEnableIf_t<TMLIsMatrixExpression_v<ExT> && !TMLIsElementwiseFusable_v<ExT, TMLMatrixSIMDType_t<MT>>, bool>
+      MLIsElementwiseAlias(const MT& res, const ExT& expr) noexcept { return false; }
+    template<typename MT, typename ExT>
+    TMLEnableIf_t<TMLIsMatrixExpression_v<ExT> && TMLIsElementwiseFusable_v<ExT, TMLMatrixSIMDType_t<MT>>, bool>
+      MLIsElementwiseAlias(const MT& res, const ExT& expr) noexcept { return expr.IsElementwiseAlias(res); }
+
+    // Operand tree of a fusable matrix or expression for a result with the given layout
+    template<bool rowMajor, typename MT>
+    TMLEnableIf_t<TMLIsMatrix_v<MT>, TMLElementwiseOperand<MT, rowMajor>> MLElementwiseOperand(const MT& mat)
+    {
+      return TMLElementwiseOperand<MT, rowMajor>(mat);
+    }
+    template<bool rowMajor, typename ExT, typename=TMLEnableIf_t<TMLIsMatrixExpression_v<ExT>>>
+    auto MLElementwiseOperand(const ExT& expr)
+    {
+      return expr.template Operand<rowMajor>();
+    }
+
+    // c = operand with SIMD registers along the lines of c (the tails of the lines are loaded and stored
+    // masked). Every element of the operands is loaded once and c is written once, no matter how deep
+    // the operand tree is. If a matrix of the tree has the other layout, c is computed block by block.
+    template<typename C, typename Operand>
+    void MLElementwiseKernel(C& c, Operand& operand)
+    {
+      using SIMDType = TMLMatrixSIMDType_t<C>;
+      constexpr std::size_t simdSize = TMLSIMDSize_v<SIMDType>;
+      constexpr bool rowMajor = TMLMatrixIsRowMajor_v<C>;
+      constexpr bool blocked = Operand::Transpose_v;
+      constexpr std::size_t bs = MLElementwiseBlockSize_v;
+
+      const std::size_t lines = rowMajor ? c.Rows() : c.Cols();
+      const std::size_t length = rowMajor ? c.Cols() : c.Rows();
+      const std::size_t blockLines = blocked ? bs : std::max<std::size_t>(lines, 1);
+      const std::size_t blockLength = blocked ? bs : std::max<std::size_t>(length, 1);
+
+      for (std::size_t o0 = 0; o0 < lines; o0 += blockLines)
+      {
+        const std::size_t o1 = std::min(o0 + blockLines, lines);
+        for (std::size_t n0 = 0; n0 < length; n0 += blockLength)
+        {
+          const std::size_t n1 = std::min(n0 + blockLength, length);
+          operand.Block(o0, o1, n0, n1);
+
+          for (std::size_t o = o0; o < o1; o++)
+          {
+            std::size_t n = n0;
+            for (; (n + simdSize) <= n1; n += simdSize)
+            {
+              if (rowMajor)
+                c.Store(operand.Load(o, n), o, n);
+              else
+                c.Store(operand.Load(o, n), n, o);
+            }
+            if (n < n1)
+            {
+              const std::size_t cnt = n1 - n;
+              if (rowMajor)
+                c.StoreMasked(operand.LoadMasked(o, n, cnt), o, n, cnt);
+              else
+                c.StoreMasked(operand.LoadMasked(o, n, cnt), n, o, cnt);
+            }
+          }
+        }
+      }
+    }
+
+    // c = op(a, b) for dense matrices
+    template<typename C, typename Op, typename A, typename B>
+    void MLElementwiseKernel(C& c, const Op& op, const A& a, const B& b)
+    {
+      auto operand = MLElementwiseNode(op, 
+        MLElementwiseOperand<TMLMatrixIsRowMajor_v<C>>(a), 
+        MLElementwiseOperand<TMLMatrixIsRowMajor_v<C>>(b));
+      MLElementwiseKernel(c, operand);
+    }
+  }
+
+  // Elementwise binary expression (subtraction, Hadamard product and division, see the aliases below)
+  template<typename M1, typename M2, typename OP>
+  class TMLDMDMElementwiseExpression : public TMLMatrixExpression<TMLDMDMElementwiseExpression<M1, M2, OP>>
+  {
+    template<typename ML, typename MR, typename>
+    friend auto operator-(const ML& lhs, const MR& rhs);
+    template<typename ML, typename MR, typename>
+    friend auto operator%(const ML& lhs, const MR& rhs);
+    template<typename ML, typename MR, typename>
+    friend auto operator/(const ML& lhs, const MR& rhs);
+
+  public:
+    using MyT = TMLDMDMElementwiseExpression<M1, M2, OP>;
+    using LOpType = TMLDecayCRTP_t<M1>;
+    using ROpType = TMLDecayCRTP_t<M2>;
+    using LOpResType = TMLMatrixExpressionResultType_t<LOpType>;
+    using LOpTmpType = TMLMatrixExpressionTemporary_t<LOpType>;
+    using ROpResType = TMLMatrixExpressionResultType_t<ROpType>;
+    using ROpTmpType = TMLMatrixExpressionTemporary_t<ROpType>;
+    // All operations give a matrix of the shape of the difference
+    using ResultType = TMLMatrixSubResult_t<LOpResType, ROpResType>;
+    using OperationType = OP;
+
+    using ElementType = TMLMatrixCommonElementType_t<LOpResType, ROpResType>;
+    using SIMDType = std::conditional_t<
+      TMLMatrixIsSameSIMDType_v<LOpResType, ROpResType>,
+      TMLMatrixSIMDType_t<LOpResType>, ElementType>;
+
+    explicit TMLDMDMElementwiseExpression(const M1& lhs, const M2& rhs)
+    : m_lhs(~lhs), m_rhs(~rhs) { assert((~lhs).Rows() == (~rhs).Rows() && (~lhs).Cols() == (~rhs).Cols()); }
+
+  private:
+    // Make copy/move private in order to prevent direct assignment of an expression
+    TMLDMDMElementwiseExpression(const MyT&) = default;
+    TMLDMDMElementwiseExpression(MyT&&) noexcept = default;
+    MyT& operator=(const MyT&) = default;
+    MyT& operator=(MyT&&) noexcept = default;
+  public:
+
+    constexpr std::size_t Rows() const noexcept { return (~m_lhs).Rows(); }
+    constexpr std::size_t Cols() const noexcept { return (~m_rhs).Cols(); }
+
+    ElementType operator()(std::size_t i, std::size_t j) const noexcept;
+
+    template<typename MT, typename=LOpResType>
+    void AssignTo(TMLDenseMatrix<MT>& res) const;
+
+    // Operand tree of the expression for Internal::MLElementwiseKernel
+    template<bool rowMajor>
+    auto Operand() const 
+    { 
+      return Internal::MLElementwiseNode(OperationType(), 
+        Internal::MLElementwiseOperand<rowMajor>(m_lhs), Internal::MLElementwiseOperand<rowMajor>(m_rhs)); 
+    }
+
+    // Is an operand a matrix that overlaps res at other positions (see Internal::MLIsElementwiseAlias)?
+    template<typename MT>
+    bool IsElementwiseAlias(const MT& res) const noexcept
+    {
+      return Internal::MLIsElementwiseAlias(res, m_lhs) || Internal::MLIsElementwiseAlias(res, m_rhs);
+    }
+
+  public:
+    template<typename SIMD>
+    constexpr static bool IsFusable_v =
+      Internal::TMLIsElementwiseFusable_v<LOpType, SIMD> &&
+      Internal::TMLIsElementwiseFusable_v<ROpType, SIMD> &&
+      OperationType::template IsVectorizable_v<ElementType>;
+
+    // Nested elementwise expressions are evaluated in one pass without temporaries
+    template<typename MT>
+    constexpr static bool IsFused_v =
+      (TMLIsMatrixExpression_v<LOpType> || TMLIsMatrixExpression_v<ROpType>) &&
+      TMLMatrixIsVectorized_v<MT> &&
+      IsFusable_v<TMLMatrixSIMDType_t<MT>>;
+
+    // Differences of a product and a matrix (e.g. r = b - a * x) accumulate the product into the result
+    template<typename MT>
+    constexpr static bool IsGemmUpdate_v = 
+      std::is_same<OperationType, Internal::SMLElementwiseSub>::value &&
+      Internal::TMLIsGemmUpdate_v<MT, LOpType, ROpType>;
+
+    // Returns false if the difference is not computed by a GEMM
+    template<typename MT> TMLEnableIf_t<!IsGemmUpdate_v<MT>, bool> 
+      ExecuteGemmUpdate(TMLDenseMatrix<MT>& res) const { return false; }
+    template<typename MT> TMLEnableIf_t<IsGemmUpdate_v<MT>, bool> 
+      ExecuteGemmUpdate(TMLDenseMatrix<MT>& res) const { return Internal::MLGemmUpdate(res, m_lhs, m_rhs, ElementType(-1)); }
+
+    template<typename C, typename A, typename B>
+    constexpr static bool IsVectorizable_v =
+      TMLMatrixIsDense_v<C> &&
+      TMLMatrixIsDense_v<A> &&
+      TMLMatrixIsDense_v<B> &&
+      TMLMatrixIsVectorized_v<C> &&
+      TMLMatrixIsVectorized_v<A> &&
+      TMLMatrixIsVectorized_v<B> &&
+      TMLMatrixIsSameSIMDType_v<C, A, B> &&
+      OperationType::template IsVectorizable_v<TMLMatrixElementType_t<C>>;
+
+    // Evaluates the operands that are expressions first (not fused) or computes everything in one pass (fused)
+    template<typename MT> TMLEnableIf_t<!IsFused_v<MT>, void> Evaluate(TMLDenseMatrix<MT>& res) const 
+      { const LOpTmpType& lhs(m_lhs); const ROpTmpType& rhs(m_rhs); ExecuteKernel(res, lhs, rhs); }
+    template<typename MT> TMLEnableIf_t<IsFused_v<MT>, void> Evaluate(TMLDenseMatrix<MT>& res) const { FusedKernel(res); }
+
+    // Selects the right kernel
+    template<typename C, typename A, typename B> TMLEnableIf_t<!IsVectorizable_v<C, A, B>, void>
+      ExecuteKernel(TMLDenseMatrix<C>& c, const TMLDenseMatrix<A>& a, const TMLDenseMatrix<B>& b) const { DefaultKernel(c, a, b); }
+    template<typename C, typename A, typename B> TMLEnableIf_t<IsVectorizable_v<C, A, B>, void>
+      ExecuteKernel(TMLDenseMatrix<C>& c, const TMLDenseMatrix<A>& a, const TMLDenseMatrix<B>& b) const { VectorizedKernel(c, a, b); }
+
+    template<typename C, typename A, typename B>
+    static void DefaultKernel(TMLDenseMatrix<C>& c, const TMLDenseMatrix<A>& a, const TMLDenseMatrix<B>& b);
+    template<typename C, typename A, typename B, typename=TMLEnableIf_t<IsVectorizable_v<C, A, B>>>
+    static void VectorizedKernel(TMLDenseMatrix<C>& c, const TMLDenseMatrix<A>& a, const TMLDenseMatrix<B>& b);
+    template<typename MT, typename=TMLEnableIf_t<IsFused_v<MT>>>
+    void FusedKernel(TMLDenseMatrix<MT>& res) const;
+
+    const LOpType& m_lhs;
+    const ROpType& m_rhs;
+  };
+
+  template<typename M1, typename M2>
+  using TMLDMDMSubExpression = TMLDMDMElementwiseExpression<M1, M2, Internal::SMLElementwiseSub>;
+  template<typename M1, typename M2>
+  using TMLDMDMHadamardExpression = TMLDMDMElementwiseExpression<M1, M2, Internal::SMLElementwiseMul>;
+  template<typename M1, typename M2>
+  using TMLDMDMDivExpression = TMLDMDMElementwiseExpression<M1, M2, Internal::SMLElementwiseDiv>;
+
+  template<typename ML, typename MR, typename=TMLEnableIf_t<TMLBooleanAnd_v<
+    TMLMatrixIsDense_v<TMLMatrixExpressionResultType_t<ML>>,
+    TMLMatrixIsDense_v<TMLMatrixExpressionResultType_t<MR>>
+  >>>
+  auto operator-(const ML& lhs, const MR& rhs)
+  {
+    return TMLDMDMSubExpression<ML, MR>(lhs, rhs);
+  }
+
+  // Hadamard (elementwise) product
+  template<typename ML, typename MR, typename=TMLEnableIf_t<TMLBooleanAnd_v<
+    TMLMatrixIsDense_v<TMLMatrixExpressionResultType_t<ML>>,
+    TMLMatrixIsDense_v<TMLMatrixExpressionResultType_t<MR>>
+  >>>
+  auto operator%(const ML& lhs, const MR& rhs)
+  {
+    return TMLDMDMHadamardExpression<ML, MR>(lhs, rhs);
+  }
+
+  // Elementwise division
+  template<typename ML, typename MR, typename=TMLEnableIf_t<TMLBooleanAnd_v<
+    TMLMatrixIsDense_v<TMLMatrixExpressionResultType_t<ML>>,
+    TMLMatrixIsDense_v<TMLMatrixExpressionResultType_t<MR>>
+  >>>
+  auto operator/(const ML& lhs, const MR& rhs)
+  {
+    return TMLDMDMDivExpression<ML, MR>(lhs, rhs);
+  }
+
+  template<typename M1, typename M2, typename OP> typename TMLDMDMElementwiseExpression<M1, M2, OP>::ElementType
+    TMLDMDMElementwiseExpression<M1, M2, OP>::operator()(std::size_t i, std::size_t j) const noexcept
+  {
+    assert(i < Rows());
+    assert(j < Cols());
+
+    return OperationType()(static_cast<ElementType>((~m_lhs)(i, j)), static_cast<ElementType>((~m_rhs)(i, j)));
+  }
+
+  template<typename M1, typename M2, typename OP>
+  template<typename MT, typename>
+  void TMLDMDMElementwiseExpression<M1, M2, OP>::AssignTo(TMLDenseMatrix<MT>& res) const
+  {
+    assert((~res).Rows() == (~m_lhs).Rows());
+    assert((~res).Cols() == (~m_rhs).Cols());
+
+    if (ExecuteGemmUpdate(res))
+      return;
+
+    // every element of the result only depends on the same elements of the operands (in-place is fine),
+    // operands that overlap the result at other positions are read before the result is written
+    if (IsElementwiseAlias(~res))
+    {
+      const TMLMatrixScratchResult_t<ResultType> tmp(*this);
+      (~res).Assign(tmp);
+    }
+    else
+    {
+      Evaluate(res);
+    }
+  }
+
+  template<typename M1, typename M2, typename OP>
+  template<typename MT, typename>
+  void TMLDMDMElementwiseExpression<M1, M2, OP>::FusedKernel(TMLDenseMatrix<MT>& res) const
+  {
+    auto operand = Operand<TMLMatrixIsRowMajor_v<MT>>();
+    Internal::MLElementwiseKernel(~res, operand);
+  }
+
+  template<typename M1, typename M2, typename OP>
+  template<typename C, typename A, typename B>
+  void TMLDMDMElementwiseExpression<M1, M2, OP>::DefaultKernel(
+    TMLDenseMatrix<C>& c, const TMLDenseMatrix<A>& a, const TMLDenseMatrix<B>& b)
+  {
+    const OperationType op;
+    for (size_t i = 0; i < (~c).Rows(); i++)
+    {
+      for (size_t j = 0; j < (~c).Cols(); j++)
+      {
+        (~c)(i, j) = op(static_cast<ElementType>((~a)(i, j)), static_cast<ElementType>((~b)(i, j)));
+      }
+    }
+  }
+
+  template<typename M1, typename M2, typename OP>
+  template<typename C, typename A, typename B, typename>
+  void TMLDMDMElementwiseExpression<M1, M2, OP>::VectorizedKernel(
+    TMLDenseMatrix<C>& c, const TMLDenseMatrix<A>& a, const TMLDenseMatrix<B>& b)
+  {
+    Internal::MLElementwiseKernel(~c, OperationType(), ~a, ~b);
+  }
+
+}
+
+#endif
@@ -5,16 +5,225 @@
 
 // Includes
 #include <type_traits>
+#include <utility>
+#include <algorithm>
+#include <vector>
+#include <limits>
 #include <cassert>
 
 #include "MatrixExpression.h"
 #include "../Matrix.h"
 
+#include "../Kernels/GemmEpilogue.h"
+#include "../Kernels/GemmKernel.h"
+#include "../Kernels/GemvKernel.h"
+#include "../Kernels/StrassenKernel.h"
+#if defined(ML_MATH_RUNTIME_DISPATCH)
+#include "../Kernels/Dispatch.h"
+#endif
+
+#include "../../Parallel/ThreadPool.h"
 #include "../../QTL/EnableIf.h"
 
 namespace ML
 {
 
+  namespace Internal
+  {
+    template<typename MT>
+    auto MLMakeGemmView(MT& mat) noexcept
+    {
+      using ViewType = TMLGemmView<std::remove_pointer_t<decltype(mat.Data())>>;
+      if (TMLMatrixIsRowMajor_v<MT>)
+        return ViewType{ mat.Data(), mat.Rows(), mat.Cols(), mat.Spacing(), 1 };
+      else
+        return ViewType{ mat.Data(), mat.Rows(), mat.Cols(), 1, mat.Spacing() };
+    }
+
+    // Do the elements of two raw views share memory? The lines of a view are its rows if the elements of 
+    // a row are adjacent, otherwise its columns.
+    template<typename ET1, typename ET2>
+    bool MLIsOverlapping(const TMLGemmView<ET1>& a, const TMLGemmView<ET2>& b) noexcept
+    {
+      return MLIsOverlapping(
+        a.data, a.cs == 1 ? a.rows : a.cols, a.cs == 1 ? a.cols : a.rows, a.cs == 1 ? a.rs : a.cs,
+        b.data, b.cs == 1 ? b.rows : b.cols, b.cs == 1 ? b.cols : b.rows, b.cs == 1 ? b.rs : b.cs);
+    }
+
+    // Blocked, unblocked and matrix-vector kernels for the SIMD type of the operands
+    template<typename ET, typename SIMD, typename=void>
+    struct TMLGemmBlockedKernel
+    {
+      using KernelType = TMLGemmKernel<ET, SIMD>;
+      using GemvKernelType = TMLGemvKernel<ET, SIMD>;
+
+      static std::size_t TileRows() { return KernelType::TileRows(); }
+      static std::size_t TileCols() { return KernelType::TileCols(); }
+
+      static SMLGemmTuning GetTuning() { return KernelType::GetTuning(); }
+      static void SetTuning(const SMLGemmTuning& tuning) { KernelType::SetTuning(tuning); }
+      static SMLGemmTuning Tune(double budget, bool store) { return KernelType::Tune(budget, store); }
+
+      static void Compute(const TMLGemmView<ET>& c, const TMLGemmView<const ET>& a, const TMLGemmView<const ET>& b,
+        std::size_t i0, std::size_t i1, std::size_t j0, std::size_t j1, const TMLGemmEpilogue<ET>& epilogue) 
+      { 
+        KernelType::Blocked(c, a, b, i0, i1, j0, j1, epilogue); 
+      }
+      static void ComputeUnblocked(const TMLGemmView<ET>& c, const TMLGemmView<const ET>& a, const TMLGemmView<const ET>& b,
+        const TMLGemmEpilogue<ET>& epilogue) 
+      { 
+        KernelType::Unblocked(c, a, b, epilogue); 
+      }
+      static void Gemv(const TMLGemmView<const ET>& a, const ET* x, std::size_t incx, ET* y, std::size_t incy, ET alpha, ET beta)
+      {
+        GemvKernelType::Gemv(a, x, incx, y, incy, alpha, beta);
+      }
+      static void Ger(const TMLGemmView<ET>& a, const ET* x, std::size_t incx, const ET* y, std::size_t incy, ET alpha, ET beta)
+      {
+        GemvKernelType::Ger(a, x, incx, y, incy, alpha, beta);
+      }
+    };
+
+#if defined(ML_MATH_RUNTIME_DISPATCH)
+    // Blocked, unblocked and matrix-vector kernels of the instruction set that is selected at runtime
+    template<typename ET, typename SIMD>
+    struct TMLGemmBlockedKernel<ET, SIMD, TMLEnableIf_t<TMLHasKernelTable_v<ET>>>
+    {
+      static std::size_t TileRows() { return MLGetKernelTable<ET>().gemmMR(); }
+      static std::size_t TileCols() { return MLGetKernelTable<ET>().gemmNR(); }
+
+      static SMLGemmTuning GetTuning() { return MLGetKernelTable<ET>().gemmTuning(); }
+      static void SetTuning(const SMLGemmTuning& tuning) { MLGetKernelTable<ET>().setGemmTuning(tuning); }
+      static SMLGemmTuning Tune(double budget, bool store) { return MLGetKernelTable<ET>().tuneGemm(budget, store); }
+
+      static void Compute(const TMLGemmView<ET>& c, const TMLGemmView<const ET>& a, const TMLGemmView<const ET>& b,
+        std::size_t i0, std::size_t i1, std::size_t j0, std::size_t j1, const TMLGemmEpilogue<ET>& epilogue)
+      {
+        MLGetKernelTable<ET>().gemm({ c.data, c.rows, c.cols, c.rs, c.cs }, { a.data, a.rows, a.cols, a.rs, a.cs },
+          { b.data, b.rows, b.cols, b.rs, b.cs }, i0, i1, j0, j1, epilogue);
+      }
+      static void ComputeUnblocked(const TMLGemmView<ET>& c, const TMLGemmView<const ET>& a, const TMLGemmView<const ET>& b,
+        const TMLGemmEpilogue<ET>& epilogue)
+      {
+        MLGetKernelTable<ET>().gemmUnblocked({ c.data, c.rows, c.cols, c.rs, c.cs }, { a.data, a.rows, a.cols, a.rs, a.cs },
+          { b.data, b.rows, b.cols, b.rs, b.cs }, epilogue);
+      }
+      static void Gemv(const TMLGemmView<const ET>& a, const ET* x, std::size_t incx, ET* y, std::size_t incy, ET alpha, ET beta)
+      {
+        MLGetKernelTable<ET>().gemv({ a.data, a.rows, a.cols, a.rs, a.cs }, x, incx, y, incy, alpha, beta);
+      }
+      static void Ger(const TMLGemmView<ET>& a, const ET* x, std::size_t incx, const ET* y, std::size_t incy, ET alpha, ET beta)
+      {
+        MLGetKernelTable<ET>().ger({ a.data, a.rows, a.cols, a.rs, a.cs }, x, incx, y, incy, alpha, beta);
+      }
+    };
+#endif
+
+    // Distance between consecutive elements of a dense matrix with one row or one column
+    template<typename MT>
+    std::size_t MLVectorIncrement(const MT& vec) noexcept
+    {
+      assert(vec.Rows() == 1 || vec.Cols() == 1);
+      const bool alongRow = vec.Rows() == 1 && vec.Cols() != 1;
+      return alongRow == TMLMatrixIsRowMajor_v<MT> ? 1 : vec.Spacing();
+    }
+  }
+
+  // Autotuning of the matrix multiplication of dynamic matrices with elements of type ET (see 
+  // Kernels/GemmTuning.h). MLTuneGemm benchmarks the candidate register tiles and block sizes on this 
+  // machine (budget: seconds per measurement), applies the fastest parameters and writes them to the 
+  // tuning file, from which they are read by later runs. The parameters must not be changed while a 
+  // product of the element type is computed.
+  template<typename ET>
+  SMLGemmTuning MLGetGemmTuning() { return Internal::TMLGemmBlockedKernel<ET, TMLSIMDTypeSelector_t<ET, 0xFFFFFFFF>>::GetTuning(); }
+  template<typename ET>
+  void MLSetGemmTuning(const SMLGemmTuning& tuning) { Internal::TMLGemmBlockedKernel<ET, TMLSIMDTypeSelector_t<ET, 0xFFFFFFFF>>::SetTuning(tuning); }
+  template<typename ET>
+  SMLGemmTuning MLTuneGemm(double budget = 0.02, bool store = true) 
+  { 
+    return Internal::TMLGemmBlockedKernel<ET, TMLSIMDTypeSelector_t<ET, 0xFFFFFFFF>>::Tune(budget, store); 
+  }
+
+  // Matrix-vector product y = alpha * A * x + beta * y. x and y are dense matrices with one column or one row, 
+  // A is any dense matrix of the same element type (y must not overlap with A or x). beta == 0 does not read y.
+  template<typename Y, typename A, typename X, typename ET = TMLMatrixElementType_t<Y>>
+  void MLGemv(TMLDenseMatrix<Y>& y, const TMLDenseMatrix<A>& a, const TMLDenseMatrix<X>& x, 
+    ET alpha = ET(1), ET beta = ET(0))
+  {
+    static_assert(TMLMatrixIsSameElementType_v<Y, A, X>, "The operands of MLGemv must have the same element type");
+    assert((~x).Rows() == 1 || (~x).Cols() == 1);
+    assert((~y).Rows() == 1 || (~y).Cols() == 1);
+    assert((~x).Rows() * (~x).Cols() == (~a).Cols());
+    assert((~y).Rows() * (~y).Cols() == (~a).Rows());
+
+    if ((~a).Rows() == 0)
+      return;
+    Internal::TMLGemmBlockedKernel<ET, TMLSIMDTypeSelector_t<ET, 0xFFFFFFFF>>::Gemv(Internal::MLMakeGemmView(~a), 
+      (~x).Data(), Internal::MLVectorIncrement(~x), (~y).Data(), Internal::MLVectorIncrement(~y), alpha, beta);
+  }
+
+  // Rank-1 update A = alpha * x * y^T + beta * A (GER for beta == 1). x has A.Rows() elements, y has A.Cols() 
+  // elements, both are dense matrices with one column or one row. beta == 0 does not read A.
+  template<typename A, typename X, typename Y, typename ET = TMLMatrixElementType_t<A>>
+  void MLGer(TMLDenseMatrix<A>& a, const TMLDenseMatrix<X>& x, const TMLDenseMatrix<Y>& y, 
+    ET alpha = ET(1), ET beta = ET(1))
+  {
+    static_assert(TMLMatrixIsSameElementType_v<A, X, Y>, "The operands of MLGer must have the same element type");
+    assert((~x).Rows() == 1 || (~x).Cols() == 1);
+    assert((~y).Rows() == 1 || (~y).Cols() == 1);
+    assert((~x).Rows() * (~x).Cols() == (~a).Rows());
+    assert((~y).Rows() * (~y).Cols() == (~a).Cols());
+
+    if ((~a).Rows() == 0 || (~a).Cols() == 0)
+      return;
+    Internal::TMLGemmBlockedKernel<ET, TMLSIMDTypeSelector_t<ET, 0xFFFFFFFF>>::Ger(Internal::MLMakeGemmView(~a), 
+      (~x).Data(), Internal::MLVectorIncrement(~x), (~y).Data(), Internal::MLVectorIncrement(~y), alpha, beta);
+  }
+
+  template<typename M1, typename M2>
+  class TMLDMDMMulExpression;
+
+  namespace Internal
+  {
+    // Number of factors of a product chain, e.g. 3 for a * b * c (nested products are the inner nodes)
+    template<typename T>
+    struct TMLMulChainLength : TMLConstant<std::size_t, 1> {};
+    template<typename M1, typename M2>
+    struct TMLMulChainLength<TMLDMDMMulExpression<M1, M2>> 
+      : TMLConstant<std::size_t, TMLMulChainLength<TMLDecayCRTP_t<M1>>::value + TMLMulChainLength<TMLDecayCRTP_t<M2>>::value> {};
+
+    // Are all factors of a product chain dense matrices with the given SIMD type?
+    template<typename T, typename SIMD, typename=void>
+    struct TMLMulChainIsVectorized : std::false_type {};
+    template<typename MT, typename SIMD>
+    struct TMLMulChainIsVectorized<MT, SIMD, TMLEnableIf_t<TMLIsMatrix_v<MT>>>
+      : TMLBooleanConstant<
+          TMLMatrixIsDense_v<MT> &&
+          TMLMatrixIsVectorized_v<MT> &&
+          std::is_same<TMLMatrixSIMDType_t<MT>, SIMD>::value> {};
+    template<typename M1, typename M2, typename SIMD>
+    struct TMLMulChainIsVectorized<TMLDMDMMulExpression<M1, M2>, SIMD, void>
+      : TMLBooleanConstant<
+          TMLMulChainIsVectorized<TMLDecayCRTP_t<M1>, SIMD>::value &&
+          TMLMulChainIsVectorized<TMLDecayCRTP_t<M2>, SIMD>::value> {};
+
+    // Collects the factors of a product chain from left to right. Fails if an inner product has 
+    // modifiers (epilogue, Strassen) that only apply to that product.
+    template<typename MT, typename ET>
+    TMLEnableIf_t<TMLIsMatrix_v<MT>, bool> MLMulChainCollect(const MT& mat, TMLGemmView<const ET>* factors, std::size_t& count)
+    {
+      factors[count++] = MLMakeGemmView(mat);
+      return true;
+    }
+    template<typename M1, typename M2, typename ET>
+    bool MLMulChainCollect(const TMLDMDMMulExpression<M1, M2>& expr, TMLGemmView<const ET>* factors, std::size_t& count)
+    {
+      if (!expr.IsPlain())
+        return false;
+      return MLMulChainCollect(expr.m_lhs, factors, count) && MLMulChainCollect(expr.m_rhs, factors, count);
+    }
+  }
+
   template<typename M1, typename M2>
   class TMLDMDMMulExpression : public TMLMatrixExpression<TMLDMDMMulExpression<M1, M2>>
   {
@@ -26,16 +235,24 @@ namespace ML
     using LOpType = TMLDecayCRTP_t<M1>;
     using ROpType = TMLDecayCRTP_t<M2>;
     using LOpResType = TMLMatrixExpressionResultType_t<LOpType>;
+    using LOpTmpType = TMLMatrixExpressionTemporary_t<LOpType>;
     using ROpResType = TMLMatrixExpressionResultType_t<ROpType>;
+    using ROpTmpType = TMLMatrixExpressionTemporary_t<ROpType>;
     using ResultType = TMLMatrixMulResult_t<LOpResType, ROpResType>;
 
     using ElementType = TMLMatrixCommonElementType_t<LOpResType, ROpResType>;
     using SIMDType = std::conditional_t<
       TMLMatrixIsSameSIMDType_v<LOpResType, ROpResType>,
       TMLMatrixSIMDType_t<LOpResType>, ElementType>;
+    using EpilogueType = TMLGemmEpilogue<ElementType>;
+
+    using StrassenWorkspaceType = TMLStrassenWorkspace<ElementType>;
 
     explicit TMLDMDMMulExpression(const M1& lhs, const M2& rhs) 
-    : m_lhs(~lhs), m_rhs(~rhs) { assert((~lhs).Cols() == (~rhs).Rows()); }
+    : m_lhs(~lhs), m_rhs(~rhs), m_threads(0), m_strassenCutoff(0), m_workspace(nullptr) 
+    { 
+      assert((~lhs).Cols() == (~rhs).Rows()); 
+    }
 
   private:
     // Make copy/move private in order to prevent direct assignment of an expression
@@ -52,9 +269,80 @@ namespace ML
 
     ElementType operator()(std::size_t i, std::size_t j) const noexcept;
 
+    // Limits the number of threads used to evaluate this product 
+    // e.g. c = (a * b).Threads(4) (0: all threads of the global thread pool)
+    MyT Threads(std::size_t threads) const { MyT expr(*this); expr.m_threads = threads; return expr; }
+
+    // Epilogue that is applied to the tiles of the product while they are computed (see Kernels/GemmEpilogue.h)
+    // e.g. c = (a * b).Scale(2, 1).ColBias(bias).Activation(EMLActivation::ReLU) computes c = max(2*a*b + c + bias, 0).
+    // beta != 0 reads the previous values of the assigned matrix (or the source of the epilogue). The bias vectors 
+    // and the source must outlive the expression.
+    MyT Epilogue(const EpilogueType& epilogue) const { MyT expr(*this); expr.m_epilogue = epilogue; return expr; }
+    MyT Scale(ElementType alpha, ElementType beta = ElementType(0)) const 
+    { 
+      MyT expr(*this); 
+      expr.m_epilogue.alpha = alpha; 
+      expr.m_epilogue.beta = beta; 
+      return expr; 
+    }
+    MyT RowBias(const ElementType* bias) const { MyT expr(*this); expr.m_epilogue.rowBias = bias; return expr; }
+    MyT ColBias(const ElementType* bias) const { MyT expr(*this); expr.m_epilogue.colBias = bias; return expr; }
+    MyT Activation(EMLActivation activation, ElementType lo = ElementType(0), ElementType hi = ElementType(0)) const 
+    { 
+      MyT expr(*this); 
+      expr.m_epilogue.activation = activation; 
+      expr.m_epilogue.lo = lo; 
+      expr.m_epilogue.hi = hi; 
+      return expr; 
+    }
+
+    // Computes the product with the Strassen-Winograd recursion down to products whose dimensions are below
+    // the cutoff, e.g. c = (a * b).Strassen(512, &workspace). The temporaries are taken from the workspace, 
+    // which also reports the error bound of the product (see Kernels/StrassenKernel.h). Without a workspace
+    // they come from the scratch arena of the thread. The recursion is only used for vectorized operands and products 
+    // without epilogue, it trades accuracy for speed (the error bound grows by about 18 / 4 per level).
+    MyT Strassen(std::size_t cutoff = StrassenCutoff_v, StrassenWorkspaceType* workspace = nullptr) const 
+    { 
+      MyT expr(*this); 
+      expr.m_strassenCutoff = cutoff; 
+      expr.m_workspace = workspace; 
+      return expr; 
+    }
+
     template<typename MT, typename=LOpResType>
     void AssignTo(TMLDenseMatrix<MT>& res) const;
 
+    // Product without modifiers that only apply to this product
+    bool IsPlain() const noexcept 
+    { 
+      return m_epilogue.alpha == ElementType(1) && m_epilogue.beta == ElementType(0) && !m_epilogue.rowBias && 
+        !m_epilogue.colBias && m_epilogue.activation == EMLActivation::None && m_strassenCutoff == 0;
+    }
+
+    // res = factor * (this product) + beta * src with one GEMM (see GemmUpdate.h), src is res itself or a matrix
+    // with the layout of res. The product may be scaled and biased itself, but only an unscaled bias and no 
+    // activation commute with the accumulation.
+    bool IsAccumulable(ElementType factor) const noexcept
+    {
+      return m_epilogue.beta == ElementType(0) && m_epilogue.activation == EMLActivation::None && 
+        (factor == ElementType(1) || (!m_epilogue.rowBias && !m_epilogue.colBias));
+    }
+    template<typename MT, typename ST>
+    void AccumulateTo(TMLDenseMatrix<MT>& res, ElementType factor, ElementType beta, const TMLDenseMatrix<ST>& src) const
+    {
+      static_assert(TMLMatrixIsRowMajor_v<MT> == TMLMatrixIsRowMajor_v<ST>, "The source needs the layout of the result");
+      assert(IsAccumulable(factor));
+      MyT expr(*this);
+      expr.m_epilogue.alpha = factor * m_epilogue.alpha;
+      expr.m_epilogue.beta = beta;
+      if (!(~res).IsAlias(~src))
+      {
+        expr.m_epilogue.source = (~src).Data();
+        expr.m_epilogue.sourceStride = (~src).Spacing();
+      }
+      expr.AssignTo(res);
+    }
+
   public:
     template<typename C, typename A, typename B>
     constexpr static bool IsVectorizable_v = 
@@ -66,24 +354,101 @@ namespace ML
       TMLMatrixIsVectorized_v<B> &&
       TMLMatrixIsSameSIMDType_v<C, A, B>;
 
+    // Products of three or more matrices (e.g. a * b * c * d) are evaluated in the order that needs the 
+    // fewest multiply-adds instead of from left to right
+    constexpr static std::size_t ChainLength_v = Internal::TMLMulChainLength<MyT>::value;
+
+    template<typename MT>
+    constexpr static bool IsChain_v = 
+      ChainLength_v >= 3 &&
+      TMLMatrixIsDense_v<MT> &&
+      TMLMatrixIsVectorized_v<MT> &&
+      Internal::TMLMulChainIsVectorized<MyT, TMLMatrixSIMDType_t<MT>>::value;
+
+    // Returns false if the product is not evaluated as a chain
+    template<typename MT> TMLEnableIf_t<!IsChain_v<MT>, bool> 
+      ExecuteChain(TMLDenseMatrix<MT>& res) const { return false; }
+    template<typename MT> TMLEnableIf_t<IsChain_v<MT>, bool> 
+      ExecuteChain(TMLDenseMatrix<MT>& res) const { return ChainKernel(res); }
+
     // Selects the right kernel
     template<typename C, typename A, typename B> TMLEnableIf_t<!IsVectorizable_v<C, A, B>, void> 
-      ExecuteKernel(TMLDenseMatrix<C>& c, const TMLDenseMatrix<A>& a, const TMLDenseMatrix<B>& b) const { DefaultKernel(c, a, b); }
+      ExecuteKernel(TMLDenseMatrix<C>& c, const TMLDenseMatrix<A>& a, const TMLDenseMatrix<B>& b) const 
+    { 
+      DefaultKernel(c, a, b, m_epilogue); 
+    }
     template<typename C, typename A, typename B> TMLEnableIf_t<IsVectorizable_v<C, A, B>, void>
-      ExecuteKernel(TMLDenseMatrix<C>& c, const TMLDenseMatrix<A>& a, const TMLDenseMatrix<B>& b) const { VectorizedKernel(c, a, b); }
+      ExecuteKernel(TMLDenseMatrix<C>& c, const TMLDenseMatrix<A>& a, const TMLDenseMatrix<B>& b) const 
+    { 
+      VectorizedKernel(c, a, b, m_threads, m_epilogue, m_strassenCutoff, m_workspace); 
+    }
+
+    // SIMD width of the kernels (1 if the operands are not vectorized)
+    constexpr static std::size_t SIMDSize_v = TMLSIMDSize_v<std::conditional_t<
+      TMLIsSIMD_v<SIMDType>, SIMDType, TMLSIMDDefault<ElementType>>>;
+
+    // Kernels on raw views (dispatched at runtime if enabled)
+    using BlockedGemmKernel = Internal::TMLGemmBlockedKernel<ElementType, SIMDType>;
+
+    // Products with more than this number of multiply-adds use the blocked kernel
+    constexpr static std::size_t BlockedKernelThreshold_v = 64 * 64 * 64;
+    // Minimum number of multiply-adds per thread of the parallel blocked kernel
+    constexpr static std::size_t ParallelWorkPerThread_v = 128 * 128 * 128;
+    // Default cutoff of the Strassen-Winograd recursion
+    constexpr static std::size_t StrassenCutoff_v = 512;
 
     // Multplication kernels
     template<typename C, typename A, typename B> 
-    static void DefaultKernel(TMLDenseMatrix<C>& c, const TMLDenseMatrix<A>& a, const TMLDenseMatrix<B>& b);
+    static void DefaultKernel(TMLDenseMatrix<C>& c, const TMLDenseMatrix<A>& a, const TMLDenseMatrix<B>& b, 
+      const EpilogueType& epilogue);
     template<typename C, typename A, typename B, typename=TMLEnableIf_t<IsVectorizable_v<C, A, B>>>
-    static void VectorizedKernel(TMLDenseMatrix<C>& c, const TMLDenseMatrix<A>& a, const TMLDenseMatrix<B>& b);
-    
-    template<std::size_t regsA, std::size_t regsB, typename C, typename A, typename B, typename=TMLEnableIf_t<IsVectorizable_v<C, A, B>>>
-    QM_ALWAYS_INLINE static void VectorizedSubKernelRRR(
-      TMLDenseMatrix<C>& c, const TMLDenseMatrix<A>& a, const TMLDenseMatrix<B>& b, std::size_t ro, std::size_t co);
+    static void VectorizedKernel(TMLDenseMatrix<C>& c, const TMLDenseMatrix<A>& a, const TMLDenseMatrix<B>& b, 
+      std::size_t threads, const EpilogueType& epilogue, std::size_t strassenCutoff = 0, 
+      StrassenWorkspaceType* workspace = nullptr);
+
+    template<typename MT, typename=TMLEnableIf_t<IsChain_v<MT>>>
+    bool ChainKernel(TMLDenseMatrix<MT>& res) const;
+
+    using ViewType = Internal::TMLGemmView<ElementType>;
+    using ConstViewType = Internal::TMLGemmView<const ElementType>;
+
+    // Selects the kernel for views of the operands of a non-empty product
+    static void ViewKernel(ViewType cv, ConstViewType av, ConstViewType bv, bool rowMajorC, std::size_t threads, 
+      EpilogueType ep, std::size_t strassenCutoff, StrassenWorkspaceType* workspace);
+
+    // Cheapest order of a product chain with the given dimensions (factor i is dims[i] x dims[i+1]), 
+    // split[i * n + j] is the last factor of the left product of the factors i..j
+    static void ChainOrder(const std::size_t* dims, std::size_t n, std::size_t* split);
+    // Scratch memory (elements) that ChainOperands needs for the product of the factors i..j
+    static std::size_t ChainScratch(const std::size_t* dims, std::size_t n, const std::size_t* split, 
+      std::size_t i, std::size_t j);
+    // Left and right operand of the last product of the factors i..j (a factor or an intermediate product
+    // in scratch) and the product of the factors i..j into a row-major view
+    static void ChainOperands(const ConstViewType* factors, const std::size_t* dims, std::size_t n, 
+      const std::size_t* split, std::size_t i, std::size_t j, ElementType* scratch, std::size_t threads, 
+      ConstViewType& left, ConstViewType& right);
+    static void ChainProduct(const ViewType& c, const ConstViewType* factors, const std::size_t* dims, std::size_t n, 
+      const std::size_t* split, std::size_t i, std::size_t j, ElementType* scratch, std::size_t threads);
+    // Size of an intermediate product in scratch (multiple of a cache line)
+    static std::size_t ChainBufferSize(std::size_t rows, std::size_t cols) noexcept
+    {
+      constexpr std::size_t line = 64 / sizeof(ElementType) > 0 ? 64 / sizeof(ElementType) : 1;
+      return ((rows * cols + line - 1) / line) * line;
+    }
+
+    // The kernels below operate on views with a row-major C (i.e. c.cs == 1)
+
+    static void BlockedKernel(const ViewType& c, const ConstViewType& a, const ConstViewType& b, 
+      std::size_t threads, const EpilogueType& epilogue);
+    static void StrassenKernel(const ViewType& c, const ConstViewType& a, const ConstViewType& b, 
+      std::size_t threads, std::size_t cutoff, StrassenWorkspaceType* workspace);
 
     const LOpType& m_lhs;
     const ROpType& m_rhs;
+    std::size_t m_threads;
+    EpilogueType m_epilogue;
+    std::size_t m_strassenCutoff;
+    StrassenWorkspaceType* m_workspace;
   };
 
   template<typename ML, typename MR, typename=TMLEnableIf_t<TMLBooleanAnd_v<
@@ -101,10 +466,19 @@ namespace ML
     assert(i < Rows());
     assert(j < Cols());
     
+    // beta refers to the assigned matrix, which an element access does not know
+    assert(m_epilogue.beta == ElementType(0));
+
     ElementType res = 0;
     for (size_t k = 0; k < (~m_lhs).Cols(); k++)
       res += static_cast<ElementType>((~m_lhs)(i, k)) * static_cast<ElementType>((~m_rhs)(k, j));
-    return res;
+
+    res = m_epilogue.alpha * res;
+    if (m_epilogue.rowBias)
+      res += m_epilogue.rowBias[i];
+    if (m_epilogue.colBias)
+      res += m_epilogue.colBias[j];
+    return Internal::MLGemmActivate(res, m_epilogue);
   }
 
   template<typename M1, typename M2>
@@ -114,13 +488,16 @@ namespace ML
     assert((~res).Rows() == (~m_lhs).Rows());
     assert((~res).Cols() == (~m_rhs).Cols());
 
-    const LOpResType& lhs(m_lhs);
-    const ROpResType& rhs(m_rhs);
+    if (ExecuteChain(res))
+      return;
+
+    const LOpTmpType& lhs(m_lhs);
+    const ROpTmpType& rhs(m_rhs);
 
     if ((~res).IsAlias(lhs) || (~res).IsAlias(rhs))
     {
-      using TmpType = decltype(~res);
-      auto tmp = TmpType(~res);
+      // The temporary is a copy of the result (read by the epilogue if beta != 0)
+      TMLMatrixScratchResult_t<MT> tmp(~res);
       ExecuteKernel(tmp, lhs, rhs);
       (~res).Assign(tmp);
     }
@@ -133,107 +510,306 @@ namespace ML
   template<typename M1, typename M2>
   template<typename C, typename A, typename B> 
   void TMLDMDMMulExpression<M1, M2>::DefaultKernel(
-    TMLDenseMatrix<C>& c, const TMLDenseMatrix<A>& a, const TMLDenseMatrix<B>& b)
+    TMLDenseMatrix<C>& c, const TMLDenseMatrix<A>& a, const TMLDenseMatrix<B>& b, const EpilogueType& epilogue)
   {
-    (~c).SetZero();
+    // C is not read if beta is 0
+    if (epilogue.beta == ElementType(0))
+    {
+      (~c).SetZero();
+    }
+    else if (epilogue.source)
+    {
+      const std::size_t stride = epilogue.sourceStride;
+      for (size_t i = 0; i < (~c).Rows(); i++)
+        for (size_t j = 0; j < (~c).Cols(); j++)
+          (~c)(i, j) = epilogue.beta * epilogue.source[TMLMatrixIsRowMajor_v<C> ? i * stride + j : j * stride + i];
+    }
+    else if (epilogue.beta != ElementType(1))
+    {
+      for (size_t i = 0; i < (~c).Rows(); i++)
+        for (size_t j = 0; j < (~c).Cols(); j++)
+          (~c)(i, j) *= epilogue.beta;
+    }
+
     for (size_t i = 0; i < (~a).Rows(); i++)
     {
       for (size_t k = 0; k < (~a).Cols(); k++)
       {
-        auto a_ik = static_cast<ElementType>((~a)(i, k));
+        auto a_ik = epilogue.alpha * static_cast<ElementType>((~a)(i, k));
         for (size_t j = 0; j < (~b).Cols(); j++)
         {
           (~c)(i, j) += a_ik * static_cast<ElementType>((~b)(k, j));
         }
       }
     }
+
+    if (epilogue.rowBias || epilogue.colBias || epilogue.activation != EMLActivation::None)
+    {
+      for (size_t i = 0; i < (~c).Rows(); i++)
+      {
+        for (size_t j = 0; j < (~c).Cols(); j++)
+        {
+          ElementType res = (~c)(i, j);
+          if (epilogue.rowBias)
+            res += epilogue.rowBias[i];
+          if (epilogue.colBias)
+            res += epilogue.colBias[j];
+          (~c)(i, j) = Internal::MLGemmActivate(res, epilogue);
+        }
+      }
+    }
   }
 
   template<typename M1, typename M2>
-  template<typename C, typename A, typename B, typename> 
+  template<typename C, typename A, typename B, typename>
   void TMLDMDMMulExpression<M1, M2>::VectorizedKernel(
-    TMLDenseMatrix<C>& c, const TMLDenseMatrix<A>& a, const TMLDenseMatrix<B>& b)
+    TMLDenseMatrix<C>& c, const TMLDenseMatrix<A>& a, const TMLDenseMatrix<B>& b, std::size_t threads, 
+    const EpilogueType& epilogue, std::size_t strassenCutoff, StrassenWorkspaceType* workspace)
   {
-    constexpr auto simdSize = TMLSIMDSize_v<SIMDType>;
+    // Empty products (C = beta * C + bias) are left to the default kernel
+    if ((~a).Cols() == 0 || (~c).Rows() == 0 || (~c).Cols() == 0)
+    {
+      DefaultKernel(c, a, b, epilogue);
+      return;
+    }
 
-    if (TMLMatrixIsRowMajor_v<C> && TMLMatrixIsRowMajor_v<A> && TMLMatrixIsRowMajor_v<B>)
+    ViewKernel(Internal::MLMakeGemmView(~c), Internal::MLMakeGemmView(~a), Internal::MLMakeGemmView(~b), 
+      TMLMatrixIsRowMajor_v<C>, threads, epilogue, strassenCutoff, workspace);
+  }
+
+  template<typename M1, typename M2>
+  void TMLDMDMMulExpression<M1, M2>::ViewKernel(ViewType cv, ConstViewType av, ConstViewType bv, bool rowMajorC, 
+    std::size_t threads, EpilogueType ep, std::size_t strassenCutoff, StrassenWorkspaceType* workspace)
+  {
+    // The kernels require a row-major C. A column-major C is computed as C^T = B^T * A^T
+    if (!rowMajorC)
     {
-      // Cascade the different kernel sizes
-      std::size_t j = 0;
-      for(; (j + 4*simdSize) <= (~c).PaddedCols(); j += 4*simdSize)
-      {
-        std::size_t i = 0;
-        for (; (i + 3) <= (~c).Rows(); i += 3) { VectorizedSubKernelRRR<3, 4>(c, a, b, i, j); }
-        for (; (i + 2) <= (~c).Rows(); i += 2) { VectorizedSubKernelRRR<2, 4>(c, a, b, i, j); }
-        if (i < (~c).Rows()) { VectorizedSubKernelRRR<1, 4>(c, a, b, i, j); }
-      }
-      for(; (j + 3*simdSize) <= (~c).PaddedCols(); j += 3*simdSize)
-      {
-        std::size_t i = 0;
-        for (; (i + 4) <= (~c).Rows(); i += 4) { VectorizedSubKernelRRR<4, 3>(c, a, b, i, j); }
-        for (; (i + 2) <= (~c).Rows(); i += 2) { VectorizedSubKernelRRR<2, 3>(c, a, b, i, j); }
-        if (i < (~c).Rows()) { VectorizedSubKernelRRR<1, 3>(c, a, b, i, j); }
-      }
-      for(; (j + 2*simdSize) <= (~c).PaddedCols(); j += 2*simdSize)
-      {
-        std::size_t i = 0;
-        for (; (i + 2) <= (~c).Rows(); i += 2) { VectorizedSubKernelRRR<2, 2>(c, a, b, i, j); }
-        if (i < (~c).Rows()) { VectorizedSubKernelRRR<1, 2>(c, a, b, i, j); }
-      }
-      for(; (j + simdSize) <= (~c).PaddedCols(); j += simdSize)
-      {
-        std::size_t i = 0;
-        for (; (i + 8) <= (~c).Rows(); i += 8) { VectorizedSubKernelRRR<8, 1>(c, a, b, i, j); }
-        for (; (i + 4) <= (~c).Rows(); i += 4) { VectorizedSubKernelRRR<4, 1>(c, a, b, i, j); }
-        for (; (i + 2) <= (~c).Rows(); i += 2) { VectorizedSubKernelRRR<2, 1>(c, a, b, i, j); }
-        for (; i < (~c).Rows(); i++) { VectorizedSubKernelRRR<1, 1>(c, a, b, i, j); }
-      }
+      cv = cv.Transposed();
+      std::swap(av, bv);
+      av = av.Transposed();
+      bv = bv.Transposed();
+      std::swap(ep.rowBias, ep.colBias);
     }
-    else
+
+    const std::size_t m = cv.rows;
+    const std::size_t n = cv.cols;
+    const std::size_t k = av.cols;
+
+    const bool scaledProduct = !ep.rowBias && !ep.colBias && ep.activation == EMLActivation::None;
+    const bool plainProduct = scaledProduct && ep.alpha == ElementType(1) && ep.beta == ElementType(0);
+
+    // GEMV and GER scale C in place, i.e. a source is copied to C first (a vector, or one sweep for GER)
+    if (scaledProduct && ep.source && ep.beta != ElementType(0) && (n == 1 || m == 1 || k == 1))
     {
-      DefaultKernel(c, a, b);
-    } 
+      for (std::size_t i = 0; i < m; i++)
+        std::copy(ep.source + i * ep.sourceStride, ep.source + i * ep.sourceStride + n, cv.data + i * cv.rs);
+      ep.source = nullptr;
+    }
+
+    // Matrix-vector products and outer products are computed by the GEMV / GER kernels, large products 
+    // and products with a B that is not contiguous along the rows of C by the (packing) blocked kernel 
+    // and small products by the cascade of register tiles
+    if (scaledProduct && n == 1)
+      BlockedGemmKernel::Gemv(av, bv.data, bv.rs, cv.data, cv.rs, ep.alpha, ep.beta);
+    else if (scaledProduct && m == 1)
+      BlockedGemmKernel::Gemv(bv.Transposed(), av.data, av.cs, cv.data, cv.cs, ep.alpha, ep.beta);
+    else if (scaledProduct && k == 1)
+      BlockedGemmKernel::Ger(cv, av.data, av.rs, bv.data, bv.cs, ep.alpha, ep.beta);
+    else if (strassenCutoff != 0 && plainProduct && Internal::TMLStrassenKernel<ElementType, SIMDType>::Levels(m, n, k, strassenCutoff) > 0)
+      StrassenKernel(cv, av, bv, threads, strassenCutoff, workspace);
+    else if (m * n * k > BlockedKernelThreshold_v || bv.cs != 1)
+      BlockedKernel(cv, av, bv, threads, ep);
+    else
+      BlockedGemmKernel::ComputeUnblocked(cv, av, bv, ep);
   }
 
   template<typename M1, typename M2>
-  template<std::size_t regsA, std::size_t regsB, typename C, typename A, typename B, typename> 
-  QM_ALWAYS_INLINE void TMLDMDMMulExpression<M1, M2>::VectorizedSubKernelRRR(
-    TMLDenseMatrix<C>& c, const TMLDenseMatrix<A>& a, const TMLDenseMatrix<B>& b, std::size_t ro, std::size_t co)
-  {
-    if ((~a).Rows() > 0) 
-    {
-      SIMDType csum[regsA][regsB];
-
-      // First p
-      std::size_t p = 0;
-      MLConstexprFor<std::size_t, 0, regsB, 1>([&](auto bi) {
-        auto bb = (~b).Load(p, co + bi * TMLSIMDSize_v<SIMDType>);
-        MLConstexprFor<std::size_t, 0, regsA, 1>([&](auto ai) {
-          auto aa = SIMDType::Set1((~a)(ro + ai, p));
-            csum[ai][bi] = aa * bb;
-        });
-      });
-
-      // Rest of ps
-      for (++p; p < (~a).Rows(); p++) {
-        MLConstexprFor<std::size_t, 0, regsB, 1>([&](auto bi) {
-          auto bb = (~b).Load(p, co + bi * TMLSIMDSize_v<SIMDType>);
-          MLConstexprFor<std::size_t, 0, regsA, 1>([&](auto ai) {
-            auto aa = SIMDType::Set1((~a)(ro + ai, p));
-              csum[ai][bi] = MLSIMDFmadd(aa, bb, csum[ai][bi]);
-          });
-        });
-      }
+  template<typename MT, typename>
+  bool TMLDMDMMulExpression<M1, M2>::ChainKernel(TMLDenseMatrix<MT>& res) const
+  {
+    constexpr std::size_t n = ChainLength_v;
+
+    ConstViewType factors[n];
+    std::size_t count = 0;
+    if (!Internal::MLMulChainCollect(*this, factors, count))
+      return false;
+    assert(count == n);
+
+    // Empty products and products that overwrite one of their factors are evaluated from left to right
+    std::size_t dims[n + 1];
+    dims[0] = factors[0].rows;
+    for (std::size_t i = 0; i < n; i++)
+    {
+      dims[i + 1] = factors[i].cols;
+      if (dims[i] == 0 || Internal::MLIsOverlapping(factors[i], Internal::MLMakeGemmView(~res)))
+        return false;
+    }
+    if (dims[n] == 0)
+      return false;
+
+    std::size_t split[n * n];
+    ChainOrder(dims, n, split);
+
+    // One buffer holds all intermediate products, the last product is computed with the modifiers of 
+    // this expression (epilogue, threads, Strassen)
+    TMLScratchArray<ElementType> scratch(ChainScratch(dims, n, split, 0, n - 1), 64);
+    ConstViewType left, right;
+    ChainOperands(factors, dims, n, split, 0, n - 1, scratch.data(), m_threads, left, right);
+    ViewKernel(Internal::MLMakeGemmView(~res), left, right, TMLMatrixIsRowMajor_v<MT>, m_threads, m_epilogue, 
+      m_strassenCutoff, m_workspace);
+    return true;
+  }
 
-      // Accumulate the results into C.
-      for (std::size_t ai = 0; ai < regsA; ai++) {
-        for (std::size_t bi = 0; bi < regsB; bi++) {
-          (~c).Store(csum[ai][bi], ro + ai, co + bi * TMLSIMDSize_v<SIMDType>);
+  template<typename M1, typename M2>
+  void TMLDMDMMulExpression<M1, M2>::ChainOrder(const std::size_t* dims, std::size_t n, std::size_t* split)
+  {
+    // Classic dynamic program over the lengths of the subchains (cost = number of multiply-adds)
+    std::vector<double> cost(n * n, 0.0);
+    for (std::size_t len = 2; len <= n; len++)
+    {
+      for (std::size_t i = 0; i + len <= n; i++)
+      {
+        const std::size_t j = i + len - 1;
+        cost[i * n + j] = std::numeric_limits<double>::infinity();
+        for (std::size_t k = i; k < j; k++)
+        {
+          const double c = cost[i * n + k] + cost[(k + 1) * n + j] + 
+            static_cast<double>(dims[i]) * static_cast<double>(dims[k + 1]) * static_cast<double>(dims[j + 1]);
+          if (c < cost[i * n + j])
+          {
+            cost[i * n + j] = c;
+            split[i * n + j] = k;
+          }
         }
       }
     }
   }
 
+  template<typename M1, typename M2>
+  std::size_t TMLDMDMMulExpression<M1, M2>::ChainScratch(const std::size_t* dims, std::size_t n, 
+    const std::size_t* split, std::size_t i, std::size_t j)
+  {
+    // The left operand is computed first, the right one while the left one is held
+    const std::size_t k = split[i * n + j];
+    const std::size_t left = k > i ? ChainBufferSize(dims[i], dims[k + 1]) : 0;
+    const std::size_t right = k + 1 < j ? ChainBufferSize(dims[k + 1], dims[j + 1]) : 0;
+    const std::size_t leftScratch = k > i ? ChainScratch(dims, n, split, i, k) : 0;
+    const std::size_t rightScratch = k + 1 < j ? ChainScratch(dims, n, split, k + 1, j) : 0;
+    return std::max(left + leftScratch, left + right + rightScratch);
+  }
+
+  template<typename M1, typename M2>
+  void TMLDMDMMulExpression<M1, M2>::ChainOperands(const ConstViewType* factors, const std::size_t* dims, 
+    std::size_t n, const std::size_t* split, std::size_t i, std::size_t j, ElementType* scratch, std::size_t threads, 
+    ConstViewType& left, ConstViewType& right)
+  {
+    const std::size_t k = split[i * n + j];
+
+    left = factors[i];
+    if (k > i)
+    {
+      const ViewType buffer = { scratch, dims[i], dims[k + 1], dims[k + 1], 1 };
+      scratch += ChainBufferSize(dims[i], dims[k + 1]);
+      ChainProduct(buffer, factors, dims, n, split, i, k, scratch, threads);
+      left = { buffer.data, buffer.rows, buffer.cols, buffer.rs, buffer.cs };
+    }
+
+    right = factors[j];
+    if (k + 1 < j)
+    {
+      const ViewType buffer = { scratch, dims[k + 1], dims[j + 1], dims[j + 1], 1 };
+      scratch += ChainBufferSize(dims[k + 1], dims[j + 1]);
+      ChainProduct(buffer, factors, dims, n, split, k + 1, j, scratch, threads);
+      right = { buffer.data, buffer.rows, buffer.cols, buffer.rs, buffer.cs };
+    }
+  }
+
+  template<typename M1, typename M2>
+  void TMLDMDMMulExpression<M1, M2>::ChainProduct(const ViewType& c, const ConstViewType* factors, 
+    const std::size_t* dims, std::size_t n, const std::size_t* split, std::size_t i, std::size_t j, 
+    ElementType* scratch, std::size_t threads)
+  {
+    ConstViewType left, right;
+    ChainOperands(factors, dims, n, split, i, j, scratch, threads, left, right);
+    ViewKernel(c, left, right, true, threads, EpilogueType(), 0, nullptr);
+  }
+
+  template<typename M1, typename M2>
+  void TMLDMDMMulExpression<M1, M2>::StrassenKernel(const ViewType& c, const ConstViewType& a, const ConstViewType& b, 
+    std::size_t threads, std::size_t cutoff, StrassenWorkspaceType* workspace)
+  {
+    using KernelType = Internal::TMLStrassenKernel<ElementType, SIMDType>;
+
+    const std::size_t m = c.rows;
+    const std::size_t n = c.cols;
+    const std::size_t k = a.cols;
+
+    // Without a workspace the temporaries are taken from the scratch arena of the thread
+    const std::size_t size = KernelType::WorkspaceSize(m, n, k, cutoff);
+    TMLScratchArray<ElementType> scratch(workspace ? 0 : size, 64);
+    ElementType* mem = workspace ? workspace->Reserve(size) : scratch.data();
+
+    // The products at the leaves of the recursion are large enough for the parallel blocked kernel
+    auto leaf = [threads](const ViewType& lc, const ConstViewType& la, const ConstViewType& lb, const EpilogueType& ep) {
+      BlockedKernel(lc, la, lb, threads, ep);
+    };
+    KernelType::Compute(c, a, b, cutoff, mem, leaf);
+
+    if (workspace)
+    {
+      const std::size_t levels = KernelType::Levels(m, n, k, cutoff);
+      workspace->SetLastProduct(levels, MLStrassenErrorBound<ElementType>(std::max(m, std::max(n, k)), levels));
+    }
+  }
+
+  template<typename M1, typename M2>
+  void TMLDMDMMulExpression<M1, M2>::BlockedKernel(
+    const ViewType& c, const ConstViewType& a, const ConstViewType& b, std::size_t threads, const EpilogueType& epilogue)
+  {
+    const std::size_t MR = BlockedGemmKernel::TileRows();
+    const std::size_t NR = BlockedGemmKernel::TileCols();
+
+    const std::size_t m = c.rows;
+    const std::size_t n = c.cols;
+    const std::size_t k = a.cols;
+
+    // Limit the number of threads such that every thread gets enough work
+    auto& pool = CMLThreadPool::GetGlobal();
+    threads = threads == 0 ? pool.GetThreadCount() : std::min(threads, pool.GetThreadCount());
+    threads = std::min(threads, std::max<std::size_t>(m * n * k / ParallelWorkPerThread_v, 1));
+
+    if (threads <= 1)
+    {
+      BlockedGemmKernel::Compute(c, a, b, 0, m, 0, n, epilogue);
+      return;
+    }
+
+    // Partition C into a grid of threads = tr x tc blocks that are as square as possible.
+    // Every block is computed independently (each thread packs its own panels).
+    const std::size_t rowUnits = (m + MR - 1) / MR;
+    const std::size_t colUnits = (n + NR - 1) / NR;
+    std::size_t tr = 1, blockSize = static_cast<std::size_t>(-1);
+    for (std::size_t t = 1; t <= threads; t++)
+    {
+      // block size ~ max(m / t, n / (threads / t)) -> compare multiplied by threads
+      const std::size_t size = std::max(m * (threads / t), n * t);
+      if (threads % t == 0 && t <= rowUnits && threads / t <= colUnits && size < blockSize)
+        tr = t, blockSize = size;
+    }
+    const std::size_t tc = threads / tr;
+
+    pool.ParallelFor(tr * tc, [&](std::size_t t) {
+      const std::size_t ti = t / tc;
+      const std::size_t tj = t % tc;
+      const std::size_t i0 = std::min(m, (rowUnits * ti / tr) * MR);
+      const std::size_t i1 = std::min(m, (rowUnits * (ti + 1) / tr) * MR);
+      const std::size_t j0 = std::min(n, (colUnits * tj / tc) * NR);
+      const std::size_t j1 = std::min(n, (colUnits * (tj + 1) / tc) * NR);
+      if (i0 < i1 && j0 < j1)
+        BlockedGemmKernel::Compute(c, a, b, i0, i1, j0, j1, epilogue);
+    }, threads);
+  }
+
 }
 
 #endif
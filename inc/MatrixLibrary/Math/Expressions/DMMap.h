@@ -0,0 +1,338 @@
+// Copyright 2021, Philipp Neufeld
+
+#ifndef ML_MATH_Expressions_DMMap_H_
+#define ML_MATH_Expressions_DMMap_H_
+
+// Includes
+#include <type_traits>
+#include <cassert>
+#include <cmath>
+
+#include "MatrixExpression.h"
+#include "DMDMElementwise.h"
+#include "../Matrix.h"
+
+#include "../../QTL/EnableIf.h"
+
+namespace ML
+{
+
+  namespace Internal
+  {
+    // The vectorized approximations of SIMD/ exist for single and double precision, other element types are
+    // mapped with the standard library element by element
+    template<typename ET>
+    constexpr bool TMLIsMapVectorizable_v = std::is_same<ET, float>::value || std::is_same<ET, double>::value;
+
+    // Elementwise functions (applied to SIMD registers with MLSIMDExp etc. and to elements with std::exp etc.)
+    struct SMLElementwiseExp
+    {
+      template<typename ET> constexpr static bool IsVectorizable_v = TMLIsMapVectorizable_v<ET>;
+      template<typename T> QM_ALWAYS_INLINE TMLEnableIf_t<TMLIsSIMD_v<T>, T> operator()(const T& x) const { return MLSIMDExp(x); }
+      template<typename T> QM_ALWAYS_INLINE TMLEnableIf_t<!TMLIsSIMD_v<T>, T> operator()(const T& x) const { return std::exp(x); }
+    };
+
+    struct SMLElementwiseLog
+    {
+      template<typename ET> constexpr static bool IsVectorizable_v = TMLIsMapVectorizable_v<ET>;
+      template<typename T> QM_ALWAYS_INLINE TMLEnableIf_t<TMLIsSIMD_v<T>, T> operator()(const T& x) const { return MLSIMDLog(x); }
+      template<typename T> QM_ALWAYS_INLINE TMLEnableIf_t<!TMLIsSIMD_v<T>, T> operator()(const T& x) const { return std::log(x); }
+    };
+
+    struct SMLElementwiseSqrt
+    {
+      template<typename ET> constexpr static bool IsVectorizable_v = TMLIsMapVectorizable_v<ET>;
+      template<typename T> QM_ALWAYS_INLINE TMLEnableIf_t<TMLIsSIMD_v<T>, T> operator()(const T& x) const { return MLSIMDSqrt(x); }
+      template<typename T> QM_ALWAYS_INLINE TMLEnableIf_t<!TMLIsSIMD_v<T>, T> operator()(const T& x) const { return std::sqrt(x); }
+    };
+
+    struct SMLElementwiseRsqrt
+    {
+      template<typename ET> constexpr static bool IsVectorizable_v = TMLIsMapVectorizable_v<ET>;
+      template<typename T> QM_ALWAYS_INLINE TMLEnableIf_t<TMLIsSIMD_v<T>, T> operator()(const T& x) const { return MLSIMDRsqrt(x); }
+      template<typename T> QM_ALWAYS_INLINE TMLEnableIf_t<!TMLIsSIMD_v<T>, T> operator()(const T& x) const { return T(1) / std::sqrt(x); }
+    };
+
+    struct SMLElementwiseSin
+    {
+      template<typename ET> constexpr static bool IsVectorizable_v = TMLIsMapVectorizable_v<ET>;
+      template<typename T> QM_ALWAYS_INLINE TMLEnableIf_t<TMLIsSIMD_v<T>, T> operator()(const T& x) const { return MLSIMDSin(x); }
+      template<typename T> QM_ALWAYS_INLINE TMLEnableIf_t<!TMLIsSIMD_v<T>, T> operator()(const T& x) const { return std::sin(x); }
+    };
+
+    struct SMLElementwiseCos
+    {
+      template<typename ET> constexpr static bool IsVectorizable_v = TMLIsMapVectorizable_v<ET>;
+      template<typename T> QM_ALWAYS_INLINE TMLEnableIf_t<TMLIsSIMD_v<T>, T> operator()(const T& x) const { return MLSIMDCos(x); }
+      template<typename T> QM_ALWAYS_INLINE TMLEnableIf_t<!TMLIsSIMD_v<T>, T> operator()(const T& x) const { return std::cos(x); }
+    };
+
+    struct SMLElementwiseTanh
+    {
+      template<typename ET> constexpr static bool IsVectorizable_v = TMLIsMapVectorizable_v<ET>;
+      template<typename T> QM_ALWAYS_INLINE TMLEnableIf_t<TMLIsSIMD_v<T>, T> operator()(const T& x) const { return MLSIMDTanh(x); }
+      template<typename T> QM_ALWAYS_INLINE TMLEnableIf_t<!TMLIsSIMD_v<T>, T> operator()(const T& x) const { return std::tanh(x); }
+    };
+
+    struct SMLElementwiseSigmoid
+    {
+      template<typename ET> constexpr static bool IsVectorizable_v = TMLIsMapVectorizable_v<ET>;
+      template<typename T> QM_ALWAYS_INLINE TMLEnableIf_t<TMLIsSIMD_v<T>, T> operator()(const T& x) const { return MLSIMDSigmoid(x); }
+      template<typename T> QM_ALWAYS_INLINE TMLEnableIf_t<!TMLIsSIMD_v<T>, T> operator()(const T& x) const { return T(1) / (T(1) + std::exp(-x)); }
+    };
+
+    struct SMLElementwiseErf
+    {
+      template<typename ET> constexpr static bool IsVectorizable_v = TMLIsMapVectorizable_v<ET>;
+      template<typename T> QM_ALWAYS_INLINE TMLEnableIf_t<TMLIsSIMD_v<T>, T> operator()(const T& x) const { return MLSIMDErf(x); }
+      template<typename T> QM_ALWAYS_INLINE TMLEnableIf_t<!TMLIsSIMD_v<T>, T> operator()(const T& x) const { return std::erf(x); }
+    };
+
+    // Power with a fixed exponent
+    template<typename ET>
+    struct TMLElementwisePow
+    {
+      template<typename T> constexpr static bool IsVectorizable_v = TMLIsMapVectorizable_v<T>;
+      template<typename T> QM_ALWAYS_INLINE TMLEnableIf_t<TMLIsSIMD_v<T>, T> operator()(const T& x) const { return MLSIMDPow(x, T::Set1(exponent)); }
+      template<typename T> QM_ALWAYS_INLINE TMLEnableIf_t<!TMLIsSIMD_v<T>, T> operator()(const T& x) const { return std::pow(x, exponent); }
+
+      ET exponent;
+    };
+  }
+
+  // Elementwise function of a dense matrix (MLExp, MLLog, MLPow, MLSqrt, MLRsqrt, MLSin, MLCos, MLTanh,
+  // MLSigmoid and MLErf)
+  template<typename M1, typename OP>
+  class TMLDMMapExpression : public TMLMatrixExpression<TMLDMMapExpression<M1, OP>>
+  {
+    template<typename M, typename> friend TMLDMMapExpression<M, Internal::SMLElementwiseExp> MLExp(const M& mat);
+    template<typename M, typename> friend TMLDMMapExpression<M, Internal::SMLElementwiseLog> MLLog(const M& mat);
+    template<typename M, typename S, typename>
+    friend TMLDMMapExpression<M, Internal::TMLElementwisePow<TMLMatrixElementType_t<TMLMatrixExpressionResultType_t<M>>>>
+      MLPow(const M& mat, const S& exponent);
+    template<typename M, typename> friend TMLDMMapExpression<M, Internal::SMLElementwiseSqrt> MLSqrt(const M& mat);
+    template<typename M, typename> friend TMLDMMapExpression<M, Internal::SMLElementwiseRsqrt> MLRsqrt(const M& mat);
+    template<typename M, typename> friend TMLDMMapExpression<M, Internal::SMLElementwiseSin> MLSin(const M& mat);
+    template<typename M, typename> friend TMLDMMapExpression<M, Internal::SMLElementwiseCos> MLCos(const M& mat);
+    template<typename M, typename> friend TMLDMMapExpression<M, Internal::SMLElementwiseTanh> MLTanh(const M& mat);
+    template<typename M, typename> friend TMLDMMapExpression<M, Internal::SMLElementwiseSigmoid> MLSigmoid(const M& mat);
+    template<typename M, typename> friend TMLDMMapExpression<M, Internal::SMLElementwiseErf> MLErf(const M& mat);
+
+  public:
+    using MyT = TMLDMMapExpression<M1, OP>;
+    using LOpType = TMLDecayCRTP_t<M1>;
+    using LOpResType = TMLMatrixExpressionResultType_t<LOpType>;
+    using LOpTmpType = TMLMatrixExpressionTemporary_t<LOpType>;
+    using ResultType = TMLMatrixCopyResult_t<LOpResType>;
+    using OperationType = OP;
+
+    using ElementType = TMLMatrixElementType_t<LOpResType>;
+    using SIMDType = TMLMatrixSIMDType_t<LOpResType>;
+
+    explicit TMLDMMapExpression(const M1& mat, const OP& op)
+    : m_mat(~mat), m_op(op) { }
+
+  private:
+    // Make copy/move private in order to prevent direct assignment of an expression
+    TMLDMMapExpression(const MyT&) = default;
+    TMLDMMapExpression(MyT&&) noexcept = default;
+    MyT& operator=(const MyT&) = default;
+    MyT& operator=(MyT&&) noexcept = default;
+  public:
+
+    constexpr std::size_t Rows() const noexcept { return (~m_mat).Rows(); }
+    constexpr std::size_t Cols() const noexcept { return (~m_mat).Cols(); }
+
+    ElementType operator()(std::size_t i, std::size_t j) const noexcept;
+
+    template<typename MT, typename=LOpResType>
+    void AssignTo(TMLDenseMatrix<MT>& res) const;
+
+    // Operand tree of the expression for Internal::MLElementwiseKernel
+    template<bool rowMajor>
+    auto Operand() const { return Internal::MLElementwiseNode(m_op, Internal::MLElementwiseOperand<rowMajor>(m_mat)); }
+
+    // Does the matrix overlap res at other positions (see Internal::MLIsElementwiseAlias)?
+    template<typename MT>
+    bool IsElementwiseAlias(const MT& res) const noexcept { return Internal::MLIsElementwiseAlias(res, m_mat); }
+
+  public:
+    template<typename SIMD>
+    constexpr static bool IsFusable_v =
+      Internal::TMLIsElementwiseFusable_v<LOpType, SIMD> &&
+      OperationType::template IsVectorizable_v<ElementType>;
+
+    // The function of an elementwise expression (e.g. MLExp(a - b)) is applied in the same pass
+    template<typename MT>
+    constexpr static bool IsFused_v =
+      TMLIsMatrixExpression_v<LOpType> &&
+      TMLMatrixIsVectorized_v<MT> &&
+      IsFusable_v<TMLMatrixSIMDType_t<MT>>;
+
+    template<typename C, typename A>
+    constexpr static bool IsVectorizable_v =
+      TMLMatrixIsDense_v<C> &&
+      TMLMatrixIsDense_v<A> &&
+      TMLMatrixIsVectorized_v<C> &&
+      TMLMatrixIsVectorized_v<A> &&
+      TMLMatrixIsSameSIMDType_v<C, A> &&
+      OperationType::template IsVectorizable_v<TMLMatrixElementType_t<C>>;
+
+    template<typename MT> TMLEnableIf_t<!IsFused_v<MT>, void> Evaluate(TMLDenseMatrix<MT>& res) const
+      { const LOpTmpType& mat(m_mat); ExecuteKernel(res, mat); }
+    template<typename MT> TMLEnableIf_t<IsFused_v<MT>, void> Evaluate(TMLDenseMatrix<MT>& res) const { FusedKernel(res); }
+
+    // Selects the right kernel
+    template<typename C, typename A> TMLEnableIf_t<!IsVectorizable_v<C, A>, void>
+      ExecuteKernel(TMLDenseMatrix<C>& c, const TMLDenseMatrix<A>& a) const { DefaultKernel(c, a); }
+    template<typename C, typename A> TMLEnableIf_t<IsVectorizable_v<C, A>, void>
+      ExecuteKernel(TMLDenseMatrix<C>& c, const TMLDenseMatrix<A>& a) const { VectorizedKernel(c, a); }
+
+    template<typename C, typename A>
+    void DefaultKernel(TMLDenseMatrix<C>& c, const TMLDenseMatrix<A>& a) const;
+    template<typename C, typename A, typename=TMLEnableIf_t<IsVectorizable_v<C, A>>>
+    void VectorizedKernel(TMLDenseMatrix<C>& c, const TMLDenseMatrix<A>& a) const;
+    template<typename MT, typename=TMLEnableIf_t<IsFused_v<MT>>>
+    void FusedKernel(TMLDenseMatrix<MT>& res) const;
+
+    const LOpType& m_mat;
+    const OperationType m_op;
+  };
+
+  // The functions are defined for dense matrices of real floating point numbers
+  template<typename MT>
+  constexpr bool TMLIsMapOperand_v =
+    TMLMatrixIsDense_v<TMLMatrixExpressionResultType_t<MT>> &&
+    std::is_floating_point<TMLMatrixElementType_t<TMLMatrixExpressionResultType_t<MT>>>::value;
+
+  // Elementwise exponential and natural logarithm
+  template<typename MT, typename=TMLEnableIf_t<TMLIsMapOperand_v<MT>>>
+  TMLDMMapExpression<MT, Internal::SMLElementwiseExp> MLExp(const MT& mat)
+  {
+    return TMLDMMapExpression<MT, Internal::SMLElementwiseExp>(mat, Internal::SMLElementwiseExp());
+  }
+
+  template<typename MT, typename=TMLEnableIf_t<TMLIsMapOperand_v<MT>>>
+  TMLDMMapExpression<MT, Internal::SMLElementwiseLog> MLLog(const MT& mat)
+  {
+    return TMLDMMapExpression<MT, Internal::SMLElementwiseLog>(mat, Internal::SMLElementwiseLog());
+  }
+
+  // Elementwise power with a scalar exponent. The vectorized version computes e^(b log a), its error grows
+  // with the magnitude of the result (see Internal::MLSIMDPowVectorized).
+  template<typename MT, typename ST, typename=TMLEnableIf_t<TMLBooleanAnd_v<
+    TMLIsMapOperand_v<MT>,
+    std::is_convertible<ST, TMLMatrixElementType_t<TMLMatrixExpressionResultType_t<MT>>>::value
+  >>>
+  TMLDMMapExpression<MT, Internal::TMLElementwisePow<TMLMatrixElementType_t<TMLMatrixExpressionResultType_t<MT>>>>
+    MLPow(const MT& mat, const ST& exponent)
+  {
+    using ET = TMLMatrixElementType_t<TMLMatrixExpressionResultType_t<MT>>;
+    return TMLDMMapExpression<MT, Internal::TMLElementwisePow<ET>>(mat, Internal::TMLElementwisePow<ET>{ static_cast<ET>(exponent) });
+  }
+
+  // Elementwise square root and reciprocal square root
+  template<typename MT, typename=TMLEnableIf_t<TMLIsMapOperand_v<MT>>>
+  TMLDMMapExpression<MT, Internal::SMLElementwiseSqrt> MLSqrt(const MT& mat)
+  {
+    return TMLDMMapExpression<MT, Internal::SMLElementwiseSqrt>(mat, Internal::SMLElementwiseSqrt());
+  }
+
+  template<typename MT, typename=TMLEnableIf_t<TMLIsMapOperand_v<MT>>>
+  TMLDMMapExpression<MT, Internal::SMLElementwiseRsqrt> MLRsqrt(const MT& mat)
+  {
+    return TMLDMMapExpression<MT, Internal::SMLElementwiseRsqrt>(mat, Internal::SMLElementwiseRsqrt());
+  }
+
+  // Elementwise sine and cosine
+  template<typename MT, typename=TMLEnableIf_t<TMLIsMapOperand_v<MT>>>
+  TMLDMMapExpression<MT, Internal::SMLElementwiseSin> MLSin(const MT& mat)
+  {
+    return TMLDMMapExpression<MT, Internal::SMLElementwiseSin>(mat, Internal::SMLElementwiseSin());
+  }
+
+  template<typename MT, typename=TMLEnableIf_t<TMLIsMapOperand_v<MT>>>
+  TMLDMMapExpression<MT, Internal::SMLElementwiseCos> MLCos(const MT& mat)
+  {
+    return TMLDMMapExpression<MT, Internal::SMLElementwiseCos>(mat, Internal::SMLElementwiseCos());
+  }
+
+  // Elementwise activation functions: hyperbolic tangent, logistic sigmoid 1 / (1 + e^-x) and error function
+  template<typename MT, typename=TMLEnableIf_t<TMLIsMapOperand_v<MT>>>
+  TMLDMMapExpression<MT, Internal::SMLElementwiseTanh> MLTanh(const MT& mat)
+  {
+    return TMLDMMapExpression<MT, Internal::SMLElementwiseTanh>(mat, Internal::SMLElementwiseTanh());
+  }
+
+  template<typename MT, typename=TMLEnableIf_t<TMLIsMapOperand_v<MT>>>
+  TMLDMMapExpression<MT, Internal::SMLElementwiseSigmoid> MLSigmoid(const MT& mat)
+  {
+    return TMLDMMapExpression<MT, Internal::SMLElementwiseSigmoid>(mat, Internal::SMLElementwiseSigmoid());
+  }
+
+  template<typename MT, typename=TMLEnableIf_t<TMLIsMapOperand_v<MT>>>
+  TMLDMMapExpression<MT, Internal::SMLElementwiseErf> MLErf(const MT& mat)
+  {
+    return TMLDMMapExpression<MT, Internal::SMLElementwiseErf>(mat, Internal::SMLElementwiseErf());
+  }
+
+  template<typename M1, typename OP> typename TMLDMMapExpression<M1, OP>::ElementType
+    TMLDMMapExpression<M1, OP>::operator()(std::size_t i, std::size_t j) const noexcept
+  {
+    assert(i < Rows());
+    assert(j < Cols());
+
+    return m_op(static_cast<ElementType>((~m_mat)(i, j)));
+  }
+
+  template<typename M1, typename OP>
+  template<typename MT, typename>
+  void TMLDMMapExpression<M1, OP>::AssignTo(TMLDenseMatrix<MT>& res) const
+  {
+    assert((~res).Rows() == (~m_mat).Rows());
+    assert((~res).Cols() == (~m_mat).Cols());
+
+    // the function can be applied in-place, but not into a view that is shifted against the matrix
+    if (IsElementwiseAlias(~res))
+    {
+      const TMLMatrixScratchResult_t<ResultType> tmp(*this);
+      (~res).Assign(tmp);
+    }
+    else
+    {
+      Evaluate(res);
+    }
+  }
+
+  template<typename M1, typename OP>
+  template<typename C, typename A>
+  void TMLDMMapExpression<M1, OP>::DefaultKernel(TMLDenseMatrix<C>& c, const TMLDenseMatrix<A>& a) const
+  {
+    for (size_t i = 0; i < (~c).Rows(); i++)
+    {
+      for (size_t j = 0; j < (~c).Cols(); j++)
+      {
+        (~c)(i, j) = m_op(static_cast<ElementType>((~a)(i, j)));
+      }
+    }
+  }
+
+  template<typename M1, typename OP>
+  template<typename C, typename A, typename>
+  void TMLDMMapExpression<M1, OP>::VectorizedKernel(TMLDenseMatrix<C>& c, const TMLDenseMatrix<A>& a) const
+  {
+    auto operand = Internal::MLElementwiseNode(m_op, Internal::MLElementwiseOperand<TMLMatrixIsRowMajor_v<C>>(~a));
+    Internal::MLElementwiseKernel(~c, operand);
+  }
+
+  template<typename M1, typename OP>
+  template<typename MT, typename>
+  void TMLDMMapExpression<M1, OP>::FusedKernel(TMLDenseMatrix<MT>& res) const
+  {
+    auto operand = Operand<TMLMatrixIsRowMajor_v<MT>>();
+    Internal::MLElementwiseKernel(~res, operand);
+  }
+
+}
+
+#endif
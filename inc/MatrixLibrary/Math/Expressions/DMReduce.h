@@ -0,0 +1,342 @@
+// Copyright 2021, Philipp Neufeld
+
+#ifndef ML_MATH_Expressions_DMReduce_H_
+#define ML_MATH_Expressions_DMReduce_H_
+
+// Includes
+#include <cmath>
+#include <utility>
+#include <type_traits>
+#include <cassert>
+
+#include "MatrixExpression.h"
+#include "DMDMElementwise.h"
+#include "../Matrix.h"
+#include "../Kernels/ReduceKernel.h"
+
+#include "../../QTL/EnableIf.h"
+#include "../../QTL/Boolean.h"
+
+namespace ML
+{
+
+  // Direction of a reduction: Rowwise reduces every row to one element (a column vector with an element per
+  // row), Columnwise every column (a row vector)
+  enum class EMLReduction
+  {
+    Rowwise,
+    Columnwise
+  };
+
+  // Position of an element (see MLArgMin and MLArgMax)
+  struct SMLMatrixIndex
+  {
+    std::size_t row, col;
+  };
+
+  namespace Internal
+  {
+    // Reduction to the position of the extreme (Op is SMLReduceMin or SMLReduceMax) instead of its value
+    template<typename Op>
+    struct TMLArgReduce {};
+
+    // Element type of a reduction of elements of type ET
+    template<typename Op, typename ET>
+    struct TMLReduceElementType : TMLType<ET> {};
+    template<typename Op, typename ET>
+    struct TMLReduceElementType<TMLArgReduce<Op>, ET> : TMLType<std::size_t> {};
+    template<typename T>
+    struct TMLReduceElementType<SMLReduceSquaredNorm, std::complex<T>> : TMLType<T> {};
+
+    template<typename Op, typename ET>
+    using TMLReduceElementType_t = typename TMLReduceElementType<Op, ET>::type;
+
+    // Reductions that compare the elements are defined for real matrices only
+    template<typename MT>
+    constexpr bool TMLIsRealDenseMatrix_v = TMLMatrixIsDense_v<TMLMatrixExpressionResultType_t<MT>> &&
+      !TMLIsComplex_v<TMLMatrixElementType_t<TMLMatrixExpressionResultType_t<MT>>>;
+
+    // Reductions of the lines of an operand, of the elements across the lines and of a row or a column of
+    // elements at(k) (k < n)
+    template<typename Op, typename SIMD>
+    struct TMLReduceDispatch
+    {
+      template<typename Dst, typename Operand>
+      static void Lines(Dst&& dst, const Operand& x, std::size_t lines, std::size_t length)
+        { TMLReduceKernel<Op, SIMD>::ReduceLines(dst, x, lines, length); }
+      template<typename Dst, typename Operand>
+      static void Across(Dst&& dst, const Operand& x, std::size_t lines, std::size_t length)
+        { TMLReduceKernel<Op, SIMD>::ReduceAcross(dst, x, lines, length); }
+
+      template<typename ET, typename At>
+      static ET Elements(At at, std::size_t n)
+      {
+        auto acc = Op::template Init<ET>();
+        for (std::size_t k = 0; k < n; k++)
+          Op::Accumulate(acc, static_cast<ET>(at(k)));
+        return Op::Result(acc);
+      }
+    };
+
+    template<typename Op, typename SIMD>
+    struct TMLReduceDispatch<TMLArgReduce<Op>, SIMD>
+    {
+      template<typename Dst, typename Operand>
+      static void Lines(Dst&& dst, const Operand& x, std::size_t lines, std::size_t length)
+        { TMLArgReduceKernel<Op, SIMD>::FindLines(dst, x, lines, length); }
+      template<typename Dst, typename Operand>
+      static void Across(Dst&& dst, const Operand& x, std::size_t lines, std::size_t length)
+        { TMLArgReduceKernel<Op, SIMD>::FindAcross(dst, x, lines, length); }
+
+      template<typename ET, typename At>
+      static std::size_t Elements(At at, std::size_t n)
+      {
+        std::size_t pos = 0;
+        for (std::size_t k = 1; k < n; k++)
+          if (Op::Exceeds(at(k), at(pos)))
+            pos = k;
+        return pos;
+      }
+    };
+
+    // Can an expression be reduced without a temporary? Fusable elementwise expressions (see MLElementwiseKernel)
+    // can if they read all matrices along their lines in the layout of their result.
+    template<typename ExT, typename=void>
+    struct TMLIsReduceFusable : std::false_type {};
+    template<typename ExT>
+    struct TMLIsReduceFusable<ExT, TMLEnableIf_t<
+      TMLIsMatrixExpression_v<ExT> &&
+      TMLIsElementwiseFusable_v<ExT, TMLMatrixSIMDType_t<TMLMatrixExpressionResultType_t<ExT>>>>>
+      : TMLBooleanConstant<!decltype(std::declval<const ExT&>().template Operand<
+          TMLMatrixIsRowMajor_v<TMLMatrixExpressionResultType_t<ExT>>>())::Transpose_v> {};
+
+    template<typename ExT>
+    constexpr bool TMLIsReduceFusable_v = TMLIsReduceFusable<ExT>::value;
+
+    // Calls f(x, rowMajor) with the operand x of a matrix or an expression (read along its lines in the layout
+    // rowMajor). Expressions that cannot be fused are evaluated into a temporary first.
+    template<typename MT, typename F>
+    TMLEnableIf_t<TMLIsMatrix_v<MT>, void> MLReduceOperand(const MT& mat, F&& f)
+    {
+      constexpr bool rowMajor = TMLMatrixIsRowMajor_v<MT>;
+      f(MLElementwiseOperand<rowMajor>(mat), TMLBooleanConstant<rowMajor>());
+    }
+    template<typename ExT, typename F>
+    TMLEnableIf_t<TMLIsReduceFusable_v<ExT>, void> MLReduceOperand(const ExT& expr, F&& f)
+    {
+      constexpr bool rowMajor = TMLMatrixIsRowMajor_v<TMLMatrixExpressionResultType_t<ExT>>;
+      f(expr.template Operand<rowMajor>(), TMLBooleanConstant<rowMajor>());
+    }
+    template<typename ExT, typename F>
+    TMLEnableIf_t<TMLIsMatrixExpression_v<ExT> && !TMLIsReduceFusable_v<ExT>, void> MLReduceOperand(const ExT& expr, F&& f)
+    {
+      const TMLMatrixExpressionTemporary_t<ExT> tmp(expr);
+      MLReduceOperand(tmp, f);
+    }
+
+    // Reduction of all elements of a matrix or an expression
+    template<typename Op, typename MT>
+    auto MLReduce(const MT& mat)
+    {
+      using ET = TMLReduceElementType_t<Op, TMLMatrixElementType_t<TMLMatrixExpressionResultType_t<MT>>>;
+      ET res{};
+      MLReduceOperand(mat, [&](const auto& x, auto rowMajor) {
+        using SIMD = typename std::decay_t<decltype(x)>::SIMDType;
+        const std::size_t lines = decltype(rowMajor)::value ? mat.Rows() : mat.Cols();
+        const std::size_t length = decltype(rowMajor)::value ? mat.Cols() : mat.Rows();
+        res = MLReduceValue<ET>(TMLReduceKernel<Op, SIMD>::Reduce(x, lines, length));
+      });
+      return res;
+    }
+
+    // Position of the extreme of all elements
+    template<typename Op, typename MT>
+    SMLMatrixIndex MLArgReduce(const MT& mat)
+    {
+      SMLMatrixIndex res{ 0, 0 };
+      MLReduceOperand(mat, [&](const auto& x, auto rowMajor) {
+        using SIMD = typename std::decay_t<decltype(x)>::SIMDType;
+        constexpr bool rm = decltype(rowMajor)::value;
+        std::size_t line = 0, pos = 0;
+        TMLArgReduceKernel<Op, SIMD>::Find(line, pos, x, rm ? mat.Rows() : mat.Cols(), rm ? mat.Cols() : mat.Rows());
+        res = rm ? SMLMatrixIndex{ line, pos } : SMLMatrixIndex{ pos, line };
+      });
+      return res;
+    }
+  }
+
+  // Reduction of every row or every column of a dense matrix (MLSum<EMLReduction::Rowwise>(m), MLMax<...>(m),
+  // see below). The lines of the matrix are reduced with independent SIMD accumulators and a horizontal reduction
+  // at the end, the elements across the lines (e.g. the columns of a row-major matrix) in a row of accumulators
+  // that is updated line by line. Either way every element is read once and in the order of the storage.
+  template<typename M1, typename OP, bool rowwise>
+  class TMLDMReduceExpression : public TMLMatrixExpression<TMLDMReduceExpression<M1, OP, rowwise>>
+  {
+    template<EMLReduction D, typename M, typename> friend auto MLSum(const M& mat);
+    template<EMLReduction D, typename M, typename> friend auto MLCompensatedSum(const M& mat);
+    template<EMLReduction D, typename M, typename> friend auto MLProd(const M& mat);
+    template<EMLReduction D, typename M, typename> friend auto MLSquaredNorm(const M& mat);
+    template<EMLReduction D, typename M, typename> friend auto MLMaxAbs(const M& mat);
+    template<EMLReduction D, typename M, typename> friend auto MLMin(const M& mat);
+    template<EMLReduction D, typename M, typename> friend auto MLMax(const M& mat);
+    template<EMLReduction D, typename M, typename> friend auto MLArgMin(const M& mat);
+    template<EMLReduction D, typename M, typename> friend auto MLArgMax(const M& mat);
+
+  public:
+    using MyT = TMLDMReduceExpression<M1, OP, rowwise>;
+    using LOpType = TMLDecayCRTP_t<M1>;
+    using LOpResType = TMLMatrixExpressionResultType_t<LOpType>;
+    using OperationType = OP;
+
+    using ValueType = TMLMatrixElementType_t<LOpResType>;
+    using ElementType = Internal::TMLReduceElementType_t<OperationType, ValueType>;
+    using ResultType = TMLMatrixReduceResult_t<LOpResType, rowwise, ElementType>;
+    using SIMDType = TMLMatrixSIMDType_t<ResultType>;
+
+    explicit TMLDMReduceExpression(const M1& mat)
+    : m_mat(~mat) { }
+
+  private:
+    // Make copy/move private in order to prevent direct assignment of an expression
+    TMLDMReduceExpression(const MyT&) = default;
+    TMLDMReduceExpression(MyT&&) noexcept = default;
+    MyT& operator=(const MyT&) = default;
+    MyT& operator=(MyT&&) noexcept = default;
+  public:
+
+    constexpr std::size_t Rows() const noexcept { return rowwise ? (~m_mat).Rows() : 1; }
+    constexpr std::size_t Cols() const noexcept { return rowwise ? 1 : (~m_mat).Cols(); }
+
+    ElementType operator()(std::size_t i, std::size_t j) const noexcept;
+
+    template<typename MT, typename=LOpResType>
+    void AssignTo(TMLDenseMatrix<MT>& res) const;
+
+  public:
+    template<typename MT, typename Operand, bool rowMajor>
+    void Evaluate(TMLDenseMatrix<MT>& res, const Operand& x, TMLBooleanConstant<rowMajor>) const;
+
+    const LOpType& m_mat;
+  };
+
+  // Sum of all elements or of every row / column
+  template<typename MT, typename=TMLEnableIf_t<TMLMatrixIsDense_v<TMLMatrixExpressionResultType_t<MT>>>>
+  auto MLSum(const MT& mat) { return Internal::MLReduce<Internal::SMLReduceAdd>(mat); }
+  template<EMLReduction D, typename MT, typename=TMLEnableIf_t<TMLMatrixIsDense_v<TMLMatrixExpressionResultType_t<MT>>>>
+  auto MLSum(const MT& mat) { return TMLDMReduceExpression<MT, Internal::SMLReduceAdd, D == EMLReduction::Rowwise>(mat); }
+
+  // Sum with compensation of the rounding errors (see Internal::SMLReduceCompensatedAdd)
+  template<typename MT, typename=TMLEnableIf_t<TMLMatrixIsDense_v<TMLMatrixExpressionResultType_t<MT>>>>
+  auto MLCompensatedSum(const MT& mat) { return Internal::MLReduce<Internal::SMLReduceCompensatedAdd>(mat); }
+  template<EMLReduction D, typename MT, typename=TMLEnableIf_t<TMLMatrixIsDense_v<TMLMatrixExpressionResultType_t<MT>>>>
+  auto MLCompensatedSum(const MT& mat) { return TMLDMReduceExpression<MT, Internal::SMLReduceCompensatedAdd, D == EMLReduction::Rowwise>(mat); }
+
+  // Product of the elements
+  template<typename MT, typename=TMLEnableIf_t<TMLMatrixIsDense_v<TMLMatrixExpressionResultType_t<MT>>>>
+  auto MLProd(const MT& mat) { return Internal::MLReduce<Internal::SMLReduceMul>(mat); }
+  template<EMLReduction D, typename MT, typename=TMLEnableIf_t<TMLMatrixIsDense_v<TMLMatrixExpressionResultType_t<MT>>>>
+  auto MLProd(const MT& mat) { return TMLDMReduceExpression<MT, Internal::SMLReduceMul, D == EMLReduction::Rowwise>(mat); }
+
+  // Sum of the squared magnitudes of the elements (real for complex matrices)
+  template<typename MT, typename=TMLEnableIf_t<TMLMatrixIsDense_v<TMLMatrixExpressionResultType_t<MT>>>>
+  auto MLSquaredNorm(const MT& mat) { return Internal::MLReduce<Internal::SMLReduceSquaredNorm>(mat); }
+  template<EMLReduction D, typename MT, typename=TMLEnableIf_t<TMLMatrixIsDense_v<TMLMatrixExpressionResultType_t<MT>>>>
+  auto MLSquaredNorm(const MT& mat) { return TMLDMReduceExpression<MT, Internal::SMLReduceSquaredNorm, D == EMLReduction::Rowwise>(mat); }
+
+  // Frobenius norm
+  template<typename MT, typename=TMLEnableIf_t<TMLMatrixIsDense_v<TMLMatrixExpressionResultType_t<MT>>>>
+  auto MLNorm(const MT& mat) { return std::sqrt(MLSquaredNorm(mat)); }
+
+  // Largest absolute value of the elements
+  template<typename MT, typename=TMLEnableIf_t<Internal::TMLIsRealDenseMatrix_v<MT>>>
+  auto MLMaxAbs(const MT& mat) { return Internal::MLReduce<Internal::SMLReduceMaxAbs>(mat); }
+  template<EMLReduction D, typename MT, typename=TMLEnableIf_t<Internal::TMLIsRealDenseMatrix_v<MT>>>
+  auto MLMaxAbs(const MT& mat) { return TMLDMReduceExpression<MT, Internal::SMLReduceMaxAbs, D == EMLReduction::Rowwise>(mat); }
+
+  // Smallest and largest element (NaNs are not treated specially)
+  template<typename MT, typename=TMLEnableIf_t<Internal::TMLIsRealDenseMatrix_v<MT>>>
+  auto MLMin(const MT& mat) { return Internal::MLReduce<Internal::SMLReduceMin>(mat); }
+  template<EMLReduction D, typename MT, typename=TMLEnableIf_t<Internal::TMLIsRealDenseMatrix_v<MT>>>
+  auto MLMin(const MT& mat) { return TMLDMReduceExpression<MT, Internal::SMLReduceMin, D == EMLReduction::Rowwise>(mat); }
+
+  template<typename MT, typename=TMLEnableIf_t<Internal::TMLIsRealDenseMatrix_v<MT>>>
+  auto MLMax(const MT& mat) { return Internal::MLReduce<Internal::SMLReduceMax>(mat); }
+  template<EMLReduction D, typename MT, typename=TMLEnableIf_t<Internal::TMLIsRealDenseMatrix_v<MT>>>
+  auto MLMax(const MT& mat) { return TMLDMReduceExpression<MT, Internal::SMLReduceMax, D == EMLReduction::Rowwise>(mat); }
+
+  // Position of the first smallest / largest element (the column of every row or the row of every column
+  // for the directional variants)
+  template<typename MT, typename=TMLEnableIf_t<Internal::TMLIsRealDenseMatrix_v<MT>>>
+  SMLMatrixIndex MLArgMin(const MT& mat) { return Internal::MLArgReduce<Internal::SMLReduceMin>(mat); }
+  template<EMLReduction D, typename MT, typename=TMLEnableIf_t<Internal::TMLIsRealDenseMatrix_v<MT>>>
+  auto MLArgMin(const MT& mat)
+    { return TMLDMReduceExpression<MT, Internal::TMLArgReduce<Internal::SMLReduceMin>, D == EMLReduction::Rowwise>(mat); }
+
+  template<typename MT, typename=TMLEnableIf_t<Internal::TMLIsRealDenseMatrix_v<MT>>>
+  SMLMatrixIndex MLArgMax(const MT& mat) { return Internal::MLArgReduce<Internal::SMLReduceMax>(mat); }
+  template<EMLReduction D, typename MT, typename=TMLEnableIf_t<Internal::TMLIsRealDenseMatrix_v<MT>>>
+  auto MLArgMax(const MT& mat)
+    { return TMLDMReduceExpression<MT, Internal::TMLArgReduce<Internal::SMLReduceMax>, D == EMLReduction::Rowwise>(mat); }
+
+  // Dot product of the elements of two matrices of the same shape (reduced without a temporary)
+  template<typename ML, typename MR>
+  auto MLDot(const ML& lhs, const MR& rhs) { return MLSum(lhs % rhs); }
+
+  template<typename M1, typename OP, bool rowwise> typename TMLDMReduceExpression<M1, OP, rowwise>::ElementType
+    TMLDMReduceExpression<M1, OP, rowwise>::operator()(std::size_t i, std::size_t j) const noexcept
+  {
+    assert(i < Rows());
+    assert(j < Cols());
+
+    using Dispatch = Internal::TMLReduceDispatch<OperationType, SIMDType>;
+    if (rowwise)
+      return Internal::MLReduceValue<ElementType>(
+        Dispatch::template Elements<ValueType>([&](std::size_t k) { return (~m_mat)(i, k); }, (~m_mat).Cols()));
+    else
+      return Internal::MLReduceValue<ElementType>(
+        Dispatch::template Elements<ValueType>([&](std::size_t k) { return (~m_mat)(k, j); }, (~m_mat).Rows()));
+  }
+
+  template<typename M1, typename OP, bool rowwise>
+  template<typename MT, typename>
+  void TMLDMReduceExpression<M1, OP, rowwise>::AssignTo(TMLDenseMatrix<MT>& res) const
+  {
+    assert((~res).Rows() == Rows());
+    assert((~res).Cols() == Cols());
+
+    // the result of a line is written when the line has been read, other overlaps go through a temporary
+    if (Internal::MLIsElementwiseAlias(~res, m_mat))
+    {
+      const TMLMatrixScratchResult_t<ResultType> tmp(*this);
+      (~res).Assign(tmp);
+      return;
+    }
+
+    Internal::MLReduceOperand(m_mat, [&](const auto& x, auto rowMajor) { Evaluate(res, x, rowMajor); });
+  }
+
+  template<typename M1, typename OP, bool rowwise>
+  template<typename MT, typename Operand, bool rowMajor>
+  void TMLDMReduceExpression<M1, OP, rowwise>::Evaluate(TMLDenseMatrix<MT>& res, const Operand& x, TMLBooleanConstant<rowMajor>) const
+  {
+    using Dispatch = Internal::TMLReduceDispatch<OperationType, typename Operand::SIMDType>;
+    const std::size_t lines = rowMajor ? (~m_mat).Rows() : (~m_mat).Cols();
+    const std::size_t length = rowMajor ? (~m_mat).Cols() : (~m_mat).Rows();
+
+    auto dst = [&](std::size_t k, const auto& value) {
+      if (rowwise)
+        (~res)(k, 0) = Internal::MLReduceValue<TMLMatrixElementType_t<MT>>(value);
+      else
+        (~res)(0, k) = Internal::MLReduceValue<TMLMatrixElementType_t<MT>>(value);
+    };
+
+    // The lines are the rows of a row-major and the columns of a column-major matrix
+    if (rowwise == rowMajor)
+      Dispatch::Lines(dst, x, lines, length);
+    else
+      Dispatch::Across(dst, x, lines, length);
+  }
+
+}
+
+#endif
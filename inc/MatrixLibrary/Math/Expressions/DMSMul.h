@@ -0,0 +1,202 @@
+// Copyright 2021, Philipp Neufeld
+
+#ifndef ML_MATH_Expressions_DMSMul_H_
+#define ML_MATH_Expressions_DMSMul_H_
+
+// Includes
+#include <type_traits>
+#include <cassert>
+
+#include "MatrixExpression.h"
+#include "DMDMElementwise.h"
+#include "../Matrix.h"
+
+#include "../../QTL/EnableIf.h"
+
+namespace ML
+{
+
+  namespace Internal
+  {
+    // Multiplication of SIMD registers by a scalar (node operation of the operand tree)
+    template<typename SIMD>
+    struct TMLElementwiseScale
+    {
+      SIMD scalar;
+      QM_ALWAYS_INLINE SIMD operator()(const SIMD& x) const { return scalar * x; }
+    };
+  }
+
+  // Product of a dense matrix and a scalar (s * m and m * s)
+  template<typename M1, typename ST>
+  class TMLDMSMulExpression : public TMLMatrixExpression<TMLDMSMulExpression<M1, ST>>
+  {
+    template<typename S, typename M, typename>
+    friend TMLDMSMulExpression<M, S> operator*(const S& lhs, const M& rhs);
+    template<typename M, typename S, typename>
+    friend TMLDMSMulExpression<M, S> operator*(const M& lhs, const S& rhs);
+
+  public:
+    using MyT = TMLDMSMulExpression<M1, ST>;
+    using LOpType = TMLDecayCRTP_t<M1>;
+    using LOpResType = TMLMatrixExpressionResultType_t<LOpType>;
+    using LOpTmpType = TMLMatrixExpressionTemporary_t<LOpType>;
+    using ResultType = TMLMatrixCopyResult_t<LOpResType>;
+
+    using ElementType = TMLMatrixElementType_t<LOpResType>;
+    using SIMDType = TMLMatrixSIMDType_t<LOpResType>;
+
+    explicit TMLDMSMulExpression(const M1& mat, const ST& scalar)
+    : m_mat(~mat), m_scalar(static_cast<ElementType>(scalar)) { }
+
+  private:
+    // Make copy/move private in order to prevent direct assignment of an expression
+    TMLDMSMulExpression(const MyT&) = default;
+    TMLDMSMulExpression(MyT&&) noexcept = default;
+    MyT& operator=(const MyT&) = default;
+    MyT& operator=(MyT&&) noexcept = default;
+  public:
+
+    constexpr std::size_t Rows() const noexcept { return (~m_mat).Rows(); }
+    constexpr std::size_t Cols() const noexcept { return (~m_mat).Cols(); }
+
+    ElementType operator()(std::size_t i, std::size_t j) const noexcept;
+
+    template<typename MT, typename=LOpResType>
+    void AssignTo(TMLDenseMatrix<MT>& res) const;
+
+    // Operand tree of the expression for Internal::MLElementwiseKernel
+    template<bool rowMajor>
+    auto Operand() const 
+    { 
+      return Internal::MLElementwiseNode(Internal::TMLElementwiseScale<SIMDType>{ SIMDType::Set1(m_scalar) }, 
+        Internal::MLElementwiseOperand<rowMajor>(m_mat)); 
+    }
+
+    // Does the matrix overlap res at other positions (see Internal::MLIsElementwiseAlias)?
+    template<typename MT>
+    bool IsElementwiseAlias(const MT& res) const noexcept { return Internal::MLIsElementwiseAlias(res, m_mat); }
+
+  public:
+    template<typename SIMD>
+    constexpr static bool IsFusable_v = Internal::TMLIsElementwiseFusable_v<LOpType, SIMD>;
+
+    // A scaled elementwise expression (e.g. 2 * (a - b)) is computed in one pass without temporaries
+    template<typename MT>
+    constexpr static bool IsFused_v =
+      TMLIsMatrixExpression_v<LOpType> &&
+      TMLMatrixIsVectorized_v<MT> &&
+      IsFusable_v<TMLMatrixSIMDType_t<MT>>;
+
+    template<typename C, typename A>
+    constexpr static bool IsVectorizable_v =
+      TMLMatrixIsDense_v<C> &&
+      TMLMatrixIsDense_v<A> &&
+      TMLMatrixIsVectorized_v<C> &&
+      TMLMatrixIsVectorized_v<A> &&
+      TMLMatrixIsSameSIMDType_v<C, A>;
+
+    template<typename MT> TMLEnableIf_t<!IsFused_v<MT>, void> Evaluate(TMLDenseMatrix<MT>& res) const 
+      { const LOpTmpType& mat(m_mat); ExecuteKernel(res, mat); }
+    template<typename MT> TMLEnableIf_t<IsFused_v<MT>, void> Evaluate(TMLDenseMatrix<MT>& res) const { FusedKernel(res); }
+
+    // Selects the right kernel
+    template<typename C, typename A> TMLEnableIf_t<!IsVectorizable_v<C, A>, void>
+      ExecuteKernel(TMLDenseMatrix<C>& c, const TMLDenseMatrix<A>& a) const { DefaultKernel(c, a); }
+    template<typename C, typename A> TMLEnableIf_t<IsVectorizable_v<C, A>, void>
+      ExecuteKernel(TMLDenseMatrix<C>& c, const TMLDenseMatrix<A>& a) const { VectorizedKernel(c, a); }
+
+    template<typename C, typename A>
+    void DefaultKernel(TMLDenseMatrix<C>& c, const TMLDenseMatrix<A>& a) const;
+    template<typename C, typename A, typename=TMLEnableIf_t<IsVectorizable_v<C, A>>>
+    void VectorizedKernel(TMLDenseMatrix<C>& c, const TMLDenseMatrix<A>& a) const;
+    template<typename MT, typename=TMLEnableIf_t<IsFused_v<MT>>>
+    void FusedKernel(TMLDenseMatrix<MT>& res) const;
+
+    const LOpType& m_mat;
+    ElementType m_scalar;
+  };
+
+  // The scalar has to be convertible to the element type of the matrix
+  template<typename ST, typename MT>
+  constexpr bool TMLIsMatrixScalar_v = std::is_convertible<ST, TMLMatrixElementType_t<MT>>::value;
+
+  template<typename ST, typename MR, typename=TMLEnableIf_t<TMLBooleanAnd_v<
+    TMLMatrixIsDense_v<TMLMatrixExpressionResultType_t<MR>>,
+    TMLIsMatrixScalar_v<ST, TMLMatrixExpressionResultType_t<MR>>
+  >>>
+  TMLDMSMulExpression<MR, ST> operator*(const ST& lhs, const MR& rhs)
+  {
+    return TMLDMSMulExpression<MR, ST>(rhs, lhs);
+  }
+
+  template<typename ML, typename ST, typename=TMLEnableIf_t<TMLBooleanAnd_v<
+    TMLMatrixIsDense_v<TMLMatrixExpressionResultType_t<ML>>,
+    TMLIsMatrixScalar_v<ST, TMLMatrixExpressionResultType_t<ML>>
+  >>>
+  TMLDMSMulExpression<ML, ST> operator*(const ML& lhs, const ST& rhs)
+  {
+    return TMLDMSMulExpression<ML, ST>(lhs, rhs);
+  }
+
+  template<typename M1, typename ST> typename TMLDMSMulExpression<M1, ST>::ElementType
+    TMLDMSMulExpression<M1, ST>::operator()(std::size_t i, std::size_t j) const noexcept
+  {
+    assert(i < Rows());
+    assert(j < Cols());
+
+    return m_scalar * (~m_mat)(i, j);
+  }
+
+  template<typename M1, typename ST>
+  template<typename MT, typename>
+  void TMLDMSMulExpression<M1, ST>::AssignTo(TMLDenseMatrix<MT>& res) const
+  {
+    assert((~res).Rows() == (~m_mat).Rows());
+    assert((~res).Cols() == (~m_mat).Cols());
+
+    // scaling can be performed in-place, but not into a view that is shifted against the matrix
+    if (IsElementwiseAlias(~res))
+    {
+      const TMLMatrixScratchResult_t<ResultType> tmp(*this);
+      (~res).Assign(tmp);
+    }
+    else
+    {
+      Evaluate(res);
+    }
+  }
+
+  template<typename M1, typename ST>
+  template<typename C, typename A>
+  void TMLDMSMulExpression<M1, ST>::DefaultKernel(TMLDenseMatrix<C>& c, const TMLDenseMatrix<A>& a) const
+  {
+    for (size_t i = 0; i < (~c).Rows(); i++)
+    {
+      for (size_t j = 0; j < (~c).Cols(); j++)
+      {
+        (~c)(i, j) = m_scalar * (~a)(i, j);
+      }
+    }
+  }
+
+  template<typename M1, typename ST>
+  template<typename C, typename A, typename>
+  void TMLDMSMulExpression<M1, ST>::VectorizedKernel(TMLDenseMatrix<C>& c, const TMLDenseMatrix<A>& a) const
+  {
+    auto operand = Internal::MLElementwiseNode(Internal::TMLElementwiseScale<SIMDType>{ SIMDType::Set1(m_scalar) },
+      Internal::MLElementwiseOperand<TMLMatrixIsRowMajor_v<C>>(~a));
+    Internal::MLElementwiseKernel(~c, operand);
+  }
+
+  template<typename M1, typename ST>
+  template<typename MT, typename>
+  void TMLDMSMulExpression<M1, ST>::FusedKernel(TMLDenseMatrix<MT>& res) const
+  {
+    auto operand = Operand<TMLMatrixIsRowMajor_v<MT>>();
+    Internal::MLElementwiseKernel(~res, operand);
+  }
+
+}
+
+#endif
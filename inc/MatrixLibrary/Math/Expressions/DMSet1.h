@@ -7,6 +7,10 @@
 #include "MatrixExpression.h"
 #include "../Dense/DenseMatrix.h"
 
+#if defined(ML_MATH_RUNTIME_DISPATCH)
+#include "../Kernels/Dispatch.h"
+#endif
+
 namespace ML
 {
   
@@ -18,7 +22,7 @@ namespace ML
     using MyT = TMLDMSet1Expression<MT>;
     using ElementType = TMLMatrixElementType_t<MT>;
     using SIMDType = TMLMatrixSIMDType_t<MT>;
-    using ResultType = TMLDecayMatrixType_t<MT>;
+    using ResultType = TMLMatrixCopyResult_t<MT>;
 
     constexpr TMLDMSet1Expression(ElementType value, std::size_t rows, std::size_t cols) 
       : m_value(value), m_rows(rows), m_cols(cols) { }
@@ -31,6 +35,28 @@ namespace ML
     void AssignTo(MT& res) const;
 
   private:
+#if defined(ML_MATH_RUNTIME_DISPATCH)
+    // Dynamic matrices are filled by the kernel of the instruction set that is selected at runtime
+    template<typename T>
+    constexpr static bool IsDispatched_v = TMLMatrixIsDynamic_v<T> && TMLHasKernelTable_v<ElementType>;
+#else
+    template<typename T>
+    constexpr static bool IsDispatched_v = false;
+#endif
+
+    // Selects the right kernel
+    template<typename T=MT> TMLEnableIf_t<!IsDispatched_v<T>, void>
+      ExecuteKernel(T& res) const { VectorizedKernel(res); }
+#if defined(ML_MATH_RUNTIME_DISPATCH)
+    template<typename T=MT> TMLEnableIf_t<IsDispatched_v<T>, void>
+      ExecuteKernel(T& res) const { DispatchedKernel(res); }
+#endif
+
+    void VectorizedKernel(MT& res) const;
+#if defined(ML_MATH_RUNTIME_DISPATCH)
+    void DispatchedKernel(MT& res) const;
+#endif
+
     std::size_t m_rows;
     std::size_t m_cols;
     ElementType m_value;
@@ -51,17 +77,65 @@ namespace ML
     assert(Rows() == (~res).Rows());
     assert(Cols() == (~res).Cols());
 
+    ExecuteKernel(res);
+  }
+
+  template<typename MT>
+  void TMLDMSet1Expression<MT>::VectorizedKernel(MT& res) const
+  {
     SIMDType reg = SIMDType::Set1(static_cast<ElementType>(this->m_value));
     
-    for (size_t i = 0; i < (~res).Rows(); i++)
+    // SIMD registers span consecutive elements of a row (row-major) or a column (column-major).
+    // The last register of a row/column is stored masked (the padding is not accessed).
+    if (TMLMatrixIsRowMajor_v<MT>)
+    {
+      for (size_t i = 0; i < (~res).Rows(); i++)
+      {
+        size_t j = 0;
+        for (; (j + TMLSIMDSize_v<SIMDType>) <= (~res).Cols(); j += TMLSIMDSize_v<SIMDType>)
+        {
+          (~res).Store(reg, i, j);
+        }
+        if (j < (~res).Cols())
+          (~res).StoreMasked(reg, i, j, (~res).Cols() - j);
+      }
+    }
+    else
     {
-      for (size_t j = 0; j < (~res).Cols(); j += TMLSIMDSize_v<SIMDType>)
+      for (size_t j = 0; j < (~res).Cols(); j++)
       {
-        (~res).Store(reg, i, j);
+        size_t i = 0;
+        for (; (i + TMLSIMDSize_v<SIMDType>) <= (~res).Rows(); i += TMLSIMDSize_v<SIMDType>)
+        {
+          (~res).Store(reg, i, j);
+        }
+        if (i < (~res).Rows())
+          (~res).StoreMasked(reg, i, j, (~res).Rows() - i);
       }
     }
   }
 
+#if defined(ML_MATH_RUNTIME_DISPATCH)
+  template<typename MT>
+  void TMLDMSet1Expression<MT>::DispatchedKernel(MT& res) const
+  {
+    const auto& kernels = MLGetKernelTable<ElementType>();
+
+    // Tightly packed matrices are filled at once, otherwise the padding is skipped
+    const std::size_t outer = TMLMatrixIsRowMajor_v<MT> ? (~res).Rows() : (~res).Cols();
+    const std::size_t inner = TMLMatrixIsRowMajor_v<MT> ? (~res).Cols() : (~res).Rows();
+    if ((~res).Spacing() == inner)
+    {
+      kernels.fill((~res).Data(), static_cast<ElementType>(this->m_value), outer * inner);
+    }
+    else
+    {
+      for (size_t i = 0; i < outer; i++)
+        kernels.fill((~res).Data() + i * (~res).Spacing(), static_cast<ElementType>(this->m_value), inner);
+    }
+  }
+#endif
+
 }
 
 #endif
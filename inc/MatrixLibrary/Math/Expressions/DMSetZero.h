@@ -7,6 +7,10 @@
 #include "MatrixExpression.h"
 #include "../Dense/DenseMatrix.h"
 
+#if defined(ML_MATH_RUNTIME_DISPATCH)
+#include "../Kernels/Dispatch.h"
+#endif
+
 namespace ML
 {
   
@@ -17,7 +21,7 @@ namespace ML
     using MyT = TMLDMSetZeroExpression;
     using ElementType = TMLMatrixElementType_t<MT>;
     using SIMDType = TMLMatrixSIMDType_t<MT>;
-    using ResultType = TMLDecayMatrixType_t<MT>;
+    using ResultType = TMLMatrixCopyResult_t<MT>;
 
     constexpr TMLDMSetZeroExpression(std::size_t rows, std::size_t cols) 
       : m_rows(rows), m_cols(cols) { }
@@ -28,8 +32,30 @@ namespace ML
     ElementType operator()(std::size_t i, std::size_t j) const noexcept;
 
     void AssignTo(MT& res) const;
-  
+
   private:
+#if defined(ML_MATH_RUNTIME_DISPATCH)
+    // Dynamic matrices are filled by the kernel of the instruction set that is selected at runtime
+    template<typename T>
+    constexpr static bool IsDispatched_v = TMLMatrixIsDynamic_v<T> && TMLHasKernelTable_v<ElementType>;
+#else
+    template<typename T>
+    constexpr static bool IsDispatched_v = false;
+#endif
+
+    // Selects the right kernel
+    template<typename T=MT> TMLEnableIf_t<!IsDispatched_v<T>, void>
+      ExecuteKernel(T& res) const { VectorizedKernel(res); }
+#if defined(ML_MATH_RUNTIME_DISPATCH)
+    template<typename T=MT> TMLEnableIf_t<IsDispatched_v<T>, void>
+      ExecuteKernel(T& res) const { DispatchedKernel(res); }
+#endif
+
+    void VectorizedKernel(MT& res) const;
+#if defined(ML_MATH_RUNTIME_DISPATCH)
+    void DispatchedKernel(MT& res) const;
+#endif
+
     std::size_t m_rows;
     std::size_t m_cols;
   };
@@ -49,16 +75,64 @@ namespace ML
     assert(Rows() == (~res).Rows());
     assert(Cols() == (~res).Cols());
 
+    ExecuteKernel(res);
+  }
+
+  template<typename MT>
+  void TMLDMSetZeroExpression<MT>::VectorizedKernel(MT& res) const
+  {
     SIMDType reg = SIMDType::SetZero();
 
-    for (size_t i = 0; i < (~res).Rows(); i++)
+    // SIMD registers span consecutive elements of a row (row-major) or a column (column-major).
+    // The last register of a row/column is stored masked (the padding is not accessed).
+    if (TMLMatrixIsRowMajor_v<MT>)
     {
-      for (size_t j = 0; j < (~res).Cols(); j += TMLSIMDSize_v<SIMDType>)
+      for (size_t i = 0; i < (~res).Rows(); i++)
       {
-        (~res).Store(reg, i, j);
+        size_t j = 0;
+        for (; (j + TMLSIMDSize_v<SIMDType>) <= (~res).Cols(); j += TMLSIMDSize_v<SIMDType>)
+        {
+          (~res).Store(reg, i, j);
+        }
+        if (j < (~res).Cols())
+          (~res).StoreMasked(reg, i, j, (~res).Cols() - j);
       }
     }
+    else
+    {
+      for (size_t j = 0; j < (~res).Cols(); j++)
+      {
+        size_t i = 0;
+        for (; (i + TMLSIMDSize_v<SIMDType>) <= (~res).Rows(); i += TMLSIMDSize_v<SIMDType>)
+        {
+          (~res).Store(reg, i, j);
+        }
+        if (i < (~res).Rows())
+          (~res).StoreMasked(reg, i, j, (~res).Rows() - i);
+      }
+    }
+  }
+
+#if defined(ML_MATH_RUNTIME_DISPATCH)
+  template<typename MT>
+  void TMLDMSetZeroExpression<MT>::DispatchedKernel(MT& res) const
+  {
+    const auto& kernels = MLGetKernelTable<ElementType>();
+
+    // Tightly packed matrices are filled at once, otherwise the padding is skipped
+    const std::size_t outer = TMLMatrixIsRowMajor_v<MT> ? (~res).Rows() : (~res).Cols();
+    const std::size_t inner = TMLMatrixIsRowMajor_v<MT> ? (~res).Cols() : (~res).Rows();
+    if ((~res).Spacing() == inner)
+    {
+      kernels.fill((~res).Data(), ElementType(0), outer * inner);
+    }
+    else
+    {
+      for (size_t i = 0; i < outer; i++)
+        kernels.fill((~res).Data() + i * (~res).Spacing(), ElementType(0), inner);
+    }
   }
+#endif
 
 }
 
@@ -0,0 +1,177 @@
+// Copyright 2021, Philipp Neufeld
+
+#ifndef ML_MATH_Expressions_DMTrans_H_
+#define ML_MATH_Expressions_DMTrans_H_
+
+// Includes
+#include <type_traits>
+#include <utility>
+#include <cassert>
+
+#include "MatrixExpression.h"
+#include "../Matrix.h"
+#include "../Kernels/ElementwiseKernel.h"
+#include "../Kernels/TransposeKernel.h"
+
+#include "../../QTL/EnableIf.h"
+
+namespace ML
+{
+
+  // Transpose of a dense matrix (MLTranspose(m)). Unlike m.Transpose(), which reinterprets the storage of m
+  // with the other layout, the expression is assigned to a matrix of any layout. If both have the same layout,
+  // the elements are moved by the cache-oblivious kernel of Kernels/TransposeKernel.h, otherwise the lines
+  // are copied.
+  template<typename M1>
+  class TMLDMTransExpression : public TMLMatrixExpression<TMLDMTransExpression<M1>>
+  {
+    template<typename M, typename>
+    friend TMLDMTransExpression<M> MLTranspose(const M& mat);
+
+  public:
+    using MyT = TMLDMTransExpression<M1>;
+    using LOpType = TMLDecayCRTP_t<M1>;
+    using LOpResType = TMLMatrixExpressionResultType_t<LOpType>;
+    using LOpTmpType = TMLMatrixExpressionTemporary_t<LOpType>;
+    using ResultType = TMLMatrixTransResult_t<LOpResType>;
+
+    using ElementType = TMLMatrixElementType_t<LOpResType>;
+    using SIMDType = TMLMatrixSIMDType_t<LOpResType>;
+
+    explicit TMLDMTransExpression(const M1& mat)
+    : m_mat(~mat) { }
+
+  private:
+    // Make copy/move private in order to prevent direct assignment of an expression
+    TMLDMTransExpression(const MyT&) = default;
+    TMLDMTransExpression(MyT&&) noexcept = default;
+    MyT& operator=(const MyT&) = default;
+    MyT& operator=(MyT&&) noexcept = default;
+  public:
+
+    constexpr std::size_t Rows() const noexcept { return (~m_mat).Cols(); }
+    constexpr std::size_t Cols() const noexcept { return (~m_mat).Rows(); }
+
+    ElementType operator()(std::size_t i, std::size_t j) const noexcept;
+
+    template<typename MT, typename=LOpResType>
+    void AssignTo(TMLDenseMatrix<MT>& res) const;
+
+  public:
+    template<typename C, typename A>
+    constexpr static bool IsVectorizable_v =
+      TMLMatrixIsDense_v<C> &&
+      TMLMatrixIsDense_v<A> &&
+      TMLMatrixIsVectorized_v<C> &&
+      TMLMatrixIsSameElementType_v<C, A>;
+
+    // Selects the right kernel
+    template<typename C, typename A> TMLEnableIf_t<!IsVectorizable_v<C, A>, void>
+      ExecuteKernel(TMLDenseMatrix<C>& c, const TMLDenseMatrix<A>& a) const { DefaultKernel(c, a); }
+    template<typename C, typename A> TMLEnableIf_t<IsVectorizable_v<C, A>, void>
+      ExecuteKernel(TMLDenseMatrix<C>& c, const TMLDenseMatrix<A>& a) const { VectorizedKernel(c, a); }
+
+    template<typename C, typename A>
+    void DefaultKernel(TMLDenseMatrix<C>& c, const TMLDenseMatrix<A>& a) const;
+    template<typename C, typename A, typename=TMLEnableIf_t<IsVectorizable_v<C, A>>>
+    void VectorizedKernel(TMLDenseMatrix<C>& c, const TMLDenseMatrix<A>& a) const;
+
+    const LOpType& m_mat;
+  };
+
+  template<typename MT, typename=TMLEnableIf_t<TMLMatrixIsDense_v<TMLMatrixExpressionResultType_t<MT>>>>
+  TMLDMTransExpression<MT> MLTranspose(const MT& mat)
+  {
+    return TMLDMTransExpression<MT>(mat);
+  }
+
+  // Transposes the square matrix mat in place (mat = MLTranspose(mat) does the same)
+  template<typename MT>
+  TMLEnableIf_t<!TMLMatrixIsVectorized_v<MT>, void> MLTransposeInPlace(TMLDenseMatrix<MT>& mat)
+  {
+    assert((~mat).Rows() == (~mat).Cols());
+    for (std::size_t i = 0; i < (~mat).Rows(); i++)
+      for (std::size_t j = i + 1; j < (~mat).Cols(); j++)
+        std::swap((~mat)(i, j), (~mat)(j, i));
+  }
+  template<typename MT>
+  TMLEnableIf_t<TMLMatrixIsVectorized_v<MT>, void> MLTransposeInPlace(TMLDenseMatrix<MT>& mat)
+  {
+    assert((~mat).Rows() == (~mat).Cols());
+    Internal::TMLTransposeKernel<TMLMatrixElementType_t<MT>, TMLMatrixSIMDType_t<MT>>::TransposeInPlace(
+      (~mat).Data(), (~mat).Spacing(), (~mat).Rows());
+  }
+
+  template<typename M1> typename TMLDMTransExpression<M1>::ElementType
+    TMLDMTransExpression<M1>::operator()(std::size_t i, std::size_t j) const noexcept
+  {
+    assert(i < Rows());
+    assert(j < Cols());
+
+    return (~m_mat)(j, i);
+  }
+
+  template<typename M1>
+  template<typename MT, typename>
+  void TMLDMTransExpression<M1>::AssignTo(TMLDenseMatrix<MT>& res) const
+  {
+    assert((~res).Rows() == (~m_mat).Cols());
+    assert((~res).Cols() == (~m_mat).Rows());
+
+    const LOpTmpType& mat(m_mat);
+
+    // m = MLTranspose(m) is only possible for square matrices (a dynamic matrix is resized before), 
+    // other overlaps (e.g. views of the same matrix) are transposed into a temporary
+    if (Internal::MLIsSameBlock(res, mat))
+    {
+      MLTransposeInPlace(res);
+    }
+    else if ((~res).IsAlias(mat))
+    {
+      const TMLMatrixScratchResult_t<ResultType> tmp(*this);
+      (~res).Assign(tmp);
+    }
+    else
+    {
+      ExecuteKernel(res, mat);
+    }
+  }
+
+  template<typename M1>
+  template<typename C, typename A>
+  void TMLDMTransExpression<M1>::DefaultKernel(TMLDenseMatrix<C>& c, const TMLDenseMatrix<A>& a) const
+  {
+    for (size_t i = 0; i < (~c).Rows(); i++)
+    {
+      for (size_t j = 0; j < (~c).Cols(); j++)
+      {
+        (~c)(i, j) = (~a)(j, i);
+      }
+    }
+  }
+
+  template<typename M1>
+  template<typename C, typename A, typename>
+  void TMLDMTransExpression<M1>::VectorizedKernel(TMLDenseMatrix<C>& c, const TMLDenseMatrix<A>& a) const
+  {
+    using SIMD = TMLMatrixSIMDType_t<C>;
+    const std::size_t lines = TMLMatrixIsRowMajor_v<A> ? (~a).Rows() : (~a).Cols();
+    const std::size_t length = TMLMatrixIsRowMajor_v<A> ? (~a).Cols() : (~a).Rows();
+
+    // The lines of a are the lines of c if the layouts differ (e.g. rows of a and columns of c)
+    if (TMLMatrixIsRowMajor_v<C> == TMLMatrixIsRowMajor_v<A>)
+    {
+      Internal::TMLTransposeKernel<ElementType, SIMD>::Transpose((~c).Data(), (~c).Spacing(),
+        (~a).Data(), (~a).Spacing(), lines, length);
+    }
+    else
+    {
+      for (std::size_t k = 0; k < lines; k++)
+        Internal::TMLElementwiseKernel<ElementType, SIMD>::Copy((~c).Data() + k * (~c).Spacing(),
+          (~a).Data() + k * (~a).Spacing(), length);
+    }
+  }
+
+}
+
+#endif
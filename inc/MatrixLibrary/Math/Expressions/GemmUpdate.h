@@ -0,0 +1,136 @@
+// Copyright 2021, Philipp Neufeld
+
+#ifndef ML_MATH_Expressions_GemmUpdate_H_
+#define ML_MATH_Expressions_GemmUpdate_H_
+
+// Sums of a matrix product and a matrix (e.g. d = a * b + c or r = b - a * x) are computed by one GEMM
+// whose epilogue adds the matrix (beta != 0) instead of materializing the product and adding it in a 
+// second pass.
+
+// Includes
+#include <type_traits>
+
+#include "MatrixExpression.h"
+#include "../Matrix.h"
+
+#include "../../QTL/EnableIf.h"
+
+namespace ML
+{
+
+  template<typename M1, typename M2>
+  class TMLDMDMMulExpression;
+  template<typename M1, typename ST>
+  class TMLDMSMulExpression;
+
+  namespace Internal
+  {
+    // Product term of the sum (optionally scaled, e.g. 2 * (a * b)). The factors of the product must be
+    // matrices, so that an alias of the result is detected before a copy overwrites it.
+    template<typename T, typename=void>
+    struct TMLGemmUpdateProduct : std::false_type {};
+
+    template<typename M1, typename M2>
+    struct TMLGemmUpdateProduct<TMLDMDMMulExpression<M1, M2>, TMLEnableIf_t<
+      !TMLIsMatrixExpression_v<TMLDecayCRTP_t<M1>> && !TMLIsMatrixExpression_v<TMLDecayCRTP_t<M2>>>> : std::true_type
+    {
+      using ProductType = TMLDMDMMulExpression<M1, M2>;
+      static const ProductType& Product(const ProductType& x) noexcept { return x; }
+      template<typename ET> static ET Factor(const ProductType&) noexcept { return ET(1); }
+    };
+
+    template<typename M, typename ST>
+    struct TMLGemmUpdateProduct<TMLDMSMulExpression<M, ST>, TMLEnableIf_t<
+      TMLGemmUpdateProduct<TMLDecayCRTP_t<M>>::value>> : std::true_type
+    {
+      using InnerType = TMLGemmUpdateProduct<TMLDecayCRTP_t<M>>;
+      using ProductType = typename InnerType::ProductType;
+      static const ProductType& Product(const TMLDMSMulExpression<M, ST>& x) noexcept { return InnerType::Product(x.m_mat); }
+      template<typename ET> static ET Factor(const TMLDMSMulExpression<M, ST>& x) noexcept
+        { return static_cast<ET>(x.m_scalar) * InnerType::template Factor<ET>(x.m_mat); }
+    };
+
+    // Matrix term of the sum (optionally scaled, e.g. 2 * c)
+    template<typename T, typename=void>
+    struct TMLGemmUpdateAddend : std::false_type {};
+
+    template<typename MT>
+    struct TMLGemmUpdateAddend<MT, TMLEnableIf_t<TMLMatrixIsDense_v<MT> && !TMLIsMatrixExpression_v<MT>>> : std::true_type
+    {
+      using MatrixType = MT;
+      static const MatrixType& Matrix(const MT& x) noexcept { return x; }
+      template<typename ET> static ET Factor(const MT&) noexcept { return ET(1); }
+    };
+
+    template<typename M, typename ST>
+    struct TMLGemmUpdateAddend<TMLDMSMulExpression<M, ST>, TMLEnableIf_t<
+      TMLMatrixIsDense_v<TMLDecayCRTP_t<M>> && !TMLIsMatrixExpression_v<TMLDecayCRTP_t<M>>>> : std::true_type
+    {
+      using MatrixType = TMLDecayCRTP_t<M>;
+      static const MatrixType& Matrix(const TMLDMSMulExpression<M, ST>& x) noexcept { return x.m_mat; }
+      template<typename ET> static ET Factor(const TMLDMSMulExpression<M, ST>& x) noexcept { return static_cast<ET>(x.m_scalar); }
+    };
+
+    // The product P and the matrix C of the sum assigned to MT have the same element type
+    template<typename MT, typename P, typename C, typename=void>
+    struct TMLIsGemmUpdateTerms : std::false_type {};
+    template<typename MT, typename P, typename C>
+    struct TMLIsGemmUpdateTerms<MT, P, C, TMLEnableIf_t<TMLGemmUpdateProduct<P>::value && TMLGemmUpdateAddend<C>::value>>
+      : std::integral_constant<bool,
+        TMLMatrixIsDense_v<MT> &&
+        TMLMatrixIsSameElementType_v<MT, typename TMLGemmUpdateProduct<P>::ProductType::ResultType> &&
+        TMLMatrixIsSameElementType_v<MT, typename TMLGemmUpdateAddend<C>::MatrixType>> {};
+
+    template<typename MT, typename L, typename R>
+    constexpr bool TMLIsGemmUpdate_v = TMLIsGemmUpdateTerms<MT, L, R>::value || TMLIsGemmUpdateTerms<MT, R, L>::value;
+
+    // The epilogue reads a matrix of the layout of the result directly (see TMLGemmEpilogue::source). A matrix 
+    // of the other layout is copied to the result first, which must not be a factor of the product then.
+    template<typename MT, typename P, typename C, typename ET>
+    TMLEnableIf_t<TMLMatrixIsRowMajor_v<MT> == TMLMatrixIsRowMajor_v<C>, bool>
+      MLGemmAccumulate(TMLDenseMatrix<MT>& res, const P& product, ET x, const C& c, ET y)
+    {
+      // The epilogue reads the source tile by tile while the result is written, a source that overlaps
+      // the result at other positions (e.g. a shifted view) is added separately
+      if (MLIsPartialOverlap(res, c))
+        return false;
+      product.AccumulateTo(res, x, y, c);
+      return true;
+    }
+    template<typename MT, typename P, typename C, typename ET>
+    TMLEnableIf_t<TMLMatrixIsRowMajor_v<MT> != TMLMatrixIsRowMajor_v<C>, bool>
+      MLGemmAccumulate(TMLDenseMatrix<MT>& res, const P& product, ET x, const C& c, ET y)
+    {
+      if ((~res).IsAlias(product.m_lhs) || (~res).IsAlias(product.m_rhs))
+        return false;
+      (~res).Assign(c);
+      product.AccumulateTo(res, x, y, ~res);
+      return true;
+    }
+
+    // res = x * p + y * c. Returns false without writing res if the epilogue of the product cannot be
+    // combined with the accumulation.
+    template<typename MT, typename P, typename C, typename ET>
+    bool MLGemmUpdate(TMLDenseMatrix<MT>& res, const P& p, ET x, const C& c, ET y)
+    {
+      x *= TMLGemmUpdateProduct<P>::template Factor<ET>(p);
+      y *= TMLGemmUpdateAddend<C>::template Factor<ET>(c);
+
+      const auto& product = TMLGemmUpdateProduct<P>::Product(p);
+      if (!product.IsAccumulable(x))
+        return false;
+      return MLGemmAccumulate(res, product, x, TMLGemmUpdateAddend<C>::Matrix(c), y);
+    }
+
+    // res = lhs + sign * rhs where one of the operands is the product
+    template<typename MT, typename L, typename R, typename ET>
+    TMLEnableIf_t<TMLIsGemmUpdateTerms<MT, L, R>::value, bool>
+      MLGemmUpdate(TMLDenseMatrix<MT>& res, const L& lhs, const R& rhs, ET sign) { return MLGemmUpdate(res, lhs, ET(1), rhs, sign); }
+    template<typename MT, typename L, typename R, typename ET>
+    TMLEnableIf_t<!TMLIsGemmUpdateTerms<MT, L, R>::value && TMLIsGemmUpdateTerms<MT, R, L>::value, bool>
+      MLGemmUpdate(TMLDenseMatrix<MT>& res, const L& lhs, const R& rhs, ET sign) { return MLGemmUpdate(res, rhs, sign, lhs, ET(1)); }
+  }
+
+}
+
+#endif
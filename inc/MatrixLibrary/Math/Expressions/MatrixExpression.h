@@ -49,12 +49,32 @@ namespace ML
   template<typename ExT>
   using TMLMatrixExpressionResultType_t = typename TMLMatrixExpressionResultType<ExT>::type;
 
+  // Type that holds an operand while an expression is evaluated: matrices are used directly, expressions
+  // are evaluated into a temporary from the scratch arena of the thread
+  template<typename ExT, typename=void>
+  struct TMLMatrixExpressionTemporary;
+  template<typename ExT>
+  struct TMLMatrixExpressionTemporary<ExT, TMLEnableIf_t<TMLIsMatrix_v<ExT>>>
+    : TMLMatrixExpressionResultType<ExT> {};
+  template<typename ExT>
+  struct TMLMatrixExpressionTemporary<ExT, TMLEnableIf_t<TMLIsMatrixExpression_v<ExT>>>
+    : TMLMatrixScratchResult<TMLMatrixExpressionResultType_t<ExT>> {};
+
+  template<typename ExT>
+  using TMLMatrixExpressionTemporary_t = typename TMLMatrixExpressionTemporary<ExT>::type;
+
 }
 
 #include "DMAssign.h"
 #include "DMSetZero.h"
 #include "DMSet1.h"
+#include "DMDMElementwise.h"
 #include "DMDMAdd.h"
 #include "DMDMMul.h"
+#include "DMSMul.h"
+#include "DMTrans.h"
+#include "DMReduce.h"
+#include "DMMap.h"
+#include "DMBroadcast.h"
 
 #endif
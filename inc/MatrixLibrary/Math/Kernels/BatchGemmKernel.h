@@ -0,0 +1,91 @@
+// Copyright 2021, Philipp Neufeld
+
+#ifndef ML_MATH_Kernels_BatchGemmKernel_H_
+#define ML_MATH_Kernels_BatchGemmKernel_H_
+
+// Includes
+#include <type_traits>
+
+#include "../MathPrerequisites.h"
+#include "../SIMD/SIMD.h"
+
+namespace ML
+{
+
+  namespace Internal
+  {
+    // Products C = A * B of packets of SIMDSize_v small matrices in the interleaved layout of TMLMatrixBatch:
+    // the element (i, j) of the N x M matrices of a packet is the (aligned) register at offset (i*M + j)*SIMDSize_v
+    // and lane l of every register belongs to the matrix l. Every product runs in its own lane, i.e. the kernel
+    // needs no shuffles or reductions and all loop bounds are known at compile time.
+    template<typename ET, typename SIMD, std::size_t N, std::size_t K, std::size_t M>
+    struct TMLBatchGemmKernel
+    {
+      static_assert(N > 0 && K > 0 && M > 0, "Empty matrices are not supported");
+
+      using ElementType = ET;
+      using SIMDType = SIMD;
+
+      constexpr static std::size_t SIMDSize_v = TMLSIMDSize_v<SIMDType>;
+
+      // Columns of C per register tile (the tile and one register of A stay in registers)
+      constexpr static std::size_t TileCols_v = M < 4 ? M : 4;
+
+      // Computes the given number of consecutive packets
+      static void Compute(ElementType* c, const ElementType* a, const ElementType* b, std::size_t packets)
+      {
+        for (std::size_t p = 0; p < packets; p++)
+          Packet(c + p * N*M*SIMDSize_v, a + p * N*K*SIMDSize_v, b + p * K*M*SIMDSize_v);
+      }
+
+      QM_ALWAYS_INLINE static void Packet(ElementType* c, const ElementType* a, const ElementType* b)
+      {
+        for (std::size_t i = 0; i < N; i++)
+        {
+          std::size_t j = 0;
+          for (; (j + TileCols_v) <= M; j += TileCols_v)
+            Tile<TileCols_v>(c, a, b, i, j);
+          Remainder(std::integral_constant<std::size_t, M % TileCols_v>(), c, a, b, i, j);
+        }
+      }
+
+    private:
+      // Computes the elements (i, j), ..., (i, j + cols - 1) of C
+      template<std::size_t cols>
+      QM_ALWAYS_INLINE static void Tile(ElementType* c, const ElementType* a, const ElementType* b, std::size_t i, std::size_t j)
+      {
+        SIMDType acc[cols];
+
+        const SIMDType a0 = SIMDType::LoadAligned(a + (i*K) * SIMDSize_v);
+        MLConstexprFor<std::size_t, 0, cols, 1>([&](auto jj) {
+          acc[jj] = a0 * SIMDType::LoadAligned(b + (j + jj) * SIMDSize_v);
+        });
+
+        for (std::size_t k = 1; k < K; k++)
+        {
+          const SIMDType ak = SIMDType::LoadAligned(a + (i*K + k) * SIMDSize_v);
+          MLConstexprFor<std::size_t, 0, cols, 1>([&](auto jj) {
+            acc[jj] = MLSIMDFmadd(ak, SIMDType::LoadAligned(b + (k*M + j + jj) * SIMDSize_v), acc[jj]);
+          });
+        }
+
+        MLConstexprFor<std::size_t, 0, cols, 1>([&](auto jj) {
+          SIMDType::StoreAligned(acc[jj], c + (i*M + j + jj) * SIMDSize_v);
+        });
+      }
+
+      template<std::size_t cols>
+      QM_ALWAYS_INLINE static void Remainder(std::integral_constant<std::size_t, cols>, ElementType* c,
+        const ElementType* a, const ElementType* b, std::size_t i, std::size_t j)
+      {
+        Tile<cols>(c, a, b, i, j);
+      }
+
+      QM_ALWAYS_INLINE static void Remainder(std::integral_constant<std::size_t, 0>, ElementType*,
+        const ElementType*, const ElementType*, std::size_t, std::size_t) { }
+    };
+  }
+
+}
+
+#endif
@@ -0,0 +1,98 @@
+// Copyright 2021, Philipp Neufeld
+
+#ifndef ML_MATH_Kernels_Dispatch_H_
+#define ML_MATH_Kernels_Dispatch_H_
+
+// Runtime dispatch of the hot kernels (enabled by the CMake option ML_RUNTIME_DISPATCH).
+// The kernels are compiled once per instruction set level (kernels/Kernels.cpp) and the
+// level is selected on first use from the features of the cpu. The environment variable
+// ML_SIMD_LEVEL (sse2, avx2, avx512) forces a lower level, e.g. for testing.
+//
+// NOTICE: This header must only depend on the standard library. The kernel translation
+// units include it before they include the rest of the library in a renamed namespace.
+
+// Includes
+#include <cstddef>
+#include <complex>
+#include <type_traits>
+
+#include "GemmEpilogue.h"
+#include "GemmTuning.h"
+
+namespace ML
+{
+
+  // Instruction set levels of the dispatched kernels (ordered)
+  enum class EMLSIMDLevel
+  {
+    SSE2,     // baseline of x86-64
+    AVX2,     // AVX2 + FMA
+    AVX512,   // AVX-512 F + DQ + BW
+  };
+
+  // Level of the kernels that are used by this process
+  EMLSIMDLevel MLGetSIMDLevel();
+  const char* MLGetSIMDLevelName(EMLSIMDLevel level);
+
+  // Element types with dispatched kernels
+  template<typename ET>
+  struct TMLHasKernelTable : std::integral_constant<bool,
+    std::is_same<ET, float>::value || std::is_same<ET, double>::value ||
+    std::is_same<ET, std::complex<float>>::value || std::is_same<ET, std::complex<double>>::value> {};
+
+  template<typename ET>
+  constexpr bool TMLHasKernelTable_v = TMLHasKernelTable<ET>::value;
+
+  // Operand of the dispatched matrix kernels: the element (i, j) is found at data[i*rs + j*cs]
+  template<typename ET>
+  struct TMLKernelView
+  {
+    ET* data;
+    std::size_t rows, cols;
+    std::size_t rs, cs;
+  };
+
+  // Kernels of one instruction set level. The kernels make no assumptions
+  // about the alignment or the padding of their operands.
+  template<typename ET>
+  struct TMLKernelTable
+  {
+    // Register tile of the blocked matrix multiplication (C is partitioned into multiples of it)
+    std::size_t(*gemmMR)();
+    std::size_t(*gemmNR)();
+    // Computes the rows [i0, i1) and the columns [j0, j1) of C = A * B followed by the epilogue 
+    // (see GemmEpilogue.h, C must be row-major, i.e. c.cs == 1)
+    void(*gemm)(const TMLKernelView<ET>& c, const TMLKernelView<const ET>& a, const TMLKernelView<const ET>& b,
+      std::size_t i0, std::size_t i1, std::size_t j0, std::size_t j1, const TMLGemmEpilogue<ET>& epilogue);
+    // Computes C = A * B followed by the epilogue without packing (small products, C must be row-major and b.cs must be 1)
+    void(*gemmUnblocked)(const TMLKernelView<ET>& c, const TMLKernelView<const ET>& a, const TMLKernelView<const ET>& b,
+      const TMLGemmEpilogue<ET>& epilogue);
+    // Parameters of the matrix multiplication of the level (see GemmTuning.h)
+    SMLGemmTuning(*gemmTuning)();
+    void(*setGemmTuning)(const SMLGemmTuning& tuning);
+    SMLGemmTuning(*tuneGemm)(double budget, bool store);
+    // y = alpha * A * x + beta * y and A = alpha * x * y^T + beta * A (the elements of the vectors are incx / incy apart)
+    void(*gemv)(const TMLKernelView<const ET>& a, const ET* x, std::size_t incx, ET* y, std::size_t incy, ET alpha, ET beta);
+    void(*ger)(const TMLKernelView<ET>& a, const ET* x, std::size_t incx, const ET* y, std::size_t incy, ET alpha, ET beta);
+
+    // Element-wise kernels on n consecutive elements (dst may alias the sources)
+    void(*copy)(ET* dst, const ET* src, std::size_t n);
+    void(*fill)(ET* dst, ET value, std::size_t n);
+    void(*add)(ET* dst, const ET* lhs, const ET* rhs, std::size_t n);
+  };
+
+  // Kernel table of the level returned by MLGetSIMDLevel()
+  template<typename ET>
+  const TMLKernelTable<ET>& MLGetKernelTable();
+
+  namespace Internal
+  {
+    // Kernel tables of the individual levels (only defined for the levels that are compiled)
+    template<typename ET> const TMLKernelTable<ET>& MLGetKernelTableSSE2();
+    template<typename ET> const TMLKernelTable<ET>& MLGetKernelTableAVX2();
+    template<typename ET> const TMLKernelTable<ET>& MLGetKernelTableAVX512();
+  }
+
+}
+
+#endif
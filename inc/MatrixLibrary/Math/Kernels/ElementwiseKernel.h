@@ -0,0 +1,58 @@
+// Copyright 2021, Philipp Neufeld
+
+#ifndef ML_MATH_Kernels_ElementwiseKernel_H_
+#define ML_MATH_Kernels_ElementwiseKernel_H_
+
+// Includes
+#include "../MathPrerequisites.h"
+#include "../SIMD/SIMD.h"
+
+namespace ML
+{
+
+  namespace Internal
+  {
+    // Element-wise kernels on n consecutive elements. The kernels make no assumptions
+    // about the alignment of the arrays and process the remainder with masked loads/stores.
+    template<typename ET, typename SIMD>
+    struct TMLElementwiseKernel
+    {
+      using ElementType = ET;
+      using SIMDType = SIMD;
+
+      constexpr static std::size_t SIMDSize_v = TMLSIMDSize_v<SIMDType>;
+
+      static void Copy(ElementType* dst, const ElementType* src, std::size_t n);
+      static void Fill(ElementType* dst, ElementType value, std::size_t n);
+      static void Add(ElementType* dst, const ElementType* lhs, const ElementType* rhs, std::size_t n);
+    };
+
+    template<typename ET, typename SIMD>
+    void TMLElementwiseKernel<ET, SIMD>::Copy(ElementType* dst, const ElementType* src, std::size_t n)
+    {
+      std::size_t i = 0;
+      for (; (i + SIMDSize_v) <= n; i += SIMDSize_v) { SIMDType::StoreUnaligned(SIMDType::LoadUnaligned(src + i), dst + i); }
+      if (i < n) { SIMDType::StoreMasked(SIMDType::LoadMasked(src + i, n - i), dst + i, n - i); }
+    }
+
+    template<typename ET, typename SIMD>
+    void TMLElementwiseKernel<ET, SIMD>::Fill(ElementType* dst, ElementType value, std::size_t n)
+    {
+      const SIMDType reg = SIMDType::Set1(value);
+      std::size_t i = 0;
+      for (; (i + SIMDSize_v) <= n; i += SIMDSize_v) { SIMDType::StoreUnaligned(reg, dst + i); }
+      if (i < n) { SIMDType::StoreMasked(reg, dst + i, n - i); }
+    }
+
+    template<typename ET, typename SIMD>
+    void TMLElementwiseKernel<ET, SIMD>::Add(ElementType* dst, const ElementType* lhs, const ElementType* rhs, std::size_t n)
+    {
+      std::size_t i = 0;
+      for (; (i + SIMDSize_v) <= n; i += SIMDSize_v) { SIMDType::StoreUnaligned(SIMDType::LoadUnaligned(lhs + i) + SIMDType::LoadUnaligned(rhs + i), dst + i); }
+      if (i < n) { SIMDType::StoreMasked(SIMDType::LoadMasked(lhs + i, n - i) + SIMDType::LoadMasked(rhs + i, n - i), dst + i, n - i); }
+    }
+  }
+
+}
+
+#endif
@@ -0,0 +1,48 @@
+// Copyright 2021, Philipp Neufeld
+
+#ifndef ML_MATH_Kernels_GemmEpilogue_H_
+#define ML_MATH_Kernels_GemmEpilogue_H_
+
+// Epilogue of the matrix multiplication. The kernels apply it to each tile of C while the
+// tile is still held in registers, i.e. scaling, bias and activation cost no extra pass over C.
+//
+// NOTICE: This header must only depend on the standard library (see Kernels/Dispatch.h).
+
+// Includes
+#include <cstddef>
+
+namespace ML
+{
+
+  // Activation function of the epilogue (not supported for complex numbers)
+  enum class EMLActivation
+  {
+    None,
+    ReLU,   // max(x, 0)
+    Clamp,  // min(max(x, lo), hi)
+    Tanh,
+  };
+
+  // C = activation(alpha * A * B + beta * S + rowBias + colBias) with the bias vectors broadcast
+  // along the rows and the columns of C, i.e. the element (i, j) gets rowBias[i] + colBias[j].
+  // S is the previous value of C unless a source matrix is given.
+  template<typename ET>
+  struct TMLGemmEpilogue
+  {
+    ET alpha = ET(1);
+    ET beta = ET(0);
+    // One value per row / column of C (nullptr: no bias)
+    const ET* rowBias = nullptr;
+    const ET* colBias = nullptr;
+    // Matrix S of the same shape and layout as C (nullptr: C itself), e.g. D = A * B + C accumulates
+    // into D without copying C first. Line i (a row of a row-major C) starts at source + i * sourceStride.
+    const ET* source = nullptr;
+    std::size_t sourceStride = 0;
+    EMLActivation activation = EMLActivation::None;
+    // Bounds of EMLActivation::Clamp
+    ET lo = ET(0), hi = ET(0);
+  };
+
+}
+
+#endif
@@ -0,0 +1,819 @@
+// Copyright 2021, Philipp Neufeld
+
+#ifndef ML_MATH_Kernels_GemmKernel_H_
+#define ML_MATH_Kernels_GemmKernel_H_
+
+// Includes
+#include <type_traits>
+#include <algorithm>
+#include <utility>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cmath>
+#include <cassert>
+
+#include "../MathPrerequisites.h"
+#include "../SIMD/SIMD.h"
+#include "GemmEpilogue.h"
+#include "GemmTuning.h"
+#include "GemmTuningFile.h"
+
+#include "../../Memory/AlignedAlloc.h"
+#include "../../Memory/ScratchArena.h"
+#include "../../QTL/EnableIf.h"
+#include "../../QTL/TypeList.h"
+
+namespace ML
+{
+
+  namespace Internal
+  {
+    // Clamps value to [lo, hi] and rounds it down to a multiple of mult (lo must not be less than mult)
+    constexpr std::size_t MLGemmBlockSize(std::size_t value, std::size_t mult, std::size_t lo, std::size_t hi)
+    {
+      value = value < lo ? lo : (value > hi ? hi : value);
+      return (value / mult) * mult;
+    }
+
+    // Default block sizes of the cache blocked (GotoBLAS/BLIS) matrix multiplication.
+    // The register tile of C is MR x NR elements. The sizes are chosen such that
+    //  - a KC x NR micro-panel of B occupies half of the L1 cache,
+    //  - a MC x KC block of packed A occupies half of the L2 cache and
+    //  - a KC x NC panel of packed B occupies half of the L3 cache.
+    constexpr std::size_t MLGemmDefaultKC(std::size_t elementSize, std::size_t nr)
+    {
+      return MLGemmBlockSize(ML_MATH_CACHE_L1D_SIZE / 2 / (nr * elementSize), 8, 64, 1024);
+    }
+    constexpr std::size_t MLGemmDefaultMC(std::size_t elementSize, std::size_t kc, std::size_t mr)
+    {
+      return MLGemmBlockSize(ML_MATH_CACHE_L2_SIZE / 2 / (kc * elementSize), mr, mr, 2048);
+    }
+    constexpr std::size_t MLGemmDefaultNC(std::size_t elementSize, std::size_t kc, std::size_t nr)
+    {
+      return MLGemmBlockSize(ML_MATH_CACHE_L3_SIZE / 2 / (kc * elementSize), nr, nr, 4096);
+    }
+
+    template<typename ET, std::size_t MR, std::size_t NR>
+    struct TMLGemmBlocking
+    {
+      constexpr static std::size_t MR_v = MR;
+      constexpr static std::size_t NR_v = NR;
+      constexpr static std::size_t KC_v = MLGemmDefaultKC(sizeof(ET), NR);
+      constexpr static std::size_t MC_v = MLGemmDefaultMC(sizeof(ET), KC_v, MR);
+      constexpr static std::size_t NC_v = MLGemmDefaultNC(sizeof(ET), KC_v, NR);
+    };
+
+    // Register tile of a micro-kernel: MR rows of C times RegsB SIMD registers per row
+    template<std::size_t MR, std::size_t RegsB>
+    struct TMLGemmTile
+    {
+      constexpr static std::size_t MR_v = MR;
+      constexpr static std::size_t RegsB_v = RegsB;
+    };
+
+    // Register tiles of the blocked kernel. The MR_v * RegsB_v accumulators and the RegsB_v registers
+    // holding a row of B must fit into the vector register file. MR_v x RegsB_v is the default tile and
+    // Candidates are the tiles that are compiled for the autotuner (they include the 3 x 4 tile that is
+    // the default of the unblocked kernel).
+    template<typename SIMD, typename=void>
+    struct TMLGemmRegisterTile
+    {
+      // 16 registers (SSE, AVX)
+      constexpr static std::size_t MR_v = 3;
+      constexpr static std::size_t RegsB_v = 4;
+      using Candidates = TMLTypelist<TMLGemmTile<3, 4>, TMLGemmTile<4, 3>, TMLGemmTile<6, 2>, TMLGemmTile<4, 2>>;
+    };
+
+#if defined(ML_MATH_AVX512F)
+    template<typename SIMD>
+    struct TMLGemmRegisterTile<SIMD, TMLEnableIf_t<TMLIsCRTP<SIMD, TMLSIMDAVX512>::value>>
+    {
+      // 32 registers (AVX-512)
+      constexpr static std::size_t MR_v = 6;
+      constexpr static std::size_t RegsB_v = 4;
+      using Candidates = TMLTypelist<TMLGemmTile<6, 4>, TMLGemmTile<8, 3>, TMLGemmTile<4, 6>, 
+        TMLGemmTile<12, 2>, TMLGemmTile<3, 4>, TMLGemmTile<4, 3>>;
+    };
+#endif
+
+    // Rows of the tiles of the unblocked cascade with regsB registers per row: about as many
+    // accumulators as the largest tile of the cascade, but at most 8 rows (regsB == 0: masked tile)
+    constexpr std::size_t MLGemmCascadeRows(std::size_t accumulators, std::size_t regsB)
+    {
+      return regsB == 0 ? MLGemmCascadeRows(accumulators, 1) :
+        (accumulators / regsB < 1 ? 1 : (accumulators / regsB > 8 ? 8 : accumulators / regsB));
+    }
+
+    // Rows of the next smaller tile of the cascade (largest power of two below rows, 0: end)
+    constexpr std::size_t MLGemmCascadeNextRows(std::size_t rows)
+    {
+      std::size_t next = 1;
+      while (2 * next < rows)
+        next *= 2;
+      return rows <= 1 ? 0 : next;
+    }
+
+    // Raw view of a dense matrix operand: the element (i, j) is found at data[i*rs + j*cs].
+    // A column-major matrix is a row-major view of its transpose and vice versa.
+    template<typename ET>
+    struct TMLGemmView
+    {
+      ET* data;
+      std::size_t rows, cols;
+      std::size_t rs, cs;
+
+      constexpr TMLGemmView<ET> Transposed() const noexcept { return { data, cols, rows, cs, rs }; }
+    };
+
+    // Epilogue of one pass of the blocked kernel over a block of K: beta and the source only apply to the
+    // first pass (C holds the partial product afterwards), bias and activation only to the last one
+    template<typename ET>
+    TMLGemmEpilogue<ET> MLGemmPassEpilogue(const TMLGemmEpilogue<ET>& epilogue, bool first, bool last) noexcept
+    {
+      TMLGemmEpilogue<ET> pass = epilogue;
+      if (!first)
+      {
+        pass.beta = ET(1);
+        pass.source = nullptr;
+      }
+      if (!last)
+      {
+        pass.rowBias = pass.colBias = nullptr;
+        pass.activation = EMLActivation::None;
+      }
+      return pass;
+    }
+
+    // Activation of the epilogue for a single element
+    template<typename ET>
+    ET MLGemmActivate(ET x, const TMLGemmEpilogue<ET>& epilogue, std::true_type)
+    {
+      switch (epilogue.activation)
+      {
+      case EMLActivation::ReLU: return std::max(x, ET(0));
+      case EMLActivation::Clamp: return std::min(std::max(x, epilogue.lo), epilogue.hi);
+      case EMLActivation::Tanh: return static_cast<ET>(std::tanh(x));
+      default: return x;
+      }
+    }
+    template<typename ET>
+    ET MLGemmActivate(ET x, const TMLGemmEpilogue<ET>& epilogue, std::false_type)
+    {
+      assert(epilogue.activation == EMLActivation::None);
+      return x;
+    }
+    template<typename ET>
+    ET MLGemmActivate(ET x, const TMLGemmEpilogue<ET>& epilogue)
+    {
+      return MLGemmActivate(x, epilogue, std::is_arithmetic<ET>());
+    }
+
+    // Kernels of the matrix multiplication C = A * B on raw views with a row-major C (i.e. c.cs == 1).
+    // The kernels make no assumptions about the alignment or the padding of the operands.
+    template<typename ET, typename SIMD>
+    struct TMLGemmKernel
+    {
+      using ElementType = ET;
+      using SIMDType = SIMD;
+      using ViewType = TMLGemmView<ElementType>;
+      using ConstViewType = TMLGemmView<const ElementType>;
+      using EpilogueType = TMLGemmEpilogue<ElementType>;
+
+      constexpr static std::size_t SIMDSize_v = TMLSIMDSize_v<SIMDType>;
+
+      // Default register tile and block sizes of the blocked kernel
+      using RegisterTile = TMLGemmRegisterTile<SIMDType>;
+      using Blocking = TMLGemmBlocking<ElementType, RegisterTile::MR_v, RegisterTile::RegsB_v * SIMDSize_v>;
+
+      // Parameters of the kernels (see GemmTuning.h). They are read from the tuning file on first use
+      // and default to RegisterTile, Blocking and a 3 x 4 unblocked tile. Invalid tiles are replaced by
+      // the defaults. SetTuning must not be called while a product is computed.
+      static SMLGemmTuning DefaultTuning() noexcept;
+      static SMLGemmTuning GetTuning() { return State().tuning; }
+      static void SetTuning(const SMLGemmTuning& tuning) { State() = MakeState(tuning); }
+
+      // Benchmarks the candidate tiles and block sizes on this machine (budget: seconds per measurement),
+      // applies the fastest parameters and writes them to the tuning file if store is set
+      static SMLGemmTuning Tune(double budget, bool store);
+
+      // Register tile of the blocked kernel
+      static std::size_t TileRows() { return State().tuning.mr; }
+      static std::size_t TileCols() { return State().tuning.regsB * SIMDSize_v; }
+
+      // Computes the rows [i0, i1) and the columns [j0, j1) of C with the blocked kernel and applies the 
+      // epilogue (see GemmEpilogue.h) to them
+      static void Blocked(const ViewType& c, const ConstViewType& a, const ConstViewType& b,
+        std::size_t i0, std::size_t i1, std::size_t j0, std::size_t j1, const EpilogueType& epilogue);
+
+      // Computes C with a cascade of register tiles that works on the operands directly (no packing).
+      // Meant for small products, B must be contiguous along the rows of C (i.e. b.cs == 1).
+      static void Unblocked(const ViewType& c, const ConstViewType& a, const ConstViewType& b, const EpilogueType& epilogue);
+
+      // Blocked kernel with a MR x regsB register tile and the given block sizes
+      template<std::size_t MR, std::size_t regsB>
+      static void BlockedTile(const ViewType& c, const ConstViewType& a, const ConstViewType& b,
+        std::size_t i0, std::size_t i1, std::size_t j0, std::size_t j1, std::size_t KC, std::size_t MC, std::size_t NC,
+        const EpilogueType& epilogue);
+
+      // Unblocked kernel whose cascade starts with a MR x regsB register tile
+      template<std::size_t MR, std::size_t regsB>
+      static void UnblockedTile(const ViewType& c, const ConstViewType& a, const ConstViewType& b, const EpilogueType& epilogue);
+
+      // Packing of the operands of the blocked kernel (any layout)
+      template<std::size_t MR>
+      static void PackA(const ConstViewType& a, std::size_t ic, std::size_t pc,
+        std::size_t mc, std::size_t kc, ElementType* buffer);
+      template<std::size_t NR>
+      static void PackB(const ConstViewType& b, std::size_t pc, std::size_t jc,
+        std::size_t kc, std::size_t nc, ElementType* buffer);
+
+      // Computes a mc x nc block of C from the packed operands (epilogue: see MLGemmPassEpilogue)
+      template<std::size_t MR, std::size_t regsB>
+      static void MacroKernel(const ViewType& c, std::size_t ic, std::size_t jc, std::size_t mc,
+        std::size_t nc, std::size_t kc, const ElementType* packedA, const ElementType* packedB, const EpilogueType& epilogue);
+
+      // Computes a (regsA x regsB*SIMDSize) tile of C whose row i starts at c + i*ldc. The element (i, p) of A is
+      // read from a[i*aRowStride + p*aColStride] and the row p of the tile of B starts at b + p*bRowStride.
+      // The first element of the tile is the element (i, j) of C (the bias of the epilogue is indexed by it).
+      template<std::size_t regsA, std::size_t regsB>
+      QM_ALWAYS_INLINE static void VectorizedSubKernelRRR(ElementType* c, std::size_t ldc,
+        std::size_t k, const ElementType* a, std::size_t aRowStride, std::size_t aColStride,
+        const ElementType* b, std::size_t bRowStride, const EpilogueType& epilogue, std::size_t i, std::size_t j);
+
+      // Same as VectorizedSubKernelRRR<regsA, 1> for the first n (< SIMDSize_v) columns of the tile. 
+      // B is loaded and C is stored masked, i.e. no element behind the n columns is accessed.
+      template<std::size_t regsA>
+      QM_ALWAYS_INLINE static void MaskedSubKernelRRR(ElementType* c, std::size_t ldc, std::size_t n,
+        std::size_t k, const ElementType* a, std::size_t aRowStride, std::size_t aColStride,
+        const ElementType* b, std::size_t bRowStride, const EpilogueType& epilogue, std::size_t i, std::size_t j);
+
+      // Applies the epilogue to the accumulator of the elements (i, j), ..., (i, j + n - 1) of C and stores 
+      // them to c (n <= SIMDSize_v, a partial register is loaded and stored masked)
+      QM_ALWAYS_INLINE static void StoreTile(SIMDType acc, ElementType* c, std::size_t n, 
+        const EpilogueType& epilogue, std::size_t i, std::size_t j);
+
+    private:
+      // Activation of the epilogue (complex numbers: no activation)
+      static SIMDType Activate(const SIMDType& x, const EpilogueType& epilogue, std::true_type);
+      static SIMDType Activate(const SIMDType& x, const EpilogueType& epilogue, std::false_type);
+
+      using Candidates = typename RegisterTile::Candidates;
+
+      // Current parameters and the indices of their tiles in Candidates
+      struct SState
+      {
+        SMLGemmTuning tuning;
+        std::size_t blockedTile, unblockedTile;
+      };
+
+      static SState& State() { static SState state = MakeState(LoadTuning()); return state; }
+      static SState MakeState(SMLGemmTuning tuning);
+      static SMLGemmTuning LoadTuning();
+
+      // Key of the parameters in the tuning file
+      static std::string TuningKey();
+
+      // Shapes (MR, regsB) of the candidate tiles and the kernels of the candidate with the given index
+      template<typename... Tiles>
+      static std::vector<std::pair<std::size_t, std::size_t>> CandidateTiles(TMLTypelist<Tiles...>);
+      template<typename... Tiles>
+      static void BlockedCandidate(TMLTypelist<Tiles...>, std::size_t tile, const ViewType& c, const ConstViewType& a, 
+        const ConstViewType& b, std::size_t i0, std::size_t i1, std::size_t j0, std::size_t j1, const SMLGemmTuning& tuning,
+        const EpilogueType& epilogue);
+      template<typename... Tiles>
+      static void UnblockedCandidate(TMLTypelist<Tiles...>, std::size_t tile, const ViewType& c, 
+        const ConstViewType& a, const ConstViewType& b, const EpilogueType& epilogue);
+    };
+
+    // Computes the rows [i, m) of a block of C with tiles of rows, then rows/2, ... and finally one row of 
+    // regsB registers per row (regsB == 0: one register of which the first n columns are stored masked).
+    // The block starts at the column j of C.
+    template<typename Kernel, std::size_t rows, std::size_t regsB>
+    struct TMLGemmRowCascade
+    {
+      using ET = typename Kernel::ElementType;
+      using EpilogueType = typename Kernel::EpilogueType;
+
+      QM_ALWAYS_INLINE static void Compute(std::size_t i, std::size_t m, std::size_t n, std::size_t k,
+        ET* c, std::size_t ldc, const ET* a, std::size_t ars, std::size_t acs, const ET* b, std::size_t ldb,
+        const EpilogueType& epilogue, std::size_t j)
+      {
+        for (; (i + rows) <= m; i += rows)
+          Tile(std::integral_constant<bool, regsB == 0>(), c + i*ldc, ldc, n, k, a + i*ars, ars, acs, b, ldb, epilogue, i, j);
+        TMLGemmRowCascade<Kernel, MLGemmCascadeNextRows(rows), regsB>::Compute(i, m, n, k, c, ldc, a, ars, acs, b, ldb, epilogue, j);
+      }
+
+      QM_ALWAYS_INLINE static void Tile(std::false_type, ET* c, std::size_t ldc, std::size_t, std::size_t k,
+        const ET* a, std::size_t ars, std::size_t acs, const ET* b, std::size_t ldb, const EpilogueType& epilogue, std::size_t i, std::size_t j)
+      {
+        Kernel::template VectorizedSubKernelRRR<rows, regsB>(c, ldc, k, a, ars, acs, b, ldb, epilogue, i, j);
+      }
+
+      QM_ALWAYS_INLINE static void Tile(std::true_type, ET* c, std::size_t ldc, std::size_t n, std::size_t k,
+        const ET* a, std::size_t ars, std::size_t acs, const ET* b, std::size_t ldb, const EpilogueType& epilogue, std::size_t i, std::size_t j)
+      {
+        Kernel::template MaskedSubKernelRRR<rows>(c, ldc, n, k, a, ars, acs, b, ldb, epilogue, i, j);
+      }
+    };
+
+    template<typename Kernel, std::size_t regsB>
+    struct TMLGemmRowCascade<Kernel, 0, regsB>
+    {
+      template<typename... Args>
+      QM_ALWAYS_INLINE static void Compute(Args&&...) { }
+    };
+
+    // Computes the columns [j, n) of C with blocks of regsB registers, then regsB - 1 registers, ... and finally 
+    // the masked remainder. The tiles have rows rows (below the first level: about accumulators accumulators).
+    template<typename Kernel, std::size_t rows, std::size_t regsB, std::size_t accumulators>
+    struct TMLGemmColumnCascade
+    {
+      static void Compute(std::size_t j, const typename Kernel::ViewType& c, const typename Kernel::ConstViewType& a, 
+        const typename Kernel::ConstViewType& b, const typename Kernel::EpilogueType& epilogue)
+      {
+        constexpr std::size_t width = regsB * Kernel::SIMDSize_v;
+        for (; (j + width) <= c.cols; j += width)
+          TMLGemmRowCascade<Kernel, rows, regsB>::Compute(0, c.rows, width, a.cols, c.data + j, c.rs, a.data, a.rs, a.cs, b.data + j, b.rs, epilogue, j);
+        TMLGemmColumnCascade<Kernel, MLGemmCascadeRows(accumulators, regsB - 1), regsB - 1, accumulators>::Compute(j, c, a, b, epilogue);
+      }
+    };
+
+    template<typename Kernel, std::size_t rows, std::size_t accumulators>
+    struct TMLGemmColumnCascade<Kernel, rows, 0, accumulators>
+    {
+      static void Compute(std::size_t j, const typename Kernel::ViewType& c, const typename Kernel::ConstViewType& a, 
+        const typename Kernel::ConstViewType& b, const typename Kernel::EpilogueType& epilogue)
+      {
+        if (j < c.cols)
+          TMLGemmRowCascade<Kernel, rows, 0>::Compute(0, c.rows, c.cols - j, a.cols, c.data + j, c.rs, a.data, a.rs, a.cs, b.data + j, b.rs, epilogue, j);
+      }
+    };
+
+    template<typename ET, typename SIMD>
+    SMLGemmTuning TMLGemmKernel<ET, SIMD>::DefaultTuning() noexcept
+    {
+      return { RegisterTile::MR_v, RegisterTile::RegsB_v, Blocking::KC_v, Blocking::MC_v, Blocking::NC_v, 3, 4 };
+    }
+
+    template<typename ET, typename SIMD>
+    std::string TMLGemmKernel<ET, SIMD>::TuningKey()
+    {
+#if defined(ML_MATH_FMA)
+      constexpr bool fma = true;
+#else
+      constexpr bool fma = false;
+#endif
+      return MLGetGemmTuningKey(TMLGemmTuningName<ElementType>::Get(), SIMDSize_v * sizeof(ElementType), fma);
+    }
+
+    template<typename ET, typename SIMD>
+    SMLGemmTuning TMLGemmKernel<ET, SIMD>::LoadTuning()
+    {
+      SMLGemmTuning tuning = DefaultTuning();
+      MLReadGemmTuning(TuningKey(), tuning);
+      return tuning;
+    }
+
+    template<typename ET, typename SIMD>
+    typename TMLGemmKernel<ET, SIMD>::SState TMLGemmKernel<ET, SIMD>::MakeState(SMLGemmTuning tuning)
+    {
+      const SMLGemmTuning defaults = DefaultTuning();
+      const auto tiles = CandidateTiles(Candidates());
+      auto findTile = [&](std::size_t mr, std::size_t regsB) { 
+        return static_cast<std::size_t>(std::find(tiles.begin(), tiles.end(), std::make_pair(mr, regsB)) - tiles.begin()); 
+      };
+
+      SState state;
+      state.blockedTile = findTile(tuning.mr, tuning.regsB);
+      if (state.blockedTile == tiles.size())
+      {
+        tuning.mr = defaults.mr;
+        tuning.regsB = defaults.regsB;
+        tuning.kc = tuning.mc = tuning.nc = 0;
+        state.blockedTile = findTile(tuning.mr, tuning.regsB);
+      }
+      state.unblockedTile = findTile(tuning.smallMR, tuning.smallRegsB);
+      if (state.unblockedTile == tiles.size())
+      {
+        tuning.smallMR = defaults.smallMR;
+        tuning.smallRegsB = defaults.smallRegsB;
+        state.unblockedTile = findTile(tuning.smallMR, tuning.smallRegsB);
+      }
+
+      // Block sizes of 0 are replaced by the defaults of the tile, MC and NC are multiples of the tile
+      const std::size_t mr = tuning.mr;
+      const std::size_t nr = tuning.regsB * SIMDSize_v;
+      tuning.kc = tuning.kc == 0 ? MLGemmDefaultKC(sizeof(ElementType), nr) : tuning.kc;
+      tuning.mc = tuning.mc == 0 ? MLGemmDefaultMC(sizeof(ElementType), tuning.kc, mr) : std::max(mr, (tuning.mc / mr) * mr);
+      tuning.nc = tuning.nc == 0 ? MLGemmDefaultNC(sizeof(ElementType), tuning.kc, nr) : std::max(nr, (tuning.nc / nr) * nr);
+      state.tuning = tuning;
+      return state;
+    }
+
+    template<typename ET, typename SIMD>
+    template<typename... Tiles>
+    std::vector<std::pair<std::size_t, std::size_t>> TMLGemmKernel<ET, SIMD>::CandidateTiles(TMLTypelist<Tiles...>)
+    {
+      return { std::make_pair(std::size_t(Tiles::MR_v), std::size_t(Tiles::RegsB_v))... };
+    }
+
+    template<typename ET, typename SIMD>
+    template<typename... Tiles>
+    void TMLGemmKernel<ET, SIMD>::BlockedCandidate(TMLTypelist<Tiles...>, std::size_t tile, const ViewType& c, const ConstViewType& a,
+      const ConstViewType& b, std::size_t i0, std::size_t i1, std::size_t j0, std::size_t j1, const SMLGemmTuning& tuning,
+      const EpilogueType& epilogue)
+    {
+      using KernelType = void(*)(const ViewType&, const ConstViewType&, const ConstViewType&, 
+        std::size_t, std::size_t, std::size_t, std::size_t, std::size_t, std::size_t, std::size_t, const EpilogueType&);
+      static const KernelType kernels[] = { &TMLGemmKernel::template BlockedTile<Tiles::MR_v, Tiles::RegsB_v>... };
+      kernels[tile](c, a, b, i0, i1, j0, j1, tuning.kc, tuning.mc, tuning.nc, epilogue);
+    }
+
+    template<typename ET, typename SIMD>
+    template<typename... Tiles>
+    void TMLGemmKernel<ET, SIMD>::UnblockedCandidate(TMLTypelist<Tiles...>, std::size_t tile, const ViewType& c,
+      const ConstViewType& a, const ConstViewType& b, const EpilogueType& epilogue)
+    {
+      using KernelType = void(*)(const ViewType&, const ConstViewType&, const ConstViewType&, const EpilogueType&);
+      static const KernelType kernels[] = { &TMLGemmKernel::template UnblockedTile<Tiles::MR_v, Tiles::RegsB_v>... };
+      kernels[tile](c, a, b, epilogue);
+    }
+
+    template<typename ET, typename SIMD>
+    SMLGemmTuning TMLGemmKernel<ET, SIMD>::Tune(double budget, bool store)
+    {
+      using Clock = std::chrono::steady_clock;
+
+      // Fastest runtime of func within the time budget (at least two runs)
+      auto measure = [budget](auto&& func) {
+        double tmin = 1e300;
+        const auto tstart = Clock::now();
+        for (std::size_t runs = 0; runs < 2 || std::chrono::duration<double>(Clock::now() - tstart).count() < budget; runs++)
+        {
+          const auto ts = Clock::now();
+          func();
+          tmin = std::min(tmin, std::chrono::duration<double>(Clock::now() - ts).count());
+        }
+        return tmin;
+      };
+
+      // Square operands for the blocked kernel (the small products use their upper left corners)
+      const std::size_t size = sizeof(ElementType) <= 4 ? 512 : 384;
+      TMLAlignedArray<ElementType> bufA(size * size, alignof(SIMDType));
+      TMLAlignedArray<ElementType> bufB(size * size, alignof(SIMDType));
+      TMLAlignedArray<ElementType> bufC(size * size, alignof(SIMDType));
+      for (std::size_t i = 0; i < size * size; i++)
+      {
+        bufA.data()[i] = ElementType(1) / static_cast<ElementType>(1 + i % 7);
+        bufB.data()[i] = ElementType(1) / static_cast<ElementType>(1 + i % 5);
+      }
+      const ViewType c{ bufC.data(), size, size, size, 1 };
+      const ConstViewType a{ bufA.data(), size, size, size, 1 };
+      const ConstViewType b{ bufB.data(), size, size, size, 1 };
+
+      const auto tiles = CandidateTiles(Candidates());
+      SMLGemmTuning best = GetTuning();
+      double tbest = 1e300;
+      auto tryBlocked = [&](const SMLGemmTuning& tuning) {
+        const SState state = MakeState(tuning);
+        const double t = measure([&]() { BlockedCandidate(Candidates(), state.blockedTile, c, a, b, 0, size, 0, size, state.tuning, EpilogueType()); });
+        if (t < tbest)
+        {
+          tbest = t;
+          best = state.tuning;
+        }
+      };
+
+      // Register tile of the blocked kernel (with the default block sizes of the tile)
+      for (const auto& tile : tiles)
+      {
+        SMLGemmTuning tuning = best;
+        tuning.mr = tile.first;
+        tuning.regsB = tile.second;
+        tuning.kc = tuning.mc = tuning.nc = 0;
+        tryBlocked(tuning);
+      }
+
+      // Block sizes KC and MC around the defaults of the tile (NC depends on the size of the L3 cache,
+      // which the operands of the benchmark do not exceed)
+      const SMLGemmTuning tileBest = best;
+      for (std::size_t kc : { tileBest.kc / 2, tileBest.kc, 2 * tileBest.kc })
+      {
+        for (std::size_t mc : { tileBest.mc / 4, tileBest.mc / 2, tileBest.mc })
+        {
+          if (kc == tileBest.kc && mc == tileBest.mc)
+            continue;
+          SMLGemmTuning tuning = tileBest;
+          tuning.kc = std::max<std::size_t>(kc, 8);
+          tuning.mc = std::max<std::size_t>(mc, 1);
+          tryBlocked(tuning);
+        }
+      }
+
+      // Largest tile of the unblocked kernel (mean time per multiply-add over several small sizes)
+      double sbest = 1e300;
+      for (const auto& tile : tiles)
+      {
+        SMLGemmTuning tuning = best;
+        tuning.smallMR = tile.first;
+        tuning.smallRegsB = tile.second;
+        const SState state = MakeState(tuning);
+
+        double score = 0.0;
+        for (std::size_t n : { 8, 13, 16, 24, 32, 48, 64 })
+        {
+          const ViewType cs{ bufC.data(), n, n, n, 1 };
+          const ConstViewType as{ bufA.data(), n, n, n, 1 };
+          const ConstViewType bs{ bufB.data(), n, n, n, 1 };
+          const std::size_t reps = std::max<std::size_t>(1, 32768 / (n * n * n));
+          score += measure([&]() { 
+            for (std::size_t r = 0; r < reps; r++) 
+              UnblockedCandidate(Candidates(), state.unblockedTile, cs, as, bs, EpilogueType()); 
+          }) / static_cast<double>(reps * n * n * n);
+        }
+        if (score < sbest)
+        {
+          sbest = score;
+          best.smallMR = state.tuning.smallMR;
+          best.smallRegsB = state.tuning.smallRegsB;
+        }
+      }
+
+      SetTuning(best);
+      if (store)
+        MLWriteGemmTuning(TuningKey(), best);
+      return best;
+    }
+
+    template<typename ET, typename SIMD>
+    void TMLGemmKernel<ET, SIMD>::Blocked(const ViewType& c, const ConstViewType& a,
+      const ConstViewType& b, std::size_t i0, std::size_t i1, std::size_t j0, std::size_t j1, const EpilogueType& epilogue)
+    {
+      const SState& state = State();
+      BlockedCandidate(Candidates(), state.blockedTile, c, a, b, i0, i1, j0, j1, state.tuning, epilogue);
+    }
+
+    template<typename ET, typename SIMD>
+    void TMLGemmKernel<ET, SIMD>::Unblocked(const ViewType& c, const ConstViewType& a, const ConstViewType& b, 
+      const EpilogueType& epilogue)
+    {
+      UnblockedCandidate(Candidates(), State().unblockedTile, c, a, b, epilogue);
+    }
+
+    template<typename ET, typename SIMD>
+    template<std::size_t MR, std::size_t regsB>
+    void TMLGemmKernel<ET, SIMD>::UnblockedTile(const ViewType& c, const ConstViewType& a, const ConstViewType& b, 
+      const EpilogueType& epilogue)
+    {
+      TMLGemmColumnCascade<TMLGemmKernel, MR, regsB, MR * regsB>::Compute(0, c, a, b, epilogue);
+    }
+
+    template<typename ET, typename SIMD>
+    template<std::size_t MR, std::size_t regsB>
+    void TMLGemmKernel<ET, SIMD>::BlockedTile(const ViewType& c, const ConstViewType& a, const ConstViewType& b,
+      std::size_t i0, std::size_t i1, std::size_t j0, std::size_t j1, std::size_t KC, std::size_t MC, std::size_t NC,
+      const EpilogueType& epilogue)
+    {
+      constexpr std::size_t NR = regsB * SIMDSize_v;
+
+      const std::size_t m = i1 - i0;
+      const std::size_t n = j1 - j0;
+      const std::size_t k = a.cols;
+
+      // Buffers for the packed panels (packed panels are padded to full register tiles)
+      const std::size_t mcMax = std::min(MC, MR * ((m + MR - 1) / MR));
+      const std::size_t ncMax = std::min(NC, NR * ((n + NR - 1) / NR));
+      const std::size_t kcMax = std::min(KC, k);
+      TMLScratchArray<ElementType> packedA(mcMax * kcMax, alignof(SIMDType));
+      TMLScratchArray<ElementType> packedB(kcMax * ncMax, alignof(SIMDType));
+
+      for (std::size_t jc = j0; jc < j1; jc += NC)
+      {
+        const std::size_t nc = std::min(NC, j1 - jc);
+        for (std::size_t pc = 0; pc < k; pc += KC)
+        {
+          const std::size_t kc = std::min(KC, k - pc);
+          const EpilogueType pass = MLGemmPassEpilogue(epilogue, pc == 0, pc + kc == k);
+          PackB<NR>(b, pc, jc, kc, nc, packedB.data());
+
+          for (std::size_t ic = i0; ic < i1; ic += MC)
+          {
+            const std::size_t mc = std::min(MC, i1 - ic);
+            PackA<MR>(a, ic, pc, mc, kc, packedA.data());
+            MacroKernel<MR, regsB>(c, ic, jc, mc, nc, kc, packedA.data(), packedB.data(), pass);
+          }
+        }
+      }
+    }
+
+    template<typename ET, typename SIMD>
+    template<std::size_t MR>
+    void TMLGemmKernel<ET, SIMD>::PackA(const ConstViewType& a,
+      std::size_t ic, std::size_t pc, std::size_t mc, std::size_t kc, ElementType* buffer)
+    {
+      // Micro-panels of MR rows are stored column by column
+      for (std::size_t ir = 0; ir < mc; ir += MR)
+      {
+        const std::size_t mr = std::min(MR, mc - ir);
+        const ElementType* panel = a.data + (ic + ir)*a.rs + pc*a.cs;
+        for (std::size_t p = 0; p < kc; p++)
+        {
+          std::size_t r = 0;
+          for (; r < mr; r++) { buffer[r] = panel[r*a.rs + p*a.cs]; }
+          for (; r < MR; r++) { buffer[r] = ElementType(0); }
+          buffer += MR;
+        }
+      }
+    }
+
+    template<typename ET, typename SIMD>
+    template<std::size_t NR>
+    void TMLGemmKernel<ET, SIMD>::PackB(const ConstViewType& b,
+      std::size_t pc, std::size_t jc, std::size_t kc, std::size_t nc, ElementType* buffer)
+    {
+      constexpr std::size_t simdSize = SIMDSize_v;
+
+      // Micro-panels of NR columns are stored row by row
+      for (std::size_t jr = 0; jr < nc; jr += NR)
+      {
+        // Columns beyond the end of B are filled with zeros (the masked load zeroes the rest of its register)
+        const std::size_t nr = jc + jr < b.cols ? std::min(std::min(NR, nc - jr), b.cols - jc - jr) : 0;
+        const ElementType* panel = b.data + pc*b.rs + (jc + jr)*b.cs;
+        for (std::size_t p = 0; p < kc; p++)
+        {
+          std::size_t j = 0;
+          if (b.cs == 1)
+          {
+            for (; (j + simdSize) <= nr; j += simdSize) { SIMDType::StoreAligned(SIMDType::LoadUnaligned(panel + p*b.rs + j), buffer + j); }
+            if (j < nr) { SIMDType::StoreAligned(SIMDType::LoadMasked(panel + p*b.rs + j, nr - j), buffer + j); j += simdSize; }
+          }
+          for (; j < nr; j++) { buffer[j] = panel[p*b.rs + j*b.cs]; }
+          for (; j < NR; j++) { buffer[j] = ElementType(0); }
+          buffer += NR;
+        }
+      }
+    }
+
+    template<typename ET, typename SIMD>
+    template<std::size_t MR, std::size_t regsB>
+    void TMLGemmKernel<ET, SIMD>::MacroKernel(const ViewType& c, std::size_t ic, std::size_t jc,
+      std::size_t mc, std::size_t nc, std::size_t kc, const ElementType* packedA, const ElementType* packedB, const EpilogueType& epilogue)
+    {
+      constexpr std::size_t simdSize = SIMDSize_v;
+      constexpr std::size_t NR = regsB * simdSize;
+
+      for (std::size_t jr = 0; jr < nc; jr += NR)
+      {
+        const std::size_t nr = std::min(NR, nc - jr);
+        const ElementType* pb = packedB + jr*kc;
+
+        for (std::size_t ir = 0; ir < mc; ir += MR)
+        {
+          const std::size_t mr = std::min(MR, mc - ir);
+          const ElementType* pa = packedA + ir*kc;
+          ElementType* pc = c.data + (ic + ir)*c.rs + jc + jr;
+
+          if (mr == MR && nr == NR)
+          {
+            VectorizedSubKernelRRR<MR, regsB>(pc, c.rs, kc, pa, 1, MR, pb, NR, epilogue, ic + ir, jc + jr);
+          }
+          else
+          {
+            // Fringe of the block: the packed panels are padded with zeros to full tiles. The full
+            // kernel computes the tile into a buffer and only the valid part is written to C
+            // (a kernel for every partial tile size would bloat the code and defeat inlining).
+            alignas(SIMDType) ElementType tile[MR * NR];
+            VectorizedSubKernelRRR<MR, regsB>(tile, NR, kc, pa, 1, MR, pb, NR, EpilogueType(), 0, 0);
+            for (std::size_t i = 0; i < mr; i++)
+            {
+              for (std::size_t j = 0; j < nr; j += simdSize)
+              {
+                StoreTile(SIMDType::LoadAligned(tile + i*NR + j), pc + i*c.rs + j, std::min(simdSize, nr - j), 
+                  epilogue, ic + ir + i, jc + jr + j);
+              }
+            }
+          }
+        }
+      }
+    }
+
+    template<typename ET, typename SIMD>
+    template<std::size_t regsA, std::size_t regsB>
+    QM_ALWAYS_INLINE void TMLGemmKernel<ET, SIMD>::VectorizedSubKernelRRR(ElementType* c, std::size_t ldc,
+      std::size_t k, const ElementType* a, std::size_t aRowStride, std::size_t aColStride,
+      const ElementType* b, std::size_t bRowStride, const EpilogueType& epilogue, std::size_t i, std::size_t j)
+    {
+      if (k > 0)
+      {
+        SIMDType csum[regsA][regsB];
+
+        // First p
+        std::size_t p = 0;
+        MLConstexprFor<std::size_t, 0, regsB, 1>([&](auto bi) {
+          auto bb = SIMDType::LoadUnaligned(b + bi * SIMDSize_v);
+          MLConstexprFor<std::size_t, 0, regsA, 1>([&](auto ai) {
+            auto aa = SIMDType::Set1(a[ai * aRowStride]);
+              csum[ai][bi] = aa * bb;
+          });
+        });
+
+        // Rest of ps
+        for (++p; p < k; p++) {
+          MLConstexprFor<std::size_t, 0, regsB, 1>([&](auto bi) {
+            auto bb = SIMDType::LoadUnaligned(b + p * bRowStride + bi * SIMDSize_v);
+            MLConstexprFor<std::size_t, 0, regsA, 1>([&](auto ai) {
+              auto aa = SIMDType::Set1(a[ai * aRowStride + p * aColStride]);
+                csum[ai][bi] = MLSIMDFmadd(aa, bb, csum[ai][bi]);
+            });
+          });
+        }
+
+        // Apply the epilogue and store the results to C.
+        for (std::size_t ai = 0; ai < regsA; ai++) {
+          for (std::size_t bi = 0; bi < regsB; bi++) {
+            StoreTile(csum[ai][bi], c + ai * ldc + bi * SIMDSize_v, SIMDSize_v, epilogue, i + ai, j + bi * SIMDSize_v);
+          }
+        }
+      }
+    }
+
+    template<typename ET, typename SIMD>
+    template<std::size_t regsA>
+    QM_ALWAYS_INLINE void TMLGemmKernel<ET, SIMD>::MaskedSubKernelRRR(ElementType* c, std::size_t ldc, std::size_t n,
+      std::size_t k, const ElementType* a, std::size_t aRowStride, std::size_t aColStride,
+      const ElementType* b, std::size_t bRowStride, const EpilogueType& epilogue, std::size_t i, std::size_t j)
+    {
+      if (k > 0)
+      {
+        SIMDType csum[regsA];
+
+        auto bb = SIMDType::LoadMasked(b, n);
+        MLConstexprFor<std::size_t, 0, regsA, 1>([&](auto ai) {
+          csum[ai] = SIMDType::Set1(a[ai * aRowStride]) * bb;
+        });
+
+        for (std::size_t p = 1; p < k; p++) {
+          bb = SIMDType::LoadMasked(b + p * bRowStride, n);
+          MLConstexprFor<std::size_t, 0, regsA, 1>([&](auto ai) {
+            csum[ai] = MLSIMDFmadd(SIMDType::Set1(a[ai * aRowStride + p * aColStride]), bb, csum[ai]);
+          });
+        }
+
+        for (std::size_t ai = 0; ai < regsA; ai++) {
+          StoreTile(csum[ai], c + ai * ldc, n, epilogue, i + ai, j);
+        }
+      }
+    }
+
+    template<typename ET, typename SIMD>
+    QM_ALWAYS_INLINE void TMLGemmKernel<ET, SIMD>::StoreTile(SIMDType acc, ElementType* c, std::size_t n,
+      const EpilogueType& epilogue, std::size_t i, std::size_t j)
+    {
+      const bool masked = n < SIMDSize_v;
+      if (epilogue.alpha != ElementType(1))
+        acc = SIMDType::Set1(epilogue.alpha) * acc;
+      if (epilogue.beta != ElementType(0))
+      {
+        const ElementType* src = epilogue.source ? epilogue.source + i * epilogue.sourceStride + j : c;
+        const SIMDType old = masked ? SIMDType::LoadMasked(src, n) : SIMDType::LoadUnaligned(src);
+        acc = epilogue.beta == ElementType(1) ? acc + old : MLSIMDFmadd(SIMDType::Set1(epilogue.beta), old, acc);
+      }
+      if (epilogue.rowBias)
+        acc = acc + SIMDType::Set1(epilogue.rowBias[i]);
+      if (epilogue.colBias)
+        acc = acc + (masked ? SIMDType::LoadMasked(epilogue.colBias + j, n) : SIMDType::LoadUnaligned(epilogue.colBias + j));
+      if (epilogue.activation != EMLActivation::None)
+        acc = Activate(acc, epilogue, std::is_arithmetic<ElementType>());
+
+      if (masked)
+        SIMDType::StoreMasked(acc, c, n);
+      else
+        SIMDType::StoreUnaligned(acc, c);
+    }
+
+    template<typename ET, typename SIMD>
+    typename TMLGemmKernel<ET, SIMD>::SIMDType TMLGemmKernel<ET, SIMD>::Activate(const SIMDType& x, 
+      const EpilogueType& epilogue, std::true_type)
+    {
+      switch (epilogue.activation)
+      {
+      case EMLActivation::ReLU: return MLSIMDMax(x, SIMDType::Set1(ElementType(0)));
+      case EMLActivation::Clamp: return MLSIMDMin(MLSIMDMax(x, SIMDType::Set1(epilogue.lo)), SIMDType::Set1(epilogue.hi));
+      case EMLActivation::Tanh: return MLSIMDTanh(x);
+      default: return x;
+      }
+    }
+
+    template<typename ET, typename SIMD>
+    typename TMLGemmKernel<ET, SIMD>::SIMDType TMLGemmKernel<ET, SIMD>::Activate(const SIMDType& x, 
+      const EpilogueType& epilogue, std::false_type)
+    {
+      assert(epilogue.activation == EMLActivation::None);
+      return x;
+    }
+  }
+
+}
+
+#endif
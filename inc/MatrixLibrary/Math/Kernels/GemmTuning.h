@@ -0,0 +1,33 @@
+// Copyright 2021, Philipp Neufeld
+
+#ifndef ML_MATH_Kernels_GemmTuning_H_
+#define ML_MATH_Kernels_GemmTuning_H_
+
+// Parameters of the matrix multiplication kernels that are tuned per machine.
+// The autotuner (MLTuneGemm) benchmarks the candidate register tiles and block sizes
+// and stores the fastest ones in the tuning file, which the kernels read on first use.
+// The path of the file is taken from the environment variable ML_GEMM_TUNING_FILE or
+// from the CMake variable of the same name (no file is used if neither is set).
+//
+// NOTICE: This header must only depend on the standard library (see Kernels/Dispatch.h).
+
+// Includes
+#include <cstddef>
+
+namespace ML
+{
+
+  // Parameters of the matrix multiplication for one element type and SIMD type
+  struct SMLGemmTuning
+  {
+    // Register tile of the blocked kernel: mr rows of C times regsB SIMD registers per row
+    std::size_t mr, regsB;
+    // Block sizes of the blocked kernel (see TMLGemmBlocking)
+    std::size_t kc, mc, nc;
+    // Largest register tile of the cascade of the unblocked kernel (small products)
+    std::size_t smallMR, smallRegsB;
+  };
+
+}
+
+#endif
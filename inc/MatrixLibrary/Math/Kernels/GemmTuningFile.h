@@ -0,0 +1,111 @@
+// Copyright 2021, Philipp Neufeld
+
+#ifndef ML_MATH_Kernels_GemmTuningFile_H_
+#define ML_MATH_Kernels_GemmTuningFile_H_
+
+// Includes
+#include <cstdlib>
+#include <complex>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <sstream>
+
+#include "../MathPrerequisites.h"
+#include "GemmTuning.h"
+
+namespace ML
+{
+
+  namespace Internal
+  {
+    // Name of an element type in the tuning file (nullptr: the parameters of the type are not tuned)
+    template<typename ET> struct TMLGemmTuningName { static const char* Get() noexcept { return nullptr; } };
+    template<> struct TMLGemmTuningName<float> { static const char* Get() noexcept { return "float"; } };
+    template<> struct TMLGemmTuningName<double> { static const char* Get() noexcept { return "double"; } };
+    template<> struct TMLGemmTuningName<std::complex<float>> { static const char* Get() noexcept { return "complex<float>"; } };
+    template<> struct TMLGemmTuningName<std::complex<double>> { static const char* Get() noexcept { return "complex<double>"; } };
+
+    // Key of the parameters in the tuning file, e.g. "float:512fma" (element type, register width in bits, FMA)
+    inline std::string MLGetGemmTuningKey(const char* name, std::size_t registerBytes, bool fma)
+    {
+      if (!name)
+        return std::string();
+      return std::string(name) + ":" + std::to_string(8 * registerBytes) + (fma ? "fma" : "");
+    }
+
+    // Path of the tuning file (empty if there is none)
+    inline std::string MLGetGemmTuningFile()
+    {
+      const char* path = std::getenv("ML_GEMM_TUNING_FILE");
+      if (path)
+        return path;
+#if defined(ML_MATH_GEMM_TUNING_FILE)
+      return ML_MATH_GEMM_TUNING_FILE;
+#else
+      return std::string();
+#endif
+    }
+
+    // The file has one line per key: "<key> mr regsB kc mc nc smallMR smallRegsB" ('#' starts a comment line).
+    // Returns false if the file or the key does not exist (tuning is not changed in that case).
+    inline bool MLReadGemmTuning(const std::string& key, SMLGemmTuning& tuning)
+    {
+      const std::string path = MLGetGemmTuningFile();
+      if (path.empty() || key.empty())
+        return false;
+
+      std::ifstream file(path);
+      std::string line;
+      while (std::getline(file, line))
+      {
+        std::istringstream fields(line);
+        std::string lineKey;
+        SMLGemmTuning t;
+        if ((fields >> lineKey) && lineKey == key &&
+          (fields >> t.mr >> t.regsB >> t.kc >> t.mc >> t.nc >> t.smallMR >> t.smallRegsB))
+        {
+          tuning = t;
+          return true;
+        }
+      }
+      return false;
+    }
+
+    // Replaces the line of key in the tuning file (the other lines are kept)
+    inline bool MLWriteGemmTuning(const std::string& key, const SMLGemmTuning& tuning)
+    {
+      const std::string path = MLGetGemmTuningFile();
+      if (path.empty() || key.empty())
+        return false;
+
+      std::vector<std::string> lines;
+      {
+        std::ifstream file(path);
+        std::string line;
+        while (std::getline(file, line))
+        {
+          std::istringstream fields(line);
+          std::string lineKey;
+          if (!(fields >> lineKey) || lineKey != key)
+            lines.push_back(line);
+        }
+      }
+      if (lines.empty())
+        lines.push_back("# MatrixLibrary GEMM tuning: <type:register bits> mr regsB kc mc nc smallMR smallRegsB");
+
+      std::ostringstream entry;
+      entry << key << " " << tuning.mr << " " << tuning.regsB << " " << tuning.kc << " " << tuning.mc
+        << " " << tuning.nc << " " << tuning.smallMR << " " << tuning.smallRegsB;
+      lines.push_back(entry.str());
+
+      std::ofstream file(path, std::ios::trunc);
+      for (const auto& line : lines)
+        file << line << "\n";
+      return static_cast<bool>(file);
+    }
+  }
+
+}
+
+#endif
@@ -0,0 +1,286 @@
+// Copyright 2021, Philipp Neufeld
+
+#ifndef ML_MATH_Kernels_GemvKernel_H_
+#define ML_MATH_Kernels_GemvKernel_H_
+
+// Includes
+#include <cstddef>
+#include <algorithm>
+
+#include "../MathPrerequisites.h"
+#include "../SIMD/SIMD.h"
+#include "GemmKernel.h"
+
+#include "../../Memory/ScratchArena.h"
+
+namespace ML
+{
+
+  namespace Internal
+  {
+    // Matrix-vector kernels: y = alpha * A * x + beta * y (GEMV) and the rank-1 update A = alpha * x * y^T + beta * A
+    // (GER). The vectors are given by their first element and the distance between consecutive elements. Both
+    // kernels stream the matrix once along its contiguous dimension and keep several rows / columns in flight,
+    // i.e. they are limited by the memory bandwidth. beta == 0 does not read the output.
+    template<typename ET, typename SIMD>
+    struct TMLGemvKernel
+    {
+      using ElementType = ET;
+      using SIMDType = SIMD;
+      using ViewType = TMLGemmView<ElementType>;
+      using ConstViewType = TMLGemmView<const ElementType>;
+
+      constexpr static std::size_t SIMDSize_v = TMLSIMDSize_v<SIMDType>;
+
+      // Rows (row-major A) or columns (column-major A) that are processed at once
+      constexpr static std::size_t Lines_v = 4;
+
+      static void Gemv(const ConstViewType& a, const ElementType* x, std::size_t incx, ElementType* y, std::size_t incy,
+        ElementType alpha, ElementType beta);
+      static void Ger(const ViewType& a, const ElementType* x, std::size_t incx, const ElementType* y, std::size_t incy,
+        ElementType alpha, ElementType beta);
+
+    private:
+      // GEMV with a row-major A (dot products, x contiguous) and with a column-major A (axpy, y contiguous)
+      static void GemvRows(const ConstViewType& a, const ElementType* x, ElementType* y, std::size_t incy,
+        ElementType alpha, ElementType beta);
+      static void GemvCols(const ConstViewType& a, const ElementType* x, std::size_t incx, ElementType* y,
+        ElementType alpha, ElementType beta);
+
+      // v = beta * v (beta == 0: v is not read)
+      static void Scale(ElementType* v, std::size_t n, ElementType beta);
+      // Row i of a row-major A = s * y + beta * (row i) with y contiguous (also used for column-major A)
+      static void Axpby(ElementType* row, std::size_t n, ElementType s, const ElementType* y, ElementType beta);
+
+      // Copies a strided vector into a contiguous buffer (returns v if it is contiguous)
+      static const ElementType* Contiguous(const ElementType* v, std::size_t n, std::size_t inc, TMLScratchArray<ElementType>& buffer)
+      {
+        if (inc == 1)
+          return v;
+        for (std::size_t i = 0; i < n; i++)
+          buffer.data()[i] = v[i * inc];
+        return buffer.data();
+      }
+    };
+
+    template<typename ET, typename SIMD>
+    void TMLGemvKernel<ET, SIMD>::Gemv(const ConstViewType& a, const ElementType* x, std::size_t incx,
+      ElementType* y, std::size_t incy, ElementType alpha, ElementType beta)
+    {
+      const std::size_t m = a.rows;
+      const std::size_t n = a.cols;
+
+      if (a.cs == 1)
+      {
+        TMLScratchArray<ElementType> buffer(incx == 1 ? 0 : n, alignof(SIMDType));
+        GemvRows(a, Contiguous(x, n, incx, buffer), y, incy, alpha, beta);
+      }
+      else if (a.rs == 1)
+      {
+        if (incy == 1)
+        {
+          GemvCols(a, x, incx, y, alpha, beta);
+        }
+        else
+        {
+          // The columns are accumulated into a contiguous copy of y
+          TMLScratchArray<ElementType> buffer(m, alignof(SIMDType));
+          for (std::size_t i = 0; i < m; i++)
+            buffer.data()[i] = beta == ElementType(0) ? ElementType(0) : y[i * incy];
+          GemvCols(a, x, incx, buffer.data(), alpha, beta);
+          for (std::size_t i = 0; i < m; i++)
+            y[i * incy] = buffer.data()[i];
+        }
+      }
+      else
+      {
+        for (std::size_t i = 0; i < m; i++)
+        {
+          ElementType sum = ElementType(0);
+          for (std::size_t j = 0; j < n; j++)
+            sum += a.data[i * a.rs + j * a.cs] * x[j * incx];
+          y[i * incy] = alpha * sum + (beta == ElementType(0) ? ElementType(0) : beta * y[i * incy]);
+        }
+      }
+    }
+
+    template<typename ET, typename SIMD>
+    void TMLGemvKernel<ET, SIMD>::GemvRows(const ConstViewType& a, const ElementType* x, ElementType* y, std::size_t incy,
+      ElementType alpha, ElementType beta)
+    {
+      const std::size_t m = a.rows;
+      const std::size_t n = a.cols;
+      const std::size_t full = (n / SIMDSize_v) * SIMDSize_v;
+
+      // Dot products of Lines_v rows (the last lines may repeat the last row)
+      for (std::size_t i = 0; i < m; i += Lines_v)
+      {
+        const ElementType* rows[Lines_v];
+        for (std::size_t l = 0; l < Lines_v; l++)
+          rows[l] = a.data + std::min(i + l, m - 1) * a.rs;
+
+        SIMDType acc[Lines_v];
+        for (std::size_t l = 0; l < Lines_v; l++)
+          acc[l] = SIMDType::Set1(ElementType(0));
+
+        for (std::size_t j = 0; j < full; j += SIMDSize_v)
+        {
+          const SIMDType xj = SIMDType::LoadUnaligned(x + j);
+          for (std::size_t l = 0; l < Lines_v; l++)
+            acc[l] = MLSIMDFmadd(SIMDType::LoadUnaligned(rows[l] + j), xj, acc[l]);
+        }
+        if (full < n)
+        {
+          const SIMDType xj = SIMDType::LoadMasked(x + full, n - full);
+          for (std::size_t l = 0; l < Lines_v; l++)
+            acc[l] = MLSIMDFmadd(SIMDType::LoadMasked(rows[l] + full, n - full), xj, acc[l]);
+        }
+
+        const std::size_t lines = (m - i) < Lines_v ? (m - i) : Lines_v;
+        for (std::size_t l = 0; l < lines; l++)
+        {
+          ElementType lanes[SIMDSize_v];
+          SIMDType::StoreUnaligned(acc[l], lanes);
+          ElementType sum = lanes[0];
+          for (std::size_t s = 1; s < SIMDSize_v; s++)
+            sum += lanes[s];
+
+          ElementType& yi = y[(i + l) * incy];
+          yi = alpha * sum + (beta == ElementType(0) ? ElementType(0) : beta * yi);
+        }
+      }
+    }
+
+    template<typename ET, typename SIMD>
+    void TMLGemvKernel<ET, SIMD>::GemvCols(const ConstViewType& a, const ElementType* x, std::size_t incx, ElementType* y,
+      ElementType alpha, ElementType beta)
+    {
+      const std::size_t m = a.rows;
+      const std::size_t n = a.cols;
+      const std::size_t full = (m / SIMDSize_v) * SIMDSize_v;
+
+      // y = beta * y, then y += (alpha * x_j) * column j for Lines_v columns at once
+      if (beta != ElementType(1))
+        Scale(y, m, beta);
+
+      std::size_t j = 0;
+      for (; (j + Lines_v) <= n; j += Lines_v)
+      {
+        const ElementType* cols[Lines_v];
+        SIMDType xs[Lines_v];
+        for (std::size_t l = 0; l < Lines_v; l++)
+        {
+          cols[l] = a.data + (j + l) * a.cs;
+          xs[l] = SIMDType::Set1(alpha * x[(j + l) * incx]);
+        }
+
+        for (std::size_t i = 0; i < full; i += SIMDSize_v)
+        {
+          SIMDType yi = SIMDType::LoadUnaligned(y + i);
+          for (std::size_t l = 0; l < Lines_v; l++)
+            yi = MLSIMDFmadd(SIMDType::LoadUnaligned(cols[l] + i), xs[l], yi);
+          SIMDType::StoreUnaligned(yi, y + i);
+        }
+        if (full < m)
+        {
+          SIMDType yi = SIMDType::LoadMasked(y + full, m - full);
+          for (std::size_t l = 0; l < Lines_v; l++)
+            yi = MLSIMDFmadd(SIMDType::LoadMasked(cols[l] + full, m - full), xs[l], yi);
+          SIMDType::StoreMasked(yi, y + full, m - full);
+        }
+      }
+      for (; j < n; j++)
+        Axpby(y, m, alpha * x[j * incx], a.data + j * a.cs, ElementType(1));
+    }
+
+    template<typename ET, typename SIMD>
+    void TMLGemvKernel<ET, SIMD>::Ger(const ViewType& a, const ElementType* x, std::size_t incx,
+      const ElementType* y, std::size_t incy, ElementType alpha, ElementType beta)
+    {
+      const std::size_t m = a.rows;
+      const std::size_t n = a.cols;
+
+      if (a.cs == 1)
+      {
+        TMLScratchArray<ElementType> buffer(incy == 1 ? 0 : n, alignof(SIMDType));
+        const ElementType* yc = Contiguous(y, n, incy, buffer);
+        for (std::size_t i = 0; i < m; i++)
+          Axpby(a.data + i * a.rs, n, alpha * x[i * incx], yc, beta);
+      }
+      else if (a.rs == 1)
+      {
+        // Column j = (alpha * y_j) * x + beta * column j
+        TMLScratchArray<ElementType> buffer(incx == 1 ? 0 : m, alignof(SIMDType));
+        const ElementType* xc = Contiguous(x, m, incx, buffer);
+        for (std::size_t j = 0; j < n; j++)
+          Axpby(a.data + j * a.cs, m, alpha * y[j * incy], xc, beta);
+      }
+      else
+      {
+        for (std::size_t i = 0; i < m; i++)
+        {
+          for (std::size_t j = 0; j < n; j++)
+          {
+            ElementType& aij = a.data[i * a.rs + j * a.cs];
+            aij = alpha * x[i * incx] * y[j * incy] + (beta == ElementType(0) ? ElementType(0) : beta * aij);
+          }
+        }
+      }
+    }
+
+    template<typename ET, typename SIMD>
+    void TMLGemvKernel<ET, SIMD>::Scale(ElementType* v, std::size_t n, ElementType beta)
+    {
+      const SIMDType bv = SIMDType::Set1(beta);
+
+      std::size_t j = 0;
+      if (beta == ElementType(0))
+      {
+        for (; (j + SIMDSize_v) <= n; j += SIMDSize_v)
+          SIMDType::StoreUnaligned(bv, v + j);
+        if (j < n)
+          SIMDType::StoreMasked(bv, v + j, n - j);
+      }
+      else
+      {
+        for (; (j + SIMDSize_v) <= n; j += SIMDSize_v)
+          SIMDType::StoreUnaligned(bv * SIMDType::LoadUnaligned(v + j), v + j);
+        if (j < n)
+          SIMDType::StoreMasked(bv * SIMDType::LoadMasked(v + j, n - j), v + j, n - j);
+      }
+    }
+
+    template<typename ET, typename SIMD>
+    void TMLGemvKernel<ET, SIMD>::Axpby(ElementType* row, std::size_t n, ElementType s, const ElementType* y, ElementType beta)
+    {
+      const SIMDType sv = SIMDType::Set1(s);
+      const SIMDType bv = SIMDType::Set1(beta);
+
+      std::size_t j = 0;
+      if (beta == ElementType(0))
+      {
+        for (; (j + SIMDSize_v) <= n; j += SIMDSize_v)
+          SIMDType::StoreUnaligned(sv * SIMDType::LoadUnaligned(y + j), row + j);
+        if (j < n)
+          SIMDType::StoreMasked(sv * SIMDType::LoadMasked(y + j, n - j), row + j, n - j);
+      }
+      else if (beta == ElementType(1))
+      {
+        for (; (j + SIMDSize_v) <= n; j += SIMDSize_v)
+          SIMDType::StoreUnaligned(MLSIMDFmadd(sv, SIMDType::LoadUnaligned(y + j), SIMDType::LoadUnaligned(row + j)), row + j);
+        if (j < n)
+          SIMDType::StoreMasked(MLSIMDFmadd(sv, SIMDType::LoadMasked(y + j, n - j), SIMDType::LoadMasked(row + j, n - j)), row + j, n - j);
+      }
+      else
+      {
+        for (; (j + SIMDSize_v) <= n; j += SIMDSize_v)
+          SIMDType::StoreUnaligned(MLSIMDFmadd(sv, SIMDType::LoadUnaligned(y + j), bv * SIMDType::LoadUnaligned(row + j)), row + j);
+        if (j < n)
+          SIMDType::StoreMasked(MLSIMDFmadd(sv, SIMDType::LoadMasked(y + j, n - j), bv * SIMDType::LoadMasked(row + j, n - j)), row + j, n - j);
+      }
+    }
+  }
+
+}
+
+#endif
@@ -0,0 +1,425 @@
+// Copyright 2021, Philipp Neufeld
+
+#ifndef ML_MATH_Kernels_ReduceKernel_H_
+#define ML_MATH_Kernels_ReduceKernel_H_
+
+// Includes
+#include <new>
+#include <limits>
+#include <algorithm>
+#include <complex>
+#include <type_traits>
+
+#include "../MathPrerequisites.h"
+#include "../SIMD/SIMD.h"
+#include "../../Memory/ScratchArena.h"
+#include "../../QTL/Type.h"
+#include "../../QTL/EnableIf.h"
+
+namespace ML
+{
+
+  namespace Internal
+  {
+    // Element type of a SIMD register or of an element
+    template<typename T, typename=void>
+    struct TMLReduceLane : TMLType<T> {};
+    template<typename T>
+    struct TMLReduceLane<T, TMLEnableIf_t<TMLIsSIMD_v<T>>> : TMLType<TMLSIMDElementType_t<T>> {};
+
+    template<typename T>
+    using TMLReduceLane_t = typename TMLReduceLane<T>::type;
+
+    // Complex element types (the squared norm of complex elements is real, see MLReduceValue)
+    template<typename T>
+    struct TMLIsComplex : std::false_type {};
+    template<typename T>
+    struct TMLIsComplex<std::complex<T>> : std::true_type {};
+
+    template<typename T>
+    constexpr bool TMLIsComplex_v = TMLIsComplex<T>::value;
+
+    // Conversion of a reduced value to the element type of the result. A complex value that is stored in a real
+    // element (the squared norm) has a zero imaginary part.
+    template<typename To, typename From>
+    QM_ALWAYS_INLINE TMLEnableIf_t<!TMLIsComplex_v<From> || TMLIsComplex_v<To>, To> MLReduceValue(const From& x) { return static_cast<To>(x); }
+    template<typename To, typename From>
+    QM_ALWAYS_INLINE TMLEnableIf_t<TMLIsComplex_v<From> && !TMLIsComplex_v<To>, To> MLReduceValue(const From& x) { return static_cast<To>(x.real()); }
+
+    // The operations below are applied to SIMD registers as well as to elements
+    template<typename T> QM_ALWAYS_INLINE TMLEnableIf_t<TMLIsSIMD_v<T>, T> MLReduceSet1(TMLReduceLane_t<T> x) { return T::Set1(x); }
+    template<typename T> QM_ALWAYS_INLINE TMLEnableIf_t<!TMLIsSIMD_v<T>, T> MLReduceSet1(T x) { return x; }
+    template<typename T> QM_ALWAYS_INLINE TMLEnableIf_t<TMLIsSIMD_v<T>, T> MLReduceMin(const T& a, const T& b) { return MLSIMDMin(a, b); }
+    template<typename T> QM_ALWAYS_INLINE TMLEnableIf_t<!TMLIsSIMD_v<T>, T> MLReduceMin(const T& a, const T& b) { return std::min(a, b); }
+    template<typename T> QM_ALWAYS_INLINE TMLEnableIf_t<TMLIsSIMD_v<T>, T> MLReduceMax(const T& a, const T& b) { return MLSIMDMax(a, b); }
+    template<typename T> QM_ALWAYS_INLINE TMLEnableIf_t<!TMLIsSIMD_v<T>, T> MLReduceMax(const T& a, const T& b) { return std::max(a, b); }
+    template<typename T> QM_ALWAYS_INLINE TMLEnableIf_t<TMLIsSIMD_v<T>, T> MLReduceAbs(const T& a) { return MLSIMDAbs(a); }
+    template<typename T> QM_ALWAYS_INLINE TMLEnableIf_t<!TMLIsSIMD_v<T>, T> MLReduceAbs(const T& a) { return MLScalarAbs(a); }
+    template<typename T> QM_ALWAYS_INLINE TMLEnableIf_t<TMLIsSIMD_v<T>, T> MLReduceFmadd(const T& a, const T& b, const T& c) { return MLSIMDFmadd(a, b, c); }
+    template<typename T> QM_ALWAYS_INLINE TMLEnableIf_t<!TMLIsSIMD_v<T>, T> MLReduceFmadd(const T& a, const T& b, const T& c) { return a * b + c; }
+
+    // acc + |x|^2 (x * x for real elements, the squared magnitude in the real part for complex elements)
+    template<typename T> QM_ALWAYS_INLINE TMLEnableIf_t<!TMLIsComplex_v<TMLReduceLane_t<T>>, T> MLReduceAddSquare(const T& acc, const T& x)
+      { return MLReduceFmadd(x, x, acc); }
+    template<typename T> QM_ALWAYS_INLINE TMLEnableIf_t<TMLIsComplex_v<T>, T> MLReduceAddSquare(const T& acc, const T& x)
+      { return acc + T(std::norm(x)); }
+    template<typename T> QM_ALWAYS_INLINE TMLEnableIf_t<TMLIsSIMD_v<T> && TMLIsComplex_v<TMLReduceLane_t<T>>, T> MLReduceAddSquare(const T& acc, const T& x)
+    {
+      using ET = TMLReduceLane_t<T>;
+      alignas(T) ET tmp[TMLSIMDSize_v<T>];
+      T::StoreAligned(x, tmp);
+      for (std::size_t i = 0; i < TMLSIMDSize_v<T>; i++)
+        tmp[i] = ET(std::norm(tmp[i]));
+      return acc + T::LoadAligned(tmp);
+    }
+
+    // Reductions of the kernels below. An Accumulator<T> holds a partial result of SIMD registers or elements
+    // T. Accumulate adds a register or an element, Combine merges two accumulators, Reduce combines the lanes of
+    // a SIMD accumulator into an element accumulator and Result gives the value of an accumulator. Masked lanes
+    // are loaded as zero, reductions with another identity replace them (ZeroIdentity_v).
+    template<typename Op>
+    struct TMLReduceOperation
+    {
+      template<typename T> using Accumulator = T;
+      template<typename T> QM_ALWAYS_INLINE static T Init() { return MLReduceSet1<T>(Op::template Identity<TMLReduceLane_t<T>>()); }
+      template<typename T> QM_ALWAYS_INLINE static T Result(const T& acc) { return acc; }
+    };
+
+    struct SMLReduceAdd : TMLReduceOperation<SMLReduceAdd>
+    {
+      constexpr static bool ZeroIdentity_v = true;
+      template<typename ET> QM_ALWAYS_INLINE static ET Identity() { return ET(0); }
+      template<typename T> QM_ALWAYS_INLINE static void Accumulate(T& acc, const T& x) { acc = acc + x; }
+      template<typename T> QM_ALWAYS_INLINE static void Combine(T& acc, const T& other) { acc = acc + other; }
+      template<typename SIMD> QM_ALWAYS_INLINE static auto Reduce(const SIMD& acc) { return MLSIMDReduceAdd(acc); }
+    };
+
+    struct SMLReduceMul : TMLReduceOperation<SMLReduceMul>
+    {
+      constexpr static bool ZeroIdentity_v = false;
+      template<typename ET> QM_ALWAYS_INLINE static ET Identity() { return ET(1); }
+      template<typename T> QM_ALWAYS_INLINE static void Accumulate(T& acc, const T& x) { acc = acc * x; }
+      template<typename T> QM_ALWAYS_INLINE static void Combine(T& acc, const T& other) { acc = acc * other; }
+      template<typename SIMD> QM_ALWAYS_INLINE static auto Reduce(const SIMD& acc) { return MLSIMDReduceMul(acc); }
+    };
+
+    // Sum of the squared magnitudes (the squared Frobenius norm)
+    struct SMLReduceSquaredNorm : TMLReduceOperation<SMLReduceSquaredNorm>
+    {
+      constexpr static bool ZeroIdentity_v = true;
+      template<typename ET> QM_ALWAYS_INLINE static ET Identity() { return ET(0); }
+      template<typename T> QM_ALWAYS_INLINE static void Accumulate(T& acc, const T& x) { acc = MLReduceAddSquare(acc, x); }
+      template<typename T> QM_ALWAYS_INLINE static void Combine(T& acc, const T& other) { acc = acc + other; }
+      template<typename SIMD> QM_ALWAYS_INLINE static auto Reduce(const SIMD& acc) { return MLSIMDReduceAdd(acc); }
+    };
+
+    struct SMLReduceMaxAbs : TMLReduceOperation<SMLReduceMaxAbs>
+    {
+      constexpr static bool ZeroIdentity_v = true;
+      template<typename ET> QM_ALWAYS_INLINE static ET Identity() { return ET(0); }
+      template<typename T> QM_ALWAYS_INLINE static void Accumulate(T& acc, const T& x) { acc = MLReduceMax(acc, MLReduceAbs(x)); }
+      template<typename T> QM_ALWAYS_INLINE static void Combine(T& acc, const T& other) { acc = MLReduceMax(acc, other); }
+      template<typename SIMD> QM_ALWAYS_INLINE static auto Reduce(const SIMD& acc) { return MLSIMDReduceMax(acc); }
+    };
+
+    // Minimum and maximum (Exceeds tells if a replaces b as the extreme, see TMLArgReduceKernel)
+    struct SMLReduceMin : TMLReduceOperation<SMLReduceMin>
+    {
+      constexpr static bool ZeroIdentity_v = false;
+      template<typename ET> QM_ALWAYS_INLINE static ET Identity()
+        { return std::numeric_limits<ET>::has_infinity ? std::numeric_limits<ET>::infinity() : std::numeric_limits<ET>::max(); }
+      template<typename T> QM_ALWAYS_INLINE static void Accumulate(T& acc, const T& x) { acc = MLReduceMin(acc, x); }
+      template<typename T> QM_ALWAYS_INLINE static void Combine(T& acc, const T& other) { acc = MLReduceMin(acc, other); }
+      template<typename SIMD> QM_ALWAYS_INLINE static auto Reduce(const SIMD& acc) { return MLSIMDReduceMin(acc); }
+      template<typename ET> QM_ALWAYS_INLINE static bool Exceeds(const ET& a, const ET& b) { return a < b; }
+    };
+
+    struct SMLReduceMax : TMLReduceOperation<SMLReduceMax>
+    {
+      constexpr static bool ZeroIdentity_v = false;
+      template<typename ET> QM_ALWAYS_INLINE static ET Identity()
+        { return std::numeric_limits<ET>::has_infinity ? -std::numeric_limits<ET>::infinity() : std::numeric_limits<ET>::lowest(); }
+      template<typename T> QM_ALWAYS_INLINE static void Accumulate(T& acc, const T& x) { acc = MLReduceMax(acc, x); }
+      template<typename T> QM_ALWAYS_INLINE static void Combine(T& acc, const T& other) { acc = MLReduceMax(acc, other); }
+      template<typename SIMD> QM_ALWAYS_INLINE static auto Reduce(const SIMD& acc) { return MLSIMDReduceMax(acc); }
+      template<typename ET> QM_ALWAYS_INLINE static bool Exceeds(const ET& a, const ET& b) { return a > b; }
+    };
+
+    // Sum with Kahan's compensation: c keeps the low-order bits that were lost in the last addition and
+    // is subtracted from the next summand. The error does not grow with the number of elements (unlike the
+    // plain sum) as long as the compiler does not reassociate floating point operations (-ffast-math).
+    template<typename T>
+    struct TMLKahanSum
+    {
+      T sum, c;
+    };
+
+    struct SMLReduceCompensatedAdd
+    {
+      constexpr static bool ZeroIdentity_v = true;
+      template<typename T> using Accumulator = TMLKahanSum<T>;
+      template<typename ET> QM_ALWAYS_INLINE static ET Identity() { return ET(0); }
+
+      template<typename T> QM_ALWAYS_INLINE static TMLKahanSum<T> Init()
+        { return { MLReduceSet1<T>(TMLReduceLane_t<T>(0)), MLReduceSet1<T>(TMLReduceLane_t<T>(0)) }; }
+      template<typename T> QM_ALWAYS_INLINE static void Accumulate(TMLKahanSum<T>& acc, const T& x)
+      {
+        const T y = x - acc.c;
+        const T t = acc.sum + y;
+        acc.c = (t - acc.sum) - y;
+        acc.sum = t;
+      }
+      template<typename T> QM_ALWAYS_INLINE static void Combine(TMLKahanSum<T>& acc, const TMLKahanSum<T>& other)
+      {
+        Accumulate(acc, other.sum);
+        Accumulate(acc, MLReduceSet1<T>(TMLReduceLane_t<T>(0)) - other.c);
+      }
+      template<typename SIMD> static TMLKahanSum<TMLSIMDElementType_t<SIMD>> Reduce(const TMLKahanSum<SIMD>& acc)
+      {
+        using ET = TMLSIMDElementType_t<SIMD>;
+        TMLKahanSum<ET> res = Init<ET>();
+        for (std::size_t i = 0; i < TMLSIMDSize_v<SIMD>; i++)
+          Combine(res, TMLKahanSum<ET>{ acc.sum[i], acc.c[i] });
+        return res;
+      }
+      template<typename T> QM_ALWAYS_INLINE static T Result(const TMLKahanSum<T>& acc) { return acc.sum - acc.c; }
+    };
+
+    // Number of independent accumulators along a line (hides the latency of the operations)
+    constexpr std::size_t MLReduceAccumulators_v = 4;
+
+    // Reductions of an operand that is read with SIMD registers along its lines (a matrix or a tree of
+    // elementwise operations, see TMLElementwiseOperand). o is the line, n the position in the line.
+    template<typename Op, typename SIMD>
+    struct TMLReduceKernel
+    {
+      using SIMDType = SIMD;
+      using ElementType = TMLSIMDElementType_t<SIMDType>;
+      using Accumulator = typename Op::template Accumulator<SIMDType>;
+
+      constexpr static std::size_t SIMDSize_v = TMLSIMDSize_v<SIMDType>;
+      constexpr static std::size_t Accumulators_v = MLReduceAccumulators_v;
+
+      // Reduction of all elements
+      template<typename Operand>
+      static ElementType Reduce(const Operand& x, std::size_t lines, std::size_t length);
+      // dst(o, r) for the reduction r of every line o
+      template<typename Dst, typename Operand>
+      static void ReduceLines(Dst&& dst, const Operand& x, std::size_t lines, std::size_t length);
+      // dst(n, r) for the reduction r of the elements n of all lines. The lines are read one after the other
+      // into a row of accumulators (which stays in the cache), i.e. the memory is streamed once.
+      template<typename Dst, typename Operand>
+      static void ReduceAcross(Dst&& dst, const Operand& x, std::size_t lines, std::size_t length);
+
+    private:
+      template<typename Operand>
+      QM_ALWAYS_INLINE static void AccumulateLine(Accumulator* acc, const Operand& x, std::size_t o, std::size_t length);
+      QM_ALWAYS_INLINE static ElementType Finish(Accumulator* acc);
+
+      // Replaces the lanes from n on by the identity of the reduction
+      QM_ALWAYS_INLINE static SIMDType Tail(const SIMDType& v, std::size_t n)
+      {
+        if (Op::ZeroIdentity_v)
+          return v;
+        alignas(SIMDType) ElementType tmp[SIMDSize_v];
+        SIMDType::StoreAligned(v, tmp);
+        for (std::size_t i = n; i < SIMDSize_v; i++)
+          tmp[i] = Op::template Identity<ElementType>();
+        return SIMDType::LoadAligned(tmp);
+      }
+    };
+
+    template<typename Op, typename SIMD>
+    template<typename Operand>
+    void TMLReduceKernel<Op, SIMD>::AccumulateLine(Accumulator* acc, const Operand& x, std::size_t o, std::size_t length)
+    {
+      constexpr std::size_t step = Accumulators_v * SIMDSize_v;
+
+      std::size_t n = 0;
+      for (; (n + step) <= length; n += step)
+      {
+        for (std::size_t k = 0; k < Accumulators_v; k++)
+          Op::Accumulate(acc[k], x.Load(o, n + k * SIMDSize_v));
+      }
+      for (std::size_t k = 0; (n + SIMDSize_v) <= length; n += SIMDSize_v, k++)
+        Op::Accumulate(acc[k], x.Load(o, n));
+      if (n < length)
+        Op::Accumulate(acc[Accumulators_v - 1], Tail(x.LoadMasked(o, n, length - n), length - n));
+    }
+
+    template<typename Op, typename SIMD>
+    typename TMLReduceKernel<Op, SIMD>::ElementType TMLReduceKernel<Op, SIMD>::Finish(Accumulator* acc)
+    {
+      for (std::size_t s = 1; s < Accumulators_v; s *= 2)
+        for (std::size_t k = 0; (k + s) < Accumulators_v; k += 2 * s)
+          Op::Combine(acc[k], acc[k + s]);
+      return Op::Result(Op::Reduce(acc[0]));
+    }
+
+    template<typename Op, typename SIMD>
+    template<typename Operand>
+    typename TMLReduceKernel<Op, SIMD>::ElementType TMLReduceKernel<Op, SIMD>::Reduce(
+      const Operand& x, std::size_t lines, std::size_t length)
+    {
+      Accumulator acc[Accumulators_v];
+      for (std::size_t k = 0; k < Accumulators_v; k++)
+        acc[k] = Op::template Init<SIMDType>();
+
+      for (std::size_t o = 0; o < lines; o++)
+        AccumulateLine(acc, x, o, length);
+      return Finish(acc);
+    }
+
+    template<typename Op, typename SIMD>
+    template<typename Dst, typename Operand>
+    void TMLReduceKernel<Op, SIMD>::ReduceLines(Dst&& dst, const Operand& x, std::size_t lines, std::size_t length)
+    {
+      Accumulator acc[Accumulators_v];
+      for (std::size_t o = 0; o < lines; o++)
+      {
+        for (std::size_t k = 0; k < Accumulators_v; k++)
+          acc[k] = Op::template Init<SIMDType>();
+        AccumulateLine(acc, x, o, length);
+        dst(o, Finish(acc));
+      }
+    }
+
+    template<typename Op, typename SIMD>
+    template<typename Dst, typename Operand>
+    void TMLReduceKernel<Op, SIMD>::ReduceAcross(Dst&& dst, const Operand& x, std::size_t lines, std::size_t length)
+    {
+      // Lanes behind the end of the lines accumulate zeros, they are not part of the result
+      const std::size_t full = length / SIMDSize_v;
+      const std::size_t tail = length - full * SIMDSize_v;
+      const std::size_t chunks = full + (tail > 0 ? 1 : 0);
+
+      TMLScratchArray<Accumulator> acc(chunks, alignof(Accumulator));
+      for (std::size_t c = 0; c < chunks; c++)
+        new (acc.data() + c) Accumulator(Op::template Init<SIMDType>());
+
+      for (std::size_t o = 0; o < lines; o++)
+      {
+        for (std::size_t c = 0; c < full; c++)
+          Op::Accumulate(acc.data()[c], x.Load(o, c * SIMDSize_v));
+        if (tail > 0)
+          Op::Accumulate(acc.data()[full], x.LoadMasked(o, full * SIMDSize_v, tail));
+      }
+
+      alignas(SIMDType) ElementType tmp[SIMDSize_v];
+      for (std::size_t c = 0; c < chunks; c++)
+      {
+        SIMDType::StoreAligned(Op::Result(acc.data()[c]), tmp);
+        for (std::size_t i = 0; i < SIMDSize_v && (c * SIMDSize_v + i) < length; i++)
+          dst(c * SIMDSize_v + i, tmp[i]);
+      }
+    }
+
+    // Positions of the first minimum or maximum (Op is SMLReduceMin or SMLReduceMax) of an operand (see
+    // TMLReduceKernel). The extreme of a line is found with SIMD registers, then its position in the line.
+    template<typename Op, typename SIMD>
+    struct TMLArgReduceKernel
+    {
+      using SIMDType = SIMD;
+      using ElementType = TMLSIMDElementType_t<SIMDType>;
+      using ValueKernel = TMLReduceKernel<Op, SIMDType>;
+
+      constexpr static std::size_t SIMDSize_v = TMLSIMDSize_v<SIMDType>;
+
+      // Line and position of the extreme of all elements (the first line and position if it occurs several times)
+      template<typename Operand>
+      static void Find(std::size_t& line, std::size_t& pos, const Operand& x, std::size_t lines, std::size_t length);
+      // dst(o, n) for the position n of the extreme of every line o
+      template<typename Dst, typename Operand>
+      static void FindLines(Dst&& dst, const Operand& x, std::size_t lines, std::size_t length);
+      // dst(n, o) for the line o of the extreme of the elements n of all lines (the lines are read one after
+      // the other, the elements are compared one by one)
+      template<typename Dst, typename Operand>
+      static void FindAcross(Dst&& dst, const Operand& x, std::size_t lines, std::size_t length);
+
+    private:
+      // Position of value in line o
+      template<typename Operand>
+      static std::size_t Position(const Operand& x, std::size_t o, std::size_t length, ElementType value);
+    };
+
+    template<typename Op, typename SIMD>
+    template<typename Operand>
+    std::size_t TMLArgReduceKernel<Op, SIMD>::Position(const Operand& x, std::size_t o, std::size_t length, ElementType value)
+    {
+      alignas(SIMDType) ElementType tmp[SIMDSize_v];
+      for (std::size_t n = 0; n < length; n += SIMDSize_v)
+      {
+        const std::size_t cnt = std::min(length - n, std::size_t(SIMDSize_v));
+        SIMDType::StoreAligned(cnt == SIMDSize_v ? x.Load(o, n) : x.LoadMasked(o, n, cnt), tmp);
+        for (std::size_t i = 0; i < cnt; i++)
+          if (tmp[i] == value)
+            return n + i;
+      }
+      return 0;
+    }
+
+    template<typename Op, typename SIMD>
+    template<typename Operand>
+    void TMLArgReduceKernel<Op, SIMD>::Find(std::size_t& line, std::size_t& pos, const Operand& x, std::size_t lines, std::size_t length)
+    {
+      line = 0;
+      pos = 0;
+      if (lines == 0 || length == 0)
+        return;
+
+      ElementType best = Op::template Identity<ElementType>();
+      ValueKernel::ReduceLines([&](std::size_t o, const ElementType& value) {
+        if (o == 0 || Op::Exceeds(value, best))
+        {
+          best = value;
+          line = o;
+        }
+      }, x, lines, length);
+      pos = Position(x, line, length, best);
+    }
+
+    template<typename Op, typename SIMD>
+    template<typename Dst, typename Operand>
+    void TMLArgReduceKernel<Op, SIMD>::FindLines(Dst&& dst, const Operand& x, std::size_t lines, std::size_t length)
+    {
+      if (length == 0)
+        return;
+      ValueKernel::ReduceLines([&](std::size_t o, const ElementType& value) {
+        dst(o, Position(x, o, length, value));
+      }, x, lines, length);
+    }
+
+    template<typename Op, typename SIMD>
+    template<typename Dst, typename Operand>
+    void TMLArgReduceKernel<Op, SIMD>::FindAcross(Dst&& dst, const Operand& x, std::size_t lines, std::size_t length)
+    {
+      if (lines == 0)
+        return;
+
+      TMLScratchArray<ElementType> best(length, alignof(SIMDType));
+      TMLScratchArray<std::size_t> index(length, alignof(std::size_t));
+      alignas(SIMDType) ElementType tmp[SIMDSize_v];
+      for (std::size_t o = 0; o < lines; o++)
+      {
+        for (std::size_t n = 0; n < length; n += SIMDSize_v)
+        {
+          const std::size_t cnt = std::min(length - n, std::size_t(SIMDSize_v));
+          SIMDType::StoreAligned(cnt == SIMDSize_v ? x.Load(o, n) : x.LoadMasked(o, n, cnt), tmp);
+          for (std::size_t i = 0; i < cnt; i++)
+          {
+            if (o == 0 || Op::Exceeds(tmp[i], best.data()[n + i]))
+            {
+              best.data()[n + i] = tmp[i];
+              index.data()[n + i] = o;
+            }
+          }
+        }
+      }
+      for (std::size_t n = 0; n < length; n++)
+        dst(n, index.data()[n]);
+    }
+  }
+
+}
+
+#endif
@@ -0,0 +1,245 @@
+// Copyright 2021, Philipp Neufeld
+
+#ifndef ML_MATH_Kernels_StrassenKernel_H_
+#define ML_MATH_Kernels_StrassenKernel_H_
+
+// Includes
+#include <cstddef>
+#include <cmath>
+#include <limits>
+#include <complex>
+#include <algorithm>
+#include <cassert>
+
+#include "../MathPrerequisites.h"
+#include "../SIMD/SIMD.h"
+#include "GemmEpilogue.h"
+#include "GemmKernel.h"
+
+#include "../../Memory/AlignedAlloc.h"
+#include "../../Memory/ScratchArena.h"
+
+namespace ML
+{
+
+  // Normwise error bound of a product of n x n matrices that is computed with the given number of levels
+  // of the Strassen-Winograd recursion (0: classical product), i.e. max|C - fl(A * B)| <= bound * max|A| * max|B|
+  // (to first order, see N. Higham, Accuracy and Stability of Numerical Algorithms, ch. 23). The bound of the
+  // classical product is n^2 u, every level multiplies the leading term by about 18 / 4.
+  template<typename ET>
+  double MLStrassenErrorBound(std::size_t n, std::size_t levels)
+  {
+    using RealType = decltype(std::abs(ET()));
+    const double u = std::numeric_limits<RealType>::epsilon() / 2;
+    const double n0 = std::ceil(static_cast<double>(n) / std::pow(2.0, static_cast<double>(levels)));
+    return std::max(std::pow(18.0, static_cast<double>(levels)) * (n0 * n0 + 6 * n0) - 6.0 * n, n0 * n0) * u;
+  }
+
+  // Temporary memory of the Strassen-Winograd recursion. A workspace that is passed to several products
+  // only allocates memory if a product needs more than any product before. It also reports the recursion
+  // depth and the error bound (see MLStrassenErrorBound) of the last product that was computed with it.
+  // A workspace must not be used by two products at the same time.
+  template<typename ET>
+  class TMLStrassenWorkspace
+  {
+  public:
+    TMLStrassenWorkspace() = default;
+    ~TMLStrassenWorkspace() { MLAlignedFree(m_data); }
+
+    TMLStrassenWorkspace(const TMLStrassenWorkspace&) = delete;
+    TMLStrassenWorkspace& operator=(const TMLStrassenWorkspace&) = delete;
+
+    // Makes sure that the workspace holds at least size elements
+    ET* Reserve(std::size_t size)
+    {
+      if (size > m_capacity)
+      {
+        MLAlignedFree(m_data);
+        m_data = MLAlignedAlloc<ET>(size, 64);
+        m_capacity = size;
+      }
+      return m_data;
+    }
+
+    std::size_t Capacity() const noexcept { return m_capacity; }
+
+    // Recursion depth and error bound of the last product
+    std::size_t Levels() const noexcept { return m_levels; }
+    double ErrorBound() const noexcept { return m_errorBound; }
+
+    void SetLastProduct(std::size_t levels, double errorBound) noexcept { m_levels = levels; m_errorBound = errorBound; }
+
+  private:
+    ET* m_data = nullptr;
+    std::size_t m_capacity = 0;
+    std::size_t m_levels = 0;
+    double m_errorBound = 0.0;
+  };
+
+  namespace Internal
+  {
+    // Strassen-Winograd recursion (7 products and 15 additions of quadrants per level) on top of a classical
+    // kernel. The recursion continues while all dimensions are at least the cutoff. Odd dimensions are handled
+    // by peeling the last row / column / slice of K off with classical products. The temporaries of all levels
+    // are taken from one workspace (two quadrants per level, the quadrants of C hold the other products).
+    template<typename ET, typename SIMD>
+    struct TMLStrassenKernel
+    {
+      using ElementType = ET;
+      using SIMDType = SIMD;
+      using ViewType = TMLGemmView<ElementType>;
+      using ConstViewType = TMLGemmView<const ElementType>;
+      using EpilogueType = TMLGemmEpilogue<ElementType>;
+
+      constexpr static std::size_t SIMDSize_v = TMLSIMDSize_v<SIMDType>;
+
+      // Number of levels and number of elements of the workspace of a product C(m x n) = A(m x k) * B(k x n)
+      static std::size_t Levels(std::size_t m, std::size_t n, std::size_t k, std::size_t cutoff) noexcept
+      {
+        return Split(m, n, k, cutoff) ? 1 + Levels(m / 2, n / 2, k / 2, cutoff) : 0;
+      }
+      static std::size_t WorkspaceSize(std::size_t m, std::size_t n, std::size_t k, std::size_t cutoff) noexcept
+      {
+        if (!Split(m, n, k, cutoff))
+          return 0;
+        const std::size_t m2 = m / 2, n2 = n / 2, k2 = k / 2;
+        return m2 * std::max(k2, n2) + k2 * n2 + WorkspaceSize(m2, n2, k2, cutoff);
+      }
+
+      // Computes C = A * B (C must be row-major, i.e. c.cs == 1). leaf(c, a, b, epilogue) computes the
+      // classical products, workspace must hold WorkspaceSize(...) elements.
+      template<typename Leaf>
+      static void Compute(const ViewType& c, const ConstViewType& a, const ConstViewType& b, std::size_t cutoff,
+        ElementType* workspace, Leaf& leaf);
+
+    private:
+      static bool Split(std::size_t m, std::size_t n, std::size_t k, std::size_t cutoff) noexcept
+      {
+        return std::min(m, std::min(n, k)) >= std::max<std::size_t>(cutoff, 2);
+      }
+
+      template<typename T>
+      static TMLGemmView<T> Block(const TMLGemmView<T>& v, std::size_t i, std::size_t j, std::size_t rows, std::size_t cols) noexcept
+      {
+        return { v.data + i * v.rs + j * v.cs, rows, cols, v.rs, v.cs };
+      }
+      static ConstViewType Const(const ViewType& v) noexcept { return { v.data, v.rows, v.cols, v.rs, v.cs }; }
+
+      // dst = x + y and dst = x - y (dst must be row-major and may alias x or y)
+      static void Add(const ViewType& dst, const ConstViewType& x, const ConstViewType& y) { Combine<false>(dst, x, y); }
+      static void Sub(const ViewType& dst, const ConstViewType& x, const ConstViewType& y) { Combine<true>(dst, x, y); }
+
+      template<bool sub>
+      static void Combine(const ViewType& dst, const ConstViewType& x, const ConstViewType& y);
+    };
+
+    template<typename ET, typename SIMD>
+    template<typename Leaf>
+    void TMLStrassenKernel<ET, SIMD>::Compute(const ViewType& c, const ConstViewType& a, const ConstViewType& b,
+      std::size_t cutoff, ElementType* workspace, Leaf& leaf)
+    {
+      assert(c.cs == 1);
+
+      const std::size_t m = c.rows, n = c.cols, k = a.cols;
+      if (!Split(m, n, k, cutoff))
+      {
+        leaf(c, a, b, EpilogueType());
+        return;
+      }
+
+      const std::size_t m2 = m / 2, n2 = n / 2, k2 = k / 2;
+      const ConstViewType a11 = Block(a, 0, 0, m2, k2), a12 = Block(a, 0, k2, m2, k2);
+      const ConstViewType a21 = Block(a, m2, 0, m2, k2), a22 = Block(a, m2, k2, m2, k2);
+      const ConstViewType b11 = Block(b, 0, 0, k2, n2), b12 = Block(b, 0, n2, k2, n2);
+      const ConstViewType b21 = Block(b, k2, 0, k2, n2), b22 = Block(b, k2, n2, k2, n2);
+      const ViewType c11 = Block(c, 0, 0, m2, n2), c12 = Block(c, 0, n2, m2, n2);
+      const ViewType c21 = Block(c, m2, 0, m2, n2), c22 = Block(c, m2, n2, m2, n2);
+
+      // Temporaries of this level (x holds a sum of quadrants of A and later the product P1)
+      const ViewType xa = { workspace, m2, k2, k2, 1 };
+      const ViewType xc = { workspace, m2, n2, n2, 1 };
+      const ViewType y = { workspace + m2 * std::max(k2, n2), k2, n2, n2, 1 };
+      ElementType* next = y.data + k2 * n2;
+
+      auto recurse = [&](const ViewType& cc, const ConstViewType& aa, const ConstViewType& bb) {
+        Compute(cc, aa, bb, cutoff, next, leaf);
+      };
+
+      // P7 = (A11 - A21) * (B22 - B12)
+      Sub(xa, a11, a21);
+      Sub(y, b22, b12);
+      recurse(c21, Const(xa), Const(y));
+      // P5 = (A21 + A22) * (B12 - B11)
+      Add(xa, a21, a22);
+      Sub(y, b12, b11);
+      recurse(c22, Const(xa), Const(y));
+      // P6 = S2 * T2 with S2 = A21 + A22 - A11 and T2 = B22 - B12 + B11
+      Sub(xa, Const(xa), a11);
+      Sub(y, b22, Const(y));
+      recurse(c12, Const(xa), Const(y));
+      // P3 = (A12 - S2) * B22
+      Sub(xa, a12, Const(xa));
+      recurse(c11, Const(xa), b22);
+      // P1 = A11 * B11
+      recurse(xc, a11, b11);
+
+      // C12 = P1 + P6 + P5 + P3, C22 = P1 + P6 + P7 + P5, C21 = P1 + P6 + P7 (- P4 below)
+      Add(c12, Const(xc), Const(c12));
+      Add(c21, Const(c12), Const(c21));
+      Add(c12, Const(c12), Const(c22));
+      Add(c22, Const(c21), Const(c22));
+      Add(c12, Const(c12), Const(c11));
+
+      // P4 = A22 * (T2 - B21), C21 = C21 - P4
+      Sub(y, Const(y), b21);
+      recurse(c11, a22, Const(y));
+      Sub(c21, Const(c21), Const(c11));
+
+      // C11 = P1 + P2 with P2 = A12 * B21
+      recurse(c11, a12, b21);
+      Add(c11, Const(c11), Const(xc));
+
+      // Peeled slice of K and peeled row / column of C
+      if (k % 2 != 0)
+      {
+        EpilogueType accumulate;
+        accumulate.beta = ElementType(1);
+        leaf(Block(c, 0, 0, 2 * m2, 2 * n2), Block(a, 0, k - 1, 2 * m2, 1), Block(b, k - 1, 0, 1, 2 * n2), accumulate);
+      }
+      if (n % 2 != 0)
+        leaf(Block(c, 0, n - 1, m, 1), a, Block(b, 0, n - 1, k, 1), EpilogueType());
+      if (m % 2 != 0)
+        leaf(Block(c, m - 1, 0, 1, 2 * n2), Block(a, m - 1, 0, 1, k), Block(b, 0, 0, k, 2 * n2), EpilogueType());
+    }
+
+    template<typename ET, typename SIMD>
+    template<bool sub>
+    void TMLStrassenKernel<ET, SIMD>::Combine(const ViewType& dst, const ConstViewType& x, const ConstViewType& y)
+    {
+      assert(dst.cs == 1);
+
+      for (std::size_t i = 0; i < dst.rows; i++)
+      {
+        ElementType* d = dst.data + i * dst.rs;
+        const ElementType* xi = x.data + i * x.rs;
+        const ElementType* yi = y.data + i * y.rs;
+
+        std::size_t j = 0;
+        if (x.cs == 1 && y.cs == 1)
+        {
+          for (; (j + SIMDSize_v) <= dst.cols; j += SIMDSize_v)
+          {
+            const SIMDType xr = SIMDType::LoadUnaligned(xi + j);
+            const SIMDType yr = SIMDType::LoadUnaligned(yi + j);
+            SIMDType::StoreUnaligned(sub ? xr - yr : xr + yr, d + j);
+          }
+        }
+        for (; j < dst.cols; j++)
+          d[j] = sub ? xi[j * x.cs] - yi[j * y.cs] : xi[j * x.cs] + yi[j * y.cs];
+      }
+    }
+  }
+
+}
+
+#endif
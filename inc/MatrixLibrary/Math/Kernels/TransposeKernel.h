@@ -0,0 +1,217 @@
+// Copyright 2021, Philipp Neufeld
+
+#ifndef ML_MATH_Kernels_TransposeKernel_H_
+#define ML_MATH_Kernels_TransposeKernel_H_
+
+// Includes
+#include <utility>
+#include <algorithm>
+
+#include "../MathPrerequisites.h"
+#include "../SIMD/SIMD.h"
+#include "../SIMD/Transpose.h"
+
+namespace ML
+{
+
+  namespace Internal
+  {
+    // Edge length below which the recursion of TMLTransposeKernel stops (a block of the source and of
+    // the destination fit into the L1 cache together)
+    constexpr std::size_t MLTransposeBlockSize_v = 32;
+
+    // Transposition of arrays of lines (rows of a row-major or columns of a column-major matrix). Larger
+    // arrays are halved along their longer side until the blocks are small enough, independent of the
+    // cache sizes (cache-oblivious). The blocks are transposed in tiles of N x N elements in registers
+    // (N is the SIMD size), the edges of the blocks element by element.
+    template<typename ET, typename SIMD>
+    struct TMLTransposeKernel
+    {
+      using ElementType = ET;
+      using SIMDType = SIMD;
+
+      constexpr static std::size_t SIMDSize_v = TMLSIMDSize_v<SIMDType>;
+      constexpr static std::size_t BlockSize_v = MLTransposeBlockSize_v;
+
+      // dst[j * ds + i] = src[i * ss + j] for i < rows and j < cols (the arrays must not overlap)
+      static void Transpose(ElementType* dst, std::size_t ds, const ElementType* src, std::size_t ss,
+        std::size_t rows, std::size_t cols);
+      // Transposes the n x n array in place
+      static void TransposeInPlace(ElementType* data, std::size_t s, std::size_t n);
+
+    private:
+      // Swaps a[i * s + j] and b[j * s + i] for i < rows and j < cols (the off-diagonal blocks of an in-place transpose)
+      static void Swap(ElementType* a, ElementType* b, std::size_t s, std::size_t rows, std::size_t cols);
+
+      static void TransposeBlock(ElementType* dst, std::size_t ds, const ElementType* src, std::size_t ss,
+        std::size_t rows, std::size_t cols);
+      static void TransposeInPlaceBlock(ElementType* data, std::size_t s, std::size_t n);
+      static void SwapBlock(ElementType* a, ElementType* b, std::size_t s, std::size_t rows, std::size_t cols);
+
+      // Loads the N x N tile at src, transposes it in the registers and stores it at dst
+      QM_ALWAYS_INLINE static void LoadTile(SIMDType* tile, const ElementType* src, std::size_t ss)
+      {
+        for (std::size_t k = 0; k < SIMDSize_v; k++)
+          tile[k] = SIMDType::LoadUnaligned(src + k * ss);
+        MLSIMDTranspose(tile);
+      }
+      QM_ALWAYS_INLINE static void StoreTile(const SIMDType* tile, ElementType* dst, std::size_t ds)
+      {
+        for (std::size_t k = 0; k < SIMDSize_v; k++)
+          SIMDType::StoreUnaligned(tile[k], dst + k * ds);
+      }
+
+      QM_ALWAYS_INLINE static void PrefetchBlock(const ElementType* data, std::size_t s, std::size_t rows, std::size_t cols)
+      {
+#if defined(ML_MATH_SSE)
+        constexpr std::size_t lineSize = 64 / sizeof(ElementType) > 0 ? 64 / sizeof(ElementType) : 1;
+        for (std::size_t i = 0; i < rows; i++)
+          for (std::size_t j = 0; j < cols; j += lineSize)
+            _mm_prefetch(reinterpret_cast<const char*>(data + i * s + j), _MM_HINT_T0);
+#endif
+      }
+
+      // Split of a side of n elements into halves (at a multiple of N unless the tiles are larger than the blocks)
+      constexpr static std::size_t Half(std::size_t n) noexcept 
+      { 
+        const std::size_t h = (n / 2 + SIMDSize_v - 1) / SIMDSize_v * SIMDSize_v;
+        return h < n ? h : n / 2;
+      }
+    };
+
+    template<typename ET, typename SIMD>
+    void TMLTransposeKernel<ET, SIMD>::Transpose(ElementType* dst, std::size_t ds, const ElementType* src, std::size_t ss,
+      std::size_t rows, std::size_t cols)
+    {
+      if (rows <= BlockSize_v && cols <= BlockSize_v)
+      {
+        TransposeBlock(dst, ds, src, ss, rows, cols);
+      }
+      else if (rows >= cols)
+      {
+        const std::size_t h = Half(rows);
+        Transpose(dst, ds, src, ss, h, cols);
+        Transpose(dst + h, ds, src + h * ss, ss, rows - h, cols);
+      }
+      else
+      {
+        const std::size_t h = Half(cols);
+        Transpose(dst, ds, src, ss, rows, h);
+        Transpose(dst + h * ds, ds, src + h, ss, rows, cols - h);
+      }
+    }
+
+    template<typename ET, typename SIMD>
+    void TMLTransposeKernel<ET, SIMD>::TransposeInPlace(ElementType* data, std::size_t s, std::size_t n)
+    {
+      if (n <= BlockSize_v)
+      {
+        TransposeInPlaceBlock(data, s, n);
+        return;
+      }
+
+      // The diagonal blocks are transposed in place, the blocks above the diagonal are swapped with the ones below
+      const std::size_t h = Half(n);
+      TransposeInPlace(data, s, h);
+      TransposeInPlace(data + h * s + h, s, n - h);
+      Swap(data + h, data + h * s, s, h, n - h);
+    }
+
+    template<typename ET, typename SIMD>
+    void TMLTransposeKernel<ET, SIMD>::Swap(ElementType* a, ElementType* b, std::size_t s, std::size_t rows, std::size_t cols)
+    {
+      if (rows <= BlockSize_v && cols <= BlockSize_v)
+      {
+        SwapBlock(a, b, s, rows, cols);
+      }
+      else if (rows >= cols)
+      {
+        const std::size_t h = Half(rows);
+        Swap(a, b, s, h, cols);
+        Swap(a + h * s, b + h, s, rows - h, cols);
+      }
+      else
+      {
+        const std::size_t h = Half(cols);
+        Swap(a, b, s, rows, h);
+        Swap(a + h, b + h * s, s, rows, cols - h);
+      }
+    }
+
+    template<typename ET, typename SIMD>
+    void TMLTransposeKernel<ET, SIMD>::TransposeBlock(ElementType* dst, std::size_t ds, const ElementType* src, std::size_t ss,
+      std::size_t rows, std::size_t cols)
+    {
+      const std::size_t tiledRows = rows / SIMDSize_v * SIMDSize_v;
+      const std::size_t tiledCols = cols / SIMDSize_v * SIMDSize_v;
+
+      // Every line of the destination block is written in pieces by several tiles. The lines are requested 
+      // up front, otherwise the stores of a tile wait for them one after the other.
+      PrefetchBlock(dst, ds, cols, rows);
+
+      SIMDType tile[SIMDSize_v];
+      for (std::size_t i = 0; i < tiledRows; i += SIMDSize_v)
+      {
+        for (std::size_t j = 0; j < tiledCols; j += SIMDSize_v)
+        {
+          LoadTile(tile, src + i * ss + j, ss);
+          StoreTile(tile, dst + j * ds + i, ds);
+        }
+      }
+
+      for (std::size_t i = 0; i < rows; i++)
+        for (std::size_t j = (i < tiledRows ? tiledCols : 0); j < cols; j++)
+          dst[j * ds + i] = src[i * ss + j];
+    }
+
+    template<typename ET, typename SIMD>
+    void TMLTransposeKernel<ET, SIMD>::TransposeInPlaceBlock(ElementType* data, std::size_t s, std::size_t n)
+    {
+      const std::size_t tiled = n / SIMDSize_v * SIMDSize_v;
+
+      SIMDType tile[SIMDSize_v], other[SIMDSize_v];
+      for (std::size_t i = 0; i < tiled; i += SIMDSize_v)
+      {
+        LoadTile(tile, data + i * s + i, s);
+        StoreTile(tile, data + i * s + i, s);
+        for (std::size_t j = i + SIMDSize_v; j < tiled; j += SIMDSize_v)
+        {
+          LoadTile(tile, data + i * s + j, s);
+          LoadTile(other, data + j * s + i, s);
+          StoreTile(tile, data + j * s + i, s);
+          StoreTile(other, data + i * s + j, s);
+        }
+      }
+
+      for (std::size_t i = 0; i < n; i++)
+        for (std::size_t j = std::max(i + 1, tiled); j < n; j++)
+          std::swap(data[i * s + j], data[j * s + i]);
+    }
+
+    template<typename ET, typename SIMD>
+    void TMLTransposeKernel<ET, SIMD>::SwapBlock(ElementType* a, ElementType* b, std::size_t s, std::size_t rows, std::size_t cols)
+    {
+      const std::size_t tiledRows = rows / SIMDSize_v * SIMDSize_v;
+      const std::size_t tiledCols = cols / SIMDSize_v * SIMDSize_v;
+
+      SIMDType tile[SIMDSize_v], other[SIMDSize_v];
+      for (std::size_t i = 0; i < tiledRows; i += SIMDSize_v)
+      {
+        for (std::size_t j = 0; j < tiledCols; j += SIMDSize_v)
+        {
+          LoadTile(tile, a + i * s + j, s);
+          LoadTile(other, b + j * s + i, s);
+          StoreTile(tile, b + j * s + i, s);
+          StoreTile(other, a + i * s + j, s);
+        }
+      }
+
+      for (std::size_t i = 0; i < rows; i++)
+        for (std::size_t j = (i < tiledRows ? tiledCols : 0); j < cols; j++)
+          std::swap(a[i * s + j], b[j * s + i]);
+    }
+  }
+
+}
+
+#endif
@@ -8,6 +8,7 @@
 // Includes
 #include <cstdint>
 #include <cmath>
+#include <utility>
 
 #include "../Core/Platform.h"
 #include "../QTL/Type.h"
@@ -31,6 +32,15 @@
 
 // Check for Features -> macros are defined by the accompanying CMake script
 #if !defined(ML_MATH_NO_INTRINSICS)
+#if defined(ML_AVX512F) && !defined(ML_MATH_AVX512F)
+#define ML_MATH_AVX512F
+#endif
+#if defined(ML_AVX512DQ) && !defined(ML_MATH_AVX512DQ)
+#define ML_MATH_AVX512DQ
+#endif
+#if defined(ML_AVX512BW) && !defined(ML_MATH_AVX512BW)
+#define ML_MATH_AVX512BW
+#endif
 #if defined(ML_FMA) && !defined(ML_MATH_FMA)
 #define ML_MATH_FMA
 #endif
@@ -60,6 +70,41 @@
 #endif
 #endif
 
+// Runtime dispatch of the hot kernels -> macro is defined by the accompanying CMake script
+// (see Kernels/Dispatch.h). The kernels are linked from the MLDispatch library.
+#if defined(ML_RUNTIME_DISPATCH) && !defined(ML_MATH_RUNTIME_DISPATCH)
+#define ML_MATH_RUNTIME_DISPATCH
+#endif
+
+// Cache sizes in bytes -> macros are defined by the accompanying CMake script.
+// The defaults are conservative values that fit most x86 processors.
+#if !defined(ML_MATH_CACHE_L1D_SIZE)
+#if defined(ML_CACHE_L1D)
+#define ML_MATH_CACHE_L1D_SIZE ML_CACHE_L1D
+#else
+#define ML_MATH_CACHE_L1D_SIZE (32 * 1024)
+#endif
+#endif
+#if !defined(ML_MATH_CACHE_L2_SIZE)
+#if defined(ML_CACHE_L2)
+#define ML_MATH_CACHE_L2_SIZE ML_CACHE_L2
+#else
+#define ML_MATH_CACHE_L2_SIZE (256 * 1024)
+#endif
+#endif
+#if !defined(ML_MATH_CACHE_L3_SIZE)
+#if defined(ML_CACHE_L3)
+#define ML_MATH_CACHE_L3_SIZE ML_CACHE_L3
+#else
+#define ML_MATH_CACHE_L3_SIZE (8 * 1024 * 1024)
+#endif
+#endif
+
+// Default path of the GEMM tuning file -> macro is defined by the accompanying CMake script
+// (see Kernels/GemmTuning.h). The environment variable ML_GEMM_TUNING_FILE takes precedence.
+#if !defined(ML_MATH_GEMM_TUNING_FILE) && defined(ML_GEMM_TUNING_FILE)
+#define ML_MATH_GEMM_TUNING_FILE ML_GEMM_TUNING_FILE
+#endif
 
 // Alignment
 #if !defined(ML_MATH_NO_INTRINSICS) && !defined(ML_MATH_ALIGNAS32)
@@ -106,6 +151,14 @@
 #define QM_ALWAYS_INLINE __attribute__((always_inline)) inline
 #endif
 
+// Type attribute that allows to access an object through a pointer to a different type (e.g. the lanes of an
+// intrinsic type through a pointer to the element type)
+#if defined(ML_COMPILER_MSVC)
+#define QM_MAY_ALIAS
+#elif defined(ML_COMPILER_GNUC) || defined(ML_COMPILER_CLANG)
+#define QM_MAY_ALIAS __attribute__((__may_alias__))
+#endif
+
 #ifndef QM_CONST
 #define QM_CONST constexpr
 #endif // !QM_CONST
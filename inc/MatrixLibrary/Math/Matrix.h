@@ -252,6 +252,47 @@ namespace ML
   template<typename MT1, typename MT2>
   using TMLMatrixMulResult_t = typename TMLMatrixMulResult<MT1, MT2>::type;
 
+  // Transposition result
+  template<typename MT, typename=void>
+  struct TMLMatrixTransResult1;
+  template<typename MT>
+  struct TMLMatrixTransResult
+    : TMLMatrixTransResult1<TMLDecayMatrixType_t<MT>> {};
+
+  template<typename MT>
+  using TMLMatrixTransResult_t = typename TMLMatrixTransResult<MT>::type;
+
+  // Matrix that holds a copy of the elements (the matrix type itself unless it is a view of another matrix)
+  template<typename MT, typename=void>
+  struct TMLMatrixCopyResult1;
+  template<typename MT>
+  struct TMLMatrixCopyResult
+    : TMLMatrixCopyResult1<TMLDecayMatrixType_t<MT>> {};
+
+  template<typename MT>
+  using TMLMatrixCopyResult_t = typename TMLMatrixCopyResult<MT>::type;
+
+  // Temporary copy of the elements within an evaluation (the copy result with its memory taken from the
+  // scratch arena of the thread, see Memory/ScratchArena.h)
+  template<typename MT, typename=void>
+  struct TMLMatrixScratchResult1;
+  template<typename MT>
+  struct TMLMatrixScratchResult
+    : TMLMatrixScratchResult1<TMLMatrixCopyResult_t<MT>> {};
+
+  template<typename MT>
+  using TMLMatrixScratchResult_t = typename TMLMatrixScratchResult<MT>::type;
+
+  // Result of reducing every row (a column vector) or every column (a row vector) to an element of type ET
+  template<typename MT, bool rowwise, typename ET, typename=void>
+  struct TMLMatrixReduceResult1;
+  template<typename MT, bool rowwise, typename ET>
+  struct TMLMatrixReduceResult
+    : TMLMatrixReduceResult1<TMLDecayMatrixType_t<MT>, rowwise, ET> {};
+
+  template<typename MT, bool rowwise, typename ET>
+  using TMLMatrixReduceResult_t = typename TMLMatrixReduceResult<MT, rowwise, ET>::type;
+
 }
 
 #include "Dense/DenseMatrix.h"
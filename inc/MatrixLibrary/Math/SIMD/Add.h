@@ -141,6 +141,58 @@ namespace ML
   }
 #endif
 
+#if defined(ML_MATH_AVX512F)
+  // AVX-512 32 bit floating point addition
+  template<typename SIMD>
+  QM_ALWAYS_INLINE SIMD 
+    operator+(const TMLSIMD32floatAVX512<SIMD>& a, const TMLSIMD32floatAVX512<SIMD>& b)
+  {
+    return _mm512_add_ps((~a).m_value, (~b).m_value);
+  }
+
+  // AVX-512 64 bit floating point addition
+  template<typename SIMD>
+  QM_ALWAYS_INLINE SIMD 
+    operator+(const TMLSIMD64floatAVX512<SIMD>& a, const TMLSIMD64floatAVX512<SIMD>& b)
+  {
+    return _mm512_add_pd((~a).m_value, (~b).m_value);
+  }
+
+  // AVX-512 32 bit integer addition
+  template<typename SIMD>
+  QM_ALWAYS_INLINE SIMD 
+    operator+(const TMLSIMD32intAVX512<SIMD>& a, const TMLSIMD32intAVX512<SIMD>& b)
+  {
+    return _mm512_add_epi32((~a).m_value, (~b).m_value);
+  }
+
+  // AVX-512 64 bit integer addition
+  template<typename SIMD>
+  QM_ALWAYS_INLINE SIMD 
+    operator+(const TMLSIMD64intAVX512<SIMD>& a, const TMLSIMD64intAVX512<SIMD>& b)
+  {
+    return _mm512_add_epi64((~a).m_value, (~b).m_value);
+  }
+#endif
+
+#if defined(ML_MATH_AVX512BW)
+  // AVX-512 8 bit integer addition
+  template<typename SIMD>
+  QM_ALWAYS_INLINE SIMD 
+    operator+(const TMLSIMD8intAVX512<SIMD>& a, const TMLSIMD8intAVX512<SIMD>& b)
+  {
+    return _mm512_add_epi8((~a).m_value, (~b).m_value);
+  }
+
+  // AVX-512 16 bit integer addition
+  template<typename SIMD>
+  QM_ALWAYS_INLINE SIMD 
+    operator+(const TMLSIMD16intAVX512<SIMD>& a, const TMLSIMD16intAVX512<SIMD>& b)
+  {
+    return _mm512_add_epi16((~a).m_value, (~b).m_value);
+  }
+#endif
+
 }
 
 #endif
@@ -0,0 +1,230 @@
+// Copyright 2021, Philipp Neufeld
+
+#ifndef ML_MATH_SIMD_Bitwise_H_
+#define ML_MATH_SIMD_Bitwise_H_
+
+// Includes
+#include <cstring>
+
+#include "SIMD.h"
+
+namespace ML
+{
+
+  // Lane-wise comparisons, selection and bit manipulation of floating point registers (the building blocks
+  // of the elementwise math functions). A comparison gives a mask with all bits of the lanes set where it
+  // holds (a bit mask for AVX-512), MLSIMDSelect(mask, a, b) takes the lanes of a where the mask is set and
+  // the lanes of b elsewhere. The shifts move the bits of every lane as an unsigned integer of the same width.
+  namespace Internal
+  {
+    // Value with the bit pattern of another value of the same size (e.g. the mask of the mantissa bits)
+    template<typename To, typename From>
+    QM_ALWAYS_INLINE To MLBitCast(const From& from) noexcept
+    {
+      static_assert(sizeof(To) == sizeof(From), "Bit casts require types of the same size");
+      To to;
+      std::memcpy(&to, &from, sizeof(To));
+      return to;
+    }
+
+    // element-wise function of one or two registers through memory (see MLSIMDScalarDiv)
+    template<typename SIMD, typename Func>
+    QM_ALWAYS_INLINE SIMD MLSIMDScalarMap(const SIMD& a, Func func)
+    {
+      using ET = TMLSIMDElementType_t<SIMD>;
+      alignas(SIMD) ET x[TMLSIMDSize_v<SIMD>];
+      SIMD::StoreAligned(a, x);
+      for (std::size_t i = 0; i < TMLSIMDSize_v<SIMD>; i++)
+        x[i] = static_cast<ET>(func(x[i]));
+      return SIMD::LoadAligned(x);
+    }
+
+    template<typename SIMD, typename Func>
+    QM_ALWAYS_INLINE SIMD MLSIMDScalarMap(const SIMD& a, const SIMD& b, Func func)
+    {
+      using ET = TMLSIMDElementType_t<SIMD>;
+      alignas(SIMD) ET x[TMLSIMDSize_v<SIMD>];
+      alignas(SIMD) ET y[TMLSIMDSize_v<SIMD>];
+      SIMD::StoreAligned(a, x);
+      SIMD::StoreAligned(b, y);
+      for (std::size_t i = 0; i < TMLSIMDSize_v<SIMD>; i++)
+        x[i] = static_cast<ET>(func(x[i], y[i]));
+      return SIMD::LoadAligned(x);
+    }
+
+    // The shifts are called with explicit template arguments, so they have to be declared as templates even
+    // if no instruction set defines them (the overloads below are more specialized)
+    template<int k, typename SIMD> SIMD MLSIMDShiftLeftBits(const SIMD& a);
+    template<int k, typename SIMD> SIMD MLSIMDShiftRightBits(const SIMD& a);
+
+#if defined(ML_MATH_SSE)
+    // SSE 32 bit floating point
+    QM_ALWAYS_INLINE MLSIMD32fSSE MLSIMDCmpLt(const MLSIMD32fSSE& a, const MLSIMD32fSSE& b) { return _mm_cmplt_ps(a.m_value, b.m_value); }
+    QM_ALWAYS_INLINE MLSIMD32fSSE MLSIMDCmpLe(const MLSIMD32fSSE& a, const MLSIMD32fSSE& b) { return _mm_cmple_ps(a.m_value, b.m_value); }
+    QM_ALWAYS_INLINE MLSIMD32fSSE MLSIMDCmpEq(const MLSIMD32fSSE& a, const MLSIMD32fSSE& b) { return _mm_cmpeq_ps(a.m_value, b.m_value); }
+    QM_ALWAYS_INLINE bool MLSIMDAnyLane(const MLSIMD32fSSE& mask) { return _mm_movemask_ps(mask.m_value) != 0; }
+    QM_ALWAYS_INLINE MLSIMD32fSSE MLSIMDAnd(const MLSIMD32fSSE& a, const MLSIMD32fSSE& b) { return _mm_and_ps(a.m_value, b.m_value); }
+    QM_ALWAYS_INLINE MLSIMD32fSSE MLSIMDOr(const MLSIMD32fSSE& a, const MLSIMD32fSSE& b) { return _mm_or_ps(a.m_value, b.m_value); }
+
+    QM_ALWAYS_INLINE MLSIMD32fSSE MLSIMDSelect(const MLSIMD32fSSE& mask, const MLSIMD32fSSE& a, const MLSIMD32fSSE& b)
+    {
+#if defined(ML_MATH_SSE4_1)
+      return _mm_blendv_ps(b.m_value, a.m_value, mask.m_value);
+#else
+      return _mm_or_ps(_mm_and_ps(mask.m_value, a.m_value), _mm_andnot_ps(mask.m_value, b.m_value));
+#endif
+    }
+#endif
+
+#if defined(ML_MATH_SSE2)
+    template<int k> QM_ALWAYS_INLINE MLSIMD32fSSE MLSIMDShiftLeftBits(const MLSIMD32fSSE& a)
+      { return _mm_castsi128_ps(_mm_slli_epi32(_mm_castps_si128(a.m_value), k)); }
+    template<int k> QM_ALWAYS_INLINE MLSIMD32fSSE MLSIMDShiftRightBits(const MLSIMD32fSSE& a)
+      { return _mm_castsi128_ps(_mm_srli_epi32(_mm_castps_si128(a.m_value), k)); }
+
+    // SSE2 64 bit floating point
+    QM_ALWAYS_INLINE MLSIMD64fSSE2 MLSIMDCmpLt(const MLSIMD64fSSE2& a, const MLSIMD64fSSE2& b) { return _mm_cmplt_pd(a.m_value, b.m_value); }
+    QM_ALWAYS_INLINE MLSIMD64fSSE2 MLSIMDCmpLe(const MLSIMD64fSSE2& a, const MLSIMD64fSSE2& b) { return _mm_cmple_pd(a.m_value, b.m_value); }
+    QM_ALWAYS_INLINE MLSIMD64fSSE2 MLSIMDCmpEq(const MLSIMD64fSSE2& a, const MLSIMD64fSSE2& b) { return _mm_cmpeq_pd(a.m_value, b.m_value); }
+    QM_ALWAYS_INLINE bool MLSIMDAnyLane(const MLSIMD64fSSE2& mask) { return _mm_movemask_pd(mask.m_value) != 0; }
+    QM_ALWAYS_INLINE MLSIMD64fSSE2 MLSIMDAnd(const MLSIMD64fSSE2& a, const MLSIMD64fSSE2& b) { return _mm_and_pd(a.m_value, b.m_value); }
+    QM_ALWAYS_INLINE MLSIMD64fSSE2 MLSIMDOr(const MLSIMD64fSSE2& a, const MLSIMD64fSSE2& b) { return _mm_or_pd(a.m_value, b.m_value); }
+
+    QM_ALWAYS_INLINE MLSIMD64fSSE2 MLSIMDSelect(const MLSIMD64fSSE2& mask, const MLSIMD64fSSE2& a, const MLSIMD64fSSE2& b)
+    {
+#if defined(ML_MATH_SSE4_1)
+      return _mm_blendv_pd(b.m_value, a.m_value, mask.m_value);
+#else
+      return _mm_or_pd(_mm_and_pd(mask.m_value, a.m_value), _mm_andnot_pd(mask.m_value, b.m_value));
+#endif
+    }
+
+    template<int k> QM_ALWAYS_INLINE MLSIMD64fSSE2 MLSIMDShiftLeftBits(const MLSIMD64fSSE2& a)
+      { return _mm_castsi128_pd(_mm_slli_epi64(_mm_castpd_si128(a.m_value), k)); }
+    template<int k> QM_ALWAYS_INLINE MLSIMD64fSSE2 MLSIMDShiftRightBits(const MLSIMD64fSSE2& a)
+      { return _mm_castsi128_pd(_mm_srli_epi64(_mm_castpd_si128(a.m_value), k)); }
+
+    // Rounding to the nearest integer (ties to even). Without SSE4.1 the fraction is rounded away by adding
+    // and subtracting 1.5 * 2^23 (1.5 * 2^52), which requires |a| < 2^22 (2^51).
+    QM_ALWAYS_INLINE MLSIMD32fSSE MLSIMDRound(const MLSIMD32fSSE& a)
+    {
+#if defined(ML_MATH_SSE4_1)
+      return _mm_round_ps(a.m_value, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+#else
+      const __m128 magic = _mm_set1_ps(12582912.0f);
+      return _mm_sub_ps(_mm_add_ps(a.m_value, magic), magic);
+#endif
+    }
+    QM_ALWAYS_INLINE MLSIMD64fSSE2 MLSIMDRound(const MLSIMD64fSSE2& a)
+    {
+#if defined(ML_MATH_SSE4_1)
+      return _mm_round_pd(a.m_value, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+#else
+      const __m128d magic = _mm_set1_pd(6755399441055744.0);
+      return _mm_sub_pd(_mm_add_pd(a.m_value, magic), magic);
+#endif
+    }
+#endif
+
+#if defined(ML_MATH_AVX)
+    // AVX 32/64 bit floating point (without AVX2 the bits are shifted in two 128 bit halves)
+    QM_ALWAYS_INLINE MLSIMD32fAVX MLSIMDCmpLt(const MLSIMD32fAVX& a, const MLSIMD32fAVX& b) { return _mm256_cmp_ps(a.m_value, b.m_value, _CMP_LT_OQ); }
+    QM_ALWAYS_INLINE MLSIMD32fAVX MLSIMDCmpLe(const MLSIMD32fAVX& a, const MLSIMD32fAVX& b) { return _mm256_cmp_ps(a.m_value, b.m_value, _CMP_LE_OQ); }
+    QM_ALWAYS_INLINE MLSIMD32fAVX MLSIMDCmpEq(const MLSIMD32fAVX& a, const MLSIMD32fAVX& b) { return _mm256_cmp_ps(a.m_value, b.m_value, _CMP_EQ_OQ); }
+    QM_ALWAYS_INLINE bool MLSIMDAnyLane(const MLSIMD32fAVX& mask) { return _mm256_movemask_ps(mask.m_value) != 0; }
+    QM_ALWAYS_INLINE MLSIMD32fAVX MLSIMDAnd(const MLSIMD32fAVX& a, const MLSIMD32fAVX& b) { return _mm256_and_ps(a.m_value, b.m_value); }
+    QM_ALWAYS_INLINE MLSIMD32fAVX MLSIMDOr(const MLSIMD32fAVX& a, const MLSIMD32fAVX& b) { return _mm256_or_ps(a.m_value, b.m_value); }
+    QM_ALWAYS_INLINE MLSIMD32fAVX MLSIMDSelect(const MLSIMD32fAVX& mask, const MLSIMD32fAVX& a, const MLSIMD32fAVX& b)
+      { return _mm256_blendv_ps(b.m_value, a.m_value, mask.m_value); }
+    QM_ALWAYS_INLINE MLSIMD32fAVX MLSIMDRound(const MLSIMD32fAVX& a)
+      { return _mm256_round_ps(a.m_value, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); }
+
+    QM_ALWAYS_INLINE MLSIMD64fAVX MLSIMDCmpLt(const MLSIMD64fAVX& a, const MLSIMD64fAVX& b) { return _mm256_cmp_pd(a.m_value, b.m_value, _CMP_LT_OQ); }
+    QM_ALWAYS_INLINE MLSIMD64fAVX MLSIMDCmpLe(const MLSIMD64fAVX& a, const MLSIMD64fAVX& b) { return _mm256_cmp_pd(a.m_value, b.m_value, _CMP_LE_OQ); }
+    QM_ALWAYS_INLINE MLSIMD64fAVX MLSIMDCmpEq(const MLSIMD64fAVX& a, const MLSIMD64fAVX& b) { return _mm256_cmp_pd(a.m_value, b.m_value, _CMP_EQ_OQ); }
+    QM_ALWAYS_INLINE bool MLSIMDAnyLane(const MLSIMD64fAVX& mask) { return _mm256_movemask_pd(mask.m_value) != 0; }
+    QM_ALWAYS_INLINE MLSIMD64fAVX MLSIMDAnd(const MLSIMD64fAVX& a, const MLSIMD64fAVX& b) { return _mm256_and_pd(a.m_value, b.m_value); }
+    QM_ALWAYS_INLINE MLSIMD64fAVX MLSIMDOr(const MLSIMD64fAVX& a, const MLSIMD64fAVX& b) { return _mm256_or_pd(a.m_value, b.m_value); }
+    QM_ALWAYS_INLINE MLSIMD64fAVX MLSIMDSelect(const MLSIMD64fAVX& mask, const MLSIMD64fAVX& a, const MLSIMD64fAVX& b)
+      { return _mm256_blendv_pd(b.m_value, a.m_value, mask.m_value); }
+    QM_ALWAYS_INLINE MLSIMD64fAVX MLSIMDRound(const MLSIMD64fAVX& a)
+      { return _mm256_round_pd(a.m_value, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); }
+
+#if defined(ML_MATH_AVX2)
+    template<int k> QM_ALWAYS_INLINE MLSIMD32fAVX MLSIMDShiftLeftBits(const MLSIMD32fAVX& a)
+      { return _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_castps_si256(a.m_value), k)); }
+    template<int k> QM_ALWAYS_INLINE MLSIMD32fAVX MLSIMDShiftRightBits(const MLSIMD32fAVX& a)
+      { return _mm256_castsi256_ps(_mm256_srli_epi32(_mm256_castps_si256(a.m_value), k)); }
+    template<int k> QM_ALWAYS_INLINE MLSIMD64fAVX MLSIMDShiftLeftBits(const MLSIMD64fAVX& a)
+      { return _mm256_castsi256_pd(_mm256_slli_epi64(_mm256_castpd_si256(a.m_value), k)); }
+    template<int k> QM_ALWAYS_INLINE MLSIMD64fAVX MLSIMDShiftRightBits(const MLSIMD64fAVX& a)
+      { return _mm256_castsi256_pd(_mm256_srli_epi64(_mm256_castpd_si256(a.m_value), k)); }
+#else
+    template<int k> QM_ALWAYS_INLINE MLSIMD32fAVX MLSIMDShiftLeftBits(const MLSIMD32fAVX& a)
+    {
+      const MLSIMD32fSSE lo = MLSIMDShiftLeftBits<k>(MLSIMD32fSSE(_mm256_castps256_ps128(a.m_value)));
+      const MLSIMD32fSSE hi = MLSIMDShiftLeftBits<k>(MLSIMD32fSSE(_mm256_extractf128_ps(a.m_value, 1)));
+      return _mm256_insertf128_ps(_mm256_castps128_ps256(lo.m_value), hi.m_value, 1);
+    }
+    template<int k> QM_ALWAYS_INLINE MLSIMD32fAVX MLSIMDShiftRightBits(const MLSIMD32fAVX& a)
+    {
+      const MLSIMD32fSSE lo = MLSIMDShiftRightBits<k>(MLSIMD32fSSE(_mm256_castps256_ps128(a.m_value)));
+      const MLSIMD32fSSE hi = MLSIMDShiftRightBits<k>(MLSIMD32fSSE(_mm256_extractf128_ps(a.m_value, 1)));
+      return _mm256_insertf128_ps(_mm256_castps128_ps256(lo.m_value), hi.m_value, 1);
+    }
+    template<int k> QM_ALWAYS_INLINE MLSIMD64fAVX MLSIMDShiftLeftBits(const MLSIMD64fAVX& a)
+    {
+      const MLSIMD64fSSE2 lo = MLSIMDShiftLeftBits<k>(MLSIMD64fSSE2(_mm256_castpd256_pd128(a.m_value)));
+      const MLSIMD64fSSE2 hi = MLSIMDShiftLeftBits<k>(MLSIMD64fSSE2(_mm256_extractf128_pd(a.m_value, 1)));
+      return _mm256_insertf128_pd(_mm256_castpd128_pd256(lo.m_value), hi.m_value, 1);
+    }
+    template<int k> QM_ALWAYS_INLINE MLSIMD64fAVX MLSIMDShiftRightBits(const MLSIMD64fAVX& a)
+    {
+      const MLSIMD64fSSE2 lo = MLSIMDShiftRightBits<k>(MLSIMD64fSSE2(_mm256_castpd256_pd128(a.m_value)));
+      const MLSIMD64fSSE2 hi = MLSIMDShiftRightBits<k>(MLSIMD64fSSE2(_mm256_extractf128_pd(a.m_value, 1)));
+      return _mm256_insertf128_pd(_mm256_castpd128_pd256(lo.m_value), hi.m_value, 1);
+    }
+#endif
+#endif
+
+#if defined(ML_MATH_AVX512F)
+    // AVX-512 32/64 bit floating point (the comparisons give bit masks)
+    QM_ALWAYS_INLINE __mmask16 MLSIMDCmpLt(const MLSIMD32fAVX512& a, const MLSIMD32fAVX512& b) { return _mm512_cmp_ps_mask(a.m_value, b.m_value, _CMP_LT_OQ); }
+    QM_ALWAYS_INLINE __mmask16 MLSIMDCmpLe(const MLSIMD32fAVX512& a, const MLSIMD32fAVX512& b) { return _mm512_cmp_ps_mask(a.m_value, b.m_value, _CMP_LE_OQ); }
+    QM_ALWAYS_INLINE __mmask16 MLSIMDCmpEq(const MLSIMD32fAVX512& a, const MLSIMD32fAVX512& b) { return _mm512_cmp_ps_mask(a.m_value, b.m_value, _CMP_EQ_OQ); }
+    QM_ALWAYS_INLINE bool MLSIMDAnyLane(__mmask16 mask) { return mask != 0; }
+    QM_ALWAYS_INLINE MLSIMD32fAVX512 MLSIMDSelect(__mmask16 mask, const MLSIMD32fAVX512& a, const MLSIMD32fAVX512& b)
+      { return _mm512_mask_blend_ps(mask, b.m_value, a.m_value); }
+    QM_ALWAYS_INLINE MLSIMD32fAVX512 MLSIMDAnd(const MLSIMD32fAVX512& a, const MLSIMD32fAVX512& b)
+      { return _mm512_castsi512_ps(_mm512_and_si512(_mm512_castps_si512(a.m_value), _mm512_castps_si512(b.m_value))); }
+    QM_ALWAYS_INLINE MLSIMD32fAVX512 MLSIMDOr(const MLSIMD32fAVX512& a, const MLSIMD32fAVX512& b)
+      { return _mm512_castsi512_ps(_mm512_or_si512(_mm512_castps_si512(a.m_value), _mm512_castps_si512(b.m_value))); }
+    template<int k> QM_ALWAYS_INLINE MLSIMD32fAVX512 MLSIMDShiftLeftBits(const MLSIMD32fAVX512& a)
+      { return _mm512_castsi512_ps(_mm512_slli_epi32(_mm512_castps_si512(a.m_value), k)); }
+    template<int k> QM_ALWAYS_INLINE MLSIMD32fAVX512 MLSIMDShiftRightBits(const MLSIMD32fAVX512& a)
+      { return _mm512_castsi512_ps(_mm512_srli_epi32(_mm512_castps_si512(a.m_value), k)); }
+    QM_ALWAYS_INLINE MLSIMD32fAVX512 MLSIMDRound(const MLSIMD32fAVX512& a)
+      { return _mm512_roundscale_ps(a.m_value, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); }
+
+    QM_ALWAYS_INLINE __mmask8 MLSIMDCmpLt(const MLSIMD64fAVX512& a, const MLSIMD64fAVX512& b) { return _mm512_cmp_pd_mask(a.m_value, b.m_value, _CMP_LT_OQ); }
+    QM_ALWAYS_INLINE __mmask8 MLSIMDCmpLe(const MLSIMD64fAVX512& a, const MLSIMD64fAVX512& b) { return _mm512_cmp_pd_mask(a.m_value, b.m_value, _CMP_LE_OQ); }
+    QM_ALWAYS_INLINE __mmask8 MLSIMDCmpEq(const MLSIMD64fAVX512& a, const MLSIMD64fAVX512& b) { return _mm512_cmp_pd_mask(a.m_value, b.m_value, _CMP_EQ_OQ); }
+    QM_ALWAYS_INLINE bool MLSIMDAnyLane(__mmask8 mask) { return mask != 0; }
+    QM_ALWAYS_INLINE MLSIMD64fAVX512 MLSIMDSelect(__mmask8 mask, const MLSIMD64fAVX512& a, const MLSIMD64fAVX512& b)
+      { return _mm512_mask_blend_pd(mask, b.m_value, a.m_value); }
+    QM_ALWAYS_INLINE MLSIMD64fAVX512 MLSIMDAnd(const MLSIMD64fAVX512& a, const MLSIMD64fAVX512& b)
+      { return _mm512_castsi512_pd(_mm512_and_si512(_mm512_castpd_si512(a.m_value), _mm512_castpd_si512(b.m_value))); }
+    QM_ALWAYS_INLINE MLSIMD64fAVX512 MLSIMDOr(const MLSIMD64fAVX512& a, const MLSIMD64fAVX512& b)
+      { return _mm512_castsi512_pd(_mm512_or_si512(_mm512_castpd_si512(a.m_value), _mm512_castpd_si512(b.m_value))); }
+    template<int k> QM_ALWAYS_INLINE MLSIMD64fAVX512 MLSIMDShiftLeftBits(const MLSIMD64fAVX512& a)
+      { return _mm512_castsi512_pd(_mm512_slli_epi64(_mm512_castpd_si512(a.m_value), k)); }
+    template<int k> QM_ALWAYS_INLINE MLSIMD64fAVX512 MLSIMDShiftRightBits(const MLSIMD64fAVX512& a)
+      { return _mm512_castsi512_pd(_mm512_srli_epi64(_mm512_castpd_si512(a.m_value), k)); }
+    QM_ALWAYS_INLINE MLSIMD64fAVX512 MLSIMDRound(const MLSIMD64fAVX512& a)
+      { return _mm512_roundscale_pd(a.m_value, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); }
+#endif
+  }
+
+}
+
+#endif
@@ -119,6 +119,50 @@ namespace ML
   }
 #endif
 
+#if defined(ML_MATH_AVX512F)
+  // AVX-512 32 bit floating point broadcast
+  template<int idx>
+  QM_ALWAYS_INLINE MLSIMD32fAVX512 MLSIMDBroadcast(const MLSIMD32fAVX512& v)
+  {
+    assert(idx < 16);
+    return _mm512_permutexvar_ps(_mm512_set1_epi32(idx), v.m_value);
+  }
+
+  // AVX-512 32 bit complex floating point broadcast
+  template<int idx>
+  QM_ALWAYS_INLINE MLSIMD32cfAVX512 MLSIMDBroadcast(const MLSIMD32cfAVX512& v)
+  {
+    assert(idx < 8);
+    __m512d reg = _mm512_castps_pd(v.m_value);
+    reg = _mm512_permutexvar_pd(_mm512_set1_epi64(idx), reg);
+    return _mm512_castpd_ps(reg);
+  }
+
+  // AVX-512 64 bit floating point broadcast
+  template<int idx>
+  QM_ALWAYS_INLINE MLSIMD64fAVX512 MLSIMDBroadcast(const MLSIMD64fAVX512& v)
+  {
+    assert(idx < 8);
+    return _mm512_permutexvar_pd(_mm512_set1_epi64(idx), v.m_value);
+  }
+
+  // AVX-512 64 bit complex floating point broadcast
+  template<int idx>
+  QM_ALWAYS_INLINE MLSIMD64cfAVX512 MLSIMDBroadcast(const MLSIMD64cfAVX512& v)
+  {
+    assert(idx < 4);
+    return _mm512_shuffle_f64x2(v.m_value, v.m_value, idx * 0x55);
+  }
+
+  // AVX-512 32 bit integer broadcast
+  template<int idx, typename SIMD>
+  QM_ALWAYS_INLINE SIMD MLSIMDBroadcast(const TMLSIMD32uiAVX512<SIMD>& v)
+  {
+    assert(idx < 16);
+    return _mm512_permutexvar_epi32(_mm512_set1_epi32(idx), (~v).m_value);
+  }
+#endif
+
 }
 
 #endif
@@ -24,6 +24,21 @@ namespace ML
       const TMLSIMD<SIMD>& m_a;
       const TMLSIMD<SIMD>& m_b;
     };
+
+    // element-wise division through memory (writing the lanes via operator[] 
+    // breaks strict aliasing for integers wider than 8 bits)
+    template<typename SIMD>
+    QM_ALWAYS_INLINE SIMD MLSIMDScalarDiv(const SIMD& a, const SIMD& b)
+    {
+      using ET = TMLSIMDElementType_t<SIMD>;
+      alignas(SIMD) ET x[TMLSIMDSize_v<SIMD>];
+      alignas(SIMD) ET y[TMLSIMDSize_v<SIMD>];
+      SIMD::StoreAligned(a, x);
+      SIMD::StoreAligned(b, y);
+      for (std::size_t i = 0; i < TMLSIMDSize_v<SIMD>; i++)
+        x[i] /= y[i];
+      return SIMD::LoadAligned(x);
+    }
   }
 
   // default division
@@ -137,10 +152,56 @@ namespace ML
   QM_ALWAYS_INLINE SIMD
     operator/(const TMLSIMDintAVX2<SIMD>& a, const TMLSIMDintAVX2<SIMD>& b)
   {
-    TMLDecaySIMDType_t<SIMD> res;
-    for (size_t i = 0; i < TMLSIMDSize_v<SIMD>; i++)
-      res[i] = (~a)[i] / (~b)[i];
-    return res;
+    return Internal::MLSIMDScalarDiv(~a, ~b);
+  }
+#endif
+
+#if defined(ML_MATH_AVX512F)
+  // AVX-512 32 bit floating point division
+  QM_ALWAYS_INLINE MLSIMD32fAVX512 operator/(const MLSIMD32fAVX512& a, const MLSIMD32fAVX512& b)
+  {
+    return _mm512_div_ps(a.m_value, b.m_value);
+  }
+
+  // AVX-512 32 bit complex floating point division
+  QM_ALWAYS_INLINE MLSIMD32cfAVX512 operator/(const MLSIMD32cfAVX512& a, const MLSIMD32cfAVX512& b)
+  {
+    // conjugate by negating the imaginary parts (odd elements)
+    MLSIMD32cfAVX512 bconj = _mm512_mask_sub_ps(b.m_value, 0xAAAA, _mm512_setzero_ps(), b.m_value);
+    MLSIMD32cfAVX512 num = a * bconj;
+
+    __m512 b2 = _mm512_mul_ps(b.m_value, b.m_value);
+    __m512 b2s = _mm512_shuffle_ps(b2, b2, _MM_SHUFFLE(2,3,0,1));
+    __m512 den = _mm512_add_ps(b2, b2s);
+
+    return _mm512_div_ps(num.m_value, den);
+  }
+
+  // AVX-512 64 bit floating point division
+  QM_ALWAYS_INLINE MLSIMD64fAVX512 operator/(const MLSIMD64fAVX512& a, const MLSIMD64fAVX512& b)
+  {
+    return _mm512_div_pd(a.m_value, b.m_value);
+  }
+
+  // AVX-512 64 bit complex floating point division
+  QM_ALWAYS_INLINE MLSIMD64cfAVX512 operator/(const MLSIMD64cfAVX512& a, const MLSIMD64cfAVX512& b)
+  {
+    MLSIMD64cfAVX512 bconj = _mm512_mask_sub_pd(b.m_value, 0xAA, _mm512_setzero_pd(), b.m_value);
+    MLSIMD64cfAVX512 num = a * bconj;
+
+    __m512d b2 = _mm512_mul_pd(b.m_value, b.m_value);
+    __m512d b2s = _mm512_shuffle_pd(b2, b2, 0x55);
+    __m512d den = _mm512_add_pd(b2, b2s);
+
+    return _mm512_div_pd(num.m_value, den);
+  }
+
+  // AVX-512 integer division (no vectorized version available)
+  template<typename SIMD>
+  QM_ALWAYS_INLINE SIMD
+    operator/(const TMLSIMDintAVX512<SIMD>& a, const TMLSIMDintAVX512<SIMD>& b)
+  {
+    return Internal::MLSIMDScalarDiv(~a, ~b);
   }
 #endif
 
@@ -0,0 +1,164 @@
+// Copyright 2021, Philipp Neufeld
+
+#ifndef ML_MATH_SIMD_Erf_H_
+#define ML_MATH_SIMD_Erf_H_
+
+// Includes
+#include <cmath>
+#include <cstdint>
+
+#include "SIMD.h"
+#include "FMA.h"
+#include "MinMax.h"
+#include "Bitwise.h"
+#include "Exp.h"
+
+namespace ML
+{
+
+  namespace Internal
+  {
+    // Error function in single precision: odd rational approximation of degree 13 / 8 on [-4, 4], erf(x)
+    // rounds to +-1 outside of that range. Maximum error 6 ulp.
+    template<typename SIMD>
+    QM_ALWAYS_INLINE SIMD MLSIMDErfFloat(const SIMD& a)
+    {
+      const SIMD x = MLSIMDClamp(a, SIMD::Set1(-4.0f), SIMD::Set1(4.0f));
+      const SIMD x2 = x * x;
+
+      SIMD p = MLSIMDFmadd(x2, SIMD::Set1(-2.72614225801306e-10f), SIMD::Set1(2.77068142495902e-08f));
+      p = MLSIMDFmadd(x2, p, SIMD::Set1(-2.10102402082508e-06f));
+      p = MLSIMDFmadd(x2, p, SIMD::Set1(-5.69250639462346e-05f));
+      p = MLSIMDFmadd(x2, p, SIMD::Set1(-7.34990630326855e-04f));
+      p = MLSIMDFmadd(x2, p, SIMD::Set1(-2.95459980854025e-03f));
+      p = MLSIMDFmadd(x2, p, SIMD::Set1(-1.60960333262415e-02f));
+
+      SIMD q = MLSIMDFmadd(x2, SIMD::Set1(-1.45660718464996e-05f), SIMD::Set1(-2.13374055278905e-04f));
+      q = MLSIMDFmadd(x2, q, SIMD::Set1(-1.68282697438203e-03f));
+      q = MLSIMDFmadd(x2, q, SIMD::Set1(-7.37332916720468e-03f));
+      q = MLSIMDFmadd(x2, q, SIMD::Set1(-1.42647390514189e-02f));
+      return x * (p / q);
+    }
+
+    // Error function in double precision (fdlibm s_erf.c): the four argument ranges [0, 0.84375), [0.84375, 1.25),
+    // [1.25, 1 / 0.35) and [1 / 0.35, 6] are evaluated for all lanes and selected afterwards, the two tail ranges
+    // (and their exponentials) only if a lane needs them. Maximum error 1 ulp.
+    template<typename SIMD>
+    QM_ALWAYS_INLINE SIMD MLSIMDErfDouble(const SIMD& a)
+    {
+      const SIMD ax = MLSIMDAbs(a);
+      const SIMD one = SIMD::Set1(1.0);
+
+      // |x| < 0.84375: x + x P(x^2) / Q(x^2)
+      const SIMD z = ax * ax;
+      SIMD r = MLSIMDFmadd(z, SIMD::Set1(-2.37630166566501626084e-05), SIMD::Set1(-5.77027029648944159157e-03));
+      r = MLSIMDFmadd(z, r, SIMD::Set1(-2.84817495755985104766e-02));
+      r = MLSIMDFmadd(z, r, SIMD::Set1(-3.25042107247001499370e-01));
+      r = MLSIMDFmadd(z, r, SIMD::Set1(1.28379167095512558561e-01));
+      SIMD s = MLSIMDFmadd(z, SIMD::Set1(-3.96022827877536812320e-06), SIMD::Set1(1.32494738004321644526e-04));
+      s = MLSIMDFmadd(z, s, SIMD::Set1(5.08130628187576562776e-03));
+      s = MLSIMDFmadd(z, s, SIMD::Set1(6.50222499887672944485e-02));
+      s = MLSIMDFmadd(z, s, SIMD::Set1(3.97917223959155352819e-01));
+      s = MLSIMDFmadd(z, s, one);
+      SIMD res = MLSIMDFmadd(ax, r / s, ax);
+
+      // 0.84375 <= |x| < 1.25: erx + P(|x| - 1) / Q(|x| - 1)
+      const SIMD t = ax - one;
+      SIMD p = MLSIMDFmadd(t, SIMD::Set1(-2.16637559486879084300e-03), SIMD::Set1(3.54783043256182359371e-02));
+      p = MLSIMDFmadd(t, p, SIMD::Set1(-1.10894694282396677476e-01));
+      p = MLSIMDFmadd(t, p, SIMD::Set1(3.18346619901161753674e-01));
+      p = MLSIMDFmadd(t, p, SIMD::Set1(-3.72207876035701323847e-01));
+      p = MLSIMDFmadd(t, p, SIMD::Set1(4.14856118683748331666e-01));
+      p = MLSIMDFmadd(t, p, SIMD::Set1(-2.36211856075265944077e-03));
+      SIMD q = MLSIMDFmadd(t, SIMD::Set1(1.19844998467991074170e-02), SIMD::Set1(1.36370839120290507362e-02));
+      q = MLSIMDFmadd(t, q, SIMD::Set1(1.26171219808761642112e-01));
+      q = MLSIMDFmadd(t, q, SIMD::Set1(7.18286544141962662868e-02));
+      q = MLSIMDFmadd(t, q, SIMD::Set1(5.40397917702171048937e-01));
+      q = MLSIMDFmadd(t, q, SIMD::Set1(1.06420880400844228286e-01));
+      q = MLSIMDFmadd(t, q, one);
+      res = MLSIMDSelect(MLSIMDCmpLe(SIMD::Set1(0.84375), ax), SIMD::Set1(8.45062911510467529297e-01) + p / q, res);
+
+      // 1.25 <= |x|: 1 - exp(-x^2 - 0.5625 + R(1 / x^2) / S(1 / x^2)) / |x|
+      const auto tailMask = MLSIMDCmpLe(SIMD::Set1(1.25), ax);
+      if (MLSIMDAnyLane(tailMask))
+      {
+        const SIMD x = MLSIMDMin(ax, SIMD::Set1(6.0));
+        const SIMD w = one / (x * x);
+
+        SIMD ra = MLSIMDFmadd(w, SIMD::Set1(-9.81432934416914548592e+00), SIMD::Set1(-8.12874355063065934246e+01));
+        ra = MLSIMDFmadd(w, ra, SIMD::Set1(-1.84605092906711035994e+02));
+        ra = MLSIMDFmadd(w, ra, SIMD::Set1(-1.62396669462573470355e+02));
+        ra = MLSIMDFmadd(w, ra, SIMD::Set1(-6.23753324503260060396e+01));
+        ra = MLSIMDFmadd(w, ra, SIMD::Set1(-1.05586262253232909814e+01));
+        ra = MLSIMDFmadd(w, ra, SIMD::Set1(-6.93858572707181764372e-01));
+        ra = MLSIMDFmadd(w, ra, SIMD::Set1(-9.86494403484714822705e-03));
+        SIMD sa = MLSIMDFmadd(w, SIMD::Set1(-6.04244152148580987438e-02), SIMD::Set1(6.57024977031928170135e+00));
+        sa = MLSIMDFmadd(w, sa, SIMD::Set1(1.08635005541779435134e+02));
+        sa = MLSIMDFmadd(w, sa, SIMD::Set1(4.29008140027567833386e+02));
+        sa = MLSIMDFmadd(w, sa, SIMD::Set1(6.45387271733267880336e+02));
+        sa = MLSIMDFmadd(w, sa, SIMD::Set1(4.34565877475229228821e+02));
+        sa = MLSIMDFmadd(w, sa, SIMD::Set1(1.37657754143519042600e+02));
+        sa = MLSIMDFmadd(w, sa, SIMD::Set1(1.96512716674392571292e+01));
+        sa = MLSIMDFmadd(w, sa, one);
+
+        SIMD rb = MLSIMDFmadd(w, SIMD::Set1(-4.83519191608651397019e+02), SIMD::Set1(-1.02509513161107724954e+03));
+        rb = MLSIMDFmadd(w, rb, SIMD::Set1(-6.37566443368389627722e+02));
+        rb = MLSIMDFmadd(w, rb, SIMD::Set1(-1.60636384855821916062e+02));
+        rb = MLSIMDFmadd(w, rb, SIMD::Set1(-1.77579549177547519889e+01));
+        rb = MLSIMDFmadd(w, rb, SIMD::Set1(-7.99283237680523006574e-01));
+        rb = MLSIMDFmadd(w, rb, SIMD::Set1(-9.86494292470009928597e-03));
+        SIMD sb = MLSIMDFmadd(w, SIMD::Set1(-2.24409524465858183362e+01), SIMD::Set1(4.74528541206955367215e+02));
+        sb = MLSIMDFmadd(w, sb, SIMD::Set1(2.55305040643316442583e+03));
+        sb = MLSIMDFmadd(w, sb, SIMD::Set1(3.19985821950859553908e+03));
+        sb = MLSIMDFmadd(w, sb, SIMD::Set1(1.53672958608443695994e+03));
+        sb = MLSIMDFmadd(w, sb, SIMD::Set1(3.25792512996573918826e+02));
+        sb = MLSIMDFmadd(w, sb, SIMD::Set1(3.03380607434824582924e+01));
+        sb = MLSIMDFmadd(w, sb, one);
+
+        const SIMD rs = MLSIMDSelect(MLSIMDCmpLt(x, SIMD::Set1(2.85714285714285714286)), ra / sa, rb / sb);
+
+        // x^2 is split at x_hi = x with the low 32 mantissa bits cleared, x_hi^2 is exact
+        const SIMD xhi = MLSIMDAnd(x, SIMD::Set1(MLBitCast<double>(std::uint64_t(0xffffffff00000000ull))));
+        const SIMD e = MLSIMDExp(MLSIMDFmsub(SIMD::SetZero() - xhi, xhi, SIMD::Set1(0.5625))) *
+          MLSIMDExp(MLSIMDFmadd(xhi - x, xhi + x, rs));
+        res = MLSIMDSelect(tailMask, one - e / x, res);
+      }
+
+      // erf is odd, the sign of the argument is copied onto the result
+      return MLSIMDOr(res, MLSIMDAnd(a, SIMD::Set1(-0.0)));
+    }
+  }
+
+  // default error function (element-wise with std::erf)
+  template<typename SIMD>
+  QM_ALWAYS_INLINE SIMD
+    MLSIMDErf(const TMLSIMD<SIMD>& a)
+  {
+    return Internal::MLSIMDScalarMap(~a, [](auto x) { return std::erf(x); });
+  }
+
+#if defined(ML_MATH_SSE)
+  // SSE 32 bit floating point error function
+  QM_ALWAYS_INLINE MLSIMD32fSSE MLSIMDErf(const MLSIMD32fSSE& a) { return Internal::MLSIMDErfFloat(a); }
+#endif
+
+#if defined(ML_MATH_SSE2)
+  // SSE2 64 bit floating point error function
+  QM_ALWAYS_INLINE MLSIMD64fSSE2 MLSIMDErf(const MLSIMD64fSSE2& a) { return Internal::MLSIMDErfDouble(a); }
+#endif
+
+#if defined(ML_MATH_AVX)
+  // AVX 32/64 bit floating point error function
+  QM_ALWAYS_INLINE MLSIMD32fAVX MLSIMDErf(const MLSIMD32fAVX& a) { return Internal::MLSIMDErfFloat(a); }
+  QM_ALWAYS_INLINE MLSIMD64fAVX MLSIMDErf(const MLSIMD64fAVX& a) { return Internal::MLSIMDErfDouble(a); }
+#endif
+
+#if defined(ML_MATH_AVX512F)
+  // AVX-512 32/64 bit floating point error function
+  QM_ALWAYS_INLINE MLSIMD32fAVX512 MLSIMDErf(const MLSIMD32fAVX512& a) { return Internal::MLSIMDErfFloat(a); }
+  QM_ALWAYS_INLINE MLSIMD64fAVX512 MLSIMDErf(const MLSIMD64fAVX512& a) { return Internal::MLSIMDErfDouble(a); }
+#endif
+
+}
+
+#endif
@@ -0,0 +1,284 @@
+// Copyright 2021, Philipp Neufeld
+
+#ifndef ML_MATH_SIMD_Exp_H_
+#define ML_MATH_SIMD_Exp_H_
+
+// Includes
+#include <cmath>
+#include <limits>
+
+#include "SIMD.h"
+#include "FMA.h"
+#include "MinMax.h"
+#include "Bitwise.h"
+
+namespace ML
+{
+
+  namespace Internal
+  {
+    // a clamped to [lo, hi], NaN stays NaN (max/min return their second operand if one of them is NaN)
+    template<typename SIMD>
+    QM_ALWAYS_INLINE SIMD MLSIMDClamp(const SIMD& a, const SIMD& lo, const SIMD& hi)
+    {
+      return MLSIMDMin(hi, MLSIMDMax(lo, a));
+    }
+
+    // 2^n for integers n in the range of the normal exponents: n + 2^23 + 127 (2^52 + 1023) holds the biased
+    // exponent in the low bits of the mantissa, from where it is shifted into the exponent field
+    template<typename SIMD>
+    QM_ALWAYS_INLINE SIMD MLSIMDPow2Float(const SIMD& n) { return MLSIMDShiftLeftBits<23>(n + SIMD::Set1(8388735.0f)); }
+    template<typename SIMD>
+    QM_ALWAYS_INLINE SIMD MLSIMDPow2Double(const SIMD& n) { return MLSIMDShiftLeftBits<52>(n + SIMD::Set1(4503599627371519.0)); }
+
+    // a * 2^n in two steps, so that the result overflows to inf and underflows gradually to zero
+    template<typename SIMD, typename Pow2>
+    QM_ALWAYS_INLINE SIMD MLSIMDScale(const SIMD& a, const SIMD& n, Pow2 pow2)
+    {
+      const SIMD n1 = MLSIMDRound(n * SIMD::Set1(TMLSIMDElementType_t<SIMD>(0.5)));
+      return a * pow2(n1) * pow2(n - n1);
+    }
+
+    // Exponent and mantissa of positive finite a (subnormals are scaled into the normal range first):
+    // a = m * 2^e with m in [sqrt(1/2), sqrt(2)). The biased exponent is shifted into the mantissa of 2^23
+    // (2^52), the mantissa gets the exponent of 1.
+    template<typename SIMD>
+    QM_ALWAYS_INLINE SIMD MLSIMDFrexpFloat(const SIMD& a, SIMD& e)
+    {
+      const auto subnormal = MLSIMDCmpLt(a, SIMD::Set1(std::numeric_limits<float>::min()));
+      const SIMD x = MLSIMDSelect(subnormal, a * SIMD::Set1(8388608.0f), a);
+      e = MLSIMDOr(MLSIMDShiftRightBits<23>(x), SIMD::Set1(8388608.0f)) -
+        MLSIMDSelect(subnormal, SIMD::Set1(8388608.0f + 127.0f + 23.0f), SIMD::Set1(8388608.0f + 127.0f));
+      SIMD m = MLSIMDOr(MLSIMDAnd(x, SIMD::Set1(MLBitCast<float>(0x007fffffu))), SIMD::Set1(1.0f));
+
+      const auto large = MLSIMDCmpLt(SIMD::Set1(1.41421356f), m);
+      e = MLSIMDSelect(large, e + SIMD::Set1(1.0f), e);
+      return MLSIMDSelect(large, m * SIMD::Set1(0.5f), m);
+    }
+
+    template<typename SIMD>
+    QM_ALWAYS_INLINE SIMD MLSIMDFrexpDouble(const SIMD& a, SIMD& e)
+    {
+      const auto subnormal = MLSIMDCmpLt(a, SIMD::Set1(std::numeric_limits<double>::min()));
+      const SIMD x = MLSIMDSelect(subnormal, a * SIMD::Set1(18014398509481984.0), a);
+      e = MLSIMDOr(MLSIMDShiftRightBits<52>(x), SIMD::Set1(4503599627370496.0)) -
+        MLSIMDSelect(subnormal, SIMD::Set1(4503599627370496.0 + 1023.0 + 54.0), SIMD::Set1(4503599627370496.0 + 1023.0));
+      SIMD m = MLSIMDOr(MLSIMDAnd(x, SIMD::Set1(MLBitCast<double>(0x000fffffffffffffull))), SIMD::Set1(1.0));
+
+      const auto large = MLSIMDCmpLt(SIMD::Set1(1.4142135623730950488), m);
+      e = MLSIMDSelect(large, e + SIMD::Set1(1.0), e);
+      return MLSIMDSelect(large, m * SIMD::Set1(0.5), m);
+    }
+
+    // Results of log for arguments that are not positive and finite: -inf for zero, inf for inf and NaN for
+    // negative arguments and NaN
+    template<typename SIMD>
+    QM_ALWAYS_INLINE SIMD MLSIMDLogSpecial(const SIMD& a, const SIMD& res)
+    {
+      using ET = TMLSIMDElementType_t<SIMD>;
+      const SIMD inf = SIMD::Set1(std::numeric_limits<ET>::infinity());
+      return MLSIMDSelect(MLSIMDCmpLt(SIMD::SetZero(), a),
+        MLSIMDSelect(MLSIMDCmpEq(a, inf), inf, res),
+        MLSIMDSelect(MLSIMDCmpEq(a, SIMD::SetZero()), SIMD::SetZero() - inf, SIMD::Set1(std::numeric_limits<ET>::quiet_NaN())));
+    }
+
+    // e^a = 2^n * e^r with n = round(a / ln 2) and |r| <= ln 2 / 2. ln 2 is split into a part with a short
+    // mantissa (n * C1 is exact) and a correction (Cody and Waite). Single precision: polynomial of degree 7
+    // (Cephes), double precision: Pade approximation e^r = 1 + 2 r P(r^2) / (Q(r^2) - r P(r^2)) (Cephes).
+    // Maximum error 1 ulp (float) and 2 ulp (double), arguments are clamped to the range where the result is neither zero nor inf.
+    template<typename SIMD>
+    QM_ALWAYS_INLINE SIMD MLSIMDExpFloat(const SIMD& a)
+    {
+      const SIMD x = MLSIMDClamp(a, SIMD::Set1(-104.0f), SIMD::Set1(89.0f));
+      const SIMD n = MLSIMDRound(x * SIMD::Set1(1.44269504088896341f));
+      SIMD r = MLSIMDFnmadd(n, SIMD::Set1(0.693359375f), x);
+      r = MLSIMDFnmadd(n, SIMD::Set1(-2.12194440e-4f), r);
+
+      SIMD p = MLSIMDFmadd(r, SIMD::Set1(1.9875691500e-4f), SIMD::Set1(1.3981999507e-3f));
+      p = MLSIMDFmadd(r, p, SIMD::Set1(8.3334519073e-3f));
+      p = MLSIMDFmadd(r, p, SIMD::Set1(4.1665795894e-2f));
+      p = MLSIMDFmadd(r, p, SIMD::Set1(1.6666665459e-1f));
+      p = MLSIMDFmadd(r, p, SIMD::Set1(5.0000001201e-1f));
+      p = MLSIMDFmadd(p, r * r, r) + SIMD::Set1(1.0f);
+
+      return MLSIMDScale(p, n, [](const SIMD& k) { return MLSIMDPow2Float(k); });
+    }
+
+    template<typename SIMD>
+    QM_ALWAYS_INLINE SIMD MLSIMDExpDouble(const SIMD& a)
+    {
+      const SIMD x = MLSIMDClamp(a, SIMD::Set1(-746.0), SIMD::Set1(710.0));
+      const SIMD n = MLSIMDRound(x * SIMD::Set1(1.4426950408889634074));
+      SIMD r = MLSIMDFnmadd(n, SIMD::Set1(6.93145751953125e-1), x);
+      r = MLSIMDFnmadd(n, SIMD::Set1(1.42860682030941723212e-6), r);
+      const SIMD r2 = r * r;
+
+      SIMD p = MLSIMDFmadd(r2, SIMD::Set1(1.26177193074810590878e-4), SIMD::Set1(3.02994407707441961300e-2));
+      p = r * MLSIMDFmadd(r2, p, SIMD::Set1(9.99999999999999999910e-1));
+      SIMD q = MLSIMDFmadd(r2, SIMD::Set1(3.00198505138664455042e-6), SIMD::Set1(2.52448340349684104192e-3));
+      q = MLSIMDFmadd(r2, q, SIMD::Set1(2.27265548208155028766e-1));
+      q = MLSIMDFmadd(r2, q, SIMD::Set1(2.00000000000000000009e0));
+      const SIMD e = MLSIMDFmadd(SIMD::Set1(2.0), p / (q - p), SIMD::Set1(1.0));
+
+      return MLSIMDScale(e, n, [](const SIMD& k) { return MLSIMDPow2Double(k); });
+    }
+
+    // log(a) = e ln 2 + log(m) with a = m * 2^e (see MLSIMDFrexpFloat). Single precision: log(1 + f) =
+    // f - f^2 / 2 + f^3 P(f) (Cephes), double precision: log(1 + f) = 2 atanh(s) with s = f / (2 + f) and
+    // a polynomial in s^2 (fdlibm). ln 2 is split as in MLSIMDExpFloat. Maximum error 1 ulp.
+    template<typename SIMD>
+    QM_ALWAYS_INLINE SIMD MLSIMDLogFloat(const SIMD& a)
+    {
+      SIMD e;
+      const SIMD f = MLSIMDFrexpFloat(a, e) - SIMD::Set1(1.0f);
+      const SIMD f2 = f * f;
+
+      SIMD p = MLSIMDFmadd(f, SIMD::Set1(7.0376836292e-2f), SIMD::Set1(-1.1514610310e-1f));
+      p = MLSIMDFmadd(f, p, SIMD::Set1(1.1676998740e-1f));
+      p = MLSIMDFmadd(f, p, SIMD::Set1(-1.2420140846e-1f));
+      p = MLSIMDFmadd(f, p, SIMD::Set1(1.4249322787e-1f));
+      p = MLSIMDFmadd(f, p, SIMD::Set1(-1.6668057665e-1f));
+      p = MLSIMDFmadd(f, p, SIMD::Set1(2.0000714765e-1f));
+      p = MLSIMDFmadd(f, p, SIMD::Set1(-2.4999993993e-1f));
+      p = MLSIMDFmadd(f, p, SIMD::Set1(3.3333331174e-1f));
+
+      SIMD y = p * f * f2;
+      y = MLSIMDFmadd(e, SIMD::Set1(-2.12194440e-4f), y);
+      y = MLSIMDFnmadd(SIMD::Set1(0.5f), f2, y);
+      const SIMD res = MLSIMDFmadd(e, SIMD::Set1(0.693359375f), f + y);
+      return MLSIMDLogSpecial(a, res);
+    }
+
+    template<typename SIMD>
+    QM_ALWAYS_INLINE SIMD MLSIMDLogDouble(const SIMD& a)
+    {
+      SIMD e;
+      const SIMD f = MLSIMDFrexpDouble(a, e) - SIMD::Set1(1.0);
+      const SIMD s = f / (SIMD::Set1(2.0) + f);
+      const SIMD z = s * s;
+      const SIMD w = z * z;
+
+      SIMD t1 = MLSIMDFmadd(w, SIMD::Set1(1.531383769920937332e-01), SIMD::Set1(2.222219843214978396e-01));
+      t1 = w * MLSIMDFmadd(w, t1, SIMD::Set1(3.999999999940941908e-01));
+      SIMD t2 = MLSIMDFmadd(w, SIMD::Set1(1.479819860511658591e-01), SIMD::Set1(1.818357216161805012e-01));
+      t2 = MLSIMDFmadd(w, t2, SIMD::Set1(2.857142874366239149e-01));
+      t2 = z * MLSIMDFmadd(w, t2, SIMD::Set1(6.666666666666735130e-01));
+      const SIMD hfsq = SIMD::Set1(0.5) * f * f;
+
+      const SIMD lo = MLSIMDFmadd(s, hfsq + t1 + t2, e * SIMD::Set1(1.90821492927058770002e-10));
+      const SIMD res = MLSIMDFmadd(e, SIMD::Set1(6.93147180369123816490e-01), f - (hfsq - lo));
+      return MLSIMDLogSpecial(a, res);
+    }
+
+    // a^b = e^(b log |a|) with the vectorized exp and log. Negative bases give NaN unless b is an integer
+    // (the sign is negative for odd b), a^0 and 1^b are 1. The rounding error of b log |a| is amplified by
+    // |b log |a||: about 20 ulp for results around 1e+-5 and 50 ulp around 1e+-20.
+    template<typename SIMD>
+    QM_ALWAYS_INLINE SIMD MLSIMDPowVectorized(const SIMD& a, const SIMD& b)
+    {
+      using ET = TMLSIMDElementType_t<SIMD>;
+      const SIMD one = SIMD::Set1(ET(1));
+      const SIMD res = MLSIMDExp(b * MLSIMDLog(MLSIMDAbs(a)));
+
+      const SIMD h = b * SIMD::Set1(ET(0.5));
+      const SIMD sign = MLSIMDSelect(MLSIMDCmpEq(MLSIMDRound(h), h), one, SIMD::SetZero() - one);
+      const SIMD negative = MLSIMDSelect(MLSIMDCmpEq(MLSIMDRound(b), b), sign * res, SIMD::Set1(std::numeric_limits<ET>::quiet_NaN()));
+
+      const SIMD pow = MLSIMDSelect(MLSIMDCmpLt(a, SIMD::SetZero()), negative, res);
+      return MLSIMDSelect(MLSIMDCmpEq(b, SIMD::SetZero()), one, MLSIMDSelect(MLSIMDCmpEq(a, one), one, pow));
+    }
+
+    // 1 / (1 + e^-a) for a >= 0 and e^a / (1 + e^a) for a < 0, both from e = e^-|a| which cannot overflow.
+    // Maximum error 3 ulp.
+    template<typename SIMD>
+    QM_ALWAYS_INLINE SIMD MLSIMDSigmoidVectorized(const SIMD& a)
+    {
+      const SIMD one = SIMD::Set1(TMLSIMDElementType_t<SIMD>(1));
+      const SIMD e = MLSIMDExp(SIMD::SetZero() - MLSIMDAbs(a));
+      const SIMD inv = one / (one + e);
+      return MLSIMDSelect(MLSIMDCmpLt(a, SIMD::SetZero()), e * inv, inv);
+    }
+  }
+
+  // default exponential, logarithm, power and logistic sigmoid 1 / (1 + e^-a) (element-wise with std::exp,
+  // std::log and std::pow)
+  template<typename SIMD>
+  QM_ALWAYS_INLINE SIMD
+    MLSIMDExp(const TMLSIMD<SIMD>& a)
+  {
+    return Internal::MLSIMDScalarMap(~a, [](auto x) { return std::exp(x); });
+  }
+
+  template<typename SIMD>
+  QM_ALWAYS_INLINE SIMD
+    MLSIMDLog(const TMLSIMD<SIMD>& a)
+  {
+    return Internal::MLSIMDScalarMap(~a, [](auto x) { return std::log(x); });
+  }
+
+  template<typename SIMD>
+  QM_ALWAYS_INLINE SIMD
+    MLSIMDPow(const TMLSIMD<SIMD>& a, const TMLSIMD<SIMD>& b)
+  {
+    return Internal::MLSIMDScalarMap(~a, ~b, [](auto x, auto y) { return std::pow(x, y); });
+  }
+
+  template<typename SIMD>
+  QM_ALWAYS_INLINE SIMD
+    MLSIMDSigmoid(const TMLSIMD<SIMD>& a)
+  {
+    using ET = TMLSIMDElementType_t<SIMD>;
+    return Internal::MLSIMDScalarMap(~a, [](ET x) { return ET(1) / (ET(1) + std::exp(-x)); });
+  }
+
+#if defined(ML_MATH_SSE2)
+  // SSE2 32/64 bit floating point exponential and logarithm
+  QM_ALWAYS_INLINE MLSIMD32fSSE MLSIMDExp(const MLSIMD32fSSE& a) { return Internal::MLSIMDExpFloat(a); }
+  QM_ALWAYS_INLINE MLSIMD32fSSE MLSIMDLog(const MLSIMD32fSSE& a) { return Internal::MLSIMDLogFloat(a); }
+  QM_ALWAYS_INLINE MLSIMD64fSSE2 MLSIMDExp(const MLSIMD64fSSE2& a) { return Internal::MLSIMDExpDouble(a); }
+  QM_ALWAYS_INLINE MLSIMD64fSSE2 MLSIMDLog(const MLSIMD64fSSE2& a) { return Internal::MLSIMDLogDouble(a); }
+#endif
+
+#if defined(ML_MATH_AVX)
+  // AVX 32/64 bit floating point exponential and logarithm
+  QM_ALWAYS_INLINE MLSIMD32fAVX MLSIMDExp(const MLSIMD32fAVX& a) { return Internal::MLSIMDExpFloat(a); }
+  QM_ALWAYS_INLINE MLSIMD32fAVX MLSIMDLog(const MLSIMD32fAVX& a) { return Internal::MLSIMDLogFloat(a); }
+  QM_ALWAYS_INLINE MLSIMD64fAVX MLSIMDExp(const MLSIMD64fAVX& a) { return Internal::MLSIMDExpDouble(a); }
+  QM_ALWAYS_INLINE MLSIMD64fAVX MLSIMDLog(const MLSIMD64fAVX& a) { return Internal::MLSIMDLogDouble(a); }
+#endif
+
+#if defined(ML_MATH_AVX512F)
+  // AVX-512 32/64 bit floating point exponential and logarithm
+  QM_ALWAYS_INLINE MLSIMD32fAVX512 MLSIMDExp(const MLSIMD32fAVX512& a) { return Internal::MLSIMDExpFloat(a); }
+  QM_ALWAYS_INLINE MLSIMD32fAVX512 MLSIMDLog(const MLSIMD32fAVX512& a) { return Internal::MLSIMDLogFloat(a); }
+  QM_ALWAYS_INLINE MLSIMD64fAVX512 MLSIMDExp(const MLSIMD64fAVX512& a) { return Internal::MLSIMDExpDouble(a); }
+  QM_ALWAYS_INLINE MLSIMD64fAVX512 MLSIMDLog(const MLSIMD64fAVX512& a) { return Internal::MLSIMDLogDouble(a); }
+#endif
+
+#if defined(ML_MATH_SSE2)
+  // SSE2 32/64 bit floating point power and sigmoid
+  QM_ALWAYS_INLINE MLSIMD32fSSE MLSIMDPow(const MLSIMD32fSSE& a, const MLSIMD32fSSE& b) { return Internal::MLSIMDPowVectorized(a, b); }
+  QM_ALWAYS_INLINE MLSIMD32fSSE MLSIMDSigmoid(const MLSIMD32fSSE& a) { return Internal::MLSIMDSigmoidVectorized(a); }
+  QM_ALWAYS_INLINE MLSIMD64fSSE2 MLSIMDPow(const MLSIMD64fSSE2& a, const MLSIMD64fSSE2& b) { return Internal::MLSIMDPowVectorized(a, b); }
+  QM_ALWAYS_INLINE MLSIMD64fSSE2 MLSIMDSigmoid(const MLSIMD64fSSE2& a) { return Internal::MLSIMDSigmoidVectorized(a); }
+#endif
+
+#if defined(ML_MATH_AVX)
+  // AVX 32/64 bit floating point power and sigmoid
+  QM_ALWAYS_INLINE MLSIMD32fAVX MLSIMDPow(const MLSIMD32fAVX& a, const MLSIMD32fAVX& b) { return Internal::MLSIMDPowVectorized(a, b); }
+  QM_ALWAYS_INLINE MLSIMD32fAVX MLSIMDSigmoid(const MLSIMD32fAVX& a) { return Internal::MLSIMDSigmoidVectorized(a); }
+  QM_ALWAYS_INLINE MLSIMD64fAVX MLSIMDPow(const MLSIMD64fAVX& a, const MLSIMD64fAVX& b) { return Internal::MLSIMDPowVectorized(a, b); }
+  QM_ALWAYS_INLINE MLSIMD64fAVX MLSIMDSigmoid(const MLSIMD64fAVX& a) { return Internal::MLSIMDSigmoidVectorized(a); }
+#endif
+
+#if defined(ML_MATH_AVX512F)
+  // AVX-512 32/64 bit floating point power and sigmoid
+  QM_ALWAYS_INLINE MLSIMD32fAVX512 MLSIMDPow(const MLSIMD32fAVX512& a, const MLSIMD32fAVX512& b) { return Internal::MLSIMDPowVectorized(a, b); }
+  QM_ALWAYS_INLINE MLSIMD32fAVX512 MLSIMDSigmoid(const MLSIMD32fAVX512& a) { return Internal::MLSIMDSigmoidVectorized(a); }
+  QM_ALWAYS_INLINE MLSIMD64fAVX512 MLSIMDPow(const MLSIMD64fAVX512& a, const MLSIMD64fAVX512& b) { return Internal::MLSIMDPowVectorized(a, b); }
+  QM_ALWAYS_INLINE MLSIMD64fAVX512 MLSIMDSigmoid(const MLSIMD64fAVX512& a) { return Internal::MLSIMDSigmoidVectorized(a); }
+#endif
+
+}
+
+#endif
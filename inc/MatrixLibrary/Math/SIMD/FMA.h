@@ -7,12 +7,13 @@
 #include "SIMD.h"
 
 #include "Add.h"
+#include "Sub.h"
 #include "Mul.h"
 
 namespace ML
 {
-  
-  // default fmadd
+
+  // default fmadd (m1 * m2 + a)
   template<typename SIMD>
   QM_ALWAYS_INLINE SIMD
     MLSIMDFmadd(const TMLSIMD<SIMD>& m1, const TMLSIMD<SIMD>& m2, const TMLSIMD<SIMD>& a)
@@ -20,22 +21,311 @@ namespace ML
     return (~m1) * (~m2) + (~a);
   }
 
+  // default fmsub (m1 * m2 - a)
+  template<typename SIMD>
+  QM_ALWAYS_INLINE SIMD
+    MLSIMDFmsub(const TMLSIMD<SIMD>& m1, const TMLSIMD<SIMD>& m2, const TMLSIMD<SIMD>& a)
+  {
+    return (~m1) * (~m2) - (~a);
+  }
+
+  // default fnmadd (a - m1 * m2)
+  template<typename SIMD>
+  QM_ALWAYS_INLINE SIMD
+    MLSIMDFnmadd(const TMLSIMD<SIMD>& m1, const TMLSIMD<SIMD>& m2, const TMLSIMD<SIMD>& a)
+  {
+    return (~a) - (~m1) * (~m2);
+  }
+
 #if defined(ML_MATH_FMA) && defined(ML_MATH_SSE)
-  // SSE 32 bit floating point multiplication
-  QM_ALWAYS_INLINE MLSIMD32fSSE 
+  // SSE 32 bit floating point fused multiply-add
+  QM_ALWAYS_INLINE MLSIMD32fSSE
     MLSIMDFmadd(const MLSIMD32fSSE& m1, const MLSIMD32fSSE& m2, const MLSIMD32fSSE& a)
   {
     return _mm_fmadd_ps((~m1).m_value, (~m2).m_value, (~a).m_value);
   }
+
+  QM_ALWAYS_INLINE MLSIMD32fSSE
+    MLSIMDFmsub(const MLSIMD32fSSE& m1, const MLSIMD32fSSE& m2, const MLSIMD32fSSE& a)
+  {
+    return _mm_fmsub_ps((~m1).m_value, (~m2).m_value, (~a).m_value);
+  }
+
+  QM_ALWAYS_INLINE MLSIMD32fSSE
+    MLSIMDFnmadd(const MLSIMD32fSSE& m1, const MLSIMD32fSSE& m2, const MLSIMD32fSSE& a)
+  {
+    return _mm_fnmadd_ps((~m1).m_value, (~m2).m_value, (~a).m_value);
+  }
+
+  // SSE 32 bit complex floating point fused multiply-add
+  // (same scheme as the complex multiplication but with fmaddsub instead of addsub)
+  QM_ALWAYS_INLINE MLSIMD32cfSSE
+    MLSIMDFmadd(const MLSIMD32cfSSE& m1, const MLSIMD32cfSSE& m2, const MLSIMD32cfSSE& a)
+  {
+    __m128 re = _mm_shuffle_ps(m1.m_value, m1.m_value, _MM_SHUFFLE(2,2,0,0));
+    __m128 im = _mm_shuffle_ps(m1.m_value, m1.m_value, _MM_SHUFFLE(3,3,1,1));
+    __m128 sw = _mm_shuffle_ps(m2.m_value, m2.m_value, _MM_SHUFFLE(2,3,0,1));
+    __m128 t = _mm_fmaddsub_ps(im, sw, a.m_value);
+    return _mm_fmaddsub_ps(re, m2.m_value, t);
+  }
+
+  QM_ALWAYS_INLINE MLSIMD32cfSSE
+    MLSIMDFmsub(const MLSIMD32cfSSE& m1, const MLSIMD32cfSSE& m2, const MLSIMD32cfSSE& a)
+  {
+    __m128 re = _mm_shuffle_ps(m1.m_value, m1.m_value, _MM_SHUFFLE(2,2,0,0));
+    __m128 im = _mm_shuffle_ps(m1.m_value, m1.m_value, _MM_SHUFFLE(3,3,1,1));
+    __m128 sw = _mm_shuffle_ps(m2.m_value, m2.m_value, _MM_SHUFFLE(2,3,0,1));
+    __m128 t = _mm_fmsubadd_ps(im, sw, a.m_value);
+    return _mm_fmaddsub_ps(re, m2.m_value, t);
+  }
+
+  QM_ALWAYS_INLINE MLSIMD32cfSSE
+    MLSIMDFnmadd(const MLSIMD32cfSSE& m1, const MLSIMD32cfSSE& m2, const MLSIMD32cfSSE& a)
+  {
+    MLSIMD32cfSSE neg = _mm_xor_ps(m1.m_value, _mm_set1_ps(-0.0f));
+    return MLSIMDFmadd(neg, m2, a);
+  }
+#endif
+
+#if defined(ML_MATH_FMA) && defined(ML_MATH_SSE2)
+  // SSE2 64 bit floating point fused multiply-add
+  QM_ALWAYS_INLINE MLSIMD64fSSE2
+    MLSIMDFmadd(const MLSIMD64fSSE2& m1, const MLSIMD64fSSE2& m2, const MLSIMD64fSSE2& a)
+  {
+    return _mm_fmadd_pd((~m1).m_value, (~m2).m_value, (~a).m_value);
+  }
+
+  QM_ALWAYS_INLINE MLSIMD64fSSE2
+    MLSIMDFmsub(const MLSIMD64fSSE2& m1, const MLSIMD64fSSE2& m2, const MLSIMD64fSSE2& a)
+  {
+    return _mm_fmsub_pd((~m1).m_value, (~m2).m_value, (~a).m_value);
+  }
+
+  QM_ALWAYS_INLINE MLSIMD64fSSE2
+    MLSIMDFnmadd(const MLSIMD64fSSE2& m1, const MLSIMD64fSSE2& m2, const MLSIMD64fSSE2& a)
+  {
+    return _mm_fnmadd_pd((~m1).m_value, (~m2).m_value, (~a).m_value);
+  }
+
+  // SSE2 64 bit complex floating point fused multiply-add
+  QM_ALWAYS_INLINE MLSIMD64cfSSE2
+    MLSIMDFmadd(const MLSIMD64cfSSE2& m1, const MLSIMD64cfSSE2& m2, const MLSIMD64cfSSE2& a)
+  {
+    __m128d re = _mm_shuffle_pd(m1.m_value, m1.m_value, _MM_SHUFFLE2(0,0));
+    __m128d im = _mm_shuffle_pd(m1.m_value, m1.m_value, _MM_SHUFFLE2(1,1));
+    __m128d sw = _mm_shuffle_pd(m2.m_value, m2.m_value, _MM_SHUFFLE2(0,1));
+    __m128d t = _mm_fmaddsub_pd(im, sw, a.m_value);
+    return _mm_fmaddsub_pd(re, m2.m_value, t);
+  }
+
+  QM_ALWAYS_INLINE MLSIMD64cfSSE2
+    MLSIMDFmsub(const MLSIMD64cfSSE2& m1, const MLSIMD64cfSSE2& m2, const MLSIMD64cfSSE2& a)
+  {
+    __m128d re = _mm_shuffle_pd(m1.m_value, m1.m_value, _MM_SHUFFLE2(0,0));
+    __m128d im = _mm_shuffle_pd(m1.m_value, m1.m_value, _MM_SHUFFLE2(1,1));
+    __m128d sw = _mm_shuffle_pd(m2.m_value, m2.m_value, _MM_SHUFFLE2(0,1));
+    __m128d t = _mm_fmsubadd_pd(im, sw, a.m_value);
+    return _mm_fmaddsub_pd(re, m2.m_value, t);
+  }
+
+  QM_ALWAYS_INLINE MLSIMD64cfSSE2
+    MLSIMDFnmadd(const MLSIMD64cfSSE2& m1, const MLSIMD64cfSSE2& m2, const MLSIMD64cfSSE2& a)
+  {
+    MLSIMD64cfSSE2 neg = _mm_xor_pd(m1.m_value, _mm_set1_pd(-0.0));
+    return MLSIMDFmadd(neg, m2, a);
+  }
 #endif
 
 #if defined(ML_MATH_FMA) && defined(ML_MATH_AVX)
-  // AVX 32 bit floating point multiplication
-  QM_ALWAYS_INLINE MLSIMD32fAVX 
+  // AVX 32 bit floating point fused multiply-add
+  QM_ALWAYS_INLINE MLSIMD32fAVX
     MLSIMDFmadd(const MLSIMD32fAVX& m1, const MLSIMD32fAVX& m2, const MLSIMD32fAVX& a)
   {
     return _mm256_fmadd_ps((~m1).m_value, (~m2).m_value, (~a).m_value);
   }
+
+  QM_ALWAYS_INLINE MLSIMD32fAVX
+    MLSIMDFmsub(const MLSIMD32fAVX& m1, const MLSIMD32fAVX& m2, const MLSIMD32fAVX& a)
+  {
+    return _mm256_fmsub_ps((~m1).m_value, (~m2).m_value, (~a).m_value);
+  }
+
+  QM_ALWAYS_INLINE MLSIMD32fAVX
+    MLSIMDFnmadd(const MLSIMD32fAVX& m1, const MLSIMD32fAVX& m2, const MLSIMD32fAVX& a)
+  {
+    return _mm256_fnmadd_ps((~m1).m_value, (~m2).m_value, (~a).m_value);
+  }
+
+  // AVX 32 bit complex floating point fused multiply-add
+  QM_ALWAYS_INLINE MLSIMD32cfAVX
+    MLSIMDFmadd(const MLSIMD32cfAVX& m1, const MLSIMD32cfAVX& m2, const MLSIMD32cfAVX& a)
+  {
+    __m256 re = _mm256_shuffle_ps(m1.m_value, m1.m_value, _MM_SHUFFLE(2,2,0,0));
+    __m256 im = _mm256_shuffle_ps(m1.m_value, m1.m_value, _MM_SHUFFLE(3,3,1,1));
+    __m256 sw = _mm256_shuffle_ps(m2.m_value, m2.m_value, _MM_SHUFFLE(2,3,0,1));
+    __m256 t = _mm256_fmaddsub_ps(im, sw, a.m_value);
+    return _mm256_fmaddsub_ps(re, m2.m_value, t);
+  }
+
+  QM_ALWAYS_INLINE MLSIMD32cfAVX
+    MLSIMDFmsub(const MLSIMD32cfAVX& m1, const MLSIMD32cfAVX& m2, const MLSIMD32cfAVX& a)
+  {
+    __m256 re = _mm256_shuffle_ps(m1.m_value, m1.m_value, _MM_SHUFFLE(2,2,0,0));
+    __m256 im = _mm256_shuffle_ps(m1.m_value, m1.m_value, _MM_SHUFFLE(3,3,1,1));
+    __m256 sw = _mm256_shuffle_ps(m2.m_value, m2.m_value, _MM_SHUFFLE(2,3,0,1));
+    __m256 t = _mm256_fmsubadd_ps(im, sw, a.m_value);
+    return _mm256_fmaddsub_ps(re, m2.m_value, t);
+  }
+
+  QM_ALWAYS_INLINE MLSIMD32cfAVX
+    MLSIMDFnmadd(const MLSIMD32cfAVX& m1, const MLSIMD32cfAVX& m2, const MLSIMD32cfAVX& a)
+  {
+    MLSIMD32cfAVX neg = _mm256_xor_ps(m1.m_value, _mm256_set1_ps(-0.0f));
+    return MLSIMDFmadd(neg, m2, a);
+  }
+
+  // AVX 64 bit floating point fused multiply-add
+  QM_ALWAYS_INLINE MLSIMD64fAVX
+    MLSIMDFmadd(const MLSIMD64fAVX& m1, const MLSIMD64fAVX& m2, const MLSIMD64fAVX& a)
+  {
+    return _mm256_fmadd_pd((~m1).m_value, (~m2).m_value, (~a).m_value);
+  }
+
+  QM_ALWAYS_INLINE MLSIMD64fAVX
+    MLSIMDFmsub(const MLSIMD64fAVX& m1, const MLSIMD64fAVX& m2, const MLSIMD64fAVX& a)
+  {
+    return _mm256_fmsub_pd((~m1).m_value, (~m2).m_value, (~a).m_value);
+  }
+
+  QM_ALWAYS_INLINE MLSIMD64fAVX
+    MLSIMDFnmadd(const MLSIMD64fAVX& m1, const MLSIMD64fAVX& m2, const MLSIMD64fAVX& a)
+  {
+    return _mm256_fnmadd_pd((~m1).m_value, (~m2).m_value, (~a).m_value);
+  }
+
+  // AVX 64 bit complex floating point fused multiply-add
+  QM_ALWAYS_INLINE MLSIMD64cfAVX
+    MLSIMDFmadd(const MLSIMD64cfAVX& m1, const MLSIMD64cfAVX& m2, const MLSIMD64cfAVX& a)
+  {
+    __m256d re = _mm256_shuffle_pd(m1.m_value, m1.m_value, 0b0000);
+    __m256d im = _mm256_shuffle_pd(m1.m_value, m1.m_value, 0b1111);
+    __m256d sw = _mm256_shuffle_pd(m2.m_value, m2.m_value, 0b0101);
+    __m256d t = _mm256_fmaddsub_pd(im, sw, a.m_value);
+    return _mm256_fmaddsub_pd(re, m2.m_value, t);
+  }
+
+  QM_ALWAYS_INLINE MLSIMD64cfAVX
+    MLSIMDFmsub(const MLSIMD64cfAVX& m1, const MLSIMD64cfAVX& m2, const MLSIMD64cfAVX& a)
+  {
+    __m256d re = _mm256_shuffle_pd(m1.m_value, m1.m_value, 0b0000);
+    __m256d im = _mm256_shuffle_pd(m1.m_value, m1.m_value, 0b1111);
+    __m256d sw = _mm256_shuffle_pd(m2.m_value, m2.m_value, 0b0101);
+    __m256d t = _mm256_fmsubadd_pd(im, sw, a.m_value);
+    return _mm256_fmaddsub_pd(re, m2.m_value, t);
+  }
+
+  QM_ALWAYS_INLINE MLSIMD64cfAVX
+    MLSIMDFnmadd(const MLSIMD64cfAVX& m1, const MLSIMD64cfAVX& m2, const MLSIMD64cfAVX& a)
+  {
+    MLSIMD64cfAVX neg = _mm256_xor_pd(m1.m_value, _mm256_set1_pd(-0.0));
+    return MLSIMDFmadd(neg, m2, a);
+  }
+#endif
+
+#if defined(ML_MATH_AVX512F)
+  // AVX-512 32 bit floating point fused multiply-add
+  QM_ALWAYS_INLINE MLSIMD32fAVX512
+    MLSIMDFmadd(const MLSIMD32fAVX512& m1, const MLSIMD32fAVX512& m2, const MLSIMD32fAVX512& a)
+  {
+    return _mm512_fmadd_ps(m1.m_value, m2.m_value, a.m_value);
+  }
+
+  QM_ALWAYS_INLINE MLSIMD32fAVX512
+    MLSIMDFmsub(const MLSIMD32fAVX512& m1, const MLSIMD32fAVX512& m2, const MLSIMD32fAVX512& a)
+  {
+    return _mm512_fmsub_ps(m1.m_value, m2.m_value, a.m_value);
+  }
+
+  QM_ALWAYS_INLINE MLSIMD32fAVX512
+    MLSIMDFnmadd(const MLSIMD32fAVX512& m1, const MLSIMD32fAVX512& m2, const MLSIMD32fAVX512& a)
+  {
+    return _mm512_fnmadd_ps(m1.m_value, m2.m_value, a.m_value);
+  }
+
+  // AVX-512 32 bit complex floating point fused multiply-add
+  QM_ALWAYS_INLINE MLSIMD32cfAVX512
+    MLSIMDFmadd(const MLSIMD32cfAVX512& m1, const MLSIMD32cfAVX512& m2, const MLSIMD32cfAVX512& a)
+  {
+    __m512 re = _mm512_shuffle_ps(m1.m_value, m1.m_value, _MM_SHUFFLE(2,2,0,0));
+    __m512 im = _mm512_shuffle_ps(m1.m_value, m1.m_value, _MM_SHUFFLE(3,3,1,1));
+    __m512 sw = _mm512_shuffle_ps(m2.m_value, m2.m_value, _MM_SHUFFLE(2,3,0,1));
+    __m512 t = _mm512_fmaddsub_ps(im, sw, a.m_value);
+    return _mm512_fmaddsub_ps(re, m2.m_value, t);
+  }
+
+  QM_ALWAYS_INLINE MLSIMD32cfAVX512
+    MLSIMDFmsub(const MLSIMD32cfAVX512& m1, const MLSIMD32cfAVX512& m2, const MLSIMD32cfAVX512& a)
+  {
+    __m512 re = _mm512_shuffle_ps(m1.m_value, m1.m_value, _MM_SHUFFLE(2,2,0,0));
+    __m512 im = _mm512_shuffle_ps(m1.m_value, m1.m_value, _MM_SHUFFLE(3,3,1,1));
+    __m512 sw = _mm512_shuffle_ps(m2.m_value, m2.m_value, _MM_SHUFFLE(2,3,0,1));
+    __m512 t = _mm512_fmsubadd_ps(im, sw, a.m_value);
+    return _mm512_fmaddsub_ps(re, m2.m_value, t);
+  }
+
+  QM_ALWAYS_INLINE MLSIMD32cfAVX512
+    MLSIMDFnmadd(const MLSIMD32cfAVX512& m1, const MLSIMD32cfAVX512& m2, const MLSIMD32cfAVX512& a)
+  {
+    MLSIMD32cfAVX512 neg = _mm512_sub_ps(_mm512_setzero_ps(), m1.m_value);
+    return MLSIMDFmadd(neg, m2, a);
+  }
+
+  // AVX-512 64 bit floating point fused multiply-add
+  QM_ALWAYS_INLINE MLSIMD64fAVX512
+    MLSIMDFmadd(const MLSIMD64fAVX512& m1, const MLSIMD64fAVX512& m2, const MLSIMD64fAVX512& a)
+  {
+    return _mm512_fmadd_pd(m1.m_value, m2.m_value, a.m_value);
+  }
+
+  QM_ALWAYS_INLINE MLSIMD64fAVX512
+    MLSIMDFmsub(const MLSIMD64fAVX512& m1, const MLSIMD64fAVX512& m2, const MLSIMD64fAVX512& a)
+  {
+    return _mm512_fmsub_pd(m1.m_value, m2.m_value, a.m_value);
+  }
+
+  QM_ALWAYS_INLINE MLSIMD64fAVX512
+    MLSIMDFnmadd(const MLSIMD64fAVX512& m1, const MLSIMD64fAVX512& m2, const MLSIMD64fAVX512& a)
+  {
+    return _mm512_fnmadd_pd(m1.m_value, m2.m_value, a.m_value);
+  }
+
+  // AVX-512 64 bit complex floating point fused multiply-add
+  QM_ALWAYS_INLINE MLSIMD64cfAVX512
+    MLSIMDFmadd(const MLSIMD64cfAVX512& m1, const MLSIMD64cfAVX512& m2, const MLSIMD64cfAVX512& a)
+  {
+    __m512d re = _mm512_shuffle_pd(m1.m_value, m1.m_value, 0x00);
+    __m512d im = _mm512_shuffle_pd(m1.m_value, m1.m_value, 0xFF);
+    __m512d sw = _mm512_shuffle_pd(m2.m_value, m2.m_value, 0x55);
+    __m512d t = _mm512_fmaddsub_pd(im, sw, a.m_value);
+    return _mm512_fmaddsub_pd(re, m2.m_value, t);
+  }
+
+  QM_ALWAYS_INLINE MLSIMD64cfAVX512
+    MLSIMDFmsub(const MLSIMD64cfAVX512& m1, const MLSIMD64cfAVX512& m2, const MLSIMD64cfAVX512& a)
+  {
+    __m512d re = _mm512_shuffle_pd(m1.m_value, m1.m_value, 0x00);
+    __m512d im = _mm512_shuffle_pd(m1.m_value, m1.m_value, 0xFF);
+    __m512d sw = _mm512_shuffle_pd(m2.m_value, m2.m_value, 0x55);
+    __m512d t = _mm512_fmsubadd_pd(im, sw, a.m_value);
+    return _mm512_fmaddsub_pd(re, m2.m_value, t);
+  }
+
+  QM_ALWAYS_INLINE MLSIMD64cfAVX512
+    MLSIMDFnmadd(const MLSIMD64cfAVX512& m1, const MLSIMD64cfAVX512& m2, const MLSIMD64cfAVX512& a)
+  {
+    MLSIMD64cfAVX512 neg = _mm512_sub_pd(_mm512_setzero_pd(), m1.m_value);
+    return MLSIMDFmadd(neg, m2, a);
+  }
 #endif
 
 }
@@ -0,0 +1,134 @@
+// Copyright 2021, Philipp Neufeld
+
+#ifndef ML_MATH_SIMD_MinMax_H_
+#define ML_MATH_SIMD_MinMax_H_
+
+// Includes
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <type_traits>
+
+#include "SIMD.h"
+
+namespace ML
+{
+
+  namespace Internal
+  {
+    // element-wise minimum / maximum through memory (see MLSIMDScalarDiv)
+    template<typename SIMD>
+    QM_ALWAYS_INLINE SIMD MLSIMDScalarMinMax(const SIMD& a, const SIMD& b, bool max)
+    {
+      using ET = TMLSIMDElementType_t<SIMD>;
+      alignas(SIMD) ET x[TMLSIMDSize_v<SIMD>];
+      alignas(SIMD) ET y[TMLSIMDSize_v<SIMD>];
+      SIMD::StoreAligned(a, x);
+      SIMD::StoreAligned(b, y);
+      for (std::size_t i = 0; i < TMLSIMDSize_v<SIMD>; i++)
+        x[i] = max ? std::max(x[i], y[i]) : std::min(x[i], y[i]);
+      return SIMD::LoadAligned(x);
+    }
+
+    // absolute value of an element (unsigned integers are returned as they are)
+    template<typename ET>
+    QM_ALWAYS_INLINE TMLEnableIf_t<std::is_unsigned<ET>::value, ET> MLScalarAbs(const ET& x) { return x; }
+    template<typename ET>
+    QM_ALWAYS_INLINE TMLEnableIf_t<!std::is_unsigned<ET>::value, ET> MLScalarAbs(const ET& x) { return static_cast<ET>(std::abs(x)); }
+
+    // element-wise absolute value through memory
+    template<typename SIMD>
+    QM_ALWAYS_INLINE SIMD MLSIMDScalarAbs(const SIMD& a)
+    {
+      using ET = TMLSIMDElementType_t<SIMD>;
+      alignas(SIMD) ET x[TMLSIMDSize_v<SIMD>];
+      SIMD::StoreAligned(a, x);
+      for (std::size_t i = 0; i < TMLSIMDSize_v<SIMD>; i++)
+        x[i] = MLScalarAbs(x[i]);
+      return SIMD::LoadAligned(x);
+    }
+  }
+
+  // default minimum / maximum (element-wise, not defined for complex numbers)
+  template<typename SIMD>
+  QM_ALWAYS_INLINE SIMD
+    MLSIMDMin(const TMLSIMD<SIMD>& a, const TMLSIMD<SIMD>& b)
+  {
+    return Internal::MLSIMDScalarMinMax<TMLDecaySIMDType_t<SIMD>>(~a, ~b, false);
+  }
+
+  template<typename SIMD>
+  QM_ALWAYS_INLINE SIMD
+    MLSIMDMax(const TMLSIMD<SIMD>& a, const TMLSIMD<SIMD>& b)
+  {
+    return Internal::MLSIMDScalarMinMax<TMLDecaySIMDType_t<SIMD>>(~a, ~b, true);
+  }
+
+  // default absolute value (element-wise, not defined for complex numbers)
+  template<typename SIMD>
+  QM_ALWAYS_INLINE SIMD
+    MLSIMDAbs(const TMLSIMD<SIMD>& a)
+  {
+    return Internal::MLSIMDScalarAbs<TMLDecaySIMDType_t<SIMD>>(~a);
+  }
+
+#if defined(ML_MATH_SSE)
+  // SSE 32 bit floating point minimum / maximum
+  QM_ALWAYS_INLINE MLSIMD32fSSE MLSIMDMin(const MLSIMD32fSSE& a, const MLSIMD32fSSE& b) { return _mm_min_ps(a.m_value, b.m_value); }
+  QM_ALWAYS_INLINE MLSIMD32fSSE MLSIMDMax(const MLSIMD32fSSE& a, const MLSIMD32fSSE& b) { return _mm_max_ps(a.m_value, b.m_value); }
+  // the absolute value clears the sign bit
+  QM_ALWAYS_INLINE MLSIMD32fSSE MLSIMDAbs(const MLSIMD32fSSE& a) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a.m_value); }
+#endif
+
+#if defined(ML_MATH_SSE2)
+  // SSE2 64 bit floating point minimum / maximum
+  QM_ALWAYS_INLINE MLSIMD64fSSE2 MLSIMDMin(const MLSIMD64fSSE2& a, const MLSIMD64fSSE2& b) { return _mm_min_pd(a.m_value, b.m_value); }
+  QM_ALWAYS_INLINE MLSIMD64fSSE2 MLSIMDMax(const MLSIMD64fSSE2& a, const MLSIMD64fSSE2& b) { return _mm_max_pd(a.m_value, b.m_value); }
+  QM_ALWAYS_INLINE MLSIMD64fSSE2 MLSIMDAbs(const MLSIMD64fSSE2& a) { return _mm_andnot_pd(_mm_set1_pd(-0.0), a.m_value); }
+#endif
+
+#if defined(ML_MATH_SSSE3)
+  // SSSE3 32 bit integer absolute value
+  QM_ALWAYS_INLINE MLSIMD32iSSE2 MLSIMDAbs(const MLSIMD32iSSE2& a) { return _mm_abs_epi32(a.m_value); }
+#endif
+
+#if defined(ML_MATH_SSE4_1)
+  // SSE4.1 32 bit integer minimum / maximum
+  QM_ALWAYS_INLINE MLSIMD32iSSE2 MLSIMDMin(const MLSIMD32iSSE2& a, const MLSIMD32iSSE2& b) { return _mm_min_epi32(a.m_value, b.m_value); }
+  QM_ALWAYS_INLINE MLSIMD32iSSE2 MLSIMDMax(const MLSIMD32iSSE2& a, const MLSIMD32iSSE2& b) { return _mm_max_epi32(a.m_value, b.m_value); }
+#endif
+
+#if defined(ML_MATH_AVX)
+  // AVX 32/64 bit floating point minimum / maximum
+  QM_ALWAYS_INLINE MLSIMD32fAVX MLSIMDMin(const MLSIMD32fAVX& a, const MLSIMD32fAVX& b) { return _mm256_min_ps(a.m_value, b.m_value); }
+  QM_ALWAYS_INLINE MLSIMD32fAVX MLSIMDMax(const MLSIMD32fAVX& a, const MLSIMD32fAVX& b) { return _mm256_max_ps(a.m_value, b.m_value); }
+  QM_ALWAYS_INLINE MLSIMD64fAVX MLSIMDMin(const MLSIMD64fAVX& a, const MLSIMD64fAVX& b) { return _mm256_min_pd(a.m_value, b.m_value); }
+  QM_ALWAYS_INLINE MLSIMD64fAVX MLSIMDMax(const MLSIMD64fAVX& a, const MLSIMD64fAVX& b) { return _mm256_max_pd(a.m_value, b.m_value); }
+  QM_ALWAYS_INLINE MLSIMD32fAVX MLSIMDAbs(const MLSIMD32fAVX& a) { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a.m_value); }
+  QM_ALWAYS_INLINE MLSIMD64fAVX MLSIMDAbs(const MLSIMD64fAVX& a) { return _mm256_andnot_pd(_mm256_set1_pd(-0.0), a.m_value); }
+#endif
+
+#if defined(ML_MATH_AVX2)
+  // AVX2 32 bit integer minimum / maximum
+  QM_ALWAYS_INLINE MLSIMD32iAVX2 MLSIMDMin(const MLSIMD32iAVX2& a, const MLSIMD32iAVX2& b) { return _mm256_min_epi32(a.m_value, b.m_value); }
+  QM_ALWAYS_INLINE MLSIMD32iAVX2 MLSIMDMax(const MLSIMD32iAVX2& a, const MLSIMD32iAVX2& b) { return _mm256_max_epi32(a.m_value, b.m_value); }
+  QM_ALWAYS_INLINE MLSIMD32iAVX2 MLSIMDAbs(const MLSIMD32iAVX2& a) { return _mm256_abs_epi32(a.m_value); }
+#endif
+
+#if defined(ML_MATH_AVX512F)
+  // AVX-512 32/64 bit floating point and 32 bit integer minimum / maximum
+  QM_ALWAYS_INLINE MLSIMD32fAVX512 MLSIMDMin(const MLSIMD32fAVX512& a, const MLSIMD32fAVX512& b) { return _mm512_min_ps(a.m_value, b.m_value); }
+  QM_ALWAYS_INLINE MLSIMD32fAVX512 MLSIMDMax(const MLSIMD32fAVX512& a, const MLSIMD32fAVX512& b) { return _mm512_max_ps(a.m_value, b.m_value); }
+  QM_ALWAYS_INLINE MLSIMD64fAVX512 MLSIMDMin(const MLSIMD64fAVX512& a, const MLSIMD64fAVX512& b) { return _mm512_min_pd(a.m_value, b.m_value); }
+  QM_ALWAYS_INLINE MLSIMD64fAVX512 MLSIMDMax(const MLSIMD64fAVX512& a, const MLSIMD64fAVX512& b) { return _mm512_max_pd(a.m_value, b.m_value); }
+  QM_ALWAYS_INLINE MLSIMD32iAVX512 MLSIMDMin(const MLSIMD32iAVX512& a, const MLSIMD32iAVX512& b) { return _mm512_min_epi32(a.m_value, b.m_value); }
+  QM_ALWAYS_INLINE MLSIMD32iAVX512 MLSIMDMax(const MLSIMD32iAVX512& a, const MLSIMD32iAVX512& b) { return _mm512_max_epi32(a.m_value, b.m_value); }
+  QM_ALWAYS_INLINE MLSIMD32fAVX512 MLSIMDAbs(const MLSIMD32fAVX512& a) { return _mm512_abs_ps(a.m_value); }
+  QM_ALWAYS_INLINE MLSIMD64fAVX512 MLSIMDAbs(const MLSIMD64fAVX512& a) { return _mm512_abs_pd(a.m_value); }
+  QM_ALWAYS_INLINE MLSIMD32iAVX512 MLSIMDAbs(const MLSIMD32iAVX512& a) { return _mm512_abs_epi32(a.m_value); }
+  QM_ALWAYS_INLINE MLSIMD64iAVX512 MLSIMDAbs(const MLSIMD64iAVX512& a) { return _mm512_abs_epi64(a.m_value); }
+#endif
+
+}
+
+#endif
@@ -56,7 +56,7 @@ namespace ML
 #if defined(ML_MATH_SSE3)
     return _mm_addsub_ps(z, y);
 #else
-    __m128 mask = _mm_set_ps(-0.0f, 0.0f, -0.0f, 0.0f);
+    __m128 mask = _mm_set_ps(0.0f, -0.0f, 0.0f, -0.0f);
     y = _mm_xor_ps(y, mask);
     return _mm_add_ps(z, y);
 #endif
@@ -82,7 +82,7 @@ namespace ML
 #if defined(ML_MATH_SSE3)
     return _mm_addsub_pd(z, y);
 #else
-    __m128 mask = _mm_set_pd(-0.0, 0.0);
+    __m128d mask = _mm_set_pd(0.0, -0.0);
     y = _mm_xor_pd(y, mask);
     return _mm_add_pd(z, y);
 #endif
@@ -122,7 +122,7 @@ namespace ML
   QM_ALWAYS_INLINE SIMD
     operator*(const TMLSIMD32uiSSE2<SIMD>& a, const TMLSIMD32uiSSE2<SIMD>& b)
   {
-    return _mm_mullo_epi32(a.m_value, b.m_value);
+    return _mm_mullo_epi32((~a).m_value, (~b).m_value);
   }
 
   // SSE 32 bit complex integer multiplication
@@ -218,7 +218,7 @@ namespace ML
   QM_ALWAYS_INLINE SIMD
     operator*(const TMLSIMD32uiAVX2<SIMD>& a, const TMLSIMD32uiAVX2<SIMD>& b)
   {
-    return _mm256_mullo_epi32(a.m_value, b.m_value);
+    return _mm256_mullo_epi32((~a).m_value, (~b).m_value);
   }
 
   // AVX2 32 bit complex integer multiplication
@@ -241,6 +241,117 @@ namespace ML
   }
 #endif
 
+#if defined(ML_MATH_AVX512F)
+  // AVX-512 32 bit floating point multiplication
+  QM_ALWAYS_INLINE MLSIMD32fAVX512 operator*(const MLSIMD32fAVX512& a, const MLSIMD32fAVX512& b)
+  {
+    return _mm512_mul_ps(a.m_value, b.m_value);
+  }
+
+  // AVX-512 32 bit complex floating point multiplication
+  QM_ALWAYS_INLINE MLSIMD32cfAVX512 operator*(const MLSIMD32cfAVX512& a, const MLSIMD32cfAVX512& b)
+  {
+    __m512 x, y;
+    x = _mm512_shuffle_ps(a.m_value, a.m_value, _MM_SHUFFLE(3,3,1,1));
+    y = _mm512_shuffle_ps(b.m_value, b.m_value, _MM_SHUFFLE(2,3,0,1));
+    y = _mm512_mul_ps(x, y);
+    x = _mm512_shuffle_ps(a.m_value, a.m_value, _MM_SHUFFLE(2,2,0,0));
+    return _mm512_fmaddsub_ps(x, b.m_value, y);
+  }
+
+  // AVX-512 64 bit floating point multiplication
+  QM_ALWAYS_INLINE MLSIMD64fAVX512 operator*(const MLSIMD64fAVX512& a, const MLSIMD64fAVX512& b)
+  {
+    return _mm512_mul_pd(a.m_value, b.m_value);
+  }
+
+  // AVX-512 64 bit complex floating point multiplication
+  QM_ALWAYS_INLINE MLSIMD64cfAVX512 operator*(const MLSIMD64cfAVX512& a, const MLSIMD64cfAVX512& b)
+  {
+    __m512d x, y;
+    x = _mm512_shuffle_pd(a.m_value, a.m_value, 0xFF);
+    y = _mm512_shuffle_pd(b.m_value, b.m_value, 0x55);
+    y = _mm512_mul_pd(x, y);
+    x = _mm512_shuffle_pd(a.m_value, a.m_value, 0x00);
+    return _mm512_fmaddsub_pd(x, b.m_value, y);
+  }
+
+  // AVX-512 32 bit integer multiplication
+  template<typename SIMD>
+  QM_ALWAYS_INLINE SIMD
+    operator*(const TMLSIMD32uiAVX512<SIMD>& a, const TMLSIMD32uiAVX512<SIMD>& b)
+  {
+    return _mm512_mullo_epi32((~a).m_value, (~b).m_value);
+  }
+
+  // AVX-512 32 bit complex integer multiplication
+  template<typename SIMD>
+  QM_ALWAYS_INLINE SIMD
+    operator*(const TMLSIMD32cuiAVX512<SIMD>& a, const TMLSIMD32cuiAVX512<SIMD>& b)
+  {
+    __m512i x, y, z;
+    x = _mm512_shuffle_epi32((~a).m_value, static_cast<_MM_PERM_ENUM>(_MM_SHUFFLE(2,2,0,0)));
+    z = _mm512_mullo_epi32(x, (~b).m_value);
+    x = _mm512_shuffle_epi32((~a).m_value, static_cast<_MM_PERM_ENUM>(_MM_SHUFFLE(3,3,1,1)));
+    y = _mm512_shuffle_epi32((~b).m_value, static_cast<_MM_PERM_ENUM>(_MM_SHUFFLE(2,3,0,1)));
+    y = _mm512_mullo_epi32(x, y);
+
+    // subtract in the real parts (even elements), add in the imaginary parts (odd elements)
+    return _mm512_mask_sub_epi32(_mm512_add_epi32(z, y), 0x5555, z, y);
+  }
+#endif
+
+#if defined(ML_MATH_AVX512DQ)
+  // AVX-512 64 bit integer multiplication
+  template<typename SIMD>
+  QM_ALWAYS_INLINE SIMD
+    operator*(const TMLSIMD64uiAVX512<SIMD>& a, const TMLSIMD64uiAVX512<SIMD>& b)
+  {
+    return _mm512_mullo_epi64((~a).m_value, (~b).m_value);
+  }
+
+  // AVX-512 64 bit complex integer multiplication
+  template<typename SIMD>
+  QM_ALWAYS_INLINE SIMD
+    operator*(const TMLSIMD64cuiAVX512<SIMD>& a, const TMLSIMD64cuiAVX512<SIMD>& b)
+  {
+    __m512i x, y, z;
+    x = _mm512_unpacklo_epi64((~a).m_value, (~a).m_value);
+    z = _mm512_mullo_epi64(x, (~b).m_value);
+    x = _mm512_unpackhi_epi64((~a).m_value, (~a).m_value);
+    y = _mm512_shuffle_epi32((~b).m_value, static_cast<_MM_PERM_ENUM>(_MM_SHUFFLE(1,0,3,2)));
+    y = _mm512_mullo_epi64(x, y);
+    return _mm512_mask_sub_epi64(_mm512_add_epi64(z, y), 0x55, z, y);
+  }
+#endif
+
+#if defined(ML_MATH_AVX512BW)
+  // AVX-512 16 bit integer multiplication
+  template<typename SIMD>
+  QM_ALWAYS_INLINE SIMD
+    operator*(const TMLSIMD16uiAVX512<SIMD>& a, const TMLSIMD16uiAVX512<SIMD>& b)
+  {
+    return _mm512_mullo_epi16((~a).m_value, (~b).m_value);
+  }
+
+  // AVX-512 16 bit complex integer multiplication
+  template<typename SIMD>
+  QM_ALWAYS_INLINE SIMD
+    operator*(const TMLSIMD16cuiAVX512<SIMD>& a, const TMLSIMD16cuiAVX512<SIMD>& b)
+  {
+    __m512i x, y, z;
+    x = _mm512_shufflelo_epi16((~a).m_value, _MM_SHUFFLE(2,2,0,0));
+    x = _mm512_shufflehi_epi16(x, _MM_SHUFFLE(2,2,0,0));
+    z = _mm512_mullo_epi16(x, (~b).m_value);
+    x = _mm512_shufflelo_epi16((~a).m_value, _MM_SHUFFLE(3,3,1,1));
+    x = _mm512_shufflehi_epi16(x, _MM_SHUFFLE(3,3,1,1));
+    y = _mm512_shufflelo_epi16((~b).m_value, _MM_SHUFFLE(2,3,0,1));
+    y = _mm512_shufflehi_epi16(y, _MM_SHUFFLE(2,3,0,1));
+    y = _mm512_mullo_epi16(x, y);
+    return _mm512_mask_sub_epi16(_mm512_add_epi16(z, y), 0x55555555, z, y);
+  }
+#endif
+
 }
 
 #endif
@@ -0,0 +1,210 @@
+// Copyright 2021, Philipp Neufeld
+
+#ifndef ML_MATH_SIMD_Reduce_H_
+#define ML_MATH_SIMD_Reduce_H_
+
+// Includes
+#include <algorithm>
+
+#include "SIMD.h"
+
+namespace ML
+{
+
+  namespace Internal
+  {
+    // horizontal reduction lane by lane (for types without a shuffle sequence)
+    template<typename SIMD, typename Op>
+    QM_ALWAYS_INLINE TMLSIMDElementType_t<SIMD> MLSIMDScalarReduce(const SIMD& a, Op op)
+    {
+      TMLSIMDElementType_t<SIMD> res = a[0];
+      for (std::size_t i = 1; i < TMLSIMDSize_v<SIMD>; i++)
+        res = op(res, a[i]);
+      return res;
+    }
+  }
+
+  // default horizontal sum / product / minimum / maximum (combine the lanes of a register into one element)
+  template<typename SIMD>
+  QM_ALWAYS_INLINE TMLSIMDElementType_t<SIMD>
+    MLSIMDReduceAdd(const TMLSIMD<SIMD>& a)
+  {
+    using ET = TMLSIMDElementType_t<SIMD>;
+    return Internal::MLSIMDScalarReduce(~a, [](const ET& x, const ET& y) { return x + y; });
+  }
+
+  template<typename SIMD>
+  QM_ALWAYS_INLINE TMLSIMDElementType_t<SIMD>
+    MLSIMDReduceMul(const TMLSIMD<SIMD>& a)
+  {
+    using ET = TMLSIMDElementType_t<SIMD>;
+    return Internal::MLSIMDScalarReduce(~a, [](const ET& x, const ET& y) { return x * y; });
+  }
+
+  template<typename SIMD>
+  QM_ALWAYS_INLINE TMLSIMDElementType_t<SIMD>
+    MLSIMDReduceMin(const TMLSIMD<SIMD>& a)
+  {
+    using ET = TMLSIMDElementType_t<SIMD>;
+    return Internal::MLSIMDScalarReduce(~a, [](const ET& x, const ET& y) { return std::min(x, y); });
+  }
+
+  template<typename SIMD>
+  QM_ALWAYS_INLINE TMLSIMDElementType_t<SIMD>
+    MLSIMDReduceMax(const TMLSIMD<SIMD>& a)
+  {
+    using ET = TMLSIMDElementType_t<SIMD>;
+    return Internal::MLSIMDScalarReduce(~a, [](const ET& x, const ET& y) { return std::max(x, y); });
+  }
+
+#if defined(ML_MATH_SSE)
+  // SSE 32 bit floating point horizontal reductions (upper half onto the lower half, then lane 1 onto lane 0)
+  QM_ALWAYS_INLINE float MLSIMDReduceAdd(const MLSIMD32fSSE& a)
+  {
+    const __m128 x = _mm_add_ps(a.m_value, _mm_movehl_ps(a.m_value, a.m_value));
+    return _mm_cvtss_f32(_mm_add_ss(x, _mm_shuffle_ps(x, x, _MM_SHUFFLE(1, 1, 1, 1))));
+  }
+  QM_ALWAYS_INLINE float MLSIMDReduceMin(const MLSIMD32fSSE& a)
+  {
+    const __m128 x = _mm_min_ps(a.m_value, _mm_movehl_ps(a.m_value, a.m_value));
+    return _mm_cvtss_f32(_mm_min_ss(x, _mm_shuffle_ps(x, x, _MM_SHUFFLE(1, 1, 1, 1))));
+  }
+  QM_ALWAYS_INLINE float MLSIMDReduceMax(const MLSIMD32fSSE& a)
+  {
+    const __m128 x = _mm_max_ps(a.m_value, _mm_movehl_ps(a.m_value, a.m_value));
+    return _mm_cvtss_f32(_mm_max_ss(x, _mm_shuffle_ps(x, x, _MM_SHUFFLE(1, 1, 1, 1))));
+  }
+#endif
+
+#if defined(ML_MATH_SSE)
+  // SSE 32 bit complex floating point horizontal sum / product (upper complex number onto the lower one)
+  QM_ALWAYS_INLINE std::complex<float> MLSIMDReduceAdd(const MLSIMD32cfSSE& a)
+  {
+    const __m128 x = _mm_add_ps(a.m_value, _mm_movehl_ps(a.m_value, a.m_value));
+    return std::complex<float>(_mm_cvtss_f32(x), _mm_cvtss_f32(_mm_shuffle_ps(x, x, _MM_SHUFFLE(1, 1, 1, 1))));
+  }
+  QM_ALWAYS_INLINE std::complex<float> MLSIMDReduceMul(const MLSIMD32cfSSE& a)
+  {
+    const __m128 x = (a * MLSIMD32cfSSE(_mm_movehl_ps(a.m_value, a.m_value))).m_value;
+    return std::complex<float>(_mm_cvtss_f32(x), _mm_cvtss_f32(_mm_shuffle_ps(x, x, _MM_SHUFFLE(1, 1, 1, 1))));
+  }
+#endif
+
+#if defined(ML_MATH_SSE2)
+  // SSE2 64 bit complex floating point lane (a register holds a single complex number)
+  QM_ALWAYS_INLINE std::complex<double> MLSIMDReduceAdd(const MLSIMD64cfSSE2& a)
+    { return std::complex<double>(_mm_cvtsd_f64(a.m_value), _mm_cvtsd_f64(_mm_unpackhi_pd(a.m_value, a.m_value))); }
+  QM_ALWAYS_INLINE std::complex<double> MLSIMDReduceMul(const MLSIMD64cfSSE2& a)
+    { return MLSIMDReduceAdd(a); }
+
+  // SSE2 64 bit floating point and 32 bit integer horizontal reductions
+  QM_ALWAYS_INLINE double MLSIMDReduceAdd(const MLSIMD64fSSE2& a)
+    { return _mm_cvtsd_f64(_mm_add_sd(a.m_value, _mm_unpackhi_pd(a.m_value, a.m_value))); }
+  QM_ALWAYS_INLINE double MLSIMDReduceMin(const MLSIMD64fSSE2& a)
+    { return _mm_cvtsd_f64(_mm_min_sd(a.m_value, _mm_unpackhi_pd(a.m_value, a.m_value))); }
+  QM_ALWAYS_INLINE double MLSIMDReduceMax(const MLSIMD64fSSE2& a)
+    { return _mm_cvtsd_f64(_mm_max_sd(a.m_value, _mm_unpackhi_pd(a.m_value, a.m_value))); }
+
+  QM_ALWAYS_INLINE std::int32_t MLSIMDReduceAdd(const MLSIMD32iSSE2& a)
+  {
+    const __m128i x = _mm_add_epi32(a.m_value, _mm_shuffle_epi32(a.m_value, _MM_SHUFFLE(1, 0, 3, 2)));
+    return _mm_cvtsi128_si32(_mm_add_epi32(x, _mm_shuffle_epi32(x, _MM_SHUFFLE(2, 3, 0, 1))));
+  }
+#endif
+
+#if defined(ML_MATH_SSE4_1)
+  // SSE4.1 32 bit integer horizontal minimum / maximum
+  QM_ALWAYS_INLINE std::int32_t MLSIMDReduceMin(const MLSIMD32iSSE2& a)
+  {
+    const __m128i x = _mm_min_epi32(a.m_value, _mm_shuffle_epi32(a.m_value, _MM_SHUFFLE(1, 0, 3, 2)));
+    return _mm_cvtsi128_si32(_mm_min_epi32(x, _mm_shuffle_epi32(x, _MM_SHUFFLE(2, 3, 0, 1))));
+  }
+  QM_ALWAYS_INLINE std::int32_t MLSIMDReduceMax(const MLSIMD32iSSE2& a)
+  {
+    const __m128i x = _mm_max_epi32(a.m_value, _mm_shuffle_epi32(a.m_value, _MM_SHUFFLE(1, 0, 3, 2)));
+    return _mm_cvtsi128_si32(_mm_max_epi32(x, _mm_shuffle_epi32(x, _MM_SHUFFLE(2, 3, 0, 1))));
+  }
+#endif
+
+#if defined(ML_MATH_AVX)
+  // AVX 32/64 bit floating point horizontal reductions (the two 128 bit halves are combined first)
+  QM_ALWAYS_INLINE float MLSIMDReduceAdd(const MLSIMD32fAVX& a)
+    { return MLSIMDReduceAdd(MLSIMD32fSSE(_mm_add_ps(_mm256_castps256_ps128(a.m_value), _mm256_extractf128_ps(a.m_value, 1)))); }
+  QM_ALWAYS_INLINE float MLSIMDReduceMin(const MLSIMD32fAVX& a)
+    { return MLSIMDReduceMin(MLSIMD32fSSE(_mm_min_ps(_mm256_castps256_ps128(a.m_value), _mm256_extractf128_ps(a.m_value, 1)))); }
+  QM_ALWAYS_INLINE float MLSIMDReduceMax(const MLSIMD32fAVX& a)
+    { return MLSIMDReduceMax(MLSIMD32fSSE(_mm_max_ps(_mm256_castps256_ps128(a.m_value), _mm256_extractf128_ps(a.m_value, 1)))); }
+
+  QM_ALWAYS_INLINE double MLSIMDReduceAdd(const MLSIMD64fAVX& a)
+    { return MLSIMDReduceAdd(MLSIMD64fSSE2(_mm_add_pd(_mm256_castpd256_pd128(a.m_value), _mm256_extractf128_pd(a.m_value, 1)))); }
+  QM_ALWAYS_INLINE double MLSIMDReduceMin(const MLSIMD64fAVX& a)
+    { return MLSIMDReduceMin(MLSIMD64fSSE2(_mm_min_pd(_mm256_castpd256_pd128(a.m_value), _mm256_extractf128_pd(a.m_value, 1)))); }
+  QM_ALWAYS_INLINE double MLSIMDReduceMax(const MLSIMD64fAVX& a)
+    { return MLSIMDReduceMax(MLSIMD64fSSE2(_mm_max_pd(_mm256_castpd256_pd128(a.m_value), _mm256_extractf128_pd(a.m_value, 1)))); }
+
+  // AVX 32/64 bit complex floating point horizontal sum / product
+  QM_ALWAYS_INLINE std::complex<float> MLSIMDReduceAdd(const MLSIMD32cfAVX& a)
+    { return MLSIMDReduceAdd(MLSIMD32cfSSE(_mm_add_ps(_mm256_castps256_ps128(a.m_value), _mm256_extractf128_ps(a.m_value, 1)))); }
+  QM_ALWAYS_INLINE std::complex<float> MLSIMDReduceMul(const MLSIMD32cfAVX& a)
+    { return MLSIMDReduceMul(MLSIMD32cfSSE(_mm256_castps256_ps128(a.m_value)) * MLSIMD32cfSSE(_mm256_extractf128_ps(a.m_value, 1))); }
+  QM_ALWAYS_INLINE std::complex<double> MLSIMDReduceAdd(const MLSIMD64cfAVX& a)
+    { return MLSIMDReduceAdd(MLSIMD64cfSSE2(_mm_add_pd(_mm256_castpd256_pd128(a.m_value), _mm256_extractf128_pd(a.m_value, 1)))); }
+  QM_ALWAYS_INLINE std::complex<double> MLSIMDReduceMul(const MLSIMD64cfAVX& a)
+    { return MLSIMDReduceMul(MLSIMD64cfSSE2(_mm256_castpd256_pd128(a.m_value)) * MLSIMD64cfSSE2(_mm256_extractf128_pd(a.m_value, 1))); }
+#endif
+
+#if defined(ML_MATH_AVX2)
+  // AVX2 32 bit integer horizontal reductions
+  QM_ALWAYS_INLINE std::int32_t MLSIMDReduceAdd(const MLSIMD32iAVX2& a)
+    { return MLSIMDReduceAdd(MLSIMD32iSSE2(_mm_add_epi32(_mm256_castsi256_si128(a.m_value), _mm256_extracti128_si256(a.m_value, 1)))); }
+  QM_ALWAYS_INLINE std::int32_t MLSIMDReduceMin(const MLSIMD32iAVX2& a)
+    { return MLSIMDReduceMin(MLSIMD32iSSE2(_mm_min_epi32(_mm256_castsi256_si128(a.m_value), _mm256_extracti128_si256(a.m_value, 1)))); }
+  QM_ALWAYS_INLINE std::int32_t MLSIMDReduceMax(const MLSIMD32iAVX2& a)
+    { return MLSIMDReduceMax(MLSIMD32iSSE2(_mm_max_epi32(_mm256_castsi256_si128(a.m_value), _mm256_extracti128_si256(a.m_value, 1)))); }
+#endif
+
+#if defined(ML_MATH_AVX512F)
+  // AVX-512 32/64 bit floating point and integer horizontal reductions
+  QM_ALWAYS_INLINE float MLSIMDReduceAdd(const MLSIMD32fAVX512& a) { return _mm512_reduce_add_ps(a.m_value); }
+  QM_ALWAYS_INLINE float MLSIMDReduceMin(const MLSIMD32fAVX512& a) { return _mm512_reduce_min_ps(a.m_value); }
+  QM_ALWAYS_INLINE float MLSIMDReduceMax(const MLSIMD32fAVX512& a) { return _mm512_reduce_max_ps(a.m_value); }
+  QM_ALWAYS_INLINE double MLSIMDReduceAdd(const MLSIMD64fAVX512& a) { return _mm512_reduce_add_pd(a.m_value); }
+  QM_ALWAYS_INLINE double MLSIMDReduceMin(const MLSIMD64fAVX512& a) { return _mm512_reduce_min_pd(a.m_value); }
+  QM_ALWAYS_INLINE double MLSIMDReduceMax(const MLSIMD64fAVX512& a) { return _mm512_reduce_max_pd(a.m_value); }
+  QM_ALWAYS_INLINE std::int32_t MLSIMDReduceAdd(const MLSIMD32iAVX512& a) { return _mm512_reduce_add_epi32(a.m_value); }
+  QM_ALWAYS_INLINE std::int32_t MLSIMDReduceMin(const MLSIMD32iAVX512& a) { return _mm512_reduce_min_epi32(a.m_value); }
+  QM_ALWAYS_INLINE std::int32_t MLSIMDReduceMax(const MLSIMD32iAVX512& a) { return _mm512_reduce_max_epi32(a.m_value); }
+  QM_ALWAYS_INLINE std::int64_t MLSIMDReduceAdd(const MLSIMD64iAVX512& a) { return _mm512_reduce_add_epi64(a.m_value); }
+  QM_ALWAYS_INLINE std::int64_t MLSIMDReduceMin(const MLSIMD64iAVX512& a) { return _mm512_reduce_min_epi64(a.m_value); }
+  QM_ALWAYS_INLINE std::int64_t MLSIMDReduceMax(const MLSIMD64iAVX512& a) { return _mm512_reduce_max_epi64(a.m_value); }
+
+  // AVX-512 32/64 bit complex floating point horizontal sum / product (the 128 bit blocks are combined pairwise)
+  QM_ALWAYS_INLINE std::complex<float> MLSIMDReduceAdd(const MLSIMD32cfAVX512& a)
+  {
+    __m512 x = _mm512_add_ps(a.m_value, _mm512_shuffle_f32x4(a.m_value, a.m_value, _MM_SHUFFLE(1, 0, 3, 2)));
+    x = _mm512_add_ps(x, _mm512_shuffle_f32x4(x, x, _MM_SHUFFLE(2, 3, 0, 1)));
+    return MLSIMDReduceAdd(MLSIMD32cfSSE(_mm512_castps512_ps128(x)));
+  }
+  QM_ALWAYS_INLINE std::complex<float> MLSIMDReduceMul(const MLSIMD32cfAVX512& a)
+  {
+    MLSIMD32cfAVX512 x = a * MLSIMD32cfAVX512(_mm512_shuffle_f32x4(a.m_value, a.m_value, _MM_SHUFFLE(1, 0, 3, 2)));
+    x = x * MLSIMD32cfAVX512(_mm512_shuffle_f32x4(x.m_value, x.m_value, _MM_SHUFFLE(2, 3, 0, 1)));
+    return MLSIMDReduceMul(MLSIMD32cfSSE(_mm512_castps512_ps128(x.m_value)));
+  }
+  QM_ALWAYS_INLINE std::complex<double> MLSIMDReduceAdd(const MLSIMD64cfAVX512& a)
+  {
+    __m512d x = _mm512_add_pd(a.m_value, _mm512_shuffle_f64x2(a.m_value, a.m_value, _MM_SHUFFLE(1, 0, 3, 2)));
+    x = _mm512_add_pd(x, _mm512_shuffle_f64x2(x, x, _MM_SHUFFLE(2, 3, 0, 1)));
+    return MLSIMDReduceAdd(MLSIMD64cfSSE2(_mm512_castpd512_pd128(x)));
+  }
+  QM_ALWAYS_INLINE std::complex<double> MLSIMDReduceMul(const MLSIMD64cfAVX512& a)
+  {
+    MLSIMD64cfAVX512 x = a * MLSIMD64cfAVX512(_mm512_shuffle_f64x2(a.m_value, a.m_value, _MM_SHUFFLE(1, 0, 3, 2)));
+    x = x * MLSIMD64cfAVX512(_mm512_shuffle_f64x2(x.m_value, x.m_value, _MM_SHUFFLE(2, 3, 0, 1)));
+    return MLSIMDReduceMul(MLSIMD64cfSSE2(_mm512_castpd512_pd128(x.m_value)));
+  }
+#endif
+
+}
+
+#endif
@@ -5,8 +5,10 @@
 
 // Includes
 #include <cstdint>
+#include <cstring>
 #include <type_traits>
 #include <complex>
+#include <algorithm>
 
 #include "../MathPrerequisites.h"
 #include "../../QTL/Type.h"
@@ -30,6 +32,55 @@ namespace ML
 
   namespace Internal
   {
+    // Masked load/store for instruction sets without masked memory operations: the first
+    // n elements are copied through a buffer on the stack (the other lanes are zero).
+    template <typename Helper>
+    struct TMLSIMDMaskedEmulation
+    {
+      using type = typename Helper::type;
+
+      template <typename T> QM_ALWAYS_INLINE static type
+        LoadMasked(const T *ptr, std::size_t n) noexcept 
+      { 
+        alignas(type) T buffer[sizeof(type) / sizeof(T)] = {};
+        std::copy(ptr, ptr + n, buffer);
+        return Helper::LoadAligned(static_cast<const T*>(buffer));
+      }
+      template <typename T> QM_ALWAYS_INLINE static void
+        StoreMasked(type v, T *ptr, std::size_t n) noexcept 
+      {
+        alignas(type) T buffer[sizeof(type) / sizeof(T)];
+        Helper::StoreAligned(v, static_cast<T*>(buffer));
+        std::copy(buffer, buffer + n, ptr);
+      }
+    };
+
+#if defined(ML_MATH_AVX)
+    // Mask of the AVX maskload/maskstore instructions that selects the first n bytes (n must be a multiple
+    // of 4). The mask is loaded from a sliding window over a table of 32 bit lanes.
+    QM_ALWAYS_INLINE __m256i MLSIMDMaskAVX(std::size_t n) noexcept
+    {
+      alignas(64) static const std::int32_t table[16] = { -1, -1, -1, -1, -1, -1, -1, -1, 0, 0, 0, 0, 0, 0, 0, 0 };
+      return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(table + 8 - n / 4));
+    }
+    QM_ALWAYS_INLINE __m128i MLSIMDMaskSSE(std::size_t n) noexcept { return _mm256_castsi256_si128(MLSIMDMaskAVX(n)); }
+#endif
+
+    // Reads a complex number as one integer of twice the width of its components (real part in the lower half)
+    template <typename Int, typename T>
+    QM_ALWAYS_INLINE Int MLSIMDPackComplex(const std::complex<T>& val) noexcept
+    {
+      static_assert(sizeof(Int) == sizeof(std::complex<T>), "Integer type has to be as wide as the complex number");
+      Int packed;
+      std::memcpy(&packed, &val, sizeof(Int));
+      return packed;
+    }
+
+#if defined(ML_MATH_AVX512F)
+    // AVX-512 opmask that selects the first n of the lanes
+    QM_ALWAYS_INLINE __mmask64 MLSIMDMaskAVX512(std::size_t n) noexcept { return n >= 64 ? ~__mmask64(0) : (__mmask64(1) << n) - 1; }
+#endif
+
     // Helper for all non-vectorized intrinsic types
     template <typename ET> 
     struct TMLSIMDIntrinsicsDefaultHelper
@@ -57,6 +108,12 @@ namespace ML
       template <typename T, typename = EnableIfLoadStore<T>> QM_ALWAYS_INLINE static void
         Stream(type v, T *ptr) noexcept { *static_cast<type*>(ptr) = v; }
 
+      // Masked load/store of the first n elements (n <= 1)
+      template <typename T, typename = EnableIfLoadStore<T>> QM_ALWAYS_INLINE static type
+        LoadMasked(const T *ptr, std::size_t n) noexcept { return n ? *static_cast<const type*>(ptr) : type(0); }
+      template <typename T, typename = EnableIfLoadStore<T>> QM_ALWAYS_INLINE static void
+        StoreMasked(type v, T *ptr, std::size_t n) noexcept { if (n) *static_cast<type*>(ptr) = v; }
+
       // Set1
       QM_ALWAYS_INLINE static type Set1(ET val) noexcept { return val; }
     };
@@ -89,6 +146,19 @@ namespace ML
       template <typename T, typename = EnableIfLoadStore<T>> QM_ALWAYS_INLINE static void
         Stream(type v, T *ptr) noexcept { _mm_stream_ps(reinterpret_cast<float*>(ptr), v); }
 
+      // Masked load/store (first n elements)
+#if defined(ML_MATH_AVX)
+      template <typename T, typename = EnableIfLoadStore<T>> QM_ALWAYS_INLINE static type
+        LoadMasked(const T *ptr, std::size_t n) noexcept { return _mm_maskload_ps(reinterpret_cast<const float*>(ptr), MLSIMDMaskSSE(n * sizeof(T))); }
+      template <typename T, typename = EnableIfLoadStore<T>> QM_ALWAYS_INLINE static void
+        StoreMasked(type v, T *ptr, std::size_t n) noexcept { _mm_maskstore_ps(reinterpret_cast<float*>(ptr), MLSIMDMaskSSE(n * sizeof(T)), v); }
+#else
+      template <typename T, typename = EnableIfLoadStore<T>> QM_ALWAYS_INLINE static type
+        LoadMasked(const T *ptr, std::size_t n) noexcept { return TMLSIMDMaskedEmulation<TMLSIMDIntrinsicFloatSSEHelper>::LoadMasked(ptr, n); }
+      template <typename T, typename = EnableIfLoadStore<T>> QM_ALWAYS_INLINE static void
+        StoreMasked(type v, T *ptr, std::size_t n) noexcept { TMLSIMDMaskedEmulation<TMLSIMDIntrinsicFloatSSEHelper>::StoreMasked(v, ptr, n); }
+#endif
+
       // Set1
       QM_ALWAYS_INLINE static type Set1(float val) noexcept { return _mm_set1_ps(val); }
       QM_ALWAYS_INLINE static type Set1(std::complex<float> val) noexcept
@@ -128,6 +198,19 @@ namespace ML
       template <typename T, typename = EnableIfLoadStore<T>> QM_ALWAYS_INLINE static void
         Stream(type v, T *ptr) noexcept { _mm_stream_pd(reinterpret_cast<double*>(ptr), v); }
 
+      // Masked load/store (first n elements)
+#if defined(ML_MATH_AVX)
+      template <typename T, typename = EnableIfLoadStore<T>> QM_ALWAYS_INLINE static type
+        LoadMasked(const T *ptr, std::size_t n) noexcept { return _mm_maskload_pd(reinterpret_cast<const double*>(ptr), MLSIMDMaskSSE(n * sizeof(T))); }
+      template <typename T, typename = EnableIfLoadStore<T>> QM_ALWAYS_INLINE static void
+        StoreMasked(type v, T *ptr, std::size_t n) noexcept { _mm_maskstore_pd(reinterpret_cast<double*>(ptr), MLSIMDMaskSSE(n * sizeof(T)), v); }
+#else
+      template <typename T, typename = EnableIfLoadStore<T>> QM_ALWAYS_INLINE static type
+        LoadMasked(const T *ptr, std::size_t n) noexcept { return TMLSIMDMaskedEmulation<TMLSIMDIntrinsicDoubleSSE2Helper>::LoadMasked(ptr, n); }
+      template <typename T, typename = EnableIfLoadStore<T>> QM_ALWAYS_INLINE static void
+        StoreMasked(type v, T *ptr, std::size_t n) noexcept { TMLSIMDMaskedEmulation<TMLSIMDIntrinsicDoubleSSE2Helper>::StoreMasked(v, ptr, n); }
+#endif
+
       // Set1
       QM_ALWAYS_INLINE static type Set1(double val) noexcept { return _mm_set1_pd(val); }
       QM_ALWAYS_INLINE static type Set1(std::complex<double> val) noexcept { return _mm_set_pd(val.imag(), val.real()); }
@@ -161,6 +244,30 @@ namespace ML
       template <typename T, typename = EnableIfLoadStore<T>> QM_ALWAYS_INLINE static void
         Stream(type v, T *ptr) noexcept { _mm_stream_si128(reinterpret_cast<__m128i*>(ptr), v); }
 
+      // Masked load/store (first n elements, AVX2 masks 32 bit lanes and partial lanes are emulated)
+#if defined(ML_MATH_AVX2)
+      template <typename T, typename = EnableIfLoadStore<T>> QM_ALWAYS_INLINE static type
+        LoadMasked(const T *ptr, std::size_t n) noexcept 
+      { 
+        if ((n * sizeof(T)) % 4 != 0)
+          return TMLSIMDMaskedEmulation<TMLSIMDIntrinsicIntegerSSE2Helper>::LoadMasked(ptr, n);
+        return _mm_maskload_epi32(reinterpret_cast<const int*>(ptr), MLSIMDMaskSSE(n * sizeof(T))); 
+      }
+      template <typename T, typename = EnableIfLoadStore<T>> QM_ALWAYS_INLINE static void
+        StoreMasked(type v, T *ptr, std::size_t n) noexcept 
+      { 
+        if ((n * sizeof(T)) % 4 != 0)
+          TMLSIMDMaskedEmulation<TMLSIMDIntrinsicIntegerSSE2Helper>::StoreMasked(v, ptr, n);
+        else
+          _mm_maskstore_epi32(reinterpret_cast<int*>(ptr), MLSIMDMaskSSE(n * sizeof(T)), v);
+      }
+#else
+      template <typename T, typename = EnableIfLoadStore<T>> QM_ALWAYS_INLINE static type
+        LoadMasked(const T *ptr, std::size_t n) noexcept { return TMLSIMDMaskedEmulation<TMLSIMDIntrinsicIntegerSSE2Helper>::LoadMasked(ptr, n); }
+      template <typename T, typename = EnableIfLoadStore<T>> QM_ALWAYS_INLINE static void
+        StoreMasked(type v, T *ptr, std::size_t n) noexcept { TMLSIMDMaskedEmulation<TMLSIMDIntrinsicIntegerSSE2Helper>::StoreMasked(v, ptr, n); }
+#endif
+
       // Set1
       QM_ALWAYS_INLINE static type Set1(std::int8_t val) noexcept { return _mm_set1_epi8(val); }
       QM_ALWAYS_INLINE static type Set1(std::uint8_t val) noexcept { return _mm_set1_epi8(*(reinterpret_cast<std::int8_t*>(&val))); }
@@ -221,6 +328,12 @@ namespace ML
       // Stream
       template <typename T, typename = EnableIfLoadStore<T>> QM_ALWAYS_INLINE static void
         Stream(type v, T *ptr) noexcept { _mm256_stream_ps(reinterpret_cast<float*>(ptr), v); }
+
+      // Masked load/store (first n elements)
+      template <typename T, typename = EnableIfLoadStore<T>> QM_ALWAYS_INLINE static type
+        LoadMasked(const T *ptr, std::size_t n) noexcept { return _mm256_maskload_ps(reinterpret_cast<const float*>(ptr), MLSIMDMaskAVX(n * sizeof(T))); }
+      template <typename T, typename = EnableIfLoadStore<T>> QM_ALWAYS_INLINE static void
+        StoreMasked(type v, T *ptr, std::size_t n) noexcept { _mm256_maskstore_ps(reinterpret_cast<float*>(ptr), MLSIMDMaskAVX(n * sizeof(T)), v); }
       
       // Set1
       QM_ALWAYS_INLINE static type Set1(float val) noexcept { return _mm256_set1_ps(val); }
@@ -258,6 +371,12 @@ namespace ML
       // Stream
       template <typename T, typename = EnableIfLoadStore<T>> QM_ALWAYS_INLINE static void
         Stream(type v, T *ptr) noexcept { _mm256_stream_pd(reinterpret_cast<double*>(ptr), v); }
+
+      // Masked load/store (first n elements)
+      template <typename T, typename = EnableIfLoadStore<T>> QM_ALWAYS_INLINE static type
+        LoadMasked(const T *ptr, std::size_t n) noexcept { return _mm256_maskload_pd(reinterpret_cast<const double*>(ptr), MLSIMDMaskAVX(n * sizeof(T))); }
+      template <typename T, typename = EnableIfLoadStore<T>> QM_ALWAYS_INLINE static void
+        StoreMasked(type v, T *ptr, std::size_t n) noexcept { _mm256_maskstore_pd(reinterpret_cast<double*>(ptr), MLSIMDMaskAVX(n * sizeof(T)), v); }
       
       // Set1
       QM_ALWAYS_INLINE static type Set1(double val) noexcept { return _mm256_set1_pd(val); }
@@ -302,6 +421,23 @@ namespace ML
       template <typename T, typename = EnableIfLoadStore<T>> QM_ALWAYS_INLINE static void
         Stream(type v, T *ptr) noexcept { _mm256_stream_si256(reinterpret_cast<__m256i*>(ptr), v); }
 
+      // Masked load/store (first n elements, AVX2 masks 32 bit lanes and partial lanes are emulated)
+      template <typename T, typename = EnableIfLoadStore<T>> QM_ALWAYS_INLINE static type
+        LoadMasked(const T *ptr, std::size_t n) noexcept 
+      { 
+        if ((n * sizeof(T)) % 4 != 0)
+          return TMLSIMDMaskedEmulation<TMLSIMDIntrinsicIntegerAVX2Helper>::LoadMasked(ptr, n);
+        return _mm256_maskload_epi32(reinterpret_cast<const int*>(ptr), MLSIMDMaskAVX(n * sizeof(T))); 
+      }
+      template <typename T, typename = EnableIfLoadStore<T>> QM_ALWAYS_INLINE static void
+        StoreMasked(type v, T *ptr, std::size_t n) noexcept 
+      { 
+        if ((n * sizeof(T)) % 4 != 0)
+          TMLSIMDMaskedEmulation<TMLSIMDIntrinsicIntegerAVX2Helper>::StoreMasked(v, ptr, n);
+        else
+          _mm256_maskstore_epi32(reinterpret_cast<int*>(ptr), MLSIMDMaskAVX(n * sizeof(T)), v);
+      }
+
       // Set1
       QM_ALWAYS_INLINE static type Set1(std::int8_t val) noexcept { return _mm256_set1_epi8(val); }
       QM_ALWAYS_INLINE static type Set1(std::uint8_t val) noexcept { return _mm256_set1_epi8(*(reinterpret_cast<std::int8_t*>(&val))); }
@@ -335,6 +471,216 @@ namespace ML
     };
 #endif
 
+#if defined(ML_MATH_AVX512F)
+    // Helper for types using the AVX-512 __m512 data type
+    struct TMLSIMDIntrinsicFloatAVX512Helper
+    {
+      using type = __m512;
+      template <typename T>
+      using EnableIfLoadStore = TMLEnableIf_t<
+        std::is_same<T, float>::value || std::is_same<T, std::complex<float>>::value>;
+
+      //Default value
+      QM_ALWAYS_INLINE static type CreateZero() noexcept { return _mm512_setzero_ps(); }
+
+      // Load
+      template <typename T, typename = EnableIfLoadStore<T>> QM_ALWAYS_INLINE static type
+        LoadAligned(const T *ptr) noexcept { return _mm512_load_ps(reinterpret_cast<const float*>(ptr)); }
+      template <typename T, typename = EnableIfLoadStore<T>> QM_ALWAYS_INLINE static type
+        LoadUnaligned(const T *ptr) noexcept { return _mm512_loadu_ps(reinterpret_cast<const float*>(ptr)); }
+
+      // Store
+      template <typename T, typename = EnableIfLoadStore<T>> QM_ALWAYS_INLINE static void
+        StoreAligned(type v, T *ptr) noexcept { _mm512_store_ps(reinterpret_cast<float*>(ptr), v); }
+      template <typename T, typename = EnableIfLoadStore<T>> QM_ALWAYS_INLINE static void
+        StoreUnaligned(type v, T *ptr) noexcept { _mm512_storeu_ps(reinterpret_cast<float*>(ptr), v); }
+
+      // Stream
+      template <typename T, typename = EnableIfLoadStore<T>> QM_ALWAYS_INLINE static void
+        Stream(type v, T *ptr) noexcept { _mm512_stream_ps(reinterpret_cast<float*>(ptr), v); }
+
+      // Masked load/store (first n elements)
+      template <typename T, typename = EnableIfLoadStore<T>> QM_ALWAYS_INLINE static type
+        LoadMasked(const T *ptr, std::size_t n) noexcept 
+      { 
+        return _mm512_maskz_loadu_ps(static_cast<__mmask16>(MLSIMDMaskAVX512(n * sizeof(T) / sizeof(float))), ptr); 
+      }
+      template <typename T, typename = EnableIfLoadStore<T>> QM_ALWAYS_INLINE static void
+        StoreMasked(type v, T *ptr, std::size_t n) noexcept 
+      { 
+        _mm512_mask_storeu_ps(ptr, static_cast<__mmask16>(MLSIMDMaskAVX512(n * sizeof(T) / sizeof(float))), v); 
+      }
+      
+      // Set1
+      QM_ALWAYS_INLINE static type Set1(float val) noexcept { return _mm512_set1_ps(val); }
+      QM_ALWAYS_INLINE static type Set1(std::complex<float> val) noexcept
+      {
+        const float re = val.real();
+        const float im = val.imag();
+        return _mm512_set_ps(im, re, im, re, im, re, im, re, im, re, im, re, im, re, im, re);
+      }
+    };
+
+    // Helper for types using the AVX-512 __m512d data type
+    struct TMLSIMDIntrinsicDoubleAVX512Helper
+    {
+      using type = __m512d;
+      template <typename T>
+      using EnableIfLoadStore = TMLEnableIf_t<
+        std::is_same<T, double>::value || std::is_same<T, std::complex<double>>::value>;
+
+      //Default value
+      QM_ALWAYS_INLINE static type CreateZero() noexcept { return _mm512_setzero_pd(); }
+
+      // Load
+      template <typename T, typename = EnableIfLoadStore<T>> QM_ALWAYS_INLINE static type
+        LoadAligned(const T *ptr) noexcept { return _mm512_load_pd(reinterpret_cast<const double*>(ptr)); }
+      template <typename T, typename = EnableIfLoadStore<T>> QM_ALWAYS_INLINE static type
+        LoadUnaligned(const T *ptr) noexcept { return _mm512_loadu_pd(reinterpret_cast<const double*>(ptr)); }
+
+      // Store
+      template <typename T, typename = EnableIfLoadStore<T>> QM_ALWAYS_INLINE static void
+        StoreAligned(type v, T *ptr) noexcept { _mm512_store_pd(reinterpret_cast<double*>(ptr), v); }
+      template <typename T, typename = EnableIfLoadStore<T>> QM_ALWAYS_INLINE static void
+        StoreUnaligned(type v, T *ptr) noexcept { _mm512_storeu_pd(reinterpret_cast<double*>(ptr), v); }
+
+      // Stream
+      template <typename T, typename = EnableIfLoadStore<T>> QM_ALWAYS_INLINE static void
+        Stream(type v, T *ptr) noexcept { _mm512_stream_pd(reinterpret_cast<double*>(ptr), v); }
+
+      // Masked load/store (first n elements)
+      template <typename T, typename = EnableIfLoadStore<T>> QM_ALWAYS_INLINE static type
+        LoadMasked(const T *ptr, std::size_t n) noexcept 
+      { 
+        return _mm512_maskz_loadu_pd(static_cast<__mmask8>(MLSIMDMaskAVX512(n * sizeof(T) / sizeof(double))), ptr); 
+      }
+      template <typename T, typename = EnableIfLoadStore<T>> QM_ALWAYS_INLINE static void
+        StoreMasked(type v, T *ptr, std::size_t n) noexcept 
+      { 
+        _mm512_mask_storeu_pd(ptr, static_cast<__mmask8>(MLSIMDMaskAVX512(n * sizeof(T) / sizeof(double))), v); 
+      }
+      
+      // Set1
+      QM_ALWAYS_INLINE static type Set1(double val) noexcept { return _mm512_set1_pd(val); }
+      QM_ALWAYS_INLINE static type Set1(std::complex<double> val) noexcept
+      {
+        const double re = val.real();
+        const double im = val.imag();
+        return _mm512_set_pd(im, re, im, re, im, re, im, re);
+      }
+    };
+
+    // Helper for types using the AVX-512 __m512i data type
+    struct TMLSIMDIntrinsicIntegerAVX512Helper
+    {
+      using type = __m512i;
+      template <typename T>
+      struct EnableIfLoadStore : TMLEnableIf_t<std::is_integral<T>::value> {};
+      template <typename T>
+      struct EnableIfLoadStore<std::complex<T>> : EnableIfLoadStore<T> {};
+
+      //Default value
+      QM_ALWAYS_INLINE static type CreateZero() noexcept { return _mm512_setzero_si512(); }
+
+      // Load
+      template <typename T, typename = EnableIfLoadStore<T>> QM_ALWAYS_INLINE static type
+        LoadAligned(const T *ptr) noexcept { return _mm512_load_si512(reinterpret_cast<const void*>(ptr)); }
+      template <typename T, typename = EnableIfLoadStore<T>> QM_ALWAYS_INLINE static type
+        LoadUnaligned(const T *ptr) noexcept { return _mm512_loadu_si512(reinterpret_cast<const void*>(ptr)); }
+
+      // Store
+      template <typename T, typename = EnableIfLoadStore<T>> QM_ALWAYS_INLINE static void
+        StoreAligned(type v, T *ptr) noexcept { _mm512_store_si512(reinterpret_cast<void*>(ptr), v); }
+      template <typename T, typename = EnableIfLoadStore<T>> QM_ALWAYS_INLINE static void
+        StoreUnaligned(type v, T *ptr) noexcept { _mm512_storeu_si512(reinterpret_cast<void*>(ptr), v); }
+
+      // Stream
+      template <typename T, typename = EnableIfLoadStore<T>> QM_ALWAYS_INLINE static void
+        Stream(type v, T *ptr) noexcept { _mm512_stream_si512(reinterpret_cast<type*>(ptr), v); }
+
+      // Masked load/store (first n elements, byte lanes with BW, otherwise 32 bit lanes and partial lanes are emulated)
+#if defined(ML_MATH_AVX512BW)
+      template <typename T, typename = EnableIfLoadStore<T>> QM_ALWAYS_INLINE static type
+        LoadMasked(const T *ptr, std::size_t n) noexcept { return _mm512_maskz_loadu_epi8(MLSIMDMaskAVX512(n * sizeof(T)), ptr); }
+      template <typename T, typename = EnableIfLoadStore<T>> QM_ALWAYS_INLINE static void
+        StoreMasked(type v, T *ptr, std::size_t n) noexcept { _mm512_mask_storeu_epi8(ptr, MLSIMDMaskAVX512(n * sizeof(T)), v); }
+#else
+      template <typename T, typename = EnableIfLoadStore<T>> QM_ALWAYS_INLINE static type
+        LoadMasked(const T *ptr, std::size_t n) noexcept 
+      { 
+        if ((n * sizeof(T)) % 4 != 0)
+          return TMLSIMDMaskedEmulation<TMLSIMDIntrinsicIntegerAVX512Helper>::LoadMasked(ptr, n);
+        return _mm512_maskz_loadu_epi32(static_cast<__mmask16>(MLSIMDMaskAVX512(n * sizeof(T) / 4)), ptr); 
+      }
+      template <typename T, typename = EnableIfLoadStore<T>> QM_ALWAYS_INLINE static void
+        StoreMasked(type v, T *ptr, std::size_t n) noexcept 
+      { 
+        if ((n * sizeof(T)) % 4 != 0)
+          TMLSIMDMaskedEmulation<TMLSIMDIntrinsicIntegerAVX512Helper>::StoreMasked(v, ptr, n);
+        else
+          _mm512_mask_storeu_epi32(ptr, static_cast<__mmask16>(MLSIMDMaskAVX512(n * sizeof(T) / 4)), v);
+      }
+#endif
+
+      // Set1
+      QM_ALWAYS_INLINE static type Set1(std::int8_t val) noexcept { return _mm512_set1_epi8(val); }
+      QM_ALWAYS_INLINE static type Set1(std::uint8_t val) noexcept { return _mm512_set1_epi8(*(reinterpret_cast<std::int8_t*>(&val))); }
+      QM_ALWAYS_INLINE static type Set1(std::int16_t val) noexcept { return _mm512_set1_epi16(val); }
+      QM_ALWAYS_INLINE static type Set1(std::uint16_t val) noexcept { return _mm512_set1_epi16(*(reinterpret_cast<std::int16_t*>(&val))); }
+      QM_ALWAYS_INLINE static type Set1(std::int32_t val) noexcept { return _mm512_set1_epi32(val); }
+      QM_ALWAYS_INLINE static type Set1(std::uint32_t val) noexcept { return _mm512_set1_epi32(*(reinterpret_cast<std::int32_t*>(&val))); }
+      QM_ALWAYS_INLINE static type Set1(std::int64_t val) noexcept { return _mm512_set1_epi64(val); }
+      QM_ALWAYS_INLINE static type Set1(std::uint64_t val) noexcept { return _mm512_set1_epi64(*(reinterpret_cast<std::int64_t*>(&val))); }
+
+      // a complex number is broadcast as one integer of twice the width (real part in the lower half)
+      QM_ALWAYS_INLINE static type Set1(std::complex<std::int8_t> val) noexcept { return _mm512_set1_epi16(MLSIMDPackComplex<std::int16_t>(val)); }
+      QM_ALWAYS_INLINE static type Set1(std::complex<std::uint8_t> val) noexcept { return _mm512_set1_epi16(MLSIMDPackComplex<std::int16_t>(val)); }
+      QM_ALWAYS_INLINE static type Set1(std::complex<std::int16_t> val) noexcept { return _mm512_set1_epi32(MLSIMDPackComplex<std::int32_t>(val)); }
+      QM_ALWAYS_INLINE static type Set1(std::complex<std::uint16_t> val) noexcept { return _mm512_set1_epi32(MLSIMDPackComplex<std::int32_t>(val)); }
+      QM_ALWAYS_INLINE static type Set1(std::complex<std::int32_t> val) noexcept { return _mm512_set1_epi64(MLSIMDPackComplex<std::int64_t>(val)); }
+      QM_ALWAYS_INLINE static type Set1(std::complex<std::uint32_t> val) noexcept { return _mm512_set1_epi64(MLSIMDPackComplex<std::int64_t>(val)); }
+      QM_ALWAYS_INLINE static type Set1(std::complex<std::int64_t> val) noexcept
+      {
+        const std::int64_t re = val.real();
+        const std::int64_t im = val.imag();
+        return _mm512_set_epi64(im, re, im, re, im, re, im, re);
+      }
+      QM_ALWAYS_INLINE static type Set1(std::complex<std::uint64_t> val) noexcept
+      {
+        const std::uint64_t ure = val.real();
+        const std::uint64_t uim = val.imag();
+        const std::int64_t re = *(reinterpret_cast<const std::int64_t*>(&ure));
+        const std::int64_t im = *(reinterpret_cast<const std::int64_t*>(&uim));
+        return _mm512_set_epi64(im, re, im, re, im, re, im, re);
+      }
+    };
+#endif
+
+    // Access to the lanes of an intrinsic type through a may_alias type (e.g. __m128i is a vector of 64 bit integers).
+    // Class types such as std::complex cannot carry the attribute: complex lanes are assembled from their real and 
+    // imaginary parts and can only be read.
+    template<typename ET, typename=void>
+    struct TMLSIMDLane;
+    template<typename ET>
+    struct TMLSIMDLane<ET, TMLEnableIf_t<std::is_arithmetic<ET>::value>>
+    {
+      typedef ET QM_MAY_ALIAS type;
+      template<typename IT> QM_ALWAYS_INLINE static ET Get(const IT &v, std::size_t i) noexcept 
+        { return (reinterpret_cast<const type*>(&v))[i]; }
+      template<typename IT> QM_ALWAYS_INLINE static ET &Ref(IT &v, std::size_t i) noexcept 
+        { return (reinterpret_cast<type*>(&v))[i]; }
+    };
+    template<typename T>
+    struct TMLSIMDLane<std::complex<T>, TMLEnableIf_t<std::is_arithmetic<T>::value>>
+    {
+      typedef T QM_MAY_ALIAS type;
+      template<typename IT> QM_ALWAYS_INLINE static std::complex<T> Get(const IT &v, std::size_t i) noexcept 
+      { 
+        const type *parts = reinterpret_cast<const type*>(&v);
+        return std::complex<T>(parts[2 * i], parts[2 * i + 1]);
+      }
+    };
+
     // Implementation of the actual intrinsic type used in the math library
     template <template <typename> class CRTP, typename ET, typename IntrinsicsHelper, typename=void> 
     struct TMLSIMD_impl;
@@ -349,8 +695,12 @@ namespace ML
       QM_ALWAYS_INLINE TMLSIMD_impl() noexcept : m_value(IntrinsicsHelper::CreateZero()) {}
       QM_ALWAYS_INLINE TMLSIMD_impl(IntrinsicType val) noexcept : m_value(val) {}
       QM_ALWAYS_INLINE TMLSIMD_impl(const TMLSIMD_impl &rhs) noexcept : m_value(rhs.m_value) {}
-      QM_ALWAYS_INLINE ElementType operator[](std::size_t i) const noexcept { return (reinterpret_cast<const ElementType*>(&m_value))[i]; }
-      QM_ALWAYS_INLINE ElementType &operator[](std::size_t i) noexcept { return (reinterpret_cast<ElementType*>(&m_value))[i]; }
+      // Lane access (see TMLSIMDLane). Complex lanes are returned as const values, so that writes do not compile.
+      QM_ALWAYS_INLINE ElementType operator[](std::size_t i) const noexcept { return TMLSIMDLane<ElementType>::Get(m_value, i); }
+      template<typename E = ElementType, typename = TMLEnableIf_t<std::is_arithmetic<E>::value>>
+      QM_ALWAYS_INLINE ElementType &operator[](std::size_t i) noexcept { return TMLSIMDLane<E>::Ref(m_value, i); }
+      template<typename E = ElementType, typename = TMLEnableIf_t<!std::is_arithmetic<E>::value>, typename = void>
+      QM_ALWAYS_INLINE const ElementType operator[](std::size_t i) noexcept { return TMLSIMDLane<E>::Get(m_value, i); }
 
       template <typename T> QM_ALWAYS_INLINE static TMLSIMD_impl 
         LoadAligned(const T *ptr) noexcept { return IntrinsicsHelper::LoadAligned(ptr); }
@@ -364,6 +714,13 @@ namespace ML
       template <typename T> QM_ALWAYS_INLINE static void 
         Stream(TMLSIMD_impl v, T *ptr) noexcept { IntrinsicsHelper::Stream(v.m_value, ptr); }
 
+      // Masked load/store of the first n elements (n <= Size_v). The other lanes are loaded 
+      // as zero and the elements behind ptr + n are not accessed (e.g. tails of unpadded rows).
+      template <typename T> QM_ALWAYS_INLINE static TMLSIMD_impl 
+        LoadMasked(const T *ptr, std::size_t n) noexcept { return IntrinsicsHelper::LoadMasked(ptr, n); }
+      template <typename T> QM_ALWAYS_INLINE static void 
+        StoreMasked(TMLSIMD_impl v, T *ptr, std::size_t n) noexcept { IntrinsicsHelper::StoreMasked(v.m_value, ptr, n); }
+
       QM_ALWAYS_INLINE static TMLSIMD_impl 
         SetZero() noexcept { return IntrinsicsHelper::CreateZero(); }
       template <typename T> QM_ALWAYS_INLINE static TMLSIMD_impl 
@@ -684,6 +1041,130 @@ namespace ML
 
 #endif
 
+#if defined(ML_MATH_AVX512F)
+  // AVX-512 CRTP types
+  template <typename SIMD> struct TMLSIMDAVX512 : TMLSIMD<SIMD> {};
+  template <typename SIMD> struct TMLSIMD32floatAVX512 : TMLSIMDAVX512<SIMD> {};
+  template <typename SIMD> struct TMLSIMD64floatAVX512 : TMLSIMDAVX512<SIMD> {};
+  template <typename SIMD> struct TMLSIMDintAVX512 : TMLSIMDAVX512<SIMD> {};
+  template <typename SIMD> struct TMLSIMD8intAVX512 : TMLSIMDintAVX512<SIMD> {};
+  template <typename SIMD> struct TMLSIMD16intAVX512 : TMLSIMDintAVX512<SIMD> {};
+  template <typename SIMD> struct TMLSIMD32intAVX512 : TMLSIMDintAVX512<SIMD> {};
+  template <typename SIMD> struct TMLSIMD64intAVX512 : TMLSIMDintAVX512<SIMD> {};
+  template <typename SIMD> struct TMLSIMD8uiAVX512 : TMLSIMD8intAVX512<SIMD> {};
+  template <typename SIMD> struct TMLSIMD16uiAVX512 : TMLSIMD16intAVX512<SIMD> {};
+  template <typename SIMD> struct TMLSIMD32uiAVX512 : TMLSIMD32intAVX512<SIMD> {};
+  template <typename SIMD> struct TMLSIMD64uiAVX512 : TMLSIMD64intAVX512<SIMD> {};
+  template <typename SIMD> struct TMLSIMD8cuiAVX512 : TMLSIMD8intAVX512<SIMD> {};
+  template <typename SIMD> struct TMLSIMD16cuiAVX512 : TMLSIMD16intAVX512<SIMD> {};
+  template <typename SIMD> struct TMLSIMD32cuiAVX512 : TMLSIMD32intAVX512<SIMD> {};
+  template <typename SIMD> struct TMLSIMD64cuiAVX512 : TMLSIMD64intAVX512<SIMD> {};
+
+  // AVX-512 SIMD types
+  using MLSIMD32fAVX512 = Internal::TMLSIMD_impl<
+    TMLSIMD32floatAVX512, 
+    float, 
+    Internal::TMLSIMDIntrinsicFloatAVX512Helper>;
+
+  using MLSIMD64fAVX512 = Internal::TMLSIMD_impl<
+    TMLSIMD64floatAVX512, 
+    double, 
+    Internal::TMLSIMDIntrinsicDoubleAVX512Helper>;
+
+  using MLSIMD32cfAVX512 = Internal::TMLSIMD_impl<
+    TMLSIMD32floatAVX512, 
+    std::complex<float>, 
+    Internal::TMLSIMDIntrinsicFloatAVX512Helper>;
+
+  using MLSIMD64cfAVX512 = Internal::TMLSIMD_impl<
+    TMLSIMD64floatAVX512, 
+    std::complex<double>, 
+    Internal::TMLSIMDIntrinsicDoubleAVX512Helper>;
+
+  using MLSIMD32uAVX512 = Internal::TMLSIMD_impl<
+    TMLSIMD32uiAVX512, 
+    std::uint32_t, 
+    Internal::TMLSIMDIntrinsicIntegerAVX512Helper>;
+
+  using MLSIMD32iAVX512 = Internal::TMLSIMD_impl<
+    TMLSIMD32uiAVX512, 
+    std::int32_t, 
+    Internal::TMLSIMDIntrinsicIntegerAVX512Helper>;
+
+  using MLSIMD64uAVX512 = Internal::TMLSIMD_impl<
+    TMLSIMD64uiAVX512, 
+    std::uint64_t, 
+    Internal::TMLSIMDIntrinsicIntegerAVX512Helper>;
+
+  using MLSIMD64iAVX512 = Internal::TMLSIMD_impl<
+    TMLSIMD64uiAVX512, 
+    std::int64_t, 
+    Internal::TMLSIMDIntrinsicIntegerAVX512Helper>;
+
+  using MLSIMD32cuAVX512 = Internal::TMLSIMD_impl<
+    TMLSIMD32cuiAVX512, 
+    std::complex<std::uint32_t>, 
+    Internal::TMLSIMDIntrinsicIntegerAVX512Helper>;
+
+  using MLSIMD32ciAVX512 = Internal::TMLSIMD_impl<
+    TMLSIMD32cuiAVX512, 
+    std::complex<std::int32_t>, 
+    Internal::TMLSIMDIntrinsicIntegerAVX512Helper>;
+
+  using MLSIMD64cuAVX512 = Internal::TMLSIMD_impl<
+    TMLSIMD64cuiAVX512, 
+    std::complex<std::uint64_t>, 
+    Internal::TMLSIMDIntrinsicIntegerAVX512Helper>;
+
+  using MLSIMD64ciAVX512 = Internal::TMLSIMD_impl<
+    TMLSIMD64cuiAVX512, 
+    std::complex<std::int64_t>, 
+    Internal::TMLSIMDIntrinsicIntegerAVX512Helper>;
+#endif
+
+#if defined(ML_MATH_AVX512BW)
+  // AVX-512 byte and word SIMD types
+  using MLSIMD8uAVX512 = Internal::TMLSIMD_impl<
+    TMLSIMD8uiAVX512, 
+    std::uint8_t, 
+    Internal::TMLSIMDIntrinsicIntegerAVX512Helper>;
+
+  using MLSIMD8iAVX512 = Internal::TMLSIMD_impl<
+    TMLSIMD8uiAVX512, 
+    std::int8_t, 
+    Internal::TMLSIMDIntrinsicIntegerAVX512Helper>;
+
+  using MLSIMD16uAVX512 = Internal::TMLSIMD_impl<
+    TMLSIMD16uiAVX512, 
+    std::uint16_t, 
+    Internal::TMLSIMDIntrinsicIntegerAVX512Helper>;
+
+  using MLSIMD16iAVX512 = Internal::TMLSIMD_impl<
+    TMLSIMD16uiAVX512, 
+    std::int16_t, 
+    Internal::TMLSIMDIntrinsicIntegerAVX512Helper>;
+
+  using MLSIMD8cuAVX512 = Internal::TMLSIMD_impl<
+    TMLSIMD8cuiAVX512, 
+    std::complex<std::uint8_t>, 
+    Internal::TMLSIMDIntrinsicIntegerAVX512Helper>;
+
+  using MLSIMD8ciAVX512 = Internal::TMLSIMD_impl<
+    TMLSIMD8cuiAVX512, 
+    std::complex<std::int8_t>, 
+    Internal::TMLSIMDIntrinsicIntegerAVX512Helper>;
+
+  using MLSIMD16cuAVX512 = Internal::TMLSIMD_impl<
+    TMLSIMD16cuiAVX512, 
+    std::complex<std::uint16_t>, 
+    Internal::TMLSIMDIntrinsicIntegerAVX512Helper>;
+
+  using MLSIMD16ciAVX512 = Internal::TMLSIMD_impl<
+    TMLSIMD16cuiAVX512, 
+    std::complex<std::int16_t>, 
+    Internal::TMLSIMDIntrinsicIntegerAVX512Helper>;
+#endif
+
   //
   // Selection of a SIMD type based on the base type
   //
@@ -853,6 +1334,78 @@ namespace ML
     : TMLType<MLSIMD64cuAVX2> {};
 #endif
 
+#if defined(ML_MATH_AVX512F)
+  // AVX-512 single precision floating point types
+  template<typename T, std::size_t maxSize>
+  struct TMLSIMDTypeSelector<T, maxSize, Internal::TMLSIMDSelEnableIf_t<T, float, maxSize, 16>>
+    : TMLType<MLSIMD32fAVX512> {};
+  template<typename T, std::size_t maxSize>
+  struct TMLSIMDTypeSelector<T, maxSize, Internal::TMLSIMDSelEnableIf_t<T, std::complex<float>, maxSize, 8>>
+    : TMLType<MLSIMD32cfAVX512> {};
+
+  // AVX-512 double precision floating point types
+  template<typename T, std::size_t maxSize>
+  struct TMLSIMDTypeSelector<T, maxSize, Internal::TMLSIMDSelEnableIf_t<T, double, maxSize, 8>>
+    : TMLType<MLSIMD64fAVX512> {};
+  template<typename T, std::size_t maxSize>
+  struct TMLSIMDTypeSelector<T, maxSize, Internal::TMLSIMDSelEnableIf_t<T, std::complex<double>, maxSize, 4>>
+    : TMLType<MLSIMD64cfAVX512> {};
+
+  // AVX-512 doubleword and quadword integer types
+  template<typename T, std::size_t maxSize>
+  struct TMLSIMDTypeSelector<T, maxSize, Internal::TMLSIMDSelEnableIf_t<T, std::int32_t, maxSize, 16>>
+    : TMLType<MLSIMD32iAVX512> {};
+  template<typename T, std::size_t maxSize>
+  struct TMLSIMDTypeSelector<T, maxSize, Internal::TMLSIMDSelEnableIf_t<T, std::uint32_t, maxSize, 16>>
+    : TMLType<MLSIMD32uAVX512> {};
+  template<typename T, std::size_t maxSize>
+  struct TMLSIMDTypeSelector<T, maxSize, Internal::TMLSIMDSelEnableIf_t<T, std::int64_t, maxSize, 8>>
+    : TMLType<MLSIMD64iAVX512> {};
+  template<typename T, std::size_t maxSize>
+  struct TMLSIMDTypeSelector<T, maxSize, Internal::TMLSIMDSelEnableIf_t<T, std::uint64_t, maxSize, 8>>
+    : TMLType<MLSIMD64uAVX512> {};
+  template<typename T, std::size_t maxSize>
+  struct TMLSIMDTypeSelector<T, maxSize, Internal::TMLSIMDSelEnableIf_t<T, std::complex<std::int32_t>, maxSize, 8>>
+    : TMLType<MLSIMD32ciAVX512> {};
+  template<typename T, std::size_t maxSize>
+  struct TMLSIMDTypeSelector<T, maxSize, Internal::TMLSIMDSelEnableIf_t<T, std::complex<std::uint32_t>, maxSize, 8>>
+    : TMLType<MLSIMD32cuAVX512> {};
+  template<typename T, std::size_t maxSize>
+  struct TMLSIMDTypeSelector<T, maxSize, Internal::TMLSIMDSelEnableIf_t<T, std::complex<std::int64_t>, maxSize, 4>>
+    : TMLType<MLSIMD64ciAVX512> {};
+  template<typename T, std::size_t maxSize>
+  struct TMLSIMDTypeSelector<T, maxSize, Internal::TMLSIMDSelEnableIf_t<T, std::complex<std::uint64_t>, maxSize, 4>>
+    : TMLType<MLSIMD64cuAVX512> {};
+#endif
+
+#if defined(ML_MATH_AVX512BW)
+  // AVX-512 byte and word integer types
+  template<typename T, std::size_t maxSize>
+  struct TMLSIMDTypeSelector<T, maxSize, Internal::TMLSIMDSelEnableIf_t<T, std::int8_t, maxSize, 64>>
+    : TMLType<MLSIMD8iAVX512> {};
+  template<typename T, std::size_t maxSize>
+  struct TMLSIMDTypeSelector<T, maxSize, Internal::TMLSIMDSelEnableIf_t<T, std::uint8_t, maxSize, 64>>
+    : TMLType<MLSIMD8uAVX512> {};
+  template<typename T, std::size_t maxSize>
+  struct TMLSIMDTypeSelector<T, maxSize, Internal::TMLSIMDSelEnableIf_t<T, std::int16_t, maxSize, 32>>
+    : TMLType<MLSIMD16iAVX512> {};
+  template<typename T, std::size_t maxSize>
+  struct TMLSIMDTypeSelector<T, maxSize, Internal::TMLSIMDSelEnableIf_t<T, std::uint16_t, maxSize, 32>>
+    : TMLType<MLSIMD16uAVX512> {};
+  template<typename T, std::size_t maxSize>
+  struct TMLSIMDTypeSelector<T, maxSize, Internal::TMLSIMDSelEnableIf_t<T, std::complex<std::int8_t>, maxSize, 32>>
+    : TMLType<MLSIMD8ciAVX512> {};
+  template<typename T, std::size_t maxSize>
+  struct TMLSIMDTypeSelector<T, maxSize, Internal::TMLSIMDSelEnableIf_t<T, std::complex<std::uint8_t>, maxSize, 32>>
+    : TMLType<MLSIMD8cuAVX512> {};
+  template<typename T, std::size_t maxSize>
+  struct TMLSIMDTypeSelector<T, maxSize, Internal::TMLSIMDSelEnableIf_t<T, std::complex<std::int16_t>, maxSize, 16>>
+    : TMLType<MLSIMD16ciAVX512> {};
+  template<typename T, std::size_t maxSize>
+  struct TMLSIMDTypeSelector<T, maxSize, Internal::TMLSIMDSelEnableIf_t<T, std::complex<std::uint16_t>, maxSize, 16>>
+    : TMLType<MLSIMD16cuAVX512> {};
+#endif
+
   template<typename T, std::size_t maxSize>
   using TMLSIMDTypeSelector_t = typename TMLSIMDTypeSelector<T, maxSize>::type;
 
@@ -864,5 +1417,14 @@ namespace ML
 #include "Div.h"
 #include "FMA.h"
 #include "Broadcast.h"
+#include "MinMax.h"
+#include "Reduce.h"
+#include "Bitwise.h"
+#include "Sqrt.h"
+#include "Exp.h"
+#include "Trig.h"
+#include "Tanh.h"
+#include "Erf.h"
+#include "Transpose.h"
 
 #endif
@@ -0,0 +1,78 @@
+// Copyright 2021, Philipp Neufeld
+
+#ifndef ML_MATH_SIMD_Sqrt_H_
+#define ML_MATH_SIMD_Sqrt_H_
+
+// Includes
+#include <cmath>
+
+#include "SIMD.h"
+#include "FMA.h"
+#include "Bitwise.h"
+
+namespace ML
+{
+
+  namespace Internal
+  {
+    // Reciprocal square root in single precision: the hardware estimate (12 bits, 14 bits for AVX-512) refined
+    // by one Newton step, maximum error 4 ulp. Zero gives +inf and inf gives zero (the Newton step gives NaN
+    // there and is discarded), subnormal arguments are treated as zero by the estimate.
+    template<typename SIMD>
+    QM_ALWAYS_INLINE SIMD MLSIMDRsqrtNewton(const SIMD& a, const SIMD& estimate)
+    {
+      const SIMD h = SIMD::Set1(0.5f) * a;
+      const SIMD y = estimate;
+      const SIMD res = MLSIMDFmadd(y, MLSIMDFnmadd(h * y, y, SIMD::Set1(0.5f)), y);
+      return MLSIMDSelect(MLSIMDCmpEq(res, res), res, y);
+    }
+  }
+
+  // default square root and reciprocal square root (element-wise with std::sqrt)
+  template<typename SIMD>
+  QM_ALWAYS_INLINE SIMD
+    MLSIMDSqrt(const TMLSIMD<SIMD>& a)
+  {
+    return Internal::MLSIMDScalarMap(~a, [](auto x) { return std::sqrt(x); });
+  }
+
+  template<typename SIMD>
+  QM_ALWAYS_INLINE SIMD
+    MLSIMDRsqrt(const TMLSIMD<SIMD>& a)
+  {
+    return Internal::MLSIMDScalarMap(~a, [](auto x) { return decltype(x)(1) / std::sqrt(x); });
+  }
+
+  // The square roots are correctly rounded (IEEE), the double precision reciprocal square root is 1 / sqrt(a)
+  // (at most 1 ulp).
+#if defined(ML_MATH_SSE)
+  // SSE 32 bit floating point square root
+  QM_ALWAYS_INLINE MLSIMD32fSSE MLSIMDSqrt(const MLSIMD32fSSE& a) { return _mm_sqrt_ps(a.m_value); }
+  QM_ALWAYS_INLINE MLSIMD32fSSE MLSIMDRsqrt(const MLSIMD32fSSE& a) { return Internal::MLSIMDRsqrtNewton(a, MLSIMD32fSSE(_mm_rsqrt_ps(a.m_value))); }
+#endif
+
+#if defined(ML_MATH_SSE2)
+  // SSE2 64 bit floating point square root
+  QM_ALWAYS_INLINE MLSIMD64fSSE2 MLSIMDSqrt(const MLSIMD64fSSE2& a) { return _mm_sqrt_pd(a.m_value); }
+  QM_ALWAYS_INLINE MLSIMD64fSSE2 MLSIMDRsqrt(const MLSIMD64fSSE2& a) { return _mm_div_pd(_mm_set1_pd(1.0), _mm_sqrt_pd(a.m_value)); }
+#endif
+
+#if defined(ML_MATH_AVX)
+  // AVX 32/64 bit floating point square root
+  QM_ALWAYS_INLINE MLSIMD32fAVX MLSIMDSqrt(const MLSIMD32fAVX& a) { return _mm256_sqrt_ps(a.m_value); }
+  QM_ALWAYS_INLINE MLSIMD32fAVX MLSIMDRsqrt(const MLSIMD32fAVX& a) { return Internal::MLSIMDRsqrtNewton(a, MLSIMD32fAVX(_mm256_rsqrt_ps(a.m_value))); }
+  QM_ALWAYS_INLINE MLSIMD64fAVX MLSIMDSqrt(const MLSIMD64fAVX& a) { return _mm256_sqrt_pd(a.m_value); }
+  QM_ALWAYS_INLINE MLSIMD64fAVX MLSIMDRsqrt(const MLSIMD64fAVX& a) { return _mm256_div_pd(_mm256_set1_pd(1.0), _mm256_sqrt_pd(a.m_value)); }
+#endif
+
+#if defined(ML_MATH_AVX512F)
+  // AVX-512 32/64 bit floating point square root
+  QM_ALWAYS_INLINE MLSIMD32fAVX512 MLSIMDSqrt(const MLSIMD32fAVX512& a) { return _mm512_sqrt_ps(a.m_value); }
+  QM_ALWAYS_INLINE MLSIMD32fAVX512 MLSIMDRsqrt(const MLSIMD32fAVX512& a) { return Internal::MLSIMDRsqrtNewton(a, MLSIMD32fAVX512(_mm512_rsqrt14_ps(a.m_value))); }
+  QM_ALWAYS_INLINE MLSIMD64fAVX512 MLSIMDSqrt(const MLSIMD64fAVX512& a) { return _mm512_sqrt_pd(a.m_value); }
+  QM_ALWAYS_INLINE MLSIMD64fAVX512 MLSIMDRsqrt(const MLSIMD64fAVX512& a) { return _mm512_div_pd(_mm512_set1_pd(1.0), _mm512_sqrt_pd(a.m_value)); }
+#endif
+
+}
+
+#endif
@@ -140,6 +140,58 @@ namespace ML
   }
 #endif
 
+#if defined(ML_MATH_AVX512F)
+  // AVX-512 32 bit floating point subtraction
+  template<typename SIMD>
+  QM_ALWAYS_INLINE SIMD 
+    operator-(const TMLSIMD32floatAVX512<SIMD>& a, const TMLSIMD32floatAVX512<SIMD>& b)
+  {
+    return _mm512_sub_ps((~a).m_value, (~b).m_value);
+  }
+
+  // AVX-512 64 bit floating point subtraction
+  template<typename SIMD>
+  QM_ALWAYS_INLINE SIMD 
+    operator-(const TMLSIMD64floatAVX512<SIMD>& a, const TMLSIMD64floatAVX512<SIMD>& b)
+  {
+    return _mm512_sub_pd((~a).m_value, (~b).m_value);
+  }
+
+  // AVX-512 32 bit integer subtraction
+  template<typename SIMD>
+  QM_ALWAYS_INLINE SIMD 
+    operator-(const TMLSIMD32intAVX512<SIMD>& a, const TMLSIMD32intAVX512<SIMD>& b)
+  {
+    return _mm512_sub_epi32((~a).m_value, (~b).m_value);
+  }
+
+  // AVX-512 64 bit integer subtraction
+  template<typename SIMD>
+  QM_ALWAYS_INLINE SIMD 
+    operator-(const TMLSIMD64intAVX512<SIMD>& a, const TMLSIMD64intAVX512<SIMD>& b)
+  {
+    return _mm512_sub_epi64((~a).m_value, (~b).m_value);
+  }
+#endif
+
+#if defined(ML_MATH_AVX512BW)
+  // AVX-512 8 bit integer subtraction
+  template<typename SIMD>
+  QM_ALWAYS_INLINE SIMD 
+    operator-(const TMLSIMD8intAVX512<SIMD>& a, const TMLSIMD8intAVX512<SIMD>& b)
+  {
+    return _mm512_sub_epi8((~a).m_value, (~b).m_value);
+  }
+
+  // AVX-512 16 bit integer subtraction
+  template<typename SIMD>
+  QM_ALWAYS_INLINE SIMD 
+    operator-(const TMLSIMD16intAVX512<SIMD>& a, const TMLSIMD16intAVX512<SIMD>& b)
+  {
+    return _mm512_sub_epi16((~a).m_value, (~b).m_value);
+  }
+#endif
+
 }
 
 #endif
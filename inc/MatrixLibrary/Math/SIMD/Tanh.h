@@ -0,0 +1,95 @@
+// Copyright 2021, Philipp Neufeld
+
+#ifndef ML_MATH_SIMD_Tanh_H_
+#define ML_MATH_SIMD_Tanh_H_
+
+// Includes
+#include <cmath>
+#include <complex>
+
+#include "SIMD.h"
+#include "FMA.h"
+#include "MinMax.h"
+#include "Bitwise.h"
+#include "Exp.h"
+
+namespace ML
+{
+
+  namespace Internal
+  {
+    // Rational approximation of tanh in single precision (degree 13 / 6, maximum error 5 ulp).
+    // tanh(x) rounds to +-1 beyond |x| = 7.90531, the argument is clamped to that range (NaN is kept).
+    template<typename SIMD>
+    QM_ALWAYS_INLINE SIMD MLSIMDTanhFloat(const SIMD& a)
+    {
+      const SIMD x = MLSIMDClamp(a, SIMD::Set1(-7.90531110763549805f), SIMD::Set1(7.90531110763549805f));
+      const SIMD x2 = x * x;
+
+      SIMD p = MLSIMDFmadd(x2, SIMD::Set1(-2.76076847742355e-16f), SIMD::Set1(2.00018790482477e-13f));
+      p = MLSIMDFmadd(x2, p, SIMD::Set1(-8.60467152213735e-11f));
+      p = MLSIMDFmadd(x2, p, SIMD::Set1(5.12229709037114e-08f));
+      p = MLSIMDFmadd(x2, p, SIMD::Set1(1.48572235717979e-05f));
+      p = MLSIMDFmadd(x2, p, SIMD::Set1(6.37261928875436e-04f));
+      p = MLSIMDFmadd(x2, p, SIMD::Set1(4.89352455891786e-03f));
+
+      SIMD q = MLSIMDFmadd(x2, SIMD::Set1(1.19825839466702e-06f), SIMD::Set1(1.18534705686654e-04f));
+      q = MLSIMDFmadd(x2, q, SIMD::Set1(2.26843463243900e-03f));
+      q = MLSIMDFmadd(x2, q, SIMD::Set1(4.89352518554385e-03f));
+
+      // x is applied last, x P(x^2) would be subnormal for tiny x
+      return x * (p / q);
+    }
+
+    // tanh in double precision: |x| + |x|^3 P(x^2) / Q(x^2) for |x| < 0.625 (Cephes), 1 - 2 / (e^2|x| + 1)
+    // otherwise, with the sign of x copied onto the result. Maximum error 2 ulp.
+    template<typename SIMD>
+    QM_ALWAYS_INLINE SIMD MLSIMDTanhDouble(const SIMD& a)
+    {
+      const SIMD ax = MLSIMDAbs(a);
+      const SIMD x2 = ax * ax;
+      SIMD p = MLSIMDFmadd(x2, SIMD::Set1(-9.64399179425052238628e-1), SIMD::Set1(-9.92877231001918586564e1));
+      p = MLSIMDFmadd(x2, p, SIMD::Set1(-1.61468768441708447952e3));
+      SIMD q = x2 + SIMD::Set1(1.12811678491632931402e2);
+      q = MLSIMDFmadd(x2, q, SIMD::Set1(2.23548839060100448583e3));
+      q = MLSIMDFmadd(x2, q, SIMD::Set1(4.84406305325125486048e3));
+      const SIMD small = MLSIMDFmadd(ax * x2, p / q, ax);
+      const SIMD large = SIMD::Set1(1.0) - SIMD::Set1(2.0) / (MLSIMDExp(ax + ax) + SIMD::Set1(1.0));
+      const SIMD res = MLSIMDSelect(MLSIMDCmpLt(ax, SIMD::Set1(0.625)), small, large);
+      return MLSIMDOr(res, MLSIMDAnd(a, SIMD::Set1(-0.0)));
+    }
+  }
+
+  // default hyperbolic tangent (element-wise with std::tanh)
+  template<typename SIMD>
+  QM_ALWAYS_INLINE SIMD
+    MLSIMDTanh(const TMLSIMD<SIMD>& a)
+  {
+    return Internal::MLSIMDScalarMap(~a, [](auto x) { return std::tanh(x); });
+  }
+
+#if defined(ML_MATH_SSE)
+  // SSE 32 bit floating point hyperbolic tangent
+  QM_ALWAYS_INLINE MLSIMD32fSSE MLSIMDTanh(const MLSIMD32fSSE& a) { return Internal::MLSIMDTanhFloat(a); }
+#endif
+
+#if defined(ML_MATH_SSE2)
+  // SSE2 64 bit floating point hyperbolic tangent
+  QM_ALWAYS_INLINE MLSIMD64fSSE2 MLSIMDTanh(const MLSIMD64fSSE2& a) { return Internal::MLSIMDTanhDouble(a); }
+#endif
+
+#if defined(ML_MATH_AVX)
+  // AVX 32/64 bit floating point hyperbolic tangent
+  QM_ALWAYS_INLINE MLSIMD32fAVX MLSIMDTanh(const MLSIMD32fAVX& a) { return Internal::MLSIMDTanhFloat(a); }
+  QM_ALWAYS_INLINE MLSIMD64fAVX MLSIMDTanh(const MLSIMD64fAVX& a) { return Internal::MLSIMDTanhDouble(a); }
+#endif
+
+#if defined(ML_MATH_AVX512F)
+  // AVX-512 32/64 bit floating point hyperbolic tangent
+  QM_ALWAYS_INLINE MLSIMD32fAVX512 MLSIMDTanh(const MLSIMD32fAVX512& a) { return Internal::MLSIMDTanhFloat(a); }
+  QM_ALWAYS_INLINE MLSIMD64fAVX512 MLSIMDTanh(const MLSIMD64fAVX512& a) { return Internal::MLSIMDTanhDouble(a); }
+#endif
+
+}
+
+#endif
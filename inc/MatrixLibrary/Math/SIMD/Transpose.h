@@ -0,0 +1,225 @@
+// Copyright 2021, Philipp Neufeld
+
+#ifndef ML_MATH_SIMD_Transpose_H_
+#define ML_MATH_SIMD_Transpose_H_
+
+// Includes
+#include <cstring>
+#include <utility>
+
+#include "SIMD.h"
+
+#include "../../QTL/EnableIf.h"
+
+namespace ML
+{
+
+  // Transposes the N x N block held in the N registers rows[0..N) (N is the SIMD size, rows[i] is
+  // row i of the block before and column i after the call). The default goes through memory.
+  template<typename SIMD, typename=TMLEnableIf_t<TMLIsSIMD_v<SIMD>>>
+  QM_ALWAYS_INLINE void MLSIMDTranspose(SIMD* rows)
+  {
+    using ET = TMLSIMDElementType_t<SIMD>;
+    constexpr std::size_t n = TMLSIMDSize_v<SIMD>;
+    alignas(SIMD) ET x[n * n];
+    for (std::size_t i = 0; i < n; i++)
+      SIMD::StoreAligned(rows[i], x + i * n);
+    for (std::size_t i = 0; i < n; i++)
+      for (std::size_t j = i + 1; j < n; j++)
+        std::swap(x[i * n + j], x[j * n + i]);
+    for (std::size_t i = 0; i < n; i++)
+      rows[i] = SIMD::LoadAligned(x + i * n);
+  }
+
+  namespace Internal
+  {
+    // In-register transposes of N x N lanes (unpack / shuffle networks). The lanes of 64 and 128 bit are
+    // also used for complex numbers, the floating point registers also for integers.
+#if defined(ML_MATH_SSE)
+    QM_ALWAYS_INLINE void MLSIMDTransposeLanes(__m128 (&r)[4]) { _MM_TRANSPOSE4_PS(r[0], r[1], r[2], r[3]); }
+#endif
+
+#if defined(ML_MATH_SSE2)
+    QM_ALWAYS_INLINE void MLSIMDTransposeLanes(__m128d (&r)[2])
+    {
+      const __m128d t = _mm_unpacklo_pd(r[0], r[1]);
+      r[1] = _mm_unpackhi_pd(r[0], r[1]);
+      r[0] = t;
+    }
+#endif
+
+#if defined(ML_MATH_AVX)
+    QM_ALWAYS_INLINE void MLSIMDTransposeLanes(__m256 (&r)[8])
+    {
+      __m256 t[8], s[8];
+      for (int k = 0; k < 4; k++)
+      {
+        t[2 * k] = _mm256_unpacklo_ps(r[2 * k], r[2 * k + 1]);
+        t[2 * k + 1] = _mm256_unpackhi_ps(r[2 * k], r[2 * k + 1]);
+      }
+      for (int g = 0; g < 2; g++)
+      {
+        s[4 * g + 0] = _mm256_shuffle_ps(t[4 * g], t[4 * g + 2], _MM_SHUFFLE(1, 0, 1, 0));
+        s[4 * g + 1] = _mm256_shuffle_ps(t[4 * g], t[4 * g + 2], _MM_SHUFFLE(3, 2, 3, 2));
+        s[4 * g + 2] = _mm256_shuffle_ps(t[4 * g + 1], t[4 * g + 3], _MM_SHUFFLE(1, 0, 1, 0));
+        s[4 * g + 3] = _mm256_shuffle_ps(t[4 * g + 1], t[4 * g + 3], _MM_SHUFFLE(3, 2, 3, 2));
+      }
+      for (int c = 0; c < 4; c++)
+      {
+        r[c] = _mm256_permute2f128_ps(s[c], s[4 + c], 0x20);
+        r[4 + c] = _mm256_permute2f128_ps(s[c], s[4 + c], 0x31);
+      }
+    }
+
+    QM_ALWAYS_INLINE void MLSIMDTransposeLanes(__m256d (&r)[4])
+    {
+      const __m256d t0 = _mm256_unpacklo_pd(r[0], r[1]);
+      const __m256d t1 = _mm256_unpackhi_pd(r[0], r[1]);
+      const __m256d t2 = _mm256_unpacklo_pd(r[2], r[3]);
+      const __m256d t3 = _mm256_unpackhi_pd(r[2], r[3]);
+      r[0] = _mm256_permute2f128_pd(t0, t2, 0x20);
+      r[1] = _mm256_permute2f128_pd(t1, t3, 0x20);
+      r[2] = _mm256_permute2f128_pd(t0, t2, 0x31);
+      r[3] = _mm256_permute2f128_pd(t1, t3, 0x31);
+    }
+
+    QM_ALWAYS_INLINE void MLSIMDTransposeLanes(__m256d (&r)[2])
+    {
+      const __m256d t = _mm256_permute2f128_pd(r[0], r[1], 0x20);
+      r[1] = _mm256_permute2f128_pd(r[0], r[1], 0x31);
+      r[0] = t;
+    }
+#endif
+
+#if defined(ML_MATH_AVX512F)
+    // 4 x 4 blocks of 128 bit lanes: lane c of row g goes to lane g of row c
+    QM_ALWAYS_INLINE void MLSIMDTransposeLanes(__m512d (&r)[4])
+    {
+      const __m512d x0 = _mm512_shuffle_f64x2(r[0], r[1], _MM_SHUFFLE(2, 0, 2, 0));
+      const __m512d x1 = _mm512_shuffle_f64x2(r[0], r[1], _MM_SHUFFLE(3, 1, 3, 1));
+      const __m512d x2 = _mm512_shuffle_f64x2(r[2], r[3], _MM_SHUFFLE(2, 0, 2, 0));
+      const __m512d x3 = _mm512_shuffle_f64x2(r[2], r[3], _MM_SHUFFLE(3, 1, 3, 1));
+      r[0] = _mm512_shuffle_f64x2(x0, x2, _MM_SHUFFLE(2, 0, 2, 0));
+      r[1] = _mm512_shuffle_f64x2(x1, x3, _MM_SHUFFLE(2, 0, 2, 0));
+      r[2] = _mm512_shuffle_f64x2(x0, x2, _MM_SHUFFLE(3, 1, 3, 1));
+      r[3] = _mm512_shuffle_f64x2(x1, x3, _MM_SHUFFLE(3, 1, 3, 1));
+    }
+
+    // Pairs of rows are transposed within the 128 bit lanes, the 4 x 4 blocks of lanes afterwards
+    QM_ALWAYS_INLINE void MLSIMDTransposeLanes(__m512d (&r)[8])
+    {
+      __m512d t[8], u[8];
+      for (int k = 0; k < 4; k++)
+      {
+        t[2 * k] = _mm512_unpacklo_pd(r[2 * k], r[2 * k + 1]);
+        t[2 * k + 1] = _mm512_unpackhi_pd(r[2 * k], r[2 * k + 1]);
+      }
+      for (int g = 0; g < 2; g++)
+      {
+        u[4 * g + 0] = _mm512_shuffle_f64x2(t[4 * g], t[4 * g + 2], _MM_SHUFFLE(2, 0, 2, 0));
+        u[4 * g + 1] = _mm512_shuffle_f64x2(t[4 * g], t[4 * g + 2], _MM_SHUFFLE(3, 1, 3, 1));
+        u[4 * g + 2] = _mm512_shuffle_f64x2(t[4 * g + 1], t[4 * g + 3], _MM_SHUFFLE(2, 0, 2, 0));
+        u[4 * g + 3] = _mm512_shuffle_f64x2(t[4 * g + 1], t[4 * g + 3], _MM_SHUFFLE(3, 1, 3, 1));
+      }
+      r[0] = _mm512_shuffle_f64x2(u[0], u[4], _MM_SHUFFLE(2, 0, 2, 0));
+      r[4] = _mm512_shuffle_f64x2(u[0], u[4], _MM_SHUFFLE(3, 1, 3, 1));
+      r[2] = _mm512_shuffle_f64x2(u[1], u[5], _MM_SHUFFLE(2, 0, 2, 0));
+      r[6] = _mm512_shuffle_f64x2(u[1], u[5], _MM_SHUFFLE(3, 1, 3, 1));
+      r[1] = _mm512_shuffle_f64x2(u[2], u[6], _MM_SHUFFLE(2, 0, 2, 0));
+      r[5] = _mm512_shuffle_f64x2(u[2], u[6], _MM_SHUFFLE(3, 1, 3, 1));
+      r[3] = _mm512_shuffle_f64x2(u[3], u[7], _MM_SHUFFLE(2, 0, 2, 0));
+      r[7] = _mm512_shuffle_f64x2(u[3], u[7], _MM_SHUFFLE(3, 1, 3, 1));
+    }
+
+    // Groups of 4 rows are transposed within the 128 bit lanes (as by _MM_TRANSPOSE4_PS), the 4 x 4
+    // blocks of lanes afterwards
+    QM_ALWAYS_INLINE void MLSIMDTransposeLanes(__m512 (&r)[16])
+    {
+      __m512 t[16], s[16];
+      for (int k = 0; k < 8; k++)
+      {
+        t[2 * k] = _mm512_unpacklo_ps(r[2 * k], r[2 * k + 1]);
+        t[2 * k + 1] = _mm512_unpackhi_ps(r[2 * k], r[2 * k + 1]);
+      }
+      for (int g = 0; g < 4; g++)
+      {
+        s[4 * g + 0] = _mm512_shuffle_ps(t[4 * g], t[4 * g + 2], _MM_SHUFFLE(1, 0, 1, 0));
+        s[4 * g + 1] = _mm512_shuffle_ps(t[4 * g], t[4 * g + 2], _MM_SHUFFLE(3, 2, 3, 2));
+        s[4 * g + 2] = _mm512_shuffle_ps(t[4 * g + 1], t[4 * g + 3], _MM_SHUFFLE(1, 0, 1, 0));
+        s[4 * g + 3] = _mm512_shuffle_ps(t[4 * g + 1], t[4 * g + 3], _MM_SHUFFLE(3, 2, 3, 2));
+      }
+      for (int c = 0; c < 4; c++)
+      {
+        const __m512 x0 = _mm512_shuffle_f32x4(s[c], s[4 + c], _MM_SHUFFLE(2, 0, 2, 0));
+        const __m512 y0 = _mm512_shuffle_f32x4(s[c], s[4 + c], _MM_SHUFFLE(3, 1, 3, 1));
+        const __m512 x1 = _mm512_shuffle_f32x4(s[8 + c], s[12 + c], _MM_SHUFFLE(2, 0, 2, 0));
+        const __m512 y1 = _mm512_shuffle_f32x4(s[8 + c], s[12 + c], _MM_SHUFFLE(3, 1, 3, 1));
+        r[c] = _mm512_shuffle_f32x4(x0, x1, _MM_SHUFFLE(2, 0, 2, 0));
+        r[8 + c] = _mm512_shuffle_f32x4(x0, x1, _MM_SHUFFLE(3, 1, 3, 1));
+        r[4 + c] = _mm512_shuffle_f32x4(y0, y1, _MM_SHUFFLE(2, 0, 2, 0));
+        r[12 + c] = _mm512_shuffle_f32x4(y0, y1, _MM_SHUFFLE(3, 1, 3, 1));
+      }
+    }
+#endif
+
+    // Transposes the registers as lanes of the register type V (of the same size)
+    template<typename V, typename SIMD>
+    QM_ALWAYS_INLINE void MLSIMDTransposeAs(SIMD* rows)
+    {
+      constexpr std::size_t n = TMLSIMDSize_v<SIMD>;
+      static_assert(sizeof(V) == sizeof(rows->m_value), "Register size mismatch");
+      V r[n];
+      for (std::size_t i = 0; i < n; i++)
+        std::memcpy(&r[i], &rows[i].m_value, sizeof(V));
+      MLSIMDTransposeLanes(r);
+      for (std::size_t i = 0; i < n; i++)
+        std::memcpy(&rows[i].m_value, &r[i], sizeof(V));
+    }
+  }
+
+#if defined(ML_MATH_SSE)
+  // SSE 32 bit floating point transpose (4 x 4)
+  QM_ALWAYS_INLINE void MLSIMDTranspose(MLSIMD32fSSE* rows) { Internal::MLSIMDTransposeAs<__m128>(rows); }
+#endif
+
+#if defined(ML_MATH_SSE2)
+  // SSE2 64 bit floating point, 32/64 bit integer and complex float transpose (4 x 4 and 2 x 2)
+  QM_ALWAYS_INLINE void MLSIMDTranspose(MLSIMD64fSSE2* rows) { Internal::MLSIMDTransposeAs<__m128d>(rows); }
+  QM_ALWAYS_INLINE void MLSIMDTranspose(MLSIMD32cfSSE* rows) { Internal::MLSIMDTransposeAs<__m128d>(rows); }
+  QM_ALWAYS_INLINE void MLSIMDTranspose(MLSIMD32iSSE2* rows) { Internal::MLSIMDTransposeAs<__m128>(rows); }
+  QM_ALWAYS_INLINE void MLSIMDTranspose(MLSIMD32uSSE2* rows) { Internal::MLSIMDTransposeAs<__m128>(rows); }
+  QM_ALWAYS_INLINE void MLSIMDTranspose(MLSIMD64iSSE2* rows) { Internal::MLSIMDTransposeAs<__m128d>(rows); }
+  QM_ALWAYS_INLINE void MLSIMDTranspose(MLSIMD64uSSE2* rows) { Internal::MLSIMDTransposeAs<__m128d>(rows); }
+#endif
+
+#if defined(ML_MATH_AVX)
+  // AVX 32/64 bit floating point and complex transpose (8 x 8, 4 x 4 and 2 x 2)
+  QM_ALWAYS_INLINE void MLSIMDTranspose(MLSIMD32fAVX* rows) { Internal::MLSIMDTransposeAs<__m256>(rows); }
+  QM_ALWAYS_INLINE void MLSIMDTranspose(MLSIMD64fAVX* rows) { Internal::MLSIMDTransposeAs<__m256d>(rows); }
+  QM_ALWAYS_INLINE void MLSIMDTranspose(MLSIMD32cfAVX* rows) { Internal::MLSIMDTransposeAs<__m256d>(rows); }
+  QM_ALWAYS_INLINE void MLSIMDTranspose(MLSIMD64cfAVX* rows) { Internal::MLSIMDTransposeAs<__m256d>(rows); }
+#endif
+
+#if defined(ML_MATH_AVX2)
+  // AVX2 32/64 bit integer transpose (8 x 8 and 4 x 4)
+  QM_ALWAYS_INLINE void MLSIMDTranspose(MLSIMD32iAVX2* rows) { Internal::MLSIMDTransposeAs<__m256>(rows); }
+  QM_ALWAYS_INLINE void MLSIMDTranspose(MLSIMD32uAVX2* rows) { Internal::MLSIMDTransposeAs<__m256>(rows); }
+  QM_ALWAYS_INLINE void MLSIMDTranspose(MLSIMD64iAVX2* rows) { Internal::MLSIMDTransposeAs<__m256d>(rows); }
+  QM_ALWAYS_INLINE void MLSIMDTranspose(MLSIMD64uAVX2* rows) { Internal::MLSIMDTransposeAs<__m256d>(rows); }
+#endif
+
+#if defined(ML_MATH_AVX512F)
+  // AVX-512 32/64 bit floating point, integer and complex transpose (16 x 16, 8 x 8 and 4 x 4)
+  QM_ALWAYS_INLINE void MLSIMDTranspose(MLSIMD32fAVX512* rows) { Internal::MLSIMDTransposeAs<__m512>(rows); }
+  QM_ALWAYS_INLINE void MLSIMDTranspose(MLSIMD64fAVX512* rows) { Internal::MLSIMDTransposeAs<__m512d>(rows); }
+  QM_ALWAYS_INLINE void MLSIMDTranspose(MLSIMD32cfAVX512* rows) { Internal::MLSIMDTransposeAs<__m512d>(rows); }
+  QM_ALWAYS_INLINE void MLSIMDTranspose(MLSIMD64cfAVX512* rows) { Internal::MLSIMDTransposeAs<__m512d>(rows); }
+  QM_ALWAYS_INLINE void MLSIMDTranspose(MLSIMD32iAVX512* rows) { Internal::MLSIMDTransposeAs<__m512>(rows); }
+  QM_ALWAYS_INLINE void MLSIMDTranspose(MLSIMD32uAVX512* rows) { Internal::MLSIMDTransposeAs<__m512>(rows); }
+  QM_ALWAYS_INLINE void MLSIMDTranspose(MLSIMD64iAVX512* rows) { Internal::MLSIMDTransposeAs<__m512d>(rows); }
+  QM_ALWAYS_INLINE void MLSIMDTranspose(MLSIMD64uAVX512* rows) { Internal::MLSIMDTransposeAs<__m512d>(rows); }
+#endif
+
+}
+
+#endif
@@ -0,0 +1,151 @@
+// Copyright 2021, Philipp Neufeld
+
+#ifndef ML_MATH_SIMD_Trig_H_
+#define ML_MATH_SIMD_Trig_H_
+
+// Includes
+#include <cmath>
+
+#include "SIMD.h"
+#include "FMA.h"
+#include "MinMax.h"
+#include "Bitwise.h"
+
+namespace ML
+{
+
+  namespace Internal
+  {
+    // sin(x) for x = r + q pi / 2 from s = sin(r) and c = cos(r): the quadrant q mod 4 = m selects
+    // s, c, -s, -c. m and its bits are computed with rounding (q is an integer below 2^22).
+    template<typename SIMD>
+    QM_ALWAYS_INLINE SIMD MLSIMDSinQuadrant(const SIMD& q, const SIMD& s, const SIMD& c)
+    {
+      using ET = TMLSIMDElementType_t<SIMD>;
+      const SIMD m = MLSIMDFnmadd(SIMD::Set1(ET(4)), MLSIMDRound(MLSIMDFmsub(q, SIMD::Set1(ET(0.25)), SIMD::Set1(ET(0.375)))), q);
+      const SIMD hi = MLSIMDRound(MLSIMDFmsub(m, SIMD::Set1(ET(0.5)), SIMD::Set1(ET(0.25))));
+      const SIMD odd = MLSIMDFnmadd(SIMD::Set1(ET(2)), hi, m);
+      const SIMD sign = MLSIMDFnmadd(SIMD::Set1(ET(2)), hi, SIMD::Set1(ET(1)));
+      return sign * MLSIMDSelect(MLSIMDCmpEq(odd, SIMD::Set1(ET(1))), c, s);
+    }
+
+    // sin(r) and cos(r) for |r| <= pi / 4 (Cephes polynomials)
+    template<typename SIMD>
+    QM_ALWAYS_INLINE void MLSIMDSinCosFloat(const SIMD& r, SIMD& s, SIMD& c)
+    {
+      const SIMD z = r * r;
+      s = MLSIMDFmadd(z, SIMD::Set1(-1.9515295891e-4f), SIMD::Set1(8.3321608736e-3f));
+      s = MLSIMDFmadd(z, s, SIMD::Set1(-1.6666654611e-1f));
+      s = MLSIMDFmadd(s * z, r, r);
+      c = MLSIMDFmadd(z, SIMD::Set1(2.443315711809948e-5f), SIMD::Set1(-1.388731625493765e-3f));
+      c = MLSIMDFmadd(z, c, SIMD::Set1(4.166664568298827e-2f));
+      c = MLSIMDFmadd(c * z, z, MLSIMDFnmadd(SIMD::Set1(0.5f), z, SIMD::Set1(1.0f)));
+    }
+
+    template<typename SIMD>
+    QM_ALWAYS_INLINE void MLSIMDSinCosDouble(const SIMD& r, SIMD& s, SIMD& c)
+    {
+      const SIMD z = r * r;
+      s = MLSIMDFmadd(z, SIMD::Set1(1.58962301576546568060e-10), SIMD::Set1(-2.50507477628578072866e-8));
+      s = MLSIMDFmadd(z, s, SIMD::Set1(2.75573136213857245213e-6));
+      s = MLSIMDFmadd(z, s, SIMD::Set1(-1.98412698295895385996e-4));
+      s = MLSIMDFmadd(z, s, SIMD::Set1(8.33333333332211858878e-3));
+      s = MLSIMDFmadd(z, s, SIMD::Set1(-1.66666666666666307295e-1));
+      s = MLSIMDFmadd(s * z, r, r);
+      c = MLSIMDFmadd(z, SIMD::Set1(-1.13585365213876817300e-11), SIMD::Set1(2.08757008419747316778e-9));
+      c = MLSIMDFmadd(z, c, SIMD::Set1(-2.75573141792967388112e-7));
+      c = MLSIMDFmadd(z, c, SIMD::Set1(2.48015872888517045348e-5));
+      c = MLSIMDFmadd(z, c, SIMD::Set1(-1.38888888888730564116e-3));
+      c = MLSIMDFmadd(z, c, SIMD::Set1(4.16666666666665929218e-2));
+      c = MLSIMDFmadd(c * z, z, MLSIMDFnmadd(SIMD::Set1(0.5), z, SIMD::Set1(1.0)));
+    }
+
+    // sin(a) (cos(a) for shift = 1) with a = r + q pi / 2. pi / 2 is split into parts with short mantissas
+    // (Cody and Waite) so that q times each part but the last is exact for |a| up to 8192 (float) / 2^24 (double),
+    // registers with larger (or infinite) arguments are computed with std::sin / std::cos. Maximum error 2 ulp.
+    template<typename SIMD>
+    QM_ALWAYS_INLINE SIMD MLSIMDSinFloat(const SIMD& a, float shift)
+    {
+      if (MLSIMDAnyLane(MLSIMDCmpLt(SIMD::Set1(8192.0f), MLSIMDAbs(a))))
+      {
+        if (shift == 0.0f)
+          return MLSIMDScalarMap(a, [](float x) { return std::sin(x); });
+        return MLSIMDScalarMap(a, [](float x) { return std::cos(x); });
+      }
+
+      const SIMD q = MLSIMDRound(a * SIMD::Set1(0.636619772367581343f));
+      SIMD r = MLSIMDFnmadd(q, SIMD::Set1(1.5703125f), a);
+      r = MLSIMDFnmadd(q, SIMD::Set1(4.837512969970703125e-4f), r);
+      r = MLSIMDFnmadd(q, SIMD::Set1(7.549533620476722717e-8f), r);
+      r = MLSIMDFnmadd(q, SIMD::Set1(2.563344068257089600e-12f), r);
+
+      SIMD s, c;
+      MLSIMDSinCosFloat(r, s, c);
+      const SIMD res = MLSIMDSinQuadrant(q + SIMD::Set1(shift), s, c);
+      return shift == 0.0f ? MLSIMDSelect(MLSIMDCmpEq(a, SIMD::SetZero()), a, res) : res;
+    }
+
+    template<typename SIMD>
+    QM_ALWAYS_INLINE SIMD MLSIMDSinDouble(const SIMD& a, double shift)
+    {
+      if (MLSIMDAnyLane(MLSIMDCmpLt(SIMD::Set1(16777216.0), MLSIMDAbs(a))))
+      {
+        if (shift == 0.0)
+          return MLSIMDScalarMap(a, [](double x) { return std::sin(x); });
+        return MLSIMDScalarMap(a, [](double x) { return std::cos(x); });
+      }
+
+      const SIMD q = MLSIMDRound(a * SIMD::Set1(0.636619772367581343076));
+      SIMD r = MLSIMDFnmadd(q, SIMD::Set1(1.57079625129699707031e0), a);
+      r = MLSIMDFnmadd(q, SIMD::Set1(7.54978941586159635335e-8), r);
+      r = MLSIMDFnmadd(q, SIMD::Set1(5.39030285815811905290e-15), r);
+
+      SIMD s, c;
+      MLSIMDSinCosDouble(r, s, c);
+      const SIMD res = MLSIMDSinQuadrant(q + SIMD::Set1(shift), s, c);
+      return shift == 0.0 ? MLSIMDSelect(MLSIMDCmpEq(a, SIMD::SetZero()), a, res) : res;
+    }
+  }
+
+  // default sine and cosine (element-wise with std::sin and std::cos)
+  template<typename SIMD>
+  QM_ALWAYS_INLINE SIMD
+    MLSIMDSin(const TMLSIMD<SIMD>& a)
+  {
+    return Internal::MLSIMDScalarMap(~a, [](auto x) { return std::sin(x); });
+  }
+
+  template<typename SIMD>
+  QM_ALWAYS_INLINE SIMD
+    MLSIMDCos(const TMLSIMD<SIMD>& a)
+  {
+    return Internal::MLSIMDScalarMap(~a, [](auto x) { return std::cos(x); });
+  }
+
+#if defined(ML_MATH_SSE2)
+  // SSE2 32/64 bit floating point sine and cosine
+  QM_ALWAYS_INLINE MLSIMD32fSSE MLSIMDSin(const MLSIMD32fSSE& a) { return Internal::MLSIMDSinFloat(a, 0.0f); }
+  QM_ALWAYS_INLINE MLSIMD32fSSE MLSIMDCos(const MLSIMD32fSSE& a) { return Internal::MLSIMDSinFloat(a, 1.0f); }
+  QM_ALWAYS_INLINE MLSIMD64fSSE2 MLSIMDSin(const MLSIMD64fSSE2& a) { return Internal::MLSIMDSinDouble(a, 0.0); }
+  QM_ALWAYS_INLINE MLSIMD64fSSE2 MLSIMDCos(const MLSIMD64fSSE2& a) { return Internal::MLSIMDSinDouble(a, 1.0); }
+#endif
+
+#if defined(ML_MATH_AVX)
+  // AVX 32/64 bit floating point sine and cosine
+  QM_ALWAYS_INLINE MLSIMD32fAVX MLSIMDSin(const MLSIMD32fAVX& a) { return Internal::MLSIMDSinFloat(a, 0.0f); }
+  QM_ALWAYS_INLINE MLSIMD32fAVX MLSIMDCos(const MLSIMD32fAVX& a) { return Internal::MLSIMDSinFloat(a, 1.0f); }
+  QM_ALWAYS_INLINE MLSIMD64fAVX MLSIMDSin(const MLSIMD64fAVX& a) { return Internal::MLSIMDSinDouble(a, 0.0); }
+  QM_ALWAYS_INLINE MLSIMD64fAVX MLSIMDCos(const MLSIMD64fAVX& a) { return Internal::MLSIMDSinDouble(a, 1.0); }
+#endif
+
+#if defined(ML_MATH_AVX512F)
+  // AVX-512 32/64 bit floating point sine and cosine
+  QM_ALWAYS_INLINE MLSIMD32fAVX512 MLSIMDSin(const MLSIMD32fAVX512& a) { return Internal::MLSIMDSinFloat(a, 0.0f); }
+  QM_ALWAYS_INLINE MLSIMD32fAVX512 MLSIMDCos(const MLSIMD32fAVX512& a) { return Internal::MLSIMDSinFloat(a, 1.0f); }
+  QM_ALWAYS_INLINE MLSIMD64fAVX512 MLSIMDSin(const MLSIMD64fAVX512& a) { return Internal::MLSIMDSinDouble(a, 0.0); }
+  QM_ALWAYS_INLINE MLSIMD64fAVX512 MLSIMDCos(const MLSIMD64fAVX512& a) { return Internal::MLSIMDSinDouble(a, 1.0); }
+#endif
+
+}
+
+#endif
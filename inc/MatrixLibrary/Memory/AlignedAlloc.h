@@ -40,6 +40,27 @@ namespace ML
       }
       ptr = nullptr;
     }
+
+  // Aligned array that is freed when it goes out of scope (e.g. for temporary buffers)
+  template<typename T>
+  class TMLAlignedArray
+  {
+  public:
+    TMLAlignedArray(std::size_t size, std::size_t alignment) 
+      : m_size(size), m_data(MLAlignedAlloc<T>(size, alignment)) {}
+    ~TMLAlignedArray() { MLAlignedFree(m_data); }
+
+    TMLAlignedArray(const TMLAlignedArray&) = delete;
+    TMLAlignedArray& operator=(const TMLAlignedArray&) = delete;
+
+    std::size_t size() const noexcept { return m_size; }
+    T* data() noexcept { return m_data; }
+    const T* data() const noexcept { return m_data; }
+
+  private:
+    std::size_t m_size;
+    T* m_data;
+  };
 }
 
 #endif
@@ -0,0 +1,151 @@
+// Copyright 2021, Philipp Neufeld
+
+#ifndef ML_Memory_Allocator_H_
+#define ML_Memory_Allocator_H_
+
+// Includes
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <algorithm>
+#include <type_traits>
+
+#include "AlignedAlloc.h"
+
+#include "../QTL/Type.h"
+#include "../QTL/EnableIf.h"
+
+namespace ML
+{
+
+  // Allocator with the interface of std::allocator on top of MLAlignedAlloc (the default allocator of the
+  // matrices). Besides allocate(n) it has allocate(n, alignment) and deallocate(p, n, alignment): the
+  // matrices request the alignment of their SIMD type through this pair if an allocator defines it.
+  template<typename T>
+  class TMLAlignedAllocator
+  {
+  public:
+    using value_type = T;
+
+    TMLAlignedAllocator() noexcept = default;
+    template<typename U>
+    TMLAlignedAllocator(const TMLAlignedAllocator<U>&) noexcept {}
+
+    T* allocate(std::size_t n) { return allocate(n, alignof(T)); }
+    void deallocate(T* ptr, std::size_t n) noexcept { deallocate(ptr, n, alignof(T)); }
+    T* allocate(std::size_t n, std::size_t alignment) { return MLAlignedAlloc<T>(n, alignment); }
+    void deallocate(T* ptr, std::size_t, std::size_t) noexcept { MLAlignedFree(ptr); }
+
+    template<typename U>
+    bool operator==(const TMLAlignedAllocator<U>&) const noexcept { return true; }
+    template<typename U>
+    bool operator!=(const TMLAlignedAllocator<U>&) const noexcept { return false; }
+  };
+
+  // Allocator that forwards to a memory resource (e.g. CMLMemoryPool or CMLArena) with the member functions
+  // void* Allocate(bytes, alignment) and void Deallocate(ptr, bytes, alignment). The resource has to outlive
+  // all memory allocated from it. Without a resource (default constructed) MLAlignedAlloc is used.
+  template<typename T, typename Resource>
+  class TMLResourceAllocator
+  {
+    template<typename U, typename R> friend class TMLResourceAllocator;
+
+  public:
+    using value_type = T;
+    template<typename U> struct rebind { using other = TMLResourceAllocator<U, Resource>; };
+
+    TMLResourceAllocator() noexcept : m_resource(nullptr) {}
+    TMLResourceAllocator(Resource& resource) noexcept : m_resource(&resource) {}
+    template<typename U>
+    TMLResourceAllocator(const TMLResourceAllocator<U, Resource>& rhs) noexcept : m_resource(rhs.m_resource) {}
+
+    T* allocate(std::size_t n) { return allocate(n, alignof(T)); }
+    void deallocate(T* ptr, std::size_t n) noexcept { deallocate(ptr, n, alignof(T)); }
+    T* allocate(std::size_t n, std::size_t alignment)
+    {
+      if (!m_resource)
+        return MLAlignedAlloc<T>(n, alignment);
+      return n ? static_cast<T*>(m_resource->Allocate(n * sizeof(T), std::max(alignment, alignof(T)))) : nullptr;
+    }
+    void deallocate(T* ptr, std::size_t n, std::size_t alignment) noexcept
+    {
+      if (!m_resource)
+        MLAlignedFree(ptr);
+      else if (ptr)
+        m_resource->Deallocate(ptr, n * sizeof(T), std::max(alignment, alignof(T)));
+    }
+
+    Resource* GetResource() const noexcept { return m_resource; }
+
+    template<typename U>
+    bool operator==(const TMLResourceAllocator<U, Resource>& rhs) const noexcept { return m_resource == rhs.m_resource; }
+    template<typename U>
+    bool operator!=(const TMLResourceAllocator<U, Resource>& rhs) const noexcept { return m_resource != rhs.m_resource; }
+
+  private:
+    Resource* m_resource;
+  };
+
+  namespace Internal
+  {
+    // Does the allocator take the alignment as an argument (see TMLAlignedAllocator)?
+    template<typename A, typename=void>
+    struct TMLIsAlignedAllocator : std::false_type {};
+    template<typename A>
+    struct TMLIsAlignedAllocator<A, TMLVoid_t<decltype(
+      std::declval<A&>().deallocate(std::declval<typename A::value_type*>(), std::declval<std::size_t>(), std::declval<std::size_t>()))>>
+      : std::true_type {};
+
+    template<typename A>
+    constexpr bool TMLIsAlignedAllocator_v = TMLIsAlignedAllocator<A>::value;
+
+    // Allocates n elements (uninitialized) aligned to alignment. Allocators that do not know about alignment
+    // (e.g. std::allocator) are asked for bytes with enough padding to align the block, the original pointer
+    // is stored in front of the block (as in MLAlignedAlloc).
+    template<typename A>
+    TMLEnableIf_t<TMLIsAlignedAllocator_v<A>, typename A::value_type*>
+      MLAllocateAligned(A& alloc, std::size_t n, std::size_t alignment)
+    {
+      return n ? alloc.allocate(n, alignment) : nullptr;
+    }
+    template<typename A>
+    TMLEnableIf_t<TMLIsAlignedAllocator_v<A>, void>
+      MLDeallocateAligned(A& alloc, typename A::value_type* ptr, std::size_t n, std::size_t alignment) noexcept
+    {
+      if (ptr)
+        alloc.deallocate(ptr, n, alignment);
+    }
+
+    template<typename A>
+    TMLEnableIf_t<!TMLIsAlignedAllocator_v<A>, typename A::value_type*>
+      MLAllocateAligned(A& alloc, std::size_t n, std::size_t alignment)
+    {
+      using T = typename A::value_type;
+      if (n == 0)
+        return nullptr;
+
+      typename std::allocator_traits<A>::template rebind_alloc<unsigned char> bytes(alloc);
+      alignment = std::max(alignment, alignof(void*));
+      unsigned char* mem = bytes.allocate(n * sizeof(T) + alignment + sizeof(void*));
+      std::uintptr_t uptr = ((reinterpret_cast<std::uintptr_t>(mem) + sizeof(void*) + alignment - 1) / alignment) * alignment;
+      *(reinterpret_cast<void**>(uptr) - 1) = mem;
+      return reinterpret_cast<T*>(uptr);
+    }
+    template<typename A>
+    TMLEnableIf_t<!TMLIsAlignedAllocator_v<A>, void>
+      MLDeallocateAligned(A& alloc, typename A::value_type* ptr, std::size_t n, std::size_t alignment) noexcept
+    {
+      using T = typename A::value_type;
+      if (!ptr)
+        return;
+
+      typename std::allocator_traits<A>::template rebind_alloc<unsigned char> bytes(alloc);
+      alignment = std::max(alignment, alignof(void*));
+      unsigned char* mem = static_cast<unsigned char*>(*(reinterpret_cast<void**>(ptr) - 1));
+      bytes.deallocate(mem, n * sizeof(T) + alignment + sizeof(void*));
+    }
+  }
+}
+
+#endif
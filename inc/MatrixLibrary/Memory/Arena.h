@@ -0,0 +1,85 @@
+// Copyright 2021, Philipp Neufeld
+
+#ifndef ML_Memory_Arena_H_
+#define ML_Memory_Arena_H_
+
+// Includes
+#include <cstdint>
+#include <cstddef>
+#include <cassert>
+
+#include "AlignedAlloc.h"
+#include "Allocator.h"
+
+namespace ML
+{
+
+  // Arena with a buffer of fixed capacity: allocations are carved out of the buffer by advancing an offset
+  // and are given back all at once by Reset (e.g. after every request). Deallocate only rewinds the offset
+  // for the most recent allocation (stack order). Requests that do not fit into the rest of the buffer are
+  // served by MLAlignedAlloc and freed individually. The arena is not thread-safe.
+  class CMLArena
+  {
+  public:
+    // The buffer is aligned to alignment
+    explicit CMLArena(std::size_t capacity, std::size_t alignment = 64)
+      : m_capacity(capacity), m_offset(0), m_buffer(MLAlignedAlloc<unsigned char>(capacity, alignment)) {}
+    ~CMLArena() { MLAlignedFree(m_buffer); }
+
+    CMLArena(const CMLArena&) = delete;
+    CMLArena& operator=(const CMLArena&) = delete;
+
+    void* Allocate(std::size_t bytes, std::size_t alignment);
+    void Deallocate(void* ptr, std::size_t bytes, std::size_t alignment) noexcept;
+
+    // Gives back all allocations from the buffer (they must not be used anymore)
+    void Reset() noexcept { m_offset = 0; }
+
+    std::size_t GetCapacity() const noexcept { return m_capacity; }
+    std::size_t GetUsed() const noexcept { return m_offset; }
+
+    // Was ptr allocated from the buffer?
+    bool Owns(const void* ptr) const noexcept
+    {
+      const unsigned char* p = static_cast<const unsigned char*>(ptr);
+      return m_buffer && p >= m_buffer && p < m_buffer + m_capacity;
+    }
+
+  private:
+    std::size_t m_capacity;
+    std::size_t m_offset;
+    unsigned char* m_buffer;
+  };
+
+  inline void* CMLArena::Allocate(std::size_t bytes, std::size_t alignment)
+  {
+    const std::uintptr_t base = reinterpret_cast<std::uintptr_t>(m_buffer);
+    const std::uintptr_t aligned = ((base + m_offset + alignment - 1) / alignment) * alignment;
+    const std::size_t offset = aligned - base;
+    if (bytes == 0 || !m_buffer || offset > m_capacity || bytes > m_capacity - offset)
+      return MLAlignedAlloc<unsigned char>(bytes, alignment);
+
+    m_offset = offset + bytes;
+    return m_buffer + offset;
+  }
+
+  inline void CMLArena::Deallocate(void* ptr, std::size_t bytes, std::size_t alignment) noexcept
+  {
+    if (!Owns(ptr))
+    {
+      MLAlignedFree(ptr);
+      return;
+    }
+
+    unsigned char* p = static_cast<unsigned char*>(ptr);
+    if (p + bytes == m_buffer + m_offset)
+      m_offset = static_cast<std::size_t>(p - m_buffer);
+  }
+
+  // Allocator that takes its memory from a CMLArena
+  template<typename T>
+  using TMLArenaAllocator = TMLResourceAllocator<T, CMLArena>;
+
+}
+
+#endif
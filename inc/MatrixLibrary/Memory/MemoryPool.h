@@ -0,0 +1,108 @@
+// Copyright 2021, Philipp Neufeld
+
+#ifndef ML_Memory_MemoryPool_H_
+#define ML_Memory_MemoryPool_H_
+
+// Includes
+#include <cstddef>
+#include <cassert>
+
+#include "AlignedAlloc.h"
+#include "Allocator.h"
+
+namespace ML
+{
+
+  // Pool for allocations that recur with the same sizes (e.g. matrices that are created and destroyed in a
+  // loop). The sizes are rounded up to powers of two, freed blocks are kept in a free list per size and
+  // handed out again, so only the first allocation of a size reaches MLAlignedAlloc. The cached blocks are
+  // freed by Release or by the destructor. The pool is not thread-safe.
+  class CMLMemoryPool
+  {
+  public:
+    // All blocks are aligned to alignment, requests with a larger alignment bypass the pool
+    explicit CMLMemoryPool(std::size_t alignment = 64) : m_alignment(alignment), m_cachedBytes(0), m_free() {}
+    ~CMLMemoryPool() { Release(); }
+
+    CMLMemoryPool(const CMLMemoryPool&) = delete;
+    CMLMemoryPool& operator=(const CMLMemoryPool&) = delete;
+
+    void* Allocate(std::size_t bytes, std::size_t alignment);
+    void Deallocate(void* ptr, std::size_t bytes, std::size_t alignment) noexcept;
+
+    // Frees all cached blocks (blocks in use are not affected)
+    void Release() noexcept;
+
+    // Bytes in the free lists
+    std::size_t GetCachedBytes() const noexcept { return m_cachedBytes; }
+
+  private:
+    constexpr static std::size_t MinClass_v = 6;
+    constexpr static std::size_t Classes_v = 64;
+
+    // Size class of a request: blocks of class k have 2^k bytes
+    static std::size_t SizeClass(std::size_t bytes) noexcept
+    {
+      std::size_t k = MinClass_v;
+      while ((std::size_t(1) << k) < bytes)
+        k++;
+      return k;
+    }
+
+  private:
+    std::size_t m_alignment;
+    std::size_t m_cachedBytes;
+    // Free lists (the pointer to the next block is stored in the block)
+    void* m_free[Classes_v];
+  };
+
+  inline void* CMLMemoryPool::Allocate(std::size_t bytes, std::size_t alignment)
+  {
+    if (alignment > m_alignment)
+      return MLAlignedAlloc<unsigned char>(bytes, alignment);
+
+    const std::size_t k = SizeClass(bytes);
+    if (void* block = m_free[k])
+    {
+      m_free[k] = *static_cast<void**>(block);
+      m_cachedBytes -= std::size_t(1) << k;
+      return block;
+    }
+    return MLAlignedAlloc<unsigned char>(std::size_t(1) << k, m_alignment);
+  }
+
+  inline void CMLMemoryPool::Deallocate(void* ptr, std::size_t bytes, std::size_t alignment) noexcept
+  {
+    if (alignment > m_alignment)
+    {
+      MLAlignedFree(ptr);
+      return;
+    }
+
+    const std::size_t k = SizeClass(bytes);
+    *static_cast<void**>(ptr) = m_free[k];
+    m_free[k] = ptr;
+    m_cachedBytes += std::size_t(1) << k;
+  }
+
+  inline void CMLMemoryPool::Release() noexcept
+  {
+    for (std::size_t k = 0; k < Classes_v; k++)
+    {
+      while (void* block = m_free[k])
+      {
+        m_free[k] = *static_cast<void**>(block);
+        MLAlignedFree(block);
+      }
+    }
+    m_cachedBytes = 0;
+  }
+
+  // Allocator that takes its memory from a CMLMemoryPool (e.g. TMLDynamicMatrix<double, true, 0xFFFFFFFF,
+  // true, TMLPoolAllocator<double>> a(n, n, TMLPoolAllocator<double>(pool)))
+  template<typename T>
+  using TMLPoolAllocator = TMLResourceAllocator<T, CMLMemoryPool>;
+
+}
+
+#endif
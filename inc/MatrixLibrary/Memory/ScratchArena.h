@@ -0,0 +1,168 @@
+// Copyright 2021, Philipp Neufeld
+
+#ifndef ML_Memory_ScratchArena_H_
+#define ML_Memory_ScratchArena_H_
+
+// Includes
+#include <cstdint>
+#include <cstddef>
+#include <atomic>
+
+#include "AlignedAlloc.h"
+#include "Allocator.h"
+
+// Capacity of the scratch arena of every thread in bytes (can be changed at runtime, see
+// CMLScratchArena::SetDefaultCapacity). The default holds the packing buffers of the GEMM kernel.
+#if !defined(ML_MEMORY_SCRATCH_SIZE)
+#define ML_MEMORY_SCRATCH_SIZE (16 * 1024 * 1024)
+#endif
+
+namespace ML
+{
+
+  // Stack of temporary memory for the evaluation of expressions (copies of aliased results, materialized
+  // operands, packing buffers of the kernels). Every thread has its own arena (see GetThreadLocal), so an
+  // allocation only advances an offset and never takes a lock. Blocks should be given back in reverse
+  // order of their allocation; blocks that are given back out of order are reclaimed as soon as the arena
+  // is empty. Requests that do not fit into the rest of the buffer are served by MLAlignedAlloc.
+  // The buffer is allocated on the first request and follows changes of the default capacity whenever the
+  // arena is empty.
+  class CMLScratchArena
+  {
+  public:
+    CMLScratchArena() noexcept : m_capacity(0), m_offset(0), m_blocks(0), m_buffer(nullptr) {}
+    ~CMLScratchArena() { MLAlignedFree(m_buffer); }
+
+    CMLScratchArena(const CMLScratchArena&) = delete;
+    CMLScratchArena& operator=(const CMLScratchArena&) = delete;
+
+    void* Allocate(std::size_t bytes, std::size_t alignment);
+    void Deallocate(void* ptr, std::size_t bytes, std::size_t alignment) noexcept;
+
+    std::size_t GetCapacity() const noexcept { return m_capacity; }
+    std::size_t GetUsed() const noexcept { return m_offset; }
+
+    // Was ptr allocated from the buffer?
+    bool Owns(const void* ptr) const noexcept
+    {
+      const unsigned char* p = static_cast<const unsigned char*>(ptr);
+      return m_buffer && p >= m_buffer && p < m_buffer + m_capacity;
+    }
+
+    // Arena of the calling thread
+    static CMLScratchArena& GetThreadLocal() { thread_local CMLScratchArena arena; return arena; }
+
+    // Capacity in bytes of the arenas of all threads (0: all requests go to MLAlignedAlloc)
+    static std::size_t GetDefaultCapacity() noexcept { return DefaultCapacity().load(std::memory_order_relaxed); }
+    static void SetDefaultCapacity(std::size_t bytes) noexcept { DefaultCapacity().store(bytes, std::memory_order_relaxed); }
+
+  private:
+    constexpr static std::size_t BufferAlignment_v = 64;
+
+    static std::atomic<std::size_t>& DefaultCapacity() noexcept
+    {
+      static std::atomic<std::size_t> capacity(ML_MEMORY_SCRATCH_SIZE);
+      return capacity;
+    }
+
+  private:
+    std::size_t m_capacity;
+    std::size_t m_offset;
+    // Number of blocks in the buffer
+    std::size_t m_blocks;
+    unsigned char* m_buffer;
+  };
+
+  inline void* CMLScratchArena::Allocate(std::size_t bytes, std::size_t alignment)
+  {
+    if (m_blocks == 0 && m_capacity != GetDefaultCapacity())
+    {
+      MLAlignedFree(m_buffer);
+      m_capacity = GetDefaultCapacity();
+      m_buffer = MLAlignedAlloc<unsigned char>(m_capacity, BufferAlignment_v);
+    }
+
+    const std::uintptr_t base = reinterpret_cast<std::uintptr_t>(m_buffer);
+    const std::uintptr_t aligned = ((base + m_offset + alignment - 1) / alignment) * alignment;
+    const std::size_t offset = aligned - base;
+    if (bytes == 0 || !m_buffer || offset > m_capacity || bytes > m_capacity - offset)
+      return MLAlignedAlloc<unsigned char>(bytes, alignment);
+
+    m_offset = offset + bytes;
+    m_blocks++;
+    return m_buffer + offset;
+  }
+
+  inline void CMLScratchArena::Deallocate(void* ptr, std::size_t bytes, std::size_t) noexcept
+  {
+    if (!Owns(ptr))
+    {
+      MLAlignedFree(ptr);
+      return;
+    }
+
+    unsigned char* p = static_cast<unsigned char*>(ptr);
+    if (--m_blocks == 0)
+      m_offset = 0;
+    else if (p + bytes == m_buffer + m_offset)
+      m_offset = static_cast<std::size_t>(p - m_buffer);
+  }
+
+  // Allocator that takes its memory from the scratch arena of the calling thread. The memory has to be
+  // given back by the same thread, so it is meant for temporaries that live within a function (e.g.
+  // TMLDynamicMatrix<double, true, 0xFFFFFFFF, true, TMLScratchAllocator<double>> tmp(m, n)).
+  template<typename T>
+  class TMLScratchAllocator
+  {
+  public:
+    using value_type = T;
+
+    TMLScratchAllocator() noexcept = default;
+    template<typename U>
+    TMLScratchAllocator(const TMLScratchAllocator<U>&) noexcept {}
+
+    T* allocate(std::size_t n) { return allocate(n, alignof(T)); }
+    void deallocate(T* ptr, std::size_t n) noexcept { deallocate(ptr, n, alignof(T)); }
+    T* allocate(std::size_t n, std::size_t alignment)
+    {
+      return static_cast<T*>(CMLScratchArena::GetThreadLocal().Allocate(n * sizeof(T), std::max(alignment, alignof(T))));
+    }
+    void deallocate(T* ptr, std::size_t n, std::size_t alignment) noexcept
+    {
+      if (ptr)
+        CMLScratchArena::GetThreadLocal().Deallocate(ptr, n * sizeof(T), std::max(alignment, alignof(T)));
+    }
+
+    template<typename U>
+    bool operator==(const TMLScratchAllocator<U>&) const noexcept { return true; }
+    template<typename U>
+    bool operator!=(const TMLScratchAllocator<U>&) const noexcept { return false; }
+  };
+
+  // Uninitialized buffer from the scratch arena of the calling thread that is given back when it goes out
+  // of scope (the scratch counterpart of TMLAlignedArray for the buffers of the kernels)
+  template<typename T>
+  class TMLScratchArray
+  {
+  public:
+    TMLScratchArray(std::size_t size, std::size_t alignment)
+      : m_arena(CMLScratchArena::GetThreadLocal()), m_size(size),
+      m_data(static_cast<T*>(m_arena.Allocate(size * sizeof(T), std::max(alignment, alignof(T))))) {}
+    ~TMLScratchArray() { m_arena.Deallocate(m_data, m_size * sizeof(T), alignof(T)); }
+
+    TMLScratchArray(const TMLScratchArray&) = delete;
+    TMLScratchArray& operator=(const TMLScratchArray&) = delete;
+
+    std::size_t size() const noexcept { return m_size; }
+    T* data() noexcept { return m_data; }
+    const T* data() const noexcept { return m_data; }
+
+  private:
+    CMLScratchArena& m_arena;
+    std::size_t m_size;
+    T* m_data;
+  };
+
+}
+
+#endif
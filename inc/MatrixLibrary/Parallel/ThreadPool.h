@@ -0,0 +1,190 @@
+// Copyright 2021, Philipp Neufeld
+
+#ifndef ML_Parallel_ThreadPool_H_
+#define ML_Parallel_ThreadPool_H_
+
+// Includes
+#include <cstdint>
+#include <cstddef>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <vector>
+#include <algorithm>
+#include <type_traits>
+
+namespace ML
+{
+
+  // Persistent pool of worker threads that execute parallel loops.
+  // The thread calling ParallelFor participates in the work. The pool serves
+  // one loop at a time: loops that are started while the pool is busy (e.g. from
+  // several user threads or from inside a parallel loop) run on the calling thread,
+  // so the number of running threads never exceeds the size of the pool.
+  class CMLThreadPool
+  {
+  public:
+    explicit CMLThreadPool(std::size_t threads = DefaultThreadCount());
+    ~CMLThreadPool() { StopWorkers(); }
+
+    CMLThreadPool(const CMLThreadPool&) = delete;
+    CMLThreadPool& operator=(const CMLThreadPool&) = delete;
+
+    // Number of threads (including the calling thread)
+    std::size_t GetThreadCount() const noexcept { return m_threadCount.load(std::memory_order_relaxed); }
+    void SetThreadCount(std::size_t threads);
+
+    // Calls func(i) for every i in [0, count) using at most maxThreads
+    // threads (0: all threads of the pool) and waits for completion
+    template<typename Func>
+    void ParallelFor(std::size_t count, Func&& func, std::size_t maxThreads = 0);
+
+    // Pool that is used by the library
+    static CMLThreadPool& GetGlobal() { static CMLThreadPool pool; return pool; }
+
+    static std::size_t DefaultThreadCount() { return std::max<std::size_t>(std::thread::hardware_concurrency(), 1); }
+
+  private:
+    void StartWorkers(std::size_t threads);
+    void StopWorkers();
+    void WorkerMain(std::uint64_t generation);
+    void RunItems();
+
+    template<typename Func>
+    static void Invoke(void* func, std::size_t i) { (*static_cast<Func*>(func))(i); }
+
+    // Set for threads that are currently executing a parallel loop
+    static bool& InParallelRegion() { thread_local bool flag = false; return flag; }
+
+  private:
+    // Written under m_submitMutex, read without lock (only a hint outside of it)
+    std::atomic<std::size_t> m_threadCount;
+    std::vector<std::thread> m_workers;
+
+    std::mutex m_submitMutex;
+    std::mutex m_mutex;
+    std::condition_variable m_wakeCV;
+    std::condition_variable m_doneCV;
+    bool m_shutdown;
+
+    // Current loop
+    std::uint64_t m_generation;
+    void (*m_invoke)(void*, std::size_t);
+    void* m_func;
+    std::size_t m_count;
+    std::atomic<std::size_t> m_next;
+    std::size_t m_participants;
+    std::size_t m_joined;
+    std::size_t m_active;
+  };
+
+  inline CMLThreadPool::CMLThreadPool(std::size_t threads)
+    : m_threadCount(1), m_shutdown(false), m_generation(0), m_invoke(nullptr), m_func(nullptr),
+    m_count(0), m_next(0), m_participants(0), m_joined(0), m_active(0)
+  {
+    StartWorkers(threads);
+  }
+
+  inline void CMLThreadPool::SetThreadCount(std::size_t threads)
+  {
+    std::lock_guard<std::mutex> submitLock(m_submitMutex);
+    StopWorkers();
+    StartWorkers(threads);
+  }
+
+  inline void CMLThreadPool::StartWorkers(std::size_t threads)
+  {
+    threads = std::max<std::size_t>(threads, 1);
+    m_shutdown = false;
+    for (std::size_t i = 1; i < threads; i++)
+      m_workers.emplace_back(&CMLThreadPool::WorkerMain, this, m_generation);
+    m_threadCount.store(threads, std::memory_order_relaxed);
+  }
+
+  inline void CMLThreadPool::StopWorkers()
+  {
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_shutdown = true;
+    }
+    m_wakeCV.notify_all();
+    for (auto& worker : m_workers)
+      worker.join();
+    m_workers.clear();
+    m_threadCount.store(1, std::memory_order_relaxed);
+  }
+
+  inline void CMLThreadPool::WorkerMain(std::uint64_t generation)
+  {
+    InParallelRegion() = true;
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    for (;;)
+    {
+      m_wakeCV.wait(lock, [&]() { return m_shutdown || (m_generation != generation && m_joined < m_participants); });
+      if (m_shutdown)
+        return;
+
+      generation = m_generation;
+      m_joined++;
+      m_active++;
+
+      lock.unlock();
+      RunItems();
+      lock.lock();
+
+      if (--m_active == 0)
+        m_doneCV.notify_all();
+    }
+  }
+
+  inline void CMLThreadPool::RunItems()
+  {
+    for (std::size_t i = m_next++; i < m_count; i = m_next++)
+      m_invoke(m_func, i);
+  }
+
+  template<typename Func>
+  void CMLThreadPool::ParallelFor(std::size_t count, Func&& func, std::size_t maxThreads)
+  {
+    std::size_t threads = maxThreads == 0 ? GetThreadCount() : std::min(maxThreads, GetThreadCount());
+    threads = std::min(threads, count);
+
+    // Run serially if there is nothing to parallelize or if the pool is busy
+    if (threads <= 1 || InParallelRegion() || !m_submitMutex.try_lock())
+    {
+      for (std::size_t i = 0; i < count; i++)
+        func(i);
+      return;
+    }
+    std::lock_guard<std::mutex> submitLock(m_submitMutex, std::adopt_lock);
+
+    // The pool may have been resized since the count was read
+    threads = std::min(threads, m_workers.size() + 1);
+
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_invoke = &CMLThreadPool::Invoke<std::remove_reference_t<Func>>;
+      m_func = const_cast<void*>(static_cast<const void*>(&func));
+      m_count = count;
+      m_next = 0;
+      m_participants = threads - 1;
+      m_joined = 0;
+      m_generation++;
+    }
+    m_wakeCV.notify_all();
+
+    InParallelRegion() = true;
+    RunItems();
+    InParallelRegion() = false;
+
+    // Close the loop for workers that did not join yet and wait for the others
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_participants = m_joined;
+    m_doneCV.wait(lock, [&]() { return m_active == 0; });
+  }
+
+}
+
+#endif
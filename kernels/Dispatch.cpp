@@ -0,0 +1,90 @@
+// Copyright 2021, Philipp Neufeld
+
+// Selection of the runtime dispatched kernels (see Kernels/Dispatch.h). The macros
+// ML_KERNELS_<LEVEL> are defined by CMake for the levels that are compiled.
+
+#include <cstdlib>
+#include <cstring>
+
+#include <MatrixLibrary/Math/Kernels/Dispatch.h>
+
+#include "../cpu/Cpu.h"
+
+namespace ML
+{
+
+  namespace
+  {
+    // Highest level that is compiled and supported by the cpu (or the level forced by ML_SIMD_LEVEL)
+    EMLSIMDLevel MLDetectSIMDLevel()
+    {
+      CMLCpu cpu;
+      EMLSIMDLevel level = EMLSIMDLevel::SSE2;
+#if defined(ML_KERNELS_AVX2)
+      if (cpu.HasAVX2() && cpu.HasFMA())
+        level = EMLSIMDLevel::AVX2;
+#endif
+#if defined(ML_KERNELS_AVX512)
+      if (level == EMLSIMDLevel::AVX2 && cpu.HasAVX512F() && cpu.HasAVX512DQ() && cpu.HasAVX512BW())
+        level = EMLSIMDLevel::AVX512;
+#endif
+
+      // Levels that are not available are ignored
+      const char* forced = std::getenv("ML_SIMD_LEVEL");
+      if (forced)
+      {
+        for (EMLSIMDLevel l : { EMLSIMDLevel::SSE2, EMLSIMDLevel::AVX2, EMLSIMDLevel::AVX512 })
+        {
+          if (l <= level && std::strcmp(forced, MLGetSIMDLevelName(l)) == 0)
+            return l;
+        }
+      }
+
+      return level;
+    }
+
+    template<typename ET>
+    const TMLKernelTable<ET>& MLSelectKernelTable(EMLSIMDLevel level)
+    {
+      switch (level)
+      {
+#if defined(ML_KERNELS_AVX512)
+      case EMLSIMDLevel::AVX512: return Internal::MLGetKernelTableAVX512<ET>();
+#endif
+#if defined(ML_KERNELS_AVX2)
+      case EMLSIMDLevel::AVX2: return Internal::MLGetKernelTableAVX2<ET>();
+#endif
+      default: return Internal::MLGetKernelTableSSE2<ET>();
+      }
+    }
+  }
+
+  EMLSIMDLevel MLGetSIMDLevel()
+  {
+    static const EMLSIMDLevel level = MLDetectSIMDLevel();
+    return level;
+  }
+
+  const char* MLGetSIMDLevelName(EMLSIMDLevel level)
+  {
+    switch (level)
+    {
+    case EMLSIMDLevel::AVX512: return "avx512";
+    case EMLSIMDLevel::AVX2: return "avx2";
+    default: return "sse2";
+    }
+  }
+
+  template<typename ET>
+  const TMLKernelTable<ET>& MLGetKernelTable()
+  {
+    static const TMLKernelTable<ET>& table = MLSelectKernelTable<ET>(MLGetSIMDLevel());
+    return table;
+  }
+
+  template const TMLKernelTable<float>& MLGetKernelTable<float>();
+  template const TMLKernelTable<double>& MLGetKernelTable<double>();
+  template const TMLKernelTable<std::complex<float>>& MLGetKernelTable<std::complex<float>>();
+  template const TMLKernelTable<std::complex<double>>& MLGetKernelTable<std::complex<double>>();
+
+}
@@ -0,0 +1,107 @@
+// Copyright 2021, Philipp Neufeld
+
+// Kernels of one instruction set level of the runtime dispatch (see Kernels/Dispatch.h).
+// This file is compiled once per level with the compiler flags and macros of the level
+// and ML_KERNELS_LEVEL set to the name of the level (SSE2, AVX2, AVX512).
+//
+// The library is included in a namespace that is renamed per level. Otherwise the linker
+// would merge the inline functions and templates that are compiled for different instruction
+// sets and the baseline code could end up executing e.g. AVX-512 instructions.
+
+// Includes (standard library first, it must not be affected by the renaming below)
+#include <cstdint>
+#include <cstdlib>
+#include <cmath>
+#include <complex>
+#include <algorithm>
+#include <type_traits>
+#include <utility>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <chrono>
+#include <immintrin.h>
+
+#include <MatrixLibrary/Math/Kernels/Dispatch.h>
+
+#define ML_KERNELS_CONCAT_IMPL(a, b) a##b
+#define ML_KERNELS_CONCAT(a, b) ML_KERNELS_CONCAT_IMPL(a, b)
+#define ML_KERNELS_NAMESPACE ML_KERNELS_CONCAT(MLKernels, ML_KERNELS_LEVEL)
+#define ML_KERNELS_TABLE ML_KERNELS_CONCAT(MLGetKernelTable, ML_KERNELS_LEVEL)
+
+// The types of the interface (Dispatch.h) are shared by all levels
+namespace ML_KERNELS_NAMESPACE
+{
+  using ::ML::SMLGemmTuning;
+  using ::ML::TMLGemmEpilogue;
+  using ::ML::EMLActivation;
+}
+
+#define ML ML_KERNELS_NAMESPACE
+#include <MatrixLibrary/Math/Kernels/GemmKernel.h>
+#include <MatrixLibrary/Math/Kernels/GemvKernel.h>
+#include <MatrixLibrary/Math/Kernels/ElementwiseKernel.h>
+#undef ML
+
+namespace
+{
+  namespace Kernels = ML_KERNELS_NAMESPACE;
+
+  // Widest SIMD type of the level
+  template<typename ET>
+  using TSIMDType = Kernels::TMLSIMDTypeSelector_t<ET, 0xFFFFFFFF>;
+
+  template<typename ET>
+  void Gemm(const ML::TMLKernelView<ET>& c, const ML::TMLKernelView<const ET>& a, const ML::TMLKernelView<const ET>& b,
+    std::size_t i0, std::size_t i1, std::size_t j0, std::size_t j1, const ML::TMLGemmEpilogue<ET>& epilogue)
+  {
+    Kernels::Internal::TMLGemmKernel<ET, TSIMDType<ET>>::Blocked({ c.data, c.rows, c.cols, c.rs, c.cs },
+      { a.data, a.rows, a.cols, a.rs, a.cs }, { b.data, b.rows, b.cols, b.rs, b.cs }, i0, i1, j0, j1, epilogue);
+  }
+
+  template<typename ET>
+  void GemmUnblocked(const ML::TMLKernelView<ET>& c, const ML::TMLKernelView<const ET>& a, const ML::TMLKernelView<const ET>& b,
+    const ML::TMLGemmEpilogue<ET>& epilogue)
+  {
+    Kernels::Internal::TMLGemmKernel<ET, TSIMDType<ET>>::Unblocked({ c.data, c.rows, c.cols, c.rs, c.cs },
+      { a.data, a.rows, a.cols, a.rs, a.cs }, { b.data, b.rows, b.cols, b.rs, b.cs }, epilogue);
+  }
+
+  template<typename ET>
+  void Gemv(const ML::TMLKernelView<const ET>& a, const ET* x, std::size_t incx, ET* y, std::size_t incy, ET alpha, ET beta)
+  {
+    Kernels::Internal::TMLGemvKernel<ET, TSIMDType<ET>>::Gemv({ a.data, a.rows, a.cols, a.rs, a.cs }, x, incx, y, incy, alpha, beta);
+  }
+
+  template<typename ET>
+  void Ger(const ML::TMLKernelView<ET>& a, const ET* x, std::size_t incx, const ET* y, std::size_t incy, ET alpha, ET beta)
+  {
+    Kernels::Internal::TMLGemvKernel<ET, TSIMDType<ET>>::Ger({ a.data, a.rows, a.cols, a.rs, a.cs }, x, incx, y, incy, alpha, beta);
+  }
+}
+
+namespace ML
+{
+  namespace Internal
+  {
+    template<typename ET>
+    const TMLKernelTable<ET>& ML_KERNELS_TABLE()
+    {
+      using GemmKernel = Kernels::Internal::TMLGemmKernel<ET, TSIMDType<ET>>;
+      using ElementwiseKernel = Kernels::Internal::TMLElementwiseKernel<ET, TSIMDType<ET>>;
+
+      static const TMLKernelTable<ET> table = {
+        &GemmKernel::TileRows, &GemmKernel::TileCols, &Gemm<ET>, &GemmUnblocked<ET>,
+        &GemmKernel::GetTuning, &GemmKernel::SetTuning, &GemmKernel::Tune, &Gemv<ET>, &Ger<ET>,
+        &ElementwiseKernel::Copy, &ElementwiseKernel::Fill, &ElementwiseKernel::Add
+      };
+      return table;
+    }
+
+    template const TMLKernelTable<float>& ML_KERNELS_TABLE<float>();
+    template const TMLKernelTable<double>& ML_KERNELS_TABLE<double>();
+    template const TMLKernelTable<std::complex<float>>& ML_KERNELS_TABLE<std::complex<float>>();
+    template const TMLKernelTable<std::complex<double>>& ML_KERNELS_TABLE<std::complex<double>>();
+  }
+}